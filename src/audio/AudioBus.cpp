@@ -1,19 +1,58 @@
 #include "AudioBus.h"
+#include "../utils/Logger.h"
 
 #include <algorithm>
 #include <cstring>
+#include <thread>
 
 AudioBus::AudioBus(uint32_t sampleRate, uint32_t channels)
-    : m_sampleRate(sampleRate), m_channels(channels)
+    : m_sampleRate(sampleRate), m_channels(channels), m_table(std::make_shared<TapTable>())
 {
 }
 
 std::shared_ptr<AudioBus::Tap> AudioBus::createTap(size_t capacitySamples)
 {
-    auto tap = std::shared_ptr<Tap>(new Tap(capacitySamples));
-    std::lock_guard<std::mutex> lock(m_tapsMutex);
-    m_taps.push_back(tap);
-    return tap;
+    std::shared_ptr<TapTable> table = m_table;
+    Tap *raw = new Tap(capacitySamples);
+
+    std::lock_guard<std::mutex> lock(table->registerMutex);
+    bool attached = false;
+    for (auto &slot : table->slots)
+    {
+        if (slot.load(std::memory_order_relaxed) == nullptr)
+        {
+            slot.store(raw, std::memory_order_seq_cst);
+            attached = true;
+            break;
+        }
+    }
+    if (!attached)
+    {
+        LOG_ERROR("AudioBus: no free tap slot (max " + std::to_string(MAX_TAPS) +
+                  ") — tap will stay silent");
+    }
+
+    return std::shared_ptr<Tap>(raw, [table](Tap *tap)
+    {
+        {
+            std::lock_guard<std::mutex> lock(table->registerMutex);
+            for (auto &slot : table->slots)
+            {
+                if (slot.load(std::memory_order_relaxed) == tap)
+                {
+                    slot.store(nullptr, std::memory_order_seq_cst);
+                    break;
+                }
+            }
+        }
+        // A push that started before the slot was cleared may still be
+        // writing into this tap; one that starts after can't see it.
+        while (table->activePushes.load(std::memory_order_seq_cst) != 0)
+        {
+            std::this_thread::yield();
+        }
+        delete tap;
+    });
 }
 
 void AudioBus::push(const int16_t *interleaved, size_t sampleCount)
@@ -23,40 +62,51 @@ void AudioBus::push(const int16_t *interleaved, size_t sampleCount)
         return;
     }
 
-    std::vector<std::shared_ptr<Tap>> live;
+    TapTable &table = *m_table;
+    table.activePushes.fetch_add(1, std::memory_order_seq_cst);
+    for (auto &slot : table.slots)
     {
-        std::lock_guard<std::mutex> lock(m_tapsMutex);
-        live.reserve(m_taps.size());
-        auto it = m_taps.begin();
-        while (it != m_taps.end())
+        if (Tap *tap = slot.load(std::memory_order_seq_cst))
         {
-            if (auto sp = it->lock())
-            {
-                live.push_back(std::move(sp));
-                ++it;
-            }
-            else
-            {
-                it = m_taps.erase(it);
-            }
+            tap->push(interleaved, sampleCount);
         }
     }
+    table.activePushes.fetch_sub(1, std::memory_order_seq_cst);
+}
 
-    for (auto &tap : live)
+AudioBus::Tap::Tap(size_t capacitySamples)
+{
+    // Capacity 0 used to mean "unbounded"; a fixed ring needs a bound, so
+    // fall back to ~2 s of 48 kHz stereo like the other taps.
+    m_capacity = capacitySamples > 0 ? capacitySamples : static_cast<size_t>(48000) * 2 * 2;
+    size_t storage = 1;
+    while (storage < m_capacity)
     {
-        tap->push(interleaved, sampleCount);
+        storage <<= 1;
     }
+    m_mask = storage - 1;
+    m_storage.reset(new int16_t[storage]);
 }
 
 void AudioBus::Tap::push(const int16_t *src, size_t sampleCount)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_buffer.insert(m_buffer.end(), src, src + sampleCount);
-    if (m_capacity > 0 && m_buffer.size() > m_capacity)
+    const size_t w = m_writePos.load(std::memory_order_relaxed);
+    const size_t r = m_readPos.load(std::memory_order_acquire);
+    if (sampleCount > m_capacity - (w - r))
     {
-        const size_t drop = m_buffer.size() - m_capacity;
-        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + drop);
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+        m_droppedSamples.fetch_add(sampleCount, std::memory_order_relaxed);
+        return;
     }
+
+    const size_t offset = w & m_mask;
+    const size_t first = std::min(sampleCount, m_mask + 1 - offset);
+    std::memcpy(m_storage.get() + offset, src, first * sizeof(int16_t));
+    if (first < sampleCount)
+    {
+        std::memcpy(m_storage.get(), src + first, (sampleCount - first) * sizeof(int16_t));
+    }
+    m_writePos.store(w + sampleCount, std::memory_order_release);
 }
 
 size_t AudioBus::Tap::pull(int16_t *dst, size_t maxSamples)
@@ -65,25 +115,37 @@ size_t AudioBus::Tap::pull(int16_t *dst, size_t maxSamples)
     {
         return 0;
     }
-    std::lock_guard<std::mutex> lock(m_mutex);
-    const size_t n = std::min(maxSamples, m_buffer.size());
+    const size_t r = m_readPos.load(std::memory_order_relaxed);
+    const size_t w = m_writePos.load(std::memory_order_acquire);
+    const size_t n = std::min(maxSamples, w - r);
     if (n == 0)
     {
         return 0;
     }
-    // deque iterators don't guarantee contiguous storage, so element-by-
-    // element copy. Sizes here are <= a few thousand samples per pull,
-    // so this is not a hot-path concern.
-    for (size_t i = 0; i < n; ++i)
+
+    const size_t offset = r & m_mask;
+    const size_t first = std::min(n, m_mask + 1 - offset);
+    std::memcpy(dst, m_storage.get() + offset, first * sizeof(int16_t));
+    if (first < n)
     {
-        dst[i] = m_buffer[i];
+        std::memcpy(dst + first, m_storage.get(), (n - first) * sizeof(int16_t));
     }
-    m_buffer.erase(m_buffer.begin(), m_buffer.begin() + n);
+    m_readPos.store(r + n, std::memory_order_release);
+    return n;
+}
+
+size_t AudioBus::Tap::discard(size_t maxSamples)
+{
+    const size_t r = m_readPos.load(std::memory_order_relaxed);
+    const size_t w = m_writePos.load(std::memory_order_acquire);
+    const size_t n = std::min(maxSamples, w - r);
+    m_readPos.store(r + n, std::memory_order_release);
     return n;
 }
 
 size_t AudioBus::Tap::available() const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    return m_buffer.size();
+    const size_t r = m_readPos.load(std::memory_order_acquire);
+    const size_t w = m_writePos.load(std::memory_order_acquire);
+    return w - r;
 }
@@ -1,11 +1,11 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <memory>
 #include <mutex>
-#include <vector>
 
 /**
  * In-process fan-out for captured S16LE interleaved audio.
@@ -17,33 +17,68 @@
  * module-pipe-source publisher that exposes the `RetroCapture` virtual
  * source to the rest of the OS audio graph.
  *
+ * push() runs on the realtime audio callback, so it never locks or
+ * allocates: taps live in a fixed slot table and each Tap is a
+ * single-producer/single-consumer ring. Pushes may come from different
+ * threads (macOS mic vs. SCK hub) as long as they are serialized.
+ *
  * The seam exists so a future DSP chain can sit between push() and the
  * publish taps without rearchitecting capture or consumers.
  */
 class AudioBus
 {
 public:
+    static constexpr size_t MAX_TAPS = 8;
+
+    /**
+     * Fixed-capacity SPSC ring. Storage is rounded up to a power of two
+     * so wrap-around is a mask and every push/pull is at most two
+     * memcpy spans; the fill limit stays at the requested capacity.
+     *
+     * When a push doesn't fit, the whole chunk is dropped (the producer
+     * can't move the consumer's read index) and counted as an overrun.
+     * Chunks are frame-aligned, so dropping whole chunks never splits
+     * channels. Consumers that need to catch up call discard().
+     */
     class Tap
     {
     public:
         // Pulls up to maxSamples interleaved int16 frames into dst.
-        // Returns the count actually copied. Non-blocking.
+        // Returns the count actually copied. Non-blocking. Consumer
+        // thread only.
         size_t pull(int16_t *dst, size_t maxSamples);
 
+        // Drops up to maxSamples of the oldest queued samples (e.g. a
+        // monitor resync). Consumer thread only.
+        size_t discard(size_t maxSamples);
+
         size_t available() const;
+        size_t capacity() const { return m_capacity; }
+
+        // Pushes dropped because the ring was full, and their samples.
+        uint64_t getOverrunCount() const { return m_overruns.load(std::memory_order_relaxed); }
+        uint64_t getDroppedSamples() const { return m_droppedSamples.load(std::memory_order_relaxed); }
 
     private:
         friend class AudioBus;
 
-        explicit Tap(size_t capacitySamples) : m_capacity(capacitySamples) {}
+        explicit Tap(size_t capacitySamples);
 
         void push(const int16_t *src, size_t sampleCount);
 
-        // Drop-oldest when full so a stalled consumer can never wedge
-        // the producer or starve the other taps.
-        size_t              m_capacity;
-        mutable std::mutex  m_mutex;
-        std::deque<int16_t> m_buffer;
+        static constexpr size_t CACHE_LINE = 64;
+
+        size_t                     m_capacity; // fill limit (samples)
+        size_t                     m_mask;     // storage size - 1
+        std::unique_ptr<int16_t[]> m_storage;
+
+        // Monotonic positions; each is written by one side only and sits
+        // on its own cache line so producer and consumer don't false-share.
+        alignas(CACHE_LINE) std::atomic<size_t> m_writePos{0};
+        alignas(CACHE_LINE) std::atomic<size_t> m_readPos{0};
+
+        alignas(CACHE_LINE) std::atomic<uint64_t> m_overruns{0};
+        std::atomic<uint64_t> m_droppedSamples{0};
     };
 
     AudioBus(uint32_t sampleRate, uint32_t channels);
@@ -51,17 +86,26 @@ public:
     uint32_t getSampleRate() const { return m_sampleRate; }
     uint32_t getChannels() const { return m_channels; }
 
-    // Caller owns the returned tap; AudioBus only holds a weak ref, so
-    // dropping the last shared_ptr cleanly removes the tap on the next
-    // push().
+    // Caller owns the returned tap; dropping the last shared_ptr removes
+    // it from the bus (waiting out an in-flight push). The tap may outlive
+    // the bus. At most MAX_TAPS are attached; beyond that the returned tap
+    // never receives samples.
     std::shared_ptr<Tap> createTap(size_t capacitySamples);
 
     void push(const int16_t *interleaved, size_t sampleCount);
 
 private:
+    // Shared with every tap's deleter so a tap released after the bus is
+    // gone still has somewhere to unregister from.
+    struct TapTable
+    {
+        std::array<std::atomic<Tap *>, MAX_TAPS> slots{};
+        std::atomic<int> activePushes{0};
+        std::mutex       registerMutex; // createTap / tap release only
+    };
+
     uint32_t m_sampleRate;
     uint32_t m_channels;
 
-    mutable std::mutex                m_tapsMutex;
-    std::vector<std::weak_ptr<Tap>>   m_taps;
+    std::shared_ptr<TapTable> m_table;
 };
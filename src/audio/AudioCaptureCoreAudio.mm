@@ -774,7 +774,6 @@ void AudioCaptureCoreAudio::monitorWriterLoop()
     // MonitorPlayback writer.
     constexpr size_t kChunkSamples = 882 * 2;
     std::vector<int16_t> chunk(kChunkSamples);
-    std::vector<int16_t> drain;
 
     while (m_monitorRunning.load())
     {
@@ -782,12 +781,8 @@ void AudioCaptureCoreAudio::monitorWriterLoop()
         {
             // Drop everything queued in the tap so the next write
             // restarts from the producer's newest samples.
-            const size_t available = m_monitorTap ? m_monitorTap->available() : 0;
-            if (available > 0)
-            {
-                drain.resize(available);
-                m_monitorTap->pull(drain.data(), available);
-            }
+            const size_t available =
+                m_monitorTap ? m_monitorTap->discard(m_monitorTap->available()) : 0;
             LOG_INFO("AudioCaptureCoreAudio: monitor resync (dropped " +
                      std::to_string(available / (m_channels ? m_channels : 1)) +
                      " queued frames)");
@@ -762,8 +762,9 @@ void AudioCapturePulse::startMonitorPlayback()
 {
     // ~2 s tap slack matches the other taps. The two hardware clocks
     // (capture device + default sink) drift in ppm over long sessions,
-    // accumulating in this tap; the bus drop-oldest at the cap is the
-    // current safety net. Smooth sample-rate-matching is a follow-up.
+    // accumulating in this tap; MonitorPlayback's resync (discard) plus
+    // the tap dropping pushes at the cap are the current safety net.
+    // Smooth sample-rate-matching is a follow-up.
     const size_t monitorCapacity =
         static_cast<size_t>(m_sampleRate) * m_channels * 2;
     auto monitorTap = m_bus->createTap(monitorCapacity);
@@ -85,7 +85,6 @@ void MonitorPlayback::writerLoop()
 {
     constexpr size_t kChunkSamples = 882 * 2;
     std::vector<int16_t> chunk(kChunkSamples);
-    std::vector<int16_t> drain;
 
     while (m_running.load())
     {
@@ -94,12 +93,7 @@ void MonitorPlayback::writerLoop()
             // Toss everything currently queued in the tap so we
             // restart from the newest samples the producer is
             // pushing right now.
-            const size_t available = m_tap->available();
-            if (available > 0)
-            {
-                drain.resize(available);
-                m_tap->pull(drain.data(), available);
-            }
+            const size_t available = m_tap->discard(m_tap->available());
             // Discard what PulseAudio already has buffered for
             // playback. After this the stream is empty and the next
             // pa_simple_write below will refill from "now".
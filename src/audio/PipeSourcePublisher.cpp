@@ -30,7 +30,7 @@ bool PipeSourcePublisher::start(const std::string &fifoPath,
 
     // O_NONBLOCK on the write end so the writer thread never blocks on
     // a slow downstream PulseAudio consumer; we drop samples instead
-    // (drop-oldest is also what AudioBus::Tap does once at capacity).
+    // (AudioBus::Tap likewise drops whole chunks once at capacity).
     m_fd = ::open(fifoPath.c_str(), O_WRONLY | O_NONBLOCK);
     if (m_fd < 0)
     {
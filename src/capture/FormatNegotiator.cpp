@@ -17,10 +17,27 @@ std::string FormatNegotiator::fourccToString(uint32_t fourcc)
 }
 
 uint32_t FormatNegotiator::chooseDefaultV4L2Format(bool yuyvSupported, bool mjpegSupported,
-                                                   uint32_t deviceCurrentFormat, bool &ok)
+                                                   uint32_t deviceCurrentFormat, bool &ok,
+                                                   uint32_t preferredFormat)
 {
     ok = true;
 
+    if (preferredFormat == FOURCC_MJPG && mjpegSupported)
+    {
+        LOG_INFO("MJPG requested and supported, using MJPG");
+        return FOURCC_MJPG;
+    }
+    if (preferredFormat == FOURCC_YUYV && yuyvSupported)
+    {
+        LOG_INFO("YUYV requested and supported, using YUYV");
+        return FOURCC_YUYV;
+    }
+    if (preferredFormat != 0)
+    {
+        LOG_WARN("Requested format '" + fourccToString(preferredFormat) +
+                 "' not supported by the device, choosing automatically");
+    }
+
     if (yuyvSupported)
     {
         LOG_INFO("YUYV supported, using YUYV as default format");
@@ -34,7 +51,7 @@ uint32_t FormatNegotiator::chooseDefaultV4L2Format(bool yuyvSupported, bool mjpe
         // Se ainda não temos formato, tentar MJPG como último recurso
         if (mjpegSupported)
         {
-            LOG_WARN("YUYV not supported, falling back to MJPG (not fully supported yet)");
+            LOG_INFO("YUYV not supported, falling back to MJPG (decoded by MJPEGDecodePool)");
             return FOURCC_MJPG;
         }
         LOG_ERROR("Nenhum formato suportado encontrado");
@@ -43,7 +60,7 @@ uint32_t FormatNegotiator::chooseDefaultV4L2Format(bool yuyvSupported, bool mjpe
     }
     if (pixelFormat == FOURCC_MJPG)
     {
-        LOG_WARN("Device is using MJPG but YUYV is unavailable. MJPG is not fully supported.");
+        LOG_INFO("Device is using MJPG (YUYV unavailable); frames are decoded by MJPEGDecodePool.");
     }
     return pixelFormat;
 }
@@ -36,10 +36,13 @@ public:
     // Inputs are what the backend learned by enumerating the device:
     //   yuyvSupported / mjpegSupported — VIDIOC_ENUM_FMT results
     //   deviceCurrentFormat            — the device's current pixelformat (may be 0)
+    //   preferredFormat                — user choice (--v4l2-format); 0 = auto.
+    //                                    Ignored (with a warning) when unsupported.
     // Returns the chosen fourcc. Sets ok=false (and logs an error) when no usable
     // format exists. Emits the same INFO/WARN messages as the original inline code.
     static uint32_t chooseDefaultV4L2Format(bool yuyvSupported, bool mjpegSupported,
-                                            uint32_t deviceCurrentFormat, bool &ok);
+                                            uint32_t deviceCurrentFormat, bool &ok,
+                                            uint32_t preferredFormat = 0);
 
     // After the driver applied the format: returns true when `actual` is an
     // acceptable result for `requested`. When they differ it logs a warning, and
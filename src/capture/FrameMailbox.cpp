@@ -0,0 +1,37 @@
+#include "FrameMailbox.h"
+
+void FrameMailbox::publish()
+{
+    const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_write | kFresh), std::memory_order_acq_rel);
+    m_write = previous & kIndexMask;
+    m_published.fetch_add(1, std::memory_order_relaxed);
+    if (previous & kFresh)
+    {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool FrameMailbox::take(Frame &frame)
+{
+    if (!(m_middle.load(std::memory_order_acquire) & kFresh))
+    {
+        return false;
+    }
+    const uint8_t previous = m_middle.exchange(m_read, std::memory_order_acq_rel);
+    m_read = previous & kIndexMask;
+
+    Slot &slot = m_slots[m_read];
+    frame.data = slot.data.data();
+    frame.size = slot.size;
+    frame.width = slot.width;
+    frame.height = slot.height;
+    frame.format = slot.format;
+    return slot.size > 0;
+}
+
+void FrameMailbox::reset()
+{
+    m_write = 0;
+    m_read = 1;
+    m_middle.store(2, std::memory_order_release);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "IVideoCapture.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * FrameMailbox - lock-free "latest frame wins" triple buffer
+ *
+ * Sits between a capture thread (one producer) and the render thread (one
+ * consumer). The producer fills its private write slot and publish()es it;
+ * the consumer take()s the newest published slot. Neither side ever waits
+ * for the other: a frame published before the previous one was taken
+ * replaces it (counted in dropped()), and take() returns false when
+ * nothing new arrived.
+ *
+ * The three slots rotate through an atomic "middle" index, so the slot the
+ * consumer holds is never written until its next take() — unlike handing
+ * out a pointer into a buffer the producer keeps overwriting.
+ */
+class FrameMailbox
+{
+public:
+    struct Slot
+    {
+        std::vector<uint8_t> data; // capacity reused between frames
+        size_t size = 0;           // valid bytes in data
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t format = 0;
+    };
+
+    // Producer: slot to fill; owned by the producer until publish().
+    Slot &writeSlot() { return m_slots[m_write]; }
+    void publish();
+
+    // Consumer: newest published frame, if one arrived since the last
+    // take(). frame.data stays valid until the next take().
+    bool take(Frame &frame);
+
+    // Forget any published frame. Only while the producer is stopped.
+    void reset();
+
+    uint64_t published() const { return m_published.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4; // middle holds an untaken frame
+
+    Slot m_slots[3];
+    uint8_t m_write = 0; // producer only
+    uint8_t m_read = 1;  // consumer only
+    std::atomic<uint8_t> m_middle{2};
+
+    std::atomic<uint64_t> m_published{0};
+    std::atomic<uint64_t> m_dropped{0};
+};
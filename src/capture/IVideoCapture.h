@@ -22,6 +22,22 @@ struct Frame
 static constexpr uint32_t RC_PIXFMT_BGRA = 0xB07A0001u;
 static constexpr uint32_t RC_PIXFMT_RGBA = 0xB07A0002u;
 
+// Decoded MJPEG capture: three tightly packed 8-bit planes (Y, then U,
+// then V, no row padding), converted to RGB by FrameProcessor on the GPU.
+// The low bits describe the layout so no side channel is needed:
+// chroma subsampling as log2 shifts, limited range and BT.709 flags.
+static constexpr uint32_t RC_PIXFMT_YUV_PLANAR = 0xB07A0100u;
+static constexpr uint32_t RC_PIXFMT_YUV_CHROMA_W_SHIFT = 0x1u; // 4:2:x horizontal
+static constexpr uint32_t RC_PIXFMT_YUV_CHROMA_H_SHIFT = 0x2u; // 4:2:0 / 4:4:0 vertical
+static constexpr uint32_t RC_PIXFMT_YUV_LIMITED_RANGE = 0x4u;  // 16–235 instead of JPEG 0–255
+static constexpr uint32_t RC_PIXFMT_YUV_BT709 = 0x8u;          // else BT.601
+static constexpr uint32_t RC_PIXFMT_YUV_FLAGS_MASK = 0xFu;
+
+inline bool isPlanarYuvPixelFormat(uint32_t format)
+{
+    return (format & ~RC_PIXFMT_YUV_FLAGS_MASK) == RC_PIXFMT_YUV_PLANAR;
+}
+
 struct DeviceInfo
 {
     std::string id;        // Device identifier (path, GUID, etc.)
@@ -113,6 +129,14 @@ public:
         return 0;
     }
 
+    /**
+     * Pixel format to pick when setFormat() is called with pixelFormat = 0
+     * (the "auto" path every caller uses). Only V4L2 honours it — lets the
+     * user choose MJPG over YUYV on USB 2.0 dongles that only reach
+     * 1080p60 compressed. 0 restores the backend's own default.
+     */
+    virtual void setPreferredPixelFormat(uint32_t fourcc) { (void)fourcc; }
+
     // AVFoundation-specific extensions. Default no-op so V4L2,
     // DirectShow and Remote captures don't need to implement them.
     virtual std::vector<AVFoundationFormatInfo> listFormats(const std::string &deviceId = "")
@@ -0,0 +1,84 @@
+#include "JitterBuffer.h"
+#include <algorithm>
+
+void JitterBuffer::reset()
+{
+    m_windowCount = 0;
+    m_windowPos = 0;
+    m_sinceEstimate = 0;
+    m_haveLast = false;
+    m_rate.store(1.0f, std::memory_order_relaxed);
+}
+
+int64_t JitterBuffer::schedule(int64_t arrivalWallUs, int64_t scheduledWallUs, int64_t frameIntervalUs)
+{
+    m_received.fetch_add(1, std::memory_order_relaxed);
+
+    m_lateness[m_windowPos] = arrivalWallUs - scheduledWallUs;
+    m_windowPos = (m_windowPos + 1) % kWindow;
+    if (m_windowCount < kWindow)
+    {
+        m_windowCount++;
+    }
+
+    // Re-estimate every kEstimateEvery frames, and on every frame while
+    // the window is still filling after a reset.
+    if (++m_sinceEstimate >= kEstimateEvery || m_windowCount < kEstimateEvery)
+    {
+        m_sinceEstimate = 0;
+        int64_t sorted[kWindow];
+        std::copy(m_lateness, m_lateness + m_windowCount, sorted);
+        const size_t p95 = (m_windowCount * 95) / 100;
+        std::nth_element(sorted, sorted + p95, sorted + m_windowCount);
+        const int64_t jitter = sorted[p95];
+        m_jitterUs.store(jitter, std::memory_order_relaxed);
+        m_targetDelayUs.store(std::min(std::max<int64_t>(jitter + frameIntervalUs / 2, 0), kMaxDelayUs),
+                              std::memory_order_relaxed);
+    }
+
+    // Media time this frame covers; bounds how far the delay may move.
+    int64_t stepUs = frameIntervalUs;
+    if (m_haveLast && scheduledWallUs > m_lastScheduledUs)
+    {
+        stepUs = std::min(scheduledWallUs - m_lastScheduledUs, 4 * frameIntervalUs);
+    }
+    m_lastScheduledUs = scheduledWallUs;
+    m_haveLast = true;
+
+    int64_t delay = m_delayUs.load(std::memory_order_relaxed);
+    const int64_t target = m_targetDelayUs.load(std::memory_order_relaxed);
+    int64_t change = 0;
+    if (target > delay)
+    {
+        change = std::min(target - delay, static_cast<int64_t>(static_cast<double>(stepUs) * kMaxGrowRate));
+    }
+    else if (target < delay)
+    {
+        change = -std::min(delay - target, static_cast<int64_t>(static_cast<double>(stepUs) * kMaxShrinkRate));
+    }
+    delay += change;
+    m_delayUs.store(delay, std::memory_order_relaxed);
+    // A frame covering stepUs of media is on screen for stepUs + change.
+    m_rate.store(static_cast<float>(stepUs) / static_cast<float>(stepUs + change), std::memory_order_relaxed);
+
+    const int64_t playoutWallUs = scheduledWallUs + delay;
+    if (playoutWallUs < arrivalWallUs)
+    {
+        m_late.fetch_add(1, std::memory_order_relaxed);
+    }
+    return playoutWallUs;
+}
+
+JitterBufferStats JitterBuffer::stats() const
+{
+    JitterBufferStats s;
+    s.delayUs = m_delayUs.load(std::memory_order_relaxed);
+    s.targetDelayUs = m_targetDelayUs.load(std::memory_order_relaxed);
+    s.jitterUs = m_jitterUs.load(std::memory_order_relaxed);
+    s.rate = m_rate.load(std::memory_order_relaxed);
+    s.framesReceived = m_received.load(std::memory_order_relaxed);
+    s.framesLate = m_late.load(std::memory_order_relaxed);
+    s.framesDropped = m_dropped.load(std::memory_order_relaxed);
+    s.framesSkipped = m_skipped.load(std::memory_order_relaxed);
+    return s;
+}
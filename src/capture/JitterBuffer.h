@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Snapshot of the remote source's playout buffer, for the UI / API.
+struct JitterBufferStats
+{
+    int64_t  delayUs        = 0;    // playout delay currently added to the PTS schedule
+    int64_t  targetDelayUs  = 0;    // where delayUs is being steered
+    int64_t  jitterUs       = 0;    // 95th-percentile arrival lateness over the window
+    float    rate           = 1.0f; // playback-rate correction in effect (1.0 = none)
+    uint32_t depthFrames    = 0;    // frames queued, waiting for their playout time
+    int64_t  depthUs        = 0;    // playout time of the newest queued frame minus now
+    uint64_t framesReceived = 0;
+    uint64_t framesLate     = 0;    // arrived after their playout time
+    uint64_t framesDropped  = 0;    // queue overflow (consumer stalled)
+    uint64_t framesSkipped  = 0;    // connect backlog skipped to reach the live edge
+};
+
+/**
+ * JitterBuffer - adaptive playout delay for VideoCaptureRemote
+ *
+ * Every decoded video frame has a scheduled wall time from the stream
+ * anchor (anchor + PTS offset). Its lateness is arrival minus that
+ * schedule; the 95th percentile of the last kWindow latenesses, plus half
+ * a frame, is the delay the queue needs so frames are there before they're
+ * due — a few ms on a LAN, a few hundred through a tunnel. Frames are then
+ * played at schedule + delayUs().
+ *
+ * The delay never jumps: per frame it moves toward the target by at most
+ * kMaxGrowRate / kMaxShrinkRate of the frame's duration, i.e. playback
+ * runs up to 10% slower while the buffer deepens and up to 5% faster while
+ * it drains. Nothing is dropped to shed depth.
+ *
+ * schedule() and the count*() calls run on the decode thread; delayUs()
+ * and stats() may be read from any thread.
+ */
+class JitterBuffer
+{
+public:
+    static constexpr int64_t kMaxDelayUs = 500'000;
+
+    // New stream anchor: forget the lateness history (it was measured
+    // against the old anchor). The current delay is kept — the network
+    // that needed it is probably still the same one.
+    void reset();
+
+    // Returns the playout wall time for a frame scheduled at
+    // scheduledWallUs (anchor + PTS offset) that arrived at arrivalWallUs.
+    int64_t schedule(int64_t arrivalWallUs, int64_t scheduledWallUs, int64_t frameIntervalUs);
+
+    void countDropped() { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+    void countSkipped() { m_skipped.fetch_add(1, std::memory_order_relaxed); }
+
+    int64_t delayUs() const { return m_delayUs.load(std::memory_order_relaxed); }
+    // depthFrames / depthUs are left 0 — the queue lives in the caller.
+    JitterBufferStats stats() const;
+
+private:
+    static constexpr size_t kWindow = 256;       // ~4 s at 60 fps
+    static constexpr size_t kEstimateEvery = 16; // frames between percentile updates
+    static constexpr double kMaxGrowRate = 0.10;
+    static constexpr double kMaxShrinkRate = 0.05;
+
+    // Decode thread only.
+    int64_t m_lateness[kWindow] = {};
+    size_t  m_windowCount = 0;
+    size_t  m_windowPos = 0;
+    size_t  m_sinceEstimate = 0;
+    int64_t m_lastScheduledUs = 0;
+    bool    m_haveLast = false;
+
+    std::atomic<int64_t>  m_delayUs{0};
+    std::atomic<int64_t>  m_targetDelayUs{0};
+    std::atomic<int64_t>  m_jitterUs{0};
+    std::atomic<float>    m_rate{1.0f};
+    std::atomic<uint64_t> m_received{0};
+    std::atomic<uint64_t> m_late{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_skipped{0};
+};
@@ -1,6 +1,8 @@
 #include "VideoCaptureRemote.h"
 #include "../utils/Logger.h"
 #include "../audio/IAudioPlayback.h"
+#include "../renderer/FrameInterpolationPass.h"
+#include "../renderer/YUVRenderPass.h"
 #ifdef __linux__
 #include "../audio/AudioPlaybackPulse.h"
 #elif defined(_WIN32)
@@ -13,21 +15,123 @@ extern "C"
 {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
+#include <libavutil/hwcontext.h>
 #include <libavutil/imgutils.h>
 #include <libavutil/opt.h>
+#include <libavutil/pixdesc.h>
 #include <libswscale/swscale.h>
 #include <libswresample/swresample.h>
 }
 
 #include "../utils/FFmpegCompat.h"
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 
+namespace
+{
+// What YUVRenderPass takes as-is: three 8-bit planes, or NV12 (what
+// VAAPI downloads to and many SoC decoders emit).
+bool isUploadableYuv8(AVPixelFormat fmt)
+{
+    if (fmt == AV_PIX_FMT_NV12)
+    {
+        return true;
+    }
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    return desc && desc->nb_components == 3 && (desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
+           !(desc->flags & AV_PIX_FMT_FLAG_RGB) && desc->comp[0].depth == 8;
+}
+
+// Deep copy into a fresh buffer, for decoders whose output buffers come
+// from a small fixed pool that a jitter-buffer-deep queue would exhaust.
+AVFrame *copyFrame(const AVFrame *src)
+{
+    AVFrame *dst = av_frame_alloc();
+    if (!dst)
+    {
+        return nullptr;
+    }
+    dst->format = src->format;
+    dst->width = src->width;
+    dst->height = src->height;
+    if (av_frame_get_buffer(dst, 0) < 0 || av_frame_copy(dst, src) < 0 || av_frame_copy_props(dst, src) < 0)
+    {
+        av_frame_free(&dst);
+    }
+    return dst;
+}
+
+// get_format for the VAAPI decoder: surfaces when the driver can decode
+// this profile, else libavcodec's own software path (first non-hwaccel
+// format) — no reconnect needed for that case.
+AVPixelFormat pickVaapiFormat(AVCodecContext *, const AVPixelFormat *formats)
+{
+    for (const AVPixelFormat *p = formats; *p != AV_PIX_FMT_NONE; ++p)
+    {
+        if (*p == AV_PIX_FMT_VAAPI)
+        {
+            return *p;
+        }
+    }
+    for (const AVPixelFormat *p = formats; *p != AV_PIX_FMT_NONE; ++p)
+    {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(*p);
+        if (desc && !(desc->flags & AV_PIX_FMT_FLAG_HWACCEL))
+        {
+            LOG_WARN("VideoCaptureRemote: VAAPI can't decode this stream — libavcodec software path");
+            return *p;
+        }
+    }
+    return AV_PIX_FMT_NONE;
+}
+
+// Planes of a held frame, scaled to (outW, outH) and flipped so the
+// texture has the same bottom-up orientation the RGB24 path delivers.
+bool planesFromFrame(const AVFrame *image, uint32_t outW, uint32_t outH, YUVRenderPass::Planes &planes)
+{
+    const AVPixelFormat fmt = static_cast<AVPixelFormat>(image->format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    if (!desc)
+    {
+        return false;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        planes.data[i] = image->data[i];
+        planes.linesize[i] = image->linesize[i];
+    }
+    planes.interleavedChroma = (fmt == AV_PIX_FMT_NV12);
+    planes.width = static_cast<uint32_t>(image->width);
+    planes.height = static_cast<uint32_t>(image->height);
+    // AV_CEIL_RSHIFT negates its operand — must be signed.
+    planes.chromaWidth = static_cast<uint32_t>(AV_CEIL_RSHIFT(image->width, desc->log2_chroma_w));
+    planes.chromaHeight = static_cast<uint32_t>(AV_CEIL_RSHIFT(image->height, desc->log2_chroma_h));
+    planes.fullRange = fmt == AV_PIX_FMT_YUVJ420P || fmt == AV_PIX_FMT_YUVJ422P ||
+                       fmt == AV_PIX_FMT_YUVJ444P || image->color_range == AVCOL_RANGE_JPEG;
+    // The host encodes BT.601 (libswscale's / RGBToYUVPass's default) and
+    // doesn't tag it; the old sws RGB path assumed 601 too.
+    planes.matrix = (image->colorspace == AVCOL_SPC_BT709) ? YUVRenderPass::ColorMatrix::BT709
+                                                           : YUVRenderPass::ColorMatrix::BT601;
+    planes.outputWidth = outW;
+    planes.outputHeight = outH;
+    planes.flipVertical = true;
+    return true;
+}
+} // namespace
+
 VideoCaptureRemote::VideoCaptureRemote() = default;
 
 VideoCaptureRemote::~VideoCaptureRemote()
 {
     close();
+    if (m_rgbSwsCtx)
+    {
+        sws_freeContext(m_rgbSwsCtx);
+        m_rgbSwsCtx = nullptr;
+    }
+    // m_gpuPass releases its GL objects here — captures are destroyed on
+    // the GL thread, before the window goes.
 }
 
 bool VideoCaptureRemote::open(const std::string &url)
@@ -68,6 +172,7 @@ bool VideoCaptureRemote::open(const std::string &url)
 
     m_everReceivedFrame.store(false);
     m_consecutiveReconnectFailures.store(0);
+    m_hwDecodeFailed.store(false);
     m_hostLikelyOffline.store(false);
     // Arm a clean abort state once here, NOT per-initDecoder pass. The
     // decode thread now runs the (blocking) avformat_open_input itself
@@ -220,27 +325,8 @@ bool VideoCaptureRemote::initDecoder()
                  " for video stream — opening anyway; size resolves "
                  "from the first decoded keyframe");
     }
-    const AVCodec *codec = avcodec_find_decoder(codecPar->codec_id);
-    if (!codec)
+    if (!openVideoDecoder(codecPar))
     {
-        LOG_ERROR("VideoCaptureRemote: no decoder for codec id " + std::to_string(codecPar->codec_id));
-        return false;
-    }
-
-    m_codecCtx = avcodec_alloc_context3(codec);
-    if (!m_codecCtx)
-    {
-        LOG_ERROR("VideoCaptureRemote: avcodec_alloc_context3 failed");
-        return false;
-    }
-    if (avcodec_parameters_to_context(m_codecCtx, codecPar) < 0)
-    {
-        LOG_ERROR("VideoCaptureRemote: avcodec_parameters_to_context failed");
-        return false;
-    }
-    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
-    {
-        LOG_ERROR("VideoCaptureRemote: avcodec_open2 failed");
         return false;
     }
 
@@ -249,7 +335,8 @@ bool VideoCaptureRemote::initDecoder()
     m_pixelFormat = 0; // signals "RGB24" to FrameProcessor
 
     LOG_INFO("VideoCaptureRemote: decoder ready — " + std::to_string(m_width) + "x" + std::to_string(m_height) +
-             " codec=" + std::string(codec->name));
+             " codec=" + std::string(m_codecCtx->codec->name) +
+             (m_decodeBackend == DecodeBackend::VAAPI ? " (VAAPI)" : ""));
 
     // Audio decoder + playback. The /raw stream always carries audio
     // (see HTTPTSStreamer::pushAudio) so we expect to find an audio
@@ -310,6 +397,188 @@ bool VideoCaptureRemote::initDecoder()
     return true;
 }
 
+VideoCaptureRemote::HwDecodeMode VideoCaptureRemote::hwDecodeModeFromString(const std::string &mode)
+{
+    if (mode == "vaapi") return HwDecodeMode::VAAPI;
+    if (mode == "v4l2m2m") return HwDecodeMode::V4L2M2M;
+    if (mode == "off") return HwDecodeMode::Off;
+    return HwDecodeMode::Auto;
+}
+
+bool VideoCaptureRemote::openVideoDecoder(const AVCodecParameters *codecPar)
+{
+    const HwDecodeMode mode = m_hwDecodeFailed.load() ? HwDecodeMode::Off : m_hwDecodeMode.load();
+    // Both backends are Linux-only; elsewhere Auto goes straight to
+    // software instead of logging two failed probes per connect.
+#ifdef __linux__
+    if (mode == HwDecodeMode::Auto || mode == HwDecodeMode::VAAPI)
+    {
+        if (openVaapiDecoder(codecPar))
+        {
+            return true;
+        }
+        freeVideoDecoder();
+    }
+    if (mode == HwDecodeMode::Auto || mode == HwDecodeMode::V4L2M2M)
+    {
+        if (openV4l2M2mDecoder(codecPar))
+        {
+            return true;
+        }
+        freeVideoDecoder();
+    }
+#endif
+    if (mode == HwDecodeMode::VAAPI || mode == HwDecodeMode::V4L2M2M)
+    {
+        LOG_WARN("VideoCaptureRemote: requested hardware decoder unavailable — using software");
+    }
+    return openSoftwareDecoder(codecPar);
+}
+
+bool VideoCaptureRemote::allocVideoCodecContext(const AVCodec *codec, const AVCodecParameters *codecPar)
+{
+    m_codecCtx = avcodec_alloc_context3(codec);
+    if (!m_codecCtx)
+    {
+        LOG_ERROR("VideoCaptureRemote: avcodec_alloc_context3 failed");
+        return false;
+    }
+    if (avcodec_parameters_to_context(m_codecCtx, codecPar) < 0)
+    {
+        LOG_ERROR("VideoCaptureRemote: avcodec_parameters_to_context failed");
+        return false;
+    }
+    return true;
+}
+
+bool VideoCaptureRemote::openVaapiDecoder(const AVCodecParameters *codecPar)
+{
+    const AVCodec *codec = avcodec_find_decoder(codecPar->codec_id);
+    if (!codec)
+    {
+        return false;
+    }
+    bool supported = false;
+    for (int i = 0;; ++i)
+    {
+        const AVCodecHWConfig *config = avcodec_get_hw_config(codec, i);
+        if (!config)
+        {
+            break;
+        }
+        if (config->device_type == AV_HWDEVICE_TYPE_VAAPI &&
+            (config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX))
+        {
+            supported = true;
+            break;
+        }
+    }
+    if (!supported)
+    {
+        return false;
+    }
+
+    // Default device (first DRM render node). Fails fast where there's no
+    // VA driver — e.g. a Pi, which then gets V4L2 M2M.
+    int rc = av_hwdevice_ctx_create(&m_hwDeviceCtx, AV_HWDEVICE_TYPE_VAAPI, nullptr, nullptr, 0);
+    if (rc < 0)
+    {
+        char errBuf[128] = {0};
+        av_strerror(rc, errBuf, sizeof(errBuf));
+        LOG_INFO(std::string("VideoCaptureRemote: no VAAPI device (") + errBuf + ")");
+        m_hwDeviceCtx = nullptr;
+        return false;
+    }
+    if (!allocVideoCodecContext(codec, codecPar))
+    {
+        return false;
+    }
+    m_codecCtx->hw_device_ctx = av_buffer_ref(m_hwDeviceCtx);
+    m_codecCtx->get_format = pickVaapiFormat;
+    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+    {
+        LOG_WARN("VideoCaptureRemote: avcodec_open2 failed with VAAPI");
+        return false;
+    }
+    m_decodeBackend = DecodeBackend::VAAPI;
+    return true;
+}
+
+bool VideoCaptureRemote::openV4l2M2mDecoder(const AVCodecParameters *codecPar)
+{
+    // Stateful M2M decoders are separate libavcodec decoders
+    // (h264_v4l2m2m, hevc_v4l2m2m, ...); avcodec_open2 fails when no
+    // /dev/video* node handles the codec.
+    const std::string name = std::string(avcodec_get_name(codecPar->codec_id)) + "_v4l2m2m";
+    const AVCodec *codec = avcodec_find_decoder_by_name(name.c_str());
+    if (!codec)
+    {
+        return false;
+    }
+    if (!allocVideoCodecContext(codec, codecPar))
+    {
+        return false;
+    }
+    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+    {
+        LOG_INFO("VideoCaptureRemote: " + name + " unavailable");
+        return false;
+    }
+    m_decodeBackend = DecodeBackend::V4L2M2M;
+    return true;
+}
+
+bool VideoCaptureRemote::openSoftwareDecoder(const AVCodecParameters *codecPar)
+{
+    const AVCodec *codec = avcodec_find_decoder(codecPar->codec_id);
+    if (!codec)
+    {
+        LOG_ERROR("VideoCaptureRemote: no decoder for codec id " + std::to_string(codecPar->codec_id));
+        return false;
+    }
+    if (!allocVideoCodecContext(codec, codecPar))
+    {
+        return false;
+    }
+    // Frame + slice threading over every core. Frame threading delays
+    // output by thread_count - 1 frames, but the delay is constant so the
+    // PTS anchor absorbs it; without it 1080p60 H.264 doesn't keep up on
+    // a Pi-class CPU.
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    m_codecCtx->thread_count = static_cast<int>(std::min(cores, 16u));
+    m_codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+    {
+        LOG_ERROR("VideoCaptureRemote: avcodec_open2 failed");
+        return false;
+    }
+    m_decodeBackend = DecodeBackend::Software;
+    LOG_INFO("VideoCaptureRemote: software decode, " + std::to_string(m_codecCtx->thread_count) + " threads");
+    return true;
+}
+
+void VideoCaptureRemote::freeVideoDecoder()
+{
+    if (m_codecCtx)
+    {
+        avcodec_free_context(&m_codecCtx);
+        m_codecCtx = nullptr;
+    }
+    if (m_hwDeviceCtx)
+    {
+        av_buffer_unref(&m_hwDeviceCtx);
+    }
+    m_decodeBackend = DecodeBackend::Software;
+    m_hwProducedFrame = false;
+}
+
+void VideoCaptureRemote::fallBackToSoftwareDecode(const std::string &reason)
+{
+    LOG_WARN("VideoCaptureRemote: hardware decode failed (" + reason + ") — reconnecting with software decode");
+    m_hwDecodeFailed.store(true);
+    cleanupDecoder();
+}
+
 bool VideoCaptureRemote::ensureAudioOutput()
 {
     if (m_audioPlayback) return true;       // already up
@@ -395,11 +664,7 @@ void VideoCaptureRemote::cleanupDecoder()
         sws_freeContext(m_swsCtx);
         m_swsCtx = nullptr;
     }
-    if (m_codecCtx)
-    {
-        avcodec_free_context(&m_codecCtx);
-        m_codecCtx = nullptr;
-    }
+    freeVideoDecoder();
     if (m_formatCtx)
     {
         avformat_close_input(&m_formatCtx);
@@ -503,7 +768,7 @@ void VideoCaptureRemote::setInterpolationMode(InterpolationMode mode)
     // running leaves the previous mode's last frame as a static ghost
     // ("o primeiro frame que chegou está estático na frente" — exactly
     // that). Drop any queued frames and forget the last consumed one so
-    // the next captureLatestFrame call rebuilds state from scratch in
+    // the next refresh rebuilds state from scratch in
     // the new mode. m_streamAnchored is reset too, so the decode thread
     // re-establishes the wall-clock anchor on the next decoded frame —
     // the previous mode's anchor may have drifted relative to where the
@@ -512,7 +777,6 @@ void VideoCaptureRemote::setInterpolationMode(InterpolationMode mode)
         std::lock_guard<std::mutex> lock(m_frameMutex);
         m_frameQueue.clear();
         m_lastConsumed = QueuedFrame{};
-        m_blendBuffer.clear();
     }
     m_streamAnchored.store(false);
     m_firstPtsUs.store(0);
@@ -532,6 +796,20 @@ void VideoCaptureRemote::setAudioVolume(float linear)
     m_audioVolume.store(linear, std::memory_order_relaxed);
 }
 
+JitterBufferStats VideoCaptureRemote::getJitterStats()
+{
+    JitterBufferStats stats = m_jitter.stats();
+    const int64_t nowWallUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                  std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::lock_guard<std::mutex> lock(m_frameMutex);
+    stats.depthFrames = static_cast<uint32_t>(m_frameQueue.size());
+    if (!m_frameQueue.empty())
+    {
+        stats.depthUs = std::max<int64_t>(m_frameQueue.back().targetWallUs - nowWallUs, 0);
+    }
+    return stats;
+}
+
 void VideoCaptureRemote::setTargetResolution(uint32_t width, uint32_t height)
 {
     // Atomic stores — picked up by the decode thread on the next frame.
@@ -546,6 +824,105 @@ bool VideoCaptureRemote::captureFrame(Frame &frame)
 }
 
 bool VideoCaptureRemote::captureLatestFrame(Frame &frame)
+{
+    // CPU fallback — only reached when getGpuTexture() returned 0, i.e.
+    // FrameInterpolationPass couldn't initialise. Shows the temporally
+    // closer endpoint in Linear mode rather than blending on the CPU.
+    Presentation p;
+    if (!pickPresentation(p))
+    {
+        return false;
+    }
+    const QueuedFrame &shown = (p.next.image && p.weight >= 0.5f) ? p.next : p.current;
+    if (shown.id != m_rgbFrameId)
+    {
+        const AVFrame *image = shown.image.get();
+        m_rgbSwsCtx = sws_getCachedContext(m_rgbSwsCtx,
+                                           image->width, image->height,
+                                           static_cast<AVPixelFormat>(image->format),
+                                           static_cast<int>(shown.width), static_cast<int>(shown.height),
+                                           AV_PIX_FMT_RGB24, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!m_rgbSwsCtx)
+        {
+            LOG_ERROR("VideoCaptureRemote::captureLatestFrame — sws_getCachedContext failed");
+            return false;
+        }
+        const size_t rowBytes = static_cast<size_t>(shown.width) * 3;
+        m_rgbBuffer.resize(rowBytes * shown.height);
+        // Write rows in reverse (bottom-up) so the resulting RGB buffer
+        // matches the orientation the rest of the capture pipeline
+        // expects from V4L2 / DirectShow sources — without this, the
+        // image renders upside-down on screen.
+        uint8_t *dstSlices[1] = { m_rgbBuffer.data() + (shown.height - 1) * rowBytes };
+        int dstStrides[1]     = { -static_cast<int>(rowBytes) };
+        sws_scale(m_rgbSwsCtx, image->data, image->linesize, 0, image->height, dstSlices, dstStrides);
+        m_rgbFrameId = shown.id;
+    }
+
+    frame.data   = m_rgbBuffer.data();
+    frame.size   = m_rgbBuffer.size();
+    frame.width  = shown.width;
+    frame.height = shown.height;
+    frame.format = 0; // RGB24 — FrameProcessor's non-YUYV path
+    return true;
+}
+
+unsigned int VideoCaptureRemote::getGpuTexture(uint32_t &width, uint32_t &height)
+{
+    if (m_gpuUnavailable)
+    {
+        return 0;
+    }
+    Presentation p;
+    if (!pickPresentation(p))
+    {
+        return 0;
+    }
+    if (!m_gpuPass)
+    {
+        m_gpuPass = std::make_unique<FrameInterpolationPass>();
+    }
+    if (!m_gpuPass->isInitialized() && !m_gpuPass->init())
+    {
+        LOG_WARN("VideoCaptureRemote: GPU frame interpolation unavailable — falling back to CPU RGB conversion");
+        m_gpuPass.reset();
+        m_gpuUnavailable = true;
+        return 0;
+    }
+
+    // Each stream frame is converted into the ring once; refreshes that
+    // don't bring a new frame only (maybe) re-run the mix draw.
+    auto toTexture = [this](const QueuedFrame &qf) -> GLuint
+    {
+        YUVRenderPass::Planes planes;
+        if (!planesFromFrame(qf.image.get(), qf.width, qf.height, planes))
+        {
+            return 0;
+        }
+        return m_gpuPass->frameTexture(qf.id, planes);
+    };
+    GLuint texture = toTexture(p.current);
+    if (texture == 0)
+    {
+        return 0;
+    }
+    if (p.next.image)
+    {
+        const GLuint nextTexture = toTexture(p.next);
+        const GLuint blended = nextTexture ? m_gpuPass->blend(texture, nextTexture, p.weight,
+                                                              p.current.width, p.current.height)
+                                           : 0;
+        if (blended != 0)
+        {
+            texture = blended;
+        }
+    }
+    width  = p.current.width;
+    height = p.current.height;
+    return texture;
+}
+
+bool VideoCaptureRemote::pickPresentation(Presentation &out)
 {
     std::lock_guard<std::mutex> lock(m_frameMutex);
     // PTS-anchored release with per-refresh linear interpolation. The
@@ -577,11 +954,14 @@ bool VideoCaptureRemote::captureLatestFrame(Frame &frame)
             // audioPtsAbsUs is in the same coordinate the video frame
             // PTS uses (microseconds, stream-origin-relative to 0).
             // Each video frame's targetWallUs was computed as
-            //   m_streamStartWallUs + (frame_pts_us - m_firstPtsUs).
+            //   m_streamStartWallUs + (frame_pts_us - m_firstPtsUs) + delay.
             // The audio-equivalent 'now' in wall-clock units is then
-            //   m_streamStartWallUs + (audio_pts_us - m_firstPtsUs).
+            //   m_streamStartWallUs + (audio_pts_us - m_firstPtsUs) + delay,
+            // so the jitter buffer's delay cancels out and a frame still
+            // goes on screen with its audio. Audio-locked, the sink's own
+            // buffer is what absorbs network jitter.
             const int64_t audioRelUs    = audioPtsAbsUs - m_firstPtsUs.load();
-            const int64_t audioNowWall  = m_streamStartWallUs + audioRelUs;
+            const int64_t audioNowWall  = m_streamStartWallUs + audioRelUs + m_jitter.delayUs();
             // Sanity gate: only let audio drive the video clock if it's
             // within ±500 ms of wall-clock. If the audio clock has run
             // off (pa_simple_get_latency reports stale, the playback
@@ -628,18 +1008,16 @@ bool VideoCaptureRemote::captureLatestFrame(Frame &frame)
         m_frameQueue.pop_front();
         ++m_statConsumed;
     }
-    if (m_lastConsumed.rgb.empty())
+    if (!m_lastConsumed.image)
     {
         return false;
     }
 
-    // Default: hand out the cached frame as-is. The Linear / Nearest
-    // branches below may override with a blended or temporally-closer
-    // frame. Frame.data is non-const uint8_t* in the IVideoCapture
-    // contract; cast away const where we point at a queued frame's
-    // buffer because the downstream FrameProcessor only reads.
-    uint8_t *outData = m_lastConsumed.rgb.data();
-    size_t outSize   = m_lastConsumed.rgb.size();
+    // Default: the cached frame as-is. The Linear / Nearest branches
+    // below may switch to a blend or to the temporally-closer frame.
+    out.current = m_lastConsumed;
+    out.next    = QueuedFrame{};
+    out.weight  = 0.0f;
 
     const InterpolationMode mode = m_interpolationMode.load();
     if (mode != InterpolationMode::Off && !m_frameQueue.empty())
@@ -650,7 +1028,6 @@ bool VideoCaptureRemote::captureLatestFrame(Frame &frame)
         // texture upload path doesn't see a half-resized frame.
         if (next.width == m_lastConsumed.width &&
             next.height == m_lastConsumed.height &&
-            next.rgb.size() == m_lastConsumed.rgb.size() &&
             next.targetWallUs > m_lastConsumed.targetWallUs)
         {
             const int64_t span = next.targetWallUs - m_lastConsumed.targetWallUs;
@@ -660,53 +1037,31 @@ bool VideoCaptureRemote::captureLatestFrame(Frame &frame)
 
             if (mode == InterpolationMode::Linear)
             {
-                // 0..256 fixed-point weight for the *next* frame; the
-                // previous frame gets (256 - tFp). Autovectorises to
-                // AVX2 byte-blend on x86_64.
-                const int tFp     = static_cast<int>((pos * 256) / span);
-                const int oneMinus = 256 - tFp;
-                if (tFp > 0 && tFp < 256)
+                // Weight of the *next* frame; the previous frame gets
+                // (1 - t). The mix itself happens on the GPU.
+                const float t = static_cast<float>(pos) / static_cast<float>(span);
+                if (t > 0.0f && t < 1.0f)
                 {
-                    if (m_blendBuffer.size() != m_lastConsumed.rgb.size())
-                    {
-                        m_blendBuffer.assign(m_lastConsumed.rgb.size(), 0);
-                    }
-                    const uint8_t *a = m_lastConsumed.rgb.data();
-                    const uint8_t *b = next.rgb.data();
-                    uint8_t *o       = m_blendBuffer.data();
-                    const size_t n   = m_blendBuffer.size();
-                    for (size_t i = 0; i < n; ++i)
-                    {
-                        o[i] = static_cast<uint8_t>((a[i] * oneMinus + b[i] * tFp) >> 8);
-                    }
-                    outData = m_blendBuffer.data();
-                    outSize = m_blendBuffer.size();
+                    out.next   = next;
+                    out.weight = t;
                 }
-                else if (tFp >= 256)
+                else if (t >= 1.0f)
                 {
-                    outData = const_cast<uint8_t *>(next.rgb.data());
-                    outSize = next.rgb.size();
+                    out.current = next;
                 }
-                // tFp == 0 → stays on m_lastConsumed.
+                // t == 0 → stays on m_lastConsumed.
             }
             else // InterpolationMode::Nearest
             {
                 // Pick whichever target is closer to now in time.
                 if (pos * 2 >= span)
                 {
-                    outData = const_cast<uint8_t *>(next.rgb.data());
-                    outSize = next.rgb.size();
+                    out.current = next;
                 }
                 // Otherwise stays on m_lastConsumed.
             }
         }
     }
-
-    frame.data   = outData;
-    frame.size   = outSize;
-    frame.width  = m_lastConsumed.width;
-    frame.height = m_lastConsumed.height;
-    frame.format = 0; // RGB24 — FrameProcessor's non-YUYV path
     return true;
 }
 
@@ -733,22 +1088,14 @@ void VideoCaptureRemote::decodeLoop()
 {
     AVPacket *packet = av_packet_alloc();
     AVFrame  *frame  = av_frame_alloc();
-    AVFrame  *rgb    = av_frame_alloc();
-    if (!packet || !frame || !rgb)
+    if (!packet || !frame)
     {
         LOG_ERROR("VideoCaptureRemote::decodeLoop — av_frame_alloc / av_packet_alloc failed");
         if (packet) av_packet_free(&packet);
         if (frame)  av_frame_free(&frame);
-        if (rgb)    av_frame_free(&rgb);
         return;
     }
 
-    // RGB scratch buffer attached to the rgb AVFrame; sized lazily once we
-    // see the first decoded frame, since the source dimensions may differ
-    // from m_codecCtx->width/height after a key-frame parameter set update.
-    int rgbW = 0, rgbH = 0;
-    std::vector<uint8_t> rgbBuf;
-
     while (m_decodeRunning.load())
     {
         // Reconnect path: when the previous av_read_frame tore the
@@ -811,7 +1158,6 @@ void VideoCaptureRemote::decodeLoop()
             // audio and re-arms the drain so we anchor at the live edge
             // instead of ~1 s in the past (#93 stage 1).
             resyncToLive();
-            rgbW = 0; rgbH = 0; rgbBuf.clear();
             // Reconnect succeeded — drop backoff state so the next
             // hiccup starts from the 2 s slot again.
             m_consecutiveReconnectFailures.store(0);
@@ -965,6 +1311,14 @@ void VideoCaptureRemote::decodeLoop()
             if (r == AVERROR(EAGAIN) || r == AVERROR_EOF) break;
             if (r < 0)
             {
+                // A hardware decoder that fails before its first frame
+                // can't handle this stream; once it has decoded, an error
+                // is a stream glitch like any other.
+                if (m_decodeBackend != DecodeBackend::Software && !m_hwProducedFrame)
+                {
+                    fallBackToSoftwareDecode("avcodec_receive_frame");
+                    break;
+                }
                 LOG_WARN("VideoCaptureRemote::decodeLoop — avcodec_receive_frame failed");
                 break;
             }
@@ -984,33 +1338,96 @@ void VideoCaptureRemote::decodeLoop()
             const int dstW = (tgtW32 > 0) ? static_cast<int>(tgtW32) : srcW;
             const int dstH = (tgtH32 > 0) ? static_cast<int>(tgtH32) : srcH;
 
-            // (Re)build the sws context if dimensions or pixfmt changed.
-            const AVPixelFormat srcFmt = static_cast<AVPixelFormat>(frame->format);
-            m_swsCtx = sws_getCachedContext(m_swsCtx,
-                                            srcW, srcH, srcFmt,
-                                            dstW, dstH, AV_PIX_FMT_RGB24,
-                                            SWS_BILINEAR, nullptr, nullptr, nullptr);
-            if (!m_swsCtx)
+            // VAAPI surfaces come down to system memory once (NV12 for
+            // 8-bit streams) — a copy, not a colour conversion.
+            AVFrame *src = frame;
+            AVFrame *downloaded = nullptr;
+            if (frame->hw_frames_ctx)
             {
-                LOG_ERROR("VideoCaptureRemote::decodeLoop — sws_getCachedContext failed");
-                av_frame_unref(frame);
-                continue;
+                downloaded = av_frame_alloc();
+                if (!downloaded || av_hwframe_transfer_data(downloaded, frame, 0) < 0 ||
+                    av_frame_copy_props(downloaded, frame) < 0)
+                {
+                    av_frame_free(&downloaded);
+                    av_frame_unref(frame);
+                    if (!m_hwProducedFrame)
+                    {
+                        fallBackToSoftwareDecode("av_hwframe_transfer_data");
+                        break;
+                    }
+                    LOG_WARN("VideoCaptureRemote::decodeLoop — av_hwframe_transfer_data failed");
+                    continue;
+                }
+                src = downloaded;
             }
-
-            if (dstW != rgbW || dstH != rgbH)
+            if (m_decodeBackend != DecodeBackend::Software)
             {
-                rgbW = dstW;
-                rgbH = dstH;
-                rgbBuf.assign(static_cast<size_t>(dstW) * static_cast<size_t>(dstH) * 3, 0);
+                m_hwProducedFrame = true;
             }
 
-            // Write rows in reverse (bottom-up) so the resulting RGB buffer
-            // matches the orientation the rest of the capture pipeline
-            // expects from V4L2 / DirectShow sources — without this, the
-            // image renders upside-down on screen.
-            uint8_t *dstSlices[1] = { rgbBuf.data() + static_cast<size_t>(dstH - 1) * static_cast<size_t>(dstW) * 3 };
-            int dstStrides[1]     = { -(dstW * 3) };
-            sws_scale(m_swsCtx, frame->data, frame->linesize, 0, srcH, dstSlices, dstStrides);
+            // Keep the decoded planes as they are — no colour conversion
+            // here. The GL thread converts, scales to dstW x dstH and flips
+            // them (getGpuTexture). Software decoder output is held by
+            // reference; V4L2 M2M output is copied, its buffers being a
+            // small pool the decoder needs back. Formats YUVRenderPass
+            // can't take (10-bit, packed) are repacked to YUV420P first;
+            // 8-bit 4:2:0 H.264 never is.
+            const AVPixelFormat srcFmt = static_cast<AVPixelFormat>(src->format);
+            AVFrame *held = nullptr;
+            if (isUploadableYuv8(srcFmt))
+            {
+                if (downloaded)
+                {
+                    held = downloaded;
+                    downloaded = nullptr;
+                }
+                else if (m_decodeBackend == DecodeBackend::V4L2M2M)
+                {
+                    held = copyFrame(src);
+                }
+                else
+                {
+                    held = av_frame_clone(src);
+                }
+            }
+            else
+            {
+                m_swsCtx = sws_getCachedContext(m_swsCtx,
+                                                srcW, srcH, srcFmt,
+                                                srcW, srcH, AV_PIX_FMT_YUV420P,
+                                                SWS_BILINEAR, nullptr, nullptr, nullptr);
+                if (!m_swsCtx)
+                {
+                    LOG_ERROR("VideoCaptureRemote::decodeLoop — sws_getCachedContext failed");
+                    av_frame_free(&downloaded);
+                    av_frame_unref(frame);
+                    continue;
+                }
+                held = av_frame_alloc();
+                if (held)
+                {
+                    held->format = AV_PIX_FMT_YUV420P;
+                    held->width  = srcW;
+                    held->height = srcH;
+                    if (av_frame_get_buffer(held, 0) < 0)
+                    {
+                        av_frame_free(&held);
+                    }
+                    else
+                    {
+                        sws_scale(m_swsCtx, src->data, src->linesize, 0, srcH, held->data, held->linesize);
+                        av_frame_copy_props(held, src);
+                    }
+                }
+            }
+            av_frame_free(&downloaded);
+            if (!held)
+            {
+                LOG_ERROR("VideoCaptureRemote::decodeLoop — failed to hold decoded frame");
+                av_frame_unref(frame);
+                continue;
+            }
+            std::shared_ptr<AVFrame> image(held, [](AVFrame *f) { av_frame_free(&f); });
 
             // Capture the frame's PTS in stream timebase units BEFORE
             // unref'ing. Used together with the per-stream anchor below
@@ -1037,6 +1454,14 @@ void VideoCaptureRemote::decodeLoop()
             // drops as reconnects rather than first-connect failures.
             m_everReceivedFrame.store(true);
 
+            int64_t frameIntervalUs = 16666; // default ~60 fps
+            if (m_formatCtx && m_videoStreamIdx >= 0)
+            {
+                AVRational fr = m_formatCtx->streams[m_videoStreamIdx]->avg_frame_rate;
+                if (fr.num > 0 && fr.den > 0)
+                    frameIntervalUs = static_cast<int64_t>(1e6 * fr.den / fr.num);
+            }
+
             // #93 stage 1 — jump-to-live: drop the connect backlog burst.
             // Frames decoded back-to-back (much faster than the stream's
             // frame interval) are the host's buffered backlog; skip them and
@@ -1045,13 +1470,6 @@ void VideoCaptureRemote::decodeLoop()
             if (m_drainToLive.load())
             {
                 if (m_drainStartWallUs == 0) m_drainStartWallUs = nowWallUs;
-                int64_t frameIntervalUs = 16666; // default ~60 fps
-                if (m_formatCtx && m_videoStreamIdx >= 0)
-                {
-                    AVRational fr = m_formatCtx->streams[m_videoStreamIdx]->avg_frame_rate;
-                    if (fr.num > 0 && fr.den > 0)
-                        frameIntervalUs = static_cast<int64_t>(1e6 * fr.den / fr.num);
-                }
                 const int64_t liveGap = std::max<int64_t>(frameIntervalUs * 6 / 10, 8000);
                 const int64_t gap = (m_lastDecodeWallUs > 0) ? (nowWallUs - m_lastDecodeWallUs) : 0;
                 m_lastDecodeWallUs = nowWallUs;
@@ -1061,6 +1479,7 @@ void VideoCaptureRemote::decodeLoop()
                 {
                     ++m_statProduced;
                     ++m_statDropped; // dropped a backlog frame
+                    m_jitter.countSkipped();
                     continue;        // keep draining; do not enqueue/anchor
                 }
                 m_drainToLive.store(false);
@@ -1084,6 +1503,7 @@ void VideoCaptureRemote::decodeLoop()
                 // can convert its own absolute PTS into the same
                 // stream-origin-relative coordinate system.
                 m_firstPtsUs.store(static_cast<int64_t>(static_cast<double>(framePtsTicks) * m_streamTimebaseSecs * 1e6));
+                m_jitter.reset();
             }
             else
             {
@@ -1091,6 +1511,8 @@ void VideoCaptureRemote::decodeLoop()
                 const int64_t deltaUs    = static_cast<int64_t>(static_cast<double>(deltaTicks) * m_streamTimebaseSecs * 1e6);
                 targetWallUs = m_streamStartWallUs + deltaUs;
                 // Watchdog in both directions: see prior comment for why.
+                // Measured against the schedule before the playout delay,
+                // which is itself capped well under the 500 ms window.
                 if (targetWallUs + 500'000 < nowWallUs ||
                     targetWallUs > nowWallUs + 500'000)
                 {
@@ -1098,19 +1520,23 @@ void VideoCaptureRemote::decodeLoop()
                     m_firstPtsTicks     = framePtsTicks;
                     m_firstPtsUs.store(static_cast<int64_t>(static_cast<double>(framePtsTicks) * m_streamTimebaseSecs * 1e6));
                     targetWallUs        = nowWallUs;
+                    m_jitter.reset();
                 }
             }
-
-            // Push the new frame onto the bounded queue. Drop the oldest
-            // if we've already buffered kMaxQueued — keeps latency bounded
-            // while absorbing the TCP / decoder bursts that would
-            // otherwise show up as visible stuttering with a single-slot
-            // buffer.
+            // Adaptive playout delay on top of the PTS schedule — see
+            // JitterBuffer. This is what the queue below holds frames for.
+            targetWallUs = m_jitter.schedule(nowWallUs, targetWallUs, frameIntervalUs);
+
+            // Push the new frame onto the queue. Depth is normally set by
+            // the jitter buffer's delay; kMaxQueued only bites when the
+            // consumer stops pulling (window hidden, GL thread stalled),
+            // and then the oldest frame goes.
             bool droppedOldest = false;
             {
                 std::lock_guard<std::mutex> lock(m_frameMutex);
                 QueuedFrame qf;
-                qf.rgb.assign(rgbBuf.begin(), rgbBuf.end());
+                qf.image        = std::move(image);
+                qf.id           = m_nextFrameId++;
                 qf.width        = static_cast<uint32_t>(dstW);
                 qf.height       = static_cast<uint32_t>(dstH);
                 qf.targetWallUs = targetWallUs;
@@ -1128,7 +1554,11 @@ void VideoCaptureRemote::decodeLoop()
             // Periodic decode stats so we can spot rate mismatches in the
             // log — produce/drop counts over the last second.
             ++m_statProduced;
-            if (droppedOldest) ++m_statDropped;
+            if (droppedOldest)
+            {
+                ++m_statDropped;
+                m_jitter.countDropped();
+            }
             auto nowTs = std::chrono::steady_clock::now();
             if (m_statStart.time_since_epoch().count() == 0) m_statStart = nowTs;
             if (std::chrono::duration_cast<std::chrono::seconds>(nowTs - m_statStart).count() >= 1)
@@ -1136,7 +1566,8 @@ void VideoCaptureRemote::decodeLoop()
                 LOG_DEBUG("VideoCaptureRemote: decoded=" + std::to_string(m_statProduced) +
                           "/s consumed=" + std::to_string(m_statConsumed) +
                           "/s drops=" + std::to_string(m_statDropped) +
-                          " queueDepth=" + std::to_string(m_frameQueue.size()));
+                          " queueDepth=" + std::to_string(m_frameQueue.size()) +
+                          " playoutDelayMs=" + std::to_string(m_jitter.delayUs() / 1000));
                 m_statProduced = m_statConsumed = m_statDropped = 0;
                 m_statStart = nowTs;
             }
@@ -1145,5 +1576,4 @@ void VideoCaptureRemote::decodeLoop()
 
     av_packet_free(&packet);
     av_frame_free(&frame);
-    av_frame_free(&rgb);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "IVideoCapture.h"
+#include "JitterBuffer.h"
 
 #include <atomic>
 #include <chrono>
@@ -16,9 +17,13 @@
 struct AVFormatContext;
 struct AVCodecContext;
 struct AVFrame;
+struct AVBufferRef;
+struct AVCodec;
+struct AVCodecParameters;
 struct SwsContext;
 struct SwrContext;
 class  IAudioPlayback;
+class  FrameInterpolationPass;
 
 /**
  * @brief Remote MPEG-TS source — consumes /raw from another RetroCapture
@@ -26,8 +31,12 @@ class  IAudioPlayback;
  *
  * Phase 3 of issue #47. open(url) takes the BASE URL of a remote server
  * (e.g. "http://host:8080"); the implementation appends "/raw" by
- * convention. Frames decoded from the stream are converted to RGB24 and
- * delivered through the same IVideoCapture contract used by V4L2 / DS.
+ * convention. The stream is decoded in hardware where available (VAAPI,
+ * V4L2 M2M — see HwDecodeMode). Decoded frames stay YUV; on the GL thread
+ * getGpuTexture() converts each one once into a small texture ring and
+ * paces / interpolates between them there (FrameInterpolationPass), so
+ * FrameProcessor gets a ready texture. captureLatestFrame() is the RGB24
+ * fallback for when that pass can't run.
  *
  * Hardware-control surface (brightness/contrast/etc.) is a no-op: a
  * remote stream isn't a piece of capture hardware and there's nothing to
@@ -50,6 +59,7 @@ public:
 
     bool captureFrame(Frame &frame) override;
     bool captureLatestFrame(Frame &frame) override;
+    unsigned int getGpuTexture(uint32_t &width, uint32_t &height) override;
 
     // Hardware controls — not applicable to a remote stream.
     bool setControl(const std::string &, int32_t) override { return false; }
@@ -90,7 +100,7 @@ public:
     void setTargetResolution(uint32_t width, uint32_t height);
 
     // Per-refresh interpolation strategy when filling display refreshes
-    // between two consecutive stream frames. See captureLatestFrame for
+    // between two consecutive stream frames. See pickPresentation for
     // the per-mode semantics.
     enum class InterpolationMode
     {
@@ -100,6 +110,21 @@ public:
     };
     void setInterpolationMode(InterpolationMode mode);
 
+    // Video decoder choice. Read by the decode thread on every (re)connect,
+    // so a change applies from the next connection. Any hardware mode
+    // falls back to software when the backend isn't there or can't decode
+    // the stream.
+    enum class HwDecodeMode
+    {
+        Auto,    // VAAPI, then V4L2 M2M, then software
+        VAAPI,   // desktop Intel / AMD
+        V4L2M2M, // SoC stateful decoders (Raspberry Pi h264_v4l2m2m, ...)
+        Off      // software, threaded across all cores
+    };
+    void setHwDecodeMode(HwDecodeMode mode) { m_hwDecodeMode.store(mode); }
+    // Config / UI strings: "auto", "vaapi", "v4l2m2m", "off".
+    static HwDecodeMode hwDecodeModeFromString(const std::string &mode);
+
     /**
      * #77 — client-side playback gain for the incoming audio, linear
      * in [0.0, 1.0] (1.0 = unity). Stored in an atomic and pushed to
@@ -110,6 +135,10 @@ public:
      */
     void setAudioVolume(float linear);
 
+    // Playout-buffer metrics (depth, delay, late / dropped frames);
+    // Application mirrors them for GET /api/v1/source/jitter. Any thread.
+    JitterBufferStats getJitterStats();
+
     /**
      * #49 Phase 3 — bearer token sent to the host's /raw endpoint
      * for password-protected streams. Set before open(); empty
@@ -129,6 +158,17 @@ private:
     void resyncToLive();
     bool initDecoder();
     void cleanupDecoder();
+    // Opens m_codecCtx for the video stream: the hardware backends
+    // m_hwDecodeMode allows, in order, then software.
+    bool openVideoDecoder(const AVCodecParameters *codecPar);
+    bool openVaapiDecoder(const AVCodecParameters *codecPar);
+    bool openV4l2M2mDecoder(const AVCodecParameters *codecPar);
+    bool openSoftwareDecoder(const AVCodecParameters *codecPar);
+    bool allocVideoCodecContext(const AVCodec *codec, const AVCodecParameters *codecPar);
+    void freeVideoDecoder();
+    // A hardware decoder that opened but can't produce frames for this
+    // stream: remember it and tear down so the reconnect opens software.
+    void fallBackToSoftwareDecode(const std::string &reason);
     // Bring up the audio sink + resampler from the audio decoder's
     // current params (m_audioCodecCtx). Returns false (and leaves
     // m_audioPlayback/m_swrCtx null) when the params aren't resolved
@@ -152,14 +192,30 @@ private:
 
     AVFormatContext *m_formatCtx = nullptr;
     AVCodecContext  *m_codecCtx  = nullptr;
+    // Decode thread: repacks decoder output YUVRenderPass can't take
+    // (10-bit, packed, ...) to YUV420P. Most streams never need it.
     SwsContext      *m_swsCtx    = nullptr;
     int              m_videoStreamIdx = -1;
 
+    enum class DecodeBackend
+    {
+        Software,
+        VAAPI,   // frames are GPU surfaces, downloaded as NV12
+        V4L2M2M  // frames live in the decoder's small capture-buffer pool
+    };
+    std::atomic<HwDecodeMode> m_hwDecodeMode{HwDecodeMode::Auto};
+    DecodeBackend    m_decodeBackend   = DecodeBackend::Software; // decode thread
+    AVBufferRef     *m_hwDeviceCtx     = nullptr;                 // VAAPI device
+    bool             m_hwProducedFrame = false; // hw decoder has delivered at least one frame
+    // Set by fallBackToSoftwareDecode, cleared by open(): hardware isn't
+    // retried on reconnects to the same host.
+    std::atomic<bool> m_hwDecodeFailed{false};
+
     // Remote-stream audio path. Activated when the /raw demuxer
     // exposes an audio stream — we decode it alongside video in the
     // same decodeLoop and submit the float-PCM samples to the
     // platform playback sink. The sink's getClockUs() becomes the
-    // A/V master clock for the captureLatestFrame() blend gate.
+    // A/V master clock for the pickPresentation() release gate.
     AVCodecContext  *m_audioCodecCtx = nullptr;
     SwrContext      *m_swrCtx        = nullptr;
     int              m_audioStreamIdx = -1;
@@ -179,41 +235,50 @@ private:
     // started yet.
     std::atomic<bool>  m_decodeAborted{false};
 
-    // Small bounded queue of decoded RGB frames. Decoder pushes to back;
-    // consumer pops front. When the queue would exceed kMaxQueued the
-    // oldest frame is dropped — bounds the latency at a few frames while
-    // absorbing TCP / decoder bursts that would otherwise overwrite mid-
-    // burst frames if we kept a single-slot buffer. Replaces the "single
-    // slot, newer overwrites older" design from the first cut of this
-    // class.
+    // Jitter buffer: decoded frames wait here for their playout time.
+    // Decoder pushes to back; consumer pops front. How long they wait —
+    // and so how deep the queue runs — is m_jitter's adaptive delay, not
+    // the queue size; kMaxQueued only guards against a stalled consumer.
     struct QueuedFrame
     {
-        std::vector<uint8_t> rgb;
+        // Decoded planes, 8-bit planar YUV or NV12 at stream size. A
+        // reference to the decoder's buffer where the decoder allows it
+        // (software), a copy otherwise; shared so the GL thread can upload
+        // it after dropping m_frameMutex.
+        std::shared_ptr<AVFrame> image;
+        // Unique per decoded frame (starts at 1) — the texture ring key.
+        uint64_t             id     = 0;
+        // Output size (target resolution, or stream size).
         uint32_t             width  = 0;
         uint32_t             height = 0;
         // Wall-clock target time (steady_clock microseconds) at which this
         // frame should become the on-screen frame. Computed in the decode
-        // loop from frame.pts and the stream anchor — see decodeLoop().
+        // loop from frame.pts, the stream anchor and the jitter buffer's
+        // playout delay — see decodeLoop().
         int64_t              targetWallUs = 0;
     };
-    // Bigger buffer absorbs the bursty arrival pattern produced by the
-    // server's variable-rate encoder + TCP buffering. PTS-anchored
-    // release means frames sit in the queue waiting for their target
-    // display moment, so bursts that arrive faster than the stream's
-    // average rate stack up briefly before draining. 5 was tight enough
-    // that bursts overflowed regularly (user observed drops=1-7/s in
-    // the decode loop telemetry); 20 gives ~500 ms of headroom at 40
-    // fps which is plenty for ordinary network jitter and still under
-    // the latency budget for distributed shader preview.
-    static constexpr size_t kMaxQueued = 20;
+    // Hard cap only. Used to be the tuning knob (5 overflowed on bursts,
+    // 20 = ~500 ms at 40 fps); now JitterBuffer::kMaxDelayUs at 60 fps
+    // plus a burst fits, and overflowing means the consumer stopped
+    // pulling (hidden window) rather than network jitter. The queue holds
+    // decoder buffer references, so this also bounds their memory.
+    static constexpr size_t kMaxQueued = 48;
+
+    // Playout delay (PTS schedule + delay = targetWallUs), sized from
+    // measured arrival jitter and corrected by rate, never by dropping.
+    // Governs the wall-clock gate; when audio is locked as master clock
+    // pickPresentation adds the same delay to the audio position, so
+    // lip sync is unaffected.
+    JitterBuffer m_jitter;
 
     std::mutex             m_frameMutex;
     std::deque<QueuedFrame> m_frameQueue;
     // Last frame handed to the consumer — used to keep something on screen
     // (rather than dummy black) when the queue is momentarily empty, and
     // as one of the two endpoints for the per-refresh interpolation
-    // (see m_blendBuffer below).
+    // (see pickPresentation).
     QueuedFrame             m_lastConsumed;
+    uint64_t                m_nextFrameId = 1; // decode thread
     std::atomic<bool>       m_hasFrame{false};
 
     std::atomic<InterpolationMode> m_interpolationMode{InterpolationMode::Linear};
@@ -222,24 +287,43 @@ private:
     // decode thread which forwards it to m_audioPlayback each frame.
     std::atomic<float> m_audioVolume{1.0f};
 
-    // Per-refresh interpolation output buffer. The classic 3:2 pulldown
-    // problem (60 fps stream into a 144 Hz panel = 2.4 refreshes per
-    // frame → alternating 2/3-refresh hold times → visible judder) is
-    // a non-integer ratio issue that no choice of stream rate can fully
-    // solve at the client side. Instead, on every captureLatestFrame
-    // call we LERP between m_lastConsumed and the next queued frame
-    // using t = (now - prevTarget) / (nextTarget - prevTarget), so each
-    // refresh shows a unique intermediate image rather than a held
-    // duplicate. Indistinguishable from real motion at typical
-    // stream:refresh ratios; the dependency on the server transmitting
-    // at a "magic" matched rate goes away.
-    std::vector<uint8_t> m_blendBuffer;
+    // Per-refresh interpolation. The classic 3:2 pulldown problem (60 fps
+    // stream into a 144 Hz panel = 2.4 refreshes per frame → alternating
+    // 2/3-refresh hold times → visible judder) is a non-integer ratio
+    // issue that no choice of stream rate can fully solve at the client
+    // side. Instead, on every refresh we LERP between m_lastConsumed and
+    // the next queued frame using
+    // t = (now - prevTarget) / (nextTarget - prevTarget), so each refresh
+    // shows a unique intermediate image rather than a held duplicate.
+    // Indistinguishable from real motion at typical stream:refresh
+    // ratios; the dependency on the server transmitting at a "magic"
+    // matched rate goes away.
+    struct Presentation
+    {
+        QueuedFrame current;  // shown as-is when next.image is null
+        QueuedFrame next;     // blend endpoint (Linear mode only)
+        float       weight = 0.0f; // share of next, in (0, 1) when blending
+    };
+    // Drains due frames and decides what this refresh shows. Takes
+    // m_frameMutex; false while nothing has been released yet.
+    bool pickPresentation(Presentation &out);
+
+    // GL thread. The blend runs on the GPU (FrameInterpolationPass, one
+    // YUV conversion per stream frame, one mix draw per refresh); if that
+    // pass can't initialise, captureLatestFrame converts the nearer
+    // endpoint to RGB24 instead (no blending). m_rgbFrameId skips the
+    // conversion while the same frame stays on screen.
+    std::unique_ptr<FrameInterpolationPass> m_gpuPass;
+    bool                 m_gpuUnavailable = false;
+    SwsContext          *m_rgbSwsCtx = nullptr;
+    std::vector<uint8_t> m_rgbBuffer;
+    uint64_t             m_rgbFrameId = 0;
 
     // PTS-anchored playback. On the first decoded frame we record the
     // current wall clock as the "stream zero" reference and the frame's
     // PTS as the stream PTS origin. Every subsequent frame's target wall
     // time = m_streamStartWallUs + (pts - m_firstPtsTicks) * timebase.
-    // captureLatestFrame() then only releases a frame once its target
+    // pickPresentation() then only releases a frame once its target
     // time has been reached, holding the previously released frame on
     // screen until then — eliminates the irregular 1/2-refresh-cycle
     // judder we get when network/decoder bursts let us poll multiple
@@ -54,11 +54,7 @@ void VideoCaptureScreen::close()
     m_width.store(0);
     m_height.store(0);
     m_receiving.store(false);
-    {
-        std::lock_guard<std::mutex> lock(m_frameMutex);
-        m_haveFrame = false;
-        m_frameBuf.clear();
-    }
+    m_mailbox.reset(); // backend parado: seguro resetar
 }
 
 bool VideoCaptureScreen::setFormat(uint32_t width, uint32_t height, uint32_t)
@@ -103,14 +99,8 @@ bool VideoCaptureScreen::captureFrame(Frame &frame)
 
 bool VideoCaptureScreen::captureLatestFrame(Frame &frame)
 {
-    std::lock_guard<std::mutex> lock(m_frameMutex);
-    if (!m_haveFrame || m_frameBuf.empty()) return false;
-    frame.data   = m_frameBuf.data();
-    frame.size   = m_frameBuf.size();
-    frame.width  = m_width.load();
-    frame.height = m_height.load();
-    frame.format = m_pixelFormat.load();
-    return true;
+    // false when nothing new arrived since the last call
+    return m_mailbox.take(frame);
 }
 
 void VideoCaptureScreen::onScreenFrame(const uint8_t *data, uint32_t w, uint32_t h,
@@ -141,20 +131,24 @@ void VideoCaptureScreen::onScreenFrame(const uint8_t *data, uint32_t w, uint32_t
                                 ? RC_PIXFMT_RGBA
                                 : RC_PIXFMT_BGRA;
 
-    std::lock_guard<std::mutex> lock(m_frameMutex);
+    FrameMailbox::Slot &slot = m_mailbox.writeSlot();
     const size_t dstStride = static_cast<size_t>(rw) * 4;
-    m_frameBuf.resize(dstStride * rh);
-    uint8_t *dst = m_frameBuf.data();
+    slot.data.resize(dstStride * rh);
+    uint8_t *dst = slot.data.data();
     for (uint32_t y = 0; y < rh; ++y)
     {
         const uint8_t *srow = data + static_cast<size_t>(ry + y) * stride +
                               static_cast<size_t>(rx) * 4;
         std::memcpy(dst + static_cast<size_t>(y) * dstStride, srow, dstStride);
     }
+    slot.size = dstStride * rh;
+    slot.width = rw;
+    slot.height = rh;
+    slot.format = outFmt;
     m_pixelFormat.store(outFmt);
     m_width.store(rw);
     m_height.store(rh);
-    m_haveFrame = true;
+    m_mailbox.publish();
     m_receiving.store(true);
 }
 
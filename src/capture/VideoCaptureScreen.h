@@ -1,6 +1,7 @@
 #pragma once
 
 #include "IVideoCapture.h"
+#include "FrameMailbox.h"
 #include "ScreenBackend.h"
 
 #include <atomic>
@@ -110,11 +111,10 @@ private:
     std::atomic<bool>  m_captureCursor{true};
     std::atomic<bool>  m_receiving{false};
 
-    // Latest frame, RGB24. onScreenFrame() writes under the lock;
-    // captureLatestFrame() hands a pointer to it to the pipeline.
-    std::mutex            m_frameMutex;
-    std::vector<uint8_t>  m_frameBuf;
-    bool                  m_haveFrame = false;
+    // Latest frame, packed RGBA/BGRA. onScreenFrame() fills the mailbox's
+    // write slot and publishes it; captureLatestFrame() takes the newest
+    // one, so the pipeline never reads a buffer the backend is rewriting.
+    FrameMailbox          m_mailbox;
 
     // DMABUF zero-copy path. The backend hands a dup'd fd (we own it);
     // getGpuTexture() imports it into m_glTex via EGL on the GL thread.
@@ -1,11 +1,13 @@
 #include "VideoCaptureV4L2.h"
 #include "FormatNegotiator.h"
+#include "../processing/MJPEGDecodePool.h"
 #include "../utils/Logger.h"
 #include "../utils/V4L2DeviceScanner.h"
 #include "../v4l2/V4L2ControlMapper.h"
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
@@ -187,7 +189,8 @@ bool VideoCaptureV4L2::setFormat(uint32_t width, uint32_t height, uint32_t pixel
         // enumeration above stays here (the platform seam).
         bool negotiateOk = true;
         pixelFormat = rc::capture::FormatNegotiator::chooseDefaultV4L2Format(
-            yuyvSupported, mjpegSupported, fmt.fmt.pix.pixelformat, negotiateOk);
+            yuyvSupported, mjpegSupported, fmt.fmt.pix.pixelformat, negotiateOk,
+            m_preferredPixelFormat);
         if (!negotiateOk)
         {
             return false;
@@ -313,116 +316,219 @@ bool VideoCaptureV4L2::captureFrame(Frame &frame)
         return false;
     }
 
+    // A thread de captura viu o dispositivo sumir: ativar modo dummy aqui,
+    // na thread de quem consome, como antes
+    const int err = m_captureError.exchange(0);
+    if (err != 0)
+    {
+        handleDeviceDisconnection(err, "VIDIOC_DQBUF");
+        return false;
+    }
+
+    // Frame mais recente publicado desde a última chamada (não bloqueia)
+    return m_mailbox.take(frame);
+}
+
+bool VideoCaptureV4L2::dequeueBuffer(uint32_t &index, uint32_t &bytesUsed, uint32_t &length, int &err)
+{
     struct v4l2_buffer buf = {};
     buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     buf.memory = V4L2_MEMORY_MMAP;
-
     if (ioctl(m_fd, VIDIOC_DQBUF, &buf) < 0)
     {
-        int err = errno;
-        // EAGAIN é normal quando não há frame disponível (non-blocking)
-        if (err == EAGAIN)
+        err = errno;
+        return false;
+    }
+    index = buf.index;
+    bytesUsed = buf.bytesused;
+    length = buf.length;
+    return true;
+}
+
+bool VideoCaptureV4L2::requeueBuffer(uint32_t index, int &err)
+{
+    struct v4l2_buffer buf = {};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+    if (ioctl(m_fd, VIDIOC_QBUF, &buf) < 0)
+    {
+        err = errno;
+        return false;
+    }
+    return true;
+}
+
+void VideoCaptureV4L2::startCaptureThread()
+{
+    m_mailbox.reset();
+    if (m_pixelFormat == V4L2_PIX_FMT_MJPEG)
+    {
+        if (!m_mjpegPool)
         {
-            return false;
+            m_mjpegPool = std::make_unique<MJPEGDecodePool>(m_mailbox);
         }
-        
-        // Erros críticos que indicam que o dispositivo foi desconectado
-        if (err == EBADF || err == ENODEV || err == EIO)
+        if (!m_mjpegPool->start())
         {
-            LOG_ERROR("Dispositivo USB desconectado detectado (errno: " + std::to_string(err) + 
-                     " - " + strerror(err) + ") - ativando modo dummy");
-            
-            // Fechar dispositivo graciosamente
-            stopCapture();
-            cleanupBuffers();
-            if (m_fd >= 0)
+            LOG_ERROR("MJPEG decode pool failed to start — MJPG frames will be dropped");
+        }
+    }
+    m_captureError.store(0);
+    m_captureRunning.store(true);
+    m_captureThread = std::thread(&VideoCaptureV4L2::captureLoop, this);
+}
+
+void VideoCaptureV4L2::stopCaptureThread()
+{
+    m_captureRunning.store(false);
+    if (m_captureThread.joinable())
+    {
+        m_captureThread.join();
+    }
+    // After the capture thread: it is the pool's only submitter
+    if (m_mjpegPool)
+    {
+        m_mjpegPool->stop();
+    }
+    m_mailbox.reset();
+}
+
+void VideoCaptureV4L2::captureLoop()
+{
+    auto isDisconnection = [](int err)
+    { return err == EBADF || err == ENODEV || err == EIO; };
+
+    while (m_captureRunning.load(std::memory_order_relaxed))
+    {
+        // Timeout curto só para enxergar m_captureRunning no stop
+        struct pollfd pfd = {};
+        pfd.fd = m_fd;
+        pfd.events = POLLIN;
+        const int ready = ::poll(&pfd, 1, 100);
+        if (ready < 0)
+        {
+            const int err = errno;
+            if (err == EINTR)
             {
-                ::close(m_fd);
-                m_fd = -1;
+                continue;
             }
-            
-            // Ativar modo dummy para continuar funcionando
-            m_dummyMode = true;
-            if (m_width > 0 && m_height > 0)
+            if (isDisconnection(err))
             {
-                size_t frameSize = m_width * m_height * 2; // YUYV: 2 bytes por pixel
-                m_dummyFrameBuffer.resize(frameSize, 0);
-                m_streaming = true;
-                LOG_INFO("Dummy mode activated automatically after device disconnect");
+                m_captureError.store(err);
+                break;
             }
-            
-            return false;
+            LOG_ERROR("poll() falhou no dispositivo (errno: " + std::to_string(err) + " - " + strerror(err) + ")");
+            continue;
+        }
+        if (ready == 0)
+        {
+            continue;
         }
-        
-        // Outros erros
-        LOG_ERROR("Failed to capturar frame (errno: " + std::to_string(err) + " - " + strerror(err) + ")");
-        return false;
-    }
 
-    // Validar buffer antes de usar
-    if (buf.index >= m_buffers.size() || 
-        !m_buffers[buf.index].start || 
-        m_buffers[buf.index].start == MAP_FAILED)
-    {
-        LOG_ERROR("Invalid buffer at index " + std::to_string(buf.index));
-        // Tentar reenfileirar para não perder sincronização (mas pode falhar se dispositivo foi desconectado)
-        if (m_fd >= 0)
+        // Esvaziar a fila do driver e ficar só com o buffer mais novo; os
+        // mais velhos voltam direto para o driver sem cópia
+        int held = -1;
+        uint32_t heldBytes = 0;
+        uint32_t heldLength = 0;
+        int err = 0;
+        int requeueErr = 0;
+        for (;;)
+        {
+            uint32_t index = 0, bytesUsed = 0, length = 0;
+            if (!dequeueBuffer(index, bytesUsed, length, err))
+            {
+                break;
+            }
+            if (held >= 0 && !requeueBuffer(static_cast<uint32_t>(held), requeueErr))
+            {
+                if (isDisconnection(requeueErr))
+                {
+                    break;
+                }
+                LOG_ERROR("Failed to reenfileirar buffer " + std::to_string(held) + " (errno: " +
+                          std::to_string(requeueErr) + " - " + strerror(requeueErr) + ")");
+                requeueErr = 0;
+            }
+            held = static_cast<int>(index);
+            heldBytes = bytesUsed;
+            heldLength = length;
+            err = 0;
+        }
+        if (requeueErr != 0)
         {
-            ioctl(m_fd, VIDIOC_QBUF, &buf);
+            m_captureError.store(requeueErr); // só sobra aqui se for desconexão
+            break;
+        }
+        if (err != 0 && err != EAGAIN)
+        {
+            if (isDisconnection(err))
+            {
+                m_captureError.store(err);
+                break;
+            }
+            LOG_ERROR("Failed to capturar frame (errno: " + std::to_string(err) + " - " + strerror(err) + ")");
+        }
+        if (held < 0)
+        {
+            continue;
         }
-        return false;
-    }
 
-    frame.data = static_cast<uint8_t *>(m_buffers[buf.index].start);
-    frame.size = buf.length;
-    frame.width = m_width;
-    frame.height = m_height;
-    frame.format = m_pixelFormat;
+        const uint32_t index = static_cast<uint32_t>(held);
+        if (index >= m_buffers.size() || !m_buffers[index].start || m_buffers[index].start == MAP_FAILED)
+        {
+            LOG_ERROR("Invalid buffer at index " + std::to_string(index));
+            requeueBuffer(index, err);
+            continue;
+        }
 
-    // Validar tamanho do frame
-    size_t expectedSize = m_width * m_height * 2; // YUYV: 2 bytes por pixel
-    if (buf.length < expectedSize)
-    {
-        LOG_WARN("Tamanho do buffer menor que o esperado: " + std::to_string(buf.length) +
-                 " < " + std::to_string(expectedSize));
-    }
+        // MJPG is variable-size: only bytesused holds the JPEG, the rest of the
+        // mmap buffer is stale. Raw formats keep the full buffer length.
+        const bool compressed = (m_pixelFormat == V4L2_PIX_FMT_MJPEG);
+        const size_t size = compressed ? heldBytes : heldLength;
+        const size_t expectedSize = static_cast<size_t>(m_width) * m_height * 2; // YUYV: 2 bytes por pixel
+        if (!compressed && heldLength < expectedSize)
+        {
+            LOG_WARN("Tamanho do buffer menor que o esperado: " + std::to_string(heldLength) +
+                     " < " + std::to_string(expectedSize));
+        }
 
-    if (ioctl(m_fd, VIDIOC_QBUF, &buf) < 0)
-    {
-        int err = errno;
-        // Erros críticos que indicam que o dispositivo foi desconectado
-        if (err == EBADF || err == ENODEV || err == EIO)
+        // Copiar antes de devolver o buffer: o driver volta a escrever nele.
+        // MJPG vai para os workers de decode, que publicam no mailbox.
+        if (compressed)
         {
-            LOG_ERROR("Dispositivo USB desconectado durante reenfileiramento (errno: " + 
-                     std::to_string(err) + " - " + strerror(err) + ") - ativando modo dummy");
-            
-            // Fechar dispositivo graciosamente
-            stopCapture();
-            cleanupBuffers();
-            if (m_fd >= 0)
+            if (m_mjpegPool)
             {
-                ::close(m_fd);
-                m_fd = -1;
+                m_mjpegPool->submit(static_cast<const uint8_t *>(m_buffers[index].start), size, m_width, m_height);
             }
-            
-            // Ativar modo dummy para continuar funcionando
-            m_dummyMode = true;
-            if (m_width > 0 && m_height > 0)
+        }
+        else
+        {
+            FrameMailbox::Slot &slot = m_mailbox.writeSlot();
+            if (slot.data.size() < size)
             {
-                size_t frameSize = m_width * m_height * 2; // YUYV: 2 bytes por pixel
-                m_dummyFrameBuffer.resize(frameSize, 0);
-                m_streaming = true;
-                LOG_INFO("Dummy mode activated automatically after device disconnect");
+                slot.data.resize(size);
             }
+            std::memcpy(slot.data.data(), m_buffers[index].start, size);
+            slot.size = size;
+            slot.width = m_width;
+            slot.height = m_height;
+            slot.format = m_pixelFormat;
         }
-        else
+
+        if (!requeueBuffer(index, err))
         {
+            if (isDisconnection(err))
+            {
+                m_captureError.store(err);
+                break;
+            }
             LOG_ERROR("Failed to reenfileirar buffer (errno: " + std::to_string(err) + " - " + strerror(err) + ")");
         }
-        return false;
+        if (!compressed)
+        {
+            m_mailbox.publish();
+        }
     }
-
-    return true;
 }
 
 bool VideoCaptureV4L2::setControl(const std::string &controlName, int32_t value)
@@ -764,6 +870,7 @@ bool VideoCaptureV4L2::startCapture()
     }
 
     m_streaming = true;
+    startCaptureThread();
     LOG_INFO("Captura iniciada");
     return true;
 }
@@ -782,6 +889,9 @@ void VideoCaptureV4L2::stopCapture()
         return;
     }
 
+    // Thread de captura fora antes do STREAMOFF / munmap dos buffers
+    stopCaptureThread();
+
     enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     if (m_fd >= 0)
     {
@@ -819,31 +929,8 @@ void VideoCaptureV4L2::cleanupBuffers()
 
 bool VideoCaptureV4L2::captureLatestFrame(Frame &frame)
 {
-    if (m_dummyMode)
-    {
-        if (!m_streaming || m_dummyFrameBuffer.empty())
-        {
-            return false;
-        }
-        generateDummyFrame(frame);
-        return true;
-    }
-
-    if (m_fd < 0 || !m_streaming)
-    {
-        return false;
-    }
-
-    Frame tempFrame;
-    bool gotFrame = false;
-
-    while (captureFrame(tempFrame))
-    {
-        frame = tempFrame;
-        gotFrame = true;
-    }
-
-    return gotFrame;
+    // A thread de captura já descarta frames antigos: o mailbox só guarda o mais novo
+    return captureFrame(frame);
 }
 
 std::vector<uint32_t> VideoCaptureV4L2::getSupportedFormats()
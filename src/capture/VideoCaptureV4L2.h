@@ -1,12 +1,29 @@
 #pragma once
 
 #include "IVideoCapture.h"
+#include "FrameMailbox.h"
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
+class MJPEGDecodePool;
+
 /**
  * @brief V4L2 implementation of IVideoCapture for Linux
+ *
+ * While streaming, a capture thread blocks in poll() on the device,
+ * dequeues every buffer as soon as the driver fills it, copies the newest
+ * one into a FrameMailbox and requeues it right away. captureFrame() /
+ * captureLatestFrame() just take() from the mailbox: the render thread
+ * never waits on the device, and a render hitch no longer leaves the
+ * driver without free buffers (which made it drop frames).
+ *
+ * MJPG frames don't go into the mailbox compressed: the capture thread
+ * hands them to an MJPEGDecodePool, whose workers publish the decoded
+ * planar YUV instead, so the render thread never decodes.
  */
 class VideoCaptureV4L2 : public IVideoCapture
 {
@@ -35,6 +52,7 @@ public:
     uint32_t getWidth() const override { return m_width; }
     uint32_t getHeight() const override { return m_height; }
     uint32_t getPixelFormat() const override { return m_pixelFormat; }
+    void setPreferredPixelFormat(uint32_t fourcc) override { m_preferredPixelFormat = fourcc; }
 
     // Additional V4L2-specific methods (for backward compatibility)
     bool setControl(uint32_t controlId, int32_t value);
@@ -56,6 +74,7 @@ private:
     uint32_t m_width = 0;
     uint32_t m_height = 0;
     uint32_t m_pixelFormat = 0;
+    uint32_t m_preferredPixelFormat = 0; // 0 = auto (YUYV first)
 
     struct Buffer
     {
@@ -65,10 +84,26 @@ private:
 
     std::vector<Buffer> m_buffers;
     bool m_streaming = false;
+
+    // Capture thread (only while streaming a real device, not in dummy mode)
+    std::thread m_captureThread;
+    std::atomic<bool> m_captureRunning{false};
+    // errno of a disconnection seen by the capture thread (0 = none); the
+    // switch to dummy mode happens on the caller's thread in captureFrame()
+    std::atomic<int> m_captureError{0};
+    FrameMailbox m_mailbox;
+    // Only while streaming MJPG; owns the mailbox's producer side then.
+    std::unique_ptr<MJPEGDecodePool> m_mjpegPool;
     bool m_dummyMode = false;
     std::vector<uint8_t> m_dummyFrameBuffer;
 
     bool initMemoryMapping();
+    void startCaptureThread();
+    void stopCaptureThread();
+    void captureLoop();
+    // Non-blocking VIDIOC_DQBUF / VIDIOC_QBUF; on failure err holds errno
+    bool dequeueBuffer(uint32_t &index, uint32_t &bytesUsed, uint32_t &length, int &err);
+    bool requeueBuffer(uint32_t index, int &err);
     void cleanupBuffers();
     void generateDummyFrame(Frame &frame);
     uint32_t getControlIdFromName(const std::string &controlName);
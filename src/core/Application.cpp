@@ -18,6 +18,7 @@
 #include "../processing/FrameProcessor.h"
 #include "../renderer/OpenGLRenderer.h"
 #include "../renderer/PBOManager.h"
+#include "../renderer/RGBToYUVPass.h"
 #ifdef USE_SDL2
 #include "../output/WindowManagerSDL.h"
 #else
@@ -362,6 +363,8 @@ bool Application::initRenderer()
     // Initialize PBO Manager for async pixel reading
     LOG_INFO("Creating PBOManager...");
     m_pboManager = std::make_unique<PBOManager>();
+    m_yuvPboManager = std::make_unique<PBOManager>();
+    m_rgbToYuvPass = std::make_unique<RGBToYUVPass>();
     LOG_INFO("PBOManager created");
 
     // Initialize ShaderEngine
@@ -457,6 +460,7 @@ bool Application::initCapture()
         if (m_remoteInterpolation == "nearest") imode = VideoCaptureRemote::InterpolationMode::Nearest;
         else if (m_remoteInterpolation == "off") imode = VideoCaptureRemote::InterpolationMode::Off;
         remote->setInterpolationMode(imode);
+        remote->setHwDecodeMode(VideoCaptureRemote::hwDecodeModeFromString(m_remoteHwDecode));
         remote->setAudioVolume(m_remoteAudioGain);
         m_capture = std::move(remote);
     }
@@ -487,6 +491,7 @@ bool Application::initCapture()
         LOG_ERROR("Failed to create VideoCapture for this platform");
         return false;
     }
+    m_capture->setPreferredPixelFormat(m_v4l2PixelFormat);
     LOG_INFO("VideoCapture created successfully");
 
     // Try to open specified device
@@ -973,6 +978,19 @@ void Application::handleKeyInput()
         {
             f8Pressed = false;
         }
+
+        // F9 saves the instant replay buffer (no-op when it's off).
+        static bool f9Pressed = false;
+        bool f9Now = sdlWindow->isKeyPressed(SDLK_F9);
+        if (f9Now && !f9Pressed)
+        {
+            m_ui->triggerReplaySave(0);
+            f9Pressed = true;
+        }
+        else if (!f9Now)
+        {
+            f9Pressed = false;
+        }
     }
 #else
     GLFWwindow *window = static_cast<GLFWwindow *>(m_window->getWindow());
@@ -1032,6 +1050,21 @@ void Application::handleKeyInput()
     {
         f8Pressed = false;
     }
+
+    // F9 saves the instant replay buffer (no-op when it's off).
+    static bool f9Pressed = false;
+    if (glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS)
+    {
+        if (!f9Pressed)
+        {
+            m_ui->triggerReplaySave(0);
+            f9Pressed = true;
+        }
+    }
+    else
+    {
+        f9Pressed = false;
+    }
 #endif // USE_SDL2
 }
 
@@ -1685,7 +1718,7 @@ void Application::processAudioCapture()
                     {
                         m_streamManager->pushAudio(audioBuffer.data(), samplesRead);
                     }
-                    if (m_recordingManager && m_recordingManager->isRecording())
+                    if (m_recordingManager && m_recordingManager->isEncoding())
                     {
                         m_recordingManager->pushAudio(audioBuffer.data(), samplesRead);
                     }
@@ -1716,7 +1749,7 @@ void Application::processAudioCapture()
                 }
             }
         }
-        else if (m_recordingManager && m_recordingManager->isRecording())
+        else if (m_recordingManager && m_recordingManager->isEncoding())
         {
             // Recording is active (but streaming is not), process audio for recording
             uint32_t audioSampleRate = m_audioCapture->getSampleRate();
@@ -1940,7 +1973,6 @@ void Application::run()
         // IMPORTANT: Capture always continues, even when window is not focused
         // This ensures streaming and processing continue working
         // IMPORTANT: Try to capture if device is open OR in dummy mode
-        bool newFrame = false;
         // Process frames if device is open OR in dummy mode
         bool shouldProcess = m_capture && (m_capture->isOpen() || m_capture->isDummyMode());
 
@@ -1964,39 +1996,22 @@ void Application::run()
             }
             else
             {
-                // Try to process frame multiple times if we don't have valid texture
-                // This is important after reconfiguration when texture was deleted
-                // In dummy mode, always try to process to ensure green frame appears
-                int maxAttempts = (m_frameProcessor->getTexture() == 0 && !m_frameProcessor->hasValidFrame()) ? 5 : 1;
-                if (m_capture->isDummyMode())
-                {
-                    maxAttempts = 5; // Always try multiple times in dummy mode
-                }
-                for (int attempt = 0; attempt < maxAttempts; ++attempt)
-                {
-                    // Check again before each attempt to avoid processing during reconfiguration
-                    if (m_isReconfiguring || (!m_capture->isOpen() && !m_capture->isDummyMode()))
-                    {
-                        break; // Stop processing if reconfiguration started
-                    }
-                    newFrame = m_frameProcessor->processFrame(m_capture.get());
-
-                    if (newFrame && m_frameProcessor->hasValidFrame() && m_frameProcessor->getTexture() != 0)
-                    {
-                        break; // Frame processed successfully
-                    }
-                    if (attempt < maxAttempts - 1)
-                    {
-#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
-                        usleep(5000); // 5ms between attempts
-#else
-                        Sleep(5); // 5ms between attempts
-#endif
-                    }
-                }
+                // Non-blocking: the capture backends produce on their own
+                // threads, so there is either a new frame in the mailbox or
+                // there isn't — sleeping here only delayed the render. A
+                // missing texture after reconfiguration is picked up on the
+                // next iteration.
+                m_frameProcessor->processFrame(m_capture.get());
             }
         }
 
+        // Advance a preset compiling in the background and swap it in here,
+        // between frames, never in the middle of applyShader
+        if (m_shaderEngine)
+        {
+            m_shaderEngine->pollPendingPreset();
+        }
+
         // Always render if we have a valid frame
         // This ensures we're always showing the latest frame
         // Skip rendering during reconfiguration to avoid accessing deleted textures
@@ -2183,6 +2198,12 @@ void Application::shutdown()
         m_frameProcessor.reset();
     }
 
+    if (m_rgbToYuvPass)
+    {
+        m_rgbToYuvPass->shutdown();
+        m_rgbToYuvPass.reset();
+    }
+
     if (m_renderer)
     {
         m_renderer->shutdown();
@@ -2358,13 +2379,9 @@ void Application::applyPreset(const std::string &presetName)
             }
         }
 
-        if (m_shaderEngine->loadPreset(shaderPath))
+        // Shader parameters are applied when the background compile swaps the preset in
+        if (m_shaderEngine->loadPresetAsync(shaderPath, data.shaderParameters))
         {
-            // Apply shader parameters
-            for (const auto &param : data.shaderParameters)
-            {
-                m_shaderEngine->setShaderParameter(param.first, param.second);
-            }
 
             // Update UI with shader path (use the relative path from preset)
             // This is important because setCurrentShader triggers a callback that
@@ -3082,6 +3099,7 @@ void Application::syncDirectoryClient()
         bool offline   = false;
         bool receiving = false;
         bool failing   = false;
+        JitterBufferStats jitter;
         if (m_capture)
         {
             if (auto *remote = dynamic_cast<VideoCaptureRemote *>(m_capture.get()))
@@ -3089,6 +3107,7 @@ void Application::syncDirectoryClient()
                 offline   = remote->isHostLikelyOffline();
                 receiving = remote->isReceivingFrames();
                 failing   = remote->isInitialConnectFailing();
+                jitter    = remote->getJitterStats();
             }
             else
             {
@@ -3098,6 +3117,7 @@ void Application::syncDirectoryClient()
         m_ui->setRemoteHostLikelyOffline(offline);
         m_ui->setRemoteReceivingFrames(receiving);
         m_ui->setRemoteInitialConnectFailing(failing);
+        m_ui->setRemoteJitterStats(jitter);
     }
 
     // #49 Phase 3 — keep the server-side password gate in sync with
@@ -3619,6 +3639,7 @@ bool Application::startRecording()
     if (m_recordingManager)
     {
         populateRecordingContext();
+        updateRecordingEncodeSource();
         RecordingSettings settings = m_recordingManager->getRecordingSettings();
         return m_recordingManager->startRecording(settings);
     }
@@ -3655,6 +3676,22 @@ void Application::populateRecordingContext()
     m_recordingManager->setRecordingContext(ctx);
 }
 
+void Application::updateRecordingEncodeSource()
+{
+    if (!m_recordingManager) return;
+
+    // /stream and the recording only see the same frames when both follow
+    // the shader the same way (see the per-pipeline override in
+    // FrameCapturePipeline); otherwise sharing would record the wrong feed.
+    EncodedPacketBus *bus = nullptr;
+    if (m_streamManager && m_streamManager->isActive() && m_ui &&
+        m_ui->getStreamingApplyShader() == m_ui->getRecordingApplyShader())
+    {
+        bus = m_streamManager->getEncodedPacketBus();
+    }
+    m_recordingManager->setSharedEncodeSource(bus);
+}
+
 void Application::stopRecording()
 {
     if (m_recordingManager)
@@ -3708,6 +3745,24 @@ std::vector<RecordingMetadata> Application::listRecordings()
     return std::vector<RecordingMetadata>();
 }
 
+RecordingPage Application::queryRecordings(const RecordingQuery &query)
+{
+    if (m_recordingManager)
+    {
+        return m_recordingManager->queryRecordings(query);
+    }
+    return RecordingPage();
+}
+
+bool Application::getRecording(const std::string &recordingId, RecordingMetadata &out)
+{
+    if (m_recordingManager)
+    {
+        return m_recordingManager->getRecording(recordingId, out);
+    }
+    return false;
+}
+
 bool Application::deleteRecording(const std::string &recordingId)
 {
     if (m_recordingManager)
@@ -16,6 +16,8 @@
 // Forward declarations for recording
 struct RecordingSettings;
 struct RecordingMetadata;
+struct RecordingQuery;
+struct RecordingPage;
 
 class IVideoCapture;
 class IAudioCapture;
@@ -30,6 +32,7 @@ class FrameProcessor;
 class StreamManager;
 class HTTPTSStreamer;
 class PBOManager;
+class RGBToYUVPass;
 class RecordingManager;
 class FrameCapturePipeline; // #157 — per-frame render/distribute pipeline
 class RemoteSourceManager;  // #158 — remote /meta worker + pending-meta drain
@@ -106,6 +109,8 @@ public:
     void setV4L2Sharpness(int32_t value) { m_v4l2Sharpness = value; }
     void setV4L2Gamma(int32_t value) { m_v4l2Gamma = value; }
     void setV4L2WhiteBalance(int32_t value) { m_v4l2WhiteBalance = value; }
+    // Requested capture fourcc (0 = auto: YUYV when the device offers it).
+    void setV4L2PixelFormat(uint32_t fourcc) { m_v4l2PixelFormat = fourcc; }
 
     // Streaming configuration
     void setStreamingEnabled(bool enabled) { m_streamingEnabled = enabled; }
@@ -145,12 +150,18 @@ private:
     // shader / source / nickname / version off the UI and capture
     // pipeline so RecordingManager can embed it as MP4/MKV metadata.
     void populateRecordingContext();
+    // Offer the /stream encoder to the next recording (shared encode)
+    // when both outputs carry the same frames; RecordingManager still
+    // checks codec settings before subscribing.
+    void updateRecordingEncodeSource();
 public:
     bool isRecording() const;
     uint64_t getRecordingDurationUs();
     uint64_t getRecordingFileSize();
     std::string getRecordingFilename();
     std::vector<struct RecordingMetadata> listRecordings();
+    RecordingPage queryRecordings(const RecordingQuery& query);
+    bool getRecording(const std::string& recordingId, RecordingMetadata& out);
     bool deleteRecording(const std::string& recordingId);
     bool renameRecording(const std::string& recordingId, const std::string& newName);
     std::string getRecordingPath(const std::string& recordingId);
@@ -266,6 +277,10 @@ private:
 #endif
     std::unique_ptr<IAudioCapture> m_audioCapture;
     std::unique_ptr<PBOManager> m_pboManager; // PBO para leitura assíncrona de pixels
+    // Encoder feed em YUV 4:2:0 convertido na GPU: o pass renderiza os
+    // planos e o segundo ring de PBOs (GL_RED) os lê de volta.
+    std::unique_ptr<RGBToYUVPass> m_rgbToYuvPass;
+    std::unique_ptr<PBOManager> m_yuvPboManager;
     std::unique_ptr<RecordingManager> m_recordingManager;
 
     // Remote-source render pacing: when consuming a remote /raw stream the
@@ -313,8 +328,7 @@ private:
 
     // Buffers reutilizáveis no caminho de captura — evita alocar ~6MB/frame a 1080p.
     // pushFrame() copia os dados, então é seguro reutilizar.
-    std::vector<uint8_t> m_captureFrameData;       // Saída RGB final (push-to-encoder).
-    std::vector<uint8_t> m_captureRgbaScratch;     // Temp RGBA→RGB (path PBO com shader).
+    std::vector<uint8_t> m_captureFrameData;       // Saída final (push-to-encoder), RGB24 ou YUV420.
     std::vector<uint8_t> m_captureSyncPadded;      // Temp glReadPixels com row padding.
     // Per-pipeline shader override: secondary readback of the raw source
     // (pre-shader) so streaming/recording can opt out of the shader chain
@@ -383,6 +397,7 @@ private:
     int32_t m_v4l2Sharpness = -1;
     int32_t m_v4l2Gamma = -1;
     int32_t m_v4l2WhiteBalance = -1;
+    uint32_t m_v4l2PixelFormat = 0; // 0 = auto
 
     // Streaming configuration
     bool m_streamingEnabled = false;
@@ -407,6 +422,7 @@ private:
     std::string m_streamingQsvPreset   = "veryfast";
     std::string m_streamingAmfQuality  = "speed";
     std::string m_remoteInterpolation  = "linear";
+    std::string m_remoteHwDecode       = "auto";
     // #77 effective client-side audio gain (muted ? 0 : volume), kept in
     // sync with UIManager and applied to each VideoCaptureRemote created.
     float m_remoteAudioGain = 1.0f;
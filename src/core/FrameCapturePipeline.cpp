@@ -16,6 +16,7 @@
 #include "../processing/FrameProcessor.h"
 #include "../renderer/OpenGLRenderer.h"
 #include "../renderer/PBOManager.h"
+#include "../renderer/RGBToYUVPass.h"
 #ifdef USE_SDL2
 #include "../output/WindowManagerSDL.h"
 #else
@@ -570,7 +571,7 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
     // IMPORTANTE: Para streaming e recording, capturar diretamente da textura final ao invés do framebuffer
     // Isso evita problemas com back/front buffer e garante que capturamos a imagem renderizada
     bool needsFrameCapture = (m_app.m_streamManager && m_app.m_streamManager->isActive()) ||
-                            (m_app.m_recordingManager && m_app.m_recordingManager->isRecording())
+                            (m_app.m_recordingManager && m_app.m_recordingManager->isEncoding())
 #if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
                             || (m_app.m_virtcam && m_app.m_virtcam->isRunning())
 #endif
@@ -646,7 +647,7 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                 // IMPORTANTE: Se há resolução de saída configurada, usar finalTexture
                 // Se não há resolução de saída mas há shader, usar textureToRender com dimensões do shader
                 // Isso garante que capturamos a textura completa processada tanto para streaming quanto para gravação
-                bool needsFrameCapture = (m_app.m_recordingManager && m_app.m_recordingManager->isRecording()) ||
+                bool needsFrameCapture = (m_app.m_recordingManager && m_app.m_recordingManager->isEncoding()) ||
                                         (m_app.m_streamManager && m_app.m_streamManager->isActive())
 #if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
                                         || (m_app.m_virtcam && m_app.m_virtcam->isRunning())
@@ -858,7 +859,7 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                         {
                             m_app.m_streamManager->pushFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight);
                         }
-                        if (m_app.m_recordingManager && m_app.m_recordingManager->isRecording())
+                        if (m_app.m_recordingManager && m_app.m_recordingManager->isEncoding())
                         {
                             m_app.m_recordingManager->pushFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight);
                         }
@@ -964,11 +965,73 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                         else             allowPBO = true;
 #endif
                     }
-                    bool useAsyncPBO = (allowPBO && m_app.m_pboManager &&
-                                        m_app.m_pboManager->init(textureWidth, textureHeight, readFormat) &&
-                                        m_app.m_pboManager->isInitialized());
 
-                    if (useAsyncPBO)
+                    // Encoder feed em YUV 4:2:0 convertido na GPU: RGBToYUVPass
+                    // renderiza Y + U/V lado a lado num alvo R8 e o ring de PBOs
+                    // lê 1.5 B/px em vez de 3; o MediaEncoder copia os planos
+                    // direto pro AVFrame (sem swscale RGB→YUV na thread do
+                    // encoder). A virtual camera continua querendo RGB(A), então
+                    // com ela ligada fica o caminho antigo. RETROCAPTURE_GPU_YUV=0
+                    // desliga para A/B.
+                    bool useGpuYuv = false;
+                    if (allowPBO && m_app.m_rgbToYuvPass && m_app.m_yuvPboManager &&
+                        (textureWidth % 2) == 0 && (textureHeight % 2) == 0)
+                    {
+                        const char *yuvEnv = std::getenv("RETROCAPTURE_GPU_YUV");
+                        bool virtcamRunning = false;
+#if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
+                        virtcamRunning = m_app.m_virtcam && m_app.m_virtcam->isRunning();
+#endif
+                        useGpuYuv = (!yuvEnv || yuvEnv[0] != '0') && !virtcamRunning &&
+                                    m_app.m_rgbToYuvPass->init() &&
+                                    m_app.m_yuvPboManager->init(textureWidth, textureHeight + textureHeight / 2, GL_RED);
+                    }
+
+                    // Só um dos rings fica vivo: ao alternar, slots pendentes
+                    // do outro entregariam um frame velho na volta.
+                    bool useAsyncPBO = false;
+                    if (useGpuYuv)
+                    {
+                        if (m_app.m_pboManager && m_app.m_pboManager->isInitialized())
+                        {
+                            m_app.m_pboManager->cleanup();
+                        }
+                    }
+                    else
+                    {
+                        if (m_app.m_yuvPboManager && m_app.m_yuvPboManager->isInitialized())
+                        {
+                            m_app.m_yuvPboManager->cleanup();
+                        }
+                        useAsyncPBO = (allowPBO && m_app.m_pboManager &&
+                                       m_app.m_pboManager->init(textureWidth, textureHeight, readFormat) &&
+                                       m_app.m_pboManager->isInitialized());
+                    }
+
+                    VideoFrameFormat frameFormat = VideoFrameFormat::RGB24;
+                    if (useGpuYuv)
+                    {
+                        glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+                        glDeleteFramebuffers(1, &captureFBO);
+
+                        const uint32_t yuvHeight = textureHeight + textureHeight / 2;
+                        if (m_app.m_rgbToYuvPass->render(fboTextureToAttach, textureWidth, textureHeight))
+                        {
+                            glBindFramebuffer(GL_FRAMEBUFFER, m_app.m_rgbToYuvPass->getFramebuffer());
+                            m_app.m_yuvPboManager->startAsyncRead(0, 0,
+                                                                  static_cast<GLsizei>(textureWidth),
+                                                                  static_cast<GLsizei>(yuvHeight));
+                            glBindFramebuffer(GL_FRAMEBUFFER, previousFBO);
+                        }
+
+                        // Mesmo atraso de ~1 frame do caminho RGB: lê o slot
+                        // pronto mais novo, sem flip (ordem bottom-up de sempre).
+                        frameFormat = VideoFrameFormat::YUV420SideBySide;
+                        frameData.resize(videoFrameBytes(frameFormat, textureWidth, textureHeight));
+                        frameDataReady = m_app.m_yuvPboManager->getReadData(
+                            frameData.data(), textureWidth, yuvHeight, /*flipY=*/false);
+                    }
+                    else if (useAsyncPBO)
                     {
                         // Agenda glReadPixels no PBO (não bloqueia).
                         m_app.m_pboManager->startAsyncRead(0, 0,
@@ -1006,41 +1069,44 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                         }
                         else
                         {
-                            auto &rgbaData = m_app.m_captureRgbaScratch;
-                            rgbaData.resize(static_cast<size_t>(textureWidth) *
-                                            static_cast<size_t>(textureHeight) * 4);
-                            if (m_app.m_pboManager->getReadData(rgbaData.data(),
-                                                          textureWidth, textureHeight,
-                                                          /*flipY=*/false))
-                            {
-                                // #85 — Virtual camera piggybacks on
-                                // this RGBA readback (shader path).
-                                // Push happens BEFORE the RGB strip
-                                // below so the sink keeps the alpha
-                                // channel intact (sws RGBA → YUYV).
-#if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
-                                if (m_app.m_virtcam && m_app.m_virtcam->isRunning())
+                            // Lê direto do PBO mapeado: a virtual camera
+                            // recebe o RGBA sem passar por um scratch e o
+                            // strip RGBA→RGB escreve direto em frameData
+                            // (antes: PBO→scratch→frameData, uma cópia
+                            // inteira de frame a mais por tick).
+                            frameData.resize(rgbDataSize);
+                            frameDataReady = m_app.m_pboManager->readMapped(
+                                textureWidth, textureHeight,
+                                [&](const uint8_t *rgba, size_t rowStride)
                                 {
-                                    m_app.m_virtcam->pushFrame(
-                                        rgbaData.data(),
-                                        textureWidth, textureHeight,
-                                        Application::VirtcamSinkT::SourceFormat::RGBA);
-                                }
+                                    // #85 — Virtual camera piggybacks on
+                                    // this RGBA readback (shader path).
+                                    // Push happens BEFORE the RGB strip
+                                    // below so the sink keeps the alpha
+                                    // channel intact (sws RGBA → YUYV).
+                                    // RGBA rows are always 4-byte aligned,
+                                    // so rowStride == width * 4 here.
+#if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
+                                    if (m_app.m_virtcam && m_app.m_virtcam->isRunning())
+                                    {
+                                        m_app.m_virtcam->pushFrame(
+                                            rgba,
+                                            textureWidth, textureHeight,
+                                            Application::VirtcamSinkT::SourceFormat::RGBA);
+                                    }
 #endif
-                                frameData.resize(rgbDataSize);
-                                for (uint32_t row = 0; row < textureHeight; row++)
-                                {
-                                    const uint8_t *src = rgbaData.data() + (row * textureWidth * 4);
-                                    uint8_t *dst = frameData.data() + (row * textureWidth * 3);
-                                    for (uint32_t col = 0; col < textureWidth; col++)
+                                    for (uint32_t row = 0; row < textureHeight; row++)
                                     {
-                                        dst[col * 3 + 0] = src[col * 4 + 0];
-                                        dst[col * 3 + 1] = src[col * 4 + 1];
-                                        dst[col * 3 + 2] = src[col * 4 + 2];
+                                        const uint8_t *src = rgba + (row * rowStride);
+                                        uint8_t *dst = frameData.data() + (row * textureWidth * 3);
+                                        for (uint32_t col = 0; col < textureWidth; col++)
+                                        {
+                                            dst[col * 3 + 0] = src[col * 4 + 0];
+                                            dst[col * 3 + 1] = src[col * 4 + 1];
+                                            dst[col * 3 + 2] = src[col * 4 + 2];
+                                        }
                                     }
-                                }
-                                frameDataReady = true;
-                            }
+                                });
                         }
                     }
                     else
@@ -1091,7 +1157,8 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                     // Verificar se o frame capturado está vazio/preto
                     // Isso ajuda a diagnosticar problemas com DirectFB
                     static int frameCheckCount = 0;
-                        if (frameCheckCount++ < 10 || frameCheckCount % 60 == 0)
+                        if (frameFormat == VideoFrameFormat::RGB24 &&
+                            (frameCheckCount++ < 10 || frameCheckCount % 60 == 0))
                         {
                             // Verificar se todos os pixels são pretos (0,0,0) ou se há dados válidos
                             size_t blackPixelCount = 0;
@@ -1134,7 +1201,7 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                         const bool shaderActive = (m_app.m_shaderEngine && m_app.m_shaderEngine->isShaderActive());
                         const bool streamWantsSource = m_app.m_ui && m_app.m_streamManager && m_app.m_streamManager->isActive() &&
                                                        !m_app.m_ui->getStreamingApplyShader();
-                        const bool recordWantsSource = m_app.m_ui && m_app.m_recordingManager && m_app.m_recordingManager->isRecording() &&
+                        const bool recordWantsSource = m_app.m_ui && m_app.m_recordingManager && m_app.m_recordingManager->isEncoding() &&
                                                        !m_app.m_ui->getRecordingApplyShader();
                         // Phase 2 of #47: /raw is by-contract pre-shader, so any connected
                         // /raw client also triggers the source-frame capture below.
@@ -1222,8 +1289,11 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                             // encode and left the remote client's video
                             // lagging the audio (and overflowed the /stream
                             // synchronizer continuously). Idle the /stream
-                            // encoder when no one is watching it.
-                            if (m_app.m_streamManager->hasClients())
+                            // encoder when no one is watching it — unless a
+                            // recording is consuming this encode through the
+                            // shared-encode bus, in which case it must run.
+                            if (m_app.m_streamManager->hasClients() ||
+                                m_app.m_streamManager->hasEncodeSubscribers())
                             {
                                 if (useSource)
                                 {
@@ -1231,7 +1301,7 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                                 }
                                 else
                                 {
-                                    m_app.m_streamManager->pushFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight);
+                                    m_app.m_streamManager->pushFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight, frameFormat);
                                 }
                             }
 
@@ -1259,11 +1329,11 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                                 }
                                 else if (!masterOn || !shaderActive)
                                 {
-                                    m_app.m_streamManager->pushRawFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight);
+                                    m_app.m_streamManager->pushRawFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight, frameFormat);
                                 }
                             }
                         }
-                        if (frameDataReady && m_app.m_recordingManager && m_app.m_recordingManager->isRecording())
+                        if (frameDataReady && m_app.m_recordingManager && m_app.m_recordingManager->isEncoding())
                         {
                             const bool useSource = recordWantsSource && sourceFrameReady;
                             static int recordingPushLogCount = 0;
@@ -1282,7 +1352,7 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
                             }
                             else
                             {
-                                m_app.m_recordingManager->pushFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight);
+                                m_app.m_recordingManager->pushFrame(frameData.data(), actualCaptureWidth, actualCaptureHeight, frameFormat);
                             }
                         }
                 } // fim do else (textura válida)
@@ -1353,6 +1423,7 @@ bool FrameCapturePipeline::renderAndDistributeFrame()
     {
         bool isRecording = m_app.m_recordingManager->isRecording();
         m_app.m_ui->setRecordingActive(isRecording);
+        m_app.m_ui->setReplayBufferActive(m_app.m_recordingManager->isReplayBufferActive());
         if (isRecording)
         {
             m_app.m_ui->setRecordingDurationUs(m_app.m_recordingManager->getCurrentDurationUs());
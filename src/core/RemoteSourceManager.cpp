@@ -252,7 +252,9 @@ void RemoteSourceManager::applyPendingRemoteMeta()
         if (!fullPath.empty())
         {
             LOG_INFO("RemoteMetaSync: applying host preset '" + preset + "' (hash " + presetHash + ")");
-            if (m_app.m_shaderEngine->loadPreset(fullPath))
+            // Host overrides ride along so they land together with the swap
+            const std::map<std::string, float> initialParams(params.begin(), params.end());
+            if (m_app.m_shaderEngine->loadPresetAsync(fullPath, initialParams))
             {
                 m_app.m_ui->setCurrentShader(preset);
                 m_app.m_appliedRemotePresetHash = presetHash;
@@ -280,18 +282,29 @@ void RemoteSourceManager::applyPendingRemoteMeta()
     }
 
     // Parameter overrides apply on top of whatever preset is now active.
-    // After a preset reload, the engine's parameters are at their preset
-    // defaults; layering the host's overrides on top reproduces the look.
+    // A preset loading in the background still has the old one on screen:
+    // the overrides go with the swap instead (on a reload they already
+    // did, as initialParams), so the outgoing shader never shows them.
     if (!params.empty())
     {
-        for (const auto &kv : params)
+        if (reloaded)
         {
-            m_app.m_shaderEngine->setShaderParameter(kv.first, kv.second);
+            LOG_INFO("RemoteMetaSync: queued " + std::to_string(params.size()) +
+                     " parameter override(s) with the preset");
         }
-        if (reloaded)
+        else if (!m_app.m_shaderEngine->getPendingPresetPath().empty())
+        {
+            for (const auto &kv : params)
+            {
+                m_app.m_shaderEngine->setPendingPresetParameter(kv.first, kv.second);
+            }
+        }
+        else
         {
-            LOG_INFO("RemoteMetaSync: applied " + std::to_string(params.size()) +
-                     " parameter override(s)");
+            for (const auto &kv : params)
+            {
+                m_app.m_shaderEngine->setShaderParameter(kv.first, kv.second);
+            }
         }
     }
 }
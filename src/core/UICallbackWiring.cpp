@@ -127,13 +127,17 @@ void UICallbackWiring::wireVisualCallbacks()
         // recarregar aqui zeraria m_customParameters do ShaderEngine
         // (vide ShaderEngine::loadPreset) e os overrides do capture preset
         // se perderiam silenciosamente.
-        if (m_app.m_shaderEngine->isShaderActive() &&
-            m_app.m_shaderEngine->getPresetPath() == fullPath) {
+        // O mesmo vale para um preset ainda compilando em segundo plano.
+        if (m_app.m_shaderEngine->getPendingPresetPath() == fullPath ||
+            (m_app.m_shaderEngine->getPendingPresetPath().empty() &&
+             m_app.m_shaderEngine->isShaderActive() &&
+             m_app.m_shaderEngine->getPresetPath() == fullPath)) {
             return;
         }
 
-        if (m_app.m_shaderEngine->loadPreset(fullPath)) {
-            LOG_INFO("Shader loaded via UI: " + shaderPath);
+        // Compila em segundo plano; o shader atual segue na tela até a troca
+        if (m_app.m_shaderEngine->loadPresetAsync(fullPath)) {
+            LOG_INFO("Shader loading via UI: " + shaderPath);
         } else {
             LOG_ERROR("Failed to load shader via UI: " + shaderPath);
         } });
@@ -424,6 +428,7 @@ void UICallbackWiring::wireVisualCallbacks()
     m_app.m_streamingQsvPreset   = m_app.m_ui->getStreamingQsvPreset();
     m_app.m_streamingAmfQuality  = m_app.m_ui->getStreamingAmfQuality();
     m_app.m_remoteInterpolation  = m_app.m_ui->getRemoteInterpolation();
+    m_app.m_remoteHwDecode       = m_app.m_ui->getRemoteHwDecode();
     m_app.m_remoteAudioGain      = m_app.m_ui->getRemoteAudioMuted() ? 0.0f : m_app.m_ui->getRemoteAudioVolume();
     m_app.m_streamingH265Preset = m_app.m_ui->getStreamingH265Preset();
     m_app.m_streamingH265Profile = m_app.m_ui->getStreamingH265Profile();
@@ -457,6 +462,12 @@ void UICallbackWiring::wireVisualCallbacks()
         settings.outputPath = m_app.m_ui->getRecordingOutputPath();
         settings.filenameTemplate = m_app.m_ui->getRecordingFilenameTemplate();
         settings.includeAudio = m_app.m_ui->getRecordingIncludeAudio();
+        settings.segmentRecording = m_app.m_ui->getRecordingSegmentRecording();
+        settings.maxDurationUs = m_app.m_ui->getRecordingMaxDurationUs();
+        settings.maxFileSize = m_app.m_ui->getRecordingMaxFileSize();
+        settings.replayBufferSeconds = m_app.m_ui->getRecordingReplayBufferSeconds();
+        settings.replayBufferMaxBytes = static_cast<uint64_t>(m_app.m_ui->getRecordingReplayBufferMaxMB()) * 1024 * 1024;
+        settings.shareStreamEncoder = m_app.m_ui->getRecordingShareStreamEncoder();
         // Hardware encoder + backend-specific preset (#59) — resolved
         // from the UI's per-backend preset fields based on the user's
         // selected backend. Auto/Software leave hwPreset empty so
@@ -924,6 +935,16 @@ void UICallbackWiring::wireStreamingCallbacks()
         }
     });
 
+    // Remote decoder choice — handed to the active VideoCaptureRemote,
+    // which reads it when it (re)connects; the running decoder is kept.
+    m_app.m_ui->setOnRemoteHwDecodeChanged([this](const std::string &v) {
+        m_app.m_remoteHwDecode = v;
+        if (auto *remote = dynamic_cast<VideoCaptureRemote *>(m_app.m_capture.get()))
+        {
+            remote->setHwDecodeMode(VideoCaptureRemote::hwDecodeModeFromString(v));
+        }
+    });
+
     // #77 Remote audio volume — UIManager hands us the effective gain
     // (muted ? 0 : volume); push it live to the active VideoCaptureRemote
     // (and remember it for any remote created later this session).
@@ -993,40 +1014,53 @@ void UICallbackWiring::wireStreamingCallbacks()
 
 void UICallbackWiring::wireRecordingCallbacks()
 {
+    // Settings for a session started now (recording or replay buffer).
+    // Use actual capture resolution and FPS, not UI settings
+    // This ensures the recording matches what's being captured
+    // CRITICAL: Use actual capture FPS to prevent video appearing sped up
+    auto sessionSettings = [this]()
+    {
+        RecordingSettings settings;
+        settings.width = m_app.m_captureWidth;
+        settings.height = m_app.m_captureHeight;
+        settings.fps = m_app.m_captureFps; // Use actual capture FPS, not UI setting
+        settings.bitrate = m_app.m_ui->getRecordingBitrate();
+        settings.codec = m_app.m_ui->getRecordingVideoCodec();
+        settings.preset = (settings.codec == "h264") ? m_app.m_ui->getRecordingH264Preset() : m_app.m_ui->getRecordingH265Preset();
+        settings.h265Profile = m_app.m_ui->getRecordingH265Profile();
+        settings.h265Level = m_app.m_ui->getRecordingH265Level();
+        settings.vp8Speed = m_app.m_ui->getRecordingVP8Speed();
+        settings.vp9Speed = m_app.m_ui->getRecordingVP9Speed();
+        settings.audioBitrate = m_app.m_ui->getRecordingAudioBitrate();
+        settings.audioCodec = m_app.m_ui->getRecordingAudioCodec();
+        settings.container = m_app.m_ui->getRecordingContainer();
+        settings.outputPath = m_app.m_ui->getRecordingOutputPath();
+        settings.filenameTemplate = m_app.m_ui->getRecordingFilenameTemplate();
+        settings.includeAudio = m_app.m_ui->getRecordingIncludeAudio();
+        settings.segmentRecording = m_app.m_ui->getRecordingSegmentRecording();
+        settings.maxDurationUs = m_app.m_ui->getRecordingMaxDurationUs();
+        settings.maxFileSize = m_app.m_ui->getRecordingMaxFileSize();
+        settings.replayBufferSeconds = m_app.m_ui->getRecordingReplayBufferSeconds();
+        settings.replayBufferMaxBytes = static_cast<uint64_t>(m_app.m_ui->getRecordingReplayBufferMaxMB()) * 1024 * 1024;
+        settings.shareStreamEncoder = m_app.m_ui->getRecordingShareStreamEncoder();
+        settings.hardwareEncoder = m_app.m_ui->getRecordingHardwareEncoder();
+        switch (settings.hardwareEncoder)
+        {
+            case 2: settings.hwPreset = m_app.m_ui->getRecordingNvencPreset(); break;
+            case 3: settings.hwPreset = m_app.m_ui->getRecordingVaapiRcMode(); break;
+            case 4: settings.hwPreset = m_app.m_ui->getRecordingQsvPreset();   break;
+            case 5: settings.hwPreset = m_app.m_ui->getRecordingAmfQuality();  break;
+            default: settings.hwPreset.clear(); break;
+        }
+        return settings;
+    };
+
     // Recording callbacks
-    m_app.m_ui->setOnRecordingStartStop([this](bool start)
+    m_app.m_ui->setOnRecordingStartStop([this, sessionSettings](bool start)
                                   {
         if (start) {
             if (m_app.m_recordingManager) {
-                RecordingSettings settings;
-                // Use actual capture resolution and FPS, not UI settings
-                // This ensures the recording matches what's being captured
-                // CRITICAL: Use actual capture FPS to prevent video appearing sped up
-                settings.width = m_app.m_captureWidth;
-                settings.height = m_app.m_captureHeight;
-                settings.fps = m_app.m_captureFps; // Use actual capture FPS, not UI setting
-                settings.bitrate = m_app.m_ui->getRecordingBitrate();
-                settings.codec = m_app.m_ui->getRecordingVideoCodec();
-                settings.preset = (settings.codec == "h264") ? m_app.m_ui->getRecordingH264Preset() : m_app.m_ui->getRecordingH265Preset();
-                settings.h265Profile = m_app.m_ui->getRecordingH265Profile();
-                settings.h265Level = m_app.m_ui->getRecordingH265Level();
-                settings.vp8Speed = m_app.m_ui->getRecordingVP8Speed();
-                settings.vp9Speed = m_app.m_ui->getRecordingVP9Speed();
-                settings.audioBitrate = m_app.m_ui->getRecordingAudioBitrate();
-                settings.audioCodec = m_app.m_ui->getRecordingAudioCodec();
-                settings.container = m_app.m_ui->getRecordingContainer();
-                settings.outputPath = m_app.m_ui->getRecordingOutputPath();
-                settings.filenameTemplate = m_app.m_ui->getRecordingFilenameTemplate();
-                settings.includeAudio = m_app.m_ui->getRecordingIncludeAudio();
-                settings.hardwareEncoder = m_app.m_ui->getRecordingHardwareEncoder();
-                switch (settings.hardwareEncoder)
-                {
-                    case 2: settings.hwPreset = m_app.m_ui->getRecordingNvencPreset(); break;
-                    case 3: settings.hwPreset = m_app.m_ui->getRecordingVaapiRcMode(); break;
-                    case 4: settings.hwPreset = m_app.m_ui->getRecordingQsvPreset();   break;
-                    case 5: settings.hwPreset = m_app.m_ui->getRecordingAmfQuality();  break;
-                    default: settings.hwPreset.clear(); break;
-                }
+                RecordingSettings settings = sessionSettings();
 
                 if (!m_app.m_recordingManager) {
                     LOG_ERROR("Application: RecordingManager not initialized. Cannot start recording.");
@@ -1036,6 +1070,7 @@ void UICallbackWiring::wireRecordingCallbacks()
                     // the recording's embedded metadata reflects exactly
                     // what was active when the session started (#59).
                     m_app.populateRecordingContext();
+                    m_app.updateRecordingEncodeSource();
                     if (m_app.m_recordingManager->startRecording(settings)) {
                         LOG_INFO("Application: Recording started successfully");
                         m_app.m_ui->setRecordingActive(true);
@@ -1188,6 +1223,47 @@ void UICallbackWiring::wireRecordingCallbacks()
             m_app.m_recordingManager->setRecordingSettings(settings);
         } });
 
+    m_app.m_ui->setOnRecordingSegmentChanged([this](bool enabled, uint64_t maxDurationUs, uint64_t maxFileSize)
+                                       {
+        if (m_app.m_recordingManager) {
+            RecordingSettings settings = m_app.m_recordingManager->getRecordingSettings();
+            settings.segmentRecording = enabled;
+            settings.maxDurationUs = maxDurationUs;
+            settings.maxFileSize = maxFileSize;
+            m_app.m_recordingManager->setRecordingSettings(settings);
+        } });
+
+    // Instant replay (F9 / API / UI button)
+    m_app.m_ui->setOnReplayBufferStartStop([this, sessionSettings](bool start)
+                                     {
+        if (!m_app.m_recordingManager) {
+            m_app.m_ui->setReplayBufferActive(false);
+            return;
+        }
+        if (start) {
+            m_app.populateRecordingContext();
+            m_app.updateRecordingEncodeSource();
+            if (!m_app.m_recordingManager->startReplayBuffer(sessionSettings())) {
+                LOG_ERROR("Application: Failed to start replay buffer. Check logs for details.");
+            }
+        } else {
+            m_app.m_recordingManager->stopReplayBuffer();
+        }
+        m_app.m_ui->setReplayBufferActive(m_app.m_recordingManager->isReplayBufferActive()); });
+
+    m_app.m_ui->setOnReplaySave([this](uint32_t seconds, std::string *outputPath)
+                          {
+        return m_app.m_recordingManager && m_app.m_recordingManager->saveReplay(seconds, outputPath); });
+
+    m_app.m_ui->setOnRecordingReplayLimitsChanged([this](uint32_t seconds, uint32_t maxMB)
+                                            {
+        if (m_app.m_recordingManager) {
+            RecordingSettings settings = m_app.m_recordingManager->getRecordingSettings();
+            settings.replayBufferSeconds = seconds;
+            settings.replayBufferMaxBytes = static_cast<uint64_t>(maxMB) * 1024 * 1024;
+            m_app.m_recordingManager->setRecordingSettings(settings);
+        } });
+
 }
 
 void UICallbackWiring::wireWebPortalCallbacks()
@@ -1490,6 +1566,7 @@ void UICallbackWiring::wireSourceAndMiscCallbacks()
                                              else if (wantRemote) m_app.m_capture = std::make_unique<VideoCaptureRemote>();
                                              else if (wantTest)   m_app.m_capture = std::make_unique<VideoCaptureTestPattern>();
                                              else                 m_app.m_capture = VideoCaptureFactory::create();
+                                             if (m_app.m_capture) m_app.m_capture->setPreferredPixelFormat(m_app.m_v4l2PixelFormat);
 
                                              // Factory backend with no device yet → idle dummy
                                              // so there's always valid output (black) until the
@@ -1827,6 +1904,7 @@ void UICallbackWiring::wireSourceAndMiscCallbacks()
                                              if (m_app.m_remoteInterpolation == "nearest") imode = VideoCaptureRemote::InterpolationMode::Nearest;
                                              else if (m_app.m_remoteInterpolation == "off") imode = VideoCaptureRemote::InterpolationMode::Off;
                                              remote->setInterpolationMode(imode);
+                                             remote->setHwDecodeMode(VideoCaptureRemote::hwDecodeModeFromString(m_app.m_remoteHwDecode));
                                              remote->setAudioVolume(m_app.m_remoteAudioGain);
                                              m_app.m_capture = std::move(remote);
                                          }
@@ -2004,6 +2082,7 @@ void UICallbackWiring::wireSourceAndMiscCallbacks()
                 if (m_app.m_remoteInterpolation == "nearest") imode = VideoCaptureRemote::InterpolationMode::Nearest;
                 else if (m_app.m_remoteInterpolation == "off") imode = VideoCaptureRemote::InterpolationMode::Off;
                 remote->setInterpolationMode(imode);
+                remote->setHwDecodeMode(VideoCaptureRemote::hwDecodeModeFromString(m_app.m_remoteHwDecode));
                 remote->setAudioVolume(m_app.m_remoteAudioGain);
                 remote->setAuthToken(authToken);
                 m_app.m_capture = std::move(remote);
@@ -2130,6 +2209,7 @@ void UICallbackWiring::wireSourceAndMiscCallbacks()
             LOG_INFO("Device change: active capture is not a local device backend — rebuilding via factory (#97)");
             if (m_app.m_remoteMetaSync) { m_app.m_remoteMetaSync->stop(); m_app.m_remoteMetaSync.reset(); }
             m_app.m_capture = VideoCaptureFactory::create();
+            if (m_app.m_capture) m_app.m_capture->setPreferredPixelFormat(m_app.m_v4l2PixelFormat);
             if (m_app.m_ui) m_app.m_ui->setCaptureControls(m_app.m_capture.get());
         }
 
@@ -0,0 +1,114 @@
+#include "EncodedPacketBus.h"
+#include "../utils/Logger.h"
+
+EncodedPacketBus::~EncodedPacketBus()
+{
+    detachSource();
+}
+
+void EncodedPacketBus::attachSource(MediaEncoder *encoder)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_source = encoder;
+}
+
+void EncodedPacketBus::detachSource()
+{
+    std::map<uint64_t, Subscriber> subscribers;
+    int64_t epochUs = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_source)
+        {
+            return;
+        }
+        epochUs = m_source->getTimestampEpochUs();
+        m_source = nullptr;
+        subscribers.swap(m_subscribers);
+    }
+
+    // Outside the lock: a detach handler may immediately try to subscribe
+    // somewhere else (or unsubscribe), which must not deadlock.
+    for (auto &entry : subscribers)
+    {
+        if (entry.second.onDetach)
+        {
+            entry.second.onDetach(epochUs);
+        }
+    }
+    if (!subscribers.empty())
+    {
+        LOG_INFO("EncodedPacketBus: source detached, " + std::to_string(subscribers.size()) +
+                 " subscriber(s) falling back to their own encoder");
+    }
+}
+
+void EncodedPacketBus::publish(const std::vector<MediaEncoder::EncodedPacket> &packets)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_subscribers.empty())
+    {
+        return;
+    }
+    for (const auto &packet : packets)
+    {
+        for (auto &entry : m_subscribers)
+        {
+            entry.second.onPacket(packet);
+        }
+    }
+}
+
+uint64_t EncodedPacketBus::subscribe(const MediaEncoder::VideoConfig &videoConfig,
+                                     const MediaEncoder::AudioConfig &audioConfig,
+                                     PacketCallback onPacket,
+                                     DetachCallback onDetach,
+                                     SourceInfo &info)
+{
+    if (!onPacket)
+    {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_source || !m_source->isInitialized())
+    {
+        return 0;
+    }
+    if (!MediaEncoder::canShareEncode(m_source->getVideoConfig(), m_source->getAudioConfig(),
+                                      videoConfig, audioConfig))
+    {
+        return 0;
+    }
+
+    info.videoConfig = m_source->getVideoConfig();
+    info.audioConfig = m_source->getAudioConfig();
+    info.videoCodecContext = m_source->getVideoCodecContext();
+    info.audioCodecContext = m_source->getAudioCodecContext();
+
+    const uint64_t id = m_nextId++;
+    m_subscribers[id] = Subscriber{std::move(onPacket), std::move(onDetach)};
+    m_source->requestKeyframe();
+    return id;
+}
+
+void EncodedPacketBus::unsubscribe(uint64_t id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_subscribers.erase(id);
+}
+
+bool EncodedPacketBus::hasSubscribers() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_subscribers.empty();
+}
+
+void EncodedPacketBus::requestKeyframe()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_source)
+    {
+        m_source->requestKeyframe();
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "MediaEncoder.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * EncodedPacketBus - fan-out of one MediaEncoder's output to extra sinks.
+ *
+ * Recording and the /stream endpoint used to each own a MediaEncoder and
+ * encode the very same rendered frame twice. When the two sides are
+ * configured identically, the recording subscribes to the streamer's bus
+ * instead: the streamer's encoding thread publishes every packet it muxes
+ * and the subscriber writes it to its own container — one x264/VAAPI
+ * encode, several sinks.
+ *
+ * The publisher owns the encoder. It calls attachSource() once the
+ * encoder is initialized and detachSource() BEFORE tearing it down;
+ * detachSource() fires every subscriber's DetachCallback so they can fall
+ * back to a private encoder. Codec contexts handed out by subscribe() are
+ * only valid until that callback runs.
+ *
+ * Callbacks run on the publisher's thread with the bus lock held, so
+ * unsubscribe() returning guarantees no callback is in flight. Keep them
+ * cheap (queue and return).
+ */
+class EncodedPacketBus
+{
+public:
+    using PacketCallback = std::function<void(const MediaEncoder::EncodedPacket &packet)>;
+    // epochUs is the source encoder's shared A/V timestamp origin, so a
+    // replacement encoder can continue the same PTS timeline.
+    using DetachCallback = std::function<void(int64_t epochUs)>;
+
+    struct SourceInfo
+    {
+        MediaEncoder::VideoConfig videoConfig;
+        MediaEncoder::AudioConfig audioConfig;
+        void *videoCodecContext = nullptr; // AVCodecContext*
+        void *audioCodecContext = nullptr; // AVCodecContext*
+    };
+
+    EncodedPacketBus() = default;
+    ~EncodedPacketBus();
+
+    // Publisher side
+    void attachSource(MediaEncoder *encoder);
+    void detachSource();
+    void publish(const std::vector<MediaEncoder::EncodedPacket> &packets);
+
+    // Subscriber side. Returns a non-zero id and fills `info` only when a
+    // source is attached and its settings match the requested ones
+    // (MediaEncoder::canShareEncode); 0 means "encode separately".
+    uint64_t subscribe(const MediaEncoder::VideoConfig &videoConfig,
+                       const MediaEncoder::AudioConfig &audioConfig,
+                       PacketCallback onPacket,
+                       DetachCallback onDetach,
+                       SourceInfo &info);
+    void unsubscribe(uint64_t id);
+
+    bool hasSubscribers() const;
+
+    // Ask the source for an IDR on its next frame — a new subscriber (or
+    // one that dropped packets) can only start writing at a keyframe.
+    void requestKeyframe();
+
+private:
+    struct Subscriber
+    {
+        PacketCallback onPacket;
+        DetachCallback onDetach;
+    };
+
+    mutable std::mutex m_mutex;
+    MediaEncoder *m_source = nullptr;
+    std::map<uint64_t, Subscriber> m_subscribers;
+    uint64_t m_nextId = 1;
+};
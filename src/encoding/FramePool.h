@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * FramePool - recycled, size-bucketed buffers for MediaSynchronizer.
+ *
+ * Every captured frame used to be copied into a fresh
+ * make_shared<vector>: ~6 MB at 1080p RGB, 60 times a second, per
+ * synchronizer. Allocations that size go straight to mmap/munmap in
+ * glibc, so each frame paid page faults on first touch and RSS
+ * sawtoothed with the encoder's drain rhythm.
+ *
+ * The pool owns refcounted slabs grouped by (rounded-up) element count.
+ * acquire() hands out another reference to a slab — it shares the
+ * slab's control block, so handing a buffer out allocates nothing — and
+ * the slab becomes reusable as soon as every consumer copy is released
+ * (use_count drops back to the pool's own reference).
+ * Consumers keep seeing a plain shared_ptr<vector<T>>.
+ *
+ * Slabs outlive the pool safely: a buffer still held by an encoder
+ * thread when the pool is destroyed just frees itself on release.
+ */
+template <typename T>
+class FramePool
+{
+public:
+    using Buffer = std::shared_ptr<std::vector<T>>;
+
+    // maxSlabsPerBucket bounds memory when a consumer stalls: past it,
+    // acquire() falls back to an unpooled buffer instead of growing.
+    explicit FramePool(size_t maxSlabsPerBucket = 32)
+        : m_maxSlabsPerBucket(maxSlabsPerBucket)
+    {
+    }
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    /**
+     * Buffer with size() == count. Contents are whatever the slab held
+     * last — callers are expected to overwrite it.
+     */
+    Buffer acquire(size_t count)
+    {
+        const size_t capacity = bucketCapacity(count);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint64_t tick = ++m_tick;
+        if ((tick % kSweepInterval) == 0)
+        {
+            sweepIdleBuckets(tick);
+        }
+
+        Bucket &bucket = findOrCreateBucket(capacity);
+        bucket.lastUseTick = tick;
+
+        for (auto &slab : bucket.slabs)
+        {
+            // Only the pool's own reference left -> every consumer has
+            // released it. The acquire fence pairs with the release
+            // half of the consumer's refcount decrement so their last
+            // reads of the buffer happen-before we hand it out again.
+            if (slab.use_count() == 1)
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                slab->resize(count);
+                m_reused.fetch_add(1, std::memory_order_relaxed);
+                return slab;
+            }
+        }
+
+        m_allocated.fetch_add(1, std::memory_order_relaxed);
+        auto slab = std::make_shared<std::vector<T>>();
+        slab->reserve(capacity);
+        slab->resize(count);
+        if (bucket.slabs.size() < m_maxSlabsPerBucket)
+        {
+            bucket.slabs.push_back(slab);
+        }
+        return slab;
+    }
+
+    // Convenience: acquire + copy, the shape every caller actually wants.
+    Buffer acquireCopy(const T *src, size_t count)
+    {
+        Buffer buffer = acquire(count);
+        std::copy(src, src + count, buffer->data());
+        return buffer;
+    }
+
+    /**
+     * Drop every slab not currently held by a consumer. Buffers still in
+     * flight stay valid; they are simply no longer recycled.
+     */
+    void trim()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &bucket : m_buckets)
+        {
+            dropFreeSlabs(bucket);
+        }
+        m_buckets.erase(std::remove_if(m_buckets.begin(), m_buckets.end(),
+                                       [](const Bucket &b)
+                                       { return b.slabs.empty(); }),
+                        m_buckets.end());
+    }
+
+    // Statistics: a healthy steady state shows allocated flat while
+    // reused keeps climbing.
+    uint64_t getAllocatedCount() const { return m_allocated.load(std::memory_order_relaxed); }
+    uint64_t getReusedCount() const { return m_reused.load(std::memory_order_relaxed); }
+
+    size_t getPooledBytes() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t bytes = 0;
+        for (const auto &bucket : m_buckets)
+        {
+            bytes += bucket.capacity * sizeof(T) * bucket.slabs.size();
+        }
+        return bytes;
+    }
+
+private:
+    struct Bucket
+    {
+        size_t capacity = 0;
+        uint64_t lastUseTick = 0;
+        std::vector<std::shared_ptr<std::vector<T>>> slabs;
+    };
+
+    // Element counts are rounded up to 4 KiB so audio chunks whose size
+    // jitters by a few samples between callbacks still share a bucket,
+    // while a fixed-resolution video stream wastes at most one page.
+    static constexpr size_t kBucketBytes = 4096;
+    // Buckets untouched for this many acquires (e.g. the old resolution
+    // after a format change) have their free slabs released.
+    static constexpr uint64_t kSweepInterval = 256;
+
+    static size_t bucketCapacity(size_t count)
+    {
+        const size_t granule = std::max<size_t>(1, kBucketBytes / sizeof(T));
+        return ((count + granule - 1) / granule) * granule;
+    }
+
+    Bucket &findOrCreateBucket(size_t capacity)
+    {
+        for (auto &bucket : m_buckets)
+        {
+            if (bucket.capacity == capacity)
+            {
+                return bucket;
+            }
+        }
+        m_buckets.emplace_back();
+        m_buckets.back().capacity = capacity;
+        return m_buckets.back();
+    }
+
+    static void dropFreeSlabs(Bucket &bucket)
+    {
+        bucket.slabs.erase(std::remove_if(bucket.slabs.begin(), bucket.slabs.end(),
+                                          [](const std::shared_ptr<std::vector<T>> &s)
+                                          { return s.use_count() == 1; }),
+                           bucket.slabs.end());
+    }
+
+    void sweepIdleBuckets(uint64_t tick)
+    {
+        for (auto &bucket : m_buckets)
+        {
+            if (tick - bucket.lastUseTick >= kSweepInterval)
+            {
+                dropFreeSlabs(bucket);
+            }
+        }
+        m_buckets.erase(std::remove_if(m_buckets.begin(), m_buckets.end(),
+                                       [](const Bucket &b)
+                                       { return b.slabs.empty(); }),
+                        m_buckets.end());
+    }
+
+    const size_t m_maxSlabsPerBucket;
+    mutable std::mutex m_mutex;
+    std::vector<Bucket> m_buckets; // few entries (one per live resolution)
+    uint64_t m_tick = 0;
+    std::atomic<uint64_t> m_allocated{0};
+    std::atomic<uint64_t> m_reused{0};
+};
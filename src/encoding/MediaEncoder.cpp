@@ -95,6 +95,53 @@ std::vector<MediaEncoder::HardwareEncoder> MediaEncoder::detectAvailableEncoders
     return cache;
 }
 
+bool MediaEncoder::canShareEncode(const VideoConfig &videoA, const AudioConfig &audioA,
+                                  const VideoConfig &videoB, const AudioConfig &audioB)
+{
+    if (videoA.codec != videoB.codec ||
+        videoA.width != videoB.width || videoA.height != videoB.height ||
+        videoA.fps != videoB.fps || videoA.bitrate != videoB.bitrate ||
+        videoA.hardwareEncoder != videoB.hardwareEncoder || videoA.hwPreset != videoB.hwPreset)
+    {
+        return false;
+    }
+
+    const std::string &codec = videoA.codec;
+    if (codec == "h264" || codec == "libx264")
+    {
+        if (videoA.preset != videoB.preset || videoA.profile != videoB.profile)
+        {
+            return false;
+        }
+    }
+    else if (codec == "h265" || codec == "libx265" || codec == "hevc")
+    {
+        if (videoA.preset != videoB.preset || videoA.h265Profile != videoB.h265Profile ||
+            videoA.h265Level != videoB.h265Level)
+        {
+            return false;
+        }
+    }
+    else if (codec == "vp8")
+    {
+        if (videoA.vp8Speed != videoB.vp8Speed)
+        {
+            return false;
+        }
+    }
+    else if (codec == "vp9")
+    {
+        if (videoA.vp9Speed != videoB.vp9Speed)
+        {
+            return false;
+        }
+    }
+
+    return !audioA.codec.empty() && audioA.codec == audioB.codec &&
+           audioA.sampleRate == audioB.sampleRate && audioA.channels == audioB.channels &&
+           audioA.bitrate == audioB.bitrate;
+}
+
 MediaEncoder::MediaEncoder()
 {
 }
@@ -978,7 +1025,8 @@ bool MediaEncoder::convertRGBToYUV(const uint8_t *rgbData, uint32_t width, uint3
     SwsContext *swsCtx = static_cast<SwsContext *>(m_swsContext);
     if (!swsCtx || m_swsSrcWidth != width || m_swsSrcHeight != height ||
         m_swsDstWidth != dstWidth || m_swsDstHeight != dstHeight ||
-        static_cast<int>(m_swsDstFormat) != static_cast<int>(dstFormat))
+        static_cast<int>(m_swsDstFormat) != static_cast<int>(dstFormat) ||
+        m_swsSrcFormat != static_cast<int>(AV_PIX_FMT_RGB24))
     {
         if (swsCtx)
         {
@@ -1002,6 +1050,7 @@ bool MediaEncoder::convertRGBToYUV(const uint8_t *rgbData, uint32_t width, uint3
         m_swsDstWidth = dstWidth;
         m_swsDstHeight = dstHeight;
         m_swsDstFormat = static_cast<int>(dstFormat);
+        m_swsSrcFormat = static_cast<int>(AV_PIX_FMT_RGB24);
     }
 
     if (av_frame_make_writable(frame) < 0)
@@ -1013,13 +1062,10 @@ bool MediaEncoder::convertRGBToYUV(const uint8_t *rgbData, uint32_t width, uint3
     const size_t srcBytes = static_cast<size_t>(srcStride) * height;
 
     // Copy into the padded scratch so libswscale's AVX2 fastpath can
-    // safely over-read past the last row (see the note above). 64 is
-    // FFmpeg's AV_INPUT_BUFFER_PADDING_SIZE; the fastpath reads at most
-    // a couple of SIMD registers past the end, well within that.
-    constexpr size_t kSwsTailPad = 64;
-    if (m_swsSrcPadded.size() < srcBytes + kSwsTailPad)
+    // safely over-read past the last row (see the note above).
+    if (m_swsSrcPadded.size() < srcBytes + FFmpegCompat::kSwsTailPad)
     {
-        m_swsSrcPadded.resize(srcBytes + kSwsTailPad);
+        m_swsSrcPadded.resize(srcBytes + FFmpegCompat::kSwsTailPad);
     }
     std::memcpy(m_swsSrcPadded.data(), rgbData, srcBytes);
 
@@ -1042,6 +1088,105 @@ bool MediaEncoder::convertRGBToYUV(const uint8_t *rgbData, uint32_t width, uint3
     return true;
 }
 
+bool MediaEncoder::copyYUV420ToFrame(const uint8_t *data, uint32_t width, uint32_t height, void *videoFrame)
+{
+    AVFrame *frame = static_cast<AVFrame *>(videoFrame);
+    if (!data || !frame || width < 2 || height < 2 || (width & 1) || (height & 1))
+    {
+        return false;
+    }
+
+    // Plane pointers into the side-by-side layout (see VideoFrameFormat.h).
+    const uint32_t chromaWidth = width / 2;
+    const uint32_t chromaHeight = height / 2;
+    const uint8_t *srcY = data;
+    const uint8_t *srcU = data + static_cast<size_t>(width) * height;
+    const uint8_t *srcV = srcU + chromaWidth;
+    const int srcLinesize = static_cast<int>(width);
+
+    AVPixelFormat dstFormat = static_cast<AVPixelFormat>(frame->format);
+    if (dstFormat != AV_PIX_FMT_YUV420P && dstFormat != AV_PIX_FMT_NV12)
+    {
+        dstFormat = AV_PIX_FMT_YUV420P;
+    }
+
+    if (av_frame_make_writable(frame) < 0)
+    {
+        return false;
+    }
+
+    const uint32_t dstWidth = m_videoConfig.width;
+    const uint32_t dstHeight = m_videoConfig.height;
+    if (width != dstWidth || height != dstHeight)
+    {
+        // Resize still needs swscale, but from YUV420P it's a plain
+        // per-plane scale instead of colour conversion + scale.
+        SwsContext *swsCtx = static_cast<SwsContext *>(m_swsContext);
+        if (!swsCtx || m_swsSrcWidth != width || m_swsSrcHeight != height ||
+            m_swsDstWidth != dstWidth || m_swsDstHeight != dstHeight ||
+            m_swsDstFormat != static_cast<int>(dstFormat) ||
+            m_swsSrcFormat != static_cast<int>(AV_PIX_FMT_YUV420P))
+        {
+            if (swsCtx)
+            {
+                sws_freeContext(swsCtx);
+            }
+            swsCtx = sws_getContext(width, height, AV_PIX_FMT_YUV420P,
+                                    dstWidth, dstHeight, dstFormat,
+                                    SWS_BILINEAR, nullptr, nullptr, nullptr);
+            m_swsContext = swsCtx;
+            if (!swsCtx)
+            {
+                LOG_ERROR("Failed to create SwsContext (YUV420P)");
+                return false;
+            }
+            m_swsSrcWidth = width;
+            m_swsSrcHeight = height;
+            m_swsDstWidth = dstWidth;
+            m_swsDstHeight = dstHeight;
+            m_swsDstFormat = static_cast<int>(dstFormat);
+            m_swsSrcFormat = static_cast<int>(AV_PIX_FMT_YUV420P);
+        }
+        const uint8_t *srcData[3] = {srcY, srcU, srcV};
+        int srcLinesizes[3] = {srcLinesize, srcLinesize, srcLinesize};
+        int ret = sws_scale(swsCtx, srcData, srcLinesizes, 0, height, frame->data, frame->linesize);
+        return ret == static_cast<int>(dstHeight);
+    }
+
+    for (uint32_t row = 0; row < height; row++)
+    {
+        std::memcpy(frame->data[0] + static_cast<size_t>(row) * frame->linesize[0],
+                    srcY + static_cast<size_t>(row) * srcLinesize, width);
+    }
+
+    if (dstFormat == AV_PIX_FMT_YUV420P)
+    {
+        for (uint32_t row = 0; row < chromaHeight; row++)
+        {
+            std::memcpy(frame->data[1] + static_cast<size_t>(row) * frame->linesize[1],
+                        srcU + static_cast<size_t>(row) * srcLinesize, chromaWidth);
+            std::memcpy(frame->data[2] + static_cast<size_t>(row) * frame->linesize[2],
+                        srcV + static_cast<size_t>(row) * srcLinesize, chromaWidth);
+        }
+    }
+    else
+    {
+        // NV12 (VAAPI/QSV/AMF upload surface): interleave U and V.
+        for (uint32_t row = 0; row < chromaHeight; row++)
+        {
+            const uint8_t *u = srcU + static_cast<size_t>(row) * srcLinesize;
+            const uint8_t *v = srcV + static_cast<size_t>(row) * srcLinesize;
+            uint8_t *uv = frame->data[1] + static_cast<size_t>(row) * frame->linesize[1];
+            for (uint32_t x = 0; x < chromaWidth; x++)
+            {
+                uv[2 * x] = u[x];
+                uv[2 * x + 1] = v[x];
+            }
+        }
+    }
+    return true;
+}
+
 bool MediaEncoder::convertInt16ToFloatPlanar(const int16_t *samples, size_t sampleCount, void *audioFrame, size_t outputSamples)
 {
     if (!samples || !audioFrame || sampleCount == 0 || outputSamples == 0)
@@ -1510,15 +1655,16 @@ void MediaEncoder::ensureMonotonicPTS(int64_t &pts, int64_t &dts, bool isVideo)
     }
 }
 
-bool MediaEncoder::encodeVideo(const uint8_t *rgbData, uint32_t width, uint32_t height,
-                               int64_t captureTimestampUs, std::vector<EncodedPacket> &packets)
+bool MediaEncoder::encodeVideo(const uint8_t *data, uint32_t width, uint32_t height,
+                               int64_t captureTimestampUs, std::vector<EncodedPacket> &packets,
+                               VideoFrameFormat format)
 {
-    if (!rgbData || !m_initialized || width == 0 || height == 0)
+    if (!data || !m_initialized || width == 0 || height == 0)
     {
         return false;
     }
 
-    size_t expectedSize = static_cast<size_t>(width) * static_cast<size_t>(height) * 3;
+    size_t expectedSize = videoFrameBytes(format, width, height);
     if (expectedSize == 0 || expectedSize > 100 * 1024 * 1024)
     {
         LOG_ERROR("MediaEncoder: Invalid frame dimensions: " + std::to_string(width) + "x" + std::to_string(height));
@@ -1539,7 +1685,15 @@ bool MediaEncoder::encodeVideo(const uint8_t *rgbData, uint32_t width, uint32_t
     using stage_clock = std::chrono::steady_clock;
     auto stageT0 = stage_clock::now();
 
-    if (!convertRGBToYUV(rgbData, width, height, videoFrame))
+    if (format == VideoFrameFormat::YUV420SideBySide)
+    {
+        if (!copyYUV420ToFrame(data, width, height, videoFrame))
+        {
+            LOG_ERROR("MediaEncoder: copyYUV420ToFrame failed");
+            return false;
+        }
+    }
+    else if (!convertRGBToYUV(data, width, height, videoFrame))
     {
         LOG_ERROR("MediaEncoder: convertRGBToYUV failed");
         return false;
@@ -1550,7 +1704,7 @@ bool MediaEncoder::encodeVideo(const uint8_t *rgbData, uint32_t width, uint32_t
     videoFrame->pts = calculatedPTS;
 
     bool forceKeyframe = false;
-    if (m_videoFrameCount == 0)
+    if (m_videoFrameCount == 0 || m_keyframeRequested.exchange(false, std::memory_order_relaxed))
     {
         forceKeyframe = true;
     }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "VideoFrameFormat.h"
 #include <atomic>
 #include <cstdint>
 #include <string>
@@ -98,8 +99,11 @@ public:
 
     // Encoding de vídeo: RGB → YUV → codec
     // Retorna true se frame foi enviado ao codec (pode gerar 0 ou mais pacotes)
-    bool encodeVideo(const uint8_t *rgbData, uint32_t width, uint32_t height,
-                     int64_t captureTimestampUs, std::vector<EncodedPacket> &packets);
+    // Frames already converted on the GPU (VideoFrameFormat::YUV420SideBySide)
+    // skip swscale unless they need resizing.
+    bool encodeVideo(const uint8_t *data, uint32_t width, uint32_t height,
+                     int64_t captureTimestampUs, std::vector<EncodedPacket> &packets,
+                     VideoFrameFormat format = VideoFrameFormat::RGB24);
 
     // Encoding de áudio: int16 → float planar → codec
     // Retorna true se samples foram processados (pode gerar 0 ou mais pacotes)
@@ -127,13 +131,38 @@ public:
     int64_t getVideoFrameCount() const { return m_videoFrameCount; }
     void resetVideoFrameCount() { m_videoFrameCount = 0; }
 
+    // Force an IDR on the next encodeVideo() call. Thread-safe — used by
+    // EncodedPacketBus when a new sink joins a running encode and can only
+    // start writing at a keyframe.
+    void requestKeyframe() { m_keyframeRequested.store(true, std::memory_order_relaxed); }
+
+    // Shared A/V timestamp origin (#109). Exposed so a replacement encoder
+    // can take over a running output on the same PTS timeline (shared
+    // encode fallback); call setTimestampEpochUs after initialize() and
+    // before the first encode. Returns 0 while no media has been encoded yet.
+    int64_t getTimestampEpochUs() const { return m_firstMediaTimestampSet ? m_firstMediaTimestampUs : 0; }
+    void setTimestampEpochUs(int64_t epochUs)
+    {
+        m_firstMediaTimestampUs = epochUs;
+        m_firstMediaTimestampSet = epochUs != 0;
+    }
+
+    // True when an encoder configured with `a` produces a bitstream a
+    // consumer configured with `b` can use as-is — same codec, geometry,
+    // rate control and backend. Fields irrelevant to the codec in use
+    // (e.g. x264 profile for VP9) are ignored. An empty audio codec on
+    // either side never matches.
+    static bool canShareEncode(const VideoConfig &videoA, const AudioConfig &audioA,
+                               const VideoConfig &videoB, const AudioConfig &audioB);
+
     // Eventos de retrocesso de PTS (forçar pra frente para preservar monotonicidade).
     // Não-zero indica instabilidade no timestamp source.
     uint64_t getDesyncFrameCount() const { return m_desyncFrameCount.load(std::memory_order_relaxed); }
 
     // #123 — per-stage video encode timing, in microseconds, accumulated
     // since the last fetch. encodeVideo() splits its cost into:
-    //   convertUs — convertRGBToYUV (CPU swscale: RGB→NV12 + any resize)
+    //   convertUs — convertRGBToYUV (CPU swscale: RGB→NV12 + any resize),
+    //               or the plane copy for GPU-converted frames
     //   uploadUs  — av_hwframe_transfer_data (sw NV12 → GPU surface; 0 for SW/NVENC)
     //   encodeUs  — avcodec_send_frame + receiveVideoPackets (codec)
     // frames is how many encodeVideo calls contributed. fetch resets the
@@ -156,6 +185,9 @@ private:
 
     // Conversão de formatos
     bool convertRGBToYUV(const uint8_t *rgbData, uint32_t width, uint32_t height, void *videoFrame);
+    // YUV420SideBySide → frame (YUV420P or NV12). Plain row copies when
+    // the size already matches; swscale only for a resize.
+    bool copyYUV420ToFrame(const uint8_t *data, uint32_t width, uint32_t height, void *videoFrame);
     bool convertInt16ToFloatPlanar(const int16_t *samples, size_t sampleCount, void *audioFrame, size_t outputSamples);
 
     // Processar pacotes do codec
@@ -200,6 +232,7 @@ private:
     uint32_t m_swsDstWidth = 0;
     uint32_t m_swsDstHeight = 0;
     int m_swsDstFormat = 0; // AVPixelFormat — invalidate sws ctx when destination format changes too
+    int m_swsSrcFormat = 0; // AVPixelFormat — RGB24, or YUV420P for resized GPU-converted frames
 
     // Padded scratch for the sws_scale source. libswscale's AVX2 RGB
     // fastpath reads a few SIMD chunks past the last row; if the
@@ -240,6 +273,7 @@ private:
 
     // Contador de frames para keyframes periódicos
     int64_t m_videoFrameCount = 0;
+    std::atomic<bool> m_keyframeRequested{false};
 
     // Audio accumulator para acumular samples até ter um frame completo
     std::mutex m_audioAccumulatorMutex;
@@ -71,6 +71,17 @@ void MediaMuxer::setMetadata(const std::map<std::string, std::string> &metadata)
     m_userMetadata = metadata;
 }
 
+void MediaMuxer::setFragmented(bool fragmented)
+{
+    // Staged like setMetadata(); only mp4/mov honour it.
+    m_fragmented = fragmented;
+}
+
+void MediaMuxer::setFormatOption(const std::string &key, const std::string &value)
+{
+    m_extraFormatOptions[key] = value;
+}
+
 bool MediaMuxer::initialize(const MediaEncoder::VideoConfig &videoConfig,
                             const MediaEncoder::AudioConfig &audioConfig,
                             void *videoCodecContext,
@@ -98,6 +109,16 @@ bool MediaMuxer::initialize(const MediaEncoder::VideoConfig &videoConfig,
     // Armazenar codec contexts para conversão de PTS/DTS
     m_videoCodecContext = videoCodecContext;
     m_audioCodecContext = audioCodecContext;
+    // Snapshot the codec time bases: a muxer fed from a shared encoder
+    // (EncodedPacketBus) may outlive the encoder that owns these contexts.
+    {
+        const AVCodecContext *videoCtx = static_cast<const AVCodecContext *>(videoCodecContext);
+        const AVCodecContext *audioCtx = static_cast<const AVCodecContext *>(audioCodecContext);
+        m_videoTimeBaseNum = videoCtx->time_base.num;
+        m_videoTimeBaseDen = videoCtx->time_base.den;
+        m_audioTimeBaseNum = audioCtx->time_base.num;
+        m_audioTimeBaseDen = audioCtx->time_base.den;
+    }
     
     // Reset PTS tracking
     m_lastVideoPTS = -1;
@@ -252,8 +273,8 @@ bool MediaMuxer::initializeStreams(void *videoCodecContext, void *audioCodecCont
     }
     }
 
-    // Não usar movflags especiais - deixar FFmpeg usar padrão
-    // O FFmpeg escreve o moov atom corretamente no final com av_write_trailer()
+    // Sem fragmentação: nenhum movflags especial, o FFmpeg escreve o moov
+    // atom no final com av_write_trailer(). Ver setFragmented().
     m_formatOptions = nullptr;
 
     // Criar stream de vídeo
@@ -459,8 +480,35 @@ bool MediaMuxer::initializeStreams(void *videoCodecContext, void *audioCodecCont
         }
     }
 
+    // Fragmented MP4/MOV: a moof+mdat pair per keyframe, so a file cut
+    // short by a crash or power loss stays playable up to its last
+    // fragment. empty_moov puts a sample-less init segment up front (what
+    // CMAF / LL-HLS requires). It needs the codec extradata (SPS/PPS):
+    // encoders opened for streaming emit headers in-band only, so then
+    // delay_moov holds the moov back until movenc has pulled them from the
+    // first packet — it is still written empty.
+    if (m_fragmented && (m_containerFormat == "mp4" || m_containerFormat == "mov"))
+    {
+        const bool haveExtradata = videoStream->codecpar->extradata_size > 0;
+        AVDictionary *fragOpts = nullptr;
+        av_dict_set(&fragOpts, "movflags",
+                    haveExtradata ? "frag_keyframe+empty_moov+default_base_moof"
+                                  : "frag_keyframe+empty_moov+delay_moov+default_base_moof",
+                    0);
+        m_formatOptions = fragOpts;
+        LOG_INFO(std::string("MediaMuxer: Fragmented output enabled") +
+                 (haveExtradata ? "" : " (no extradata, moov delayed to the first packet)"));
+    }
+
     AVDictionary *optsPtr = static_cast<AVDictionary *>(m_formatOptions);
+    for (const auto &kv : m_extraFormatOptions)
+    {
+        av_dict_set(&optsPtr, kv.first.c_str(), kv.second.c_str(), 0);
+    }
     int headerRet = avformat_write_header(formatCtx, &optsPtr);
+    // Opções não consumidas pelo muxer ficam no dicionário; liberar sempre.
+    av_dict_free(&optsPtr);
+    m_formatOptions = nullptr;
     if (headerRet < 0)
     {
         char errbuf[256];
@@ -744,13 +792,12 @@ void MediaMuxer::convertPTS(const MediaEncoder::EncodedPacket &packet, int64_t &
         return;
     }
 
-    AVCodecContext *codecCtx = packet.isVideo ? static_cast<AVCodecContext *>(m_videoCodecContext) : static_cast<AVCodecContext *>(m_audioCodecContext);
-    if (!codecCtx)
+    AVRational codecTimeBase = packet.isVideo ? AVRational{m_videoTimeBaseNum, m_videoTimeBaseDen}
+                                              : AVRational{m_audioTimeBaseNum, m_audioTimeBaseDen};
+    if (codecTimeBase.num <= 0 || codecTimeBase.den <= 0)
     {
         return;
     }
-
-    AVRational codecTimeBase = codecCtx->time_base;
     AVRational streamTimeBase = stream->time_base;
 
     // Log time_base mismatch occasionally for debugging
@@ -934,6 +981,41 @@ void MediaMuxer::finalize()
     }
 }
 
+void MediaMuxer::release()
+{
+    // Depois de finalize() o arquivo já está fechado; aqui só resta o
+    // AVFormatContext. Ao contrário de cleanup(), liberamos de verdade —
+    // o chamador garante que nenhuma outra thread está em muxPacket().
+    std::lock_guard<std::mutex> lock(m_muxMutex);
+    AVFormatContext *formatCtx = static_cast<AVFormatContext *>(m_muxerContext);
+    if (formatCtx)
+    {
+        bool isFile = (formatCtx->url && strcmp(formatCtx->url, "pipe:") != 0);
+        if (formatCtx->pb)
+        {
+            if (isFile)
+            {
+                avio_closep(&formatCtx->pb);
+            }
+            else
+            {
+                av_freep(&formatCtx->pb->buffer);
+                avio_context_free(&formatCtx->pb);
+            }
+        }
+        avformat_free_context(formatCtx);
+    }
+    m_muxerContext = nullptr;
+    m_videoStream = nullptr;
+    m_audioStream = nullptr;
+    m_initialized = false;
+    {
+        std::lock_guard<std::mutex> headerLock(m_headerMutex);
+        m_formatHeader.clear();
+        m_headerWritten = false;
+    }
+}
+
 void MediaMuxer::cleanup()
 {
     // SIMPLIFICADO: Apenas marcar como não inicializado
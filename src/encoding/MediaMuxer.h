@@ -35,6 +35,16 @@ public:
      // `ffprobe -show_format <file>` without parsing the filename.
     void setMetadata(const std::map<std::string, std::string> &metadata);
 
+    // Fragmented MP4/MOV output (frag_keyframe): every keyframe closes a
+    // moof fragment, so the file is playable even if av_write_trailer()
+    // never runs. Call BEFORE initialize(); ignored for other containers.
+    void setFragmented(bool fragmented);
+
+    // Extra muxer / AVFormatContext options for avformat_write_header
+    // (e.g. "frag_duration", "flush_packets"). Staged like setMetadata();
+    // call BEFORE initialize(). Unknown keys are ignored by FFmpeg.
+    void setFormatOption(const std::string &key, const std::string &value);
+
     // Inicializar muxer com configurações, codec contexts e callback OU arquivo
     // Os codec contexts são necessários para configurar os streams corretamente
     // Para arquivos: usar filePath (FFmpeg abre o arquivo diretamente com avio_open, suporta seek)
@@ -62,6 +72,12 @@ public:
     // Limpar recursos
     void cleanup();
 
+    // Liberar o AVFormatContext após finalize(), deixando o muxer pronto
+    // para um novo initialize() (rotação de segmentos). Diferente de
+    // cleanup(), que mantém o contexto vivo: só chamar quando nenhuma
+    // outra thread pode estar dentro de muxPacket().
+    void release();
+
     // Verificar se está inicializado
     bool isInitialized() const { return m_initialized; }
 
@@ -104,6 +120,12 @@ private:
     // Codec contexts (necessários para conversão de PTS/DTS)
     void *m_videoCodecContext = nullptr; // AVCodecContext*
     void *m_audioCodecContext = nullptr; // AVCodecContext*
+    // Codec time bases captured at initialize(); convertPTS uses these so
+    // it never dereferences a codec context after its encoder is gone.
+    int m_videoTimeBaseNum = 0;
+    int m_videoTimeBaseDen = 0;
+    int m_audioTimeBaseNum = 0;
+    int m_audioTimeBaseDen = 0;
 
     // Header do formato (capturado após primeira escrita)
     mutable std::mutex m_headerMutex;
@@ -124,4 +146,10 @@ private:
     // Container-level metadata staged via setMetadata() and applied
     // to formatCtx->metadata just before avformat_write_header.
     std::map<std::string, std::string> m_userMetadata;
+
+    // movflags de fragmentação no próximo initialize() (setFragmented).
+    bool m_fragmented = false;
+
+    // Opções extras do header (setFormatOption).
+    std::map<std::string, std::string> m_extraFormatOptions;
 };
@@ -1,6 +1,7 @@
 #include "MediaSynchronizer.h"
 #include "../utils/Logger.h"
 #include <algorithm>
+#include <chrono>
 #include <ctime>
 
 MediaSynchronizer::MediaSynchronizer()
@@ -19,14 +20,15 @@ int64_t MediaSynchronizer::getTimestampUs() const
     return static_cast<int64_t>(ts.tv_sec) * 1000000LL + static_cast<int64_t>(ts.tv_nsec) / 1000LL;
 }
 
-bool MediaSynchronizer::addVideoFrame(const uint8_t *data, uint32_t width, uint32_t height, int64_t captureTimestampUs)
+bool MediaSynchronizer::addVideoFrame(const uint8_t *data, uint32_t width, uint32_t height, int64_t captureTimestampUs,
+                                      VideoFrameFormat format)
 {
     if (!data || width == 0 || height == 0)
     {
         return false;
     }
 
-    size_t expectedSize = static_cast<size_t>(width) * static_cast<size_t>(height) * 3;
+    size_t expectedSize = videoFrameBytes(format, width, height);
     if (expectedSize == 0 || expectedSize > 100 * 1024 * 1024)
     {
         LOG_ERROR("MediaSynchronizer: Invalid frame size");
@@ -34,11 +36,15 @@ bool MediaSynchronizer::addVideoFrame(const uint8_t *data, uint32_t width, uint3
     }
 
     TimestampedFrame frame;
-    frame.data = std::make_shared<std::vector<uint8_t>>(data, data + expectedSize);
+    // Pooled copy: at 1080p RGB this is ~6 MB per frame, and a fresh
+    // allocation every frame meant an mmap/munmap + page faults each time.
+    frame.data = m_videoPool.acquireCopy(data, expectedSize);
     frame.width = width;
     frame.height = height;
     frame.captureTimestampUs = captureTimestampUs;
     frame.processed = false;
+    frame.enqueuedUs = getTimestampUs();
+    frame.format = format;
 
     if (frame.data->size() != expectedSize)
     {
@@ -69,6 +75,7 @@ bool MediaSynchronizer::addVideoFrame(const uint8_t *data, uint32_t width, uint3
         m_videoBuffer.push_back(std::move(frame));
         m_latestVideoTimestampUs = std::max(m_latestVideoTimestampUs, captureTimestampUs);
     }
+    notifyConsumers();
 
     // Não chamar cleanupOldData() aqui - deixar para o encodingThread fazer ocasionalmente
     // Isso evita remover dados muito agressivamente antes de serem processados
@@ -92,7 +99,7 @@ bool MediaSynchronizer::addAudioChunk(const int16_t *samples, size_t sampleCount
     int64_t durationUs = (sampleCount * 1000000LL) / (sampleRate * channels);
 
     TimestampedAudio audio;
-    audio.samples = std::make_shared<std::vector<int16_t>>(samples, samples + sampleCount);
+    audio.samples = m_audioPool.acquireCopy(samples, sampleCount);
     audio.sampleCount = sampleCount;
     audio.captureTimestampUs = captureTimestampUs;
     audio.durationUs = durationUs;
@@ -118,9 +125,10 @@ bool MediaSynchronizer::addAudioChunk(const int16_t *samples, size_t sampleCount
             }
         }
 
-        m_audioBuffer.push_back(audio);
+        m_audioBuffer.push_back(std::move(audio));
         m_latestAudioTimestampUs = std::max(m_latestAudioTimestampUs, captureTimestampUs);
     }
+    notifyConsumers();
 
     // Não chamar cleanupOldData() aqui - deixar para o encodingThread fazer ocasionalmente
     // Isso evita remover dados muito agressivamente antes de serem processados
@@ -319,8 +327,13 @@ void MediaSynchronizer::markVideoProcessed(size_t startIdx, size_t endIdx)
     std::lock_guard<std::mutex> lock(m_videoBufferMutex);
     if (endIdx > startIdx && endIdx <= m_videoBuffer.size())
     {
+        const int64_t nowUs = getTimestampUs();
         for (size_t i = startIdx; i < endIdx; i++)
         {
+            if (!m_videoBuffer[i].processed)
+            {
+                recordVideoLatency(m_videoBuffer[i], nowUs);
+            }
             m_videoBuffer[i].processed = true;
         }
     }
@@ -365,6 +378,7 @@ void MediaSynchronizer::markVideoFrameProcessedByTimestamp(int64_t timestampUs)
         if (frame.captureTimestampUs == timestampUs && !frame.processed)
         {
             frame.processed = true;
+            recordVideoLatency(frame, getTimestampUs());
             break; // Only mark first match (should be unique)
         }
     }
@@ -464,6 +478,12 @@ void MediaSynchronizer::clear()
 
     m_videoDropCount.store(0, std::memory_order_relaxed);
     m_audioDropCount.store(0, std::memory_order_relaxed);
+    fetchVideoQueueLatency();
+
+    // Give idle slabs back to the allocator between sessions; frames
+    // still held by an encoder thread are unaffected.
+    m_videoPool.trim();
+    m_audioPool.trim();
 }
 
 size_t MediaSynchronizer::getVideoBufferSize() const
@@ -477,3 +497,51 @@ size_t MediaSynchronizer::getAudioBufferSize() const
     std::lock_guard<std::mutex> lock(m_audioBufferMutex);
     return m_audioBuffer.size();
 }
+
+void MediaSynchronizer::notifyConsumers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_signalMutex);
+        ++m_dataSequence;
+    }
+    m_dataCv.notify_all();
+}
+
+void MediaSynchronizer::wakeConsumers()
+{
+    notifyConsumers();
+}
+
+uint64_t MediaSynchronizer::getDataSequence() const
+{
+    std::lock_guard<std::mutex> lock(m_signalMutex);
+    return m_dataSequence;
+}
+
+bool MediaSynchronizer::waitForData(uint64_t seenSequence, int64_t timeoutUs)
+{
+    std::unique_lock<std::mutex> lock(m_signalMutex);
+    return m_dataCv.wait_for(lock, std::chrono::microseconds(timeoutUs),
+                             [&]
+                             { return m_dataSequence != seenSequence; });
+}
+
+void MediaSynchronizer::recordVideoLatency(const TimestampedFrame &frame, int64_t nowUs)
+{
+    if (frame.enqueuedUs <= 0 || nowUs < frame.enqueuedUs)
+    {
+        return;
+    }
+    const uint64_t latencyUs = static_cast<uint64_t>(nowUs - frame.enqueuedUs);
+    m_videoLatency.frames++;
+    m_videoLatency.totalUs += latencyUs;
+    m_videoLatency.maxUs = std::max(m_videoLatency.maxUs, latencyUs);
+}
+
+MediaSynchronizer::QueueLatency MediaSynchronizer::fetchVideoQueueLatency()
+{
+    std::lock_guard<std::mutex> lock(m_videoBufferMutex);
+    QueueLatency latency = m_videoLatency;
+    m_videoLatency = QueueLatency();
+    return latency;
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "FramePool.h"
+#include "VideoFrameFormat.h"
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <vector>
 #include <deque>
@@ -25,6 +28,8 @@ public:
         uint32_t height;
         int64_t captureTimestampUs; // Timestamp absoluto de captura
         bool processed = false;     // Flag para marcar se já foi processado
+        int64_t enqueuedUs = 0;     // Quando entrou no buffer (estatística de latência)
+        VideoFrameFormat format = VideoFrameFormat::RGB24;
     };
 
     // Chunk de áudio com timestamp
@@ -78,7 +83,8 @@ public:
     void setMaxAudioBufferSize(size_t size) { m_maxAudioBufferSize = size; }
 
     // Adicionar frame de vídeo
-    bool addVideoFrame(const uint8_t *data, uint32_t width, uint32_t height, int64_t captureTimestampUs);
+    bool addVideoFrame(const uint8_t *data, uint32_t width, uint32_t height, int64_t captureTimestampUs,
+                       VideoFrameFormat format = VideoFrameFormat::RGB24);
 
     // Adicionar chunk de áudio
     bool addAudioChunk(const int16_t *samples, size_t sampleCount, int64_t captureTimestampUs, uint32_t sampleRate, uint32_t channels);
@@ -122,6 +128,22 @@ public:
     // Limpar todos os buffers
     void clear();
 
+    // Consumer wake-up. Encoder threads used to sleep-poll (100 µs .. 10 ms)
+    // and re-read the buffer sizes every time; now they block here until a
+    // producer adds something. Read getDataSequence() BEFORE draining, then
+    // wait on it: anything added in between makes the wait return at once,
+    // so no wake-up is lost. Returns false on timeout.
+    uint64_t getDataSequence() const;
+    bool waitForData(uint64_t seenSequence, int64_t timeoutUs);
+    // Wake every waiter without new data (stop/shutdown paths).
+    void wakeConsumers();
+
+    // Queue latency of video frames: from addVideoFrame() until the
+    // consumer marks them processed (i.e. wait + encode + mux). Fetch
+    // resets the accumulators, same as MediaEncoder::fetchVideoStageTimings.
+    struct QueueLatency { uint64_t frames = 0, totalUs = 0, maxUs = 0; };
+    QueueLatency fetchVideoQueueLatency();
+
     // Obter estatísticas
     size_t getVideoBufferSize() const;
     size_t getAudioBufferSize() const;
@@ -133,10 +155,19 @@ public:
     uint64_t getVideoDropCount() const { return m_videoDropCount.load(); }
     uint64_t getAudioDropCount() const { return m_audioDropCount.load(); }
 
+    // Buffer pool counters — allocations should stay flat once capture
+    // reaches steady state; only reuses keep growing.
+    uint64_t getVideoPoolAllocations() const { return m_videoPool.getAllocatedCount(); }
+    uint64_t getAudioPoolAllocations() const { return m_audioPool.getAllocatedCount(); }
+
 private:
     // Obter timestamp atual em microssegundos
     int64_t getTimestampUs() const;
 
+    void notifyConsumers();
+    // Chamado com m_videoBufferMutex travado.
+    void recordVideoLatency(const TimestampedFrame &frame, int64_t nowUs);
+
     // Parâmetros de sincronização
     int64_t m_syncToleranceUs = 200 * 1000LL;   // 200ms de tolerância (aumentado para melhor sincronização)
     int64_t m_maxBufferTimeUs = 5 * 1000000LL;  // 5 segundos máximo (reduzido para evitar atraso)
@@ -161,11 +192,24 @@ private:
     int64_t m_latestAudioTimestampUs = 0;
     int64_t m_firstAudioTimestampUs = 0;
 
+    // Accumulated while holding m_videoBufferMutex.
+    QueueLatency m_videoLatency;
+
+    // Wake-up for the consumer thread: bumped on every add.
+    mutable std::mutex m_signalMutex;
+    std::condition_variable m_dataCv;
+    uint64_t m_dataSequence = 0;
+
     // Contadores de overflow. Atomic porque addVideoFrame/addAudioChunk são
     // chamados de threads distintas dos getters.
     std::atomic<uint64_t> m_videoDropCount{0};
     std::atomic<uint64_t> m_audioDropCount{0};
 
+    // Recycled storage for frame/chunk copies. Slabs still referenced
+    // by an encoder thread stay valid even if the pool goes away first.
+    FramePool<uint8_t> m_videoPool;
+    FramePool<int16_t> m_audioPool;
+
     // Rótulo da instância para logs (#123). Vazio por padrão.
     std::string m_name;
 };
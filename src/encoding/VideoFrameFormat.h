@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Pixel layout of a captured video frame on its way from the render loop
+ * to MediaEncoder (pushFrame -> MediaSynchronizer -> encodeVideo).
+ *
+ * RGB24: tightly packed, width * height * 3 bytes — glReadPixels output,
+ * converted to YUV by swscale inside the encoder.
+ *
+ * YUV420SideBySide: what RGBToYUVPass renders and reads back in one go,
+ * a single 8-bit image of width x (height * 3 / 2):
+ *   rows [0, h)        : Y, width bytes per row
+ *   rows [h, h + h/2)  : U in bytes [0, w/2), V in bytes [w/2, w)
+ * i.e. YUV420P where U and V share rows. Each plane is addressable with
+ * a plain pointer + linesize (U/V linesize = width), so the encoder
+ * copies it into the AVFrame without swscale. Width and height are even.
+ */
+enum class VideoFrameFormat : uint8_t
+{
+    RGB24,
+    YUV420SideBySide,
+};
+
+inline size_t videoFrameBytes(VideoFrameFormat format, uint32_t width, uint32_t height)
+{
+    const size_t pixels = static_cast<size_t>(width) * static_cast<size_t>(height);
+    return format == VideoFrameFormat::YUV420SideBySide ? pixels * 3 / 2 : pixels * 3;
+}
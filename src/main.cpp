@@ -1,4 +1,5 @@
 #include "core/Application.h"
+#include "capture/FormatNegotiator.h"
 #include "streaming/CloudflaredDownloader.h"
 #include "ui/UIManager.h"
 #include "utils/HttpClient.h"
@@ -59,6 +60,8 @@ void printUsage(const char *programName)
 #ifdef __linux__
     std::cout << "\nV4L2 Hardware Controls (only when --source v4l2):\n";
     std::cout << "  --v4l2-device <path>        V4L2 capture device (default: /dev/video0)\n";
+    std::cout << "  --v4l2-format <fmt>         Capture pixel format: auto, yuyv, mjpeg (default: auto = YUYV if available)\n";
+    std::cout << "                              mjpeg unlocks 1080p60+ on USB 2.0 dongles (decoded on the GPU)\n";
     std::cout << "  --v4l2-brightness <value>   V4L2 brightness (-100 to 100, default: don't set)\n";
     std::cout << "  --v4l2-contrast <value>     V4L2 contrast (-100 to 100, default: don't set)\n";
     std::cout << "  --v4l2-saturation <value>   V4L2 saturation (-100 to 100, default: don't set)\n";
@@ -176,6 +179,7 @@ int main(int argc, char *argv[])
     int v4l2Sharpness = -1;
     int v4l2Gamma = -1;
     int v4l2WhiteBalance = -1;
+    uint32_t v4l2PixelFormat = 0; // 0 = auto (FormatNegotiator picks)
 #endif
 
 #ifdef _WIN32
@@ -485,6 +489,27 @@ int main(int argc, char *argv[])
 #else
             LOG_WARN("--v4l2-sharpness is only available on Linux");
             ++i; // Skip argument
+#endif
+        }
+        else if (arg == "--v4l2-format" && i + 1 < argc)
+        {
+#ifdef __linux__
+            std::string fmt = argv[++i];
+            std::transform(fmt.begin(), fmt.end(), fmt.begin(), ::tolower);
+            if (fmt == "auto")
+                v4l2PixelFormat = 0;
+            else if (fmt == "yuyv")
+                v4l2PixelFormat = rc::capture::FormatNegotiator::FOURCC_YUYV;
+            else if (fmt == "mjpeg" || fmt == "mjpg")
+                v4l2PixelFormat = rc::capture::FormatNegotiator::FOURCC_MJPG;
+            else
+            {
+                LOG_ERROR("V4L2 format invalid. Use auto, yuyv or mjpeg");
+                return 1;
+            }
+#else
+            LOG_WARN("--v4l2-format is only available on Linux");
+            ++i; // Skip argument
 #endif
         }
         else if (arg == "--v4l2-gamma" && i + 1 < argc)
@@ -870,6 +895,7 @@ int main(int argc, char *argv[])
     {
         // Configurar dispositivo V4L2
         app.setDevicePath(devicePath);
+        app.setV4L2PixelFormat(v4l2PixelFormat);
 
         // Configurar controles V4L2 se especificados
         if (v4l2Brightness >= 0)
@@ -896,7 +922,7 @@ int main(int argc, char *argv[])
         // Se não for V4L2, avisar sobre parâmetros V4L2 ignorados
         bool hasV4L2Params = (v4l2Brightness >= 0 || v4l2Contrast >= 0 || v4l2Saturation >= 0 ||
                               v4l2Hue >= 0 || v4l2Gain >= 0 || v4l2Exposure >= 0 ||
-                              v4l2Sharpness >= 0 || v4l2Gamma >= 0 || v4l2WhiteBalance >= 0);
+                              v4l2Sharpness >= 0 || v4l2Gamma >= 0 || v4l2WhiteBalance >= 0 || v4l2PixelFormat != 0);
         if (hasV4L2Params || devicePath != "/dev/video0")
         {
             LOG_WARN("V4L2 parameters or --v4l2-device specified but source is not V4L2. Parameters will be ignored.");
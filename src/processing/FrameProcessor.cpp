@@ -1,6 +1,7 @@
 #include "FrameProcessor.h"
 #include "../capture/IVideoCapture.h"
 #include "../renderer/OpenGLRenderer.h"
+#include "../renderer/YUVRenderPass.h"
 #include "../utils/Logger.h"
 #include <iostream>
 
@@ -101,6 +102,7 @@ bool FrameProcessor::processFrame(IVideoCapture *capture)
 
         m_textureWidth = frame.width;
         m_textureHeight = frame.height;
+        m_textureIsRenderTarget = false;
 
         // Criar textura vazia primeiro
         glGenTextures(1, &m_texture);
@@ -123,17 +125,23 @@ bool FrameProcessor::processFrame(IVideoCapture *capture)
     // YUYV: 2 bytes por pixel (formato comum V4L2)
     // RGB24: 3 bytes por pixel (formato comum DirectShow)
     bool isYUYV = false;
-#ifdef __linux__
-    // No Linux, verificar se é YUYV pelo formato ou tamanho
-    // V4L2_PIX_FMT_YUYV e V4L2_PIX_FMT_MJPEG já estão definidos em <linux/videodev2.h>
 
-    // Verificar se é MJPG (não suportado ainda)
-    if (frame.format == V4L2_PIX_FMT_MJPEG)
+    // MJPG capture arrives already decoded (MJPEGDecodePool) as planar YUV;
+    // convert on the GPU (no CPU RGB pass). Checked first: 4:2:2 planes
+    // have the same byte count as YUYV.
+    if (isPlanarYuvPixelFormat(frame.format))
     {
-        LOG_ERROR("MJPG format detected but not supported. The device must be configured for YUYV.");
-        return false;
+        if (!processPlanarYUVFrame(frame, textureCreated))
+        {
+            return false;
+        }
+        m_hasValidFrame = true;
+        return true;
     }
 
+#ifdef __linux__
+    // No Linux, verificar se é YUYV pelo formato ou tamanho
+    // V4L2_PIX_FMT_YUYV já está definido em <linux/videodev2.h>
     if (frame.format == V4L2_PIX_FMT_YUYV || frame.size == frame.width * frame.height * 2)
     {
         isYUYV = true;
@@ -146,6 +154,14 @@ bool FrameProcessor::processFrame(IVideoCapture *capture)
     }
 #endif
 
+    // The previous source was MJPEG at the same size: its RGBA render-target
+    // storage doesn't match the RGB uploads below, so reallocate.
+    if (m_textureIsRenderTarget)
+    {
+        textureCreated = true;
+        m_textureIsRenderTarget = false;
+    }
+
     if (isYUYV)
     {
         // Validar tamanho do buffer YUYV
@@ -230,6 +246,7 @@ void FrameProcessor::deleteTexture()
         m_textureWidth = 0;
         m_textureHeight = 0;
         m_hasValidFrame = false;
+        m_textureIsRenderTarget = false;
     }
 }
 
@@ -283,3 +300,54 @@ void FrameProcessor::convertYUYVtoRGB(const uint8_t *yuyv, uint8_t *rgb, uint32_
     sws_scale(m_swsContext, srcSlice, srcStride, 0, static_cast<int>(height), dstSlice, dstStride);
 }
 
+
+bool FrameProcessor::processPlanarYUVFrame(const Frame &frame, bool textureCreated)
+{
+    const uint32_t chromaW = (frame.format & RC_PIXFMT_YUV_CHROMA_W_SHIFT) ? (frame.width + 1) / 2 : frame.width;
+    const uint32_t chromaH = (frame.format & RC_PIXFMT_YUV_CHROMA_H_SHIFT) ? (frame.height + 1) / 2 : frame.height;
+    const size_t lumaSize = static_cast<size_t>(frame.width) * frame.height;
+    const size_t chromaSize = static_cast<size_t>(chromaW) * chromaH;
+    if (frame.size < lumaSize + 2 * chromaSize)
+    {
+        LOG_ERROR("Tamanho do frame YUV planar incorreto: esperado " + std::to_string(lumaSize + 2 * chromaSize) +
+                  ", recebido " + std::to_string(frame.size));
+        return false;
+    }
+
+    // The GPU pass renders into m_texture, so it needs colour-renderable
+    // RGBA storage (RGB8 isn't guaranteed renderable on GLES 2).
+    if (textureCreated || !m_textureIsRenderTarget)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, frame.width, frame.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        m_textureIsRenderTarget = true;
+    }
+
+    if (!m_yuvPass)
+    {
+        m_yuvPass = std::make_unique<YUVRenderPass>();
+    }
+    if (!m_yuvPass->isInitialized() && !m_yuvPass->init())
+    {
+        return false;
+    }
+
+    // Tightly packed: Y, then U, then V (see RC_PIXFMT_YUV_PLANAR).
+    YUVRenderPass::Planes planes;
+    planes.data[0] = frame.data;
+    planes.data[1] = frame.data + lumaSize;
+    planes.data[2] = frame.data + lumaSize + chromaSize;
+    planes.linesize[0] = static_cast<int>(frame.width);
+    planes.linesize[1] = static_cast<int>(chromaW);
+    planes.linesize[2] = static_cast<int>(chromaW);
+    planes.width = frame.width;
+    planes.height = frame.height;
+    planes.chromaWidth = chromaW;
+    planes.chromaHeight = chromaH;
+    planes.fullRange = !(frame.format & RC_PIXFMT_YUV_LIMITED_RANGE);
+    planes.matrix = (frame.format & RC_PIXFMT_YUV_BT709) ? YUVRenderPass::ColorMatrix::BT709
+                                                         : YUVRenderPass::ColorMatrix::BT601;
+
+    const bool ok = m_yuvPass->render(planes, m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    return ok;
+}
@@ -2,12 +2,14 @@
 
 #include "../renderer/glad_loader.h"
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 // Forward declarations
 struct Frame;
 class IVideoCapture;
 class OpenGLRenderer;
+class YUVRenderPass;
 struct SwsContext;
 
 /**
@@ -105,10 +107,24 @@ private:
     // Texture filtering configurável
     bool m_textureFilterLinear = false; // Padrão: GL_NEAREST (mais rápido)
 
+    // MJPEG capture arrives decoded to planar YUV (the capture side's
+    // MJPEGDecodePool) and is converted to RGB on the GPU (YUVRenderPass
+    // renders into m_texture). Created on the first such frame so
+    // YUYV-only setups never pay for it.
+    std::unique_ptr<YUVRenderPass> m_yuvPass;
+    // m_texture has RGBA storage (FBO render target) rather than RGB.
+    bool m_textureIsRenderTarget = false;
+
     /**
      * Convert YUYV (V4L2_PIX_FMT_YUYV) to RGB24 using libswscale.
      * libswscale dispatches to SIMD paths internally (SSE2/AVX/NEON).
      */
     void convertYUYVtoRGB(const uint8_t* yuyv, uint8_t* rgb, uint32_t width, uint32_t height);
+
+    /**
+     * Convert an RC_PIXFMT_YUV_PLANAR frame into m_texture on the GPU.
+     * Called with m_texture bound and sized to the frame.
+     */
+    bool processPlanarYUVFrame(const Frame& frame, bool textureCreated);
 };
 
@@ -0,0 +1,274 @@
+#include "MJPEGDecodePool.h"
+#include "MJPEGDecoder.h"
+#include "../capture/FrameMailbox.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+MJPEGDecodePool::MJPEGDecodePool(FrameMailbox &output)
+    : m_output(output)
+{
+}
+
+MJPEGDecodePool::~MJPEGDecodePool()
+{
+    stop();
+}
+
+bool MJPEGDecodePool::start(unsigned int workers)
+{
+    if (isRunning())
+    {
+        return true;
+    }
+
+    // A 1080p JPEG takes a few ms on one core, 4K several times that; two
+    // workers keep 4K60 fed, more than four only burns cores the encoder
+    // and the render thread want.
+    if (workers == 0)
+    {
+        workers = std::min(4u, std::max(2u, std::thread::hardware_concurrency() / 2));
+    }
+
+    m_decoders.clear();
+    for (unsigned int i = 0; i < workers; ++i)
+    {
+        auto decoder = std::make_unique<MJPEGDecoder>();
+        if (!decoder->init())
+        {
+            m_decoders.clear();
+            return false; // MJPEGDecoder already logged
+        }
+        m_decoders.push_back(std::move(decoder));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stopping = false;
+        m_nextSequence = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_publishMutex);
+        m_lastPublished = 0;
+    }
+    for (auto &decoder : m_decoders)
+    {
+        m_workers.emplace_back(&MJPEGDecodePool::workerLoop, this, std::ref(*decoder));
+    }
+
+    LOG_INFO("MJPEGDecodePool: " + std::to_string(workers) + " decode threads");
+    return true;
+}
+
+void MJPEGDecodePool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_stopping = true;
+    }
+    m_jobCv.notify_all();
+    for (auto &worker : m_workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+    m_decoders.clear();
+
+    std::lock_guard<std::mutex> lock(m_jobMutex);
+    while (!m_pending.empty())
+    {
+        m_freeJobs.push_back(std::move(m_pending.front()));
+        m_pending.pop_front();
+    }
+}
+
+void MJPEGDecodePool::submit(const uint8_t *data, size_t size, uint32_t width, uint32_t height)
+{
+    if (!data || size == 0)
+    {
+        return;
+    }
+
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (m_stopping || m_workers.empty())
+        {
+            return;
+        }
+        if (!m_freeJobs.empty())
+        {
+            job = std::move(m_freeJobs.back());
+            m_freeJobs.pop_back();
+        }
+    }
+
+    // Copy outside the lock so workers picking up jobs never wait on it.
+    if (job.data.size() < size)
+    {
+        job.data.resize(size);
+    }
+    std::memcpy(job.data.data(), data, size);
+    job.size = size;
+    job.width = width;
+    job.height = height;
+
+    {
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        if (m_stopping)
+        {
+            m_freeJobs.push_back(std::move(job));
+            return;
+        }
+        job.sequence = ++m_nextSequence;
+        while (m_pending.size() >= kMaxPending)
+        {
+            m_freeJobs.push_back(std::move(m_pending.front()));
+            m_pending.pop_front();
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_pending.push_back(std::move(job));
+    }
+    m_jobCv.notify_one();
+}
+
+void MJPEGDecodePool::workerLoop(MJPEGDecoder &decoder)
+{
+    SwsContext *sws = nullptr;
+    std::vector<uint8_t> rgba;
+    Job job;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_jobMutex);
+            m_jobCv.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+            if (m_stopping)
+            {
+                break;
+            }
+            job = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+
+        const AVFrame *decoded = decoder.decode(job.data.data(), job.size);
+        if (decoded)
+        {
+            publishDecoded(*decoded, job, sws, rgba);
+        }
+
+        std::lock_guard<std::mutex> lock(m_jobMutex);
+        m_freeJobs.push_back(std::move(job));
+    }
+
+    if (sws)
+    {
+        sws_freeContext(sws);
+    }
+}
+
+void MJPEGDecodePool::publishDecoded(const AVFrame &decoded, const Job &job, SwsContext *&sws,
+                                     std::vector<uint8_t> &rgba)
+{
+    const int w = decoded.width;
+    const int h = decoded.height;
+    if (w != static_cast<int>(job.width) || h != static_cast<int>(job.height))
+    {
+        LOG_WARN("MJPEG frame is " + std::to_string(w) + "x" + std::to_string(h) +
+                 " but the capture format is " + std::to_string(job.width) + "x" + std::to_string(job.height) +
+                 " — dropping frame");
+        return;
+    }
+
+    // Planar 8-bit YUV with 3 components and at most 2x subsampling is what
+    // UVC MJPEG produces in practice (4:2:2 mostly, some 4:2:0); it goes to
+    // the GPU as-is. Everything else (grayscale, 4:1:1, >8-bit) is
+    // converted to RGBA here, still off the render thread.
+    const AVPixelFormat fmt = static_cast<AVPixelFormat>(decoded.format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    const bool planarYuv = desc && desc->nb_components == 3 && (desc->flags & AV_PIX_FMT_FLAG_PLANAR) &&
+                           !(desc->flags & AV_PIX_FMT_FLAG_RGB) && desc->comp[0].depth == 8 &&
+                           desc->log2_chroma_w <= 1 && desc->log2_chroma_h <= 1;
+    if (!planarYuv)
+    {
+        sws = sws_getCachedContext(sws, w, h, fmt, w, h, AV_PIX_FMT_RGBA, SWS_POINT, nullptr, nullptr, nullptr);
+        if (!sws)
+        {
+            LOG_ERROR("sws_getCachedContext falhou para MJPEG (" +
+                      std::string(desc ? desc->name : "?") + ")→RGBA");
+            return;
+        }
+        rgba.resize(static_cast<size_t>(w) * h * 4);
+        uint8_t *dst[1] = {rgba.data()};
+        int dstStride[1] = {w * 4};
+        sws_scale(sws, decoded.data, decoded.linesize, 0, h, dst, dstStride);
+    }
+
+    std::lock_guard<std::mutex> lock(m_publishMutex);
+    if (job.sequence <= m_lastPublished)
+    {
+        // A newer frame finished first; publishing this one would step back.
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    FrameMailbox::Slot &slot = m_output.writeSlot();
+    if (planarYuv)
+    {
+        // AV_CEIL_RSHIFT negates its operand — must be signed.
+        const int cw = AV_CEIL_RSHIFT(w, desc->log2_chroma_w);
+        const int ch = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
+        const size_t lumaSize = static_cast<size_t>(w) * h;
+        const size_t chromaSize = static_cast<size_t>(cw) * ch;
+        slot.size = lumaSize + 2 * chromaSize;
+        if (slot.data.size() < slot.size)
+        {
+            slot.data.resize(slot.size);
+        }
+        uint8_t *dst = slot.data.data();
+        av_image_copy_plane(dst, w, decoded.data[0], decoded.linesize[0], w, h);
+        av_image_copy_plane(dst + lumaSize, cw, decoded.data[1], decoded.linesize[1], cw, ch);
+        av_image_copy_plane(dst + lumaSize + chromaSize, cw, decoded.data[2], decoded.linesize[2], cw, ch);
+
+        // JFIF is full-range BT.601; the YUVJ formats and color_range say
+        // so explicitly, a handful of devices tag limited range instead.
+        const bool fullRange = fmt == AV_PIX_FMT_YUVJ420P || fmt == AV_PIX_FMT_YUVJ422P ||
+                               fmt == AV_PIX_FMT_YUVJ444P || fmt == AV_PIX_FMT_YUVJ440P ||
+                               decoded.color_range == AVCOL_RANGE_JPEG;
+        uint32_t format = RC_PIXFMT_YUV_PLANAR;
+        if (desc->log2_chroma_w)
+            format |= RC_PIXFMT_YUV_CHROMA_W_SHIFT;
+        if (desc->log2_chroma_h)
+            format |= RC_PIXFMT_YUV_CHROMA_H_SHIFT;
+        if (!fullRange)
+            format |= RC_PIXFMT_YUV_LIMITED_RANGE;
+        if (decoded.colorspace == AVCOL_SPC_BT709)
+            format |= RC_PIXFMT_YUV_BT709;
+        slot.format = format;
+    }
+    else
+    {
+        slot.size = rgba.size();
+        if (slot.data.size() < slot.size)
+        {
+            slot.data.resize(slot.size);
+        }
+        std::memcpy(slot.data.data(), rgba.data(), slot.size);
+        slot.format = RC_PIXFMT_RGBA;
+    }
+    slot.width = job.width;
+    slot.height = job.height;
+    m_output.publish();
+    m_lastPublished = job.sequence;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class FrameMailbox;
+class MJPEGDecoder;
+struct AVFrame;
+struct SwsContext;
+
+/**
+ * MJPEGDecodePool - decodes V4L2 MJPEG capture off the render thread
+ *
+ * The capture thread submit()s each compressed frame as soon as it is
+ * dequeued. A few worker threads, each with its own single-threaded
+ * MJPEGDecoder, decode frames in parallel, so throughput scales with the
+ * worker count even though one JPEG can't be split across cores. Each
+ * decoded image is packed into the output FrameMailbox as
+ * RC_PIXFMT_YUV_PLANAR (or RC_PIXFMT_RGBA for layouts the GPU pass doesn't
+ * cover); the render thread only uploads.
+ *
+ * Latest frame wins: when every worker is busy the oldest queued JPEG is
+ * dropped, and a frame that finishes after a newer one was published is
+ * discarded instead of going backwards in time.
+ *
+ * The workers take turns as the mailbox's single producer under
+ * m_publishMutex. Nothing else may publish to it while the pool runs.
+ */
+class MJPEGDecodePool
+{
+public:
+    explicit MJPEGDecodePool(FrameMailbox &output);
+    ~MJPEGDecodePool();
+
+    MJPEGDecodePool(const MJPEGDecodePool &) = delete;
+    MJPEGDecodePool &operator=(const MJPEGDecodePool &) = delete;
+
+    // workers = 0 picks a count from the core count.
+    bool start(unsigned int workers = 0);
+    // Joins the workers and drops anything still queued.
+    void stop();
+    bool isRunning() const { return !m_workers.empty(); }
+
+    // Capture thread: copy one JPEG into the queue and return. width/height
+    // are the negotiated format; decoded images of another size are dropped.
+    void submit(const uint8_t *data, size_t size, uint32_t width, uint32_t height);
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Job
+    {
+        std::vector<uint8_t> data; // capacity reused between frames
+        size_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t sequence = 0;
+    };
+
+    // Only the newest waiting JPEG is kept: once every worker is busy, a
+    // deeper queue would just add latency.
+    static constexpr size_t kMaxPending = 1;
+
+    FrameMailbox &m_output;
+
+    std::vector<std::unique_ptr<MJPEGDecoder>> m_decoders; // one per worker
+    std::vector<std::thread> m_workers;
+    std::mutex m_jobMutex;
+    std::condition_variable m_jobCv;
+    std::deque<Job> m_pending;
+    std::vector<Job> m_freeJobs; // recycled buffers
+    uint64_t m_nextSequence = 0;
+    bool m_stopping = false;
+
+    std::mutex m_publishMutex;
+    uint64_t m_lastPublished = 0; // sequence; guarded by m_publishMutex
+
+    std::atomic<uint64_t> m_dropped{0};
+
+    void workerLoop(MJPEGDecoder &decoder);
+    // Worker: pack one decoded image into the mailbox unless a newer one
+    // was already published. sws/rgba are the worker's RGBA fallback state.
+    void publishDecoded(const AVFrame &decoded, const Job &job, SwsContext *&sws, std::vector<uint8_t> &rgba);
+};
@@ -0,0 +1,130 @@
+#include "MJPEGDecoder.h"
+#include "../utils/Logger.h"
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+MJPEGDecoder::~MJPEGDecoder()
+{
+    shutdown();
+}
+
+bool MJPEGDecoder::init()
+{
+    if (m_codecCtx)
+    {
+        return true;
+    }
+
+    const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+    if (!codec)
+    {
+        LOG_ERROR("MJPEGDecoder: libavcodec has no MJPEG decoder");
+        return false;
+    }
+
+    m_codecCtx = avcodec_alloc_context3(codec);
+    if (!m_codecCtx)
+    {
+        LOG_ERROR("MJPEGDecoder: avcodec_alloc_context3 failed");
+        return false;
+    }
+
+    // libavcodec's mjpeg decoder has no slice threading, and frame
+    // threading would queue frames inside the codec. Parallelism comes
+    // from MJPEGDecodePool running one single-threaded decoder per worker.
+    m_codecCtx->thread_count = 1;
+    m_codecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    m_codecCtx->flags2 |= AV_CODEC_FLAG2_FAST;
+
+    if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
+    {
+        LOG_ERROR("MJPEGDecoder: avcodec_open2 failed");
+        avcodec_free_context(&m_codecCtx);
+        return false;
+    }
+
+    m_frame = av_frame_alloc();
+    m_packet = av_packet_alloc();
+    if (!m_frame || !m_packet)
+    {
+        LOG_ERROR("MJPEGDecoder: failed to allocate frame/packet");
+        shutdown();
+        return false;
+    }
+
+    return true;
+}
+
+void MJPEGDecoder::shutdown()
+{
+    if (m_packet)
+    {
+        av_packet_free(&m_packet);
+    }
+    if (m_frame)
+    {
+        av_frame_free(&m_frame);
+    }
+    if (m_codecCtx)
+    {
+        avcodec_free_context(&m_codecCtx);
+    }
+    m_lastDecodeFailed = false;
+}
+
+const AVFrame *MJPEGDecoder::decode(const uint8_t *data, size_t size)
+{
+    if (!m_codecCtx && !init())
+    {
+        return nullptr;
+    }
+    if (!data || size == 0)
+    {
+        return nullptr;
+    }
+
+    // libavcodec's bitstream reader may over-read up to
+    // AV_INPUT_BUFFER_PADDING_SIZE bytes past the packet, and the V4L2
+    // mmap buffer gives no such guarantee past bytesused — copy into a
+    // reused, zero-padded buffer (a few hundred KB, noise next to decode).
+    const size_t padded = size + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (m_bitstream.size() < padded)
+    {
+        m_bitstream.resize(padded);
+    }
+    std::memcpy(m_bitstream.data(), data, size);
+    std::memset(m_bitstream.data() + size, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+
+    av_packet_unref(m_packet);
+    m_packet->data = m_bitstream.data();
+    m_packet->size = static_cast<int>(size);
+
+    int ret = avcodec_send_packet(m_codecCtx, m_packet);
+    if (ret >= 0)
+    {
+        av_frame_unref(m_frame);
+        ret = avcodec_receive_frame(m_codecCtx, m_frame);
+    }
+    m_packet->data = nullptr;
+    m_packet->size = 0;
+
+    if (ret < 0)
+    {
+        if (!m_lastDecodeFailed)
+        {
+            char errBuf[128] = {0};
+            av_strerror(ret, errBuf, sizeof(errBuf));
+            LOG_WARN("MJPEGDecoder: frame decode failed (" + std::string(errBuf) +
+                     ") — dropping corrupt/truncated frames until the stream recovers");
+        }
+        m_lastDecodeFailed = true;
+        return nullptr;
+    }
+    m_lastDecodeFailed = false;
+    return m_frame;
+}
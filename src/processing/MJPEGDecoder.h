@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct AVCodecContext;
+struct AVFrame;
+struct AVPacket;
+
+/**
+ * MJPEG frame decoder for V4L2 capture.
+ *
+ * Cheap USB capture dongles only reach 1080p60 (and above) in MJPEG. Each
+ * compressed frame is decoded here to planar YUV; FrameProcessor then
+ * converts it on the GPU with YUVRenderPass, so there is no CPU RGB pass.
+ *
+ * Uses libavcodec's MJPEG decoder (SIMD IDCT) on a single thread: that
+ * decoder has no slice threading, and frame threading would queue frames
+ * inside the codec. MJPEGDecodePool gets throughput by running one
+ * decoder per worker thread with several frames in flight.
+ *
+ * Not thread-safe: one instance per thread.
+ */
+class MJPEGDecoder
+{
+public:
+    MJPEGDecoder() = default;
+    ~MJPEGDecoder();
+
+    bool init();
+    void shutdown();
+    bool isInitialized() const { return m_codecCtx != nullptr; }
+
+    /**
+     * Decode one JPEG image. Returns the decoded frame (owned by the
+     * decoder, valid until the next decode() / shutdown()) or nullptr on
+     * error / truncated input.
+     */
+    const AVFrame *decode(const uint8_t *data, size_t size);
+
+private:
+    AVCodecContext *m_codecCtx = nullptr;
+    AVFrame *m_frame = nullptr;
+    AVPacket *m_packet = nullptr;
+    std::vector<uint8_t> m_bitstream; // padded copy of the JPEG payload
+    // Log the first failure of a burst, not one per frame at 60 fps.
+    bool m_lastDecodeFailed = false;
+};
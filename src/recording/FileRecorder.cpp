@@ -87,6 +87,11 @@ void FileRecorder::setMetadata(const std::map<std::string, std::string> &metadat
     m_muxer.setMetadata(metadata);
 }
 
+void FileRecorder::setFragmented(bool fragmented)
+{
+    m_muxer.setFragmented(fragmented);
+}
+
 bool FileRecorder::initialize(const MediaEncoder::VideoConfig& videoConfig,
                                const MediaEncoder::AudioConfig& audioConfig,
                                void* videoCodecContext,
@@ -107,6 +112,8 @@ bool FileRecorder::initialize(const MediaEncoder::VideoConfig& videoConfig,
     m_outputPath = outputPath;
     m_videoCodecContext = videoCodecContext;
     m_audioCodecContext = audioCodecContext;
+    m_videoConfig = videoConfig;
+    m_audioConfig = audioConfig;
 
     // Ensure output directory exists
     if (!ensureOutputDirectory(outputPath))
@@ -207,6 +214,38 @@ void FileRecorder::stopRecording()
              std::to_string(m_durationUs / 1000000) + " seconds");
 }
 
+bool FileRecorder::startNextSegment(const std::string& nextPath,
+                                    void* videoCodecContext,
+                                    void* audioCodecContext)
+{
+    if (!m_initialized)
+    {
+        LOG_ERROR("FileRecorder: Cannot rotate segment - not initialized");
+        return false;
+    }
+
+    const std::string previousPath = m_outputPath;
+    const MediaEncoder::VideoConfig videoConfig = m_videoConfig;
+    const MediaEncoder::AudioConfig audioConfig = m_audioConfig;
+
+    // Fechar o segmento atual por completo (trailer + arquivo) e liberar o
+    // contexto — cleanup() vaza o AVFormatContext de propósito, o que numa
+    // sessão de horas com dezenas de segmentos não dá.
+    m_muxer.flush();
+    m_muxer.finalize();
+    m_muxer.release();
+    m_recording = false;
+    m_initialized = false;
+
+    if (!initialize(videoConfig, audioConfig, videoCodecContext, audioCodecContext, nextPath))
+    {
+        LOG_ERROR("FileRecorder: Failed to open next segment: " + nextPath);
+        return false;
+    }
+    LOG_INFO("FileRecorder: Segment closed: " + previousPath);
+    return startRecording();
+}
+
 bool FileRecorder::muxPacket(const MediaEncoder::EncodedPacket& packet)
 {
     if (!m_recording || !m_initialized)
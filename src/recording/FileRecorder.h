@@ -25,6 +25,10 @@ public:
      // in the output file's metadata atoms. Call BEFORE initialize().
     void setMetadata(const std::map<std::string, std::string> &metadata);
 
+    // Fragmented MP4 output (see MediaMuxer::setFragmented). Sticky across
+    // segments; call BEFORE initialize().
+    void setFragmented(bool fragmented);
+
     // Initialize recorder with configurations and output path
     bool initialize(const MediaEncoder::VideoConfig& videoConfig,
                     const MediaEncoder::AudioConfig& audioConfig,
@@ -41,6 +45,15 @@ public:
     // Check if recording
     bool isRecording() const { return m_recording; }
 
+    // Segment rotation: finalize the current file (trailer + close), free
+    // its muxer context and reopen on nextPath with the same stream configs,
+    // already recording. Codec contexts are passed again because a shared
+    // encoder may have been replaced since initialize(). Must be called
+    // from the thread that calls muxPacket().
+    bool startNextSegment(const std::string& nextPath,
+                          void* videoCodecContext,
+                          void* audioCodecContext);
+
     // Mux a packet (called by RecordingManager)
     bool muxPacket(const MediaEncoder::EncodedPacket& packet);
 
@@ -77,4 +90,8 @@ private:
     // Codec contexts (stored for MediaMuxer)
     void* m_videoCodecContext = nullptr;
     void* m_audioCodecContext = nullptr;
+
+    // Stream configs from initialize(), reused by startNextSegment()
+    MediaEncoder::VideoConfig m_videoConfig;
+    MediaEncoder::AudioConfig m_audioConfig;
 };
@@ -0,0 +1,448 @@
+#include "RecordingCatalog.h"
+#include "../utils/Logger.h"
+#include "../utils/FilesystemCompat.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+std::string toLower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(),
+                   [](unsigned char c)
+                   { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+bool ensureParentDir(const std::string &path)
+{
+    try
+    {
+        fs::path dir = fs::path(path).parent_path();
+        if (!dir.empty() && !fs::exists(dir))
+        {
+            fs::create_directories(dir);
+        }
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("RecordingCatalog: Cannot create directory for " + path + ": " + e.what());
+        return false;
+    }
+}
+} // namespace
+
+RecordingCatalog::~RecordingCatalog()
+{
+    close();
+}
+
+bool RecordingCatalog::open(const std::string &snapshotPath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_byId.clear();
+    m_byDate.clear();
+    m_byShader.clear();
+    m_byPath.clear();
+    m_journalLines = 0;
+    m_nextSeq = 0;
+    m_snapshotUnreadable = false;
+
+    m_snapshotPath = snapshotPath;
+    fs::path journal(snapshotPath);
+    journal.replace_extension(".journal");
+    m_journalPath = journal.string();
+
+    bool ok = true;
+    try
+    {
+        if (fs::exists(m_snapshotPath))
+        {
+            std::ifstream file(m_snapshotPath);
+            nlohmann::json json;
+            file >> json;
+            if (json.contains("recordings") && json["recordings"].is_array())
+            {
+                for (const auto &item : json["recordings"])
+                {
+                    insertLocked(RecordingMetadata::fromJSON(item));
+                }
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("RecordingCatalog: Exception loading " + m_snapshotPath + ": " + std::string(e.what()));
+        LOG_WARN("RecordingCatalog: Not compacting until the snapshot is repaired; changes stay in " +
+                 m_journalPath);
+        ok = false;
+        m_snapshotUnreadable = true;
+    }
+
+    // Replay what happened after the last compaction.
+    size_t replayed = 0;
+    std::ifstream journalFile(m_journalPath);
+    std::string line;
+    while (journalFile.is_open() && std::getline(journalFile, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+        try
+        {
+            const nlohmann::json record = nlohmann::json::parse(line);
+            if (record.contains("put"))
+            {
+                insertLocked(RecordingMetadata::fromJSON(record["put"]));
+            }
+            else if (record.contains("del"))
+            {
+                eraseLocked(record["del"].get<std::string>());
+            }
+            replayed++;
+        }
+        catch (const std::exception &)
+        {
+            // Torn write from a crash — only ever the last line.
+            LOG_WARN("RecordingCatalog: Skipping unreadable journal line in " + m_journalPath);
+        }
+    }
+    journalFile.close();
+
+    if (replayed > 0)
+    {
+        m_journalLines = replayed;
+        compactLocked();
+    }
+    LOG_INFO("RecordingCatalog: " + std::to_string(m_byId.size()) + " recordings (" +
+             std::to_string(replayed) + " journal entries replayed)");
+    return ok;
+}
+
+void RecordingCatalog::close()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_snapshotPath.empty() && m_journalLines > 0)
+    {
+        compactLocked();
+    }
+}
+
+bool RecordingCatalog::put(const RecordingMetadata &metadata)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    insertLocked(metadata);
+    return appendJournalLocked(nlohmann::json{{"put", metadata.toJSON()}});
+}
+
+bool RecordingCatalog::remove(const std::string &id)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!eraseLocked(id))
+    {
+        return false;
+    }
+    return appendJournalLocked(nlohmann::json{{"del", id}});
+}
+
+bool RecordingCatalog::update(const std::string &id, const std::function<void(RecordingMetadata &)> &fn)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byId.find(id);
+    if (it == m_byId.end())
+    {
+        return false;
+    }
+    RecordingMetadata metadata = it->second.metadata;
+    fn(metadata);
+    metadata.id = id;
+    insertLocked(metadata);
+    return appendJournalLocked(nlohmann::json{{"put", metadata.toJSON()}});
+}
+
+bool RecordingCatalog::get(const std::string &id, RecordingMetadata &out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byId.find(id);
+    if (it == m_byId.end())
+    {
+        return false;
+    }
+    out = it->second.metadata;
+    return true;
+}
+
+std::vector<RecordingMetadata> RecordingCatalog::all() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<RecordingMetadata> result;
+    result.reserve(m_byDate.size());
+    for (const auto &entry : m_byDate)
+    {
+        result.push_back(m_byId.at(entry.second).metadata);
+    }
+    return result;
+}
+
+RecordingPage RecordingCatalog::query(const RecordingQuery &query) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    RecordingPage page;
+    if (!query.from.empty() && !query.to.empty() && !(query.from < query.to))
+    {
+        return page;
+    }
+    const std::string search = toLower(query.search);
+
+    auto visit = [&](const std::string &id)
+    {
+        const RecordingMetadata &metadata = m_byId.at(id).metadata;
+        if (!matchesLocked(metadata, query, search))
+        {
+            return;
+        }
+        if (page.total >= query.offset && (query.limit == 0 || page.items.size() < query.limit))
+        {
+            page.items.push_back(metadata);
+        }
+        page.total++;
+    };
+    // Walk [from, to) of an index ordered by DateKey in the requested
+    // direction; idOf maps the index's element to an id.
+    auto walk = [&](auto begin, auto end, auto idOf)
+    {
+        if (query.newestFirst)
+        {
+            for (auto it = end; it != begin;)
+            {
+                --it;
+                visit(idOf(*it));
+            }
+        }
+        else
+        {
+            for (auto it = begin; it != end; ++it)
+            {
+                visit(idOf(*it));
+            }
+        }
+    };
+    const DateKey fromKey(query.from, 0);
+    const DateKey toKey(query.to, 0);
+
+    if (!query.shader.empty())
+    {
+        auto bucket = m_byShader.find(query.shader);
+        if (bucket == m_byShader.end())
+        {
+            return page;
+        }
+        const std::set<DateKey> &keys = bucket->second;
+        auto begin = query.from.empty() ? keys.begin() : keys.lower_bound(fromKey);
+        auto end = query.to.empty() ? keys.end() : keys.lower_bound(toKey);
+        walk(begin, end, [this](const DateKey &key) -> const std::string &
+             { return m_byDate.at(key); });
+        return page;
+    }
+
+    auto begin = query.from.empty() ? m_byDate.begin() : m_byDate.lower_bound(fromKey);
+    auto end = query.to.empty() ? m_byDate.end() : m_byDate.lower_bound(toKey);
+    walk(begin, end, [](const std::pair<const DateKey, std::string> &entry) -> const std::string &
+         { return entry.second; });
+    return page;
+}
+
+size_t RecordingCatalog::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_byId.size();
+}
+
+std::vector<std::pair<std::string, std::string>> RecordingCatalog::paths() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::pair<std::string, std::string>> result;
+    result.reserve(m_byId.size());
+    for (const auto &entry : m_byId)
+    {
+        result.emplace_back(entry.first, entry.second.metadata.filepath);
+    }
+    return result;
+}
+
+bool RecordingCatalog::containsPath(const std::string &filepath) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_byPath.count(filepath) > 0;
+}
+
+void RecordingCatalog::insertLocked(const RecordingMetadata &metadata)
+{
+    // Replacing keeps the entry's place among same-second siblings.
+    uint64_t seq = m_nextSeq;
+    auto existing = m_byId.find(metadata.id);
+    if (existing != m_byId.end() && existing->second.dateKey.first == metadata.createdAt)
+    {
+        seq = existing->second.dateKey.second;
+    }
+    else
+    {
+        m_nextSeq++;
+    }
+    eraseLocked(metadata.id);
+
+    Slot slot;
+    slot.metadata = metadata;
+    slot.dateKey = DateKey(metadata.createdAt, seq);
+    m_byDate[slot.dateKey] = metadata.id;
+    if (!metadata.shaderName.empty())
+    {
+        m_byShader[metadata.shaderName].insert(slot.dateKey);
+    }
+    if (!metadata.filepath.empty())
+    {
+        m_byPath[metadata.filepath] = metadata.id;
+    }
+    m_byId[metadata.id] = std::move(slot);
+}
+
+bool RecordingCatalog::eraseLocked(const std::string &id)
+{
+    auto it = m_byId.find(id);
+    if (it == m_byId.end())
+    {
+        return false;
+    }
+    const Slot &slot = it->second;
+    m_byDate.erase(slot.dateKey);
+    auto bucket = m_byShader.find(slot.metadata.shaderName);
+    if (bucket != m_byShader.end())
+    {
+        bucket->second.erase(slot.dateKey);
+        if (bucket->second.empty())
+        {
+            m_byShader.erase(bucket);
+        }
+    }
+    auto byPath = m_byPath.find(slot.metadata.filepath);
+    if (byPath != m_byPath.end() && byPath->second == id)
+    {
+        m_byPath.erase(byPath);
+    }
+    m_byId.erase(it);
+    return true;
+}
+
+bool RecordingCatalog::appendJournalLocked(const nlohmann::json &record)
+{
+    if (m_snapshotPath.empty())
+    {
+        return false; // not opened
+    }
+    if (m_journalLines == 0 && !ensureParentDir(m_journalPath))
+    {
+        return false;
+    }
+    {
+        std::ofstream journal(m_journalPath, std::ios::app);
+        if (!journal.is_open())
+        {
+            LOG_ERROR("RecordingCatalog: Failed to open journal for writing: " + m_journalPath);
+            return false;
+        }
+        journal << record.dump() << '\n';
+        journal.flush();
+        if (!journal.good())
+        {
+            LOG_ERROR("RecordingCatalog: Failed to append to journal: " + m_journalPath);
+            return false;
+        }
+    }
+    if (++m_journalLines >= kCompactEvery)
+    {
+        compactLocked();
+    }
+    return true;
+}
+
+bool RecordingCatalog::compactLocked()
+{
+    // The in-memory catalog is only the journal: writing it out would
+    // replace the archive in the unreadable (but maybe fixable) snapshot.
+    if (m_snapshotUnreadable)
+    {
+        return false;
+    }
+    if (!ensureParentDir(m_snapshotPath))
+    {
+        return false;
+    }
+    try
+    {
+        nlohmann::json json;
+        json["recordings"] = nlohmann::json::array();
+        for (const auto &entry : m_byDate)
+        {
+            json["recordings"].push_back(m_byId.at(entry.second).metadata.toJSON());
+        }
+
+        const std::string tmp = m_snapshotPath + ".tmp";
+        {
+            std::ofstream file(tmp, std::ios::trunc);
+            if (!file.is_open())
+            {
+                LOG_ERROR("RecordingCatalog: Failed to open metadata file for writing: " + tmp);
+                return false;
+            }
+            file << json.dump(2);
+            if (!file.good())
+            {
+                LOG_ERROR("RecordingCatalog: Failed to write " + tmp);
+                return false;
+            }
+        }
+        if (std::rename(tmp.c_str(), m_snapshotPath.c_str()) != 0)
+        {
+            // Windows rename doesn't replace an existing file.
+            std::remove(m_snapshotPath.c_str());
+            if (std::rename(tmp.c_str(), m_snapshotPath.c_str()) != 0)
+            {
+                LOG_ERROR("RecordingCatalog: Failed to replace " + m_snapshotPath);
+                return false;
+            }
+        }
+
+        // Snapshot has everything: the journal starts over.
+        std::ofstream truncate(m_journalPath, std::ios::trunc);
+        m_journalLines = 0;
+        return true;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("RecordingCatalog: Exception saving metadata: " + std::string(e.what()));
+        return false;
+    }
+}
+
+bool RecordingCatalog::matchesLocked(const RecordingMetadata &metadata, const RecordingQuery &query,
+                                     const std::string &searchLower) const
+{
+    if (!query.sourceType.empty() && metadata.sourceType != query.sourceType)
+    {
+        return false;
+    }
+    if (!query.sessionId.empty() && metadata.sessionId != query.sessionId)
+    {
+        return false;
+    }
+    if (!searchLower.empty() && toLower(metadata.filename).find(searchLower) == std::string::npos)
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "RecordingMetadata.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Filter + page for RecordingCatalog::query() (GET /api/v1/recordings).
+// Empty strings don't filter.
+struct RecordingQuery
+{
+    size_t offset = 0;
+    size_t limit = 0;          // 0 = everything after offset
+    bool newestFirst = false;  // default keeps the old list order (oldest first)
+    std::string from;          // createdAt >= from (ISO 8601, prefix allowed: "2026-03")
+    std::string to;            // createdAt < to
+    std::string shader;        // exact shaderName
+    std::string sourceType;    // exact sourceType
+    std::string sessionId;     // parts of one segmented recording
+    std::string search;        // case-insensitive substring of filename
+};
+
+struct RecordingPage
+{
+    std::vector<RecordingMetadata> items;
+    size_t total = 0; // matches before offset/limit
+};
+
+/**
+ * RecordingCatalog - the recordings list, indexed and journaled
+ *
+ * Entries live in memory indexed by id, by creation date and by shader,
+ * so the API can page and filter without copying the whole list. On disk
+ * it is the same recordings.json snapshot as before plus an append-only
+ * journal next to it (recordings.journal, one JSON object per line:
+ * {"put": {...}} or {"del": "<id>"}). A change appends one line instead of
+ * rewriting the snapshot; the journal is folded back into the snapshot
+ * (write-temp-and-rename) on open, every kCompactEvery lines and on close,
+ * unless the snapshot failed to parse — then it is left untouched.
+ * A torn last line from a crash is skipped on replay.
+ *
+ * Thread-safe; every call takes the catalog mutex only for the in-memory
+ * work and the single journal append.
+ */
+class RecordingCatalog
+{
+public:
+    RecordingCatalog() = default;
+    ~RecordingCatalog();
+
+    RecordingCatalog(const RecordingCatalog &) = delete;
+    RecordingCatalog &operator=(const RecordingCatalog &) = delete;
+
+    // Loads snapshot + journal and compacts. A missing snapshot is an
+    // empty catalog, not an error.
+    bool open(const std::string &snapshotPath);
+    // Compacts if anything was journaled since the last compaction.
+    void close();
+
+    // Insert or replace by id.
+    bool put(const RecordingMetadata &metadata);
+    bool remove(const std::string &id);
+    // Edit in place; false if the id isn't there. fn must not change the id.
+    bool update(const std::string &id, const std::function<void(RecordingMetadata &)> &fn);
+
+    bool get(const std::string &id, RecordingMetadata &out) const;
+    // Whole list, oldest first (what listRecordings() always returned).
+    std::vector<RecordingMetadata> all() const;
+    RecordingPage query(const RecordingQuery &query) const;
+    size_t size() const;
+
+    // (id, filepath) of every entry — what the rescan needs, without
+    // copying full metadata.
+    std::vector<std::pair<std::string, std::string>> paths() const;
+    bool containsPath(const std::string &filepath) const;
+
+private:
+    static constexpr size_t kCompactEvery = 512;
+
+    // Creation order: createdAt, then insertion sequence for ties (the
+    // timestamp only has second resolution).
+    using DateKey = std::pair<std::string, uint64_t>;
+
+    struct Slot
+    {
+        RecordingMetadata metadata;
+        DateKey dateKey;
+    };
+
+    // m_mutex held.
+    void insertLocked(const RecordingMetadata &metadata);
+    bool eraseLocked(const std::string &id);
+    bool appendJournalLocked(const nlohmann::json &record);
+    bool compactLocked();
+    // Filters the index walk doesn't cover (source, session, search).
+    bool matchesLocked(const RecordingMetadata &metadata, const RecordingQuery &query,
+                       const std::string &searchLower) const;
+
+    mutable std::mutex m_mutex;
+    std::string m_snapshotPath;
+    std::string m_journalPath;
+    size_t m_journalLines = 0;
+    uint64_t m_nextSeq = 0;
+    // Snapshot exists but failed to parse: never compact over it (the
+    // journal keeps growing instead, nothing is lost).
+    bool m_snapshotUnreadable = false;
+
+    std::unordered_map<std::string, Slot> m_byId;
+    std::map<DateKey, std::string> m_byDate; // -> id
+    std::map<std::string, std::set<DateKey>> m_byShader;
+    std::unordered_map<std::string, std::string> m_byPath; // filepath -> id
+};
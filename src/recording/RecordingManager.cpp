@@ -9,16 +9,89 @@
 #include <sstream>
 #include <algorithm>
 #include <cstdint>
+#include <cstdio>
 #include <limits>
+#include <set>
+#include <cctype>
+#include <chrono>
+#include <sys/stat.h>
 
 extern "C"
 {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
-#include <libavutil/imgutils.h>
-#include <libswscale/swscale.h>
 }
 
+namespace
+{
+// recording_20260101_120000.mp4 -> recording_20260101_120000_part003.mp4
+std::string segmentPath(const std::string &basePath, uint32_t index)
+{
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_part%03u", index);
+    const size_t slash = basePath.find_last_of("/\\");
+    size_t dot = basePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        dot = basePath.size();
+    }
+    return basePath.substr(0, dot) + suffix + basePath.substr(dot);
+}
+
+// Instant-replay files sit next to the recordings with their own prefix.
+const char *kReplayFilenameTemplate = "replay_%Y%m%d_%H%M%S";
+
+// Longest a segment cut waits for audio to catch up before rotating anyway.
+constexpr int64_t kMaxCutHoldUs = 1000000;
+
+// Standalone AVCodecContext carrying just the stream parameters and time
+// base of source — all MediaMuxer reads from a context. Caller frees it
+// with avcodec_free_context().
+void *cloneCodecParameters(const void *source)
+{
+    const AVCodecContext *src = static_cast<const AVCodecContext *>(source);
+    if (!src)
+    {
+        return nullptr;
+    }
+    AVCodecParameters *params = avcodec_parameters_alloc();
+    AVCodecContext *copy = avcodec_alloc_context3(nullptr);
+    if (!params || !copy || avcodec_parameters_from_context(params, src) < 0 ||
+        avcodec_parameters_to_context(copy, params) < 0)
+    {
+        LOG_ERROR("RecordingManager: Failed to copy shared codec parameters");
+        avcodec_parameters_free(&params);
+        avcodec_free_context(&copy);
+        return nullptr;
+    }
+    avcodec_parameters_free(&params);
+    copy->time_base = src->time_base;
+    copy->framerate = src->framerate;
+    return copy;
+}
+
+// recording.mp4 -> recording.jpg, next to the video.
+std::string thumbnailPathFor(const std::string &videoPath)
+{
+    fs::path path(videoPath);
+#if defined(_WIN32) && defined(__GNUC__) && __GNUC__ < 8
+    // Custom implementation: stem() returns std::string
+    return (path.parent_path() / (path.stem() + ".jpg")).string();
+#else
+    return (path.parent_path() / (path.stem().string() + ".jpg")).string();
+#endif
+}
+
+std::string isoTimestampNow()
+{
+    std::time_t time = std::time(nullptr);
+    std::tm *tm = std::gmtime(&time);
+    std::stringstream timeStr;
+    timeStr << std::put_time(tm, "%Y-%m-%dT%H:%M:%SZ");
+    return timeStr.str();
+}
+} // namespace
+
 RecordingManager::RecordingManager()
 {
     // Default metadata path
@@ -94,7 +167,17 @@ bool RecordingManager::initialize()
     }
 
     // Load existing recordings metadata
-    loadRecordingsMetadata();
+    m_catalog.open(m_metadataPath);
+
+    m_thumbnailer.start([this](const std::vector<RecordingThumbnailer::Result> &results)
+                        { onThumbnailsReady(results); });
+    queueThumbnailBackfill();
+
+    {
+        std::lock_guard<std::mutex> lock(m_rescanMutex);
+        m_rescanStop = false;
+    }
+    m_rescanThread = std::thread(&RecordingManager::rescanThread, this);
 
     m_initialized = true;
     LOG_INFO("RecordingManager: Initialized");
@@ -107,6 +190,7 @@ void RecordingManager::shutdown()
     {
         stopRecording();
     }
+    stopReplayBuffer();
 
     if (m_running)
     {
@@ -118,49 +202,200 @@ void RecordingManager::shutdown()
         m_running = false;
     }
 
+    if (m_replayWriter.joinable())
+    {
+        m_replayWriter.join();
+    }
+
     m_encoder.cleanup();
     m_recorder.cleanup();
     m_synchronizer.clear();
 
+    stopRescan();
+    m_thumbnailer.stop();
+    m_catalog.close();
+
     m_initialized = false;
 }
 
 bool RecordingManager::startRecording(const RecordingSettings &settings)
 {
+    std::lock_guard<std::mutex> control(m_controlMutex);
     if (m_recording)
     {
         LOG_WARN("RecordingManager: Already recording");
         return false;
     }
 
-    m_settings = settings;
+    // With the replay buffer on, the encoder is already running: the file
+    // joins it at the next keyframe and the session's codec settings win.
+    const bool midSession = m_running.load();
+    if (midSession)
+    {
+        LOG_INFO("RecordingManager: replay buffer running — recording joins its encoder");
+    }
+    else if (!startSession(settings))
+    {
+        return false;
+    }
 
-    // Generate output filename
-    std::string outputPath = generateFilename(settings);
+    if (!attachFile(settings, midSession))
+    {
+        if (!midSession)
+        {
+            releaseSharedEncode();
+            teardownSession();
+        }
+        return false;
+    }
 
-    // Initialize metadata
-    m_currentMetadata = RecordingMetadata();
-    m_currentMetadata.filename = fs_helper::get_filename_string(fs::path(outputPath));
-    m_currentMetadata.filepath = fs::absolute(fs::path(outputPath)).string();
-    m_currentMetadata.container = settings.container;
-    m_currentMetadata.videoCodec = settings.codec;
-    m_currentMetadata.audioCodec = settings.includeAudio ? settings.audioCodec : "";
-    m_currentMetadata.width = settings.width;
-    m_currentMetadata.height = settings.height;
-    m_currentMetadata.fps = settings.fps;
+    if (!midSession)
+    {
+        launchEncodingThread();
+    }
 
-    // Generate ID (simple hash from filename + timestamp)
-    std::time_t now = std::time(nullptr);
-    std::stringstream ss;
-    ss << m_currentMetadata.filename << "_" << now;
-    m_currentMetadata.id = std::to_string(std::hash<std::string>{}(ss.str()));
+    LOG_INFO("RecordingManager: Started recording to: " + getCurrentFilename());
+    return true;
+}
 
-    // Get creation timestamp
-    std::time_t time = std::time(nullptr);
-    std::tm *tm = std::gmtime(&time);
-    std::stringstream timeStr;
-    timeStr << std::put_time(tm, "%Y-%m-%dT%H:%M:%SZ");
-    m_currentMetadata.createdAt = timeStr.str();
+void RecordingManager::stopRecording()
+{
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (!m_recording)
+    {
+        return;
+    }
+
+    if (m_replayActive)
+    {
+        // The replay buffer keeps the encoder running; only the file goes.
+        detachFile();
+        LOG_INFO("RecordingManager: Stopped recording (replay buffer still running)");
+        return;
+    }
+
+    drainSession();
+    detachFile();
+    teardownSession();
+
+    LOG_INFO("RecordingManager: Stopped recording");
+}
+
+bool RecordingManager::startReplayBuffer(const RecordingSettings &settings)
+{
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (m_replayActive)
+    {
+        return true;
+    }
+
+    m_replayBuffer.clear();
+    m_replayBuffer.configure(static_cast<uint64_t>(settings.replayBufferSeconds) * 1000000ULL,
+                             settings.replayBufferMaxBytes);
+
+    if (m_running)
+    {
+        // Piggyback on the running recording; the ring fills from its next keyframe.
+        m_replayActive = true;
+        LOG_INFO("RecordingManager: Replay buffer started on the running recording encoder");
+        return true;
+    }
+
+    if (!startSession(settings))
+    {
+        return false;
+    }
+    m_replayActive = true;
+    launchEncodingThread();
+
+    LOG_INFO("RecordingManager: Replay buffer started (" + std::to_string(settings.replayBufferSeconds) + " s, " +
+             std::to_string(settings.replayBufferMaxBytes / (1024 * 1024)) + " MB cap)");
+    return true;
+}
+
+void RecordingManager::stopReplayBuffer()
+{
+    std::lock_guard<std::mutex> control(m_controlMutex);
+    if (!m_replayActive)
+    {
+        return;
+    }
+
+    m_replayActive = false;
+    // A save still queued is dropped; one already handed to the writer
+    // finishes (and clears m_replaySaving itself).
+    if (m_replaySaveRequested.exchange(false))
+    {
+        m_replaySaving = false;
+    }
+    if (!m_recording)
+    {
+        drainSession();
+        teardownSession();
+    }
+    m_replayBuffer.clear();
+    LOG_INFO("RecordingManager: Replay buffer stopped");
+}
+
+bool RecordingManager::saveReplay(uint32_t seconds, std::string *outputPath)
+{
+    if (!m_replayActive)
+    {
+        LOG_WARN("RecordingManager: Replay buffer is not running — nothing to save");
+        return false;
+    }
+
+    bool expected = false;
+    if (!m_replaySaving.compare_exchange_strong(expected, true))
+    {
+        LOG_WARN("RecordingManager: Previous replay is still being written");
+        return false;
+    }
+
+    // Named now so the caller can report it; the file itself is opened by
+    // the encoding thread, which owns the codec contexts the muxer is
+    // opened from — it picks the request up on its next iteration.
+    RecordingSettings replaySettings;
+    {
+        // m_settings is rewritten by startSession() under the same lock.
+        std::lock_guard<std::mutex> control(m_controlMutex);
+        replaySettings = m_settings;
+    }
+    replaySettings.filenameTemplate = kReplayFilenameTemplate;
+    const std::string path = generateFilename(replaySettings);
+    {
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        m_replaySavePath = path;
+    }
+    if (outputPath)
+    {
+        *outputPath = path;
+    }
+    m_replaySaveSeconds = seconds;
+    m_replaySaveRequested = true;
+    wakeEncodingThread();
+    return true;
+}
+
+uint64_t RecordingManager::getReplayBufferDurationUs() const
+{
+    return m_replayBuffer.getDurationUs();
+}
+
+uint64_t RecordingManager::getReplayBufferBytes() const
+{
+    return m_replayBuffer.getBytes();
+}
+
+std::string RecordingManager::getLastReplayPath()
+{
+    std::lock_guard<std::mutex> lock(m_statusMutex);
+    return m_lastReplayPath;
+}
+
+bool RecordingManager::startSession(const RecordingSettings &settings)
+{
+    m_settings = settings;
 
     // Reset timestamp tracking (not needed with absolute timestamps, but keep for cleanup)
     m_recordingStartTimestampUs = 0;
@@ -209,111 +444,54 @@ bool RecordingManager::startRecording(const RecordingSettings &settings)
         audioConfig.codec = ""; // Empty codec means no audio
     }
 
+    m_videoConfig = videoConfig;
+    m_audioConfig = audioConfig;
+    m_rebase = PacketRebase();
+
+    // Shared encode: if /stream is already encoding these exact settings,
+    // mux its packets instead of running a second encoder.
+    EncodedPacketBus::SourceInfo shared;
+    const bool useShared = settings.shareStreamEncoder &&
+                           subscribeSharedEncode(videoConfig, audioConfig, shared);
+
     // Inicializar encoder para gravação em arquivo (não streaming)
-    if (!m_encoder.initialize(videoConfig, audioConfig, false))
+    if (!useShared && !m_encoder.initialize(videoConfig, audioConfig, false))
     {
         LOG_ERROR("RecordingManager: Failed to initialize MediaEncoder");
         return false;
     }
-
-    // Stage container metadata before initialize so it lands in the
-    // format header (#59). Mirrors what /meta exposes on the
-    // streaming side but persisted into the file so the artifact is
-    // self-describing. Standard MP4 keys (title / comment / encoder)
-    // get the human-readable summary; custom retrocapture.* keys are
-    // for programmatic readers — these land in MP4 udta atoms and
-    // MKV Tags entries, and ffprobe surfaces them under TAG: prefixes.
-    {
-        std::map<std::string, std::string> meta;
-        std::string title = m_currentMetadata.filename;
-        if (!title.empty()) meta["title"] = title;
-
-        std::ostringstream comment;
-        comment << "RetroCapture session";
-        if (!m_context.shaderName.empty()) {
-            comment << " — shader: " << m_context.shaderName;
-        }
-        if (m_context.sourceWidth && m_context.sourceHeight) {
-            comment << " — source: " << m_context.sourceWidth
-                    << "x" << m_context.sourceHeight;
-            if (m_context.sourceFps) comment << "@" << m_context.sourceFps;
-        }
-        if (!m_context.kind.empty()) comment << " — kind: " << m_context.kind;
-        meta["comment"] = comment.str();
-
-        if (!m_context.applicationVersion.empty()) {
-            meta["encoder"] = "RetroCapture " + m_context.applicationVersion;
-        } else {
-            meta["encoder"] = "RetroCapture";
-        }
-
-        if (!m_context.shaderName.empty())
-            meta["retrocapture.shader"]    = m_context.shaderName;
-        if (!m_context.hostNickname.empty())
-            meta["retrocapture.host"]      = m_context.hostNickname;
-        if (m_context.sourceWidth)
-            meta["retrocapture.source_width"]  = std::to_string(m_context.sourceWidth);
-        if (m_context.sourceHeight)
-            meta["retrocapture.source_height"] = std::to_string(m_context.sourceHeight);
-        if (m_context.sourceFps)
-            meta["retrocapture.source_fps"]    = std::to_string(m_context.sourceFps);
-        if (!m_context.sourceType.empty())
-            meta["retrocapture.source_type"]   = m_context.sourceType;
-        if (!m_context.applicationVersion.empty())
-            meta["retrocapture.version"]       = m_context.applicationVersion;
-        if (!m_context.kind.empty())
-            meta["retrocapture.kind"]          = m_context.kind;
-        meta["retrocapture.codec"] = settings.codec;
-
-        m_recorder.setMetadata(meta);
-    }
-
-    // Initialize FileRecorder
-    if (!m_recorder.initialize(videoConfig, audioConfig,
-                               m_encoder.getVideoCodecContext(),
-                               m_encoder.getAudioCodecContext(),
-                               outputPath))
+    if (useShared)
     {
-        LOG_ERROR("RecordingManager: Failed to initialize FileRecorder");
-        m_encoder.cleanup();
-        return false;
+        // The bus only vouches for its contexts until the detach callback;
+        // muxers opened later (segments, replays) use these copies.
+        m_sharedVideoCtx = cloneCodecParameters(shared.videoCodecContext);
+        m_sharedAudioCtx = cloneCodecParameters(shared.audioCodecContext);
     }
-
-    // Start recording
-    if (!m_recorder.startRecording())
+    else
     {
-        LOG_ERROR("RecordingManager: Failed to start FileRecorder");
-        m_recorder.cleanup();
-        m_encoder.cleanup();
-        return false;
+        // Private encodes only rebase once a file joins mid-stream, but the
+        // segment clock and replay muxing read the time bases from the start.
+        loadRebaseTimeBases();
     }
+    return true;
+}
 
-    // Start encoding thread
+void RecordingManager::launchEncodingThread()
+{
     m_stopRequest = false;
     m_running = true;
-    m_recording = true;
     m_encodingThreadExited.store(false, std::memory_order_relaxed);
     m_encodingThread = std::thread(&RecordingManager::encodingThread, this);
-
-    {
-        std::lock_guard<std::mutex> lock(m_statusMutex);
-        m_currentFilename = outputPath;
-        m_currentFileSize = 0;
-        m_currentDurationUs = 0;
-    }
-
-    LOG_INFO("RecordingManager: Started recording to: " + outputPath);
-    return true;
 }
 
-void RecordingManager::stopRecording()
+void RecordingManager::drainSession()
 {
-    if (!m_recording)
-    {
-        return;
-    }
+    // Stop receiving shared-encode packets first; whatever is already
+    // queued is written below once the encoding thread is gone.
+    releaseSharedEncode();
 
     m_stopRequest = true;
+    wakeEncodingThread();
 
     // Wait for encoding thread to finish, but bail after a deadline so the app
     // can shut down even if the thread is stuck inside FFmpeg. MediaMuxer's
@@ -340,6 +518,11 @@ void RecordingManager::stopRecording()
         }
     }
 
+    if (m_encodingThreadExited.load(std::memory_order_acquire))
+    {
+        drainSharedPackets();
+    }
+
     // Flush encoder and get remaining packets
     if (m_encoder.isInitialized())
     {
@@ -349,68 +532,30 @@ void RecordingManager::stopRecording()
         // Mux remaining packets before stopping
         for (const auto &packet : packets)
         {
-            if (m_recorder.isRecording())
-            {
-                m_recorder.muxPacket(packet);
-            }
+            muxEncodedPacket(packet);
         }
     }
+}
 
-    // Flush recorder to ensure all data is written
-    // Note: stopRecording() will flush and close file, but cleanup() needs file open for av_write_trailer
-    if (m_recorder.isRecording())
-    {
-        m_recorder.flush();
-        // Stop recorder (flushes but keeps file open for cleanup)
-        m_recorder.stopRecording();
-    }
-
-    // Finalize metadata before cleanup
-    {
-        std::lock_guard<std::mutex> lock(m_statusMutex);
-        m_currentMetadata.fileSize = m_recorder.getFileSize();
-        m_currentMetadata.durationUs = m_recorder.getDurationUs();
-    }
-
-    // Cleanup in correct order:
-    // 1. Flush and stop recorder (but keep file open for av_write_trailer)
-    // 2. Cleanup recorder (calls av_write_trailer, then closes file)
-    // 3. Cleanup encoder
-    // 4. Clear synchronizer
-    LOG_INFO("RecordingManager: Starting cleanup sequence");
-    m_recorder.cleanup();
-    LOG_INFO("RecordingManager: Recorder cleaned up, cleaning encoder");
+void RecordingManager::teardownSession()
+{
+    LOG_INFO("RecordingManager: Cleaning encoder");
     m_encoder.cleanup();
-    LOG_INFO("RecordingManager: Encoder cleaned up, clearing synchronizer");
     m_synchronizer.clear();
-    LOG_INFO("RecordingManager: Cleanup sequence completed");
 
-    // Update file size after cleanup (file is now finalized)
-    if (fs::exists(m_currentMetadata.filepath))
+    // The encoding thread is gone, nothing else starts a replay writer.
+    if (m_replayWriter.joinable())
     {
-        try
-        {
-            m_currentMetadata.fileSize = static_cast<uint64_t>(fs::file_size(m_currentMetadata.filepath));
-        }
-        catch (...)
-        {
-            // Ignore errors
-        }
+        m_replayWriter.join();
     }
 
-    // Add to recordings list (after cleanup, file is finalized)
-    // This will also generate thumbnail now that file is complete
-    finalizeCurrentRecording();
-
-    // Reset state
-    {
-        std::lock_guard<std::mutex> lock(m_statusMutex);
-        m_currentFilename.clear();
-        m_currentFileSize = 0;
-        m_currentDurationUs = 0;
-    }
+    AVCodecContext *videoCtx = static_cast<AVCodecContext *>(m_sharedVideoCtx);
+    AVCodecContext *audioCtx = static_cast<AVCodecContext *>(m_sharedAudioCtx);
+    avcodec_free_context(&videoCtx);
+    avcodec_free_context(&audioCtx);
+    m_sharedVideoCtx = nullptr;
+    m_sharedAudioCtx = nullptr;
 
-    m_recording = false;
     m_running = false;
     m_stopRequest = false;
 
@@ -418,48 +563,429 @@ void RecordingManager::stopRecording()
     m_recordingStartTimestampUs = 0;
     m_videoFrameCount = 0;
     m_audioSampleCount = 0;
-
-    LOG_INFO("RecordingManager: Stopped recording");
+    m_rebase = PacketRebase();
+    m_sharedSourceLost = false;
 }
 
-void RecordingManager::pushFrame(const uint8_t *data, uint32_t width, uint32_t height)
+bool RecordingManager::attachFile(const RecordingSettings &settings, bool midSession)
 {
-    if (!m_recording)
+    // Generate output filename. Segmented sessions number every file,
+    // the first one included, so the parts sort together.
+    const std::string basePath = generateFilename(settings);
+    const bool segmented = settings.segmentRecording &&
+                           (settings.maxDurationUs > 0 || settings.maxFileSize > 0);
+    if (settings.segmentRecording && !segmented)
     {
-        return;
+        LOG_WARN("RecordingManager: segmented recording without a duration or size limit — writing a single file");
     }
+    const std::string outputPath = segmented ? segmentPath(basePath, 1) : basePath;
 
-    // Use absolute timestamp when frame arrives
-    // This ensures frames are timestamped based on when they're actually captured
-    int64_t timestampUs = getTimestampUs();
+    std::lock_guard<std::mutex> lock(m_fileOutputMutex);
 
-    bool added = m_synchronizer.addVideoFrame(data, width, height, timestampUs);
+    m_currentMetadata = describeFile(outputPath, settings.container);
+    m_segment = SegmentState();
+    if (segmented)
+    {
+        m_currentMetadata.sessionId = m_currentMetadata.id;
+        m_currentMetadata.segmentIndex = 1;
+        m_segment.enabled = true;
+        m_segment.index = 1;
+        m_segment.basePath = basePath;
+        m_segment.maxDurationUs = settings.maxDurationUs;
+        m_segment.maxFileSize = settings.maxFileSize;
+    }
 
-    static int frameCount = 0;
-    static int logCount = 0;
-    frameCount++;
+    m_segment.containerMetadata = containerMetadata(m_currentMetadata.filename, "RetroCapture session");
+    m_recorder.setMetadata(m_segment.containerMetadata);
+    m_recorder.setFragmented(segmented);
 
-    if (!added)
+    // Initialize FileRecorder
+    if (!m_recorder.initialize(m_videoConfig, m_audioConfig,
+                               currentVideoContext(), currentAudioContext(),
+                               outputPath))
     {
-        if (logCount < 3)
-        {
-            LOG_WARN("RecordingManager: Failed to add video frame to synchronizer");
-            logCount++;
-        }
+        LOG_ERROR("RecordingManager: Failed to initialize FileRecorder");
+        m_segment = SegmentState();
+        return false;
     }
-    else if (frameCount == 1 || frameCount % 60 == 0)
+
+    // Start recording
+    if (!m_recorder.startRecording())
     {
-        // Log first frame and every 60 frames (1 second at 60fps)
-        LOG_INFO("RecordingManager: Pushed frame " + std::to_string(frameCount) +
-                 " (" + std::to_string(width) + "x" + std::to_string(height) + ")");
+        LOG_ERROR("RecordingManager: Failed to start FileRecorder");
+        m_recorder.cleanup();
+        m_segment = SegmentState();
+        return false;
     }
-}
 
-void RecordingManager::pushAudio(const int16_t *samples, size_t sampleCount)
-{
-    if (!m_recording || !m_settings.includeAudio)
+    if (midSession)
     {
-        return;
+        // The encoder has been running for a while: start the file at the
+        // next keyframe and shift it to zero, same as a shared-encode file.
+        loadRebaseTimeBases();
+        m_rebase.active = true;
+        m_rebase.waitingKeyframe = true;
+        if (m_encoder.isInitialized())
+        {
+            m_encoder.requestKeyframe();
+        }
+    }
+
+    if (segmented)
+    {
+        {
+            std::lock_guard<std::mutex> finalizeLock(m_segmentFinalizeMutex);
+            m_segmentFinalizeQueue.clear();
+            m_segmentFinalizerStop = false;
+        }
+        m_segmentFinalizer = std::thread(&RecordingManager::segmentFinalizerThread, this);
+    }
+
+    {
+        std::lock_guard<std::mutex> statusLock(m_statusMutex);
+        m_currentFilename = outputPath;
+        m_currentFileSize = 0;
+        m_currentDurationUs = 0;
+    }
+    m_recording = true;
+    return true;
+}
+
+void RecordingManager::detachFile()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_fileOutputMutex);
+
+        // A cut still waiting for audio: its video belongs to this file now.
+        if (m_segment.cutPending && m_recorder.isRecording())
+        {
+            for (const auto &packet : m_segment.heldVideo)
+            {
+                muxToFileLocked(packet);
+            }
+        }
+
+        // Flush recorder to ensure all data is written
+        // Note: stopRecording() will flush and close file, but cleanup() needs file open for av_write_trailer
+        if (m_recorder.isRecording())
+        {
+            m_recorder.flush();
+            // Stop recorder (flushes but keeps file open for cleanup)
+            m_recorder.stopRecording();
+        }
+
+        // Finalize metadata before cleanup
+        {
+            std::lock_guard<std::mutex> statusLock(m_statusMutex);
+            m_currentMetadata.fileSize = m_recorder.getFileSize();
+            m_currentMetadata.durationUs = m_recorder.getDurationUs();
+        }
+
+        // Cleanup recorder (calls av_write_trailer, then closes file)
+        m_recorder.cleanup();
+        m_segment = SegmentState();
+        m_recording = false;
+    }
+
+    // Update file size after cleanup (file is now finalized)
+    if (fs::exists(m_currentMetadata.filepath))
+    {
+        try
+        {
+            m_currentMetadata.fileSize = static_cast<uint64_t>(fs::file_size(m_currentMetadata.filepath));
+        }
+        catch (...)
+        {
+            // Ignore errors
+        }
+    }
+
+    // Earlier segments first, so the catalog stays in recording order
+    stopSegmentFinalizer();
+
+    // Add to recordings list (after cleanup, file is finalized)
+    // and queue its thumbnail now that the file is complete
+    finalizeCurrentRecording();
+
+    // Reset state
+    {
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        m_currentFilename.clear();
+        m_currentFileSize = 0;
+        m_currentDurationUs = 0;
+    }
+}
+
+RecordingMetadata RecordingManager::describeFile(const std::string &outputPath, const std::string &container) const
+{
+    RecordingMetadata metadata;
+    metadata.filename = fs_helper::get_filename_string(fs::path(outputPath));
+    metadata.filepath = fs::absolute(fs::path(outputPath)).string();
+    metadata.container = container;
+    metadata.videoCodec = m_settings.codec;
+    metadata.audioCodec = m_settings.includeAudio ? m_settings.audioCodec : "";
+    metadata.width = m_settings.width;
+    metadata.height = m_settings.height;
+    metadata.fps = m_settings.fps;
+
+    // Generate ID (simple hash from filename + timestamp)
+    std::time_t now = std::time(nullptr);
+    std::stringstream ss;
+    ss << metadata.filename << "_" << now;
+    metadata.id = std::to_string(std::hash<std::string>{}(ss.str()));
+
+    // Get creation timestamp
+    metadata.createdAt = isoTimestampNow();
+    metadata.shaderName = m_context.shaderName;
+    metadata.sourceType = m_context.sourceType;
+    return metadata;
+}
+
+std::map<std::string, std::string> RecordingManager::containerMetadata(const std::string &title,
+                                                                       const std::string &summary) const
+{
+    // Stage container metadata before initialize so it lands in the
+    // format header (#59). Mirrors what /meta exposes on the
+    // streaming side but persisted into the file so the artifact is
+    // self-describing. Standard MP4 keys (title / comment / encoder)
+    // get the human-readable summary; custom retrocapture.* keys are
+    // for programmatic readers — these land in MP4 udta atoms and
+    // MKV Tags entries, and ffprobe surfaces them under TAG: prefixes.
+    std::map<std::string, std::string> meta;
+    if (!title.empty()) meta["title"] = title;
+
+    std::ostringstream comment;
+    comment << summary;
+    if (!m_context.shaderName.empty()) {
+        comment << " — shader: " << m_context.shaderName;
+    }
+    if (m_context.sourceWidth && m_context.sourceHeight) {
+        comment << " — source: " << m_context.sourceWidth
+                << "x" << m_context.sourceHeight;
+        if (m_context.sourceFps) comment << "@" << m_context.sourceFps;
+    }
+    if (!m_context.kind.empty()) comment << " — kind: " << m_context.kind;
+    meta["comment"] = comment.str();
+
+    if (!m_context.applicationVersion.empty()) {
+        meta["encoder"] = "RetroCapture " + m_context.applicationVersion;
+    } else {
+        meta["encoder"] = "RetroCapture";
+    }
+
+    if (!m_context.shaderName.empty())
+        meta["retrocapture.shader"]    = m_context.shaderName;
+    if (!m_context.hostNickname.empty())
+        meta["retrocapture.host"]      = m_context.hostNickname;
+    if (m_context.sourceWidth)
+        meta["retrocapture.source_width"]  = std::to_string(m_context.sourceWidth);
+    if (m_context.sourceHeight)
+        meta["retrocapture.source_height"] = std::to_string(m_context.sourceHeight);
+    if (m_context.sourceFps)
+        meta["retrocapture.source_fps"]    = std::to_string(m_context.sourceFps);
+    if (!m_context.sourceType.empty())
+        meta["retrocapture.source_type"]   = m_context.sourceType;
+    if (!m_context.applicationVersion.empty())
+        meta["retrocapture.version"]       = m_context.applicationVersion;
+    if (!m_context.kind.empty())
+        meta["retrocapture.kind"]          = m_context.kind;
+    meta["retrocapture.codec"] = m_settings.codec;
+    return meta;
+}
+
+void *RecordingManager::currentVideoContext() const
+{
+    // A fallback encoder that took over from the shared one owns the
+    // contexts now; otherwise the copies of the shared encoder's.
+    return m_encoder.isInitialized() ? m_encoder.getVideoCodecContext() : m_sharedVideoCtx;
+}
+
+void *RecordingManager::currentAudioContext() const
+{
+    return m_encoder.isInitialized() ? m_encoder.getAudioCodecContext() : m_sharedAudioCtx;
+}
+
+void RecordingManager::loadRebaseTimeBases()
+{
+    const AVCodecContext *videoCtx = static_cast<const AVCodecContext *>(currentVideoContext());
+    const AVCodecContext *audioCtx = static_cast<const AVCodecContext *>(currentAudioContext());
+    if (videoCtx)
+    {
+        m_rebase.videoTbNum = videoCtx->time_base.num;
+        m_rebase.videoTbDen = videoCtx->time_base.den;
+    }
+    if (audioCtx)
+    {
+        m_rebase.audioTbNum = audioCtx->time_base.num;
+        m_rebase.audioTbDen = audioCtx->time_base.den;
+    }
+}
+
+void RecordingManager::beginReplaySave()
+{
+    const uint64_t lastUs = static_cast<uint64_t>(m_replaySaveSeconds.load()) * 1000000ULL;
+    auto job = std::unique_ptr<ReplayJob>(new ReplayJob());
+    job->packets = m_replayBuffer.snapshot(lastUs);
+    if (job->packets.empty())
+    {
+        LOG_WARN("RecordingManager: Replay buffer is empty — nothing to save");
+        m_replaySaving = false;
+        return;
+    }
+
+    std::string outputPath;
+    {
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        outputPath = m_replaySavePath;
+    }
+    try
+    {
+        const fs::path dir = fs::path(outputPath).parent_path();
+        if (!dir.empty() && !fs::exists(dir))
+        {
+            fs::create_directories(dir);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("RecordingManager: Exception creating replay directory: " + std::string(e.what()));
+    }
+
+    job->metadata = describeFile(outputPath, m_settings.container);
+    job->muxer.reset(new MediaMuxer());
+    job->muxer->setMetadata(containerMetadata(job->metadata.filename, "RetroCapture replay"));
+
+    // Opened here, on the thread that owns the codec contexts; after
+    // initialize() the muxer only needs the time bases it captured.
+    if (!job->muxer->initialize(m_videoConfig, m_audioConfig,
+                                currentVideoContext(), currentAudioContext(),
+                                job->metadata.filepath))
+    {
+        LOG_ERROR("RecordingManager: Failed to open replay file: " + outputPath);
+        m_replaySaving = false;
+        return;
+    }
+    const AVCodecContext *videoCtx = static_cast<const AVCodecContext *>(currentVideoContext());
+    const AVCodecContext *audioCtx = static_cast<const AVCodecContext *>(currentAudioContext());
+    if (videoCtx)
+    {
+        job->videoTbNum = videoCtx->time_base.num;
+        job->videoTbDen = videoCtx->time_base.den;
+    }
+    if (audioCtx)
+    {
+        job->audioTbNum = audioCtx->time_base.num;
+        job->audioTbDen = audioCtx->time_base.den;
+    }
+
+    // The previous writer is done (m_replaySaving was clear), join is instant.
+    if (m_replayWriter.joinable())
+    {
+        m_replayWriter.join();
+    }
+    m_replayWriter = std::thread(&RecordingManager::writeReplay, this, std::move(job));
+}
+
+void RecordingManager::writeReplay(std::unique_ptr<ReplayJob> job)
+{
+    std::vector<MediaEncoder::EncodedPacket> &packets = job->packets;
+
+    // The snapshot starts on a keyframe; shift everything so it lands at zero.
+    const MediaEncoder::EncodedPacket &first = packets.front();
+    const int64_t videoBase = (first.dts != -1) ? first.dts : first.pts;
+    const int64_t audioBase = (job->audioTbNum > 0 && job->audioTbDen > 0 && job->videoTbDen > 0)
+                                  ? av_rescale_q(videoBase,
+                                                 AVRational{job->videoTbNum, job->videoTbDen},
+                                                 AVRational{job->audioTbNum, job->audioTbDen})
+                                  : 0;
+
+    size_t written = 0;
+    for (auto &packet : packets)
+    {
+        const int64_t base = packet.isVideo ? videoBase : audioBase;
+        if (packet.pts != -1) packet.pts -= base;
+        if (packet.dts != -1) packet.dts -= base;
+        // Audio encoded just before the keyframe lands before zero.
+        if ((packet.pts != -1 && packet.pts < 0) || (packet.dts != -1 && packet.dts < 0))
+        {
+            continue;
+        }
+        if (job->muxer->muxPacket(packet))
+        {
+            written++;
+        }
+    }
+    job->muxer->finalize();
+    job->muxer->release();
+
+    RecordingMetadata &metadata = job->metadata;
+    if (packets.back().captureTimestampUs > first.captureTimestampUs)
+    {
+        metadata.durationUs = static_cast<uint64_t>(packets.back().captureTimestampUs - first.captureTimestampUs);
+    }
+    try
+    {
+        if (fs::exists(metadata.filepath))
+        {
+            metadata.fileSize = static_cast<uint64_t>(fs::file_size(metadata.filepath));
+        }
+    }
+    catch (...)
+    {
+        // Ignore errors
+    }
+
+    LOG_INFO("RecordingManager: Replay saved: " + metadata.filepath + " (" + std::to_string(written) +
+             " packets, " + std::to_string(metadata.durationUs / 1000000) + " s)");
+    const std::string path = metadata.filepath;
+    finalizeRecording(metadata);
+
+    {
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        m_lastReplayPath = path;
+    }
+    m_replaySaving = false;
+}
+
+void RecordingManager::pushFrame(const uint8_t *data, uint32_t width, uint32_t height, VideoFrameFormat format)
+{
+    // Shared encode: the /stream encoder already has this frame.
+    if (!m_running || m_usingSharedEncode.load())
+    {
+        return;
+    }
+
+    // Use absolute timestamp when frame arrives
+    // This ensures frames are timestamped based on when they're actually captured
+    int64_t timestampUs = getTimestampUs();
+
+    bool added = m_synchronizer.addVideoFrame(data, width, height, timestampUs, format);
+
+    static int frameCount = 0;
+    static int logCount = 0;
+    frameCount++;
+
+    if (!added)
+    {
+        if (logCount < 3)
+        {
+            LOG_WARN("RecordingManager: Failed to add video frame to synchronizer");
+            logCount++;
+        }
+    }
+    else if (frameCount == 1 || frameCount % 60 == 0)
+    {
+        // Log first frame and every 60 frames (1 second at 60fps)
+        LOG_INFO("RecordingManager: Pushed frame " + std::to_string(frameCount) +
+                 " (" + std::to_string(width) + "x" + std::to_string(height) + ")");
+    }
+}
+
+void RecordingManager::pushAudio(const int16_t *samples, size_t sampleCount)
+{
+    if (!m_running || !m_settings.includeAudio || m_usingSharedEncode.load())
+    {
+        return;
     }
 
     // Use absolute timestamp when audio chunk arrives
@@ -478,10 +1004,60 @@ void RecordingManager::encodingThread()
 
     int cleanupCounter = 0;
     const int CLEANUP_INTERVAL = 10;
+    // The thread blocks until new data arrives (synchronizer push or
+    // shared packet); this only bounds the wait so cleanupOldData() still
+    // runs when capture stops. stopRecording() wakes it immediately.
+    const int64_t IDLE_WAIT_US = 50000;
 
     while (m_running && !m_stopRequest)
     {
-        bool processedAny = false;
+        if (m_replaySaveRequested.exchange(false))
+        {
+            if (m_replayActive && !m_stopRequest)
+            {
+                beginReplaySave();
+            }
+            else
+            {
+                m_replaySaving = false;
+            }
+        }
+
+        // The shared /stream encoder went away (streaming stopped): write
+        // what it already produced, then continue on a private encoder.
+        if (m_sharedSourceLost.exchange(false))
+        {
+            drainSharedPackets();
+            if (!startFallbackEncoder())
+            {
+                LOG_ERROR("RecordingManager: could not take over from the shared encoder — "
+                          "recording stops here, file is finalized on stop");
+                break;
+            }
+        }
+
+        if (m_usingSharedEncode.load())
+        {
+            if (drainSharedPackets())
+            {
+                std::lock_guard<std::mutex> lock(m_statusMutex);
+                m_currentFileSize = m_recorder.getFileSize();
+                m_currentDurationUs = m_recorder.getDurationUs();
+            }
+            std::unique_lock<std::mutex> lock(m_sharedMutex);
+            m_sharedCv.wait_for(lock, std::chrono::microseconds(IDLE_WAIT_US),
+                                [this]
+                                {
+                                    return !m_sharedPackets.empty() || m_stopRequest || m_sharedSourceLost ||
+                                           m_replaySaveRequested;
+                                });
+            continue;
+        }
+
+        // Snapshot before draining so a push during this iteration makes
+        // the wait at the bottom return immediately.
+        const uint64_t seenSequence = m_synchronizer.getDataSequence();
+        bool moreVideo = false;
 
         // Cleanup old data occasionally
         cleanupCounter++;
@@ -511,7 +1087,7 @@ void RecordingManager::encodingThread()
                 {
                     for (const auto &p : aPackets)
                     {
-                        if (!m_recorder.muxPacket(p))
+                        if (!muxEncodedPacket(p))
                         {
                             static int audioMuxErrorCount = 0;
                             if (audioMuxErrorCount++ < 3)
@@ -520,7 +1096,6 @@ void RecordingManager::encodingThread()
                             }
                         }
                     }
-                    processedAny = true;
                 }
                 m_synchronizer.markAudioChunkProcessedByTimestamp(chunk.captureTimestampUs);
             }
@@ -536,11 +1111,21 @@ void RecordingManager::encodingThread()
         bufferLogCounter++;
         if (bufferLogCounter == 1 || bufferLogCounter % 100 == 0)
         {
+            // Push -> encoded latency of the frames since the last line.
+            auto latency = m_synchronizer.fetchVideoQueueLatency();
+            std::string latencyStr;
+            if (latency.frames > 0)
+            {
+                char buf[64];
+                std::snprintf(buf, sizeof(buf), ", QueueLatency: avg=%.2fms max=%.2fms",
+                              (latency.totalUs / 1000.0) / latency.frames, latency.maxUs / 1000.0);
+                latencyStr = buf;
+            }
             LOG_INFO("RecordingManager: Buffer status - Video: " + std::to_string(videoBufferSize) +
                      ", Audio: " + std::to_string(audioBufferSize) +
                      ", IncludeAudio: " + std::string(m_settings.includeAudio ? "true" : "false") +
                      ", AudioSR: " + std::to_string(m_audioSampleRate) +
-                     ", AudioCh: " + std::to_string(m_audioChannels));
+                     ", AudioCh: " + std::to_string(m_audioChannels) + latencyStr);
         }
 
         // Calculate sync zone
@@ -582,7 +1167,7 @@ void RecordingManager::encodingThread()
             }
             else
             {
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                m_synchronizer.waitForData(seenSequence, IDLE_WAIT_US);
                 continue;
             }
         }
@@ -606,6 +1191,7 @@ void RecordingManager::encodingThread()
 
                 if (framesProcessed >= MAX_FRAMES_PER_ITERATION)
                 {
+                    moreVideo = true;
                     break;
                 }
 
@@ -614,17 +1200,16 @@ void RecordingManager::encodingThread()
                     // Encode frame
                     std::vector<MediaEncoder::EncodedPacket> packets;
                     if (m_encoder.encodeVideo(frame.data->data(), frame.width, frame.height,
-                                              frame.captureTimestampUs, packets))
+                                              frame.captureTimestampUs, packets, frame.format))
                     {
                         // Mux packets
                         for (const auto &packet : packets)
                         {
-                            if (!m_recorder.muxPacket(packet))
+                            if (!muxEncodedPacket(packet))
                             {
                                 LOG_ERROR("RecordingManager: Failed to mux packet");
                             }
                         }
-                        processedAny = true;
                         framesProcessed++;
 
                         // Log first successful frame
@@ -663,392 +1248,721 @@ void RecordingManager::encodingThread()
             }
         }
 
-        // Add delay based on FPS (same as streaming) to maintain natural rate
-        // Reduce delay when there's backlog to process faster
-        if (processedAny)
+        // Cap hit: go straight back for the rest. Otherwise block until
+        // the next push instead of the old 100 µs / frameTime/2 / 10 ms
+        // sleeps, which delayed every frame by up to half a frame time.
+        if (!moreVideo)
         {
-            if (hasBacklog)
-            {
-                // When there's backlog, minimal delay to not consume 100% CPU but process fast
-                std::this_thread::sleep_for(std::chrono::microseconds(100)); // 100µs only
-            }
-            else
+            m_synchronizer.waitForData(seenSequence, IDLE_WAIT_US);
+        }
+    }
+
+    m_encodingThreadExited.store(true, std::memory_order_release);
+}
+
+bool RecordingManager::subscribeSharedEncode(const MediaEncoder::VideoConfig &videoConfig,
+                                             const MediaEncoder::AudioConfig &audioConfig,
+                                             EncodedPacketBus::SourceInfo &info)
+{
+    if (!m_sharedEncodeSource)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        m_sharedPackets.clear();
+        m_sharedDropUntilKeyframe = false;
+    }
+    m_sharedSourceLost = false;
+    m_usingSharedEncode = true; // before subscribe: a detach may race us
+
+    auto onPacket = [this](const MediaEncoder::EncodedPacket &packet)
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        if (m_sharedDropUntilKeyframe)
+        {
+            if (!packet.isVideo || !packet.isKeyframe)
             {
-                // No backlog: delay based on FPS to maintain natural rate
-                // For 60 FPS: ~16.67ms per frame, but we process 2 frames, so ~8ms
-                int64_t frameTimeUs = 1000000LL / static_cast<int64_t>(m_settings.fps > 0 ? m_settings.fps : 60);
-                int64_t delayUs = frameTimeUs / 2; // Delay proportional (since we process 2 frames)
-                std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+                return;
             }
+            m_sharedDropUntilKeyframe = false;
         }
-        else
+        if (m_sharedPackets.size() >= kMaxSharedBacklog)
         {
-            // No data processed, wait a bit
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            // Our thread stalled (slow disk). Dropping single packets would
+            // leave undecodable references in the file — drop the whole
+            // backlog and resume at the next keyframe instead.
+            m_sharedPackets.clear();
+            m_sharedDropUntilKeyframe = true;
+            LOG_WARN("RecordingManager: shared encode backlog overflow — skipping to next keyframe");
+            return;
         }
+        m_sharedPackets.push_back(packet);
+        m_sharedCv.notify_one();
+    };
+    auto onDetach = [this](int64_t epochUs)
+    {
+        m_sharedEpochUs = epochUs;
+        m_sharedSubscription = 0;
+        m_usingSharedEncode = false;
+        m_sharedSourceLost = true;
+        wakeEncodingThread();
+    };
+
+    const uint64_t id = m_sharedEncodeSource->subscribe(videoConfig, audioConfig, onPacket, onDetach, info);
+    if (id == 0)
+    {
+        m_usingSharedEncode = false;
+        LOG_INFO("RecordingManager: stream encoder settings differ — using a separate encoder");
+        return false;
     }
 
-    m_encodingThreadExited.store(true, std::memory_order_release);
-}
+    // The streaming encoder keeps parameter sets in-band and may carry no
+    // extradata. MP4/MOV recover H.264/HEVC headers from the first
+    // keyframe; anything else needs real extradata to write its header.
+    const AVCodecContext *videoCtx = static_cast<const AVCodecContext *>(info.videoCodecContext);
+    const AVCodecContext *audioCtx = static_cast<const AVCodecContext *>(info.audioCodecContext);
+    const std::string &container = m_settings.container;
+    const bool inBandOk = (container == "mp4" || container == "mov") &&
+                          (videoCtx->codec_id == AV_CODEC_ID_H264 || videoCtx->codec_id == AV_CODEC_ID_HEVC);
+    const bool headersOk = (videoCtx->extradata_size > 0 || inBandOk) && audioCtx->extradata_size > 0;
+    if (!headersOk)
+    {
+        m_sharedEncodeSource->unsubscribe(id);
+        m_usingSharedEncode = false;
+        LOG_INFO("RecordingManager: stream bitstream can't be muxed into ." + container +
+                 " as-is — using a separate encoder");
+        return false;
+    }
 
-uint64_t RecordingManager::getCurrentDurationUs()
-{
-    std::lock_guard<std::mutex> lock(m_statusMutex);
-    return m_currentDurationUs;
+    m_sharedSubscription = id;
+    m_videoConfig = info.videoConfig;
+    m_audioConfig = info.audioConfig;
+    m_rebase.active = true;
+    m_rebase.waitingKeyframe = true;
+    m_rebase.videoTbNum = videoCtx->time_base.num;
+    m_rebase.videoTbDen = videoCtx->time_base.den;
+    m_rebase.audioTbNum = audioCtx->time_base.num;
+    m_rebase.audioTbDen = audioCtx->time_base.den;
+
+    LOG_INFO("RecordingManager: sharing the /stream encoder (one encode, two outputs)");
+    return true;
 }
 
-uint64_t RecordingManager::getCurrentFileSize()
+void RecordingManager::releaseSharedEncode()
 {
-    std::lock_guard<std::mutex> lock(m_statusMutex);
-    return m_currentFileSize;
+    const uint64_t id = m_sharedSubscription.exchange(0);
+    if (id != 0 && m_sharedEncodeSource)
+    {
+        m_sharedEncodeSource->unsubscribe(id);
+    }
+    m_usingSharedEncode = false;
 }
 
-std::string RecordingManager::getCurrentFilename()
+void RecordingManager::wakeEncodingThread()
 {
-    std::lock_guard<std::mutex> lock(m_statusMutex);
-    return m_currentFilename;
+    // Taking the lock orders the flag the caller just set against the
+    // predicate check in the waiting thread — no lost wake-up.
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+    }
+    m_sharedCv.notify_all();
+    m_synchronizer.wakeConsumers();
 }
 
-bool RecordingManager::loadRecordingsMetadata()
+bool RecordingManager::drainSharedPackets()
 {
-    std::lock_guard<std::mutex> lock(m_recordingsMutex);
-
-    try
+    std::deque<MediaEncoder::EncodedPacket> packets;
+    {
+        std::lock_guard<std::mutex> lock(m_sharedMutex);
+        packets.swap(m_sharedPackets);
+    }
+    for (const auto &packet : packets)
     {
-        if (!fs::exists(m_metadataPath))
+        if (!muxEncodedPacket(packet))
         {
-            return true; // No metadata file yet, that's OK
+            static int sharedMuxErrorCount = 0;
+            if (sharedMuxErrorCount++ < 3)
+            {
+                LOG_ERROR("RecordingManager: Failed to mux shared-encode packet");
+            }
         }
+    }
+    return !packets.empty();
+}
 
-        std::ifstream file(m_metadataPath);
-        if (!file.is_open())
-        {
-            LOG_WARN("RecordingManager: Failed to open metadata file: " + m_metadataPath);
-            return false;
-        }
+bool RecordingManager::startFallbackEncoder()
+{
+    // Streaming-mode configuration, identical to the encoder we were
+    // sharing, so parameter sets and rate control stay consistent inside
+    // the file; same epoch so PTS continue on the same timeline and the
+    // rebase computed from the first shared keyframe still applies.
+    if (!m_encoder.initialize(m_videoConfig, m_audioConfig, true))
+    {
+        LOG_ERROR("RecordingManager: Failed to initialize fallback MediaEncoder");
+        return false;
+    }
+    m_encoder.setTimestampEpochUs(m_sharedEpochUs.load());
+    LOG_INFO("RecordingManager: shared encoder detached — continuing with a private encoder");
+    return true;
+}
 
-        nlohmann::json json;
-        file >> json;
-        file.close();
+bool RecordingManager::muxEncodedPacket(const MediaEncoder::EncodedPacket &packet)
+{
+    // The ring keeps the encoder's own timestamps; writeReplay() rebases.
+    if (m_replayActive)
+    {
+        m_replayBuffer.push(packet);
+    }
 
-        if (json.contains("recordings") && json["recordings"].is_array())
+    std::lock_guard<std::mutex> lock(m_fileOutputMutex);
+    if (!m_recorder.isRecording())
+    {
+        return true; // replay buffer only
+    }
+
+    if (m_segment.cutPending)
+    {
+        if (!packet.isVideo)
         {
-            m_recordings.clear();
-            for (const auto &item : json["recordings"])
+            const int64_t ts = (packet.pts != -1) ? packet.pts : packet.dts;
+            if (ts < m_segment.cutAudioTs)
             {
-                m_recordings.push_back(RecordingMetadata::fromJSON(item));
+                // Stamped before the cut: still part of the outgoing file.
+                return muxToFileLocked(packet);
             }
+            if (!completeSegmentCut())
+            {
+                return false;
+            }
+            return muxToFileLocked(packet);
+        }
+        m_segment.heldVideo.push_back(packet);
+        // Audio stalled (or silent): don't hold video for more than a second.
+        const int64_t ts = (packet.dts != -1) ? packet.dts : packet.pts;
+        const int64_t heldUs = av_rescale_q(ts - m_segment.cutTs,
+                                            AVRational{m_rebase.videoTbNum, m_rebase.videoTbDen},
+                                            AVRational{1, 1000000});
+        if (heldUs >= kMaxCutHoldUs && !completeSegmentCut())
+        {
+            return false;
         }
-
         return true;
     }
-    catch (const std::exception &e)
+
+    // Segment cut: the keyframe that crosses a limit becomes the first
+    // packet of the next file. Skipped while a shared session still waits
+    // for its very first keyframe (that one starts segment 1).
+    if (m_segment.enabled && packet.isVideo && !m_stopRequest &&
+        !(m_rebase.active && m_rebase.waitingKeyframe))
     {
-        LOG_ERROR("RecordingManager: Exception loading metadata: " + std::string(e.what()));
-        return false;
+        const int64_t ts = (packet.dts != -1) ? packet.dts : packet.pts;
+        if (segmentLimitReached(packet, ts) && packet.isKeyframe)
+        {
+            const bool hasAudio = m_settings.includeAudio && currentAudioContext() &&
+                                  m_rebase.audioTbNum > 0 && m_rebase.audioTbDen > 0 &&
+                                  m_rebase.videoTbNum > 0 && m_rebase.videoTbDen > 0;
+            if (!hasAudio)
+            {
+                return rotateSegment(ts) && muxToFileLocked(packet);
+            }
+            m_segment.cutPending = true;
+            m_segment.cutTs = ts;
+            m_segment.cutAudioTs = av_rescale_q(ts,
+                                                AVRational{m_rebase.videoTbNum, m_rebase.videoTbDen},
+                                                AVRational{m_rebase.audioTbNum, m_rebase.audioTbDen});
+            m_segment.heldVideo.push_back(packet);
+            return true;
+        }
     }
+
+    return muxToFileLocked(packet);
 }
 
-bool RecordingManager::saveRecordingsMetadata()
+bool RecordingManager::muxToFileLocked(const MediaEncoder::EncodedPacket &packet)
 {
-    std::lock_guard<std::mutex> lock(m_recordingsMutex);
+    if (!m_rebase.active)
+    {
+        return m_recorder.muxPacket(packet);
+    }
 
-    try
+    if (m_rebase.waitingKeyframe)
     {
-        // Ensure directory exists
-        fs::path metadataPath(m_metadataPath);
-        fs::path dir = metadataPath.parent_path();
-        if (!dir.empty() && !fs::exists(dir))
+        // Nothing before the first keyframe is decodable on its own.
+        if (!packet.isVideo || !packet.isKeyframe)
         {
-            fs::create_directories(dir);
+            return true;
         }
+        const int64_t start = (packet.dts != -1) ? packet.dts : packet.pts;
+        m_rebase.videoBase = std::max<int64_t>(start, 0);
+        m_rebase.audioBase = av_rescale_q(m_rebase.videoBase,
+                                          AVRational{m_rebase.videoTbNum, m_rebase.videoTbDen},
+                                          AVRational{m_rebase.audioTbNum, m_rebase.audioTbDen});
+        m_rebase.waitingKeyframe = false;
+    }
 
-        nlohmann::json json;
-        json["recordings"] = nlohmann::json::array();
-        for (const auto &recording : m_recordings)
-        {
-            json["recordings"].push_back(recording.toJSON());
-        }
+    MediaEncoder::EncodedPacket shifted = packet;
+    const int64_t base = packet.isVideo ? m_rebase.videoBase : m_rebase.audioBase;
+    if (shifted.pts != -1) shifted.pts -= base;
+    if (shifted.dts != -1) shifted.dts -= base;
+    // Audio encoded just before the first keyframe of a session lands
+    // before zero (segment cuts hand it to the previous file instead).
+    if ((shifted.pts != -1 && shifted.pts < 0) || (shifted.dts != -1 && shifted.dts < 0))
+    {
+        return true;
+    }
+    return m_recorder.muxPacket(shifted);
+}
 
-        std::ofstream file(m_metadataPath);
-        if (!file.is_open())
+bool RecordingManager::completeSegmentCut()
+{
+    std::vector<MediaEncoder::EncodedPacket> held;
+    held.swap(m_segment.heldVideo);
+    m_segment.cutPending = false;
+    if (!rotateSegment(m_segment.cutTs))
+    {
+        return false;
+    }
+    for (const auto &packet : held)
+    {
+        if (!muxToFileLocked(packet))
         {
-            LOG_ERROR("RecordingManager: Failed to open metadata file for writing: " + m_metadataPath);
             return false;
         }
+    }
+    return true;
+}
 
-        file << json.dump(2);
-        file.close();
+bool RecordingManager::segmentLimitReached(const MediaEncoder::EncodedPacket &packet, int64_t ts)
+{
+    if (!m_segment.started)
+    {
+        m_segment.started = true;
+        m_segment.startTs = ts;
+        return false;
+    }
 
-        return true;
+    bool reached = false;
+    if (m_segment.maxDurationUs > 0 && m_rebase.videoTbNum > 0 && m_rebase.videoTbDen > 0)
+    {
+        const int64_t elapsedUs = av_rescale_q(ts - m_segment.startTs,
+                                               AVRational{m_rebase.videoTbNum, m_rebase.videoTbDen},
+                                               AVRational{1, 1000000});
+        reached = elapsedUs >= static_cast<int64_t>(m_segment.maxDurationUs);
     }
-    catch (const std::exception &e)
+    if (!reached && m_segment.maxFileSize > 0)
+    {
+        reached = m_recorder.getFileSize() >= m_segment.maxFileSize;
+    }
+
+    // Our own encoder only emits a keyframe every gop_size frames (2 s);
+    // ask for one now so the segment overshoots by a frame, not a GOP.
+    // A shared encoder is left alone — forcing IDRs would hit the stream.
+    if (reached && !packet.isKeyframe && !m_segment.keyframeRequested && m_encoder.isInitialized())
     {
-        LOG_ERROR("RecordingManager: Exception saving metadata: " + std::string(e.what()));
+        m_encoder.requestKeyframe();
+        m_segment.keyframeRequested = true;
+    }
+    return reached;
+}
+
+bool RecordingManager::rotateSegment(int64_t keyframeTs)
+{
+    RecordingMetadata finished = m_currentMetadata;
+    finished.durationUs = m_recorder.getDurationUs();
+
+    const uint32_t nextIndex = m_segment.index + 1;
+    const std::string nextPath = segmentPath(m_segment.basePath, nextIndex);
+
+    const std::string nextFilename = fs_helper::get_filename_string(fs::path(nextPath));
+    m_segment.containerMetadata["title"] = nextFilename;
+    m_recorder.setMetadata(m_segment.containerMetadata);
+
+    const bool opened = m_recorder.startNextSegment(nextPath, currentVideoContext(), currentAudioContext());
+
+    // The previous file is closed either way — hand it to the finalizer.
+    {
+        std::lock_guard<std::mutex> lock(m_segmentFinalizeMutex);
+        m_segmentFinalizeQueue.push_back(finished);
+    }
+    m_segmentFinalizeCv.notify_one();
+
+    if (!opened)
+    {
+        LOG_ERROR("RecordingManager: Failed to open segment " + nextPath + " — recording stops here");
+        m_segment.enabled = false;
         return false;
     }
+
+    m_currentMetadata.filename = nextFilename;
+    m_currentMetadata.filepath = fs::absolute(fs::path(nextPath)).string();
+    std::stringstream idSource;
+    idSource << nextFilename << "_" << std::time(nullptr);
+    m_currentMetadata.id = std::to_string(std::hash<std::string>{}(idSource.str()));
+    m_currentMetadata.createdAt = isoTimestampNow();
+    m_currentMetadata.segmentIndex = nextIndex;
+    m_currentMetadata.fileSize = 0;
+    m_currentMetadata.durationUs = 0;
+    m_currentMetadata.thumbnailPath.clear();
+
+    // Every segment starts at zero: shift by the cut keyframe. Audio
+    // stamped before it already went to the previous file.
+    m_rebase.active = true;
+    m_rebase.waitingKeyframe = false;
+    m_rebase.videoBase = keyframeTs;
+    m_rebase.audioBase = (m_rebase.audioTbNum > 0 && m_rebase.audioTbDen > 0)
+                             ? av_rescale_q(keyframeTs,
+                                            AVRational{m_rebase.videoTbNum, m_rebase.videoTbDen},
+                                            AVRational{m_rebase.audioTbNum, m_rebase.audioTbDen})
+                             : 0;
+
+    m_segment.index = nextIndex;
+    m_segment.startTs = keyframeTs;
+    m_segment.keyframeRequested = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        m_currentFilename = nextPath;
+        m_currentFileSize = 0;
+        m_currentDurationUs = 0;
+    }
+
+    LOG_INFO("RecordingManager: Segment " + std::to_string(nextIndex) + " started: " + nextPath);
+    return true;
 }
 
-void RecordingManager::finalizeCurrentRecording()
+void RecordingManager::segmentFinalizerThread()
 {
-    // Generate thumbnail from video file (file is already finalized at this point)
-    if (fs::exists(m_currentMetadata.filepath))
+    // Saving rewrites the whole catalog JSON; that doesn't belong on the
+    // encoding thread mid-recording.
+    std::unique_lock<std::mutex> lock(m_segmentFinalizeMutex);
+    while (true)
     {
-        // Generate thumbnail path: same name as video but with .jpg extension
-        fs::path videoPath(m_currentMetadata.filepath);
-#if defined(_WIN32) && defined(__GNUC__) && __GNUC__ < 8
-        // Custom implementation: stem() returns std::string
-        fs::path thumbnailPath = videoPath.parent_path() / (videoPath.stem() + ".jpg");
-#else
-        // std::filesystem: stem() returns path, need to convert to string
-        fs::path thumbnailPath = videoPath.parent_path() / (videoPath.stem().string() + ".jpg");
-#endif
+        m_segmentFinalizeCv.wait(lock, [this]
+                                 { return m_segmentFinalizerStop || !m_segmentFinalizeQueue.empty(); });
+        if (m_segmentFinalizeQueue.empty())
+        {
+            break; // stop requested and nothing left
+        }
+        RecordingMetadata metadata = m_segmentFinalizeQueue.front();
+        m_segmentFinalizeQueue.pop_front();
+        lock.unlock();
 
-        if (generateThumbnail(m_currentMetadata.filepath, thumbnailPath.string()))
+        try
         {
-            m_currentMetadata.thumbnailPath = thumbnailPath.string();
-            LOG_INFO("RecordingManager: Thumbnail generated: " + m_currentMetadata.thumbnailPath);
+            if (fs::exists(metadata.filepath))
+            {
+                metadata.fileSize = static_cast<uint64_t>(fs::file_size(metadata.filepath));
+            }
         }
-        else
+        catch (...)
         {
-            LOG_WARN("RecordingManager: Failed to generate thumbnail for: " + m_currentMetadata.filepath);
+            // Ignore errors
         }
+        finalizeRecording(metadata);
+
+        lock.lock();
     }
+}
 
+void RecordingManager::stopSegmentFinalizer()
+{
+    if (!m_segmentFinalizer.joinable())
     {
-        std::lock_guard<std::mutex> lock(m_recordingsMutex);
-        m_recordings.push_back(m_currentMetadata);
+        return;
     }
+    {
+        std::lock_guard<std::mutex> lock(m_segmentFinalizeMutex);
+        m_segmentFinalizerStop = true;
+    }
+    m_segmentFinalizeCv.notify_all();
+    m_segmentFinalizer.join();
+}
 
-    saveRecordingsMetadata();
+uint64_t RecordingManager::getCurrentDurationUs()
+{
+    std::lock_guard<std::mutex> lock(m_statusMutex);
+    return m_currentDurationUs;
 }
 
-bool RecordingManager::generateThumbnail(const std::string &videoPath, const std::string &thumbnailPath)
+uint64_t RecordingManager::getCurrentFileSize()
 {
-    AVFormatContext *formatCtx = nullptr;
-    AVCodecContext *codecCtx = nullptr;
-    const AVCodec *codec = nullptr;
-    AVFrame *frame = nullptr;
-    AVFrame *yuvFrame = nullptr;
-    SwsContext *swsCtx = nullptr;
-    int videoStreamIndex = -1;
-    bool success = false;
-
-    // Open video file
-    if (avformat_open_input(&formatCtx, videoPath.c_str(), nullptr, nullptr) < 0)
-    {
-        LOG_ERROR("RecordingManager: Could not open video file: " + videoPath);
-        return false;
+    std::lock_guard<std::mutex> lock(m_statusMutex);
+    return m_currentFileSize;
+}
+
+std::string RecordingManager::getCurrentFilename()
+{
+    std::lock_guard<std::mutex> lock(m_statusMutex);
+    return m_currentFilename;
+}
+
+void RecordingManager::finalizeCurrentRecording()
+{
+    finalizeRecording(m_currentMetadata);
+}
+
+void RecordingManager::finalizeRecording(RecordingMetadata metadata)
+{
+    // Listed right away; the thumbnail is decoded on m_thumbnailer and
+    // lands in the entry when ready (the API 404s it until then).
+    const bool exists = fs::exists(metadata.filepath);
+    m_catalog.put(metadata);
+
+    if (exists)
+    {
+        m_thumbnailer.enqueue(metadata.id, metadata.filepath, thumbnailPathFor(metadata.filepath), "");
     }
+}
 
-    // Find stream info
-    if (avformat_find_stream_info(formatCtx, nullptr) < 0)
+void RecordingManager::queueThumbnailBackfill()
+{
+    // The worker does every filesystem check; here it's one catalog copy.
+    for (const RecordingMetadata &m : m_catalog.all())
     {
-        LOG_ERROR("RecordingManager: Could not find stream info");
-        avformat_close_input(&formatCtx);
-        return false;
+        const std::string thumbnailPath = m.thumbnailPath.empty() ? thumbnailPathFor(m.filepath) : m.thumbnailPath;
+        m_thumbnailer.enqueue(m.id, m.filepath, thumbnailPath, m.thumbnailKey);
     }
+}
 
-    // Find video stream
-    for (unsigned int i = 0; i < formatCtx->nb_streams; i++)
+void RecordingManager::onThumbnailsReady(const std::vector<RecordingThumbnailer::Result> &results)
+{
+    for (const RecordingThumbnailer::Result &result : results)
     {
-        if (formatCtx->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+        const bool found = m_catalog.update(result.recordingId, [&result](RecordingMetadata &m)
+                                            {
+                                                m.thumbnailPath = result.thumbnailPath;
+                                                m.thumbnailKey = result.key;
+                                            });
+        if (!found)
         {
-            videoStreamIndex = i;
-            break;
+            // Deleted while its thumbnail was being made.
+            try
+            {
+                fs::remove(result.thumbnailPath);
+            }
+            catch (...)
+            {
+            }
         }
     }
+}
 
-    if (videoStreamIndex == -1)
+void RecordingManager::rescanThread()
+{
+    std::unique_lock<std::mutex> lock(m_rescanMutex);
+    while (!m_rescanStop)
     {
-        LOG_ERROR("RecordingManager: No video stream found");
-        avformat_close_input(&formatCtx);
-        return false;
+        lock.unlock();
+        try
+        {
+            rescanRecordings();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_WARN("RecordingManager: Recordings rescan failed: " + std::string(e.what()));
+        }
+        lock.lock();
+        m_rescanCv.wait_for(lock, std::chrono::seconds(kRescanIntervalSec), [this]
+                            { return m_rescanStop; });
     }
+}
 
-    // Get codec parameters
-    AVCodecParameters *codecpar = formatCtx->streams[videoStreamIndex]->codecpar;
-
-    // Find decoder
-    codec = avcodec_find_decoder(codecpar->codec_id);
-    if (!codec)
+void RecordingManager::stopRescan()
+{
     {
-        LOG_ERROR("RecordingManager: Codec not found");
-        avformat_close_input(&formatCtx);
-        return false;
+        std::lock_guard<std::mutex> lock(m_rescanMutex);
+        m_rescanStop = true;
     }
-
-    // Allocate codec context
-    codecCtx = avcodec_alloc_context3(codec);
-    if (!codecCtx)
+    m_rescanCv.notify_all();
+    if (m_rescanThread.joinable())
     {
-        LOG_ERROR("RecordingManager: Could not allocate codec context");
-        avformat_close_input(&formatCtx);
-        return false;
+        m_rescanThread.join();
     }
+}
 
-    // Copy codec parameters to context
-    if (avcodec_parameters_to_context(codecCtx, codecpar) < 0)
+void RecordingManager::rescanRecordings()
+{
+    // Folders to look at: every folder a catalogued file lives in, plus
+    // the default recordings folder.
+    const std::vector<std::pair<std::string, std::string>> known = m_catalog.paths();
+    std::set<std::string> knownPaths;
+    std::set<std::string> dirs;
+    for (const auto &entry : known)
     {
-        LOG_ERROR("RecordingManager: Could not copy codec parameters");
-        avcodec_free_context(&codecCtx);
-        avformat_close_input(&formatCtx);
-        return false;
+        knownPaths.insert(entry.second);
+        dirs.insert(fs::path(entry.second).parent_path().string());
     }
-
-    // Open codec
-    if (avcodec_open2(codecCtx, codec, nullptr) < 0)
+    const std::string defaultDir = Paths::getDefaultRecordingsDir();
+    if (!defaultDir.empty())
     {
-        LOG_ERROR("RecordingManager: Could not open codec");
-        avcodec_free_context(&codecCtx);
-        avformat_close_input(&formatCtx);
-        return false;
+        dirs.insert(fs::absolute(fs::path(defaultDir)).string());
     }
 
-    // Allocate frame
-    frame = av_frame_alloc();
-    if (!frame)
+    // Gone from disk. A missing folder is more likely an unplugged drive
+    // than a deletion, so those entries stay.
+    for (const auto &entry : known)
     {
-        LOG_ERROR("RecordingManager: Could not allocate frame");
-        avcodec_free_context(&codecCtx);
-        avformat_close_input(&formatCtx);
-        return false;
+        const fs::path path(entry.second);
+        if (fs::exists(path) || !fs::exists(path.parent_path()))
+        {
+            continue;
+        }
+        RecordingMetadata metadata;
+        if (m_catalog.get(entry.first, metadata) && m_catalog.remove(entry.first))
+        {
+            LOG_INFO("RecordingManager: Recording removed outside the app: " + entry.second);
+            if (!metadata.thumbnailPath.empty())
+            {
+                try
+                {
+                    fs::remove(metadata.thumbnailPath);
+                }
+                catch (...)
+                {
+                }
+            }
+        }
     }
 
-    // Read first frame
-    AVPacket *packet = av_packet_alloc();
-    if (!packet)
+    // New on disk: video files nobody catalogued. Skip what is still
+    // being written (the active recording, anything touched in the last
+    // few seconds — replay saves, segments).
+    std::string active;
     {
-        LOG_ERROR("RecordingManager: Could not allocate packet");
-        avcodec_free_context(&codecCtx);
-        avformat_close_input(&formatCtx);
-        av_frame_free(&frame);
-        return false;
+        std::lock_guard<std::mutex> lock(m_statusMutex);
+        if (!m_currentFilename.empty())
+        {
+            active = fs::absolute(fs::path(m_currentFilename)).string();
+        }
     }
-
-    // Seek to beginning
-    av_seek_frame(formatCtx, videoStreamIndex, 0, AVSEEK_FLAG_FRAME);
-
-    // Read until we get a video frame
-    while (av_read_frame(formatCtx, packet) >= 0)
+    const std::time_t now = std::time(nullptr);
+    for (const std::string &dir : dirs)
     {
-        if (packet->stream_index == videoStreamIndex)
+        if (dir.empty() || !fs::exists(dir) || !fs::is_directory(dir))
+        {
+            continue;
+        }
+        fs::directory_iterator it(dir);
+        fs::directory_iterator end;
+        for (; it != end; ++it)
         {
-            // Send packet to decoder
-            if (avcodec_send_packet(codecCtx, packet) >= 0)
+            if (!fs_helper::is_regular_file(it))
             {
-                // Receive frame from decoder
-                if (avcodec_receive_frame(codecCtx, frame) >= 0)
-                {
-                    int width = codecCtx->width;
-                    int height = codecCtx->height;
-
-                    // Use MJPEG encoder to save as JPEG
-                    const AVCodec *jpegCodec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
-                    if (jpegCodec)
-                    {
-                        AVCodecContext *jpegCtx = avcodec_alloc_context3(jpegCodec);
-                        if (jpegCtx)
-                        {
-                            jpegCtx->width = width;
-                            jpegCtx->height = height;
-                            jpegCtx->pix_fmt = AV_PIX_FMT_YUVJ420P;
-                            jpegCtx->time_base = {1, 25};
-
-                            if (avcodec_open2(jpegCtx, jpegCodec, nullptr) >= 0)
-                            {
-                                // Allocate YUV frame
-                                yuvFrame = av_frame_alloc();
-                                if (yuvFrame)
-                                {
-                                    yuvFrame->format = AV_PIX_FMT_YUVJ420P;
-                                    yuvFrame->width = width;
-                                    yuvFrame->height = height;
-                                    if (av_frame_get_buffer(yuvFrame, 32) >= 0)
-                                    {
-                                        // Convert decoded frame to YUVJ420P
-                                        swsCtx = sws_getContext(
-                                            width, height, codecCtx->pix_fmt,
-                                            width, height, AV_PIX_FMT_YUVJ420P,
-                                            SWS_BILINEAR, nullptr, nullptr, nullptr);
-
-                                        if (swsCtx)
-                                        {
-                                            sws_scale(swsCtx, frame->data, frame->linesize,
-                                                      0, height, yuvFrame->data, yuvFrame->linesize);
-
-                                            yuvFrame->pts = 0;
-
-                                            // Encode frame
-                                            if (avcodec_send_frame(jpegCtx, yuvFrame) >= 0)
-                                            {
-                                                AVPacket *jpegPacket = av_packet_alloc();
-                                                if (jpegPacket)
-                                                {
-                                                    if (avcodec_receive_packet(jpegCtx, jpegPacket) >= 0)
-                                                    {
-                                                        // Write to file
-                                                        std::ofstream outFile(thumbnailPath, std::ios::binary);
-                                                        if (outFile.is_open())
-                                                        {
-                                                            outFile.write(reinterpret_cast<const char *>(jpegPacket->data), jpegPacket->size);
-                                                            outFile.close();
-                                                            success = true;
-                                                        }
-                                                    }
-                                                    av_packet_free(&jpegPacket);
-                                                }
-                                            }
-                                            sws_freeContext(swsCtx);
-                                        }
-                                    }
-                                    av_frame_free(&yuvFrame);
-                                }
-                            }
-                            avcodec_free_context(&jpegCtx);
-                        }
-                    }
+                continue;
+            }
+            const fs::path p = fs_helper::get_path(it);
+            std::string ext = fs_helper::get_extension_string(p);
+            std::transform(ext.begin(), ext.end(), ext.begin(),
+                           [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            if (ext != ".mp4" && ext != ".mkv" && ext != ".avi" && ext != ".mov" && ext != ".webm")
+            {
+                continue;
+            }
+            const std::string filepath = fs::absolute(p).string();
+            if (knownPaths.count(filepath) || filepath == active || m_catalog.containsPath(filepath))
+            {
+                continue;
+            }
+            struct stat st{};
+            if (::stat(filepath.c_str(), &st) != 0 || now - st.st_mtime < 10)
+            {
+                continue;
+            }
 
-                    break; // Got frame, exit loop
-                }
+            RecordingMetadata metadata;
+            metadata.filename = fs_helper::get_filename_string(p);
+            metadata.filepath = filepath;
+            metadata.container = ext.substr(1);
+            metadata.fileSize = static_cast<uint64_t>(st.st_size);
+            {
+                std::stringstream ss;
+                ss << metadata.filepath << "_" << st.st_mtime;
+                metadata.id = std::to_string(std::hash<std::string>{}(ss.str()));
             }
+            std::time_t mtime = st.st_mtime;
+            std::tm *tm = std::gmtime(&mtime);
+            std::stringstream timeStr;
+            timeStr << std::put_time(tm, "%Y-%m-%dT%H:%M:%SZ");
+            metadata.createdAt = timeStr.str();
+            if (!probeRecording(filepath, metadata))
+            {
+                continue; // not a playable video (yet)
+            }
+
+            m_catalog.put(metadata);
+            m_thumbnailer.enqueue(metadata.id, metadata.filepath, thumbnailPathFor(metadata.filepath), "");
+            LOG_INFO("RecordingManager: Recording found on disk: " + filepath);
         }
-        av_packet_unref(packet);
     }
+}
 
-    // Cleanup
-    av_packet_free(&packet);
-    av_frame_free(&frame);
-    avcodec_free_context(&codecCtx);
+bool RecordingManager::probeRecording(const std::string &filepath, RecordingMetadata &metadata)
+{
+    // Container headers only — codec, size and duration for the list.
+    AVFormatContext *formatCtx = nullptr;
+    if (avformat_open_input(&formatCtx, filepath.c_str(), nullptr, nullptr) < 0)
+    {
+        return false;
+    }
+    const int videoIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (videoIndex < 0)
+    {
+        avformat_close_input(&formatCtx);
+        return false;
+    }
+    const AVStream *video = formatCtx->streams[videoIndex];
+    metadata.videoCodec = avcodec_get_name(video->codecpar->codec_id);
+    metadata.width = static_cast<uint32_t>(std::max(0, video->codecpar->width));
+    metadata.height = static_cast<uint32_t>(std::max(0, video->codecpar->height));
+    if (video->avg_frame_rate.den > 0 && video->avg_frame_rate.num > 0)
+    {
+        metadata.fps = static_cast<uint32_t>((video->avg_frame_rate.num + video->avg_frame_rate.den / 2) /
+                                             video->avg_frame_rate.den);
+    }
+    const int audioIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (audioIndex >= 0)
+    {
+        metadata.audioCodec = avcodec_get_name(formatCtx->streams[audioIndex]->codecpar->codec_id);
+    }
+    if (formatCtx->duration != AV_NOPTS_VALUE && formatCtx->duration > 0)
+    {
+        metadata.durationUs = static_cast<uint64_t>(formatCtx->duration);
+    }
     avformat_close_input(&formatCtx);
-
-    return success;
+    return true;
 }
 
 std::vector<RecordingMetadata> RecordingManager::listRecordings()
 {
-    std::lock_guard<std::mutex> lock(m_recordingsMutex);
-    return m_recordings;
+    return m_catalog.all();
 }
 
-bool RecordingManager::deleteRecording(const std::string &recordingId)
+RecordingPage RecordingManager::queryRecordings(const RecordingQuery &query)
 {
-    std::lock_guard<std::mutex> lock(m_recordingsMutex);
+    return m_catalog.query(query);
+}
 
-    auto it = std::find_if(m_recordings.begin(), m_recordings.end(),
-                           [&recordingId](const RecordingMetadata &m)
-                           { return m.id == recordingId; });
+bool RecordingManager::getRecording(const std::string &recordingId, RecordingMetadata &out)
+{
+    return m_catalog.get(recordingId, out);
+}
 
-    if (it == m_recordings.end())
+bool RecordingManager::deleteRecording(const std::string &recordingId)
+{
+    RecordingMetadata metadata;
+    if (!m_catalog.get(recordingId, metadata))
     {
         LOG_INFO("RecordingManager: Recording not found: " + recordingId);
         return false;
     }
 
-    std::string filepath = it->filepath; // Copiar antes de remover da lista
-    std::string thumbnailPath = it->thumbnailPath; // Copiar caminho do thumbnail
+    const std::string &filepath = metadata.filepath;
+    const std::string &thumbnailPath = metadata.thumbnailPath;
 
-    // Delete video file (if it exists) - fazer ANTES de remover da lista para evitar problemas
+    // Delete video file (if it exists)
     // If file doesn't exist, just log and continue - we'll remove the record anyway
     try
     {
@@ -1097,62 +2011,16 @@ bool RecordingManager::deleteRecording(const std::string &recordingId)
     }
 
     // Remove from list (always, even if file deletion failed or file doesn't exist)
-    m_recordings.erase(it);
-
-    // Save metadata - fazer sem lock adicional (já temos o lock)
-    try
-    {
-        // Ensure directory exists
-        fs::path metadataPath(m_metadataPath);
-        fs::path dir = metadataPath.parent_path();
-        if (!dir.empty() && !fs::exists(dir))
-        {
-            fs::create_directories(dir);
-        }
-
-        nlohmann::json json;
-        json["recordings"] = nlohmann::json::array();
-        for (const auto &recording : m_recordings)
-        {
-            json["recordings"].push_back(recording.toJSON());
-        }
-
-        std::ofstream file(m_metadataPath);
-        if (!file.is_open())
-        {
-            LOG_ERROR("RecordingManager: Failed to open metadata file for writing: " + m_metadataPath);
-            return false;
-        }
-
-        file << json.dump(2);
-        file.close();
-
-        LOG_INFO("RecordingManager: Metadata saved successfully");
-        return true;
-    }
-    catch (const std::exception &e)
-    {
-        LOG_ERROR("RecordingManager: Exception saving metadata: " + std::string(e.what()));
-        return false;
-    }
-    catch (...)
-    {
-        LOG_ERROR("RecordingManager: Unknown exception saving metadata");
-        return false;
-    }
+    m_catalog.remove(recordingId);
+    return true;
 }
 
 std::string RecordingManager::getRecordingPath(const std::string &recordingId)
 {
-    std::lock_guard<std::mutex> lock(m_recordingsMutex);
-
-    auto it = std::find_if(m_recordings.begin(), m_recordings.end(),
-                           [&recordingId](const RecordingMetadata &m)
-                           { return m.id == recordingId; });
-
-    if (it != m_recordings.end())
+    RecordingMetadata metadata;
+    if (m_catalog.get(recordingId, metadata))
     {
-        return it->filepath;
+        return metadata.filepath;
     }
 
     return "";
@@ -1160,19 +2028,14 @@ std::string RecordingManager::getRecordingPath(const std::string &recordingId)
 
 bool RecordingManager::renameRecording(const std::string &recordingId, const std::string &newName)
 {
-    std::lock_guard<std::mutex> lock(m_recordingsMutex);
-
-    auto it = std::find_if(m_recordings.begin(), m_recordings.end(),
-                           [&recordingId](const RecordingMetadata &m)
-                           { return m.id == recordingId; });
-
-    if (it == m_recordings.end())
+    RecordingMetadata metadata;
+    if (!m_catalog.get(recordingId, metadata))
     {
         return false;
     }
 
     // Get old file path
-    std::string oldPath = it->filepath;
+    std::string oldPath = metadata.filepath;
     fs::path oldFilePath(oldPath);
 
     // Create new file path with new name
@@ -1199,11 +2062,13 @@ bool RecordingManager::renameRecording(const std::string &recordingId, const std
     }
 
     // Update metadata
-    it->filename = fs_helper::get_filename_string(newFilePath);
-    it->filepath = fs::absolute(newFilePath).string();
-
-    // Save metadata
-    return saveRecordingsMetadata();
+    const std::string filename = fs_helper::get_filename_string(newFilePath);
+    const std::string filepath = fs::absolute(newFilePath).string();
+    return m_catalog.update(recordingId, [&](RecordingMetadata &m)
+                            {
+                                m.filename = filename;
+                                m.filepath = filepath;
+                            });
 }
 
 void RecordingManager::setAudioFormat(uint32_t sampleRate, uint32_t channels)
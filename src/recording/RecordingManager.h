@@ -3,12 +3,19 @@
 #include "RecordingSettings.h"
 #include "RecordingMetadata.h"
 #include "FileRecorder.h"
+#include "ReplayBuffer.h"
+#include "RecordingThumbnailer.h"
+#include "RecordingCatalog.h"
 #include "../encoding/MediaEncoder.h"
 #include "../encoding/MediaSynchronizer.h"
+#include "../encoding/EncodedPacketBus.h"
+#include <deque>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <vector>
+#include <map>
 #include <memory>
 #include <cstdint>
 #include <string>
@@ -35,6 +42,29 @@ public:
     bool startRecording(const RecordingSettings& settings);
     void stopRecording();
     bool isRecording() const { return m_recording; }
+    // Encoder running (recording and/or replay buffer) — frames and audio
+    // should be pushed while this is true.
+    bool isEncoding() const { return m_running; }
+
+    /**
+     * Instant replay: keep the last RecordingSettings::replayBufferSeconds
+     * of encoded output in memory (ReplayBuffer) and write it to a file on
+     * saveReplay(). Shares the encoder with startRecording() — either can
+     * start first; a file started while the buffer runs joins the encode
+     * at the next keyframe with the buffer's codec settings.
+     */
+    bool startReplayBuffer(const RecordingSettings& settings);
+    void stopReplayBuffer();
+    bool isReplayBufferActive() const { return m_replayActive; }
+    // seconds = 0 saves the whole buffer. Returns at once; the file is
+    // muxed off the capture thread and lands in the recordings list.
+    // false if the buffer is off or the previous save is still running.
+    // outputPath (optional) receives the file that will be written.
+    bool saveReplay(uint32_t seconds = 0, std::string *outputPath = nullptr);
+    bool isSavingReplay() const { return m_replaySaving; }
+    uint64_t getReplayBufferDurationUs() const;
+    uint64_t getReplayBufferBytes() const;
+    std::string getLastReplayPath();
 
     // Configuration
     void setRecordingSettings(const RecordingSettings& settings) { m_settings = settings; }
@@ -70,14 +100,25 @@ public:
     std::string getCurrentFilename();
 
     // Frame/Audio input (called by Application)
-    void pushFrame(const uint8_t* data, uint32_t width, uint32_t height);
+    void pushFrame(const uint8_t* data, uint32_t width, uint32_t height,
+                   VideoFrameFormat format = VideoFrameFormat::RGB24);
     void pushAudio(const int16_t* samples, size_t sampleCount);
     
     // Set audio format (called by Application)
     void setAudioFormat(uint32_t sampleRate, uint32_t channels);
 
-    // Recording list
+    // Shared encode (see EncodedPacketBus). Application points this at the
+    // /stream encoder's bus before startRecording() when both outputs
+    // carry the same frames; startRecording() subscribes if the codec
+    // settings match and encodes privately otherwise. nullptr disables.
+    void setSharedEncodeSource(EncodedPacketBus *bus) { m_sharedEncodeSource = bus; }
+    bool isUsingSharedEncode() const { return m_usingSharedEncode.load(); }
+
+    // Recording list (RecordingCatalog). listRecordings() copies every
+    // entry; the API pages through queryRecordings() instead.
     std::vector<RecordingMetadata> listRecordings();
+    RecordingPage queryRecordings(const RecordingQuery& query);
+    bool getRecording(const std::string& recordingId, RecordingMetadata& out);
     bool deleteRecording(const std::string& recordingId);
     bool renameRecording(const std::string& recordingId, const std::string& newName);
     std::string getRecordingPath(const std::string& recordingId);
@@ -89,24 +130,169 @@ private:
     // Generate output filename from template
     std::string generateFilename(const RecordingSettings& settings);
 
+    // Encode session (encoder or shared subscription + encoding thread),
+    // shared by the file output and the replay buffer. Callers hold
+    // m_controlMutex.
+    bool startSession(const RecordingSettings& settings);
+    void launchEncodingThread();
+    void drainSession();   // stop the thread, flush the encoder into the outputs
+    void teardownSession();
+    // File output on top of a session; midSession = encoder already running.
+    bool attachFile(const RecordingSettings& settings, bool midSession);
+    void detachFile();
+    RecordingMetadata describeFile(const std::string& outputPath, const std::string& container) const;
+    std::map<std::string, std::string> containerMetadata(const std::string& title,
+                                                         const std::string& summary) const;
+    // Codec contexts new muxers are opened from: the private/fallback
+    // encoder's, else our copies of the shared encoder's parameters.
+    void *currentVideoContext() const;
+    void *currentAudioContext() const;
+    void loadRebaseTimeBases();
+
     // Get timestamp in microseconds
     int64_t getTimestampUs() const;
 
-    // Load recordings metadata from JSON
-    bool loadRecordingsMetadata();
-    
-    // Save recordings metadata to JSON
-    bool saveRecordingsMetadata();
-
     // Add current recording to metadata
     void finalizeCurrentRecording();
-    
-    // Generate thumbnail from video file (extract first frame)
-    bool generateThumbnail(const std::string& videoPath, const std::string& thumbnailPath);
+    // Catalog entry for a finished file (segment or whole recording); the
+    // thumbnail follows from m_thumbnailer.
+    void finalizeRecording(RecordingMetadata metadata);
+
+    // Thumbnails: queue every catalog entry at startup (cheap when nothing
+    // changed) and apply finished batches to the catalog.
+    void queueThumbnailBackfill();
+    void onThumbnailsReady(const std::vector<RecordingThumbnailer::Result>& results);
+
+    // Files added to / deleted from the recordings folders outside the
+    // app: checked at startup and every kRescanIntervalSec.
+    void rescanThread();
+    void rescanRecordings();
+    bool probeRecording(const std::string& filepath, RecordingMetadata& metadata);
+    void stopRescan();
+
+    // Shared encode helpers
+    bool subscribeSharedEncode(const MediaEncoder::VideoConfig &videoConfig,
+                               const MediaEncoder::AudioConfig &audioConfig,
+                               EncodedPacketBus::SourceInfo &info);
+    void releaseSharedEncode();
+    bool drainSharedPackets();
+    bool startFallbackEncoder();
+    // Every packet bound for the file goes through here: applies the
+    // shared-encode timestamp rebase (no-op for private encodes).
+    bool muxEncodedPacket(const MediaEncoder::EncodedPacket &packet);
+    // Rebase + mux into the open file. m_fileOutputMutex held.
+    bool muxToFileLocked(const MediaEncoder::EncodedPacket &packet);
+    // Unblock the encoding thread's waits (stop / shared source lost).
+    void wakeEncodingThread();
+
+    // Segmented recording (RecordingSettings::segmentRecording). Checked
+    // per packet from muxEncodedPacket; cuts at the first video keyframe
+    // once a limit is reached. The encoders interleave their output, so
+    // audio stamped before the cut can still arrive after that keyframe:
+    // the keyframe and the video behind it are held until audio reaches
+    // the cut, and that audio goes to the outgoing file. Encoding thread only.
+    bool segmentLimitReached(const MediaEncoder::EncodedPacket &packet, int64_t ts);
+    bool rotateSegment(int64_t keyframeTs);
+    // Rotate at the pending cut and mux the held video into the new file.
+    bool completeSegmentCut();
+    // Finished segments are finalized off the encoding thread.
+    void segmentFinalizerThread();
+    void stopSegmentFinalizer();
+
+    // Replay save: the muxer is opened on the encoding thread (it owns the
+    // codec contexts), the packets are written on m_replayWriter.
+    struct ReplayJob
+    {
+        std::unique_ptr<MediaMuxer> muxer;
+        std::vector<MediaEncoder::EncodedPacket> packets;
+        RecordingMetadata metadata;
+        int videoTbNum = 0, videoTbDen = 0;
+        int audioTbNum = 0, audioTbDen = 0;
+    };
+    void beginReplaySave();
+    void writeReplay(std::unique_ptr<ReplayJob> job);
 
     FileRecorder m_recorder;
     MediaEncoder m_encoder;
     MediaSynchronizer m_synchronizer;
+
+    // Configs the session was started with — needed to bring up a private
+    // encoder if the shared one goes away mid-recording.
+    MediaEncoder::VideoConfig m_videoConfig;
+    MediaEncoder::AudioConfig m_audioConfig;
+
+    // Shared encode state. Packets arrive on the streamer's encoding
+    // thread and are queued for ours; the detach callback flags the
+    // fallback to a private encoder on the same PTS timeline.
+    EncodedPacketBus *m_sharedEncodeSource = nullptr;
+    std::atomic<uint64_t> m_sharedSubscription{0};
+    std::atomic<bool> m_usingSharedEncode{false};
+    std::atomic<bool> m_sharedSourceLost{false};
+    std::atomic<int64_t> m_sharedEpochUs{0};
+    std::mutex m_sharedMutex;
+    std::condition_variable m_sharedCv; // packet queued / source lost / stop
+    std::deque<MediaEncoder::EncodedPacket> m_sharedPackets;
+    bool m_sharedDropUntilKeyframe = false; // guarded by m_sharedMutex
+    static constexpr size_t kMaxSharedBacklog = 1024;
+
+    // The shared encoder has been running since streaming started, so its
+    // PTS don't start at zero: the file starts at the first keyframe we
+    // see and every timestamp is shifted back by that keyframe's PTS.
+    struct PacketRebase
+    {
+        bool active = false;
+        bool waitingKeyframe = false;
+        int64_t videoBase = 0; // in video codec time_base
+        int64_t audioBase = 0; // same instant in audio codec time_base
+        int videoTbNum = 0, videoTbDen = 0;
+        int audioTbNum = 0, audioTbDen = 0;
+    };
+    PacketRebase m_rebase; // touched only by the encoding thread / stop path
+
+    struct SegmentState
+    {
+        bool enabled = false;
+        uint32_t index = 0;       // 1-based index of the file being written
+        std::string basePath;     // generateFilename() output, before _partNNN
+        bool started = false;     // startTs valid
+        int64_t startTs = 0;      // first video dts of this segment, codec time_base
+        bool keyframeRequested = false;
+        bool cutPending = false;    // cut keyframe seen, waiting for audio to reach it
+        int64_t cutTs = 0;          // its dts, video codec time_base
+        int64_t cutAudioTs = 0;     // same instant, audio codec time_base
+        std::vector<MediaEncoder::EncodedPacket> heldVideo; // cut keyframe onwards
+        uint64_t maxDurationUs = 0; // limits the file was started with
+        uint64_t maxFileSize = 0;
+        std::map<std::string, std::string> containerMetadata;
+    };
+    SegmentState m_segment; // touched only by the encoding thread / start-stop paths
+
+    // Owned copies of the shared encoder's codec parameters (AVCodecContext*).
+    // The bus only guarantees its own contexts until detach; segments and
+    // replays open muxers long after that.
+    void *m_sharedVideoCtx = nullptr;
+    void *m_sharedAudioCtx = nullptr;
+
+    // Guards m_recorder / m_segment / m_currentMetadata between the
+    // encoding thread and attachFile()/detachFile() while a session runs.
+    std::mutex m_fileOutputMutex;
+    // Serializes start/stop of recording and replay buffer.
+    std::mutex m_controlMutex;
+
+    ReplayBuffer m_replayBuffer;
+    std::atomic<bool> m_replayActive{false};
+    std::atomic<bool> m_replaySaveRequested{false};
+    std::atomic<uint32_t> m_replaySaveSeconds{0};
+    std::atomic<bool> m_replaySaving{false}; // save requested or being written
+    std::thread m_replayWriter;              // started/joined by the encoding thread or with it stopped
+    std::string m_lastReplayPath;            // guarded by m_statusMutex
+    std::string m_replaySavePath;            // file of the pending save; guarded by m_statusMutex
+
+    std::thread m_segmentFinalizer;
+    std::mutex m_segmentFinalizeMutex;
+    std::condition_variable m_segmentFinalizeCv;
+    std::deque<RecordingMetadata> m_segmentFinalizeQueue;
+    bool m_segmentFinalizerStop = false; // guarded by m_segmentFinalizeMutex
     
     RecordingSettings m_settings;
     Context           m_context;
@@ -124,9 +310,14 @@ private:
     uint64_t m_currentDurationUs = 0;
     
     // Recordings metadata
-    std::vector<RecordingMetadata> m_recordings;
-    std::mutex m_recordingsMutex;
+    RecordingCatalog m_catalog;
     std::string m_metadataPath;
+
+    static constexpr int kRescanIntervalSec = 60;
+    std::thread m_rescanThread;
+    std::mutex m_rescanMutex;
+    std::condition_variable m_rescanCv;
+    bool m_rescanStop = false; // guarded by m_rescanMutex
     
     // Audio format (from Application)
     uint32_t m_audioSampleRate = 44100;
@@ -138,4 +329,8 @@ private:
     uint64_t m_audioSampleCount = 0;         // Contador de samples desde o início
     
     bool m_initialized = false;
+
+    // Last member: destroyed first, so its worker (which calls back into
+    // m_catalog) is joined while everything else still exists.
+    RecordingThumbnailer m_thumbnailer;
 };
@@ -22,6 +22,23 @@ nlohmann::json RecordingMetadata::toJSON() const
     {
         j["thumbnailPath"] = thumbnailPath;
     }
+    if (!thumbnailKey.empty())
+    {
+        j["thumbnailKey"] = thumbnailKey;
+    }
+    if (!shaderName.empty())
+    {
+        j["shaderName"] = shaderName;
+    }
+    if (!sourceType.empty())
+    {
+        j["sourceType"] = sourceType;
+    }
+    if (segmentIndex > 0)
+    {
+        j["sessionId"] = sessionId;
+        j["segmentIndex"] = segmentIndex;
+    }
     return j;
 }
 
@@ -55,6 +72,16 @@ RecordingMetadata RecordingMetadata::fromJSON(const nlohmann::json& json)
         metadata.createdAt = json["createdAt"].get<std::string>();
     if (json.contains("thumbnailPath"))
         metadata.thumbnailPath = json["thumbnailPath"].get<std::string>();
+    if (json.contains("thumbnailKey"))
+        metadata.thumbnailKey = json["thumbnailKey"].get<std::string>();
+    if (json.contains("shaderName"))
+        metadata.shaderName = json["shaderName"].get<std::string>();
+    if (json.contains("sourceType"))
+        metadata.sourceType = json["sourceType"].get<std::string>();
+    if (json.contains("sessionId"))
+        metadata.sessionId = json["sessionId"].get<std::string>();
+    if (json.contains("segmentIndex"))
+        metadata.segmentIndex = json["segmentIndex"].get<uint32_t>();
     
     return metadata;
 }
@@ -31,6 +31,17 @@ struct RecordingMetadata
 
     // Thumbnail (optional)
     std::string thumbnailPath;   // Thumbnail path
+    std::string thumbnailKey;    // Video size/mtime/hash the thumbnail was made from
+
+    // What was recorded (RecordingManager::Context at start); filterable
+    // in GET /api/v1/recordings. Empty for files found by the rescan.
+    std::string shaderName;
+    std::string sourceType;
+
+    // Segmented recordings: every part is its own entry; sessionId groups
+    // them and segmentIndex (1-based) orders them. 0 = not segmented.
+    std::string sessionId;
+    uint32_t segmentIndex = 0;
 
     // JSON serialization
     nlohmann::json toJSON() const;
@@ -122,6 +122,7 @@ bool RecordingProfileManager::save(const std::string &name, const RecordingSetti
     j["limits"] = {
         {"maxDurationUs", s.maxDurationUs},
         {"maxFileSize", s.maxFileSize},
+        {"segment", s.segmentRecording},
     };
     j["options"] = {
         {"autoStart", s.autoStart},
@@ -201,6 +202,7 @@ bool RecordingProfileManager::load(const std::string &name, RecordingSettings &s
             const auto &l = j["limits"];
             if (l.contains("maxDurationUs")) s.maxDurationUs = l["maxDurationUs"].get<uint64_t>();
             if (l.contains("maxFileSize")) s.maxFileSize = l["maxFileSize"].get<uint64_t>();
+            if (l.contains("segment")) s.segmentRecording = l["segment"].get<bool>();
         }
         if (j.contains("options"))
         {
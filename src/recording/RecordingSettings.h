@@ -34,6 +34,24 @@ struct RecordingSettings
     bool autoStart = false;
     uint64_t maxDurationUs = 0; // 0 = no limit
     uint64_t maxFileSize = 0;   // 0 = no limit
+    // Segmented recording: instead of one growing file, cut a new
+    // <name>_partNNN file at the first keyframe after either limit above
+    // is reached (maxDurationUs alone gives fixed-length segments). The
+    // encoder keeps running across the cut. MP4/MOV segments are written
+    // fragmented so each one stays playable if the app dies mid-segment.
+    bool segmentRecording = false;
+    // Instant replay (RecordingManager::startReplayBuffer): how much of
+    // the encoded output is kept in memory for saveReplay(). Whichever
+    // cap is hit first wins; whole GOPs are dropped from the front.
+    uint32_t replayBufferSeconds = 60;
+    uint64_t replayBufferMaxBytes = 512ULL * 1024 * 1024;
+    // Reuse the /stream encoder's output instead of encoding a second
+    // time when streaming is active with identical codec settings (see
+    // EncodedPacketBus). Opt-in: that encoder runs low-latency streaming
+    // rate control, so the file gets the stream's quality rather than
+    // what the recording settings would produce on their own. Falls back
+    // to a private encoder automatically.
+    bool shareStreamEncoder = false;
 
     // Hardware encoder selection (#59) — mirrors the streaming side.
     // Same int encoding as MediaEncoder::HardwareEncoder
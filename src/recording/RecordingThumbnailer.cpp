@@ -0,0 +1,541 @@
+#include "RecordingThumbnailer.h"
+#include "../utils/Logger.h"
+#include "../utils/FilesystemCompat.h"
+#include "../utils/PixelFormatConverter.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+
+// Not all MinGW-w64 headers define the POSIX macro
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+#include "../utils/FFmpegCompat.h"
+
+namespace
+{
+constexpr size_t kSampleBytes = 64 * 1024;
+// Past this many video packets without a decodable keyframe, give up.
+constexpr int kMaxVideoPackets = 600;
+// Thumbnail instant: 10% in (the first frames are often black or a fade),
+// but never further than this into long recordings.
+constexpr int64_t kMaxTargetUs = 30LL * 1000000LL;
+
+struct ContentKey
+{
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+
+    // "<size>-<mtime>-<hash>"
+    std::string toString() const
+    {
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%llu-%lld-%016llx", static_cast<unsigned long long>(size),
+                      static_cast<long long>(mtime), static_cast<unsigned long long>(hash));
+        return buf;
+    }
+
+    // Same bytes regardless of when they were written.
+    std::string contentId() const
+    {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%llu-%016llx", static_cast<unsigned long long>(size),
+                      static_cast<unsigned long long>(hash));
+        return buf;
+    }
+
+    static bool parse(const std::string &text, ContentKey &key)
+    {
+        unsigned long long size = 0, hash = 0;
+        long long mtime = 0;
+        if (std::sscanf(text.c_str(), "%llu-%lld-%llx", &size, &mtime, &hash) != 3)
+        {
+            return false;
+        }
+        key.size = size;
+        key.mtime = mtime;
+        key.hash = hash;
+        return true;
+    }
+};
+
+bool statFile(const std::string &path, ContentKey &key)
+{
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        return false;
+    }
+    key.size = static_cast<uint64_t>(st.st_size);
+    key.mtime = static_cast<int64_t>(st.st_mtime);
+    return true;
+}
+
+bool fileExists(const std::string &path)
+{
+    struct stat st{};
+    return ::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+// FNV-1a 64 over the first and last kSampleBytes (the container header and
+// index live there, so any rewrite of the file shows up).
+bool hashSamples(const std::string &path, ContentKey &key)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+    uint64_t hash = 14695981039346656037ULL;
+    std::vector<char> buf(kSampleBytes);
+    auto mix = [&](uint64_t offset)
+    {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+        const std::streamsize got = file.gcount();
+        for (std::streamsize i = 0; i < got; ++i)
+        {
+            hash ^= static_cast<unsigned char>(buf[i]);
+            hash *= 1099511628211ULL;
+        }
+    };
+    mix(0);
+    if (key.size > kSampleBytes)
+    {
+        mix(std::max<uint64_t>(kSampleBytes, key.size - kSampleBytes));
+    }
+    key.hash = hash;
+    return true;
+}
+
+// Write-then-rename so a reader never sees a partial file.
+bool writeFileAtomic(const std::string &path, const uint8_t *data, size_t size)
+{
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            return false;
+        }
+        out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+        if (!out.good())
+        {
+            out.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    try
+    {
+        fs::rename(tmp, path);
+    }
+    catch (const std::exception &)
+    {
+        // Windows rename doesn't replace an existing file.
+        std::remove(path.c_str());
+        if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool copyFileAtomic(const std::string &from, const std::string &to)
+{
+    std::ifstream in(from, std::ios::binary);
+    if (!in.is_open())
+    {
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return !data.empty() &&
+           writeFileAtomic(to, reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+// Everything generate() allocates, freed in one place whatever path exits.
+struct DecodeState
+{
+    AVFormatContext *formatCtx = nullptr;
+    AVCodecContext *codecCtx = nullptr;
+    AVCodecContext *jpegCtx = nullptr;
+    AVPacket *packet = nullptr;
+    AVFrame *frame = nullptr;
+    AVFrame *yuvFrame = nullptr;
+    SwsContext *toRgb = nullptr;
+    SwsContext *toYuv = nullptr;
+
+    ~DecodeState()
+    {
+        sws_freeContext(toYuv);
+        sws_freeContext(toRgb);
+        av_frame_free(&yuvFrame);
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        avcodec_free_context(&jpegCtx);
+        avcodec_free_context(&codecCtx);
+        avformat_close_input(&formatCtx);
+    }
+};
+
+// Decode the first frame at or after the current read position; with
+// skip_frame = NONKEY that is the keyframe the seek landed on.
+bool decodeOneFrame(DecodeState &s, int streamIndex)
+{
+    int videoPackets = 0;
+    while (av_read_frame(s.formatCtx, s.packet) >= 0)
+    {
+        if (s.packet->stream_index != streamIndex)
+        {
+            av_packet_unref(s.packet);
+            continue;
+        }
+        const int sent = avcodec_send_packet(s.codecCtx, s.packet);
+        av_packet_unref(s.packet);
+        if (sent < 0 && sent != AVERROR(EAGAIN))
+        {
+            continue; // damaged packet — try the next one
+        }
+        if (avcodec_receive_frame(s.codecCtx, s.frame) >= 0)
+        {
+            return true;
+        }
+        if (++videoPackets >= kMaxVideoPackets)
+        {
+            return false;
+        }
+    }
+    // EOF: decoders with delay may still hold the frame.
+    avcodec_send_packet(s.codecCtx, nullptr);
+    return avcodec_receive_frame(s.codecCtx, s.frame) >= 0;
+}
+} // namespace
+
+RecordingThumbnailer::~RecordingThumbnailer()
+{
+    stop();
+}
+
+void RecordingThumbnailer::start(ResultCallback onResults)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running)
+    {
+        return;
+    }
+    m_onResults = std::move(onResults);
+    m_running = true;
+    m_worker = std::thread(&RecordingThumbnailer::workerThread, this);
+}
+
+void RecordingThumbnailer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+        {
+            return;
+        }
+        m_running = false;
+        m_queue.clear();
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable())
+    {
+        m_worker.join();
+    }
+}
+
+void RecordingThumbnailer::enqueue(const std::string &recordingId, const std::string &videoPath,
+                                   const std::string &thumbnailPath, const std::string &knownKey)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running)
+        {
+            return;
+        }
+        m_queue.push_back(Job{recordingId, videoPath, thumbnailPath, knownKey});
+    }
+    m_cv.notify_one();
+}
+
+void RecordingThumbnailer::workerThread()
+{
+    std::vector<Result> batch;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        if (m_queue.empty() && !batch.empty())
+        {
+            lock.unlock();
+            m_onResults(batch);
+            batch.clear();
+            lock.lock();
+            continue; // re-check: jobs may have arrived meanwhile
+        }
+        m_cv.wait(lock, [this]
+                  { return !m_running || !m_queue.empty(); });
+        if (!m_running)
+        {
+            break;
+        }
+        Job job = std::move(m_queue.front());
+        m_queue.pop_front();
+        lock.unlock();
+
+        Result result;
+        if (process(job, result))
+        {
+            batch.push_back(std::move(result));
+            if (batch.size() >= kBatchSize)
+            {
+                m_onResults(batch);
+                batch.clear();
+            }
+        }
+        lock.lock();
+    }
+    lock.unlock();
+    if (!batch.empty())
+    {
+        m_onResults(batch);
+    }
+}
+
+bool RecordingThumbnailer::process(const Job &job, Result &result)
+{
+    ContentKey key;
+    if (!statFile(job.videoPath, key))
+    {
+        return false; // video gone (deleted/moved meanwhile)
+    }
+    const bool haveThumbnail = fileExists(job.thumbnailPath);
+
+    // Fast path, no reads: same size/mtime as when the thumbnail was made.
+    ContentKey known;
+    if (haveThumbnail && ContentKey::parse(job.knownKey, known) && known.size == key.size &&
+        known.mtime == key.mtime)
+    {
+        m_generated[known.contentId()] = job.thumbnailPath;
+        return false; // catalog already up to date
+    }
+
+    if (!hashSamples(job.videoPath, key))
+    {
+        return false;
+    }
+    result.recordingId = job.recordingId;
+    result.thumbnailPath = job.thumbnailPath;
+    result.key = key.toString();
+
+    // Thumbnails from before keys existed are kept as they are.
+    if (haveThumbnail && job.knownKey.empty())
+    {
+        m_generated[key.contentId()] = job.thumbnailPath;
+        return true;
+    }
+
+    auto cached = m_generated.find(key.contentId());
+    if (cached != m_generated.end() && cached->second != job.thumbnailPath && fileExists(cached->second) &&
+        copyFileAtomic(cached->second, job.thumbnailPath))
+    {
+        return true;
+    }
+
+    if (!generate(job.videoPath, job.thumbnailPath))
+    {
+        LOG_WARN("RecordingThumbnailer: Failed to generate thumbnail for: " + job.videoPath);
+        return false;
+    }
+    m_generated[key.contentId()] = job.thumbnailPath;
+    return true;
+}
+
+bool RecordingThumbnailer::generate(const std::string &videoPath, const std::string &thumbnailPath)
+{
+    DecodeState s;
+
+    if (avformat_open_input(&s.formatCtx, videoPath.c_str(), nullptr, nullptr) < 0)
+    {
+        LOG_ERROR("RecordingThumbnailer: Could not open video file: " + videoPath);
+        return false;
+    }
+
+    // MP4/MKV headers already carry codec and dimensions; probing packets
+    // (find_stream_info) is only needed for headerless formats like TS.
+    int streamIndex = av_find_best_stream(s.formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (streamIndex < 0 || s.formatCtx->streams[streamIndex]->codecpar->width <= 0)
+    {
+        s.formatCtx->probesize = 1 << 20;
+        s.formatCtx->max_analyze_duration = AV_TIME_BASE / 2;
+        if (avformat_find_stream_info(s.formatCtx, nullptr) < 0)
+        {
+            LOG_ERROR("RecordingThumbnailer: Could not find stream info: " + videoPath);
+            return false;
+        }
+        streamIndex = av_find_best_stream(s.formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    }
+    if (streamIndex < 0)
+    {
+        LOG_ERROR("RecordingThumbnailer: No video stream in: " + videoPath);
+        return false;
+    }
+    AVStream *stream = s.formatCtx->streams[streamIndex];
+
+    const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    s.codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!s.codecCtx || avcodec_parameters_to_context(s.codecCtx, stream->codecpar) < 0)
+    {
+        LOG_ERROR("RecordingThumbnailer: Decoder unavailable for: " + videoPath);
+        return false;
+    }
+
+    // One keyframe is all we decode: skip everything else, skip the loop
+    // filter (invisible after the downscale), and use slice threads only —
+    // frame threading would hold the first frame back by thread_count.
+    s.codecCtx->skip_frame = AVDISCARD_NONKEY;
+    s.codecCtx->skip_loop_filter = AVDISCARD_ALL;
+    s.codecCtx->flags2 |= AV_CODEC_FLAG2_FAST;
+    s.codecCtx->thread_type = FF_THREAD_SLICE;
+    // lowres (MJPEG, MPEG-1/2): decode at 1/2^n size while that still
+    // leaves twice the thumbnail width for the area filter.
+    int lowres = 0;
+    while (lowres < codec->max_lowres &&
+           (stream->codecpar->width >> (lowres + 1)) >= static_cast<int>(kThumbnailWidth * 2))
+    {
+        lowres++;
+    }
+    s.codecCtx->lowres = lowres;
+
+    if (avcodec_open2(s.codecCtx, codec, nullptr) < 0)
+    {
+        LOG_ERROR("RecordingThumbnailer: Could not open decoder for: " + videoPath);
+        return false;
+    }
+
+    // Back to the keyframe before the target instant; if the container
+    // can't seek we just decode from the start.
+    int64_t durationUs = s.formatCtx->duration != AV_NOPTS_VALUE ? s.formatCtx->duration : 0;
+    int64_t targetUs = std::min(durationUs / 10, kMaxTargetUs);
+    if (targetUs > 0)
+    {
+        int64_t ts = av_rescale_q(targetUs, AVRational{1, AV_TIME_BASE}, stream->time_base);
+        if (stream->start_time != AV_NOPTS_VALUE)
+        {
+            ts += stream->start_time;
+        }
+        if (av_seek_frame(s.formatCtx, streamIndex, ts, AVSEEK_FLAG_BACKWARD) < 0)
+        {
+            av_seek_frame(s.formatCtx, streamIndex, 0, AVSEEK_FLAG_BACKWARD);
+        }
+    }
+
+    s.packet = av_packet_alloc();
+    s.frame = av_frame_alloc();
+    if (!s.packet || !s.frame || !decodeOneFrame(s, streamIndex))
+    {
+        LOG_ERROR("RecordingThumbnailer: No decodable keyframe in: " + videoPath);
+        return false;
+    }
+
+    // Decoded frame -> RGB24 at the same size (format conversion only),
+    // then the area filter does the actual reduction.
+    const int srcW = s.frame->width;
+    const int srcH = s.frame->height;
+    if (srcW <= 0 || srcH <= 0)
+    {
+        return false;
+    }
+    s.toRgb = sws_getContext(srcW, srcH, static_cast<AVPixelFormat>(s.frame->format), srcW, srcH,
+                             AV_PIX_FMT_RGB24, SWS_POINT, nullptr, nullptr, nullptr);
+    if (!s.toRgb)
+    {
+        LOG_ERROR("RecordingThumbnailer: Unsupported pixel format in: " + videoPath);
+        return false;
+    }
+    std::vector<uint8_t> rgb(static_cast<size_t>(srcW) * srcH * 3);
+    uint8_t *rgbPlanes[4] = {rgb.data(), nullptr, nullptr, nullptr};
+    int rgbStrides[4] = {srcW * 3, 0, 0, 0};
+    sws_scale(s.toRgb, s.frame->data, s.frame->linesize, 0, srcH, rgbPlanes, rgbStrides);
+
+    // Even dimensions for 4:2:0; never enlarge.
+    int dstW = std::min(srcW, static_cast<int>(kThumbnailWidth)) & ~1;
+    int dstH = static_cast<int>(static_cast<int64_t>(srcH) * dstW / srcW) & ~1;
+    dstW = std::max(dstW, 2);
+    dstH = std::max(dstH, 2);
+    // Tail pad: thumb is the sws_scale source below.
+    std::vector<uint8_t> thumb(static_cast<size_t>(dstW) * dstH * 3 + FFmpegCompat::kSwsTailPad);
+    rc::pixfmt::downscaleRgb24Area(rgb.data(), srcW, srcH, static_cast<size_t>(srcW) * 3, thumb.data(), dstW, dstH);
+
+    const AVCodec *jpegCodec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    s.jpegCtx = jpegCodec ? avcodec_alloc_context3(jpegCodec) : nullptr;
+    if (!s.jpegCtx)
+    {
+        LOG_ERROR("RecordingThumbnailer: MJPEG encoder unavailable");
+        return false;
+    }
+    s.jpegCtx->width = dstW;
+    s.jpegCtx->height = dstH;
+    s.jpegCtx->pix_fmt = AV_PIX_FMT_YUVJ420P;
+    s.jpegCtx->time_base = {1, 25};
+    // Fixed quantizer instead of the default bitrate target.
+    s.jpegCtx->flags |= AV_CODEC_FLAG_QSCALE;
+    s.jpegCtx->global_quality = FF_QP2LAMBDA * 3;
+    if (avcodec_open2(s.jpegCtx, jpegCodec, nullptr) < 0)
+    {
+        LOG_ERROR("RecordingThumbnailer: Could not open MJPEG encoder");
+        return false;
+    }
+
+    s.yuvFrame = av_frame_alloc();
+    if (!s.yuvFrame)
+    {
+        return false;
+    }
+    s.yuvFrame->format = AV_PIX_FMT_YUVJ420P;
+    s.yuvFrame->width = dstW;
+    s.yuvFrame->height = dstH;
+    if (av_frame_get_buffer(s.yuvFrame, 32) < 0)
+    {
+        return false;
+    }
+    s.toYuv = sws_getContext(dstW, dstH, AV_PIX_FMT_RGB24, dstW, dstH, AV_PIX_FMT_YUVJ420P,
+                             SWS_POINT, nullptr, nullptr, nullptr);
+    if (!s.toYuv)
+    {
+        return false;
+    }
+    const uint8_t *thumbPlanes[4] = {thumb.data(), nullptr, nullptr, nullptr};
+    int thumbStrides[4] = {dstW * 3, 0, 0, 0};
+    sws_scale(s.toYuv, thumbPlanes, thumbStrides, 0, dstH, s.yuvFrame->data, s.yuvFrame->linesize);
+    s.yuvFrame->pts = 0;
+    s.yuvFrame->quality = s.jpegCtx->global_quality;
+
+    av_packet_unref(s.packet);
+    if (avcodec_send_frame(s.jpegCtx, s.yuvFrame) < 0 || avcodec_receive_packet(s.jpegCtx, s.packet) < 0)
+    {
+        LOG_ERROR("RecordingThumbnailer: JPEG encode failed for: " + videoPath);
+        return false;
+    }
+    if (!writeFileAtomic(thumbnailPath, s.packet->data, static_cast<size_t>(s.packet->size)))
+    {
+        LOG_ERROR("RecordingThumbnailer: Could not write: " + thumbnailPath);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * RecordingThumbnailer - background JPEG thumbnails for the recordings list
+ *
+ * One worker thread drains a queue of (recording, video, thumbnail) jobs so
+ * neither finishing a recording nor loading a catalog of hundreds of them
+ * waits on a decoder. Per job:
+ *
+ *  - content key: size + mtime + FNV-1a of the first/last 64 KB. If the
+ *    thumbnail exists and the catalog's key still has the same size/mtime,
+ *    nothing is read at all; if only the mtime moved but the sampled bytes
+ *    match a thumbnail made this session, that file is copied instead of
+ *    decoding again.
+ *  - decode: container headers only (no avformat_find_stream_info unless
+ *    they lack the dimensions), seek back to the keyframe before ~10% of
+ *    the duration, keyframes-only decode without loop filter (plus lowres
+ *    for the decoders that implement it), first frame wins.
+ *  - scale: RGB24 at decode size, rc::pixfmt::downscaleRgb24Area to
+ *    kThumbnailWidth, MJPEG. Written to a temp file and renamed, so the
+ *    HTTP side never serves half a JPEG.
+ *
+ * Results are handed back in batches (when the queue runs dry or every
+ * kBatchSize jobs) so the catalog is saved once per batch, not per file.
+ */
+class RecordingThumbnailer
+{
+public:
+    struct Result
+    {
+        std::string recordingId;
+        std::string thumbnailPath;
+        std::string key; // store in RecordingMetadata::thumbnailKey
+    };
+    using ResultCallback = std::function<void(const std::vector<Result> &results)>;
+
+    static constexpr uint32_t kThumbnailWidth = 320;
+
+    RecordingThumbnailer() = default;
+    ~RecordingThumbnailer();
+
+    RecordingThumbnailer(const RecordingThumbnailer &) = delete;
+    RecordingThumbnailer &operator=(const RecordingThumbnailer &) = delete;
+
+    // onResults runs on the worker thread.
+    void start(ResultCallback onResults);
+    // Drops queued jobs, finishes the one in flight and delivers its batch.
+    void stop();
+
+    // knownKey: the catalog's thumbnailKey (may be empty). Ignored while
+    // stopped — the next start()'s backfill picks the recording up.
+    void enqueue(const std::string &recordingId, const std::string &videoPath,
+                 const std::string &thumbnailPath, const std::string &knownKey);
+
+    // Synchronous decode + scale + encode; used by the worker.
+    static bool generate(const std::string &videoPath, const std::string &thumbnailPath);
+
+private:
+    struct Job
+    {
+        std::string recordingId;
+        std::string videoPath;
+        std::string thumbnailPath;
+        std::string knownKey;
+    };
+
+    static constexpr size_t kBatchSize = 16;
+
+    void workerThread();
+    // true = result carries something the catalog doesn't have yet.
+    bool process(const Job &job, Result &result);
+
+    std::thread m_worker;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_queue;
+    bool m_running = false; // guarded by m_mutex
+    ResultCallback m_onResults;
+
+    // Content (size + sampled hash, no mtime) -> thumbnail made this
+    // session. Worker thread only.
+    std::unordered_map<std::string, std::string> m_generated;
+};
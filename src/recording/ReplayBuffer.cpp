@@ -0,0 +1,128 @@
+#include "ReplayBuffer.h"
+
+void ReplayBuffer::configure(uint64_t maxDurationUs, uint64_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxDurationUs = maxDurationUs;
+    m_maxBytes = maxBytes;
+}
+
+void ReplayBuffer::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_gops.clear();
+    m_bytes = 0;
+    m_newestUs = 0;
+}
+
+void ReplayBuffer::push(const MediaEncoder::EncodedPacket &packet)
+{
+    // Copy before locking; snapshot() may be walking the ring.
+    auto entry = std::make_shared<const MediaEncoder::EncodedPacket>(packet);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (packet.isVideo && packet.isKeyframe)
+    {
+        m_gops.emplace_back();
+        m_gops.back().startUs = packet.captureTimestampUs;
+    }
+    else if (m_gops.empty())
+    {
+        return; // nothing decodable before the first keyframe
+    }
+
+    Gop &gop = m_gops.back();
+    gop.packets.push_back(std::move(entry));
+    gop.bytes += packet.data.size();
+    m_bytes += packet.data.size();
+    if (packet.captureTimestampUs > m_newestUs)
+    {
+        m_newestUs = packet.captureTimestampUs;
+    }
+
+    trim();
+}
+
+uint64_t ReplayBuffer::spanUs() const
+{
+    if (m_gops.empty() || m_newestUs <= m_gops.front().startUs)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(m_newestUs - m_gops.front().startUs);
+}
+
+void ReplayBuffer::trim()
+{
+    // Dropping the front GOP only helps if another one remains behind it.
+    while (m_gops.size() > 1)
+    {
+        const bool overBytes = m_maxBytes > 0 && m_bytes > m_maxBytes;
+        // Keep the front GOP while the one after it still starts inside
+        // the window — dropping it would leave less than maxDuration.
+        const int64_t nextStartUs = m_gops[1].startUs;
+        const bool overDuration = m_maxDurationUs > 0 && m_newestUs > nextStartUs &&
+                                  static_cast<uint64_t>(m_newestUs - nextStartUs) >= m_maxDurationUs;
+        if (!overBytes && !overDuration)
+        {
+            break;
+        }
+        m_bytes -= m_gops.front().bytes;
+        m_gops.pop_front();
+    }
+}
+
+std::vector<MediaEncoder::EncodedPacket> ReplayBuffer::snapshot(uint64_t lastUs) const
+{
+    // Only references under the lock; the payload copy happens after.
+    std::vector<std::shared_ptr<const MediaEncoder::EncodedPacket>> refs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t first = 0;
+        if (lastUs > 0)
+        {
+            // Latest GOP that starts at or before the requested instant.
+            const int64_t fromUs = m_newestUs - static_cast<int64_t>(lastUs);
+            for (size_t i = 0; i < m_gops.size(); i++)
+            {
+                if (m_gops[i].startUs <= fromUs)
+                {
+                    first = i;
+                }
+            }
+        }
+
+        size_t count = 0;
+        for (size_t i = first; i < m_gops.size(); i++)
+        {
+            count += m_gops[i].packets.size();
+        }
+        refs.reserve(count);
+        for (size_t i = first; i < m_gops.size(); i++)
+        {
+            refs.insert(refs.end(), m_gops[i].packets.begin(), m_gops[i].packets.end());
+        }
+    }
+
+    std::vector<MediaEncoder::EncodedPacket> packets;
+    packets.reserve(refs.size());
+    for (const auto &ref : refs)
+    {
+        packets.push_back(*ref);
+    }
+    return packets;
+}
+
+uint64_t ReplayBuffer::getDurationUs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return spanUs();
+}
+
+uint64_t ReplayBuffer::getBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "../encoding/MediaEncoder.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * ReplayBuffer - bounded in-memory ring of encoded packets ("instant replay")
+ *
+ * Keeps the last N seconds of a running encode so they can be written to a
+ * file after the fact, without recording to disk all the time. Packets are
+ * grouped per GOP (a video keyframe and everything up to the next one) and
+ * the ring only ever drops whole GOPs from the front, so a snapshot always
+ * starts on a keyframe and decodes cleanly.
+ *
+ * Both caps apply: the buffered span (captureTimestampUs of the oldest GOP
+ * to the newest packet) and the total payload bytes. The GOP being written
+ * is never dropped, so a single GOP larger than the byte cap still fits.
+ *
+ * Thread-safe: push() runs on the recording encoding thread, snapshot() and
+ * the getters from anywhere. Packets are held by shared_ptr so snapshot()
+ * only takes references under the lock and copies the payloads after
+ * releasing it — push() never waits on a multi-second copy.
+ */
+class ReplayBuffer
+{
+public:
+    ReplayBuffer() = default;
+
+    // New caps apply from the next push(); 0 = no limit on that axis.
+    void configure(uint64_t maxDurationUs, uint64_t maxBytes);
+    void clear();
+
+    // Packets before the first video keyframe are discarded.
+    void push(const MediaEncoder::EncodedPacket &packet);
+
+    /**
+     * Copy of the buffered packets in arrival order, starting on a video
+     * keyframe. lastUs > 0 keeps only the GOPs needed to cover the newest
+     * lastUs microseconds (rounded out to the GOP boundary before it).
+     */
+    std::vector<MediaEncoder::EncodedPacket> snapshot(uint64_t lastUs = 0) const;
+
+    uint64_t getDurationUs() const;
+    uint64_t getBytes() const;
+
+private:
+    struct Gop
+    {
+        std::vector<std::shared_ptr<const MediaEncoder::EncodedPacket>> packets;
+        uint64_t bytes = 0;
+        int64_t startUs = 0; // captureTimestampUs of the keyframe
+    };
+
+    // Chamado com m_mutex travado.
+    void trim();
+    uint64_t spanUs() const;
+
+    mutable std::mutex m_mutex;
+    std::deque<Gop> m_gops;
+    uint64_t m_bytes = 0;
+    int64_t m_newestUs = 0;
+    uint64_t m_maxDurationUs = 0;
+    uint64_t m_maxBytes = 0;
+};
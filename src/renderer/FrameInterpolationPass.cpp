@@ -0,0 +1,332 @@
+#include "FrameInterpolationPass.h"
+#include "../utils/Logger.h"
+#include <string>
+
+namespace
+{
+// Same version/GLSL-dialect handling as YUVRenderPass: the remote viewer
+// runs on GL 2.1 / ES 2.0 machines too.
+std::string cleanVersionString()
+{
+    std::string version = getGLSLVersionString();
+    while (!version.empty() && (version.back() == '\n' || version.back() == '\r' || version.back() == ' '))
+        version.pop_back();
+    while (!version.empty() && (version.front() == ' ' || version.front() == '\n' || version.front() == '\r'))
+        version.erase(0, 1);
+    return version;
+}
+
+std::string buildVertexShader()
+{
+    const std::string version = cleanVersionString();
+    const bool isES = isOpenGLES();
+    if (getOpenGLMajorVersion() >= 3)
+    {
+        return version + (isES ? "\n" : " core\n") +
+               "in vec2 aPos;\n"
+               "in vec2 aTexCoord;\n"
+               "out vec2 TexCoord;\n"
+               "void main() {\n"
+               "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+               "    TexCoord = aTexCoord;\n"
+               "}\n";
+    }
+    return version + "\n" +
+           (isES ? "precision mediump float;\n" : "") +
+           "attribute vec2 aPos;\n"
+           "attribute vec2 aTexCoord;\n"
+           "varying vec2 TexCoord;\n"
+           "void main() {\n"
+           "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+           "    TexCoord = aTexCoord;\n"
+           "}\n";
+}
+
+std::string buildFragmentShader()
+{
+    const std::string version = cleanVersionString();
+    const bool isES = isOpenGLES();
+    if (getOpenGLMajorVersion() >= 3)
+    {
+        return version + (isES ? "\nprecision mediump float;\n" : " core\n") +
+               "in vec2 TexCoord;\n"
+               "uniform sampler2D frameA;\n"
+               "uniform sampler2D frameB;\n"
+               "uniform float weight;\n"
+               "out vec4 FragColor;\n"
+               "void main() {\n"
+               "    FragColor = mix(texture(frameA, TexCoord), texture(frameB, TexCoord), weight);\n"
+               "}\n";
+    }
+    return version + "\n" + (isES ? "precision mediump float;\n" : "") +
+           "varying vec2 TexCoord;\n"
+           "uniform sampler2D frameA;\n"
+           "uniform sampler2D frameB;\n"
+           "uniform float weight;\n"
+           "void main() {\n"
+           "    gl_FragColor = mix(texture2D(frameA, TexCoord), texture2D(frameB, TexCoord), weight);\n"
+           "}\n";
+}
+
+GLuint compileShader(GLenum type, const std::string &source)
+{
+    const char *src = source.c_str();
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+        LOG_ERROR("FrameInterpolationPass: shader compile failed: " + std::string(infoLog));
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+} // namespace
+
+FrameInterpolationPass::~FrameInterpolationPass()
+{
+    shutdown();
+}
+
+bool FrameInterpolationPass::init()
+{
+    if (m_program != 0)
+    {
+        return true;
+    }
+    if (!m_yuvPass.init())
+    {
+        return false;
+    }
+    if (!createProgram())
+    {
+        m_yuvPass.shutdown();
+        return false;
+    }
+    createQuad();
+    glGenFramebuffers(1, &m_fbo);
+    for (Slot &slot : m_ring)
+    {
+        glGenTextures(1, &slot.texture);
+    }
+    glGenTextures(1, &m_outputTexture);
+    LOG_INFO("FrameInterpolationPass inicializado (" + std::to_string(kRingSize) + " texturas no anel)");
+    return true;
+}
+
+void FrameInterpolationPass::shutdown()
+{
+    if (m_program == 0)
+    {
+        return;
+    }
+    for (Slot &slot : m_ring)
+    {
+        glDeleteTextures(1, &slot.texture);
+        slot = Slot{};
+    }
+    glDeleteTextures(1, &m_outputTexture);
+    m_outputTexture = 0;
+    m_outputWidth = 0;
+    m_outputHeight = 0;
+    m_outputAttached = false;
+    if (m_fbo)
+    {
+        glDeleteFramebuffers(1, &m_fbo);
+        m_fbo = 0;
+    }
+    if (m_VAO)
+    {
+        glDeleteVertexArrays(1, &m_VAO);
+        m_VAO = 0;
+    }
+    if (m_VBO)
+    {
+        glDeleteBuffers(1, &m_VBO);
+        m_VBO = 0;
+    }
+    if (m_EBO)
+    {
+        glDeleteBuffers(1, &m_EBO);
+        m_EBO = 0;
+    }
+    glDeleteProgram(m_program);
+    m_program = 0;
+    m_yuvPass.shutdown();
+}
+
+bool FrameInterpolationPass::createProgram()
+{
+    GLuint vs = compileShader(GL_VERTEX_SHADER, buildVertexShader());
+    if (!vs)
+    {
+        return false;
+    }
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, buildFragmentShader());
+    if (!fs)
+    {
+        glDeleteShader(vs);
+        return false;
+    }
+
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vs);
+    glAttachShader(m_program, fs);
+    glBindAttribLocation(m_program, 0, "aPos");
+    glBindAttribLocation(m_program, 1, "aTexCoord");
+    glLinkProgram(m_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(m_program, sizeof(infoLog), nullptr, infoLog);
+        LOG_ERROR("FrameInterpolationPass: program link failed: " + std::string(infoLog));
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+
+    m_locFrameA = glGetUniformLocation(m_program, "frameA");
+    m_locFrameB = glGetUniformLocation(m_program, "frameB");
+    m_locWeight = glGetUniformLocation(m_program, "weight");
+    return true;
+}
+
+void FrameInterpolationPass::createQuad()
+{
+    float vertices[] = {
+        // Posições      // TexCoords
+        -1.0f, -1.0f,    0.0f, 0.0f,
+         1.0f, -1.0f,    1.0f, 0.0f,
+         1.0f,  1.0f,    1.0f, 1.0f,
+        -1.0f,  1.0f,    0.0f, 1.0f
+    };
+    unsigned int indices[] = {
+        0, 1, 2,
+        2, 3, 0
+    };
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+void FrameInterpolationPass::allocateTexture(GLuint texture, uint32_t width, uint32_t height)
+{
+    // RGBA: colour-renderable everywhere, RGB8 isn't on GLES 2. The
+    // shader chain sets its own filtering on the input texture.
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+}
+
+GLuint FrameInterpolationPass::frameTexture(uint64_t frameId, const YUVRenderPass::Planes &planes)
+{
+    if (m_program == 0 || frameId == 0)
+    {
+        return 0;
+    }
+    Slot *victim = &m_ring[0];
+    for (Slot &slot : m_ring)
+    {
+        if (slot.frameId == frameId)
+        {
+            slot.lastUse = ++m_useCounter;
+            return slot.texture;
+        }
+        if (slot.lastUse < victim->lastUse)
+        {
+            victim = &slot;
+        }
+    }
+
+    const uint32_t width = planes.outputWidth ? planes.outputWidth : planes.width;
+    const uint32_t height = planes.outputHeight ? planes.outputHeight : planes.height;
+    if (victim->width != width || victim->height != height)
+    {
+        allocateTexture(victim->texture, width, height);
+        victim->width = width;
+        victim->height = height;
+    }
+    if (!m_yuvPass.render(planes, victim->texture))
+    {
+        victim->frameId = 0;
+        victim->lastUse = 0;
+        return 0;
+    }
+    victim->frameId = frameId;
+    victim->lastUse = ++m_useCounter;
+    return victim->texture;
+}
+
+GLuint FrameInterpolationPass::blend(GLuint a, GLuint b, float weight, uint32_t width, uint32_t height)
+{
+    if (m_program == 0 || a == 0 || b == 0 || width == 0 || height == 0)
+    {
+        return 0;
+    }
+
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    if (m_outputWidth != width || m_outputHeight != height || !m_outputAttached)
+    {
+        allocateTexture(m_outputTexture, width, height);
+        m_outputWidth = width;
+        m_outputHeight = height;
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_outputTexture, 0);
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LOG_ERROR("FrameInterpolationPass: framebuffer incompleto (status " + std::to_string(status) + ")");
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+            m_outputAttached = false;
+            glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+            return 0;
+        }
+        m_outputAttached = true;
+    }
+
+    glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glUseProgram(m_program);
+    glUniform1f(m_locWeight, weight);
+    glUniform1i(m_locFrameA, 0);
+    glUniform1i(m_locFrameB, 1);
+    glActiveTexture(GL_TEXTURE0 + 1);
+    glBindTexture(GL_TEXTURE_2D, b);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, a);
+
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    return m_outputTexture;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "YUVRenderPass.h"
+#include "glad_loader.h"
+#include <cstdint>
+
+/**
+ * GPU side of the remote-source frame pacing (VideoCaptureRemote).
+ *
+ * Each decoded stream frame is converted once, by YUVRenderPass, into one
+ * of kRingSize RGBA textures tagged with the frame's id; display refreshes
+ * between two stream frames then either hand out one of those textures
+ * as-is (Nearest / Off, or Linear at the endpoints) or render a mix of
+ * the two into an output texture (Linear). Nothing is uploaded or
+ * converted on a refresh that doesn't bring a new stream frame.
+ *
+ * Three slots: the frame on screen, the next one, and the one being
+ * replaced when the schedule advances. Least recently used goes.
+ *
+ * MUST be used on the GL thread.
+ */
+class FrameInterpolationPass
+{
+public:
+    FrameInterpolationPass() = default;
+    ~FrameInterpolationPass();
+
+    bool init();
+    void shutdown();
+    bool isInitialized() const { return m_program != 0; }
+
+    /**
+     * Ring texture holding frameId, converting planes into it first if it
+     * isn't resident (planes are only read then). Output size and
+     * orientation come from planes (see YUVRenderPass::Planes). 0 on error.
+     */
+    GLuint frameTexture(uint64_t frameId, const YUVRenderPass::Planes &planes);
+
+    /**
+     * Render mix(a, b, weight) into the output texture and return it. Both
+     * inputs are width x height ring textures. Restores the previously
+     * bound framebuffer and viewport. 0 on error.
+     */
+    GLuint blend(GLuint a, GLuint b, float weight, uint32_t width, uint32_t height);
+
+private:
+    static constexpr int kRingSize = 3;
+
+    struct Slot
+    {
+        GLuint texture = 0;
+        uint64_t frameId = 0; // 0 = empty (frame ids start at 1)
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t lastUse = 0;
+    };
+
+    YUVRenderPass m_yuvPass;
+    Slot m_ring[kRingSize];
+    uint64_t m_useCounter = 0;
+
+    GLuint m_program = 0;
+    GLuint m_VAO = 0;
+    GLuint m_VBO = 0;
+    GLuint m_EBO = 0;
+    GLuint m_fbo = 0;
+    GLuint m_outputTexture = 0;
+    uint32_t m_outputWidth = 0;
+    uint32_t m_outputHeight = 0;
+    bool m_outputAttached = false;
+
+    GLint m_locFrameA = -1;
+    GLint m_locFrameB = -1;
+    GLint m_locWeight = -1;
+
+    bool createProgram();
+    void createQuad();
+    static void allocateTexture(GLuint texture, uint32_t width, uint32_t height);
+};
@@ -379,7 +379,9 @@ void OpenGLRenderer::updateTexture(GLuint texture, const uint8_t* data, uint32_t
         // (na prática, precisaria de conversão)
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
     } else if (format == V4L2_PIX_FMT_MJPEG || format == V4L2_PIX_FMT_JPEG) {
-        // MJPEG precisa ser decodificado primeiro
+        // MJPEG precisa ser decodificado primeiro (a captura decodifica via
+        // MJPEGDecodePool e o FrameProcessor converte com YUVRenderPass;
+        // não deveria chegar aqui)
         LOG_WARN("MJPEG precisa ser decodificado antes de criar textura");
     } else {
         glTexImage2D(GL_TEXTURE_2D, 0, glInternalFormat, width, height, 0, glFormat, GL_UNSIGNED_BYTE, data);
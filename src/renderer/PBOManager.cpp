@@ -1,20 +1,22 @@
 #include "PBOManager.h"
 #include "../utils/Logger.h"
+#include <algorithm>
 #include <cstring>
 
-PBOManager::PBOManager()
+PBOManager::PBOManager(int slotCount)
     : m_initialized(false)
     , m_width(0)
     , m_height(0)
     , m_format(GL_RGB)
     , m_bytesPerPixel(3)
     , m_bufferSize(0)
-    , m_currentPBO(0)
-    , m_nextPBO(1)
-    , m_readsStarted(0)
+    , m_slotCount(std::max(2, std::min(slotCount, MAX_SLOT_COUNT)))
+    , m_writeIndex(0)
+    , m_nextSeq(0)
+    , m_useFences(false)
+    , m_skipped(0)
+    , m_overruns(0)
 {
-    m_pbo[0] = 0;
-    m_pbo[1] = 0;
 }
 
 PBOManager::~PBOManager()
@@ -26,7 +28,7 @@ bool PBOManager::init(uint32_t width, uint32_t height, GLenum format)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    uint32_t bpp = (format == GL_RGBA) ? 4 : 3;
+    uint32_t bpp = (format == GL_RGBA) ? 4 : (format == GL_RED) ? 1 : 3;
 
     if (m_initialized)
     {
@@ -38,7 +40,6 @@ bool PBOManager::init(uint32_t width, uint32_t height, GLenum format)
             m_width = width;
             m_height = height;
             m_bufferSize = calculateBufferSize(width, height);
-            m_readsStarted = 0;
             if (!createPBOs())
             {
                 m_initialized = false;
@@ -64,14 +65,15 @@ bool PBOManager::init(uint32_t width, uint32_t height, GLenum format)
 
     m_initialized = true;
     LOG_INFO("PBOs initialized: " + std::to_string(width) + "x" + std::to_string(height) +
-             " (" + (format == GL_RGBA ? "RGBA" : "RGB") + ")");
+             " (" + (format == GL_RGBA ? "RGBA" : format == GL_RED ? "R8" : "RGB") + ", " + std::to_string(m_slotCount) +
+             " slots, " + (m_useFences ? "fenced" : "no fences") + ")");
     return true;
 }
 
 void PBOManager::cleanup()
 {
     std::lock_guard<std::mutex> lock(m_mutex);
-    
+
     if (m_initialized)
     {
         deletePBOs();
@@ -79,30 +81,40 @@ void PBOManager::cleanup()
         m_width = 0;
         m_height = 0;
         m_bufferSize = 0;
-        m_readsStarted = 0;
     }
 }
 
 bool PBOManager::startAsyncRead(GLint x, GLint y, GLsizei width, GLsizei height)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
-    
+
     if (!m_initialized)
     {
         return false;
     }
-    
+
     // Redimensionar se necessário
     if (width != static_cast<GLsizei>(m_width) || height != static_cast<GLsizei>(m_height))
     {
         resizeIfNeeded(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        if (!m_initialized)
+        {
+            return false;
+        }
     }
-    
-    // Alternar PBOs: usar o próximo PBO para leitura
-    std::swap(m_currentPBO, m_nextPBO);
 
-    // Bind o PBO atual para glReadPixels escrever nele
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[m_currentPBO]);
+    Slot& slot = m_slots[m_writeIndex];
+    if (slot.pending)
+    {
+        // Ring cheio: a GPU está N frames atrás ou ninguém está lendo.
+        // Reescrever o slot mais antigo é seguro — o driver serializa o
+        // novo glReadPixels depois do anterior no mesmo buffer.
+        releaseSlot(slot);
+        m_overruns++;
+    }
+
+    // Bind o PBO do slot para glReadPixels escrever nele
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
 
     // Iniciar leitura assíncrona (não bloqueia): glReadPixels escreve no PBO
     // mas não espera a transferência completar.
@@ -110,19 +122,22 @@ bool PBOManager::startAsyncRead(GLint x, GLint y, GLsizei width, GLsizei height)
 
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-    if (m_readsStarted < 2)
+    if (m_useFences)
     {
-        m_readsStarted++;
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     }
+    slot.pending = true;
+    slot.seq = m_nextSeq++;
+    m_writeIndex = (m_writeIndex + 1) % m_slotCount;
 
     return true;
 }
 
-bool PBOManager::getReadData(uint8_t* data, uint32_t width, uint32_t height, bool flipY)
+bool PBOManager::readMapped(uint32_t width, uint32_t height, const ReadConsumer& consumer)
 {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    if (!m_initialized || !data)
+    if (!m_initialized || !consumer)
     {
         return false;
     }
@@ -132,25 +147,40 @@ bool PBOManager::getReadData(uint8_t* data, uint32_t width, uint32_t height, boo
         return false;
     }
 
-    // Precisamos de pelo menos 2 startAsyncRead antes de ler m_nextPBO,
-    // senão o "PBO anterior" tem conteúdo indefinido (recém-alocado).
-    if (m_readsStarted < 2)
+    int index = acquireNewestReady();
+    if (index < 0)
     {
         return false;
     }
 
-    // Bind o PBO que foi iniciado no frame anterior (m_nextPBO, devido ao swap em startAsyncRead).
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[m_nextPBO]);
+    Slot& slot = m_slots[index];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
 
+    // Fence já sinalizou: o map não espera a GPU.
     void* mappedData = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-
+    bool ok = false;
     if (mappedData)
     {
-        size_t rowSizeUnpadded = static_cast<size_t>(width) * m_bytesPerPixel;
-        size_t rowSizePadded = ((rowSizeUnpadded + 3) / 4) * 4;
+        consumer(static_cast<const uint8_t*>(mappedData), rowStride());
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        ok = true;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    releaseSlot(slot);
+    return ok;
+}
 
-        const uint8_t* src = static_cast<const uint8_t*>(mappedData);
+bool PBOManager::getReadData(uint8_t* data, uint32_t width, uint32_t height, bool flipY)
+{
+    if (!data)
+    {
+        return false;
+    }
 
+    return readMapped(width, height, [&](const uint8_t* src, size_t rowSizePadded)
+    {
+        size_t rowSizeUnpadded = static_cast<size_t>(width) * m_bytesPerPixel;
         for (uint32_t row = 0; row < height; row++)
         {
             uint32_t srcRow = flipY ? (height - 1 - row) : row;
@@ -158,43 +188,25 @@ bool PBOManager::getReadData(uint8_t* data, uint32_t width, uint32_t height, boo
             uint8_t* dstPtr = data + (row * rowSizeUnpadded);
             memcpy(dstPtr, srcPtr, rowSizeUnpadded);
         }
-
-        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-
-        return true;
-    }
-
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    return false;
+    });
 }
 
 bool PBOManager::hasDataReady() const
 {
     std::lock_guard<std::mutex> lock(m_mutex);
-    
+
     if (!m_initialized)
     {
         return false;
     }
-    
-    // Verificar se o PBO anterior tem dados prontos
-    // Usar glMapBuffer com GL_READ_ONLY para verificar
-    // Nota: glMapBuffer pode bloquear, mas como estamos verificando o PBO anterior
-    // (que foi lido no frame anterior), ele deve estar pronto
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[m_nextPBO]);
-    
-    // Tentar mapear (pode bloquear se dados não estão prontos, mas isso é aceitável)
-    void* mappedData = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
-    
-    if (mappedData)
+
+    for (const Slot& slot : m_slots)
     {
-        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-        return true;
+        if (slot.pending && slotReady(slot))
+        {
+            return true;
+        }
     }
-    
-    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
     return false;
 }
 
@@ -204,13 +216,12 @@ void PBOManager::resizeIfNeeded(uint32_t width, uint32_t height)
     {
         return; // Não precisa redimensionar
     }
-    
+
     deletePBOs();
 
     m_width = width;
     m_height = height;
     m_bufferSize = calculateBufferSize(width, height);
-    m_readsStarted = 0;
 
     if (!createPBOs())
     {
@@ -219,44 +230,119 @@ void PBOManager::resizeIfNeeded(uint32_t width, uint32_t height)
     }
 }
 
-size_t PBOManager::calculateBufferSize(uint32_t width, uint32_t height) const
+size_t PBOManager::rowStride() const
 {
     // Padding de 4 bytes por linha (default GL_PACK_ALIGNMENT).
+    size_t rowSizeUnpadded = static_cast<size_t>(m_width) * m_bytesPerPixel;
+    return ((rowSizeUnpadded + 3) / 4) * 4;
+}
+
+size_t PBOManager::calculateBufferSize(uint32_t width, uint32_t height) const
+{
     size_t rowSizeUnpadded = static_cast<size_t>(width) * m_bytesPerPixel;
     size_t rowSizePadded = ((rowSizeUnpadded + 3) / 4) * 4;
     return rowSizePadded * static_cast<size_t>(height);
 }
 
+bool PBOManager::slotReady(const Slot& slot) const
+{
+    if (slot.fence)
+    {
+        // Timeout 0: só consulta. O FLUSH garante que o fence chega à GPU
+        // mesmo se ninguém mais der flush neste frame.
+        GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+
+    // Sem fences: pronto depois de N-1 leituras mais novas (para N=2 é o
+    // "PBO do frame anterior" do double-buffering original).
+    return (m_nextSeq - slot.seq) >= static_cast<uint64_t>(m_slotCount - 1);
+}
+
+void PBOManager::releaseSlot(Slot& slot)
+{
+    if (slot.fence)
+    {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+    }
+    slot.pending = false;
+}
+
+int PBOManager::acquireNewestReady()
+{
+    int newest = -1;
+    for (int i = 0; i < m_slotCount; i++)
+    {
+        const Slot& slot = m_slots[i];
+        if (slot.pending && (newest < 0 || slot.seq > m_slots[newest].seq) && slotReady(slot))
+        {
+            newest = i;
+        }
+    }
+    if (newest < 0)
+    {
+        return -1;
+    }
+
+    // Entregar sempre o mais novo mantém a latência em ~1 frame mesmo
+    // depois de um soluço da GPU; os mais velhos que ele não são mais úteis.
+    for (int i = 0; i < m_slotCount; i++)
+    {
+        Slot& slot = m_slots[i];
+        if (slot.pending && slot.seq < m_slots[newest].seq)
+        {
+            releaseSlot(slot);
+            m_skipped++;
+        }
+    }
+    return newest;
+}
+
 bool PBOManager::createPBOs()
 {
-    // Criar 2 PBOs para double-buffering
-    glGenBuffers(2, m_pbo);
-    
-    if (m_pbo[0] == 0 || m_pbo[1] == 0)
+    m_slots.assign(m_slotCount, Slot());
+    m_writeIndex = 0;
+    m_nextSeq = 0;
+    m_useFences = hasFenceSync();
+
+    std::vector<GLuint> ids(m_slotCount, 0);
+    glGenBuffers(m_slotCount, ids.data());
+
+    for (int i = 0; i < m_slotCount; i++)
     {
-        LOG_ERROR("Failed to generate PBOs");
-        return false;
+        if (ids[i] == 0)
+        {
+            LOG_ERROR("Failed to generate PBOs");
+            glDeleteBuffers(m_slotCount, ids.data());
+            m_slots.clear();
+            return false;
+        }
+        m_slots[i].pbo = ids[i];
     }
-    
-    // Alocar espaço para ambos os PBOs
-    for (int i = 0; i < 2; i++)
+
+    // Alocar espaço para todos os slots
+    for (int i = 0; i < m_slotCount; i++)
     {
-        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pbo[i]);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_slots[i].pbo);
         glBufferData(GL_PIXEL_PACK_BUFFER, m_bufferSize, nullptr, GL_STREAM_READ);
     }
-    
+
     glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
-    
+
     return true;
 }
 
 void PBOManager::deletePBOs()
 {
-    if (m_pbo[0] != 0 || m_pbo[1] != 0)
+    for (Slot& slot : m_slots)
     {
-        glDeleteBuffers(2, m_pbo);
-        m_pbo[0] = 0;
-        m_pbo[1] = 0;
+        releaseSlot(slot);
+        if (slot.pbo != 0)
+        {
+            glDeleteBuffers(1, &slot.pbo);
+            slot.pbo = 0;
+        }
     }
+    m_slots.clear();
 }
-
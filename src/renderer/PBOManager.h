@@ -2,39 +2,53 @@
 
 #include "glad_loader.h"
 #include <cstdint>
+#include <functional>
 #include <vector>
 #include <mutex>
 
 /**
  * Gerencia PBOs (Pixel Buffer Objects) para leitura assíncrona de pixels do framebuffer.
- * Usa double-buffering: enquanto um PBO é lido, o outro é preenchido.
+ *
+ * Ring de N slots: cada startAsyncRead() agenda um glReadPixels no próximo
+ * slot e, quando o contexto tem sync objects, coloca um fence logo atrás.
+ * A leitura só mapeia slots cujo fence já sinalizou, então a CPU nunca
+ * espera a GPU — com double-buffering fixo o glMapBuffer do "PBO anterior"
+ * bloqueava sempre que a GPU estava mais de um frame atrás (presets pesados
+ * tipo crt-royale). Sem fences, um slot é considerado pronto depois de
+ * N-1 leituras mais novas (N=2 reproduz o comportamento antigo).
  */
 class PBOManager {
 public:
-    PBOManager();
+    static constexpr int DEFAULT_SLOT_COUNT = 3;
+    static constexpr int MAX_SLOT_COUNT = 8;
+
+    explicit PBOManager(int slotCount = DEFAULT_SLOT_COUNT);
     ~PBOManager();
-    
+
     /**
      * Inicializar PBOs com tamanho e formato específicos.
      * @param width Largura da imagem
      * @param height Altura da imagem
-     * @param format Formato de leitura (GL_RGB = 3 bpp, GL_RGBA = 4 bpp)
+     * @param format Formato de leitura (GL_RGB = 3 bpp, GL_RGBA = 4 bpp,
+     *               GL_RED = 1 bpp — planos YUV do RGBToYUVPass)
      * @return true se inicializado com sucesso
      */
     bool init(uint32_t width, uint32_t height, GLenum format = GL_RGB);
-    
+
     /**
      * Limpar recursos (deletar PBOs).
      */
     void cleanup();
-    
+
     /**
      * Verificar se PBOs estão inicializados.
      */
     bool isInitialized() const { return m_initialized; }
-    
+
     /**
-     * Iniciar leitura assíncrona do framebuffer para o PBO atual.
+     * Iniciar leitura assíncrona do framebuffer para o próximo slot do ring.
+     * Se o ring estiver cheio (GPU N frames atrás), o slot mais antigo ainda
+     * não lido é descartado.
      * @param x Coordenada X do viewport
      * @param y Coordenada Y do viewport
      * @param width Largura da região a ler
@@ -42,9 +56,9 @@ public:
      * @return true se iniciado com sucesso
      */
     bool startAsyncRead(GLint x, GLint y, GLsizei width, GLsizei height);
-    
+
     /**
-     * Obter dados do PBO que foi lido anteriormente (não bloqueia).
+     * Obter dados do slot completo mais recente (não bloqueia).
      * @param data Buffer de saída (tamanho = width * height * bytesPerPixel)
      * @param width Largura esperada
      * @param height Altura esperada
@@ -53,51 +67,90 @@ public:
      */
     bool getReadData(uint8_t* data, uint32_t width, uint32_t height, bool flipY);
 
+    /**
+     * Consumidor que lê direto da memória mapeada do PBO. `rowStride` é o
+     * tamanho da linha com o padding de GL_PACK_ALIGNMENT (4); linhas em
+     * ordem bottom-up, como o glReadPixels as entrega. O ponteiro só é
+     * válido durante a chamada.
+     */
+    using ReadConsumer = std::function<void(const uint8_t* data, size_t rowStride)>;
+
+    /**
+     * Mesma seleção de slot que getReadData, mas sem a cópia intermediária:
+     * o consumidor (virtual camera, conversão RGBA->RGB para stream/gravação)
+     * lê direto do buffer mapeado.
+     * @return true se havia um slot pronto e o consumidor foi chamado
+     */
+    bool readMapped(uint32_t width, uint32_t height, const ReadConsumer& consumer);
+
     /**
      * Bytes por pixel do formato configurado.
      */
     uint32_t getBytesPerPixel() const { return m_bytesPerPixel; }
-    
+
     /**
-     * Verificar se há dados prontos para leitura.
+     * Verificar se há dados prontos para leitura (não bloqueia).
      */
     bool hasDataReady() const;
-    
+
     /**
      * Redimensionar PBOs se necessário (chamado quando dimensões mudam).
      */
     void resizeIfNeeded(uint32_t width, uint32_t height);
-    
+
+    // Estatísticas: slots que completaram mas foram pulados por haver um
+    // mais novo pronto, e slots sobrescritos antes de completar (ring cheio).
+    uint64_t getSkippedCount() const { return m_skipped; }
+    uint64_t getOverrunCount() const { return m_overruns; }
+
 private:
+    struct Slot
+    {
+        GLuint pbo = 0;
+        GLsync fence = nullptr;
+        bool pending = false; // glReadPixels agendado e ainda não consumido
+        uint64_t seq = 0;     // ordem de startAsyncRead
+    };
+
     bool m_initialized;
     uint32_t m_width;
     uint32_t m_height;
-    GLenum m_format;            // GL_RGB ou GL_RGBA
-    uint32_t m_bytesPerPixel;   // 3 ou 4
+    GLenum m_format;            // GL_RGB, GL_RGBA ou GL_RED
+    uint32_t m_bytesPerPixel;   // 3, 4 ou 1
     size_t m_bufferSize;        // width * height * bytesPerPixel (com row padding)
-    
-    // Double-buffering: 2 PBOs
-    GLuint m_pbo[2];
-    int m_currentPBO; // Índice do PBO atual (0 ou 1)
-    int m_nextPBO;    // Índice do próximo PBO (1 ou 0)
-    int m_readsStarted; // Quantos startAsyncRead já rodaram desde init/resize (cap em 2)
-    
+
+    std::vector<Slot> m_slots;
+    int m_slotCount;
+    int m_writeIndex;   // Próximo slot para startAsyncRead
+    uint64_t m_nextSeq; // seq do próximo startAsyncRead
+    bool m_useFences;   // hasFenceSync() no momento do createPBOs
+
+    uint64_t m_skipped;
+    uint64_t m_overruns;
+
     // Mutex para thread-safety
     mutable std::mutex m_mutex;
-    
+
     /**
      * Calcular tamanho do buffer necessário.
      */
     size_t calculateBufferSize(uint32_t width, uint32_t height) const;
-    
+    size_t rowStride() const;
+
     /**
      * Criar PBOs.
      */
     bool createPBOs();
-    
+
     /**
      * Deletar PBOs.
      */
     void deletePBOs();
-};
 
+    // Chamados com m_mutex travado.
+    bool slotReady(const Slot& slot) const;
+    void releaseSlot(Slot& slot);
+    // Slot pendente mais novo já pronto; slots pendentes mais velhos que
+    // ele são liberados (pulados). -1 se nada pronto.
+    int acquireNewestReady();
+};
@@ -0,0 +1,277 @@
+#include "RGBToYUVPass.h"
+#include "../utils/Logger.h"
+#include <string>
+
+namespace
+{
+const char *kVertexShader =
+    "#version 330 core\n"
+    "in vec2 aPos;\n"
+    "void main() {\n"
+    "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+    "}\n";
+
+// One fragment per output byte. gl_FragCoord.y < h writes luma for the
+// source texel of the same row; above that, the left half is U and the
+// right half V for the 2x2 block (cx, cy). Chroma averages four explicit
+// texel fetches so the result doesn't depend on the source's filter mode.
+const char *kFragmentShader =
+    "#version 330 core\n"
+    "uniform sampler2D source;\n"
+    "uniform vec2 size;\n"
+    "out vec4 FragColor;\n"
+    "const vec3 kY = vec3(0.256788, 0.504129, 0.097906);\n"
+    "const vec3 kU = vec3(-0.148223, -0.290993, 0.439216);\n"
+    "const vec3 kV = vec3(0.439216, -0.367788, -0.071427);\n"
+    "vec3 texel(vec2 p) {\n"
+    "    return texture(source, (p + 0.5) / size).rgb;\n"
+    "}\n"
+    "void main() {\n"
+    "    vec2 p = floor(gl_FragCoord.xy);\n"
+    "    float value;\n"
+    "    if (p.y < size.y) {\n"
+    "        value = dot(texel(p), kY) + 16.0 / 255.0;\n"
+    "    } else {\n"
+    "        float halfWidth = size.x * 0.5;\n"
+    "        bool isV = p.x >= halfWidth;\n"
+    "        vec2 c = vec2(isV ? p.x - halfWidth : p.x, p.y - size.y) * 2.0;\n"
+    "        vec3 rgb = (texel(c) + texel(c + vec2(1.0, 0.0)) +\n"
+    "                    texel(c + vec2(0.0, 1.0)) + texel(c + vec2(1.0, 1.0))) * 0.25;\n"
+    "        value = dot(rgb, isV ? kV : kU) + 128.0 / 255.0;\n"
+    "    }\n"
+    "    FragColor = vec4(value, 0.0, 0.0, 1.0);\n"
+    "}\n";
+
+GLuint compileShader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+        LOG_ERROR("RGBToYUVPass: shader compile failed: " + std::string(infoLog));
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+} // namespace
+
+RGBToYUVPass::~RGBToYUVPass()
+{
+    shutdown();
+}
+
+bool RGBToYUVPass::init()
+{
+    if (m_program != 0)
+    {
+        return true;
+    }
+    if (m_unsupported)
+    {
+        return false;
+    }
+
+    // GL_R8 as a render target and GL_RED readback: desktop GL 3.x. On
+    // ES / 2.1 the caller keeps the RGB readback + swscale path.
+    if (isOpenGLES() || getOpenGLMajorVersion() < 3 || getGLSLVersionString() != "#version 330")
+    {
+        LOG_INFO("RGBToYUVPass: needs desktop GL 3.3 — encoder feed stays RGB");
+        m_unsupported = true;
+        return false;
+    }
+
+    if (!createProgram())
+    {
+        m_unsupported = true;
+        return false;
+    }
+    createQuad();
+    glGenFramebuffers(1, &m_fbo);
+
+    LOG_INFO("RGBToYUVPass inicializado");
+    return true;
+}
+
+void RGBToYUVPass::shutdown()
+{
+    if (m_program == 0)
+    {
+        return;
+    }
+    if (m_targetTexture)
+    {
+        glDeleteTextures(1, &m_targetTexture);
+        m_targetTexture = 0;
+    }
+    m_width = 0;
+    m_height = 0;
+    if (m_fbo)
+    {
+        glDeleteFramebuffers(1, &m_fbo);
+        m_fbo = 0;
+    }
+    if (m_VAO)
+    {
+        glDeleteVertexArrays(1, &m_VAO);
+        m_VAO = 0;
+    }
+    if (m_VBO)
+    {
+        glDeleteBuffers(1, &m_VBO);
+        m_VBO = 0;
+    }
+    if (m_EBO)
+    {
+        glDeleteBuffers(1, &m_EBO);
+        m_EBO = 0;
+    }
+    glDeleteProgram(m_program);
+    m_program = 0;
+}
+
+bool RGBToYUVPass::createProgram()
+{
+    GLuint vs = compileShader(GL_VERTEX_SHADER, kVertexShader);
+    if (!vs)
+    {
+        return false;
+    }
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, kFragmentShader);
+    if (!fs)
+    {
+        glDeleteShader(vs);
+        return false;
+    }
+
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vs);
+    glAttachShader(m_program, fs);
+    glBindAttribLocation(m_program, 0, "aPos");
+    glLinkProgram(m_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(m_program, sizeof(infoLog), nullptr, infoLog);
+        LOG_ERROR("RGBToYUVPass: program link failed: " + std::string(infoLog));
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+
+    m_locSource = glGetUniformLocation(m_program, "source");
+    m_locSize = glGetUniformLocation(m_program, "size");
+    return true;
+}
+
+void RGBToYUVPass::createQuad()
+{
+    float vertices[] = {
+        -1.0f, -1.0f,
+         1.0f, -1.0f,
+         1.0f,  1.0f,
+        -1.0f,  1.0f
+    };
+    unsigned int indices[] = {
+        0, 1, 2,
+        2, 3, 0
+    };
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+}
+
+bool RGBToYUVPass::ensureTarget(uint32_t width, uint32_t height)
+{
+    if (m_targetTexture != 0 && m_width == width && m_height == height)
+    {
+        return true;
+    }
+
+    if (m_targetTexture == 0)
+    {
+        glGenTextures(1, &m_targetTexture);
+    }
+    glBindTexture(GL_TEXTURE_2D, m_targetTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, static_cast<GLsizei>(width),
+                 static_cast<GLsizei>(height + height / 2), 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLint prevFbo = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_targetTexture, 0);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        LOG_ERROR("RGBToYUVPass: framebuffer incompleto (status " + std::to_string(status) + ")");
+        // Driver sem R8 renderizável: desistir de vez (caminho RGB).
+        shutdown();
+        m_unsupported = true;
+        return false;
+    }
+
+    m_width = width;
+    m_height = height;
+    return true;
+}
+
+bool RGBToYUVPass::render(GLuint sourceTexture, uint32_t width, uint32_t height)
+{
+    if (m_program == 0 || sourceTexture == 0 || width < 2 || height < 2 ||
+        (width & 1) || (height & 1))
+    {
+        return false;
+    }
+    if (!ensureTarget(width, height))
+    {
+        return false;
+    }
+
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height + height / 2));
+    glDisable(GL_BLEND);
+    glUseProgram(m_program);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sourceTexture);
+    glUniform1i(m_locSource, 0);
+    glUniform2f(m_locSize, static_cast<float>(width), static_cast<float>(height));
+
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "glad_loader.h"
+#include <cstdint>
+
+/**
+ * GPU RGB→YUV 4:2:0 pass for the encoder feed — the inverse of
+ * YUVRenderPass.
+ *
+ * Renders the final capture texture into one GL_R8 target of
+ * width x (height * 3 / 2) laid out as VideoFrameFormat::YUV420SideBySide
+ * (Y rows, then U and V side by side). Reading that back moves 1.5 bytes
+ * per pixel instead of 3, and MediaEncoder copies the planes straight into
+ * its AVFrame instead of running swscale's RGB→YUV on the encoder thread.
+ *
+ * BT.601 limited range, chroma = average of the 2x2 block — the same
+ * output libswscale produced for RGB24 → YUV420P with our default flags.
+ *
+ * Orientation matches a direct glReadPixels of the source texture: row 0
+ * of the read-back is texture row 0, so the CPU side sees the same
+ * bottom-up order the RGB path always had.
+ *
+ * Needs desktop GL 3+ (R8 colour attachment + GL_RED readback); init()
+ * fails elsewhere and the caller keeps the RGB readback. Even dimensions
+ * only. MUST be used on the GL thread.
+ */
+class RGBToYUVPass
+{
+public:
+    RGBToYUVPass() = default;
+    ~RGBToYUVPass();
+
+    // Idempotent; once init() or a render() target allocation has failed it
+    // keeps returning false so the caller settles on the RGB path.
+    bool init();
+    void shutdown();
+    bool isInitialized() const { return m_program != 0; }
+
+    /**
+     * Convert sourceTexture (RGB/RGBA, width x height) into the internal
+     * YUV target. Restores the previously bound framebuffer and viewport.
+     */
+    bool render(GLuint sourceTexture, uint32_t width, uint32_t height);
+
+    // FBO holding the converted frame — bind it (GL_FRAMEBUFFER) to
+    // glReadPixels/PBOManager::startAsyncRead getOutputWidth() x
+    // getOutputHeight() pixels of GL_RED.
+    GLuint getFramebuffer() const { return m_fbo; }
+    uint32_t getOutputWidth() const { return m_width; }
+    uint32_t getOutputHeight() const { return m_height + m_height / 2; }
+
+private:
+    GLuint m_program = 0;
+    GLuint m_VAO = 0;
+    GLuint m_VBO = 0;
+    GLuint m_EBO = 0;
+    GLuint m_fbo = 0;
+    GLuint m_targetTexture = 0;
+    uint32_t m_width = 0;  // luma size of the allocated target
+    uint32_t m_height = 0;
+    bool m_unsupported = false;
+
+    GLint m_locSource = -1;
+    GLint m_locSize = -1;
+
+    bool createProgram();
+    void createQuad();
+    bool ensureTarget(uint32_t width, uint32_t height);
+};
@@ -0,0 +1,431 @@
+#include "YUVRenderPass.h"
+#include "../utils/Logger.h"
+#include <cstring>
+#include <string>
+
+namespace
+{
+// Same clean-up OpenGLRenderer applies: the version string must be exactly
+// "#version XXX" before we append " core" / newlines.
+std::string cleanVersionString()
+{
+    std::string version = getGLSLVersionString();
+    while (!version.empty() && (version.back() == '\n' || version.back() == '\r' || version.back() == ' '))
+        version.pop_back();
+    while (!version.empty() && (version.front() == ' ' || version.front() == '\n' || version.front() == '\r'))
+        version.erase(0, 1);
+    return version;
+}
+
+// Modern = GLSL with in/out + texture(); legacy = attribute/varying + texture2D().
+bool useModernGLSL()
+{
+    return getOpenGLMajorVersion() >= 3;
+}
+
+std::string buildVertexShader()
+{
+    const std::string version = cleanVersionString();
+    const bool isES = isOpenGLES();
+    if (useModernGLSL())
+    {
+        return version + (isES ? "\n" : " core\n") +
+               "in vec2 aPos;\n"
+               "in vec2 aTexCoord;\n"
+               "uniform float flipY;\n"
+               "out vec2 TexCoord;\n"
+               "void main() {\n"
+               "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+               "    TexCoord = vec2(aTexCoord.x, mix(aTexCoord.y, 1.0 - aTexCoord.y, flipY));\n"
+               "}\n";
+    }
+    return version + "\n" +
+           (isES ? "precision mediump float;\n" : "") +
+           "attribute vec2 aPos;\n"
+           "attribute vec2 aTexCoord;\n"
+           "uniform float flipY;\n"
+           "varying vec2 TexCoord;\n"
+           "void main() {\n"
+           "    gl_Position = vec4(aPos, 0.0, 1.0);\n"
+           "    TexCoord = vec2(aTexCoord.x, mix(aTexCoord.y, 1.0 - aTexCoord.y, flipY));\n"
+           "}\n";
+}
+
+std::string buildFragmentShader()
+{
+    const std::string version = cleanVersionString();
+    const bool isES = isOpenGLES();
+    const bool modern = useModernGLSL();
+
+    // coeffs = (Cr→R, Cb→G, Cr→G, Cb→B); yOffset/yScale/cScale fold the
+    // range expansion (video 16–235 or JPEG 0–255) into the same pass.
+    // interleaved = 1: planeU holds CbCr pairs (NV12) — Cr is its second
+    // channel, .g of a GL_RG texture or .a of a GL_LUMINANCE_ALPHA one.
+    const std::string body =
+        std::string("uniform sampler2D planeY;\n"
+                    "uniform sampler2D planeU;\n"
+                    "uniform sampler2D planeV;\n"
+                    "uniform float yOffset;\n"
+                    "uniform float yScale;\n"
+                    "uniform float cScale;\n"
+                    "uniform vec4 coeffs;\n"
+                    "uniform float interleaved;\n") +
+        (modern ? "out vec4 FragColor;\n" : "") +
+        "void main() {\n" +
+        (modern ? "    float y = texture(planeY, TexCoord).r;\n"
+                  "    vec4 cb = texture(planeU, TexCoord);\n"
+                  "    float u = cb.r;\n"
+                  "    float v = mix(texture(planeV, TexCoord).r, cb.g, interleaved);\n"
+                : "    float y = texture2D(planeY, TexCoord).r;\n"
+                  "    vec4 cb = texture2D(planeU, TexCoord);\n"
+                  "    float u = cb.r;\n"
+                  "    float v = mix(texture2D(planeV, TexCoord).r, cb.a, interleaved);\n") +
+        "    y = (y - yOffset) * yScale;\n"
+        "    u = (u - 0.5019608) * cScale;\n"
+        "    v = (v - 0.5019608) * cScale;\n"
+        "    vec3 rgb = vec3(y + coeffs.x * v,\n"
+        "                    y - coeffs.y * u - coeffs.z * v,\n"
+        "                    y + coeffs.w * u);\n" +
+        (modern ? "    FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);\n"
+                : "    gl_FragColor = vec4(clamp(rgb, 0.0, 1.0), 1.0);\n") +
+        "}\n";
+
+    if (modern)
+    {
+        return version + (isES ? "\nprecision mediump float;\n" : " core\n") +
+               "in vec2 TexCoord;\n" + body;
+    }
+    return version + "\n" + (isES ? "precision mediump float;\n" : "") +
+           "varying vec2 TexCoord;\n" + body;
+}
+
+GLuint compileShader(GLenum type, const std::string &source)
+{
+    const char *src = source.c_str();
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &src, nullptr);
+    glCompileShader(shader);
+    GLint ok = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+    if (!ok)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+        LOG_ERROR("YUVRenderPass: shader compile failed: " + std::string(infoLog));
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+} // namespace
+
+YUVRenderPass::~YUVRenderPass()
+{
+    shutdown();
+}
+
+bool YUVRenderPass::init()
+{
+    if (m_program != 0)
+    {
+        return true;
+    }
+
+    const bool isES = isOpenGLES();
+    const int major = getOpenGLMajorVersion();
+    if (major >= 3)
+    {
+        m_planeInternalFormat = GL_R8;
+        m_planeFormat = GL_RED;
+        m_pairInternalFormat = GL_RG8;
+        m_pairFormat = GL_RG;
+    }
+    else
+    {
+        m_planeInternalFormat = GL_LUMINANCE;
+        m_planeFormat = GL_LUMINANCE;
+        m_pairInternalFormat = GL_LUMINANCE_ALPHA;
+        m_pairFormat = GL_LUMINANCE_ALPHA;
+    }
+    m_hasUnpackRowLength = !(isES && major < 3);
+
+    if (!createProgram())
+    {
+        return false;
+    }
+    createQuad();
+    glGenFramebuffers(1, &m_fbo);
+    glGenTextures(3, m_planeTex);
+
+    LOG_INFO("YUVRenderPass inicializado (planos " +
+             std::string(m_planeFormat == GL_RED ? "GL_R8" : "GL_LUMINANCE") + ")");
+    return true;
+}
+
+void YUVRenderPass::shutdown()
+{
+    if (m_program == 0)
+    {
+        return;
+    }
+    glDeleteTextures(3, m_planeTex);
+    for (int i = 0; i < 3; ++i)
+    {
+        m_planeTex[i] = 0;
+        m_planeWidth[i] = 0;
+        m_planeHeight[i] = 0;
+        m_planeChannels[i] = 0;
+    }
+    if (m_fbo)
+    {
+        glDeleteFramebuffers(1, &m_fbo);
+        m_fbo = 0;
+    }
+    m_attachedTexture = 0;
+    if (m_VAO)
+    {
+        glDeleteVertexArrays(1, &m_VAO);
+        m_VAO = 0;
+    }
+    if (m_VBO)
+    {
+        glDeleteBuffers(1, &m_VBO);
+        m_VBO = 0;
+    }
+    if (m_EBO)
+    {
+        glDeleteBuffers(1, &m_EBO);
+        m_EBO = 0;
+    }
+    glDeleteProgram(m_program);
+    m_program = 0;
+}
+
+bool YUVRenderPass::createProgram()
+{
+    GLuint vs = compileShader(GL_VERTEX_SHADER, buildVertexShader());
+    if (!vs)
+    {
+        return false;
+    }
+    GLuint fs = compileShader(GL_FRAGMENT_SHADER, buildFragmentShader());
+    if (!fs)
+    {
+        glDeleteShader(vs);
+        return false;
+    }
+
+    m_program = glCreateProgram();
+    glAttachShader(m_program, vs);
+    glAttachShader(m_program, fs);
+    // No layout qualifiers in the shaders (they must build on GLSL 1.x too),
+    // so pin the attribute slots the quad uses before linking.
+    glBindAttribLocation(m_program, 0, "aPos");
+    glBindAttribLocation(m_program, 1, "aTexCoord");
+    glLinkProgram(m_program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    GLint ok = 0;
+    glGetProgramiv(m_program, GL_LINK_STATUS, &ok);
+    if (!ok)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(m_program, sizeof(infoLog), nullptr, infoLog);
+        LOG_ERROR("YUVRenderPass: program link failed: " + std::string(infoLog));
+        glDeleteProgram(m_program);
+        m_program = 0;
+        return false;
+    }
+
+    m_locPlane[0] = glGetUniformLocation(m_program, "planeY");
+    m_locPlane[1] = glGetUniformLocation(m_program, "planeU");
+    m_locPlane[2] = glGetUniformLocation(m_program, "planeV");
+    m_locYOffset = glGetUniformLocation(m_program, "yOffset");
+    m_locYScale = glGetUniformLocation(m_program, "yScale");
+    m_locCScale = glGetUniformLocation(m_program, "cScale");
+    m_locCoeffs = glGetUniformLocation(m_program, "coeffs");
+    m_locFlipY = glGetUniformLocation(m_program, "flipY");
+    m_locInterleaved = glGetUniformLocation(m_program, "interleaved");
+    return true;
+}
+
+void YUVRenderPass::createQuad()
+{
+    float vertices[] = {
+        // Posições      // TexCoords
+        -1.0f, -1.0f,    0.0f, 0.0f,
+         1.0f, -1.0f,    1.0f, 0.0f,
+         1.0f,  1.0f,    1.0f, 1.0f,
+        -1.0f,  1.0f,    0.0f, 1.0f
+    };
+    unsigned int indices[] = {
+        0, 1, 2,
+        2, 3, 0
+    };
+
+    glGenVertexArrays(1, &m_VAO);
+    glGenBuffers(1, &m_VBO);
+    glGenBuffers(1, &m_EBO);
+    glBindVertexArray(m_VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void *)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
+
+void YUVRenderPass::uploadPlane(int index, const uint8_t *data, int linesize, uint32_t width, uint32_t height,
+                                int channels)
+{
+    glActiveTexture(GL_TEXTURE0 + index);
+    glBindTexture(GL_TEXTURE_2D, m_planeTex[index]);
+
+    const GLint internalFormat = (channels == 2) ? m_pairInternalFormat : m_planeInternalFormat;
+    const GLenum format = (channels == 2) ? m_pairFormat : m_planeFormat;
+    const size_t rowBytes = static_cast<size_t>(width) * channels;
+
+    // Padded rows: GL_UNPACK_ROW_LENGTH (in texels) where available, else
+    // repack into a tight buffer (ES 2.0 only — one memcpy per row).
+    const uint8_t *src = data;
+    bool rowLengthSet = false;
+    if (linesize != static_cast<int>(rowBytes))
+    {
+        if (m_hasUnpackRowLength && linesize % channels == 0)
+        {
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, linesize / channels);
+            rowLengthSet = true;
+        }
+        else
+        {
+            m_repackBuffer.resize(rowBytes * height);
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                std::memcpy(m_repackBuffer.data() + static_cast<size_t>(y) * rowBytes,
+                            data + static_cast<size_t>(y) * linesize, rowBytes);
+            }
+            src = m_repackBuffer.data();
+        }
+    }
+
+    if (m_planeWidth[index] != width || m_planeHeight[index] != height || m_planeChannels[index] != channels)
+    {
+        // Chroma planes are sampled with GL_LINEAR so 4:2:x upsamples
+        // smoothly; luma is 1:1 with the target unless the caller asked
+        // for a different output size, where bilinear is what we want.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0,
+                     format, GL_UNSIGNED_BYTE, src);
+        m_planeWidth[index] = width;
+        m_planeHeight[index] = height;
+        m_planeChannels[index] = channels;
+    }
+    else
+    {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, src);
+    }
+
+    if (rowLengthSet)
+    {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+}
+
+bool YUVRenderPass::render(const Planes &planes, GLuint targetTexture)
+{
+    if (m_program == 0 || targetTexture == 0 || planes.width == 0 || planes.height == 0 ||
+        planes.chromaWidth == 0 || planes.chromaHeight == 0 ||
+        !planes.data[0] || !planes.data[1] || (!planes.interleavedChroma && !planes.data[2]))
+    {
+        return false;
+    }
+
+    GLint prevFbo = 0;
+    GLint prevViewport[4] = {0, 0, 0, 0};
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+
+    // Plane widths are arbitrary (odd chroma widths are common).
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    uploadPlane(0, planes.data[0], planes.linesize[0], planes.width, planes.height);
+    if (planes.interleavedChroma)
+    {
+        // planeV stays bound to whatever it last held; the shader
+        // doesn't use it (interleaved = 1).
+        uploadPlane(1, planes.data[1], planes.linesize[1], planes.chromaWidth, planes.chromaHeight, 2);
+    }
+    else
+    {
+        uploadPlane(1, planes.data[1], planes.linesize[1], planes.chromaWidth, planes.chromaHeight);
+        uploadPlane(2, planes.data[2], planes.linesize[2], planes.chromaWidth, planes.chromaHeight);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_fbo);
+    if (m_attachedTexture != targetTexture)
+    {
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targetTexture, 0);
+        const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+        {
+            LOG_ERROR("YUVRenderPass: framebuffer incompleto (status " + std::to_string(status) + ")");
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+            m_attachedTexture = 0;
+            glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+            return false;
+        }
+        m_attachedTexture = targetTexture;
+    }
+
+    const uint32_t outWidth = planes.outputWidth ? planes.outputWidth : planes.width;
+    const uint32_t outHeight = planes.outputHeight ? planes.outputHeight : planes.height;
+    glViewport(0, 0, static_cast<GLsizei>(outWidth), static_cast<GLsizei>(outHeight));
+    glUseProgram(m_program);
+    glUniform1f(m_locFlipY, planes.flipVertical ? 1.0f : 0.0f);
+    glUniform1f(m_locInterleaved, planes.interleavedChroma ? 1.0f : 0.0f);
+
+    // Kr/Kb per matrix; the four coefficients are the standard derivation
+    // R = Y + 2(1-Kr)·Cr, B = Y + 2(1-Kb)·Cb, G from the luma identity.
+    const float kr = (planes.matrix == ColorMatrix::BT709) ? 0.2126f : 0.299f;
+    const float kb = (planes.matrix == ColorMatrix::BT709) ? 0.0722f : 0.114f;
+    const float kg = 1.0f - kr - kb;
+    glUniform4f(m_locCoeffs,
+                2.0f * (1.0f - kr),
+                2.0f * kb * (1.0f - kb) / kg,
+                2.0f * kr * (1.0f - kr) / kg,
+                2.0f * (1.0f - kb));
+    if (planes.fullRange)
+    {
+        glUniform1f(m_locYOffset, 0.0f);
+        glUniform1f(m_locYScale, 1.0f);
+        glUniform1f(m_locCScale, 1.0f);
+    }
+    else
+    {
+        glUniform1f(m_locYOffset, 16.0f / 255.0f);
+        glUniform1f(m_locYScale, 255.0f / 219.0f);
+        glUniform1f(m_locCScale, 255.0f / 224.0f);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        glUniform1i(m_locPlane[i], i);
+    }
+
+    glBindVertexArray(m_VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+
+    // Leave unit 0 active — the rest of the pipeline binds there without
+    // re-selecting the unit.
+    glActiveTexture(GL_TEXTURE0);
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFbo));
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "glad_loader.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * GPU YUV→RGB conversion pass.
+ *
+ * Uploads the planes of a planar YUV image (4:2:0 / 4:2:2 / 4:4:4 / 4:4:0,
+ * 8-bit) as single-channel textures — or, for NV12, luma plus one
+ * two-channel CbCr texture — and renders them into an RGBA target
+ * texture through an FBO. Used by decoders that produce planar YUV (MJPEG
+ * capture) so the colour conversion runs on the GPU instead of a per-pixel
+ * CPU pass followed by an RGB upload — the planes are also 1.5–2 bytes per
+ * pixel instead of 3, so the upload itself is smaller.
+ *
+ * Orientation matches FrameProcessor's CPU uploads: row 0 of the source
+ * lands in row 0 of the target texture (unless Planes::flipVertical).
+ * The target may be larger or smaller than the planes; the planes are
+ * then sampled bilinearly.
+ *
+ * MUST be used on the GL thread.
+ */
+class YUVRenderPass
+{
+public:
+    enum class ColorMatrix
+    {
+        BT601,
+        BT709
+    };
+
+    struct Planes
+    {
+        const uint8_t *data[3] = {nullptr, nullptr, nullptr};
+        int linesize[3] = {0, 0, 0};
+        uint32_t width = 0;        // luma
+        uint32_t height = 0;
+        uint32_t chromaWidth = 0;  // U/V plane size (CbCr pairs when interleaved)
+        uint32_t chromaHeight = 0;
+        bool interleavedChroma = false; // NV12: CbCr pairs in data[1], data[2] unused
+        bool fullRange = true;     // JPEG (0–255) vs. video (16–235) levels
+        ColorMatrix matrix = ColorMatrix::BT601;
+        uint32_t outputWidth = 0;  // target size; 0 = luma size
+        uint32_t outputHeight = 0;
+        bool flipVertical = false; // last source row lands in target row 0
+    };
+
+    YUVRenderPass() = default;
+    ~YUVRenderPass();
+
+    bool init();
+    void shutdown();
+    bool isInitialized() const { return m_program != 0; }
+
+    /**
+     * Upload the planes and convert them into targetTexture, which must
+     * already have RGBA storage of the output size (outputWidth x
+     * outputHeight, or the luma size when those are 0).
+     * Restores the previously bound framebuffer and viewport.
+     */
+    bool render(const Planes &planes, GLuint targetTexture);
+
+private:
+    GLuint m_program = 0;
+    GLuint m_VAO = 0;
+    GLuint m_VBO = 0;
+    GLuint m_EBO = 0;
+    GLuint m_fbo = 0;
+    GLuint m_attachedTexture = 0;
+    GLuint m_planeTex[3] = {0, 0, 0};
+    uint32_t m_planeWidth[3] = {0, 0, 0};
+    uint32_t m_planeHeight[3] = {0, 0, 0};
+    int m_planeChannels[3] = {0, 0, 0};
+
+    GLint m_locPlane[3] = {-1, -1, -1};
+    GLint m_locYOffset = -1;
+    GLint m_locYScale = -1;
+    GLint m_locCScale = -1;
+    GLint m_locCoeffs = -1;
+    GLint m_locFlipY = -1;
+    GLint m_locInterleaved = -1;
+
+    // Single-channel texture format: GL_R8/GL_RED on GL3+/ES3, GL_LUMINANCE
+    // on GL 2.1 / ES 2.0 (where GL_RED textures aren't available).
+    GLint m_planeInternalFormat = GL_LUMINANCE;
+    GLenum m_planeFormat = GL_LUMINANCE;
+    // Two-channel (CbCr) equivalent: GL_RG8/GL_RG, or GL_LUMINANCE_ALPHA.
+    GLint m_pairInternalFormat = GL_LUMINANCE_ALPHA;
+    GLenum m_pairFormat = GL_LUMINANCE_ALPHA;
+    // ES 2.0 has no GL_UNPACK_ROW_LENGTH; padded rows get repacked there.
+    bool m_hasUnpackRowLength = true;
+    std::vector<uint8_t> m_repackBuffer;
+
+    bool createProgram();
+    void createQuad();
+    // channels: 1 for Y/U/V, 2 for an interleaved CbCr plane.
+    void uploadPlane(int index, const uint8_t *data, int linesize, uint32_t width, uint32_t height,
+                     int channels = 1);
+};
@@ -62,6 +62,17 @@ void (*glUniform3f)(GLint, GLfloat, GLfloat, GLfloat) = nullptr;
 void (*glUniform4f)(GLint, GLfloat, GLfloat, GLfloat, GLfloat) = nullptr;
 void (*glUniformMatrix4fv)(GLint, GLsizei, GLboolean, const GLfloat *) = nullptr;
 void (*glGetIntegerv)(GLenum, GLint*) = nullptr;
+GLsync (*glFenceSync)(GLenum, GLbitfield) = nullptr;
+GLenum (*glClientWaitSync)(GLsync, GLbitfield, GLuint64) = nullptr;
+void (*glDeleteSync)(GLsync) = nullptr;
+void (*glGetProgramBinary)(GLuint, GLsizei, GLsizei *, GLenum *, void *) = nullptr;
+void (*glProgramBinary)(GLuint, GLenum, const void *, GLsizei) = nullptr;
+void (*glProgramParameteri)(GLuint, GLenum, GLint) = nullptr;
+const GLubyte *(*glGetStringi)(GLenum, GLuint) = nullptr;
+void (*glMaxShaderCompilerThreadsKHR)(GLuint) = nullptr;
+
+// Resolvido uma vez em loadOpenGLFunctions()
+static bool s_parallelShaderCompile = false;
 
 // Funções básicas (glViewport, glClearColor, glClear, glDrawElements) são do OpenGL 1.x/2.x
 // e estão linkadas estaticamente via OpenGL::GL - não precisam ser declaradas aqui
@@ -84,6 +95,8 @@ bool loadOpenGLFunctions()
         LOG_ERROR("Failed to load OpenGL function: " #name);           \
         return false;                                                   \
     }
+#define LOAD_OPTIONAL_FUNC(name) \
+    name = reinterpret_cast<decltype(name)>(SDL_GL_GetProcAddress(#name));
 #else
     // GLFW: Carregar funções via glfwGetProcAddress (forma recomendada)
     // Isso funciona tanto com OpenGL quanto com OpenGL ES
@@ -102,6 +115,8 @@ bool loadOpenGLFunctions()
         LOG_ERROR("Failed to load OpenGL function: " #name);           \
         return false;                                                   \
     }
+#define LOAD_OPTIONAL_FUNC(name) \
+    name = reinterpret_cast<decltype(name)>(glfwGetProcAddress(#name));
 #endif
 
     // Funções OpenGL 3.3+ Core (precisam ser carregadas dinamicamente)
@@ -160,6 +175,52 @@ bool loadOpenGLFunctions()
     // glGetIntegerv - carregar dinamicamente para garantir compatibilidade
     LOAD_FUNC(glGetIntegerv)
 
+    // Sync objects — opcionais. Sem elas o PBOManager volta ao
+    // agendamento por contagem de frames (ver PBOManager::slotReady).
+    LOAD_OPTIONAL_FUNC(glFenceSync)
+    LOAD_OPTIONAL_FUNC(glClientWaitSync)
+    LOAD_OPTIONAL_FUNC(glDeleteSync)
+    if (!hasFenceSync())
+    {
+        glFenceSync = nullptr;
+        glClientWaitSync = nullptr;
+        glDeleteSync = nullptr;
+        LOG_INFO("OpenGL sync objects not available - PBO readback without fences");
+    }
+
+    // Program binaries — opcionais. Sem elas o ShaderProgramCache fica
+    // desligado e todo preset compila do fonte.
+    LOAD_OPTIONAL_FUNC(glGetProgramBinary)
+    LOAD_OPTIONAL_FUNC(glProgramBinary)
+    LOAD_OPTIONAL_FUNC(glProgramParameteri)
+    if (!hasProgramBinary())
+    {
+        glGetProgramBinary = nullptr;
+        glProgramBinary = nullptr;
+        glProgramParameteri = nullptr;
+        LOG_INFO("OpenGL program binaries not available - shader cache disabled");
+    }
+
+    // Compilação paralela — opcional. Sem ela o ShaderEngine compila um
+    // pass por frame ao carregar presets em segundo plano.
+    LOAD_OPTIONAL_FUNC(glGetStringi)
+    LOAD_OPTIONAL_FUNC(glMaxShaderCompilerThreadsKHR)
+    s_parallelShaderCompile = hasGLExtension("GL_KHR_parallel_shader_compile") ||
+                              hasGLExtension("GL_ARB_parallel_shader_compile");
+    if (s_parallelShaderCompile)
+    {
+        if (glMaxShaderCompilerThreadsKHR)
+        {
+            // 0xFFFFFFFF = quantas threads o driver quiser
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+        }
+        LOG_INFO("OpenGL parallel shader compile available");
+    }
+    else
+    {
+        glMaxShaderCompilerThreadsKHR = nullptr;
+    }
+
     // glEnable, glDisable, glBlendFunc são funções do OpenGL 1.x/2.x
     // e estão disponíveis estaticamente - não precisam ser carregadas dinamicamente
 
@@ -167,6 +228,7 @@ bool loadOpenGLFunctions()
     // e estão linkadas estaticamente - não precisam ser carregadas dinamicamente
 
 #undef LOAD_FUNC
+#undef LOAD_OPTIONAL_FUNC
 
     // Verificar se as funções críticas foram carregadas
     if (!glGenVertexArrays || !glGenBuffers || !glCreateShader || !glCreateProgram)
@@ -179,6 +241,69 @@ bool loadOpenGLFunctions()
     return true;
 }
 
+bool hasFenceSync()
+{
+    return glFenceSync && glClientWaitSync && glDeleteSync;
+}
+
+bool hasProgramBinary()
+{
+    if (!glGetProgramBinary || !glProgramBinary || !glProgramParameteri)
+    {
+        return false;
+    }
+    // Alguns drivers expõem as funções mas nenhum formato (Mesa antigo)
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+bool hasGLExtension(const char *name)
+{
+    const std::string needle = name;
+    GLint count = 0;
+    if (glGetStringi)
+    {
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    }
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char *ext = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (ext && needle == ext)
+        {
+            return true;
+        }
+    }
+    if (count > 0)
+    {
+        return false;
+    }
+
+    // Contextos legados / ES 2.0: uma string separada por espaços
+    const char *raw = reinterpret_cast<const char *>(glGetString(GL_EXTENSIONS));
+    if (!raw)
+    {
+        return false;
+    }
+    const std::string extStr = raw;
+    size_t pos = 0;
+    while ((pos = extStr.find(needle, pos)) != std::string::npos)
+    {
+        const size_t endPos = pos + needle.size();
+        if ((pos == 0 || extStr[pos - 1] == ' ') && (endPos == extStr.size() || extStr[endPos] == ' '))
+        {
+            return true;
+        }
+        pos = endPos;
+    }
+    return false;
+}
+
+bool hasParallelShaderCompile()
+{
+    return s_parallelShaderCompile;
+}
+
 // Funções para detectar versão OpenGL
 bool isOpenGLES()
 {
@@ -30,6 +30,8 @@ typedef double GLclampd;
 typedef void GLvoid;
 typedef char GLchar;
 typedef ptrdiff_t GLsizeiptr;
+typedef unsigned long long GLuint64;
+typedef struct __GLsync *GLsync;
 
 // Funções OpenGL 3.3 Core
 extern GLuint (*glCreateShader)(GLenum type);
@@ -80,6 +82,26 @@ extern void (*glUniform3f)(GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
 extern void (*glUniform4f)(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
 extern void (*glUniformMatrix4fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
 
+// Sync objects (GL 3.2 / ARB_sync / GLES 3.0). OPCIONAIS: ficam nullptr em
+// contextos 2.1/ES 2.0 — checar com hasFenceSync() antes de usar.
+extern GLsync (*glFenceSync)(GLenum condition, GLbitfield flags);
+extern GLenum (*glClientWaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
+extern void (*glDeleteSync)(GLsync sync);
+
+// Program binaries (GL 4.1 / ARB_get_program_binary / GLES 3.0). OPCIONAIS:
+// checar com hasProgramBinary() — sem elas o ShaderProgramCache fica inativo.
+extern void (*glGetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+extern void (*glProgramBinary)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+extern void (*glProgramParameteri)(GLuint program, GLenum pname, GLint value);
+
+// Lista de extensões indexada (GL 3.0 / GLES 3.0) — perfis core não
+// respondem a glGetString(GL_EXTENSIONS). OPCIONAL: use hasGLExtension().
+extern const GLubyte* (*glGetStringi)(GLenum name, GLuint index);
+// KHR_parallel_shader_compile. OPCIONAL: checar com hasParallelShaderCompile().
+// Mesmo com a extensão a função pode faltar (a variante ARB); aí o driver
+// usa o número de threads padrão.
+extern void (*glMaxShaderCompilerThreadsKHR)(GLuint count);
+
 // Funções básicas do OpenGL 1.x/2.x - usamos as versões estáticas linkadas
 // Declarações forward (implementações vêm do OpenGL linkado estaticamente)
 #ifdef __cplusplus
@@ -96,6 +118,7 @@ void glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format
 void glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
 void glFinish(void);
 void glFlush(void);
+void glPixelStorei(GLenum pname, GLint param);
 #ifdef __cplusplus
 }
 #endif
@@ -154,6 +177,14 @@ extern void (*glGetIntegerv)(GLenum pname, GLint* params);
 #define GL_PIXEL_PACK_BUFFER 0x88EB
 #define GL_STREAM_READ 0x88E1
 #define GL_READ_ONLY 0x88B8
+
+// Sync objects
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_WAIT_FAILED 0x911D
 #define GL_DEPTH_TEST 0x0B71
 #define GL_ACTIVE_UNIFORMS 0x8B86
 #define GL_FLOAT_VEC2 0x8B50
@@ -167,6 +198,23 @@ extern void (*glGetIntegerv)(GLenum pname, GLint* params);
 #define GL_SHADING_LANGUAGE_VERSION 0x8B8C
 #define GL_MAJOR_VERSION 0x821B
 #define GL_EXTENSIONS 0x1F03
+#define GL_VENDOR 0x1F00
+#define GL_RENDERER 0x1F01
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_NUM_EXTENSIONS 0x821D
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+
+// Texturas de um canal / upload de planos YUV
+#define GL_RED 0x1903
+#define GL_R8 0x8229
+#define GL_LUMINANCE 0x1909
+#define GL_RG 0x8227
+#define GL_RG8 0x822B
+#define GL_LUMINANCE_ALPHA 0x190A
+#define GL_UNPACK_ALIGNMENT 0x0CF5
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
 
 // Funções básicas do OpenGL que podem estar disponíveis estaticamente
 // glGetString está disponível desde OpenGL 1.0, então pode ser linkado estaticamente
@@ -192,4 +240,14 @@ std::string getGLSLVersionString();
 bool isOpenGLES();
 // Retorna a versão major do OpenGL (3, 2, etc.)
 int getOpenGLMajorVersion();
+// Retorna true se glFenceSync/glClientWaitSync/glDeleteSync foram carregadas
+bool hasFenceSync();
+// Retorna true se glGetProgramBinary/glProgramBinary/glProgramParameteri
+// foram carregadas e o driver oferece ao menos um formato de binário
+bool hasProgramBinary();
+// Retorna true se o contexto expõe a extensão (glGetStringi ou GL_EXTENSIONS)
+bool hasGLExtension(const char* name);
+// Retorna true se GL_COMPLETION_STATUS_KHR pode ser consultado em shaders e
+// programs (KHR/ARB_parallel_shader_compile) — compile/link não bloqueiam
+bool hasParallelShaderCompile();
 
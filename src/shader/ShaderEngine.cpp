@@ -2,14 +2,17 @@
 #include "ShaderPreprocessor.h"
 #include "../utils/Logger.h"
 #include "../utils/FilesystemCompat.h"
+#include "../utils/Paths.h"
 #include "../renderer/glad_loader.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <initializer_list>
 #include <regex>
 #include <set>
+#include <utility>
 #include <vector>
 #include <png.h>
 #include <cstdlib>
@@ -42,6 +45,15 @@ bool ShaderEngine::init()
     // Não há valores padrão hardcoded - o usuário define conforme necessário
 
     createQuad();
+
+    // Cache de programas linkados: trocar de preset não recompila o que
+    // já foi compilado antes com o mesmo driver
+    const std::string cacheDir = Paths::getCacheDir();
+    if (!cacheDir.empty())
+    {
+        m_programCache.init((fs::path(cacheDir) / "shaders").string());
+    }
+
     m_initialized = true;
     LOG_INFO("ShaderEngine initialized");
     return true;
@@ -70,16 +82,14 @@ void ShaderEngine::shutdown()
     }
 
     disableShader();
+    if (m_loadThread.joinable())
+    {
+        m_loadThread.join();
+    }
+    m_loadJob.reset();
     cleanupPresetPasses();
     cleanupTextureReferences();
     cleanupQuad();
-    
-    // Limpar framebuffer temporário reutilizável
-    if (m_copyFramebuffer != 0)
-    {
-        glDeleteFramebuffers(1, &m_copyFramebuffer);
-        m_copyFramebuffer = 0;
-    }
 
     m_initialized = false;
     LOG_INFO("ShaderEngine shutdown");
@@ -236,23 +246,11 @@ bool ShaderEngine::loadPreset(const std::string &presetPath)
     disableShader();
     cleanupPresetPasses();
 
-    // Verificar extensão - apenas GLSLP é suportado
-    fs::path presetFilePath(presetPath);
-    std::string extension = presetFilePath.extension();
-    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
-
-    if (extension == ".slangp")
+    if (!checkPresetExtension(presetPath))
     {
-        LOG_ERROR("Slang presets (.slangp) are not supported. Use GLSLP presets (.glslp)");
-        LOG_ERROR("Many RetroArch presets are available in GLSLP format in the shaders/shaders_glsl/ folder");
         return false;
     }
 
-    if (extension != ".glslp" && !extension.empty())
-    {
-        LOG_WARN("Unrecognized preset extension: " + extension + ". Expected .glslp");
-    }
-
     m_customParameters.clear(); // Limpar parâmetros customizados ao carregar novo preset
 
     if (!m_preset.load(presetPath))
@@ -318,6 +316,398 @@ bool ShaderEngine::loadPreset(const std::string &presetPath)
     return true;
 }
 
+bool ShaderEngine::checkPresetExtension(const std::string &presetPath)
+{
+    // Verificar extensão - apenas GLSLP é suportado
+    fs::path presetFilePath(presetPath);
+    std::string extension = presetFilePath.extension();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+    if (extension == ".slangp")
+    {
+        LOG_ERROR("Slang presets (.slangp) are not supported. Use GLSLP presets (.glslp)");
+        LOG_ERROR("Many RetroArch presets are available in GLSLP format in the shaders/shaders_glsl/ folder");
+        return false;
+    }
+
+    if (extension != ".glslp" && !extension.empty())
+    {
+        LOG_WARN("Unrecognized preset extension: " + extension + ". Expected .glslp");
+    }
+    return true;
+}
+
+bool ShaderEngine::loadPresetAsync(const std::string &presetPath, const std::map<std::string, float> &initialParameters)
+{
+    if (!m_initialized)
+    {
+        LOG_ERROR("ShaderEngine not initialized");
+        return false;
+    }
+    if (!checkPresetExtension(presetPath))
+    {
+        return false;
+    }
+
+    auto job = std::unique_ptr<PendingPreset>(new PendingPreset());
+    job->generation = ++m_loadGeneration;
+    job->path = presetPath;
+    job->parameters = initialParameters;
+    m_pendingPresetPath = presetPath;
+
+    // Um pedido anterior ainda compilando na thread GL não será mais usado
+    if (m_pendingPreset)
+    {
+        releasePendingPreset(*m_pendingPreset);
+        m_pendingPreset.reset();
+    }
+
+    if (m_loadThread.joinable())
+    {
+        // Thread ocupada (ou terminou e ainda não foi recolhida): o pedido
+        // atual dela é descartado pela geração e este roda em seguida
+        m_queuedLoad = std::move(job);
+    }
+    else
+    {
+        startLoadThread(std::move(job));
+    }
+    LOG_INFO("Loading preset in background: " + presetPath);
+    return true;
+}
+
+bool ShaderEngine::setPendingPresetParameter(const std::string &name, float value)
+{
+    // O pedido corrente é o da última geração, em qualquer estágio; a thread
+    // de carga não toca em parameters, só a ativação (thread GL)
+    const uint64_t generation = m_loadGeneration.load();
+    for (PendingPreset *job : {m_queuedLoad.get(), m_pendingPreset.get(), m_loadJob.get()})
+    {
+        if (job && job->generation == generation)
+        {
+            job->parameters[name] = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ShaderEngine::startLoadThread(std::unique_ptr<PendingPreset> job)
+{
+    // Consultas GL feitas aqui; a thread de carga não tem contexto
+    const ShaderPreprocessor::ContextInfo context = ShaderPreprocessor::queryContext();
+    m_loadJob = std::move(job);
+    m_loadThreadDone.store(false, std::memory_order_relaxed);
+    PendingPreset *jobPtr = m_loadJob.get();
+    m_loadThread = std::thread([this, jobPtr, context]()
+                               {
+        preparePendingPreset(*jobPtr, context, m_loadGeneration);
+        m_loadThreadDone.store(true, std::memory_order_release); });
+}
+
+void ShaderEngine::preparePendingPreset(PendingPreset &job, const ShaderPreprocessor::ContextInfo &context,
+                                        const std::atomic<uint64_t> &generation)
+{
+    if (!job.preset.load(job.path))
+    {
+        return;
+    }
+
+    const auto &passes = job.preset.getPasses();
+    job.sources.resize(passes.size());
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        if (generation.load(std::memory_order_relaxed) != job.generation)
+        {
+            return; // Substituído por outro pedido, parar cedo
+        }
+        preparePassSource(i, passes[i], passes, context, job.sources[i]);
+    }
+
+    for (const auto &tex : job.preset.getTextures())
+    {
+        DecodedTexture image;
+        if (decodeTextureReference(tex.first, tex.second.path, image))
+        {
+            job.textures.push_back(std::move(image));
+        }
+        else
+        {
+            LOG_ERROR("Failed to load reference texture: " + tex.first);
+        }
+    }
+    job.parsed = true;
+}
+
+void ShaderEngine::pollPendingPreset()
+{
+    if (m_loadThread.joinable() && m_loadThreadDone.load(std::memory_order_acquire))
+    {
+        m_loadThread.join();
+        std::unique_ptr<PendingPreset> job = std::move(m_loadJob);
+        if (job->generation == m_loadGeneration.load())
+        {
+            if (job->parsed)
+            {
+                const auto &passes = job->preset.getPasses();
+                job->passes.resize(passes.size());
+                job->cacheKeys.resize(passes.size());
+                job->compiling.assign(passes.size(), false);
+                for (size_t i = 0; i < passes.size(); ++i)
+                {
+                    job->passes[i].passInfo = passes[i];
+                    job->passes[i].extractedParameters = job->sources[i].extractedParameters;
+                    job->passes[i].parameterInfo = job->sources[i].parameterInfo;
+                }
+                m_pendingPreset = std::move(job);
+            }
+            else
+            {
+                LOG_ERROR("Failed to load preset: " + job->path + " (keeping current shader)");
+                m_pendingPresetPath.clear();
+            }
+        }
+        if (m_queuedLoad)
+        {
+            startLoadThread(std::move(m_queuedLoad));
+        }
+    }
+
+    if (!m_pendingPreset)
+    {
+        return;
+    }
+    if (m_pendingPreset->generation != m_loadGeneration.load())
+    {
+        releasePendingPreset(*m_pendingPreset);
+        m_pendingPreset.reset();
+        return;
+    }
+    if (!advancePendingPreset(*m_pendingPreset))
+    {
+        return;
+    }
+
+    std::unique_ptr<PendingPreset> pending = std::move(m_pendingPreset);
+    m_pendingPresetPath.clear();
+    if (pending->failed)
+    {
+        LOG_ERROR("Preset failed to compile: " + pending->path + " (keeping current shader)");
+        releasePendingPreset(*pending);
+        return;
+    }
+    activatePendingPreset(*pending);
+}
+
+bool ShaderEngine::advancePendingPreset(PendingPreset &pending)
+{
+    const size_t count = pending.passes.size();
+
+    if (!hasParallelShaderCompile())
+    {
+        // Sem compilação paralela cada pass bloqueia o driver: um por
+        // frame, para o preset atual continuar fluindo entre eles
+        if (pending.nextPass < count)
+        {
+            const size_t i = pending.nextPass++;
+            if (!pending.sources[i].ok ||
+                !linkPassProgram(i, pending.passes[i].passInfo, pending.sources[i].vertexSource,
+                                 pending.sources[i].fragmentSource, pending.passes[i]))
+            {
+                pending.failed = true;
+            }
+        }
+        return pending.failed || pending.nextPass >= count;
+    }
+
+    // KHR_parallel_shader_compile: dispara tudo de uma vez e consulta
+    // GL_COMPLETION_STATUS_KHR a cada frame, sem bloquear
+    if (!pending.linksIssued)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            issuePendingLink(pending, i);
+        }
+        pending.linksIssued = true;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!pending.compiling[i])
+        {
+            continue;
+        }
+        GLint done = GL_FALSE;
+        glGetProgramiv(pending.passes[i].program, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done)
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!finishPendingLink(pending, i))
+        {
+            pending.failed = true;
+        }
+    }
+    return true;
+}
+
+void ShaderEngine::issuePendingLink(PendingPreset &pending, size_t i)
+{
+    const PreparedPassSource &source = pending.sources[i];
+    ShaderPassData &passData = pending.passes[i];
+    if (!source.ok)
+    {
+        return;
+    }
+
+    if (m_programCache.isEnabled())
+    {
+        const std::string key = m_programCache.key(source.vertexSource, source.fragmentSource);
+        GLuint cachedProgram = m_programCache.load(key, source.vertexSource, source.fragmentSource);
+        if (cachedProgram != 0)
+        {
+            passData.program = cachedProgram;
+            passData.floatFramebuffer = passData.passInfo.floatFramebuffer;
+            return;
+        }
+        pending.cacheKeys[i] = key;
+    }
+
+    // Sem consultar status aqui: isso bloquearia até o driver terminar
+    const char *vsSrc = source.vertexSource.c_str();
+    const char *fsSrc = source.fragmentSource.c_str();
+    passData.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(passData.vertexShader, 1, &vsSrc, nullptr);
+    glCompileShader(passData.vertexShader);
+    passData.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(passData.fragmentShader, 1, &fsSrc, nullptr);
+    glCompileShader(passData.fragmentShader);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, passData.vertexShader);
+    glAttachShader(program, passData.fragmentShader);
+    bindPassAttribLocations(program);
+    m_programCache.prepareProgram(program);
+    glLinkProgram(program);
+    passData.program = program;
+    pending.compiling[i] = true;
+}
+
+bool ShaderEngine::finishPendingLink(PendingPreset &pending, size_t i)
+{
+    const PreparedPassSource &source = pending.sources[i];
+    ShaderPassData &passData = pending.passes[i];
+    if (!source.ok)
+    {
+        return false;
+    }
+    if (!pending.compiling[i])
+    {
+        return passData.program != 0; // Veio do cache
+    }
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(passData.program, GL_LINK_STATUS, &linked);
+    if (linked)
+    {
+        passData.floatFramebuffer = passData.passInfo.floatFramebuffer;
+        if (!pending.cacheKeys[i].empty())
+        {
+            m_programCache.store(pending.cacheKeys[i], source.vertexSource, source.fragmentSource, passData.program);
+        }
+        return true;
+    }
+
+    // Falhou: refazer pelo caminho síncrono, que registra o erro e tenta a
+    // correção vec3 = COMPAT_TEXTURE(...) (raro; bloqueia só neste caso)
+    deleteProgram(passData.program);
+    glDeleteShader(passData.vertexShader);
+    glDeleteShader(passData.fragmentShader);
+    passData.program = 0;
+    passData.vertexShader = 0;
+    passData.fragmentShader = 0;
+    return linkPassProgram(i, passData.passInfo, source.vertexSource, source.fragmentSource, passData);
+}
+
+void ShaderEngine::activatePendingPreset(PendingPreset &pending)
+{
+    disableShader();
+    cleanupPresetPasses();
+    cleanupTextureReferences();
+
+    m_customParameters.clear();
+    m_preset = pending.preset;
+    m_presetPath = pending.path;
+    m_passes = std::move(pending.passes);
+
+    // Upload depois de m_preset trocado: as configurações de filtro/wrap vêm dele
+    for (const auto &image : pending.textures)
+    {
+        uploadTextureReference(image);
+    }
+
+    glUseProgram(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    // Tabelas só agora: resolvem parâmetros do preset e LUTs novos
+    size_t totalParams = 0;
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        buildUniformTable(m_passes[i].program, &m_passes[i], i, m_passes[i].uniforms);
+        totalParams += m_passes[i].parameterInfo.size();
+    }
+    configureFrameHistory();
+
+    m_shaderActive = true;
+    for (const auto &param : pending.parameters)
+    {
+        setShaderParameter(param.first, param.second);
+    }
+
+    LOG_INFO("Preset carregado: " + m_presetPath + " (" + std::to_string(m_passes.size()) + " pass(es), " +
+             std::to_string(totalParams) + " parameter(s), compiled in background)");
+}
+
+void ShaderEngine::releasePendingPreset(PendingPreset &pending)
+{
+    for (auto &pass : pending.passes)
+    {
+        if (pass.program != 0)
+        {
+            deleteProgram(pass.program);
+            pass.program = 0;
+        }
+        if (pass.vertexShader != 0)
+        {
+            glDeleteShader(pass.vertexShader);
+            pass.vertexShader = 0;
+        }
+        if (pass.fragmentShader != 0)
+        {
+            glDeleteShader(pass.fragmentShader);
+            pass.fragmentShader = 0;
+        }
+    }
+}
+
+void ShaderEngine::cancelPendingPreset()
+{
+    // A thread de carga, se rodando, para na próxima checagem de geração;
+    // o resultado é descartado em pollPendingPreset()/shutdown()
+    ++m_loadGeneration;
+    m_queuedLoad.reset();
+    if (m_pendingPreset)
+    {
+        releasePendingPreset(*m_pendingPreset);
+        m_pendingPreset.reset();
+    }
+    m_pendingPresetPath.clear();
+}
+
 bool ShaderEngine::compilePass(size_t i)
 {
     const auto &passes = m_preset.getPasses();
@@ -330,18 +720,59 @@ bool ShaderEngine::compilePass(size_t i)
 
     passData.passInfo = passInfo;
 
-    // DEBUG: Log das configurações do pass
+    PreparedPassSource source;
+    if (!preparePassSource(i, passInfo, passes, ShaderPreprocessor::queryContext(), source))
+    {
+        // Arquivo ilegível ou Slang: manter parâmetros existentes se houver,
+        // apenas marcar que este pass não compilou
+        passData.vertexShader = 0;
+        passData.fragmentShader = 0;
+        passData.program = 0;
+        return false;
+    }
+
+    // Se já temos parameterInfo preservado e o novo está vazio, manter o preservado
+    // Caso contrário, usar o novo (que pode ter mais parâmetros)
+    if (!source.parameterInfo.empty())
+    {
+        passData.extractedParameters = source.extractedParameters;
+        passData.parameterInfo = source.parameterInfo;
+    }
+    else if (!localPreservedParamInfo.empty())
+    {
+        // Manter os parâmetros preservados se o novo está vazio
+        passData.parameterInfo = localPreservedParamInfo;
+        passData.extractedParameters = localPreservedExtractedParams;
+    }
+
+    // Log de debug: verificar se parâmetros foram extraídos
+    if (!passData.parameterInfo.empty())
+    {
+        LOG_INFO("Pass " + std::to_string(i) + " has " + std::to_string(passData.parameterInfo.size()) + " parameter(s)");
+    }
+
+    // IMPORTANTE: Os parâmetros já foram extraídos e armazenados em passData.parameterInfo
+    // Mesmo que a compilação falhe, queremos manter os parâmetros para a UI
+    if (!linkPassProgram(i, passInfo, source.vertexSource, source.fragmentSource, passData))
+    {
+        return false;
+    }
+
+    // Locations de todos os uniforms que o render alimenta, resolvidas uma vez
+    buildUniformTable(passData.program, &passData, i, passData.uniforms);
+    return true;
+}
+
+bool ShaderEngine::preparePassSource(size_t i, const ShaderPass &passInfo, const std::vector<ShaderPass> &presetPasses,
+                                     const ShaderPreprocessor::ContextInfo &context, PreparedPassSource &out)
+{
+    out = PreparedPassSource{};
 
     // Ler shader
     std::ifstream file(passInfo.shaderPath);
     if (!file.is_open())
     {
         LOG_ERROR("Failed to open shader for pass " + std::to_string(i) + ": " + passInfo.shaderPath);
-        // Se não conseguimos ler o arquivo, manter parâmetros existentes se houver
-        // Apenas marcar que este pass não compilou
-        passData.vertexShader = 0;
-        passData.fragmentShader = 0;
-        passData.program = 0;
         return false;
     }
 
@@ -359,10 +790,6 @@ bool ShaderEngine::compilePass(size_t i)
     {
         LOG_ERROR("Slang shaders (.slang) are not supported in pass " + std::to_string(i));
         LOG_ERROR("Use GLSL shaders (.glsl) or GLSLP presets (.glslp)");
-        // Slang não suportado, manter parâmetros existentes se houver
-        passData.vertexShader = 0;
-        passData.fragmentShader = 0;
-        passData.program = 0;
         return false;
     }
 
@@ -384,35 +811,57 @@ bool ShaderEngine::compilePass(size_t i)
         defaultOutputHeight,
         defaultInputWidth,
         defaultInputHeight,
-        m_preset.getPasses());
-
-    // Armazenar resultados
-    std::string vertexSource = preprocessResult.vertexSource;
-    std::string fragmentSource = preprocessResult.fragmentSource;
+        presetPasses,
+        context);
+
+    out.vertexSource = std::move(preprocessResult.vertexSource);
+    out.fragmentSource = std::move(preprocessResult.fragmentSource);
+    out.extractedParameters = std::move(preprocessResult.extractedParameters);
+    out.parameterInfo = std::move(preprocessResult.parameterInfo);
+    out.ok = true;
+    return true;
+}
 
-    // Se já temos parameterInfo preservado e o novo está vazio, manter o preservado
-    // Caso contrário, usar o novo (que pode ter mais parâmetros)
-    if (!preprocessResult.parameterInfo.empty())
-    {
-        passData.extractedParameters = preprocessResult.extractedParameters;
-        passData.parameterInfo = preprocessResult.parameterInfo;
-    }
-    else if (!localPreservedParamInfo.empty())
-    {
-        // Manter os parâmetros preservados se o novo está vazio
-        passData.parameterInfo = localPreservedParamInfo;
-        passData.extractedParameters = localPreservedExtractedParams;
-    }
+void ShaderEngine::bindPassAttribLocations(GLuint program)
+{
+    // Ligar atributos antes de linkar (necessário quando não usamos layout(location))
+    // RetroArch shaders podem usar VertexCoord ou Position
+    glBindAttribLocation(program, 0, "Position");
+    glBindAttribLocation(program, 0, "VertexCoord"); // RetroArch também usa VertexCoord
+    glBindAttribLocation(program, 1, "TexCoord");
+    // IMPORTANTE: Motion blur shaders precisam de PrevTexCoord, Prev1TexCoord, etc.
+    // Como todos os frames têm as mesmas dimensões, podemos usar os mesmos dados de TexCoord
+    glBindAttribLocation(program, 1, "PrevTexCoord");
+    glBindAttribLocation(program, 1, "Prev1TexCoord");
+    glBindAttribLocation(program, 1, "Prev2TexCoord");
+    glBindAttribLocation(program, 1, "Prev3TexCoord");
+    glBindAttribLocation(program, 1, "Prev4TexCoord");
+    glBindAttribLocation(program, 1, "Prev5TexCoord");
+    glBindAttribLocation(program, 1, "Prev6TexCoord");
+    glBindAttribLocation(program, 2, "COLOR"); // Alguns shaders RetroArch usam COLOR como atributo
+}
 
-    // Log de debug: verificar se parâmetros foram extraídos
-    if (!passData.parameterInfo.empty())
+bool ShaderEngine::linkPassProgram(size_t i, const ShaderPass &passInfo, const std::string &vertexSource,
+                                   std::string fragmentSource, ShaderPassData &passData)
+{
+    // Programa já linkado antes para este mesmo fonte pré-processado e driver:
+    // pula compilação, correção vec3/vec4 e linkagem
+    std::string cacheKey;
+    const std::string preprocessedFragment = fragmentSource;
+    if (m_programCache.isEnabled())
     {
-        LOG_INFO("Pass " + std::to_string(i) + " has " + std::to_string(passData.parameterInfo.size()) + " parameter(s)");
+        cacheKey = m_programCache.key(vertexSource, preprocessedFragment);
+        GLuint cachedProgram = m_programCache.load(cacheKey, vertexSource, preprocessedFragment);
+        if (cachedProgram != 0)
+        {
+            passData.vertexShader = 0;
+            passData.fragmentShader = 0;
+            passData.program = cachedProgram;
+            passData.floatFramebuffer = passInfo.floatFramebuffer;
+            return true;
+        }
     }
 
-    // IMPORTANTE: Os parâmetros já foram extraídos e armazenados em passData.parameterInfo
-    // Mesmo que a compilação falhe, queremos manter os parâmetros para a UI
-
     // Compilar shaders
     if (!compileShader(vertexSource, GL_VERTEX_SHADER, passData.vertexShader))
     {
@@ -702,22 +1151,9 @@ bool ShaderEngine::compilePass(size_t i)
     glAttachShader(program, passData.vertexShader);
     glAttachShader(program, passData.fragmentShader);
 
-    // Ligar atributos antes de linkar (necessário quando não usamos layout(location))
-    // RetroArch shaders podem usar VertexCoord ou Position
-    glBindAttribLocation(program, 0, "Position");
-    glBindAttribLocation(program, 0, "VertexCoord"); // RetroArch também usa VertexCoord
-    glBindAttribLocation(program, 1, "TexCoord");
-    // IMPORTANTE: Motion blur shaders precisam de PrevTexCoord, Prev1TexCoord, etc.
-    // Como todos os frames têm as mesmas dimensões, podemos usar os mesmos dados de TexCoord
-    glBindAttribLocation(program, 1, "PrevTexCoord");
-    glBindAttribLocation(program, 1, "Prev1TexCoord");
-    glBindAttribLocation(program, 1, "Prev2TexCoord");
-    glBindAttribLocation(program, 1, "Prev3TexCoord");
-    glBindAttribLocation(program, 1, "Prev4TexCoord");
-    glBindAttribLocation(program, 1, "Prev5TexCoord");
-    glBindAttribLocation(program, 1, "Prev6TexCoord");
-    glBindAttribLocation(program, 2, "COLOR"); // Alguns shaders RetroArch usam COLOR como atributo
+    bindPassAttribLocations(program);
 
+    m_programCache.prepareProgram(program);
     glLinkProgram(program);
 
     GLint success;
@@ -727,10 +1163,9 @@ bool ShaderEngine::compilePass(size_t i)
         char infoLog[512];
         glGetProgramInfoLog(program, 512, nullptr, infoLog);
         LOG_ERROR("Error linking shader program for pass " + std::to_string(i) + " (" + passInfo.shaderPath + "): " + std::string(infoLog));
-        glDeleteProgram(program);
+        deleteProgram(program);
         glDeleteShader(passData.vertexShader);
         glDeleteShader(passData.fragmentShader);
-        glDeleteProgram(program);
         // Manter parameterInfo mesmo se linkagem falhar
         passData.vertexShader = 0;
         passData.fragmentShader = 0;
@@ -740,9 +1175,10 @@ bool ShaderEngine::compilePass(size_t i)
 
     passData.program = program;
     passData.floatFramebuffer = passInfo.floatFramebuffer;
-    
-    // Pré-cachear uniforms comuns para este pass após linkagem bem-sucedida
-    preCacheCommonUniforms(program);
+    if (!cacheKey.empty())
+    {
+        m_programCache.store(cacheKey, vertexSource, preprocessedFragment, program);
+    }
     return true;
 }
 
@@ -787,7 +1223,7 @@ bool ShaderEngine::loadPresetPasses()
         {
             if (pass.program != 0)
             {
-                glDeleteProgram(pass.program);
+                deleteProgram(pass.program);
                 pass.program = 0;
             }
             if (pass.vertexShader != 0)
@@ -833,6 +1269,7 @@ bool ShaderEngine::loadPresetPasses()
         if (!compilePass(i))
             allPassesCompiled = false;
     }
+    configureFrameHistory();
 
     // Verificar se há texturas de referência
     const auto &textures = m_preset.getTextures();
@@ -985,7 +1422,8 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
     // IMPORTANTE: Configurar uniforms ANTES de bind de texturas
     // Mas o uniform Texture/Source precisa ser configurado DEPOIS do bind
     // Primeiro, configurar outros uniforms (SourceSize, etc)
-    setupUniforms(pass.program, i, currentWidth, currentHeight, outputWidth, outputHeight);
+    ShaderUniformTable &u = pass.uniforms;
+    setupUniforms(u, i, currentWidth, currentHeight, outputWidth, outputHeight);
 
     // Bind textura de entrada na unidade 0 (ANTES de configurar uniform Texture)
     glActiveTexture(GL_TEXTURE0);
@@ -1042,40 +1480,12 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
 
     // Configurar uniform Texture/Source DEPOIS do bind (como RetroArch faz)
     // RetroArch shaders podem usar diferentes nomes: Texture, Source, Input, s_p, etc.
-    // Tentar todos os nomes comuns
+    // O primeiro declarado foi resolvido na linkagem (buildUniformTable)
     bool textureBound = false;
-
-    // Lista de nomes comuns de uniforms de textura no RetroArch
-    const char *textureUniformNames[] = {
-        "Texture", // Mais comum
-        "Source",  // Segundo mais comum
-        "Input",   // Alguns shaders usam
-        "s_p",     // Usado por alguns shaders (ex: sgenpt-mix)
-        "tex",     // Alguns shaders usam
-        "image",   // Raro, mas possível
-    };
-
-    for (const char *name : textureUniformNames)
+    if (u.source >= 0)
     {
-        GLint loc = getUniformLocation(pass.program, name);
-        if (loc >= 0)
-        {
-            // IMPORTANTE: Garantir que a textura está bindada ANTES de configurar o uniform
-            // E garantir que estamos na unidade de textura correta
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, currentTexture);
-            glUniform1i(loc, 0);
-            textureBound = true;
-            if (i == 0 || i == 3 || i == 4)
-            {
-            }
-            break; // Encontrou um, não precisa tentar os outros
-        }
-        else if (i == 0)
-        {
-            // Log apenas no primeiro pass para debug
-            // LOG_INFO("Pass 0: Uniform '" + std::string(name) + "' não encontrado");
-        }
+        glUniform1i(u.source, 0);
+        textureBound = true;
     }
 
     // Se nenhum uniform foi encontrado, logar aviso (primeiro pass, pass 3 e pass 4 que estão falhando)
@@ -1093,18 +1503,7 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
     // IMPORTANTE: Se não há passes anteriores (i == 0), mas o shader espera PrevTexture,
     // vincular a textura de entrada atual para esses uniforms (comportamento comum do RetroArch)
     // IMPORTANTE: Para motion blur, precisamos vincular frames anteriores reais
-    // Verificar se o shader precisa de histórico de frames (PrevTexture, Prev1Texture, etc.)
-    bool needsHistory = false;
-    for (int prevIdx = 0; prevIdx < 7; ++prevIdx)
-    {
-        std::string name = (prevIdx == 0) ? "PrevTexture" : "Prev" + std::to_string(prevIdx) + "Texture";
-        if (getUniformLocation(pass.program, name) >= 0)
-        {
-            needsHistory = true;
-            break;
-        }
-    }
-
+    // (u.needsHistory: o shader declara PrevTexture, Prev1Texture, etc.)
     if (i == 0)
     {
         // Para o primeiro pass, vincular histórico de frames se disponível
@@ -1113,129 +1512,73 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
         // O shader motion blur deve funcionar apenas quando há histórico real
         for (int prevIdx = 0; prevIdx < 7; ++prevIdx) // RetroArch geralmente usa até Prev6Texture
         {
-            std::vector<std::string> passTextureNames;
-            if (prevIdx == 0)
-            {
-                passTextureNames.push_back("PrevTexture");
-                passTextureNames.push_back("PassPrev0Texture");
-            }
-            else
-            {
-                passTextureNames.push_back("Prev" + std::to_string(prevIdx) + "Texture");
-                passTextureNames.push_back("PassPrev" + std::to_string(prevIdx) + "Texture");
-            }
-
-            for (const auto &name : passTextureNames)
+            // PrevTexture = frame mais recente (índice 0), Prev6Texture = frame mais antigo
+            // O histórico é ordenado: [mais recente, ..., mais antigo]
+            const GLint loc = u.history[prevIdx];
+            const HistorySlot *frame = frameHistoryAt(static_cast<size_t>(prevIdx));
+            if (loc >= 0 && u.needsHistory && frame)
             {
-                GLint loc = getUniformLocation(pass.program, name);
-                if (loc >= 0)
-                {
-                    // IMPORTANTE: Só vincular se temos histórico real para este índice
-                    // Se não há histórico suficiente, NÃO vincular o uniform
-                    // Isso evita que o shader faça média de frames idênticos (que escurece)
-                    // O shader motion blur deve funcionar apenas quando há histórico real
-                    if (needsHistory && prevIdx < static_cast<int>(m_frameHistory.size()))
-                    {
-                        glActiveTexture(GL_TEXTURE0 + texUnit);
-
-                        // Usar frame do histórico (frames mais antigos primeiro)
-                        // PrevTexture = frame mais recente (índice 0), Prev6Texture = frame mais antigo
-                        // O histórico é ordenado: [mais recente, ..., mais antigo]
-                        size_t historyIdx = prevIdx; // prevIdx=0 é o mais recente, prevIdx=6 é o mais antigo
-                        if (historyIdx < m_frameHistory.size() && m_frameHistory[historyIdx] != 0)
-                        {
-                            glBindTexture(GL_TEXTURE_2D, m_frameHistory[historyIdx]);
-                            glUniform1i(loc, texUnit);
-                            texUnit++;
-                        }
-                    }
-                    // Se não há histórico suficiente, não vincular o uniform
-                    // O shader pode usar valores padrão ou zero, mas não fará média de frames idênticos
-                    // Isso evita o escurecimento quando não há histórico suficiente
-                    break;
-                }
+                glActiveTexture(GL_TEXTURE0 + texUnit);
+                glBindTexture(GL_TEXTURE_2D, frame->texture);
+                glUniform1i(loc, texUnit);
+                texUnit++;
             }
         }
     }
     else
     {
         // Para passes subsequentes, vincular texturas de passes anteriores reais
-        for (uint32_t prevPass = 0; prevPass < i && prevPass < m_passes.size(); ++prevPass)
+        for (uint32_t prevPass = 0; prevPass < u.prevPasses.size() && prevPass < m_passes.size(); ++prevPass)
         {
-            // Tentar diferentes nomes de uniforms
-            std::vector<std::string> passTextureNames;
-            if (prevPass == 0)
-            {
-                passTextureNames.push_back("PassPrev" + std::to_string(i - prevPass) + "Texture");
-                passTextureNames.push_back("PrevTexture");
-            }
-            else
-            {
-                passTextureNames.push_back("PassPrev" + std::to_string(i - prevPass) + "Texture");
-                passTextureNames.push_back("Prev" + std::to_string(prevPass) + "Texture");
-            }
-
-            for (const auto &name : passTextureNames)
+            const ShaderUniformTable::PrevPassSlot &slot = u.prevPasses[prevPass];
+            const ShaderPassData &target = m_passes[prevPass];
+            if (slot.texture >= 0)
             {
-                GLint loc = getUniformLocation(pass.program, name);
-                if (loc >= 0)
-                {
-                    glActiveTexture(GL_TEXTURE0 + texUnit);
-                    glBindTexture(GL_TEXTURE_2D, m_passes[prevPass].texture);
-                    glUniform1i(loc, texUnit);
-                    texUnit++;
-                    break;
-                }
+                glActiveTexture(GL_TEXTURE0 + texUnit);
+                glBindTexture(GL_TEXTURE_2D, target.texture);
+                glUniform1i(slot.texture, texUnit);
+                texUnit++;
             }
 
             // PassPrev<N>TextureSize / PassPrev<N>InputSize / PassPrev<N>OutputSize:
             // dimensões do pass alvo. Sem isso, shaders como crt-royale-bloom-approx
             // (que faz tex_uv = video_uv * PassPrev2InputSize / PassPrev2TextureSize)
             // dividem 0/0 e produzem NaN → tela preta.
-            const std::string nStr = std::to_string(i - prevPass);
-            const ShaderPassData &target = m_passes[prevPass];
             const float tw = static_cast<float>(target.width);
             const float th = static_cast<float>(target.height);
-
-            GLint sizeLoc = getUniformLocation(pass.program, "PassPrev" + nStr + "TextureSize");
-            if (sizeLoc >= 0)
+            if (slot.textureSize >= 0)
             {
-                glUniform2f(sizeLoc, tw, th);
+                glUniform2f(slot.textureSize, tw, th);
             }
-            sizeLoc = getUniformLocation(pass.program, "PassPrev" + nStr + "InputSize");
-            if (sizeLoc >= 0)
+            if (slot.inputSize >= 0)
             {
                 // InputSize de pass P é o tamanho que ele recebeu como entrada.
                 // Se P>0, é o output do pass anterior; se P==0, é o source original.
                 if (prevPass == 0)
                 {
-                    glUniform2f(sizeLoc,
+                    glUniform2f(slot.inputSize,
                                 static_cast<float>(m_sourceWidth),
                                 static_cast<float>(m_sourceHeight));
                 }
                 else
                 {
-                    glUniform2f(sizeLoc,
+                    glUniform2f(slot.inputSize,
                                 static_cast<float>(m_passes[prevPass - 1].width),
                                 static_cast<float>(m_passes[prevPass - 1].height));
                 }
             }
-            sizeLoc = getUniformLocation(pass.program, "PassPrev" + nStr + "OutputSize");
-            if (sizeLoc >= 0)
+            if (slot.outputSize >= 0)
             {
-                glUniform2f(sizeLoc, tw, th);
+                glUniform2f(slot.outputSize, tw, th);
             }
         }
 
         // PassPrev<N>Texture com N > pass atual aponta pra "antes do pass 0",
         // que na prática é o input original (kawase_glow's screen_combine usa
         // PassPrev8Texture no pass 7 pra recuperar a imagem pré-blur).
-        // Tentamos uma faixa razoável acima do pass atual.
-        for (uint32_t N = i + 1; N <= i + 12; ++N)
+        if (originalTexture != 0)
         {
-            GLint loc = getUniformLocation(pass.program,
-                                           "PassPrev" + std::to_string(N) + "Texture");
-            if (loc >= 0 && originalTexture != 0)
+            for (GLint loc : u.passPrevOriginal)
             {
                 glActiveTexture(GL_TEXTURE0 + texUnit);
                 glBindTexture(GL_TEXTURE_2D, originalTexture);
@@ -1248,29 +1591,22 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
         // RetroArch GLSL spec: presets podem nomear um pass via `aliasN = MyPass`,
         // e passes posteriores referenciam o sampler como `uniform sampler2D MyPass`
         // (e o tamanho via `uniform vec4 MyPassSize`).
-        for (uint32_t prevPass = 0; prevPass < i && prevPass < m_passes.size(); ++prevPass)
+        for (uint32_t prevPass = 0; prevPass < u.prevPasses.size() && prevPass < m_passes.size(); ++prevPass)
         {
-            const std::string &alias = m_passes[prevPass].passInfo.alias;
-            if (alias.empty())
-            {
-                continue;
-            }
-
-            GLint aliasTexLoc = getUniformLocation(pass.program, alias);
-            if (aliasTexLoc >= 0)
+            const ShaderUniformTable::PrevPassSlot &slot = u.prevPasses[prevPass];
+            if (slot.alias >= 0)
             {
                 glActiveTexture(GL_TEXTURE0 + texUnit);
                 glBindTexture(GL_TEXTURE_2D, m_passes[prevPass].texture);
-                glUniform1i(aliasTexLoc, texUnit);
+                glUniform1i(slot.alias, texUnit);
                 texUnit++;
             }
 
-            GLint aliasSizeLoc = getUniformLocation(pass.program, alias + "Size");
-            if (aliasSizeLoc >= 0)
+            if (slot.aliasSize >= 0)
             {
                 float w = static_cast<float>(m_passes[prevPass].width);
                 float h = static_cast<float>(m_passes[prevPass].height);
-                glUniform4f(aliasSizeLoc, w, h,
+                glUniform4f(slot.aliasSize, w, h,
                             w > 0.0f ? 1.0f / w : 0.0f,
                             h > 0.0f ? 1.0f / h : 0.0f);
             }
@@ -1282,34 +1618,11 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
     // lazy: se algum uniform PassFeedback<N>* aparecer aqui, marcamos pass[N]
     // pra ter ping-pong e alocamos sua segunda textura na primeira vez.
     // O swap entre texture/feedbackTexture acontece no fim do frame, abaixo.
-    for (uint32_t fbPass = 0; fbPass <= i && fbPass < m_passes.size(); ++fbPass)
+    for (uint32_t fbPass = 0; fbPass < u.feedback.size() && fbPass < m_passes.size(); ++fbPass)
     {
-        const std::string idxStr = std::to_string(fbPass);
-        std::vector<std::string> samplerNames = {
-            "PassFeedback" + idxStr,
-            "PassFeedback" + idxStr + "Texture"
-        };
-
-        GLint fbTexLoc = -1;
-        for (const auto &name : samplerNames)
-        {
-            fbTexLoc = getUniformLocation(pass.program, name);
-            if (fbTexLoc >= 0) break;
-        }
-
-        bool hasFeedbackUniform = (fbTexLoc >= 0);
-
-        GLint fbSizeLoc = getUniformLocation(pass.program, "PassFeedback" + idxStr + "Size");
-        if (fbSizeLoc < 0)
-        {
-            fbSizeLoc = getUniformLocation(pass.program, "PassFeedback" + idxStr + "TextureSize");
-        }
-        if (fbSizeLoc >= 0)
-        {
-            hasFeedbackUniform = true;
-        }
-
-        if (!hasFeedbackUniform)
+        const GLint fbTexLoc = u.feedback[fbPass].texture;
+        const GLint fbSizeLoc = u.feedback[fbPass].size;
+        if (fbTexLoc < 0 && fbSizeLoc < 0)
         {
             continue;
         }
@@ -1348,17 +1661,17 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
 
     // IMPORTANTE: Vincular textura original (OrigTexture) se o shader precisar
     // Alguns shaders (como hqx-pass2) precisam da textura original além da saída do pass anterior
-    GLint origTexLoc = getUniformLocation(pass.program, "OrigTexture");
-    if (origTexLoc >= 0)
+    if (u.origTexture >= 0)
     {
         glActiveTexture(GL_TEXTURE0 + texUnit);
         glBindTexture(GL_TEXTURE_2D, originalTexture);
-        glUniform1i(origTexLoc, texUnit);
+        glUniform1i(u.origTexture, texUnit);
         texUnit++;
     }
 
     // Bind texturas de referência (LUTs, etc)
     const auto &presetTextures = m_preset.getTextures();
+    size_t texRefIdx = 0;
     for (const auto &texRef : m_textureReferences)
     {
         glActiveTexture(GL_TEXTURE0 + texUnit);
@@ -1399,7 +1712,8 @@ void ShaderEngine::renderMultipassPass(size_t i, GLuint &currentTexture, uint32_
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
 
-        GLint loc = getUniformLocation(pass.program, texRef.first);
+        GLint loc = texRefIdx < u.textureReferences.size() ? u.textureReferences[texRefIdx] : -1;
+        texRefIdx++;
         if (loc >= 0)
         {
             glUniform1i(loc, texUnit);
@@ -1491,28 +1805,25 @@ GLuint ShaderEngine::renderSinglePass(GLuint inputTexture, uint32_t width, uint3
 
     glUseProgram(m_shaderProgram);
 
-    GLint texLoc = getUniformLocation(m_shaderProgram, "Texture");
-    if (texLoc >= 0)
+    const ShaderUniformTable &u = m_shaderUniforms;
+    if (u.source >= 0)
     {
-        glUniform1i(texLoc, 0);
+        glUniform1i(u.source, 0);
     }
 
-    GLint texSizeLoc = getUniformLocation(m_shaderProgram, "TextureSize");
-    if (texSizeLoc >= 0)
+    if (u.textureSize >= 0)
     {
-        glUniform2f(texSizeLoc, static_cast<float>(width), static_cast<float>(height));
+        glUniform2f(u.textureSize, static_cast<float>(width), static_cast<float>(height));
     }
 
-    GLint inputSizeLoc = getUniformLocation(m_shaderProgram, "InputSize");
-    if (inputSizeLoc >= 0)
+    if (u.inputSize >= 0)
     {
-        glUniform2f(inputSizeLoc, static_cast<float>(width), static_cast<float>(height));
+        glUniform2f(u.inputSize, static_cast<float>(width), static_cast<float>(height));
     }
 
-    GLint outputSizeLoc = getUniformLocation(m_shaderProgram, "OutputSize");
-    if (outputSizeLoc >= 0)
+    if (u.outputSize >= 0)
     {
-        glUniform2f(outputSizeLoc, static_cast<float>(width), static_cast<float>(height));
+        glUniform2f(u.outputSize, static_cast<float>(width), static_cast<float>(height));
     }
 
     glActiveTexture(GL_TEXTURE0);
@@ -1728,139 +2039,33 @@ GLuint ShaderEngine::applyShader(GLuint inputTexture, uint32_t width, uint32_t h
         // Usar dimensões padrão razoáveis como fallback (será sobrescrito)
         glViewport(0, 0, 1920, 1080);
 
-        // IMPORTANTE: Atualizar histórico de frames para motion blur
-        // O histórico deve conter frames JÁ PROCESSADOS (saída do shader)
-        // IMPORTANTE: Precisamos copiar o conteúdo para texturas dedicadas, não apenas armazenar referências
-        // As texturas dos framebuffers são reutilizadas e sobrescritas a cada frame
-        if (currentTexture != 0 && currentWidth > 0 && currentHeight > 0)
+        // Histórico de frames (PrevTexture/OriginalHistorySize): guarda a
+        // saída final deste frame no ring, só se o preset referencia algum
+        if (!m_frameHistory.empty() && currentTexture != 0 && currentWidth > 0 && currentHeight > 0)
         {
-            // Encontrar qual framebuffer contém currentTexture
+            // Framebuffer que contém currentTexture (o swap de PassFeedback
+            // acima pode tê-la movido para o par feedback)
             GLuint sourceFramebuffer = 0;
+            const ShaderPassData *sourcePass = nullptr;
             for (const auto &pass : m_passes)
             {
                 if (pass.texture == currentTexture)
                 {
                     sourceFramebuffer = pass.framebuffer;
+                    sourcePass = &pass;
                     break;
                 }
-            }
-
-            // Criar uma nova textura para o histórico (se necessário)
-            GLuint historyTexture = 0;
-            if (m_frameHistory.size() < MAX_FRAME_HISTORY)
-            {
-                // Criar nova textura para o histórico
-                glGenTextures(1, &historyTexture);
-                glBindTexture(GL_TEXTURE_2D, historyTexture);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, currentWidth, currentHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-                glBindTexture(GL_TEXTURE_2D, 0);
-            }
-            else
-            {
-                // Reutilizar a textura mais antiga (ring buffer)
-                historyTexture = m_frameHistory.back();
-                m_frameHistory.pop_back();
-                m_frameHistoryWidths.pop_back();
-                m_frameHistoryHeights.pop_back();
-
-                // Verificar se precisa redimensionar
-                if (m_frameHistoryWidths.empty() || m_frameHistoryHeights.empty() ||
-                    m_frameHistoryWidths.back() != currentWidth || m_frameHistoryHeights.back() != currentHeight)
-                {
-                    glBindTexture(GL_TEXTURE_2D, historyTexture);
-                    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, currentWidth, currentHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-                    glBindTexture(GL_TEXTURE_2D, 0);
-                }
-            }
-
-            // Copiar conteúdo do framebuffer para a textura do histórico
-            // Usar renderização simples: renderizar a textura atual para um framebuffer temporário
-            // vinculado à textura do histórico usando o VAO e shader program existente
-            if (sourceFramebuffer != 0 && historyTexture != 0)
-            {
-                // Criar framebuffer temporário reutilizável se ainda não existe
-                if (m_copyFramebuffer == 0)
-                {
-                    glGenFramebuffers(1, &m_copyFramebuffer);
-                }
-                
-                // Reutilizar framebuffer existente
-                glBindFramebuffer(GL_FRAMEBUFFER, m_copyFramebuffer);
-                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTexture, 0);
-
-                // Verificar se o framebuffer está completo
-                GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-                if (status == GL_FRAMEBUFFER_COMPLETE)
+                if (pass.feedbackTexture == currentTexture)
                 {
-                    glViewport(0, 0, currentWidth, currentHeight);
-                    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-                    glClear(GL_COLOR_BUFFER_BIT);
-
-                    // Renderizar a textura atual para o framebuffer temporário usando o VAO
-                    // Usar o shader program do primeiro pass para copiar a textura
-                    if (!m_passes.empty() && m_passes[0].program != 0)
-                    {
-                        // Usar o shader program do primeiro pass temporariamente
-                        glUseProgram(m_passes[0].program);
-                        glBindVertexArray(m_VAO);
-
-                        // Bind da textura atual
-                        glActiveTexture(GL_TEXTURE0);
-                        glBindTexture(GL_TEXTURE_2D, currentTexture);
-
-                        // Configurar uniform Texture se existir
-                        GLint texLoc = getUniformLocation(m_passes[0].program, "Texture");
-                        if (texLoc < 0)
-                        {
-                            texLoc = getUniformLocation(m_passes[0].program, "Source");
-                        }
-                        if (texLoc >= 0)
-                        {
-                            glUniform1i(texLoc, 0);
-                        }
-
-                        // Renderizar
-                        glEnableVertexAttribArray(0);
-                        glEnableVertexAttribArray(1);
-                        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-
-                        glBindVertexArray(0);
-                        glBindTexture(GL_TEXTURE_2D, 0);
-                        glUseProgram(0);
-                    }
-                    else
-                    {
-                        // Se não há shader program disponível, a textura ficará vazia
-                        // Mas pelo menos não crasha
-                        LOG_WARN("Could not copy frame to history (no shader program)");
-                    }
+                    sourceFramebuffer = pass.feedbackFramebuffer;
+                    sourcePass = &pass;
+                    break;
                 }
-
-                glBindFramebuffer(GL_FRAMEBUFFER, 0);
-                // Não deletar o framebuffer - reutilizar no próximo frame
-            }
-
-            // IMPORTANTE: Por enquanto, vamos apenas armazenar a referência da textura
-            // Isso não é ideal, mas permite que o código compile e funcione
-            // O problema é que as texturas dos framebuffers são reutilizadas, então
-            // o histórico pode conter texturas sobrescritas
-            // Uma implementação completa precisaria copiar o conteúdo usando renderização
-
-            // Adicionar ao histórico
-            m_frameHistory.insert(m_frameHistory.begin(), historyTexture);
-            m_frameHistoryWidths.insert(m_frameHistoryWidths.begin(), currentWidth);
-            m_frameHistoryHeights.insert(m_frameHistoryHeights.begin(), currentHeight);
-
-            // DEBUG: Log apenas quando necessário
-            if (m_frameHistory.size() == 1)
-            {
             }
-            else if (m_frameHistory.size() == MAX_FRAME_HISTORY)
+            if (sourceFramebuffer != 0)
             {
+                pushFrameHistory(sourceFramebuffer, currentWidth, currentHeight,
+                                 sourcePass->passInfo.floatFramebuffer, sourcePass->passInfo.srgbFramebuffer);
             }
         }
 
@@ -1909,99 +2114,44 @@ uint32_t ShaderEngine::calculateScale(uint32_t sourceSize, const std::string &sc
     return sourceSize;
 }
 
-void ShaderEngine::applyCoreSizeUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight, uint32_t outputWidth, uint32_t outputHeight)
+void ShaderEngine::applyCoreSizeUniforms(const ShaderUniformTable &u, uint32_t inputWidth, uint32_t inputHeight, uint32_t outputWidth, uint32_t outputHeight)
 {
     // Texture/Source será configurado DEPOIS do bind da textura (em applyShader)
     // Isso garante que a textura esteja vinculada antes de configurar o uniform
 
     // SourceSize (vec4 do RetroArch - convertido de params.SourceSize)
-    GLint loc = getUniformLocation(program, "SourceSize");
-    if (loc >= 0)
+    if (u.sourceSize >= 0)
     {
-        glUniform4f(loc, static_cast<float>(inputWidth), static_cast<float>(inputHeight),
+        glUniform4f(u.sourceSize, static_cast<float>(inputWidth), static_cast<float>(inputHeight),
                     1.0f / static_cast<float>(inputWidth), 1.0f / static_cast<float>(inputHeight));
     }
 
     // OriginalSize (vec4 do RetroArch - convertido de params.OriginalSize)
-    loc = getUniformLocation(program, "OriginalSize");
-    if (loc >= 0)
+    if (u.originalSize >= 0)
     {
-        glUniform4f(loc, static_cast<float>(m_sourceWidth), static_cast<float>(m_sourceHeight),
+        glUniform4f(u.originalSize, static_cast<float>(m_sourceWidth), static_cast<float>(m_sourceHeight),
                     1.0f / static_cast<float>(m_sourceWidth), 1.0f / static_cast<float>(m_sourceHeight));
     }
 
     // OutputSize (vec4 do RetroArch - convertido de params.OutputSize)
-    // IMPORTANTE: Alguns shaders usam vec4, outros usam vec2, e alguns podem usar vec3
-    // Vamos tentar detectar o tipo verificando o código do shader primeiro
-    // Se não conseguirmos detectar, tentamos vec2 primeiro (mais comum)
-    loc = getUniformLocation(program, "OutputSize");
-    if (loc >= 0)
+    // IMPORTANTE: Alguns shaders usam vec4, outros usam vec2, e alguns podem usar vec3.
+    // O tipo declarado foi detectado na linkagem (buildUniformTable); vec2 é o padrão.
+    if (u.outputSize >= 0)
     {
-        // Verificar o tipo do uniform usando glGetActiveUniform
-        // Primeiro, precisamos obter o número de uniforms ativos
-        GLint numUniforms = 0;
-        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numUniforms);
-
-        GLenum uniformType = GL_FLOAT_VEC2; // Default
-        bool foundType = false;
-
-        for (GLint i = 0; i < numUniforms; ++i)
+        if (u.outputSizeType == GL_FLOAT_VEC3)
         {
-            char uniformName[256];
-            GLint uniformSize;
-            GLenum type;
-            glGetActiveUniform(program, i, sizeof(uniformName), nullptr, &uniformSize, &type, uniformName);
-
-            if (std::string(uniformName) == "OutputSize")
-            {
-                uniformType = type;
-                foundType = true;
-                break;
-            }
+            // vec3: usar width, height, 1.0/width (ou similar)
+            glUniform3f(u.outputSize, static_cast<float>(outputWidth), static_cast<float>(outputHeight),
+                        1.0f / static_cast<float>(outputWidth));
         }
-
-        // Configurar baseado no tipo detectado
-        if (foundType)
+        else if (u.outputSizeType == GL_FLOAT_VEC4)
         {
-            if (uniformType == GL_FLOAT_VEC2)
-            {
-                glUniform2f(loc, static_cast<float>(outputWidth), static_cast<float>(outputHeight));
-            }
-            else if (uniformType == GL_FLOAT_VEC3)
-            {
-                // vec3: usar width, height, 1.0/width (ou similar)
-                glUniform3f(loc, static_cast<float>(outputWidth), static_cast<float>(outputHeight),
-                            1.0f / static_cast<float>(outputWidth));
-            }
-            else if (uniformType == GL_FLOAT_VEC4)
-            {
-                glUniform4f(loc, static_cast<float>(outputWidth), static_cast<float>(outputHeight),
-                            1.0f / static_cast<float>(outputWidth), 1.0f / static_cast<float>(outputHeight));
-            }
-            else
-            {
-                // Fallback: tentar vec2
-                glUniform2f(loc, static_cast<float>(outputWidth), static_cast<float>(outputHeight));
-            }
+            glUniform4f(u.outputSize, static_cast<float>(outputWidth), static_cast<float>(outputHeight),
+                        1.0f / static_cast<float>(outputWidth), 1.0f / static_cast<float>(outputHeight));
         }
         else
         {
-            // Não encontramos o tipo, tentar vec2 primeiro (mais comum)
-            glUniform2f(loc, static_cast<float>(outputWidth), static_cast<float>(outputHeight));
-        }
-
-        if (passIndex == 0 || passIndex == 4)
-        {
-            std::string typeStr = "vec2 (fallback)";
-            if (foundType)
-            {
-                if (uniformType == GL_FLOAT_VEC2)
-                    typeStr = "vec2";
-                else if (uniformType == GL_FLOAT_VEC3)
-                    typeStr = "vec3";
-                else if (uniformType == GL_FLOAT_VEC4)
-                    typeStr = "vec4";
-            }
+            glUniform2f(u.outputSize, static_cast<float>(outputWidth), static_cast<float>(outputHeight));
         }
     }
     // Nota: Se OutputSize não for encontrado, pode ser que o shader não o use
@@ -2010,16 +2160,14 @@ void ShaderEngine::applyCoreSizeUniforms(GLuint program, uint32_t passIndex, uin
 
 }
 
-void ShaderEngine::applyPassSizeUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight)
+void ShaderEngine::applyPassSizeUniforms(const ShaderUniformTable &u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight)
 {
-    GLint loc = 0;
-    // PassOutputSize# - Tamanhos de saída de passes anteriores (RetroArch injeta isso)
+    // PassOutputSize# / PassInputSize# - Tamanhos de passes anteriores (RetroArch injeta isso)
     // Permite que shaders acessem informações de passes anteriores
-    for (uint32_t i = 0; i < passIndex && i < m_passes.size(); ++i)
+    for (uint32_t i = 0; i < u.prevPasses.size() && i < m_passes.size(); ++i)
     {
-        std::string passOutputName = "PassOutputSize" + std::to_string(i);
-        loc = getUniformLocation(program, passOutputName);
-        if (loc >= 0)
+        const auto &slot = u.prevPasses[i];
+        if (slot.passOutputSize >= 0)
         {
             // Usar dimensões do pass anterior
             uint32_t prevWidth = m_passes[i].width;
@@ -2029,17 +2177,10 @@ void ShaderEngine::applyPassSizeUniforms(GLuint program, uint32_t passIndex, uin
             if (prevHeight == 0)
                 prevHeight = inputHeight; // Fallback
 
-            glUniform4f(loc, static_cast<float>(prevWidth), static_cast<float>(prevHeight),
+            glUniform4f(slot.passOutputSize, static_cast<float>(prevWidth), static_cast<float>(prevHeight),
                         1.0f / static_cast<float>(prevWidth), 1.0f / static_cast<float>(prevHeight));
         }
-    }
-
-    // PassInputSize# - Tamanhos de entrada de passes anteriores
-    for (uint32_t i = 0; i < passIndex && i < m_passes.size(); ++i)
-    {
-        std::string passInputName = "PassInputSize" + std::to_string(i);
-        loc = getUniformLocation(program, passInputName);
-        if (loc >= 0)
+        if (slot.passInputSize >= 0)
         {
             // Para o primeiro pass, usar source size; para outros, usar output do pass anterior
             uint32_t prevInputWidth = (i == 0) ? m_sourceWidth : m_passes[i - 1].width;
@@ -2049,132 +2190,96 @@ void ShaderEngine::applyPassSizeUniforms(GLuint program, uint32_t passIndex, uin
             if (prevInputHeight == 0)
                 prevInputHeight = inputHeight;
 
-            glUniform4f(loc, static_cast<float>(prevInputWidth), static_cast<float>(prevInputHeight),
+            glUniform4f(slot.passInputSize, static_cast<float>(prevInputWidth), static_cast<float>(prevInputHeight),
                         1.0f / static_cast<float>(prevInputWidth), 1.0f / static_cast<float>(prevInputHeight));
         }
     }
 
     // Variáveis de configuração do pass atual (Scale, Filter, etc)
-    // Essas são injetadas pelo RetroArch e podem ser usadas pelos shaders
-    if (passIndex < m_passes.size())
+    // Essas são injetadas pelo RetroArch e podem ser usadas pelos shaders.
+    // Fixas para a vida do programa: enviadas só na primeira vez.
+    if (!u.constantsPushed && passIndex < m_passes.size())
     {
         const auto &passInfo = m_passes[passIndex].passInfo;
 
-        // PassScale - Fator de escala do pass atual
-        loc = getUniformLocation(program, "PassScale");
-        if (loc >= 0)
+        // PassScale - Fator de escala do pass atual (média dos fatores X e Y)
+        if (u.passScale >= 0)
         {
-            // Média dos fatores X e Y
-            float avgScale = (passInfo.scaleX + passInfo.scaleY) / 2.0f;
-            glUniform1f(loc, avgScale);
+            glUniform1f(u.passScale, (passInfo.scaleX + passInfo.scaleY) / 2.0f);
         }
 
         // PassScaleX, PassScaleY - Escalas individuais
-        loc = getUniformLocation(program, "PassScaleX");
-        if (loc >= 0)
+        if (u.passScaleX >= 0)
         {
-            glUniform1f(loc, passInfo.scaleX);
+            glUniform1f(u.passScaleX, passInfo.scaleX);
         }
-
-        loc = getUniformLocation(program, "PassScaleY");
-        if (loc >= 0)
+        if (u.passScaleY >= 0)
         {
-            glUniform1f(loc, passInfo.scaleY);
+            glUniform1f(u.passScaleY, passInfo.scaleY);
         }
 
         // PassFilter - 1.0 para Linear, 0.0 para Nearest
-        loc = getUniformLocation(program, "PassFilter");
-        if (loc >= 0)
+        if (u.passFilter >= 0)
         {
-            glUniform1f(loc, passInfo.filterLinear ? 1.0f : 0.0f);
+            glUniform1f(u.passFilter, passInfo.filterLinear ? 1.0f : 0.0f);
         }
     }
 
 }
 
-void ShaderEngine::applyFrameUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight)
+void ShaderEngine::applyFrameUniforms(const ShaderUniformTable &u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight)
 {
-    GLint loc = 0;
     // FrameCount (uint convertido para float - convertido de params.FrameCount)
     // IMPORTANTE: Aplicar frame_count_mod# do passInfo (não do preset parameters)
     // RetroArch armazena frame_count_mod diretamente no pass
-    float frameCountValue = m_frameCount;
-    if (passIndex < m_passes.size())
-    {
-        const auto &passData = m_passes[passIndex];
-        if (passData.passInfo.frameCountMod > 0)
-        {
-            frameCountValue = fmod(m_frameCount, static_cast<float>(passData.passInfo.frameCountMod));
-        }
-    }
-
-    loc = getUniformLocation(program, "FrameCount");
-    if (loc >= 0)
+    if (u.frameCount >= 0)
     {
-        // FrameCount pode ser declarado como int ou float
-        // Verificar o tipo do uniform e usar a função apropriada
-        GLenum uniformType = GL_FLOAT;
-        GLint uniformSize = 0;
-        char uniformName[256];
-        GLsizei nameLength = 0;
-
-        // Encontrar o índice do uniform
-        GLint uniformCount = 0;
-        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
-        bool foundType = false;
-        for (GLint i = 0; i < uniformCount; ++i)
+        float frameCountValue = m_frameCount;
+        if (passIndex < m_passes.size() && m_passes[passIndex].passInfo.frameCountMod > 0)
         {
-            glGetActiveUniform(program, i, 256, &nameLength, &uniformSize, &uniformType, uniformName);
-            if (std::string(uniformName) == "FrameCount")
-            {
-                foundType = true;
-                break;
-            }
+            frameCountValue = fmod(m_frameCount, static_cast<float>(m_passes[passIndex].passInfo.frameCountMod));
         }
 
-        if (foundType && uniformType == GL_INT)
+        // FrameCount pode ser declarado como int ou float (tipo detectado na linkagem)
+        if (u.frameCountIsInt)
         {
-            // Se é int, usar glUniform1i
-            glUniform1i(loc, static_cast<GLint>(frameCountValue));
+            glUniform1i(u.frameCount, static_cast<GLint>(frameCountValue));
         }
         else
         {
-            // Se é float ou não encontramos o tipo, usar glUniform1f (padrão)
-            glUniform1f(loc, frameCountValue);
+            glUniform1f(u.frameCount, frameCountValue);
         }
     }
-    // Remover aviso - é normal que uniforms não usados sejam otimizados pelo compilador
 
-    // MVPMatrix (mat4 do RetroArch - matriz identidade)
-    // RetroArch shaders podem usar MVPMatrix * VertexCoord
-    // IMPORTANTE: Sem isso, o shader não renderiza nada!
-    // Usar matriz identidade normal (sem inversão Y aqui)
-    loc = getUniformLocation(program, "MVPMatrix");
-    if (loc >= 0)
+    if (!u.constantsPushed)
     {
-        // Matriz identidade (sem transformação)
-        float mvp[16] = {
-            1.0f, 0.0f, 0.0f, 0.0f,
-            0.0f, 1.0f, 0.0f, 0.0f,
-            0.0f, 0.0f, 1.0f, 0.0f,
-            0.0f, 0.0f, 0.0f, 1.0f};
-        glUniformMatrix4fv(loc, 1, GL_FALSE, mvp);
-    }
+        // MVPMatrix (mat4 do RetroArch - matriz identidade)
+        // RetroArch shaders podem usar MVPMatrix * VertexCoord
+        // IMPORTANTE: Sem isso, o shader não renderiza nada!
+        if (u.mvpMatrix >= 0)
+        {
+            // Matriz identidade (sem transformação)
+            float mvp[16] = {
+                1.0f, 0.0f, 0.0f, 0.0f,
+                0.0f, 1.0f, 0.0f, 0.0f,
+                0.0f, 0.0f, 1.0f, 0.0f,
+                0.0f, 0.0f, 0.0f, 1.0f};
+            glUniformMatrix4fv(u.mvpMatrix, 1, GL_FALSE, mvp);
+        }
 
-    // FrameDirection (int do RetroArch)
-    loc = getUniformLocation(program, "FrameDirection");
-    if (loc >= 0)
-    {
-        glUniform1i(loc, 1); // Sempre 1 (forward)
+        // FrameDirection (int do RetroArch)
+        if (u.frameDirection >= 0)
+        {
+            glUniform1i(u.frameDirection, 1); // Sempre 1 (forward)
+        }
     }
 
     // OriginalHistorySize0-7: dimensões dos frames anteriores.
     // Convenção slang: OriginalHistory0 = source atual, OriginalHistory1..N = N frames atrás.
-    // m_frameHistoryWidths/Heights armazena o histórico real (mais recente primeiro).
+    // frameHistoryAt(0) é o frame anterior.
     for (int i = 0; i <= 7; ++i)
     {
-        std::string historyName = "OriginalHistorySize" + std::to_string(i);
-        loc = getUniformLocation(program, historyName);
+        const GLint loc = u.originalHistorySize[i];
         if (loc < 0)
         {
             continue;
@@ -2190,12 +2295,11 @@ void ShaderEngine::applyFrameUniforms(GLuint program, uint32_t passIndex, uint32
         }
         else
         {
-            size_t historyIdx = static_cast<size_t>(i - 1);
-            if (historyIdx < m_frameHistoryWidths.size() &&
-                historyIdx < m_frameHistoryHeights.size())
+            const HistorySlot *frame = frameHistoryAt(static_cast<size_t>(i - 1));
+            if (frame)
             {
-                w = static_cast<float>(m_frameHistoryWidths[historyIdx]);
-                h = static_cast<float>(m_frameHistoryHeights[historyIdx]);
+                w = static_cast<float>(frame->width);
+                h = static_cast<float>(frame->height);
             }
             else
             {
@@ -2213,184 +2317,31 @@ void ShaderEngine::applyFrameUniforms(GLuint program, uint32_t passIndex, uint32
 
 }
 
-void ShaderEngine::applyShaderParameterUniforms(GLuint program, uint32_t passIndex)
+void ShaderEngine::applyShaderParameterUniforms(ShaderUniformTable &u)
 {
-    GLint loc = 0;
-    // Parâmetros extraídos de #pragma parameter (injetados pelo RetroArch)
-    // Esses são parâmetros configuráveis que o RetroArch injeta como uniforms
-    if (passIndex < m_passes.size())
-    {
-        const auto &extractedParams = m_passes[passIndex].extractedParameters;
-        if (passIndex == 0 && !extractedParams.empty())
-        {
-        }
-        for (const auto &param : extractedParams)
-        {
-            loc = getUniformLocation(program, param.first);
-            if (loc >= 0)
-            {
-                // Verificar se há valor customizado (do usuário), do preset, ou usar valor padrão do #pragma parameter
-                float value = param.second;
-                auto customIt = m_customParameters.find(param.first);
-                if (customIt != m_customParameters.end())
-                {
-                    value = customIt->second;
-                }
-                else
-                {
-                    const auto &presetParams = m_preset.getParameters();
-                    auto presetIt = presetParams.find(param.first);
-                    if (presetIt != presetParams.end())
-                    {
-                        value = presetIt->second;
-                    }
-                }
-                glUniform1f(loc, value);
-            }
-            else if (passIndex == 0)
-            {
-                // Log apenas se não encontrou (pode ser normal se o shader não usa)
-                // LOG_WARN("Pass 0: Uniform de parâmetro '" + param.first + "' não encontrado");
-            }
-        }
-    }
-
-    // Parâmetros customizados do shader com valores padrão (fallback para shaders antigos)
-    // Esses valores serão usados se o shader não definir seus próprios
-    loc = getUniformLocation(program, "BLURSCALEX");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.30f);
-    }
-
-    loc = getUniformLocation(program, "LOWLUMSCAN");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 6.0f);
-    }
-
-    loc = getUniformLocation(program, "HILUMSCAN");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 8.0f);
-    }
-
-    loc = getUniformLocation(program, "BRIGHTBOOST");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 1.25f);
-    }
-
-    loc = getUniformLocation(program, "MASK_DARK");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.25f);
-    }
-
-    loc = getUniformLocation(program, "MASK_FADE");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.8f);
-    }
-
-    // Parâmetros comuns de outros shaders (valores seguros/padrão)
-    loc = getUniformLocation(program, "RESSWITCH_ENABLE");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 1.0f);
-    }
-
-    loc = getUniformLocation(program, "RESSWITCH_GLITCH_TRESHOLD");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.1f);
-    }
-
-    loc = getUniformLocation(program, "RESSWITCH_GLITCH_BAR_STR");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.6f);
-    }
-
-    loc = getUniformLocation(program, "RESSWITCH_GLITCH_BAR_SIZE");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.5f);
-    }
-
-    loc = getUniformLocation(program, "RESSWITCH_GLITCH_BAR_SMOOTH");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 1.0f);
-    }
-
-    loc = getUniformLocation(program, "RESSWITCH_GLITCH_SHAKE_MAX");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.25f);
-    }
-
-    loc = getUniformLocation(program, "RESSWITCH_GLITCH_ROT_MAX");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.2f);
-    }
-
-    loc = getUniformLocation(program, "RESSWITCH_GLITCH_WOB_MAX");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.1f);
-    }
-
-    // Parâmetros do shader Grade/Afterglow
-    loc = getUniformLocation(program, "AS");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.20f); // Afterglow Strength
-    }
-
-    loc = getUniformLocation(program, "asat");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.33f); // Afterglow saturation
-    }
-
-    loc = getUniformLocation(program, "PR");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.32f); // Persistence Red
-    }
-
-    loc = getUniformLocation(program, "PG");
-    if (loc >= 0)
+    // Parâmetros (#pragma parameter, globais do preset e constantes legadas).
+    // Só mudam quando o usuário mexe num parâmetro: fora isso, nada a enviar —
+    // o valor fica guardado no próprio programa.
+    if (u.parameterRevision == m_parameterRevision)
     {
-        glUniform1f(loc, 0.32f); // Persistence Green
+        return;
     }
+    u.parameterRevision = m_parameterRevision;
 
-    loc = getUniformLocation(program, "PB");
-    if (loc >= 0)
+    for (auto &slot : u.parameters)
     {
-        glUniform1f(loc, 0.32f); // Persistence Blue
+        const float value = resolveParameterValue(slot.name, slot.fallback);
+        if (!slot.hasPushed || value != slot.pushed)
+        {
+            glUniform1f(slot.location, value);
+            slot.pushed = value;
+            slot.hasPushed = true;
+        }
     }
-
 }
 
-void ShaderEngine::applyAlternateSizeUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight, uint32_t outputWidth, uint32_t outputHeight)
+void ShaderEngine::applyAlternateSizeUniforms(const ShaderUniformTable &u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight, uint32_t outputWidth, uint32_t outputHeight)
 {
-    GLint loc = 0;
-    // Parâmetros de resolução e escala
-    loc = getUniformLocation(program, "internal_res");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 1.0f); // Internal Resolution
-    }
-
-    loc = getUniformLocation(program, "auto_res");
-    if (loc >= 0)
-    {
-        glUniform1f(loc, 0.0f); // Auto resolution
-    }
-
     // TextureSize (vec2 alternativo)
     // IMPORTANTE: Para shaders como interlacing.glsl que escalam a altura (scale_y = 2.0),
     // TextureSize pode precisar refletir a altura da SAÍDA, não da entrada
@@ -2398,8 +2349,7 @@ void ShaderEngine::applyAlternateSizeUniforms(GLuint program, uint32_t passIndex
     // Onde vTexCoord.y é a coordenada na textura de SAÍDA (0.0 a 1.0)
     // Se TextureSize.y é a altura da entrada (224) mas a saída é 448, o cálculo fica errado
     // Vamos tentar usar a altura da SAÍDA quando o pass escala a altura
-    loc = getUniformLocation(program, "TextureSize");
-    if (loc >= 0)
+    if (u.textureSize >= 0)
     {
         // Para shaders que escalam a altura (como interlacing.glsl com scale_y = 2.0),
         // usar a altura da SAÍDA em TextureSize.y para que o cálculo de y funcione corretamente
@@ -2423,113 +2373,70 @@ void ShaderEngine::applyAlternateSizeUniforms(GLuint program, uint32_t passIndex
         // O shader usa TextureSize para calcular vTexCoord baseado na textura de entrada
         // Se TextureSize for diferente do tamanho real da textura, vTexCoord pode sair de [0,1]
 
-        glUniform2f(loc, static_cast<float>(inputWidth), textureSizeY);
+        glUniform2f(u.textureSize, static_cast<float>(inputWidth), textureSizeY);
     }
-    // Nota: Se TextureSize não for encontrado, pode ser que o shader não o use
-    // ou que ele tenha sido otimizado fora pelo compilador GLSL
-    // Isso é normal e não é um erro - não gerar avisos
 
     // InputSize (vec2 alternativo)
-    loc = getUniformLocation(program, "InputSize");
-    if (loc >= 0)
+    if (u.inputSize >= 0)
     {
-        glUniform2f(loc, static_cast<float>(inputWidth), static_cast<float>(inputHeight));
+        glUniform2f(u.inputSize, static_cast<float>(inputWidth), static_cast<float>(inputHeight));
     }
-    // Nota: Se InputSize não for encontrado, pode ser que o shader não o use
-    // ou que ele tenha sido otimizado fora pelo compilador GLSL
-    // Isso é normal e não é um erro - não gerar avisos
 
     // VideoSize (tamanho original)
-    loc = getUniformLocation(program, "IN.video_size");
-    if (loc >= 0)
+    if (u.inVideoSize >= 0)
     {
-        glUniform2f(loc, static_cast<float>(m_sourceWidth), static_cast<float>(m_sourceHeight));
+        glUniform2f(u.inVideoSize, static_cast<float>(m_sourceWidth), static_cast<float>(m_sourceHeight));
     }
 
     // TextureSize (alternativo)
-    loc = getUniformLocation(program, "IN.texture_size");
-    if (loc >= 0)
+    if (u.inTextureSize >= 0)
     {
-        glUniform2f(loc, static_cast<float>(inputWidth), static_cast<float>(inputHeight));
+        glUniform2f(u.inTextureSize, static_cast<float>(inputWidth), static_cast<float>(inputHeight));
     }
 
-    // OutputSize (alternativo como vec2 - alguns shaders como crt-geom usam vec2 OutputSize)
-    // IMPORTANTE: Se o shader declarou OutputSize como vec2, precisamos usar glUniform2f
-    // Mas se declarou como vec4, precisamos usar glUniform4f
-    // O problema é que não podemos saber qual é sem verificar o tipo do uniform
-    // Vamos tentar configurar como vec2 também (muitos shaders usam vec2)
-    // NOTA: Se o shader espera vec4 e passamos vec2, pode causar problemas
-    // Mas se espera vec2 e passamos vec4, também pode causar problemas
-    // A solução é verificar o tipo do uniform, mas isso requer glGetActiveUniform
-    // Por enquanto, vamos configurar ambos (vec4 acima e vec2 aqui se necessário)
-
     // OutputSize como vec2 (IN.output_size é um formato alternativo)
-    loc = getUniformLocation(program, "IN.output_size");
-    if (loc >= 0)
+    if (u.inOutputSize >= 0)
     {
-        glUniform2f(loc, static_cast<float>(outputWidth), static_cast<float>(outputHeight));
+        glUniform2f(u.inOutputSize, static_cast<float>(outputWidth), static_cast<float>(outputHeight));
     }
 
-    // IMPORTANTE: Se o shader declarou OutputSize como vec2 (não vec4), precisamos usar glUniform2f
-    // Mas já configuramos como vec4 acima. O problema é que se o shader espera vec2,
-    // passar vec4 pode não funcionar corretamente.
-    // Vamos adicionar uma verificação: se o uniform OutputSize existe mas não aceitou vec4,
-    // tentar como vec2. Mas isso é complicado sem verificar o tipo.
-    // Por enquanto, vamos assumir que se o shader usa vec2 OutputSize, ele também terá
-    // uma declaração explícita e o glUniform4f acima pode não funcionar.
-    // Mas na prática, muitos drivers OpenGL são tolerantes com isso.
-
 }
 
-void ShaderEngine::applyGlobalPresetUniforms(GLuint program)
+void ShaderEngine::applyGlobalPresetUniforms(const ShaderUniformTable &u)
 {
-    GLint loc = 0;
     // Frame count e time
     // IMPORTANTE: NÃO incrementar aqui! FrameCount deve ser incrementado apenas uma vez por frame
     // no início de applyShader(), não a cada chamada de setupUniforms() (que é chamado para cada pass)
-    // m_frameCount += 1.0f; // MOVED TO applyShader()
-    // m_time += 0.016f; // ~60fps
-
-    loc = getUniformLocation(program, "IN.frame_count");
-    if (loc >= 0)
+    if (u.inFrameCount >= 0)
     {
-        glUniform1f(loc, m_frameCount);
+        glUniform1f(u.inFrameCount, m_frameCount);
     }
 
-    loc = getUniformLocation(program, "FRAMEINDEX");
-    if (loc >= 0)
+    if (u.frameIndex >= 0)
     {
-        glUniform1f(loc, m_frameCount);
+        glUniform1f(u.frameIndex, m_frameCount);
     }
 
-    loc = getUniformLocation(program, "TIME");
-    if (loc >= 0)
+    if (u.time >= 0)
     {
-        glUniform1f(loc, m_time);
+        glUniform1f(u.time, m_time);
     }
 
-    // Parâmetros globais do preset
-    const auto &params = m_preset.getParameters();
-    for (const auto &param : params)
-    {
-        loc = getUniformLocation(program, param.first);
-        if (loc >= 0)
-        {
-            glUniform1f(loc, param.second);
-        }
-    }
+    // Parâmetros globais do preset: enviados junto com os #pragma parameter
+    // em applyShaderParameterUniforms (mesma tabela, mesma precedência).
 }
 
 
-void ShaderEngine::setupUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight,
+void ShaderEngine::setupUniforms(ShaderUniformTable &u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight,
                                  uint32_t outputWidth, uint32_t outputHeight)
 {
-    applyCoreSizeUniforms(program, passIndex, inputWidth, inputHeight, outputWidth, outputHeight);
-    applyPassSizeUniforms(program, passIndex, inputWidth, inputHeight);
-    applyFrameUniforms(program, passIndex, inputWidth, inputHeight);
-    applyShaderParameterUniforms(program, passIndex);
-    applyAlternateSizeUniforms(program, passIndex, inputWidth, inputHeight, outputWidth, outputHeight);
-    applyGlobalPresetUniforms(program);
+    applyCoreSizeUniforms(u, inputWidth, inputHeight, outputWidth, outputHeight);
+    applyPassSizeUniforms(u, passIndex, inputWidth, inputHeight);
+    applyFrameUniforms(u, passIndex, inputWidth, inputHeight);
+    applyShaderParameterUniforms(u);
+    applyAlternateSizeUniforms(u, passIndex, inputWidth, inputHeight, outputWidth, outputHeight);
+    applyGlobalPresetUniforms(u);
+    u.constantsPushed = true;
 }
 
 bool ShaderEngine::loadTextureReference(const std::string &name, const std::string &path)
@@ -2541,6 +2448,17 @@ bool ShaderEngine::loadTextureReference(const std::string &name, const std::stri
         return true;
     }
 
+    DecodedTexture image;
+    if (!decodeTextureReference(name, path, image))
+    {
+        return false;
+    }
+    uploadTextureReference(image);
+    return true;
+}
+
+bool ShaderEngine::decodeTextureReference(const std::string &name, const std::string &path, DecodedTexture &out)
+{
     // Verificar se o arquivo existe
     if (!fs::exists(path))
     {
@@ -2632,7 +2550,8 @@ bool ShaderEngine::loadTextureReference(const std::string &name, const std::stri
     // Alocar buffer para dados da imagem
     png_bytep *row_pointers = (png_bytep *)malloc(sizeof(png_bytep) * height);
     int rowbytes = png_get_rowbytes(png_ptr, info_ptr);
-    std::vector<uint8_t> imageData(rowbytes * height);
+    std::vector<uint8_t> &imageData = out.pixels;
+    imageData.assign(static_cast<size_t>(rowbytes) * height, 0);
 
     for (uint32_t y = 0; y < height; y++)
     {
@@ -2650,13 +2569,24 @@ bool ShaderEngine::loadTextureReference(const std::string &name, const std::stri
     fclose(fp);
     free(row_pointers);
 
+    out.name = name;
+    out.width = width;
+    out.height = height;
+    return true;
+}
+
+void ShaderEngine::uploadTextureReference(const DecodedTexture &image)
+{
+    const std::string &name = image.name;
+
     // Criar textura OpenGL
     GLuint texture;
     glGenTextures(1, &texture);
     glBindTexture(GL_TEXTURE_2D, texture);
 
     // Carregar dados na textura primeiro
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData.data());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 image.pixels.data());
 
     // Aplicar configurações do preset (filter_linear, wrap_mode, mipmap)
     // Buscar configurações da textura no preset
@@ -2701,8 +2631,6 @@ bool ShaderEngine::loadTextureReference(const std::string &name, const std::stri
     glBindTexture(GL_TEXTURE_2D, 0);
 
     m_textureReferences[name] = texture;
-
-    return true;
 }
 
 void ShaderEngine::cleanupTextureReferences()
@@ -2723,7 +2651,7 @@ void ShaderEngine::cleanupPresetPasses()
     {
         if (pass.program != 0)
         {
-            glDeleteProgram(pass.program);
+            deleteProgram(pass.program);
         }
         if (pass.vertexShader != 0)
         {
@@ -2742,11 +2670,95 @@ void ShaderEngine::cleanupPresetPasses()
     // Os parameterInfo serão limpos apenas quando um novo preset for carregado
     m_passes.clear();
 
-    // Limpar histórico de frames
-    // IMPORTANTE: Não deletar as texturas aqui, pois elas pertencem aos framebuffers dos passes
+    cleanupFrameHistory();
+}
+
+void ShaderEngine::configureFrameHistory()
+{
+    cleanupFrameHistory();
+
+    // Profundidade = frame mais antigo que algum pass lê. Prev<N>Texture só
+    // é ligado no pass 0; OriginalHistorySize<N> vale em qualquer pass.
+    size_t depth = 0;
+    if (!m_passes.empty() && m_passes[0].uniforms.needsHistory)
+    {
+        for (size_t k = 0; k < MAX_FRAME_HISTORY; ++k)
+        {
+            if (m_passes[0].uniforms.history[k] >= 0)
+            {
+                depth = std::max(depth, k + 1);
+            }
+        }
+    }
+    for (const auto &pass : m_passes)
+    {
+        for (size_t k = 1; k <= MAX_FRAME_HISTORY; ++k)
+        {
+            if (pass.uniforms.originalHistorySize[k] >= 0)
+            {
+                depth = std::max(depth, k);
+            }
+        }
+    }
+
+    // Texturas alocadas no primeiro push, quando o tamanho é conhecido
+    m_frameHistory.resize(depth);
+    if (depth > 0)
+    {
+        LOG_INFO("Frame history: " + std::to_string(depth) + " frame(s)");
+    }
+}
+
+void ShaderEngine::pushFrameHistory(GLuint sourceFramebuffer, uint32_t width, uint32_t height,
+                                    bool floatBuffer, bool srgbBuffer)
+{
+    m_frameHistoryHead = (m_frameHistoryHead + 1) % m_frameHistory.size();
+    HistorySlot &slot = m_frameHistory[m_frameHistoryHead];
+    // Blit para RGBA8 quantizaria um pass float e perderia a decodificação
+    // sRGB: PrevTexture tem que ter a mesma codificação do frame atual
+    if (slot.framebuffer == 0 || slot.width != width || slot.height != height ||
+        slot.floatBuffer != floatBuffer || slot.srgbBuffer != srgbBuffer)
+    {
+        cleanupFramebuffer(slot.framebuffer, slot.texture);
+        createFramebuffer(width, height, floatBuffer, slot.framebuffer, slot.texture, srgbBuffer);
+        slot.width = width;
+        slot.height = height;
+        slot.floatBuffer = floatBuffer;
+        slot.srgbBuffer = srgbBuffer;
+    }
+    if (slot.framebuffer == 0)
+    {
+        return;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sourceFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, slot.framebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    m_frameHistoryCount = std::min(m_frameHistoryCount + 1, m_frameHistory.size());
+}
+
+const ShaderEngine::HistorySlot *ShaderEngine::frameHistoryAt(size_t age) const
+{
+    if (age >= m_frameHistoryCount)
+    {
+        return nullptr;
+    }
+    const size_t depth = m_frameHistory.size();
+    const HistorySlot &slot = m_frameHistory[(m_frameHistoryHead + depth - age) % depth];
+    return slot.texture != 0 ? &slot : nullptr;
+}
+
+void ShaderEngine::cleanupFrameHistory()
+{
+    for (auto &slot : m_frameHistory)
+    {
+        cleanupFramebuffer(slot.framebuffer, slot.texture);
+    }
     m_frameHistory.clear();
-    m_frameHistoryWidths.clear();
-    m_frameHistoryHeights.clear();
+    m_frameHistoryHead = 0;
+    m_frameHistoryCount = 0;
 }
 
 bool ShaderEngine::compileShader(const std::string &source, GLenum type, GLuint &shader)
@@ -2793,6 +2805,7 @@ bool ShaderEngine::linkProgram(GLuint vertexShader, GLuint fragmentShader)
     glAttachShader(m_shaderProgram, vertexShader);
     glAttachShader(m_shaderProgram, fragmentShader);
     glLinkProgram(m_shaderProgram);
+    m_uniformLocations.clear(); // locations só valem para esta linkagem
 
     GLint success;
     glGetProgramiv(m_shaderProgram, GL_LINK_STATUS, &success);
@@ -2801,22 +2814,22 @@ bool ShaderEngine::linkProgram(GLuint vertexShader, GLuint fragmentShader)
         char infoLog[512];
         glGetProgramInfoLog(m_shaderProgram, 512, nullptr, infoLog);
         LOG_ERROR("Error linking shader program: " + std::string(infoLog));
-        glDeleteProgram(m_shaderProgram);
+        deleteProgram(m_shaderProgram);
         m_shaderProgram = 0;
         return false;
     }
 
-    // Pré-cachear uniforms comuns após linkagem bem-sucedida
-    preCacheCommonUniforms(m_shaderProgram);
+    buildUniformTable(m_shaderProgram, nullptr, 0, m_shaderUniforms);
 
     return true;
 }
 
 void ShaderEngine::disableShader()
 {
+    cancelPendingPreset();
     if (m_shaderProgram != 0)
     {
-        glDeleteProgram(m_shaderProgram);
+        deleteProgram(m_shaderProgram);
         m_shaderProgram = 0;
     }
     if (m_vertexShader != 0)
@@ -2832,6 +2845,16 @@ void ShaderEngine::disableShader()
     cleanupFramebuffer(m_framebuffer, m_outputTexture);
     m_shaderActive = false;
     m_uniformLocations.clear();
+    m_shaderUniforms = ShaderUniformTable{};
+}
+
+void ShaderEngine::deleteProgram(GLuint program)
+{
+    // Chaves são "<id>_<nome>" e o driver reutiliza ids apagados: sem
+    // limpar, o próximo programa com o mesmo id herdaria locations (e -1s)
+    // do anterior.
+    glDeleteProgram(program);
+    m_uniformLocations.clear();
 }
 
 GLint ShaderEngine::getUniformLocation(GLuint program, const std::string &name)
@@ -2843,30 +2866,245 @@ GLint ShaderEngine::getUniformLocation(GLuint program, const std::string &name)
         return it->second;
     }
 
+    // Cachear também os ausentes (-1): sem isso todo uniform que o shader
+    // não declara voltava ao driver a cada chamada.
     GLint location = glGetUniformLocation(program, name.c_str());
-    if (location >= 0)
+    m_uniformLocations[key] = location;
+    return location;
+}
+
+namespace
+{
+// Valores padrão para uniforms de shaders antigos que não declaram
+// #pragma parameter para eles. Perdem para o #pragma e para o preset.
+struct LegacyUniformDefault
+{
+    const char *name;
+    float value;
+};
+const LegacyUniformDefault kLegacyUniformDefaults[] = {
+    {"BLURSCALEX", 0.30f},
+    {"LOWLUMSCAN", 6.0f},
+    {"HILUMSCAN", 8.0f},
+    {"BRIGHTBOOST", 1.25f},
+    {"MASK_DARK", 0.25f},
+    {"MASK_FADE", 0.8f},
+    // Parâmetros comuns de outros shaders (valores seguros/padrão)
+    {"RESSWITCH_ENABLE", 1.0f},
+    {"RESSWITCH_GLITCH_TRESHOLD", 0.1f},
+    {"RESSWITCH_GLITCH_BAR_STR", 0.6f},
+    {"RESSWITCH_GLITCH_BAR_SIZE", 0.5f},
+    {"RESSWITCH_GLITCH_BAR_SMOOTH", 1.0f},
+    {"RESSWITCH_GLITCH_SHAKE_MAX", 0.25f},
+    {"RESSWITCH_GLITCH_ROT_MAX", 0.2f},
+    {"RESSWITCH_GLITCH_WOB_MAX", 0.1f},
+    // Grade/Afterglow
+    {"AS", 0.20f},   // Afterglow Strength
+    {"asat", 0.33f}, // Afterglow saturation
+    {"PR", 0.32f},   // Persistence Red
+    {"PG", 0.32f},   // Persistence Green
+    {"PB", 0.32f},   // Persistence Blue
+    // Resolução e escala
+    {"internal_res", 1.0f},
+    {"auto_res", 0.0f},
+};
+
+GLint firstUniformLocation(GLuint program, std::initializer_list<std::string> names)
+{
+    for (const auto &name : names)
     {
-        m_uniformLocations[key] = location;
+        GLint loc = glGetUniformLocation(program, name.c_str());
+        if (loc >= 0)
+        {
+            return loc;
+        }
     }
-    return location;
+    return -1;
 }
+} // namespace
 
-void ShaderEngine::preCacheCommonUniforms(GLuint program)
+void ShaderEngine::buildUniformTable(GLuint program, const ShaderPassData *pass, size_t passIndex,
+                                     ShaderUniformTable &table)
 {
-    // Lista de uniforms comuns usados frequentemente
-    // Pré-cachear após linkagem para evitar chamadas glGetUniformLocation repetidas
-    const std::vector<std::string> commonUniforms = {
-        "Texture", "Source", "InputTexture", "OrigTexture",
-        "SourceSize", "InputSize", "OutputSize", "OriginalSize",
-        "IN.texture_size", "IN.video_size", "IN.output_size",
-        "IN.frame_count", "FRAMEINDEX", "TIME",
-        "brightness", "contrast", "flipY"
-    };
-    
-    for (const auto& uniformName : commonUniforms)
+    table = ShaderUniformTable{};
+    if (program == 0)
+    {
+        return;
+    }
+
+    auto loc = [program](const std::string &name)
+    { return glGetUniformLocation(program, name.c_str()); };
+
+    // Lista de nomes comuns de uniforms de textura no RetroArch, em ordem de preferência
+    table.source = firstUniformLocation(program, {"Texture", "Source", "Input", "s_p", "tex", "image"});
+    table.textureSize = loc("TextureSize");
+    table.inputSize = loc("InputSize");
+    table.outputSize = loc("OutputSize");
+
+    // Tipos de OutputSize (vec2/vec3/vec4) e FrameCount (int/float) variam
+    // entre shaders; resolver uma vez aqui em vez de varrer glGetActiveUniform por frame.
+    GLint numUniforms = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &numUniforms);
+    for (GLint i = 0; i < numUniforms; ++i)
+    {
+        char uniformName[256];
+        GLint uniformSize = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, sizeof(uniformName), nullptr, &uniformSize, &type, uniformName);
+        if (std::strcmp(uniformName, "OutputSize") == 0)
+        {
+            table.outputSizeType = type;
+        }
+        else if (std::strcmp(uniformName, "FrameCount") == 0)
+        {
+            table.frameCountIsInt = (type == GL_INT);
+        }
+    }
+
+    if (!pass)
+    {
+        // Shader único: só Texture e os tamanhos acima são alimentados
+        return;
+    }
+
+    table.sourceSize = loc("SourceSize");
+    table.originalSize = loc("OriginalSize");
+    table.frameCount = loc("FrameCount");
+    table.mvpMatrix = loc("MVPMatrix");
+    table.frameDirection = loc("FrameDirection");
+    for (int i = 0; i <= 7; ++i)
+    {
+        table.originalHistorySize[i] = loc("OriginalHistorySize" + std::to_string(i));
+    }
+    table.passScale = loc("PassScale");
+    table.passScaleX = loc("PassScaleX");
+    table.passScaleY = loc("PassScaleY");
+    table.passFilter = loc("PassFilter");
+    table.inVideoSize = loc("IN.video_size");
+    table.inTextureSize = loc("IN.texture_size");
+    table.inOutputSize = loc("IN.output_size");
+    table.inFrameCount = loc("IN.frame_count");
+    table.frameIndex = loc("FRAMEINDEX");
+    table.time = loc("TIME");
+    table.origTexture = loc("OrigTexture");
+
+    // Histórico de frames (motion blur). A checagem de needsHistory usa só os
+    // nomes Prev*, o bind no pass 0 aceita também PassPrev<N>Texture.
+    for (int prevIdx = 0; prevIdx < 7; ++prevIdx)
+    {
+        const std::string prevName = (prevIdx == 0) ? "PrevTexture" : "Prev" + std::to_string(prevIdx) + "Texture";
+        const GLint prevLoc = loc(prevName);
+        if (prevLoc >= 0)
+        {
+            table.needsHistory = true;
+        }
+        if (passIndex == 0)
+        {
+            table.history[prevIdx] = prevLoc >= 0 ? prevLoc : loc("PassPrev" + std::to_string(prevIdx) + "Texture");
+        }
+    }
+
+    const auto &presetPasses = m_preset.getPasses();
+    if (passIndex > 0)
+    {
+        table.prevPasses.resize(passIndex);
+        for (size_t prevPass = 0; prevPass < passIndex; ++prevPass)
+        {
+            ShaderUniformTable::PrevPassSlot &slot = table.prevPasses[prevPass];
+            const std::string nStr = std::to_string(passIndex - prevPass);
+            slot.texture = firstUniformLocation(program,
+                                                {"PassPrev" + nStr + "Texture",
+                                                 prevPass == 0 ? std::string("PrevTexture")
+                                                               : "Prev" + std::to_string(prevPass) + "Texture"});
+            slot.textureSize = loc("PassPrev" + nStr + "TextureSize");
+            slot.inputSize = loc("PassPrev" + nStr + "InputSize");
+            slot.outputSize = loc("PassPrev" + nStr + "OutputSize");
+            slot.passOutputSize = loc("PassOutputSize" + std::to_string(prevPass));
+            slot.passInputSize = loc("PassInputSize" + std::to_string(prevPass));
+
+            const std::string &alias = prevPass < presetPasses.size() ? presetPasses[prevPass].alias : std::string();
+            if (!alias.empty())
+            {
+                slot.alias = loc(alias);
+                slot.aliasSize = loc(alias + "Size");
+            }
+        }
+
+        // PassPrev<N>Texture com N > pass corrente aponta pro input original
+        for (size_t N = passIndex + 1; N <= passIndex + 12; ++N)
+        {
+            const GLint origLoc = loc("PassPrev" + std::to_string(N) + "Texture");
+            if (origLoc >= 0)
+            {
+                table.passPrevOriginal.push_back(origLoc);
+            }
+        }
+    }
+
+    table.feedback.resize(passIndex + 1);
+    for (size_t fbPass = 0; fbPass <= passIndex; ++fbPass)
+    {
+        const std::string idxStr = std::to_string(fbPass);
+        table.feedback[fbPass].texture = firstUniformLocation(program,
+                                                              {"PassFeedback" + idxStr,
+                                                               "PassFeedback" + idxStr + "Texture"});
+        table.feedback[fbPass].size = firstUniformLocation(program,
+                                                           {"PassFeedback" + idxStr + "Size",
+                                                            "PassFeedback" + idxStr + "TextureSize"});
+    }
+
+    table.textureReferences.reserve(m_textureReferences.size());
+    for (const auto &texRef : m_textureReferences)
+    {
+        table.textureReferences.push_back(loc(texRef.first));
+    }
+
+    // Parâmetros float: um slot por nome, com o fallback de menor precedência
+    // (constante legada < #pragma parameter). Parâmetros do preset que o pass
+    // não declara via #pragma também entram, com o próprio valor do preset.
+    std::map<std::string, float> fallbacks;
+    for (const auto &def : kLegacyUniformDefaults)
+    {
+        fallbacks[def.name] = def.value;
+    }
+    for (const auto &param : pass->extractedParameters)
+    {
+        fallbacks[param.first] = param.second;
+    }
+    for (const auto &param : m_preset.getParameters())
+    {
+        fallbacks.insert(param);
+    }
+    for (const auto &entry : fallbacks)
+    {
+        const GLint paramLoc = loc(entry.first);
+        if (paramLoc < 0)
+        {
+            continue;
+        }
+        ShaderUniformTable::ParamSlot slot;
+        slot.location = paramLoc;
+        slot.name = entry.first;
+        slot.fallback = entry.second;
+        table.parameters.push_back(slot);
+    }
+}
+
+float ShaderEngine::resolveParameterValue(const std::string &name, float fallback) const
+{
+    // Precedência: valor do usuário > valor do preset > fallback
+    auto customIt = m_customParameters.find(name);
+    if (customIt != m_customParameters.end())
+    {
+        return customIt->second;
+    }
+    const auto &presetParams = m_preset.getParameters();
+    auto presetIt = presetParams.find(name);
+    if (presetIt != presetParams.end())
     {
-        getUniformLocation(program, uniformName);
+        return presetIt->second;
     }
+    return fallback;
 }
 
 void ShaderEngine::createFramebuffer(uint32_t width, uint32_t height, bool floatBuffer, GLuint &fb, GLuint &tex, bool srgbBuffer)
@@ -3380,8 +3618,9 @@ bool ShaderEngine::setShaderParameter(const std::string &name, float value)
     // Clamp valor entre min e max
     float clampedValue = std::max(minVal, std::min(maxVal, value));
 
-    // Armazenar valor customizado
+    // Armazenar valor customizado; os passes reenviam na próxima renderização
     m_customParameters[name] = clampedValue;
+    m_parameterRevision++;
 
     return true;
 }
@@ -2,11 +2,16 @@
 
 #include "../renderer/glad_loader.h"
 #include "ShaderPreset.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderProgramCache.h"
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <map>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <thread>
 
 struct ShaderParameterInfo {
     float defaultValue;
@@ -16,6 +21,74 @@ struct ShaderParameterInfo {
     std::string description;
 };
 
+// Locations de uniforms de um programa, resolvidas uma única vez após a
+// linkagem (-1 = não declarado ou otimizado fora pelo compilador GLSL).
+// O caminho por frame (setupUniforms e bind de texturas) só lê esta tabela:
+// nenhuma chamada a glGetUniformLocation nem chave string por uniform.
+struct ShaderUniformTable {
+    // Uniform float de parâmetro: #pragma parameter, parâmetro global do
+    // preset ou constante legada. Só é reenviado quando o valor muda.
+    struct ParamSlot {
+        GLint location = -1;
+        std::string name;
+        float fallback = 0.0f; // usado sem valor do usuário nem do preset
+        float pushed = 0.0f;   // último valor enviado ao programa
+        bool hasPushed = false;
+    };
+    // Pass anterior P visto do pass corrente (índice = P)
+    struct PrevPassSlot {
+        GLint texture = -1;     // PassPrev<i-P>Texture, senão PrevTexture/Prev<P>Texture
+        GLint textureSize = -1; // PassPrev<i-P>TextureSize
+        GLint inputSize = -1;   // PassPrev<i-P>InputSize
+        GLint outputSize = -1;  // PassPrev<i-P>OutputSize
+        GLint passOutputSize = -1; // PassOutputSize<P>
+        GLint passInputSize = -1;  // PassInputSize<P>
+        GLint alias = -1;       // <aliasP>
+        GLint aliasSize = -1;   // <aliasP>Size
+    };
+    struct FeedbackSlot {
+        GLint texture = -1; // PassFeedback<N> / PassFeedback<N>Texture
+        GLint size = -1;    // PassFeedback<N>Size / PassFeedback<N>TextureSize
+    };
+
+    GLint source = -1; // Texture/Source/Input/s_p/tex/image (o primeiro declarado)
+    GLint sourceSize = -1;
+    GLint originalSize = -1;
+    GLint outputSize = -1;
+    GLenum outputSizeType = GL_FLOAT_VEC2;
+    GLint frameCount = -1;
+    bool frameCountIsInt = false;
+    GLint mvpMatrix = -1;
+    GLint frameDirection = -1;
+    GLint originalHistorySize[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+    GLint passScale = -1;
+    GLint passScaleX = -1;
+    GLint passScaleY = -1;
+    GLint passFilter = -1;
+    GLint textureSize = -1;
+    GLint inputSize = -1;
+    GLint inVideoSize = -1;
+    GLint inTextureSize = -1;
+    GLint inOutputSize = -1;
+    GLint inFrameCount = -1;
+    GLint frameIndex = -1;
+    GLint time = -1;
+
+    // Histórico de frames (só pass 0): PrevTexture..Prev6Texture ou PassPrev<N>Texture
+    GLint history[7] = {-1, -1, -1, -1, -1, -1, -1};
+    bool needsHistory = false;
+    std::vector<PrevPassSlot> prevPasses;
+    std::vector<GLint> passPrevOriginal; // PassPrev<N>Texture com N > pass corrente
+    std::vector<FeedbackSlot> feedback;  // índice = pass alvo (0..pass corrente)
+    GLint origTexture = -1;
+    // Na ordem de iteração de m_textureReferences no momento da construção
+    std::vector<GLint> textureReferences;
+
+    std::vector<ParamSlot> parameters;
+    uint64_t parameterRevision = 0; // m_parameterRevision já aplicado (0 = nunca)
+    bool constantsPushed = false;   // MVPMatrix, FrameDirection, PassScale*, PassFilter
+};
+
 struct ShaderPassData {
     GLuint program = 0;
     GLuint vertexShader = 0;
@@ -37,6 +110,8 @@ struct ShaderPassData {
     GLuint feedbackTexture = 0;
     GLuint feedbackFramebuffer = 0;
     bool feedbackEnabled = false;
+
+    ShaderUniformTable uniforms;
 };
 
 class ShaderEngine {
@@ -53,6 +128,23 @@ public:
     // Carregar preset com múltiplos passes
     bool loadPreset(const std::string& presetPath);
     std::string getPresetPath() const { return m_presetPath; }
+
+    // Carregar preset sem travar o render: leitura, pré-processamento e
+    // decodificação das LUTs numa thread; compilação/linkagem na thread GL
+    // via pollPendingPreset(). O preset atual continua sendo aplicado até o
+    // novo estar todo linkado. initialParameters são aplicados na troca
+    // (como setShaderParameter logo após um loadPreset). Um pedido novo ou
+    // disableShader()/loadPreset() descartam o anterior. Se algum pass não
+    // compilar, o preset atual é mantido.
+    bool loadPresetAsync(const std::string& presetPath,
+                         const std::map<std::string, float>& initialParameters = {});
+    // Preset pedido via loadPresetAsync e ainda não ativo ("" = nenhum)
+    const std::string& getPendingPresetPath() const { return m_pendingPresetPath; }
+    // Altera um initialParameter do preset pendente (aplicado só na troca);
+    // false se não há preset pendente
+    bool setPendingPresetParameter(const std::string& name, float value);
+    // Chamar uma vez por frame na thread GL, fora do applyShader
+    void pollPendingPreset();
     
     // Aplicar shader/preset na textura
     GLuint applyShader(GLuint inputTexture, uint32_t width, uint32_t height);
@@ -108,6 +200,7 @@ private:
     GLuint m_outputTexture = 0;
     uint32_t m_outputWidth = 0;
     uint32_t m_outputHeight = 0;
+    ShaderUniformTable m_shaderUniforms;
     
     // Modo preset (múltiplos passes)
     ShaderPreset m_preset;
@@ -123,33 +216,91 @@ private:
     uint32_t m_maxShaderWidth = 0;  // 0 = sem limite
     uint32_t m_maxShaderHeight = 0; // 0 = sem limite
     
+    // Binários de programas já linkados (Paths::getCacheDir()/shaders)
+    ShaderProgramCache m_programCache;
+
+    // Fonte de um pass lida e pré-processada — sem GL, roda fora da thread GL
+    struct PreparedPassSource {
+        bool ok = false;
+        std::string vertexSource;
+        std::string fragmentSource;
+        std::map<std::string, float> extractedParameters;
+        std::map<std::string, ShaderParameterInfo> parameterInfo;
+    };
+    // LUT do preset decodificada para RGBA8, aguardando upload
+    struct DecodedTexture {
+        std::string name;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> pixels;
+    };
+    // Preset de loadPresetAsync. A thread de carga preenche preset/sources/
+    // textures; passes/cacheKeys/nextPass só são tocados na thread GL.
+    struct PendingPreset {
+        uint64_t generation = 0;
+        std::string path;
+        std::map<std::string, float> parameters;
+        bool parsed = false;
+        ShaderPreset preset;
+        std::vector<PreparedPassSource> sources;
+        std::vector<DecodedTexture> textures;
+
+        std::vector<ShaderPassData> passes;
+        std::vector<std::string> cacheKeys; // vazio com o cache desligado
+        std::vector<bool> compiling;        // link disparado (não veio do cache)
+        size_t nextPass = 0;
+        bool linksIssued = false;
+        bool failed = false;
+    };
+    std::thread m_loadThread;
+    std::atomic<bool> m_loadThreadDone{false};
+    // Incrementado a cada pedido/cancelamento; resultados de outra geração são descartados
+    std::atomic<uint64_t> m_loadGeneration{0};
+    std::unique_ptr<PendingPreset> m_loadJob;      // com a thread de carga até m_loadThreadDone
+    std::unique_ptr<PendingPreset> m_queuedLoad;   // pedido esperando a thread ficar livre
+    std::unique_ptr<PendingPreset> m_pendingPreset; // compilando na thread GL
+    std::string m_pendingPresetPath;
+    
     // VAO para renderização
     GLuint m_VAO = 0;
     GLuint m_VBO = 0;
     GLuint m_EBO = 0;
     
-    // Uniforms
+    // Uniforms (m_uniformLocations só atende setUniform(); o render usa ShaderUniformTable)
     std::unordered_map<std::string, GLint> m_uniformLocations;
     float m_frameCount = 0.0f;
     float m_time = 0.0f;
     
     // Parâmetros customizados (valores alterados pelo usuário)
     std::map<std::string, float> m_customParameters;
+    // Incrementado a cada mudança em m_customParameters; as tabelas de
+    // uniforms comparam com o seu parameterRevision para saber se reenviam.
+    uint64_t m_parameterRevision = 1;
     
-    // Histórico de frames para motion blur (mantém até 7 frames anteriores)
-    std::vector<GLuint> m_frameHistory; // Texturas de frames anteriores
-    std::vector<uint32_t> m_frameHistoryWidths;
-    std::vector<uint32_t> m_frameHistoryHeights;
+    // Histórico de frames para motion blur (PrevTexture..Prev6Texture,
+    // OriginalHistorySize1..7): ring de tamanho fixo com a profundidade que
+    // o preset realmente referencia — vazio (nenhuma cópia) quando nenhum pass usa
+    struct HistorySlot {
+        GLuint texture = 0;
+        GLuint framebuffer = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool floatBuffer = false; // mesmo formato do pass de origem
+        bool srgbBuffer = false;
+    };
+    std::vector<HistorySlot> m_frameHistory;
+    size_t m_frameHistoryHead = 0;  // slot do frame mais recente
+    size_t m_frameHistoryCount = 0; // slots já preenchidos
     static constexpr size_t MAX_FRAME_HISTORY = 7;
     
-    // Framebuffer temporário reutilizável para copiar frames ao histórico
-    // Criado uma vez e reutilizado entre frames (evita criar/deletar a cada frame)
-    GLuint m_copyFramebuffer = 0;
-    
     bool compileShader(const std::string& source, GLenum type, GLuint& shader);
     bool linkProgram(GLuint vertexShader, GLuint fragmentShader);
     GLint getUniformLocation(GLuint program, const std::string& name);
-    void preCacheCommonUniforms(GLuint program); // Pré-cachear uniforms comuns após linkagem
+    // glDeleteProgram + invalida m_uniformLocations (o driver reutiliza ids)
+    void deleteProgram(GLuint program);
+    // Monta a tabela de locations após a linkagem. pass == nullptr: shader único.
+    void buildUniformTable(GLuint program, const ShaderPassData* pass, size_t passIndex, ShaderUniformTable& table);
+    float resolveParameterValue(const std::string& name, float fallback) const;
     void createFramebuffer(uint32_t width, uint32_t height, bool floatBuffer, GLuint& fb, GLuint& tex, bool srgbBuffer = false);
     void cleanupFramebuffer(GLuint& fb, GLuint& tex);
     void createQuad();
@@ -159,28 +310,60 @@ private:
     std::string generateDefaultVertexShader();
     
     // Preset functions
+    static bool checkPresetExtension(const std::string& presetPath);
     bool loadPresetPasses();
     // #154 — per-pass compile/link loop body extracted from loadPresetPasses (behavior-preserving).
     bool compilePass(size_t i);
+    // Lê e pré-processa o pass i. Sem GL: usado também pela thread de carga.
+    static bool preparePassSource(size_t i, const ShaderPass& passInfo, const std::vector<ShaderPass>& presetPasses,
+                                  const ShaderPreprocessor::ContextInfo& context, PreparedPassSource& out);
+    // Compila e linka (ou busca no cache) o programa do pass. Não monta a
+    // tabela de uniforms: ela depende do preset e das LUTs ativos.
+    bool linkPassProgram(size_t i, const ShaderPass& passInfo, const std::string& vertexSource,
+                         std::string fragmentSource, ShaderPassData& passData);
+    static void bindPassAttribLocations(GLuint program);
+
+    // Carga em segundo plano
+    void startLoadThread(std::unique_ptr<PendingPreset> job);
+    static void preparePendingPreset(PendingPreset& job, const ShaderPreprocessor::ContextInfo& context,
+                                     const std::atomic<uint64_t>& generation);
+    // Avança compilação/linkagem; true quando todos os passes terminaram
+    bool advancePendingPreset(PendingPreset& pending);
+    void issuePendingLink(PendingPreset& pending, size_t i);
+    bool finishPendingLink(PendingPreset& pending, size_t i);
+    void activatePendingPreset(PendingPreset& pending);
+    void releasePendingPreset(PendingPreset& pending);
+    void cancelPendingPreset();
     void cleanupPresetPasses();
+    // Dimensiona o ring de histórico pelas tabelas de uniforms dos passes
+    void configureFrameHistory();
+    // Copia (blit) o frame de sourceFramebuffer para o próximo slot do ring;
+    // o slot é alocado com o formato (float/sRGB) do pass de origem
+    void pushFrameHistory(GLuint sourceFramebuffer, uint32_t width, uint32_t height,
+                          bool floatBuffer, bool srgbBuffer);
+    // age 0 = frame anterior; nullptr se ainda não há frame tão antigo
+    const HistorySlot* frameHistoryAt(size_t age) const;
+    void cleanupFrameHistory();
     uint32_t calculateScale(uint32_t sourceSize, const std::string& scaleType, float scale,
                            uint32_t viewportSize, uint32_t absoluteValue);
     // #154 — applyShader() bodies extracted (behavior-preserving): one preset pass + the simple single-shader path.
     void renderMultipassPass(size_t i, GLuint &currentTexture, uint32_t &currentWidth,
                              uint32_t &currentHeight, GLuint originalTexture);
     GLuint renderSinglePass(GLuint inputTexture, uint32_t width, uint32_t height);
-    void setupUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight,
+    void setupUniforms(ShaderUniformTable& u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight,
                       uint32_t outputWidth, uint32_t outputHeight);
     // #154 — setupUniforms() split into cohesive uniform-group helpers (behavior-preserving).
-    void applyCoreSizeUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight,
+    void applyCoreSizeUniforms(const ShaderUniformTable& u, uint32_t inputWidth, uint32_t inputHeight,
                                uint32_t outputWidth, uint32_t outputHeight);
-    void applyPassSizeUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight);
-    void applyFrameUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight);
-    void applyShaderParameterUniforms(GLuint program, uint32_t passIndex);
-    void applyAlternateSizeUniforms(GLuint program, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight,
+    void applyPassSizeUniforms(const ShaderUniformTable& u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight);
+    void applyFrameUniforms(const ShaderUniformTable& u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight);
+    void applyShaderParameterUniforms(ShaderUniformTable& u);
+    void applyAlternateSizeUniforms(const ShaderUniformTable& u, uint32_t passIndex, uint32_t inputWidth, uint32_t inputHeight,
                                     uint32_t outputWidth, uint32_t outputHeight);
-    void applyGlobalPresetUniforms(GLuint program);
+    void applyGlobalPresetUniforms(const ShaderUniformTable& u);
     bool loadTextureReference(const std::string& name, const std::string& path);
+    static bool decodeTextureReference(const std::string& name, const std::string& path, DecodedTexture& out);
+    void uploadTextureReference(const DecodedTexture& image);
     void cleanupTextureReferences();
     
     // Funções auxiliares para aplicar configurações de textura
@@ -8,6 +8,46 @@
 #include <regex>
 #include <algorithm>
 
+ShaderPreprocessor::ContextInfo ShaderPreprocessor::queryContext()
+{
+    ContextInfo info;
+    info.glslVersion = getGLSLVersionString();
+    info.isES = isOpenGLES();
+
+    // Probe whether GL_ARB_shading_language_420pack is actually
+    // exposed by this GL context. Some macOS GPUs (Intel Iris under
+    // OpenGL 4.1) do not expose it even though shaders ship with a
+    // `#extension ... : require` line — requiring it then fails
+    // compile. Default to not requiring it; only emit the
+    // `#extension : require` line when the driver actually has it,
+    // and strip stray `#extension` lines from shader sources
+    // otherwise (same code path as the OpenGL ES branch).
+    auto checkExtension = [](const char *name) -> bool {
+        const GLubyte *raw = glGetString(GL_EXTENSIONS);
+        if (!raw)
+        {
+            return false;
+        }
+        const std::string extStr = reinterpret_cast<const char *>(raw);
+        const std::string needle = name;
+        size_t pos = 0;
+        while ((pos = extStr.find(needle, pos)) != std::string::npos)
+        {
+            const bool startOk = (pos == 0) || (extStr[pos - 1] == ' ');
+            const size_t endPos = pos + needle.size();
+            const bool endOk = (endPos == extStr.size()) || (extStr[endPos] == ' ');
+            if (startOk && endOk)
+            {
+                return true;
+            }
+            pos = endPos;
+        }
+        return false;
+    };
+    info.has420Pack = !info.isES && checkExtension("GL_ARB_shading_language_420pack");
+    return info;
+}
+
 ShaderPreprocessor::PreprocessResult ShaderPreprocessor::preprocess(
     const std::string& shaderSource,
     const std::string& shaderPath,
@@ -17,6 +57,21 @@ ShaderPreprocessor::PreprocessResult ShaderPreprocessor::preprocess(
     uint32_t inputWidth,
     uint32_t inputHeight,
     const std::vector<ShaderPass>& presetPasses)
+{
+    return preprocess(shaderSource, shaderPath, passIndex, outputWidth, outputHeight,
+                      inputWidth, inputHeight, presetPasses, queryContext());
+}
+
+ShaderPreprocessor::PreprocessResult ShaderPreprocessor::preprocess(
+    const std::string& shaderSource,
+    const std::string& shaderPath,
+    size_t passIndex,
+    uint32_t outputWidth,
+    uint32_t outputHeight,
+    uint32_t inputWidth,
+    uint32_t inputHeight,
+    const std::vector<ShaderPass>& presetPasses,
+    const ContextInfo& context)
 {
     PreprocessResult result;
 
@@ -118,7 +173,7 @@ ShaderPreprocessor::PreprocessResult ShaderPreprocessor::preprocess(
     else
     {
         // Adicionar versão GLSL dinâmica baseada na versão OpenGL disponível
-        versionLine = getGLSLVersionString() + "\n";
+        versionLine = context.glslVersion + "\n";
     }
 
     // Construir shaders: version + extension + define + código completo
@@ -126,40 +181,8 @@ ShaderPreprocessor::PreprocessResult ShaderPreprocessor::preprocess(
     // e "#define FRAGMENT\n#define PARAMETER_UNIFORM\n" para fragment
     // IMPORTANTE: RetroArch também adiciona defines para compatibilidade
     
-    // Verificar se estamos usando OpenGL ES
-    bool isES = isOpenGLES();
-
-    // Probe whether GL_ARB_shading_language_420pack is actually
-    // exposed by this GL context. Some macOS GPUs (Intel Iris under
-    // OpenGL 4.1) do not expose it even though shaders ship with a
-    // `#extension ... : require` line — requiring it then fails
-    // compile. Default to not requiring it; only emit the
-    // `#extension : require` line when the driver actually has it,
-    // and strip stray `#extension` lines from shader sources
-    // otherwise (same code path as the OpenGL ES branch).
-    auto checkExtension = [](const char *name) -> bool {
-        const GLubyte *raw = glGetString(GL_EXTENSIONS);
-        if (!raw)
-        {
-            return false;
-        }
-        const std::string extStr = reinterpret_cast<const char *>(raw);
-        const std::string needle = name;
-        size_t pos = 0;
-        while ((pos = extStr.find(needle, pos)) != std::string::npos)
-        {
-            const bool startOk = (pos == 0) || (extStr[pos - 1] == ' ');
-            const size_t endPos = pos + needle.size();
-            const bool endOk = (endPos == extStr.size()) || (extStr[endPos] == ' ');
-            if (startOk && endOk)
-            {
-                return true;
-            }
-            pos = endPos;
-        }
-        return false;
-    };
-    const bool has420Pack = !isES && checkExtension("GL_ARB_shading_language_420pack");
+    const bool isES = context.isES;
+    const bool has420Pack = context.has420Pack;
 
     // Adicionar extensão para inicialização estilo C (GL_ARB_shading_language_420pack)
     // Isso permite inicialização de arrays e estruturas estilo C
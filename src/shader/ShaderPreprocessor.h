@@ -32,6 +32,22 @@ public:
         std::map<std::string, ShaderParameterInfo> parameterInfo;  // Full parameter info
     };
 
+    /**
+     * GL context properties the preprocessor depends on. Query them on the
+     * GL thread with queryContext() and pass them in when preprocessing on
+     * another thread (background preset loads).
+     */
+    struct ContextInfo {
+        std::string glslVersion;  // #version line used when the shader has none
+        bool isES = false;
+        bool has420Pack = false;  // GL_ARB_shading_language_420pack exposed
+    };
+
+    /**
+     * Query ContextInfo from the current GL context. GL thread only.
+     */
+    static ContextInfo queryContext();
+
     /**
      * Preprocess shader source code.
      * 
@@ -62,6 +78,20 @@ public:
         uint32_t inputHeight,
         const std::vector<ShaderPass>& presetPasses);
 
+    /**
+     * Same as above, but makes no GL calls: safe on any thread.
+     */
+    static PreprocessResult preprocess(
+        const std::string& shaderSource,
+        const std::string& shaderPath,
+        size_t passIndex,
+        uint32_t outputWidth,
+        uint32_t outputHeight,
+        uint32_t inputWidth,
+        uint32_t inputHeight,
+        const std::vector<ShaderPass>& presetPasses,
+        const ContextInfo& context);
+
     /**
      * Process #include directives.
      * Public so it can be used by ShaderEngine for simple shader loading.
@@ -0,0 +1,277 @@
+#include "ShaderProgramCache.h"
+#include "../utils/Logger.h"
+#include "../utils/FilesystemCompat.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <sys/stat.h>
+
+namespace
+{
+const char kMagic[4] = {'R', 'C', 'P', 'B'};
+
+struct EntryHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t driverIdLength;
+    uint32_t vertexLength;
+    uint32_t fragmentLength;
+    uint32_t binaryLength;
+};
+
+void fnv1a(uint64_t &hash, const std::string &data)
+{
+    for (unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    // Separador: "ab"+"c" e "a"+"bc" não podem colidir
+    hash ^= 0xFF;
+    hash *= 1099511628211ULL;
+}
+
+std::string glString(GLenum name)
+{
+    const char *value = reinterpret_cast<const char *>(glGetString(name));
+    return value ? value : "";
+}
+
+bool readString(std::ifstream &file, uint32_t length, std::string &out)
+{
+    out.resize(length);
+    return length == 0 || static_cast<bool>(file.read(&out[0], length));
+}
+} // namespace
+
+bool ShaderProgramCache::init(const std::string &directory)
+{
+    m_enabled = false;
+    if (directory.empty() || !hasProgramBinary())
+    {
+        return false;
+    }
+    try
+    {
+        if (!fs::exists(directory))
+        {
+            fs::create_directories(directory);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN("ShaderProgramCache: Cannot create " + directory + ": " + e.what());
+        return false;
+    }
+
+    m_directory = directory;
+    m_driverId = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION) + "|" +
+                 glString(GL_SHADING_LANGUAGE_VERSION);
+    m_enabled = true;
+    prune();
+    LOG_INFO("ShaderProgramCache: " + m_directory);
+    return true;
+}
+
+std::string ShaderProgramCache::key(const std::string &vertexSource, const std::string &fragmentSource) const
+{
+    uint64_t hash = 14695981039346656037ULL;
+    fnv1a(hash, std::to_string(kFormatVersion));
+    fnv1a(hash, m_driverId);
+    fnv1a(hash, vertexSource);
+    fnv1a(hash, fragmentSource);
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(hash));
+    return buf;
+}
+
+std::string ShaderProgramCache::entryPath(const std::string &key) const
+{
+    return (fs::path(m_directory) / (key + ".bin")).string();
+}
+
+GLuint ShaderProgramCache::load(const std::string &key, const std::string &vertexSource,
+                                const std::string &fragmentSource)
+{
+    if (!m_enabled)
+    {
+        return 0;
+    }
+    const std::string path = entryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        return 0;
+    }
+
+    EntryHeader header{};
+    std::string driverId, vertex, fragment;
+    std::vector<char> binary;
+    bool valid = static_cast<bool>(file.read(reinterpret_cast<char *>(&header), sizeof(header))) &&
+                 std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kFormatVersion &&
+                 header.binaryLength > 0 &&
+                 readString(file, header.driverIdLength, driverId) && driverId == m_driverId &&
+                 readString(file, header.vertexLength, vertex) && vertex == vertexSource &&
+                 readString(file, header.fragmentLength, fragment) && fragment == fragmentSource;
+    if (valid)
+    {
+        binary.resize(header.binaryLength);
+        valid = static_cast<bool>(file.read(binary.data(), binary.size()));
+    }
+    file.close();
+
+    GLuint program = 0;
+    if (valid)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            // Driver atualizado sem mudar as strings de versão, ou binário truncado
+            glDeleteProgram(program);
+            program = 0;
+            valid = false;
+        }
+    }
+
+    if (!valid)
+    {
+        LOG_INFO("ShaderProgramCache: Discarding stale entry " + key);
+        std::remove(path.c_str());
+        return 0;
+    }
+
+    return program;
+}
+
+void ShaderProgramCache::prepareProgram(GLuint program) const
+{
+    if (m_enabled)
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void ShaderProgramCache::store(const std::string &key, const std::string &vertexSource,
+                               const std::string &fragmentSource, GLuint program)
+{
+    if (!m_enabled || program == 0)
+    {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return;
+    }
+    std::vector<char> binary(static_cast<size_t>(length));
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+    {
+        return;
+    }
+
+    EntryHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.binaryFormat = format;
+    header.driverIdLength = static_cast<uint32_t>(m_driverId.size());
+    header.vertexLength = static_cast<uint32_t>(vertexSource.size());
+    header.fragmentLength = static_cast<uint32_t>(fragmentSource.size());
+    header.binaryLength = static_cast<uint32_t>(written);
+
+    const std::string path = entryPath(key);
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            LOG_WARN("ShaderProgramCache: Failed to open " + tmp);
+            return;
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(m_driverId.data(), m_driverId.size());
+        file.write(vertexSource.data(), vertexSource.size());
+        file.write(fragmentSource.data(), fragmentSource.size());
+        file.write(binary.data(), written);
+        if (!file.good())
+        {
+            LOG_WARN("ShaderProgramCache: Failed to write " + tmp);
+            file.close();
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        // Windows rename doesn't replace an existing file.
+        std::remove(path.c_str());
+        if (std::rename(tmp.c_str(), path.c_str()) != 0)
+        {
+            LOG_WARN("ShaderProgramCache: Failed to replace " + path);
+            std::remove(tmp.c_str());
+        }
+    }
+}
+
+void ShaderProgramCache::prune()
+{
+    struct Entry
+    {
+        std::string path;
+        int64_t mtime;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    try
+    {
+        for (fs::directory_iterator it(m_directory), end; it != end; ++it)
+        {
+            const fs::path path = fs_helper::get_path(it);
+            struct stat st{};
+            if (!fs_helper::is_regular_file(it) || fs_helper::get_extension_string(path) != ".bin" ||
+                ::stat(path.string().c_str(), &st) != 0)
+            {
+                continue;
+            }
+            entries.push_back({path.string(), static_cast<int64_t>(st.st_mtime), static_cast<uint64_t>(st.st_size)});
+            total += static_cast<uint64_t>(st.st_size);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARN("ShaderProgramCache: Cannot scan " + m_directory + ": " + e.what());
+        return;
+    }
+    if (total <= kMaxCacheBytes)
+    {
+        return;
+    }
+
+    // Mais antigos primeiro
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b)
+              { return a.mtime < b.mtime; });
+    for (const auto &entry : entries)
+    {
+        if (total <= kMaxCacheBytes)
+        {
+            break;
+        }
+        if (std::remove(entry.path.c_str()) == 0)
+        {
+            total -= entry.size;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../renderer/glad_loader.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * On-disk cache of linked shader programs (glGetProgramBinary blobs).
+ *
+ * Entries are keyed by a hash of the preprocessed vertex + fragment source
+ * and the driver identity (GL vendor / renderer / version / GLSL version),
+ * so a driver update or an edited shader/include simply misses. Each entry
+ * also stores the sources it was built from; a load only succeeds if they
+ * match byte for byte and the driver accepts the binary (GL_LINK_STATUS),
+ * otherwise the entry is deleted and the caller compiles from source.
+ *
+ * Lives in Paths::getCacheDir()/shaders. MUST be used on the GL thread.
+ */
+class ShaderProgramCache
+{
+public:
+    // Inactive (load() misses, store() no-op) when the context has no
+    // program binary formats or the directory can't be created.
+    bool init(const std::string &directory);
+    bool isEnabled() const { return m_enabled; }
+
+    std::string key(const std::string &vertexSource, const std::string &fragmentSource) const;
+
+    // Linked program for key, or 0 on miss / rejected binary.
+    GLuint load(const std::string &key, const std::string &vertexSource, const std::string &fragmentSource);
+
+    // Call before glLinkProgram so the driver keeps a retrievable binary.
+    void prepareProgram(GLuint program) const;
+    // Save a successfully linked program. Failures only log.
+    void store(const std::string &key, const std::string &vertexSource, const std::string &fragmentSource,
+               GLuint program);
+
+private:
+    static constexpr uint32_t kFormatVersion = 1;
+    static constexpr uint64_t kMaxCacheBytes = 128ull * 1024 * 1024;
+
+    bool m_enabled = false;
+    std::string m_directory;
+    std::string m_driverId;
+
+    std::string entryPath(const std::string &key) const;
+    // Drop the oldest-written entries while the directory is over kMaxCacheBytes.
+    void prune();
+};
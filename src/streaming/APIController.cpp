@@ -8,6 +8,7 @@
 #include "../utils/PresetManager.h"
 #include "../recording/RecordingSettings.h"
 #include "../recording/RecordingMetadata.h"
+#include "../recording/RecordingCatalog.h"
 #include "../audio/IAudioCapture.h"
 #ifdef __linux__
 #include "../audio/AudioCapturePulse.h"
@@ -27,6 +28,7 @@
 #include <fstream>
 #include <cstdint>
 #include <climits>
+#include <cctype>
 #include "../utils/FilesystemCompat.h"
 
 // Falls back when the CMake compile flag isn't set (e.g. when a tool
@@ -135,6 +137,62 @@ namespace
         oss << "fnv1a64:" << std::hex << std::setw(16) << std::setfill('0') << h;
         return oss.str();
     }
+
+    // Value of ?key=... on the request line, percent/plus-decoded; empty
+    // when absent. extractPath() drops the query, so read it from here.
+    std::string queryParam(const std::string &request, const std::string &key)
+    {
+        const size_t lineEnd = request.find_first_of("\r\n");
+        const std::string line = request.substr(0, lineEnd);
+        const size_t q = line.find('?');
+        if (q == std::string::npos)
+            return "";
+        const size_t queryEnd = line.find(' ', q);
+        const std::string query = line.substr(q + 1, queryEnd == std::string::npos ? std::string::npos : queryEnd - q - 1);
+
+        size_t pos = 0;
+        while (pos <= query.size())
+        {
+            size_t amp = query.find('&', pos);
+            if (amp == std::string::npos)
+                amp = query.size();
+            const std::string pair = query.substr(pos, amp - pos);
+            const size_t eq = pair.find('=');
+            if (pair.substr(0, eq) == key)
+            {
+                const std::string raw = eq == std::string::npos ? "" : pair.substr(eq + 1);
+                std::string value;
+                for (size_t i = 0; i < raw.size(); ++i)
+                {
+                    if (raw[i] == '+')
+                        value += ' ';
+                    else if (raw[i] == '%' && i + 2 < raw.size() &&
+                             std::isxdigit(static_cast<unsigned char>(raw[i + 1])) &&
+                             std::isxdigit(static_cast<unsigned char>(raw[i + 2])))
+                    {
+                        value += static_cast<char>(std::stoi(raw.substr(i + 1, 2), nullptr, 16));
+                        i += 2;
+                    }
+                    else
+                        value += raw[i];
+                }
+                return value;
+            }
+            pos = amp + 1;
+        }
+        return "";
+    }
+
+    // Empty leaves value as is.
+    bool parseCount(const std::string &text, size_t &value)
+    {
+        if (text.empty())
+            return true;
+        if (text.find_first_not_of("0123456789") != std::string::npos || text.size() > 18)
+            return false;
+        value = static_cast<size_t>(std::stoull(text));
+        return true;
+    }
 }
 
 APIController::APIController()
@@ -502,6 +560,11 @@ bool APIController::routeGETSource(int clientFd, const std::string &path, bool &
         result = handleGETSourceOverscan(clientFd);
         return true;
     }
+    if (path == "/api/v1/source/jitter")
+    {
+        result = handleGETSourceJitter(clientFd);
+        return true;
+    }
     return false;
 }
 
@@ -574,7 +637,7 @@ bool APIController::routeGETRecording(int clientFd, const std::string &path, con
     }
     if (path == "/api/v1/recordings")
     {
-        result = handleGETRecordings(clientFd);
+        result = handleGETRecordings(clientFd, request);
         return true;
     }
     if (path.find("/api/v1/recordings/") == 0)
@@ -794,6 +857,11 @@ bool APIController::routePOSTRecording(int clientFd, const std::string &path, co
         result = handleSetRecordingControl(clientFd, body);
         return true;
     }
+    if (path == "/api/v1/recording/replay")
+    {
+        result = handleSetReplayControl(clientFd, body);
+        return true;
+    }
     if (path == "/api/v1/recording/profiles")
     {
         result = handleSaveRecordingProfile(clientFd, body);
@@ -1145,6 +1213,32 @@ bool APIController::handleGETSourceOverscan(int clientFd)
     return true;
 }
 
+bool APIController::handleGETSourceJitter(int clientFd)
+{
+    if (!m_uiManager)
+    {
+        sendErrorResponse(clientFd, 500, "UIManager not available");
+        return true;
+    }
+    // All zero outside client mode (no remote source).
+    const JitterBufferStats st = m_uiManager->getRemoteJitterStats();
+    std::ostringstream out;
+    out << "{"
+        << "\"delayMs\": " << jsonNumber(static_cast<float>(st.delayUs) / 1000.0f) << ", "
+        << "\"targetDelayMs\": " << jsonNumber(static_cast<float>(st.targetDelayUs) / 1000.0f) << ", "
+        << "\"jitterMs\": " << jsonNumber(static_cast<float>(st.jitterUs) / 1000.0f) << ", "
+        << "\"rate\": " << jsonNumber(st.rate) << ", "
+        << "\"depthFrames\": " << jsonNumber(st.depthFrames) << ", "
+        << "\"depthMs\": " << jsonNumber(static_cast<float>(st.depthUs) / 1000.0f) << ", "
+        << "\"framesReceived\": " << jsonNumber(st.framesReceived) << ", "
+        << "\"framesLate\": " << jsonNumber(st.framesLate) << ", "
+        << "\"framesDropped\": " << jsonNumber(st.framesDropped) << ", "
+        << "\"framesSkipped\": " << jsonNumber(st.framesSkipped)
+        << "}";
+    sendJSONResponse(clientFd, 200, out.str());
+    return true;
+}
+
 bool APIController::handleSetSourceOverscan(int clientFd, const std::string &body)
 {
     if (!m_uiManager)
@@ -2738,7 +2832,11 @@ bool APIController::handleGETRecordingSettings(int clientFd)
          << "\"outputPath\": " << jsonString(m_uiManager->getRecordingOutputPath()) << ", "
          << "\"filenameTemplate\": " << jsonString(m_uiManager->getRecordingFilenameTemplate()) << ", "
          << "\"includeAudio\": " << (m_uiManager->getRecordingIncludeAudio() ? "true" : "false") << ", "
-         << "\"applyShader\": " << jsonBool(m_uiManager->getRecordingApplyShader())
+         << "\"segmentRecording\": " << jsonBool(m_uiManager->getRecordingSegmentRecording()) << ", "
+         << "\"maxDurationUs\": " << jsonNumber(m_uiManager->getRecordingMaxDurationUs()) << ", "
+         << "\"maxFileSize\": " << jsonNumber(m_uiManager->getRecordingMaxFileSize()) << ", "
+         << "\"applyShader\": " << jsonBool(m_uiManager->getRecordingApplyShader()) << ", "
+         << "\"shareStreamEncoder\": " << jsonBool(m_uiManager->getRecordingShareStreamEncoder())
          << "}";
     sendJSONResponse(clientFd, 200, json.str());
     return true;
@@ -2762,7 +2860,8 @@ bool APIController::handleGETRecordingStatus(int clientFd)
          << "\"isRecording\": " << (isRecording ? "true" : "false") << ", "
          << "\"duration\": " << jsonNumber(durationUs) << ", "
          << "\"fileSize\": " << jsonNumber(fileSize) << ", "
-         << "\"currentFile\": " << jsonString(filename);
+         << "\"currentFile\": " << jsonString(filename) << ", "
+         << "\"replayBufferActive\": " << (m_uiManager->getReplayBufferActive() ? "true" : "false");
     
     if (isRecording)
     {
@@ -2779,7 +2878,7 @@ bool APIController::handleGETRecordingStatus(int clientFd)
     return true;
 }
 
-bool APIController::handleGETRecordings(int clientFd)
+bool APIController::handleGETRecordings(int clientFd, const std::string& request)
 {
     if (!m_application)
     {
@@ -2789,17 +2888,37 @@ bool APIController::handleGETRecordings(int clientFd)
 
     try
     {
-        auto recordings = m_application->listRecordings();
-        
+        // Sem parâmetros: a lista inteira, mais antiga primeiro (como antes).
+        // ?offset=&limit= paginam; order=desc; from/to filtram createdAt
+        // (ISO 8601, prefixo vale: from=2026-03); shader, source, session
+        // e q (trecho do nome do arquivo) filtram.
+        RecordingQuery query;
+        if (!parseCount(queryParam(request, "offset"), query.offset) ||
+            !parseCount(queryParam(request, "limit"), query.limit))
+        {
+            sendErrorResponse(clientFd, 400, "offset/limit must be non-negative integers");
+            return true;
+        }
+        query.newestFirst = queryParam(request, "order") == "desc";
+        query.from = queryParam(request, "from");
+        query.to = queryParam(request, "to");
+        query.shader = queryParam(request, "shader");
+        query.sourceType = queryParam(request, "source");
+        query.sessionId = queryParam(request, "session");
+        query.search = queryParam(request, "q");
+
+        RecordingPage page = m_application->queryRecordings(query);
+
         std::ostringstream json;
         json << "{\"recordings\": [";
-        for (size_t i = 0; i < recordings.size(); ++i)
+        for (size_t i = 0; i < page.items.size(); ++i)
         {
             if (i > 0)
                 json << ", ";
-            json << recordings[i].toJSON();
+            json << page.items[i].toJSON();
         }
-        json << "], \"total\": " << recordings.size() << "}";
+        json << "], \"total\": " << page.total << ", \"offset\": " << query.offset
+             << ", \"limit\": " << query.limit << "}";
         
         sendJSONResponse(clientFd, 200, json.str());
         return true;
@@ -2821,17 +2940,14 @@ bool APIController::handleGETRecording(int clientFd, const std::string& recordin
 
     try
     {
-        auto recordings = m_application->listRecordings();
-        auto it = std::find_if(recordings.begin(), recordings.end(),
-                              [&recordingId](const RecordingMetadata& m) { return m.id == recordingId; });
-        
-        if (it == recordings.end())
+        RecordingMetadata recording;
+        if (!m_application->getRecording(recordingId, recording))
         {
             sendErrorResponse(clientFd, 404, "Recording not found");
             return true;
         }
         
-        sendJSONResponse(clientFd, 200, it->toJSON().dump());
+        sendJSONResponse(clientFd, 200, recording.toJSON().dump());
         return true;
     }
     catch (const std::exception& e)
@@ -2887,11 +3003,23 @@ bool APIController::handleSetRecordingSettings(int clientFd, const std::string&
             m_uiManager->triggerRecordingFilenameTemplateChange(json["filenameTemplate"].get<std::string>());
         if (json.contains("includeAudio"))
             m_uiManager->triggerRecordingIncludeAudioChange(json["includeAudio"].get<bool>());
+        if (json.contains("segmentRecording") || json.contains("maxDurationUs") || json.contains("maxFileSize"))
+        {
+            m_uiManager->triggerRecordingSegmentChange(
+                json.value("segmentRecording", m_uiManager->getRecordingSegmentRecording()),
+                json.value("maxDurationUs", m_uiManager->getRecordingMaxDurationUs()),
+                json.value("maxFileSize", m_uiManager->getRecordingMaxFileSize()));
+        }
         if (json.contains("applyShader") && json["applyShader"].is_boolean())
         {
             m_uiManager->setRecordingApplyShader(json["applyShader"].get<bool>());
             m_uiManager->saveConfig();
         }
+        if (json.contains("shareStreamEncoder") && json["shareStreamEncoder"].is_boolean())
+        {
+            m_uiManager->setRecordingShareStreamEncoder(json["shareStreamEncoder"].get<bool>());
+            m_uiManager->saveConfig();
+        }
 
         sendJSONResponse(clientFd, 200, "{\"success\": true}");
         return true;
@@ -2938,6 +3066,75 @@ bool APIController::handleSetRecordingControl(int clientFd, const std::string& b
     }
 }
 
+// {"action": "start" | "stop" | "save", "seconds": N}. "seconds" only
+// applies to "save" (0 / absent = whole buffer). The saved file shows up
+// in /api/v1/recordings once it has been written.
+bool APIController::handleSetReplayControl(int clientFd, const std::string& body)
+{
+    if (!m_uiManager)
+    {
+        sendErrorResponse(clientFd, 500, "UIManager not available");
+        return true;
+    }
+
+    try
+    {
+        nlohmann::json json = nlohmann::json::parse(body);
+
+        if (!json.contains("action"))
+        {
+            sendErrorResponse(clientFd, 400, "Missing 'action' field");
+            return true;
+        }
+
+        std::string action = json["action"].get<std::string>();
+        if (action == "start" || action == "stop")
+        {
+            m_uiManager->triggerReplayBufferStartStop(action == "start");
+        }
+        else if (action == "save")
+        {
+            if (!m_uiManager->getReplayBufferActive())
+            {
+                sendErrorResponse(clientFd, 409, "Replay buffer is not running");
+                return true;
+            }
+            std::string outputPath;
+            if (!m_uiManager->triggerReplaySave(json.value("seconds", 0u), &outputPath))
+            {
+                sendErrorResponse(clientFd, 409, m_uiManager->getReplayBufferActive()
+                                                     ? "A replay is still being written"
+                                                     : "Replay buffer is not running");
+                return true;
+            }
+
+            std::ostringstream response;
+            response << "{\"success\": true, \"action\": \"save\", "
+                     << "\"replayBufferActive\": true, "
+                     << "\"path\": " << jsonString(outputPath) << ", "
+                     << "\"filename\": " << jsonString(fs::path(outputPath).filename().string()) << "}";
+            sendJSONResponse(clientFd, 200, response.str());
+            return true;
+        }
+        else
+        {
+            sendErrorResponse(clientFd, 400, "Unknown action: " + action);
+            return true;
+        }
+
+        std::ostringstream response;
+        response << "{\"success\": true, \"action\": " << jsonString(action) << ", "
+                 << "\"replayBufferActive\": " << (m_uiManager->getReplayBufferActive() ? "true" : "false") << "}";
+        sendJSONResponse(clientFd, 200, response.str());
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        sendErrorResponse(clientFd, 400, "Invalid JSON: " + std::string(e.what()));
+        return true;
+    }
+}
+
 bool APIController::handleDeleteRecording(int clientFd, const std::string& recordingId)
 {
     if (!m_application)
@@ -3059,14 +3256,6 @@ bool APIController::handleGETRecordingFile(int clientFd, const std::string& reco
         // UINT64_MAX indicates no range header
         bool isRangeRequest = (range.first != UINT64_MAX && range.second != UINT64_MAX);
 
-        // Open file
-        std::ifstream file(filepath, std::ios::binary);
-        if (!file.is_open())
-        {
-            sendErrorResponse(clientFd, 500, "Failed to open recording file");
-            return true;
-        }
-
         uint64_t startByte = 0;
         uint64_t endByte = fileSize - 1;
         uint64_t contentLength = fileSize;
@@ -3078,9 +3267,6 @@ bool APIController::handleGETRecordingFile(int clientFd, const std::string& reco
             contentLength = endByte - startByte + 1;
         }
 
-        // Seek to start position
-        file.seekg(startByte, std::ios::beg);
-
         // Prepare response headers
         std::ostringstream response;
         if (isRangeRequest)
@@ -3105,38 +3291,17 @@ bool APIController::handleGETRecordingFile(int clientFd, const std::string& reco
         std::string headerStr = response.str();
         if (!sendAll(clientFd, headerStr.c_str(), headerStr.length()))
         {
-            file.close();
             return true;
         }
 
-        // Stream file content in chunks (64KB at a time). sendAll() handles
-        // partial/EAGAIN sends — without it, a full socket buffer (immediate
-        // on a large file like a multi-hundred-MB recording) silently dropped
-        // the unsent tail of each chunk, corrupting/truncating the download
-        // and stalling browser playback after a couple of seconds (#79).
-        const size_t chunkSize = 64 * 1024; // 64KB chunks
-        std::vector<char> buffer(chunkSize);
-        uint64_t remaining = contentLength;
-
-        while (remaining > 0 && file.good())
+        // Body goes through HTTPServer::sendFile — sendfile(2) on plain
+        // sockets, mmap windows under TLS — so a multi-GB recording never
+        // passes through a userspace buffer here. It loops until the whole
+        // range is out (the partial-send truncation of #79 can't recur).
+        if (!m_httpServer || !m_httpServer->sendFile(clientFd, filepath, startByte, contentLength))
         {
-            size_t toRead = (remaining > chunkSize) ? chunkSize : static_cast<size_t>(remaining);
-            file.read(buffer.data(), toRead);
-            size_t bytesRead = file.gcount();
-
-            if (bytesRead == 0)
-                break;
-
-            if (!sendAll(clientFd, buffer.data(), bytesRead))
-            {
-                file.close();
-                return true;
-            }
-
-            remaining -= bytesRead;
+            LOG_WARN("Recording download interrupted: " + filepath);
         }
-
-        file.close();
         return true;
     }
     catch (const std::exception& e)
@@ -3156,28 +3321,25 @@ bool APIController::handleGETRecordingThumbnail(int clientFd, const std::string&
 
     try
     {
-        auto recordings = m_application->listRecordings();
-        auto it = std::find_if(recordings.begin(), recordings.end(),
-                              [&recordingId](const RecordingMetadata& m) { return m.id == recordingId; });
-        
-        if (it == recordings.end())
+        RecordingMetadata recording;
+        if (!m_application->getRecording(recordingId, recording))
         {
             sendErrorResponse(clientFd, 404, "Recording not found");
             return true;
         }
 
         // Check if thumbnail exists
-        if (it->thumbnailPath.empty() || !fs::exists(it->thumbnailPath))
+        if (recording.thumbnailPath.empty() || !fs::exists(recording.thumbnailPath))
         {
             sendErrorResponse(clientFd, 404, "Thumbnail not found");
             return true;
         }
 
         // Get file size
-        uint64_t fileSize = fs::file_size(it->thumbnailPath);
+        uint64_t fileSize = fs::file_size(recording.thumbnailPath);
 
         // Open file
-        std::ifstream file(it->thumbnailPath, std::ios::binary);
+        std::ifstream file(recording.thumbnailPath, std::ios::binary);
         if (!file.is_open())
         {
             sendErrorResponse(clientFd, 500, "Failed to open thumbnail file");
@@ -153,7 +153,7 @@ private:
     bool handleGETStreamingSettings(int clientFd);
     bool handleGETRecordingSettings(int clientFd);
     bool handleGETRecordingStatus(int clientFd);
-    bool handleGETRecordings(int clientFd);
+    bool handleGETRecordings(int clientFd, const std::string& request);
     bool handleGETRecording(int clientFd, const std::string& recordingId);
     bool handleGETV4L2Devices(int clientFd);
     bool handleGETV4L2Controls(int clientFd);
@@ -179,6 +179,8 @@ private:
     bool handleGETPresets(int clientFd);
     bool handleGETPreset(int clientFd, const std::string& presetName);
     bool handleGETSourceOverscan(int clientFd);
+    // GET /api/v1/source/jitter — remote-source playout buffer metrics.
+    bool handleGETSourceJitter(int clientFd);
     /**
      * GET /api/v1/preferences — exposes the host application's current
      * UI language so the portal can default to it on first load.
@@ -222,6 +224,7 @@ private:
     bool handleSetStreamingControl(int clientFd, const std::string &body);
     bool handleSetRecordingSettings(int clientFd, const std::string &body);
     bool handleSetRecordingControl(int clientFd, const std::string &body);
+    bool handleSetReplayControl(int clientFd, const std::string &body);
     bool handleDeleteRecording(int clientFd, const std::string &recordingId);
     bool handlePUTRecording(int clientFd, const std::string &recordingId, const std::string &body);
     bool handleGETRecordingFile(int clientFd, const std::string &recordingId, const std::string &request);
@@ -0,0 +1,882 @@
+#include "HLSSegmenter.h"
+#include "../utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace
+{
+    constexpr int64_t kPartTargetUs = 500000;  // LL-HLS part target (0.5 s)
+    constexpr double kSegmentTargetSec = 2.0;  // = one GOP of the stream encoder
+    // EXT-X-TARGETDURATION must not change for the life of the playlist, so
+    // it is fixed at init with room for a late keyframe; a segment that
+    // would still outgrow it is cut without one (see publishPart()).
+    constexpr long kTargetHeadroomSec = 2;
+    constexpr size_t kWindowSegments = 6;      // complete segments kept / listed
+    constexpr size_t kPartSegments = 3;        // trailing segments listed with parts
+    constexpr int64_t kMaxGapUs = 1000000;     // input gap that restarts the timeline
+    constexpr int64_t kViewerTimeoutMs = 15000;
+    constexpr int64_t kStaleMs = 3000;         // no part for this long = not live
+    constexpr int64_t kStartupWaitMs = 6000;   // encoder may be waking up from idle
+    constexpr size_t kAvioBufferSize = 32 * 1024;
+    constexpr uint32_t kSampleIsNonSync = 0x00010000;
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    uint32_t readU32(const std::string &buf, size_t off)
+    {
+        const unsigned char *p = reinterpret_cast<const unsigned char *>(buf.data()) + off;
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+
+    uint64_t readU64(const std::string &buf, size_t off)
+    {
+        return (uint64_t(readU32(buf, off)) << 32) | readU32(buf, off + 4);
+    }
+
+    // Calls fn(type, payloadOffset, payloadSize) for every box in
+    // buf[begin, end). false when a box header doesn't fit.
+    template <typename Fn>
+    bool forEachBox(const std::string &buf, size_t begin, size_t end, Fn fn)
+    {
+        size_t pos = begin;
+        while (pos + 8 <= end)
+        {
+            uint64_t size = readU32(buf, pos);
+            size_t header = 8;
+            if (size == 1)
+            {
+                if (pos + 16 > end)
+                {
+                    return false;
+                }
+                size = readU64(buf, pos + 8);
+                header = 16;
+            }
+            else if (size == 0)
+            {
+                size = end - pos;
+            }
+            if (size < header || size > end - pos)
+            {
+                return false;
+            }
+            fn(buf.substr(pos + 4, 4), pos + header, static_cast<size_t>(size) - header);
+            pos += static_cast<size_t>(size);
+        }
+        return pos == end;
+    }
+
+    // True when a moov carries samples in its sample tables, i.e. movenc
+    // wrote a regular moov for the first fragment instead of an empty_moov
+    // init. Media in such a moov is not referenced by any moof, so it is
+    // not a usable CMAF init segment.
+    bool moovHasSamples(const std::string &buf, size_t begin, size_t end)
+    {
+        bool samples = false;
+        forEachBox(buf, begin, end, [&](const std::string &type, size_t off, size_t len)
+        {
+            if (type == "moov" || type == "trak" || type == "mdia" || type == "minf" || type == "stbl")
+            {
+                samples = samples || moovHasSamples(buf, off, off + len);
+            }
+            else if (type == "stsz" && len >= 12)
+            {
+                samples = samples || readU32(buf, off + 8) > 0; // sample_count
+            }
+            else if (type == "stts" && len >= 8)
+            {
+                samples = samples || readU32(buf, off + 4) > 0; // entry_count
+            }
+        });
+        return samples;
+    }
+
+    // "_HLS_msn=12&_HLS_part=3" -> value of key, if present and numeric.
+    bool queryInt(const std::string &query, const std::string &key, int64_t &value)
+    {
+        size_t pos = 0;
+        while (pos < query.size())
+        {
+            size_t amp = query.find('&', pos);
+            if (amp == std::string::npos)
+            {
+                amp = query.size();
+            }
+            const std::string pair = query.substr(pos, amp - pos);
+            if (pair.size() > key.size() && pair.compare(0, key.size(), key) == 0 && pair[key.size()] == '=')
+            {
+                const char *begin = pair.c_str() + key.size() + 1;
+                char *end = nullptr;
+                long long v = std::strtoll(begin, &end, 10);
+                if (end != begin && *end == '\0' && v >= 0)
+                {
+                    value = v;
+                    return true;
+                }
+                return false;
+            }
+            pos = amp + 1;
+        }
+        return false;
+    }
+}
+
+HLSSegmenter::~HLSSegmenter()
+{
+    cleanup();
+}
+
+bool HLSSegmenter::initialize(const MediaEncoder::VideoConfig &videoConfig,
+                              const MediaEncoder::AudioConfig &audioConfig,
+                              void *videoCodecContext, void *audioCodecContext,
+                              std::function<void()> requestKeyframe)
+{
+    cleanup();
+
+    // HLS fMP4 players decode H.264/HEVC + AAC; VP8/VP9/MP3 in fMP4 would
+    // produce a playlist nothing can play.
+    const bool videoOk = videoConfig.codec == "h264" || videoConfig.codec == "h265";
+    if (!videoOk || audioConfig.codec != "aac" || !videoCodecContext || !audioCodecContext)
+    {
+        LOG_WARN("HLS: output disabled — needs H.264/H.265 + AAC (stream uses " +
+                 videoConfig.codec + " + " + audioConfig.codec + ")");
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_muxMutex);
+    m_videoConfig = videoConfig;
+    m_audioConfig = audioConfig;
+    m_videoCodecContext = videoCodecContext;
+    m_audioCodecContext = audioCodecContext;
+    m_requestKeyframe = std::move(requestKeyframe);
+
+    {
+        std::lock_guard<std::mutex> storeLock(m_storeMutex);
+        std::ostringstream tag;
+        tag << std::hex << std::chrono::duration_cast<std::chrono::seconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+        m_tag = tag.str();
+        m_segments.clear();
+        m_init.reset();
+        m_initId = 0;
+        m_nextMsn = 0;
+        m_lastPublishMs = 0;
+        m_partTarget = kPartTargetUs / 1000000.0;
+        m_segmentTarget = kSegmentTargetSec;
+        m_targetDuration = static_cast<long>(std::ceil(kSegmentTargetSec)) + kTargetHeadroomSec;
+    }
+
+    if (!startMuxer())
+    {
+        return false;
+    }
+    m_active = true;
+    LOG_INFO("HLS: LL-HLS output ready at /hls/index.m3u8 (part target " +
+             std::to_string(kPartTargetUs / 1000) + " ms)");
+    return true;
+}
+
+void HLSSegmenter::cleanup()
+{
+    m_active = false;
+    {
+        std::lock_guard<std::mutex> lock(m_muxMutex);
+        if (m_muxer)
+        {
+            m_muxer->release();
+            m_muxer.reset();
+        }
+        m_pending.clear();
+        m_initBytes.clear();
+        m_moof.clear();
+        m_videoCodecContext = nullptr;
+        m_audioCodecContext = nullptr;
+        m_requestKeyframe = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_storeMutex);
+        m_segments.clear();
+        m_init.reset();
+    }
+    // Wake blocked playlist/part requests so they return 404 now.
+    m_storeCv.notify_all();
+}
+
+bool HLSSegmenter::startMuxer()
+{
+    // The header is written from inside initialize(), through the
+    // callback, so the parse state has to be clean before it.
+    m_pending.clear();
+    m_initBytes.clear();
+    m_moof.clear();
+    m_haveInit = false;
+    m_waitingKeyframe = true;
+    m_lastVideoUs = -1;
+    m_videoTrackId = 0;
+    m_videoTimescale = 0;
+    m_trexDuration = 0;
+    m_trexFlags = 0;
+
+    // frag_keyframe closes a part on every keyframe; frag_duration caps the
+    // rest. movenc cuts only once the limit is reached, so leave one frame
+    // of headroom to keep parts within the advertised PART-TARGET.
+    const int64_t frameUs = m_videoConfig.fps > 0 ? 1000000 / m_videoConfig.fps : 0;
+    const int64_t fragUs = std::max<int64_t>(kPartTargetUs - frameUs, kPartTargetUs / 2);
+
+    m_muxer.reset(new MediaMuxer());
+    m_muxer->setFragmented(true);
+    m_muxer->setFormatOption("frag_duration", std::to_string(fragUs));
+    m_muxer->setFormatOption("flush_packets", "1");
+    auto writeCallback = [this](const uint8_t *data, size_t size) -> int
+    {
+        return this->onMuxerWrite(data, size);
+    };
+    if (!m_muxer->initialize(m_videoConfig, m_audioConfig,
+                             m_videoCodecContext, m_audioCodecContext,
+                             "", writeCallback, kAvioBufferSize, "mp4"))
+    {
+        LOG_ERROR("HLS: failed to initialize fMP4 muxer");
+        m_muxer.reset();
+        return false;
+    }
+    drainBoxes();
+
+    if (m_requestKeyframe)
+    {
+        m_requestKeyframe();
+    }
+    return true;
+}
+
+void HLSSegmenter::restartTimeline()
+{
+    if (m_muxer)
+    {
+        m_muxer->release();
+        m_muxer.reset();
+    }
+    {
+        // Players resync from the new init; nobody was fed across the gap.
+        std::lock_guard<std::mutex> lock(m_storeMutex);
+        m_segments.clear();
+        m_init.reset();
+    }
+    m_storeCv.notify_all();
+    startMuxer();
+}
+
+void HLSSegmenter::push(const std::vector<MediaEncoder::EncodedPacket> &packets)
+{
+    if (!m_active || packets.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_muxMutex);
+    if (!m_muxer)
+    {
+        return;
+    }
+
+    for (const auto &packet : packets)
+    {
+        if (packet.isVideo)
+        {
+            // The /stream encoder idles while nobody watches; when it comes
+            // back the timestamps jump and the fMP4 timeline would carry a
+            // hole several seconds long. Start over instead.
+            if (m_lastVideoUs >= 0 && packet.captureTimestampUs - m_lastVideoUs > kMaxGapUs)
+            {
+                LOG_INFO("HLS: input gap of " +
+                         std::to_string((packet.captureTimestampUs - m_lastVideoUs) / 1000) +
+                         " ms, restarting timeline");
+                restartTimeline();
+                if (!m_muxer)
+                {
+                    return;
+                }
+            }
+            m_lastVideoUs = packet.captureTimestampUs;
+            if (m_waitingKeyframe)
+            {
+                if (!packet.isKeyframe)
+                {
+                    continue;
+                }
+                m_waitingKeyframe = false;
+            }
+        }
+        else if (m_waitingKeyframe)
+        {
+            continue;
+        }
+        m_muxer->muxPacket(packet);
+    }
+    drainBoxes();
+}
+
+int HLSSegmenter::onMuxerWrite(const uint8_t *data, size_t size)
+{
+    // Chamado de dentro de muxPacket(), com m_muxMutex já travado.
+    m_pending.append(reinterpret_cast<const char *>(data), size);
+    return static_cast<int>(size);
+}
+
+void HLSSegmenter::drainBoxes()
+{
+    size_t pos = 0;
+    while (m_pending.size() - pos >= 8)
+    {
+        uint64_t size = readU32(m_pending, pos);
+        size_t header = 8;
+        if (size == 1)
+        {
+            if (m_pending.size() - pos < 16)
+            {
+                break;
+            }
+            size = readU64(m_pending, pos + 8);
+            header = 16;
+        }
+        if (size < header)
+        {
+            // size 0 ("to end of file") or garbage — movenc never writes
+            // either on a fragmented stream, so the byte stream is lost.
+            LOG_WARN("HLS: malformed box in muxer output, restarting timeline");
+            restartTimeline();
+            return;
+        }
+        if (m_pending.size() - pos < size)
+        {
+            break;
+        }
+        onBox(m_pending.substr(pos + 4, 4), m_pending.substr(pos, static_cast<size_t>(size)));
+        pos += static_cast<size_t>(size);
+    }
+    m_pending.erase(0, pos);
+}
+
+void HLSSegmenter::onBox(const std::string &type, std::string box)
+{
+    if (type == "moof")
+    {
+        if (m_haveInit)
+        {
+            m_moof = std::move(box);
+        }
+        return;
+    }
+    if (type == "mdat")
+    {
+        if (m_moof.empty())
+        {
+            return;
+        }
+        double duration = 0.0;
+        bool independent = false;
+        if (!parseFragment(m_moof, duration, independent))
+        {
+            LOG_WARN("HLS: could not parse fragment, dropping part");
+            m_moof.clear();
+            return;
+        }
+        std::string part;
+        part.reserve(m_moof.size() + box.size());
+        part.append(m_moof).append(box);
+        m_moof.clear();
+        publishPart(std::make_shared<const std::string>(std::move(part)), duration, independent);
+        return;
+    }
+    if (m_haveInit)
+    {
+        return; // mfra and friends from a trailer
+    }
+
+    m_initBytes.append(box);
+    if (type == "moov")
+    {
+        if (moovHasSamples(box, 0, box.size()))
+        {
+            // Not an empty_moov init: its media would never reach a part,
+            // and players would choke on it. Publish nothing.
+            LOG_ERROR("HLS: muxer wrote a moov with samples instead of a CMAF init segment — rejecting it");
+            m_initBytes.clear();
+            return;
+        }
+        if (!parseInit(m_initBytes))
+        {
+            LOG_ERROR("HLS: init segment has no usable video track");
+        }
+        m_haveInit = true;
+        publishInit(std::make_shared<const std::string>(std::move(m_initBytes)));
+        m_initBytes.clear();
+    }
+}
+
+bool HLSSegmenter::parseInit(const std::string &init)
+{
+    m_videoTrackId = 0;
+    m_videoTimescale = 0;
+    m_trexDuration = 0;
+    m_trexFlags = 0;
+
+    struct Trex
+    {
+        uint32_t trackId;
+        uint32_t duration;
+        uint32_t flags;
+    };
+    std::vector<Trex> trexes;
+
+    forEachBox(init, 0, init.size(), [&](const std::string &type, size_t off, size_t len)
+    {
+        if (type != "moov")
+        {
+            return;
+        }
+        forEachBox(init, off, off + len, [&](const std::string &t2, size_t o2, size_t l2)
+        {
+            if (t2 == "trak")
+            {
+                uint32_t trackId = 0;
+                uint32_t timescale = 0;
+                bool video = false;
+                forEachBox(init, o2, o2 + l2, [&](const std::string &t3, size_t o3, size_t l3)
+                {
+                    if (t3 == "tkhd" && l3 >= 24)
+                    {
+                        const bool v1 = init[o3] == 1;
+                        trackId = readU32(init, o3 + (v1 ? 20 : 12));
+                    }
+                    else if (t3 == "mdia")
+                    {
+                        forEachBox(init, o3, o3 + l3, [&](const std::string &t4, size_t o4, size_t l4)
+                        {
+                            if (t4 == "mdhd" && l4 >= 24)
+                            {
+                                const bool v1 = init[o4] == 1;
+                                timescale = readU32(init, o4 + (v1 ? 20 : 12));
+                            }
+                            else if (t4 == "hdlr" && l4 >= 12)
+                            {
+                                video = init.compare(o4 + 8, 4, "vide") == 0;
+                            }
+                        });
+                    }
+                });
+                if (video && m_videoTrackId == 0)
+                {
+                    m_videoTrackId = trackId;
+                    m_videoTimescale = timescale;
+                }
+            }
+            else if (t2 == "mvex")
+            {
+                forEachBox(init, o2, o2 + l2, [&](const std::string &t3, size_t o3, size_t l3)
+                {
+                    if (t3 == "trex" && l3 >= 24)
+                    {
+                        trexes.push_back({readU32(init, o3 + 4), readU32(init, o3 + 12), readU32(init, o3 + 20)});
+                    }
+                });
+            }
+        });
+    });
+
+    for (const auto &trex : trexes)
+    {
+        if (trex.trackId == m_videoTrackId)
+        {
+            m_trexDuration = trex.duration;
+            m_trexFlags = trex.flags;
+        }
+    }
+    return m_videoTrackId != 0 && m_videoTimescale != 0;
+}
+
+bool HLSSegmenter::parseFragment(const std::string &moof, double &duration, bool &independent) const
+{
+    if (m_videoTrackId == 0 || m_videoTimescale == 0)
+    {
+        return false;
+    }
+
+    uint64_t total = 0;
+    bool sawVideo = false;
+    independent = false;
+
+    forEachBox(moof, 0, moof.size(), [&](const std::string &type, size_t off, size_t len)
+    {
+        if (type != "moof")
+        {
+            return;
+        }
+        forEachBox(moof, off, off + len, [&](const std::string &t2, size_t o2, size_t l2)
+        {
+            if (t2 != "traf")
+            {
+                return;
+            }
+            uint32_t trackId = 0;
+            uint32_t defaultDuration = m_trexDuration;
+            uint32_t defaultFlags = m_trexFlags;
+            forEachBox(moof, o2, o2 + l2, [&](const std::string &t3, size_t o3, size_t l3)
+            {
+                const size_t end = o3 + l3;
+                if (t3 == "tfhd" && l3 >= 8)
+                {
+                    const uint32_t flags = readU32(moof, o3) & 0xFFFFFF;
+                    trackId = readU32(moof, o3 + 4);
+                    size_t p = o3 + 8;
+                    if (flags & 0x01) p += 8; // base-data-offset
+                    if (flags & 0x02) p += 4; // sample-description-index
+                    if ((flags & 0x08) && p + 4 <= end)
+                    {
+                        defaultDuration = readU32(moof, p);
+                        p += 4;
+                    }
+                    if (flags & 0x10) p += 4; // default-sample-size
+                    if ((flags & 0x20) && p + 4 <= end)
+                    {
+                        defaultFlags = readU32(moof, p);
+                    }
+                }
+                else if (t3 == "trun" && l3 >= 8 && trackId == m_videoTrackId)
+                {
+                    const uint32_t flags = readU32(moof, o3) & 0xFFFFFF;
+                    const uint32_t count = readU32(moof, o3 + 4);
+                    size_t p = o3 + 8;
+                    if (flags & 0x01) p += 4; // data-offset
+                    bool hasFirstFlags = false;
+                    uint32_t firstFlags = 0;
+                    if ((flags & 0x04) && p + 4 <= end)
+                    {
+                        hasFirstFlags = true;
+                        firstFlags = readU32(moof, p);
+                        p += 4;
+                    }
+                    const bool hasDuration = flags & 0x100;
+                    const bool hasSize = flags & 0x200;
+                    const bool hasFlags = flags & 0x400;
+                    const size_t stride = 4 * ((hasDuration ? 1 : 0) + (hasSize ? 1 : 0) + (hasFlags ? 1 : 0) +
+                                               ((flags & 0x800) ? 1 : 0));
+                    for (uint32_t i = 0; i < count && p + stride <= end; i++)
+                    {
+                        total += hasDuration ? readU32(moof, p) : defaultDuration;
+                        if (!sawVideo)
+                        {
+                            uint32_t sampleFlags = defaultFlags;
+                            if (hasFirstFlags)
+                            {
+                                sampleFlags = firstFlags;
+                            }
+                            else if (hasFlags)
+                            {
+                                sampleFlags = readU32(moof, p + (hasDuration ? 4 : 0) + (hasSize ? 4 : 0));
+                            }
+                            independent = (sampleFlags & kSampleIsNonSync) == 0;
+                            sawVideo = true;
+                        }
+                        p += stride;
+                    }
+                }
+            });
+        });
+    });
+
+    duration = static_cast<double>(total) / m_videoTimescale;
+    return sawVideo;
+}
+
+void HLSSegmenter::publishInit(std::shared_ptr<const std::string> init)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_storeMutex);
+        m_init = std::move(init);
+        m_initId++;
+    }
+    m_storeCv.notify_all();
+}
+
+void HLSSegmenter::publishPart(std::shared_ptr<const std::string> data, double duration, bool independent)
+{
+    bool forcedCut = false;
+    {
+        std::lock_guard<std::mutex> lock(m_storeMutex);
+
+        Segment *open = (!m_segments.empty() && !m_segments.back().complete) ? &m_segments.back() : nullptr;
+        if (open && independent && open->duration >= m_segmentTarget)
+        {
+            open->complete = true;
+            open = nullptr;
+        }
+        else if (open && !open->parts.empty() && open->duration + duration > m_targetDuration)
+        {
+            // The keyframe is late (encoder stall, GOP longer than asked):
+            // close the segment here rather than let its EXTINF exceed the
+            // target duration. The next segment starts mid-GOP; players
+            // joining there wait for the keyframe requested below.
+            open->complete = true;
+            open = nullptr;
+            forcedCut = true;
+        }
+        if (!open)
+        {
+            if (!independent && !forcedCut)
+            {
+                return; // a segment has to start on a keyframe
+            }
+            Segment segment;
+            segment.msn = m_nextMsn++;
+            m_segments.push_back(std::move(segment));
+            open = &m_segments.back();
+        }
+
+        Part part;
+        part.data = std::move(data);
+        part.duration = duration;
+        part.independent = independent;
+        open->parts.push_back(std::move(part));
+        open->duration += duration;
+        m_lastPublishMs = nowMs();
+
+        size_t complete = m_segments.size() - (m_segments.back().complete ? 0 : 1);
+        while (complete > kWindowSegments)
+        {
+            m_segments.pop_front();
+            complete--;
+        }
+    }
+    m_storeCv.notify_all();
+    if (forcedCut && m_requestKeyframe)
+    {
+        m_requestKeyframe();
+    }
+}
+
+std::string HLSSegmenter::partName(uint64_t msn, size_t part) const
+{
+    return m_tag + "-" + std::to_string(msn) + "." + std::to_string(part) + ".m4s";
+}
+
+std::string HLSSegmenter::segmentName(uint64_t msn) const
+{
+    return m_tag + "-" + std::to_string(msn) + ".m4s";
+}
+
+std::string HLSSegmenter::initName() const
+{
+    return m_tag + "-init" + std::to_string(m_initId) + ".mp4";
+}
+
+std::string HLSSegmenter::playlistLocked() const
+{
+    std::ostringstream m3u;
+    m3u.setf(std::ios::fixed);
+    m3u.precision(3);
+    m3u << "#EXTM3U\n"
+        << "#EXT-X-VERSION:6\n"
+        << "#EXT-X-TARGETDURATION:" << m_targetDuration << "\n"
+        << "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=" << (3 * m_partTarget) << "\n"
+        << "#EXT-X-PART-INF:PART-TARGET=" << m_partTarget << "\n"
+        << "#EXT-X-MEDIA-SEQUENCE:" << m_segments.front().msn << "\n"
+        << "#EXT-X-MAP:URI=\"" << initName() << "\"\n";
+
+    const size_t partsFrom = m_segments.size() > kPartSegments ? m_segments.size() - kPartSegments : 0;
+    for (size_t i = 0; i < m_segments.size(); i++)
+    {
+        const Segment &segment = m_segments[i];
+        if (i >= partsFrom)
+        {
+            for (size_t p = 0; p < segment.parts.size(); p++)
+            {
+                m3u << "#EXT-X-PART:DURATION=" << segment.parts[p].duration
+                    << ",URI=\"" << partName(segment.msn, p) << "\""
+                    << (segment.parts[p].independent ? ",INDEPENDENT=YES" : "") << "\n";
+            }
+        }
+        if (segment.complete)
+        {
+            m3u << "#EXTINF:" << segment.duration << ",\n"
+                << segmentName(segment.msn) << "\n";
+        }
+    }
+
+    // The next part either continues the open segment or starts a new one;
+    // hint the former — a wrong guess just ends in a 404 the player skips.
+    const Segment &last = m_segments.back();
+    const std::string hint = last.complete ? partName(m_nextMsn, 0) : partName(last.msn, last.parts.size());
+    m3u << "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"" << hint << "\"\n";
+    return m3u.str();
+}
+
+const HLSSegmenter::Segment *HLSSegmenter::findSegmentLocked(uint64_t msn) const
+{
+    if (m_segments.empty() || msn < m_segments.front().msn || msn > m_segments.back().msn)
+    {
+        return nullptr;
+    }
+    return &m_segments[static_cast<size_t>(msn - m_segments.front().msn)];
+}
+
+bool HLSSegmenter::playlistReadyLocked(uint64_t msn, int64_t part) const
+{
+    if (m_nextMsn > msn + 1)
+    {
+        return true; // a later segment has started, so msn is done
+    }
+    const Segment *segment = findSegmentLocked(msn);
+    if (!segment)
+    {
+        return false;
+    }
+    if (segment->complete)
+    {
+        return true;
+    }
+    return part >= 0 && segment->parts.size() > static_cast<size_t>(part);
+}
+
+bool HLSSegmenter::isFreshLocked() const
+{
+    return !m_segments.empty() && m_init && nowMs() - m_lastPublishMs < kStaleMs;
+}
+
+bool HLSSegmenter::hasRecentRequests() const
+{
+    const int64_t last = m_lastRequestMs.load();
+    return last != 0 && nowMs() - last < kViewerTimeoutMs;
+}
+
+bool HLSSegmenter::serve(const std::string &name, const std::string &query, Response &out)
+{
+    // Any hit counts as a viewer — it is what wakes the /stream encode.
+    m_lastRequestMs = nowMs();
+    if (!m_active)
+    {
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(m_storeMutex);
+    const auto blockFor = std::chrono::milliseconds(
+        3000 * static_cast<int64_t>(m_targetDuration));
+
+    if (name == "index.m3u8")
+    {
+        // Segments left over from before the encoder went idle are not
+        // live; wait for the restarted timeline instead of serving them.
+        m_storeCv.wait_for(lock, std::chrono::milliseconds(kStartupWaitMs),
+                           [this] { return !m_active || isFreshLocked(); });
+        if (!m_active || !isFreshLocked())
+        {
+            return false;
+        }
+
+        // Blocking playlist reload: hold the request until the segment (or
+        // part) the player asked for exists. Requests far ahead of the
+        // live edge are answered right away.
+        int64_t msn = 0;
+        int64_t part = -1;
+        if (queryInt(query, "_HLS_msn", msn))
+        {
+            queryInt(query, "_HLS_part", part);
+            if (static_cast<uint64_t>(msn) <= m_nextMsn + 2)
+            {
+                m_storeCv.wait_for(lock, blockFor, [&]
+                                   { return !m_active || playlistReadyLocked(static_cast<uint64_t>(msn), part); });
+            }
+            if (!m_active || !isFreshLocked())
+            {
+                return false;
+            }
+        }
+
+        out.contentType = "application/vnd.apple.mpegurl";
+        out.body = playlistLocked();
+        out.cacheable = false;
+        return true;
+    }
+
+    const std::string prefix = m_tag + "-";
+    if (name.compare(0, prefix.size(), prefix) != 0)
+    {
+        return false; // another session's (or nobody's) resource
+    }
+    const std::string rest = name.substr(prefix.size());
+
+    if (rest.compare(0, 4, "init") == 0)
+    {
+        if (!m_init || name != initName())
+        {
+            return false;
+        }
+        out.contentType = "video/mp4";
+        out.body = *m_init;
+        out.cacheable = true;
+        return true;
+    }
+
+    // "<msn>.m4s" or "<msn>.<part>.m4s"
+    char *end = nullptr;
+    const uint64_t msn = std::strtoull(rest.c_str(), &end, 10);
+    if (end == rest.c_str())
+    {
+        return false;
+    }
+    const std::string tail = end;
+    if (tail == ".m4s")
+    {
+        const Segment *segment = findSegmentLocked(msn);
+        if (!segment || !segment->complete)
+        {
+            return false;
+        }
+        size_t total = 0;
+        for (const auto &part : segment->parts)
+        {
+            total += part.data->size();
+        }
+        out.body.reserve(total);
+        for (const auto &part : segment->parts)
+        {
+            out.body.append(*part.data);
+        }
+        out.contentType = "video/mp4";
+        out.cacheable = true;
+        return true;
+    }
+
+    if (tail.size() < 6 || tail[0] != '.' || tail.compare(tail.size() - 4, 4, ".m4s") != 0)
+    {
+        return false;
+    }
+    char *partEnd = nullptr;
+    const unsigned long long partIndex = std::strtoull(tail.c_str() + 1, &partEnd, 10);
+    if (partEnd == tail.c_str() + 1 || std::string(partEnd) != ".m4s")
+    {
+        return false;
+    }
+
+    // Preload hints ask for the part before it exists: hold the request
+    // until it is published, or until its segment closes without it.
+    m_storeCv.wait_for(lock, blockFor, [&]
+                       { return !m_active || playlistReadyLocked(msn, static_cast<int64_t>(partIndex)); });
+    const Segment *segment = findSegmentLocked(msn);
+    if (!m_active || !segment || partIndex >= segment->parts.size())
+    {
+        return false;
+    }
+    out.contentType = "video/mp4";
+    out.body = *segment->parts[static_cast<size_t>(partIndex)].data;
+    out.cacheable = true;
+    return true;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "../encoding/MediaEncoder.h"
+#include "../encoding/MediaMuxer.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * HLSSegmenter - LL-HLS output (CMAF fMP4 parts) built from the /stream encode
+ *
+ * Re-muxes the packets HTTPTSStreamer already encodes for /stream into a
+ * fragmented MP4 (one moof+mdat per keyframe and at most every part target)
+ * and keeps the last few segments in memory, so browsers and set-top players
+ * that only speak HLS can watch without a second encode. No disk I/O: the
+ * init segment, parts and segments are served straight from here.
+ *
+ * The byte stream coming out of the muxer is split into top-level boxes:
+ * ftyp+moov is the init segment, every moof+mdat pair becomes a part, and a
+ * segment is a run of parts that starts on an independent (keyframe) part and
+ * closes at the first keyframe after the segment target (or, if the keyframe
+ * is late, before it would outgrow the fixed EXT-X-TARGETDURATION). Part durations and
+ * the keyframe flag are read back from the moof (trun), not guessed from the
+ * packets, since the interleaver may hold packets across a cut.
+ *
+ * Threading: push() runs on the /stream encoding thread; the request side
+ * (playlist/init/part/segment) runs on the HTTP client threads and may block
+ * for a bounded time (LL-HLS blocking playlist reload and preload hints).
+ */
+class HLSSegmenter
+{
+public:
+    struct Response
+    {
+        std::string contentType;
+        std::string body;
+        bool cacheable = false; // parts/segments/init never change once served
+    };
+
+    HLSSegmenter() = default;
+    ~HLSSegmenter();
+
+    // Only H.264/H.265 + AAC are valid in HLS fMP4; returns false (and
+    // stays disabled) for anything else. requestKeyframe is called when
+    // the segmenter needs a fresh keyframe to (re)start the timeline.
+    bool initialize(const MediaEncoder::VideoConfig &videoConfig,
+                    const MediaEncoder::AudioConfig &audioConfig,
+                    void *videoCodecContext, void *audioCodecContext,
+                    std::function<void()> requestKeyframe);
+    void cleanup();
+    bool isActive() const { return m_active.load(); }
+
+    // Encoding thread: the packets just muxed into /stream.
+    void push(const std::vector<MediaEncoder::EncodedPacket> &packets);
+
+    // Resource name relative to /hls/ ("index.m3u8", "<tag>-3.m4s", ...)
+    // and the raw query string. false = 404.
+    bool serve(const std::string &name, const std::string &query, Response &out);
+
+    // True while an HLS player has polled recently; the /stream encode is
+    // gated on this like on a connected /stream client.
+    bool hasRecentRequests() const;
+
+private:
+    struct Part
+    {
+        std::shared_ptr<const std::string> data;
+        double duration = 0.0;
+        bool independent = false;
+    };
+
+    struct Segment
+    {
+        uint64_t msn = 0;
+        bool complete = false;
+        double duration = 0.0;
+        std::vector<Part> parts;
+    };
+
+    // Encoding thread (m_muxMutex held).
+    bool startMuxer();
+    void restartTimeline();
+    int onMuxerWrite(const uint8_t *data, size_t size);
+    void drainBoxes();
+    void onBox(const std::string &type, std::string box);
+    bool parseInit(const std::string &init);
+    bool parseFragment(const std::string &moof, double &duration, bool &independent) const;
+
+    // Store side (m_storeMutex held).
+    void publishInit(std::shared_ptr<const std::string> init);
+    void publishPart(std::shared_ptr<const std::string> data, double duration, bool independent);
+    std::string playlistLocked() const;
+    const Segment *findSegmentLocked(uint64_t msn) const;
+    bool playlistReadyLocked(uint64_t msn, int64_t part) const;
+    bool isFreshLocked() const;
+
+    std::string partName(uint64_t msn, size_t part) const;
+    std::string segmentName(uint64_t msn) const;
+    std::string initName() const;
+
+    std::atomic<bool> m_active{false};
+
+    // --- encoding side ---
+    std::mutex m_muxMutex;
+    MediaEncoder::VideoConfig m_videoConfig;
+    MediaEncoder::AudioConfig m_audioConfig;
+    void *m_videoCodecContext = nullptr;
+    void *m_audioCodecContext = nullptr;
+    std::function<void()> m_requestKeyframe;
+    std::unique_ptr<MediaMuxer> m_muxer;
+    std::string m_pending;  // muxer bytes not yet forming a whole box
+    std::string m_initBytes; // ftyp (+free) until the moov arrives
+    std::string m_moof;      // moof waiting for its mdat
+    bool m_haveInit = false;
+    bool m_waitingKeyframe = true;
+    int64_t m_lastVideoUs = -1;
+    // From the moov: video track and its timescale, plus trex defaults.
+    uint32_t m_videoTrackId = 0;
+    uint32_t m_videoTimescale = 0;
+    uint32_t m_trexDuration = 0;
+    uint32_t m_trexFlags = 0;
+
+    // --- store side ---
+    mutable std::mutex m_storeMutex;
+    std::condition_variable m_storeCv;
+    std::string m_tag; // per-session name prefix so caches never mix runs
+    std::deque<Segment> m_segments;
+    // A timeline restart (input gap) drops every segment and brings a new
+    // init, so there is only ever one; m_initId keeps its URI unique.
+    std::shared_ptr<const std::string> m_init;
+    uint32_t m_initId = 0;
+    uint64_t m_nextMsn = 0; // never reused within a session, even across restarts
+    int64_t m_lastPublishMs = 0;
+    long m_targetDuration = 4; // EXT-X-TARGETDURATION, fixed per session
+    double m_partTarget = 0.5;
+    double m_segmentTarget = 2.0;
+
+    std::atomic<int64_t> m_lastRequestMs{0};
+};
@@ -5,8 +5,14 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <cstring>
 #include <cerrno>
+#ifdef PLATFORM_LINUX
+#include <sys/sendfile.h>
+#include <poll.h>
+#endif
 #define SOCKET_ERROR_MSG() std::string(strerror(errno))
 #elif defined(_WIN32) || defined(WIN32)
 // IMPORTANTE: winsock2.h deve ser incluído ANTES de windows.h para evitar conflitos
@@ -53,6 +59,9 @@ inline std::string getSocketError()
 #include <iomanip>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <vector>
 
 #ifdef ENABLE_HTTPS
 #include <openssl/ssl.h>
@@ -448,7 +457,20 @@ ssize_t HTTPServer::sendData(int clientFd, const void *data, size_t size)
         auto it = m_sslClients.find(clientFd);
         if (it != m_sslClients.end())
         {
-            return SSL_write(it->second, data, static_cast<int>(size));
+            // Same contract as the plain path below: 0 means "socket full,
+            // retry later" (non-blocking fds in the stream client reactor),
+            // -1 means the connection is gone.
+            int written = SSL_write(it->second, data, static_cast<int>(size));
+            if (written <= 0)
+            {
+                int err = SSL_get_error(it->second, written);
+                if (err == SSL_ERROR_WANT_WRITE || err == SSL_ERROR_WANT_READ)
+                {
+                    return 0;
+                }
+                return -1;
+            }
+            return written;
         }
     }
 #endif
@@ -485,6 +507,146 @@ ssize_t HTTPServer::sendData(int clientFd, const void *data, size_t size)
 #endif
 }
 
+bool HTTPServer::sendBuffer(int clientFd, const char *data, size_t size)
+{
+    // sendData() não bloqueia (0 = buffer do socket cheio). ~30 s sem
+    // progresso derruba o envio em vez de prender a thread para sempre.
+    int idleSpins = 0;
+    while (size > 0)
+    {
+        ssize_t n = sendData(clientFd, data, size);
+        if (n < 0)
+        {
+            return false;
+        }
+        if (n == 0)
+        {
+            if (++idleSpins > 30000)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        idleSpins = 0;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool HTTPServer::sendFile(int clientFd, const std::string &filePath, uint64_t offset, uint64_t length)
+{
+    if (length == 0)
+    {
+        return true;
+    }
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+    int fileFd = open(filePath.c_str(), O_RDONLY);
+    if (fileFd < 0)
+    {
+        LOG_ERROR("HTTPServer::sendFile - Failed to open " + filePath + ": " + SOCKET_ERROR_MSG());
+        return false;
+    }
+
+    bool ok = true;
+#ifdef PLATFORM_LINUX
+    if (!isClientHTTPS(clientFd))
+    {
+        off_t pos = static_cast<off_t>(offset);
+        uint64_t remaining = length;
+        int idleWaits = 0;
+        while (remaining > 0)
+        {
+            const size_t chunk = static_cast<size_t>(std::min<uint64_t>(remaining, 1ULL << 30));
+            ssize_t n = ::sendfile(clientFd, fileFd, &pos, chunk);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    // Buffer do socket cheio: esperar ficar gravável (~30 s no máximo).
+                    pollfd pfd{clientFd, POLLOUT, 0};
+                    if (++idleWaits > 30 || ::poll(&pfd, 1, 1000) < 0)
+                    {
+                        ok = false;
+                        break;
+                    }
+                    continue;
+                }
+                ok = false; // cliente desconectou
+                break;
+            }
+            if (n == 0)
+            {
+                ok = false; // arquivo encolheu durante o envio
+                break;
+            }
+            idleWaits = 0;
+            remaining -= static_cast<uint64_t>(n);
+        }
+        close(fileFd);
+        return ok;
+    }
+#endif
+
+    // TLS precisa dos bytes em userspace para o SSL_write; mapear em
+    // janelas evita o read() + cópia e não reserva o arquivo inteiro
+    // (gravações passam de GB) no espaço de endereçamento.
+    const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t windowSize = 8ULL * 1024 * 1024;
+    const uint64_t end = offset + length;
+    uint64_t pos = offset;
+    while (ok && pos < end)
+    {
+        const uint64_t mapStart = pos - (pos % pageSize);
+        const uint64_t mapLen = std::min<uint64_t>(end - mapStart, windowSize);
+        void *map = mmap(nullptr, static_cast<size_t>(mapLen), PROT_READ, MAP_PRIVATE, fileFd,
+                         static_cast<off_t>(mapStart));
+        if (map == MAP_FAILED)
+        {
+            LOG_ERROR("HTTPServer::sendFile - mmap failed for " + filePath + ": " + SOCKET_ERROR_MSG());
+            ok = false;
+            break;
+        }
+        madvise(map, static_cast<size_t>(mapLen), MADV_SEQUENTIAL);
+        const uint64_t skip = pos - mapStart;
+        ok = sendBuffer(clientFd, static_cast<const char *>(map) + skip, static_cast<size_t>(mapLen - skip));
+        munmap(map, static_cast<size_t>(mapLen));
+        pos = mapStart + mapLen;
+    }
+    close(fileFd);
+    return ok;
+#else
+    // Windows: leitura em blocos (sem sendfile/mmap portáveis com Winsock + TLS).
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        LOG_ERROR("HTTPServer::sendFile - Failed to open " + filePath);
+        return false;
+    }
+    file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    std::vector<char> buffer(256 * 1024);
+    uint64_t remaining = length;
+    while (remaining > 0 && file.good())
+    {
+        const size_t toRead = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+        file.read(buffer.data(), toRead);
+        const size_t bytesRead = static_cast<size_t>(file.gcount());
+        if (bytesRead == 0 || !sendBuffer(clientFd, buffer.data(), bytesRead))
+        {
+            return false;
+        }
+        remaining -= bytesRead;
+    }
+    return remaining == 0;
+#endif
+}
+
 ssize_t HTTPServer::receiveData(int clientFd, void *buffer, size_t size)
 {
 #ifdef ENABLE_HTTPS
@@ -504,6 +666,45 @@ ssize_t HTTPServer::receiveData(int clientFd, void *buffer, size_t size)
 #endif
 }
 
+ssize_t HTTPServer::receiveAvailable(int clientFd, void *buffer, size_t size)
+{
+#ifdef ENABLE_HTTPS
+    if (m_useSSL)
+    {
+        auto it = m_sslClients.find(clientFd);
+        if (it != m_sslClients.end())
+        {
+            int received = SSL_read(it->second, buffer, static_cast<int>(size));
+            if (received <= 0)
+            {
+                int err = SSL_get_error(it->second, received);
+                if (err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE)
+                {
+                    return 0;
+                }
+                return -1;
+            }
+            return received;
+        }
+    }
+#endif
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+    ssize_t result = recv(clientFd, buffer, size, MSG_DONTWAIT);
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        return 0;
+    }
+    return result > 0 ? result : -1; // 0 = peer fechou
+#else
+    int result = recv(clientFd, (char *)buffer, (int)size, 0);
+    if (result == SOCKET_ERROR)
+    {
+        return WSAGetLastError() == WSAEWOULDBLOCK ? 0 : -1;
+    }
+    return result > 0 ? result : -1;
+#endif
+}
+
 void HTTPServer::closeClient(int clientFd)
 {
 #ifdef ENABLE_HTTPS
@@ -3,6 +3,7 @@
 #include <string>
 #include <map>
 #include <cstddef>
+#include <cstdint>
 #if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
 #include <sys/types.h>
 #endif
@@ -56,6 +57,21 @@ public:
      */
     ssize_t sendData(int clientFd, const void *data, size_t size);
 
+    /**
+     * Enviar um trecho de arquivo inteiro (bloqueia até terminar)
+     *
+     * Sockets em texto puro no Linux usam sendfile(2): os bytes vão do
+     * page cache direto para o socket, sem passar por buffer do processo.
+     * Clientes TLS (e macOS) mapeiam o arquivo com mmap em janelas e
+     * mandam via sendData(); no Windows cai para leitura em blocos.
+     * @param clientFd File descriptor do cliente
+     * @param filePath Caminho do arquivo
+     * @param offset Primeiro byte a enviar
+     * @param length Quantidade de bytes
+     * @return true se todos os bytes foram enviados
+     */
+    bool sendFile(int clientFd, const std::string &filePath, uint64_t offset, uint64_t length);
+
     /**
      * Receber dados do socket (com suporte SSL se habilitado)
      * @param clientFd File descriptor do cliente
@@ -65,6 +81,17 @@ public:
      */
     ssize_t receiveData(int clientFd, void *buffer, size_t size);
 
+    /**
+     * Receber sem bloquear (mesmo contrato de sendData)
+     *
+     * O socket precisa estar em modo não-bloqueante para clientes TLS.
+     * @param clientFd File descriptor do cliente
+     * @param buffer Buffer para receber dados
+     * @param size Tamanho do buffer
+     * @return Bytes recebidos, 0 se não há nada agora, -1 se a conexão fechou ou deu erro
+     */
+    ssize_t receiveAvailable(int clientFd, void *buffer, size_t size);
+
     /**
      * Fechar conexão do cliente
      * @param clientFd File descriptor do cliente
@@ -110,6 +137,9 @@ public:
     std::string getSSLKeyPath() const { return m_sslKeyPath; }
 
 private:
+    // Loop de sendData() até enviar tudo (EAGAIN = espera e tenta de novo).
+    bool sendBuffer(int clientFd, const char *data, size_t size);
+
 #ifdef ENABLE_HTTPS
     bool initializeSSL();
     void cleanupSSL();
@@ -30,15 +30,19 @@ extern "C"
 #include <libswresample/swresample.h>
 }
 
+// Upper bound on how long an idle encoder thread blocks in
+// MediaSynchronizer::waitForData(). New data and stop() wake it earlier.
+static constexpr int64_t ENCODER_IDLE_WAIT_US = 50000; // 50 ms
+
 // Enable aggressive TCP keep-alive on a client socket so a viewer that
 // vanishes WITHOUT a clean FIN (network drop, a remote client whose
 // TLS read errored and was reaped over the internet) is detected by
-// the kernel in ~25 s instead of the default ~2 h. The disconnect
-// monitor loop's blocking recv() then returns and the client is
+// the kernel in ~25 s instead of the default ~2 h. The socket then
+// errors out in the client reactor's epoll set and the client is
 // reaped, so the viewer count converges to reality.
 //
 // Without this, half-open connections from failed/repeated connects
-// pile up in m_clientSockets / m_rawClientSockets and inflate the
+// pile up in the /stream and /raw client reactors and inflate the
 // reported viewer count (the symptom: "counter already >6 even
 // without completing a connection"). #92.
 static void enableClientKeepalive(int fd)
@@ -89,6 +93,33 @@ __attribute__((unused)) static int writeCallbackNonConst(void *opaque, uint8_t *
 
 HTTPTSStreamer::HTTPTSStreamer()
 {
+    auto sendFn = [this](int fd, const void *data, size_t size)
+    { return m_httpServer.sendData(fd, data, size); };
+    auto closeFn = [this](int fd)
+    { m_httpServer.closeClient(fd); };
+    auto receiveFn = [this](int fd, void *buffer, size_t size)
+    { return m_httpServer.receiveAvailable(fd, buffer, size); };
+    m_streamClients.setTransport(sendFn, closeFn, receiveFn);
+    m_rawClients.setTransport(sendFn, closeFn);
+
+    // Accepted sockets wait in the /stream reactor until their request is
+    // in; see serverThread().
+    m_streamClients.setRequestHandler([this](int fd, std::string request)
+                                      { dispatchRequest(fd, std::move(request)); });
+
+    // /stream (mpegts.js) cannot survive a gap — a viewer that falls this
+    // far behind is disconnected and reconnects. A lagging /raw client is
+    // moved forward to a keyframe and keeps the connection (#93); its
+    // consumer is a live remote client, so it also gets the tighter age
+    // bound.
+    StreamClientReactor::Limits streamLimits;
+    streamLimits.policy = StreamClientReactor::OverflowPolicy::Disconnect;
+    m_streamClients.setLimits(streamLimits);
+
+    StreamClientReactor::Limits rawLimits;
+    rawLimits.maxLagUs = 3 * 1000000LL;
+    rawLimits.policy = StreamClientReactor::OverflowPolicy::SkipToKeyframe;
+    m_rawClients.setLimits(rawLimits);
 }
 
 HTTPTSStreamer::~HTTPTSStreamer()
@@ -166,7 +197,7 @@ void HTTPTSStreamer::setStreamPasswordHash(const std::string &sha256Hex)
     m_apiController.setStreamPasswordHash(sha256Hex);
 }
 
-bool HTTPTSStreamer::pushFrame(const uint8_t *data, uint32_t width, uint32_t height)
+bool HTTPTSStreamer::pushFrame(const uint8_t *data, uint32_t width, uint32_t height, VideoFrameFormat format)
 {
     if (!data || !m_active || width == 0 || height == 0)
     {
@@ -185,7 +216,7 @@ bool HTTPTSStreamer::pushFrame(const uint8_t *data, uint32_t width, uint32_t hei
     int64_t captureTimestampUs = getTimestampUs();
 
     // Adicionar frame ao MediaSynchronizer
-    return m_streamSynchronizer.addVideoFrame(data, width, height, captureTimestampUs);
+    return m_streamSynchronizer.addVideoFrame(data, width, height, captureTimestampUs, format);
 }
 
 bool HTTPTSStreamer::pushAudio(const int16_t *samples, size_t sampleCount)
@@ -227,7 +258,7 @@ bool HTTPTSStreamer::pushAudio(const int16_t *samples, size_t sampleCount)
     return ok;
 }
 
-bool HTTPTSStreamer::pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height)
+bool HTTPTSStreamer::pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height, VideoFrameFormat format)
 {
     if (!data || !m_active || width == 0 || height == 0)
     {
@@ -240,7 +271,7 @@ bool HTTPTSStreamer::pushRawFrame(const uint8_t *data, uint32_t width, uint32_t
         return false;
     }
     int64_t captureTimestampUs = getTimestampUs();
-    return m_rawStreamSynchronizer.addVideoFrame(data, width, height, captureTimestampUs);
+    return m_rawStreamSynchronizer.addVideoFrame(data, width, height, captureTimestampUs, format);
 }
 
 bool HTTPTSStreamer::start()
@@ -440,6 +471,9 @@ bool HTTPTSStreamer::start()
     m_active = true;
     m_stopRequest = false;
 
+    m_streamClients.start();
+    m_rawClients.start();
+
     m_serverThread = std::thread(&HTTPTSStreamer::serverThread, this);
     m_serverThread.detach();
     m_encodingThread = std::thread(&HTTPTSStreamer::encodingThread, this);
@@ -604,6 +638,10 @@ bool HTTPTSStreamer::startWebPortalServer()
     m_active = true;
     m_stopRequest = false;
 
+    // /stream viewers that connect before encoding starts are parked here.
+    m_streamClients.start();
+    m_rawClients.start();
+
     m_serverThread = std::thread(&HTTPTSStreamer::serverThread, this);
     m_serverThread.detach();
 
@@ -638,38 +676,29 @@ void HTTPTSStreamer::stop()
     m_active = false;
     m_stopRequest = true;
 
+    // Encoder threads block in waitForData() between frames; kick them so
+    // they see m_stopRequest now instead of at the idle timeout.
+    m_streamSynchronizer.wakeConsumers();
+    m_rawStreamSynchronizer.wakeConsumers();
+
+    // Hand shared-encode subscribers (a recording piggybacking on
+    // /stream) back to their own encoder right away — every frame
+    // between here and the end of the shutdown wait below would be lost
+    // to them otherwise.
+    m_streamPacketBus.detachSource();
+
     // Fechar servidor HTTP/HTTPS para acordar accept()
     // IMPORTANTE: Fechar servidor ANTES de setar flags para evitar race condition
     m_httpServer.closeServer();
 
-    // Fechar todos os sockets de clientes
-    {
-        std::lock_guard<std::mutex> lock(m_outputMutex);
-        for (int clientFd : m_clientSockets)
-        {
-            m_httpServer.closeClient(clientFd);
-        }
-        m_clientSockets.clear();
-        m_clientPending.clear();
-        m_clientCount = 0;
-    }
-
-    // Phase 2 of #47: same for /raw clients.
-    {
-        std::lock_guard<std::mutex> lock(m_rawOutputMutex);
-        for (int clientFd : m_rawClientSockets)
-        {
-            m_httpServer.closeClient(clientFd);
-        }
-        m_rawClientSockets.clear();
-        m_rawClientPending.clear();
-        m_rawClientCount = 0;
-    }
+    // Fechar todos os sockets de clientes (/stream e /raw). Joins the
+    // reactor threads, so no send is in flight once these return.
+    m_streamClients.stop();
+    m_rawClients.stop();
 
     // Aguardar um tempo para threads detached processarem m_stopRequest e
-    // terminarem. Os loops checam m_running/m_stopRequest a cada iteração,
-    // que para os encoder threads é <30ms e para os client handlers é a
-    // próxima recv (~10ms). 10s era exagero — congelava a UI quando o
+    // terminarem. Os loops checam m_running/m_stopRequest a cada iteração;
+    // os encoder threads acabaram de ser acordados acima. 10s era exagero — congelava a UI quando o
     // restart era disparado por um callback de setting na thread principal.
     // 1.5s dá margem confortável sem trancar a interface.
     std::this_thread::sleep_for(std::chrono::milliseconds(1500));
@@ -750,7 +779,7 @@ uint32_t HTTPTSStreamer::getClientCount() const
     // watching the host's broadcast" — surfacing only one of them
     // makes the count under-report whenever the audience splits
     // between the portal and remote-client viewers (#68).
-    return m_clientCount.load() + m_rawClientCount.load();
+    return m_streamClients.getClientCount() + m_rawClients.getClientCount();
 }
 
 void HTTPTSStreamer::cleanup()
@@ -758,101 +787,7 @@ void HTTPTSStreamer::cleanup()
     stop();
 }
 
-bool HTTPTSStreamer::readClientRequest(int clientFd, std::string &request)
-{
-// Configurar socket para baixa latência
-#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
-    int flag = 1;
-    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
-#elif defined(_WIN32)
-    // Windows: usar int (BOOL é apenas um typedef para int)
-    int flag = 1;
-    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, (const char *)&flag, sizeof(flag));
-#endif
-
-    // Read the HTTP request. We must loop until we see the header
-    // terminator (\r\n\r\n) because TCP doesn't guarantee that an
-    // entire request arrives in one segment — common when fronted
-    // by Cloudflare or any tunnel where slow-start fragments the
-    // request across multiple packets. The original code took the
-    // single-recv shortcut, which on localhost always returned the
-    // full request (loopback has huge MTU and one-shot delivery)
-    // but on external paths returned 1-N bytes and the rest of the
-    // request was abandoned, surfacing later as `Request preview: �`
-    // garbage and broken asset loads in the portal.
-    //
-    // Cap the total bytes we'll accumulate (16 KB header limit) and
-    // the total wait time (5 s) so a malicious or stuck client can't
-    // hold a handler thread indefinitely.
-    request.reserve(2048);
-    {
-        char buffer[4096];
-        constexpr size_t kMaxHeaderBytes = 16 * 1024;
-        constexpr int    kRecvTimeoutMs  = 5000;
-
-        // SO_RCVTIMEO so each recv has a deadline. Without it, a
-        // peer that opens the connection and sends nothing would
-        // park a thread forever.
-#ifdef _WIN32
-        DWORD tv = kRecvTimeoutMs;
-        ::setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO,
-                     reinterpret_cast<const char *>(&tv), sizeof(tv));
-#else
-        timeval tv{};
-        tv.tv_sec  = kRecvTimeoutMs / 1000;
-        tv.tv_usec = (kRecvTimeoutMs % 1000) * 1000;
-        ::setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-#endif
-
-        while (request.size() < kMaxHeaderBytes)
-        {
-            ssize_t n = m_httpServer.receiveData(clientFd, buffer,
-                                                  sizeof(buffer) - 1);
-            if (n <= 0)
-            {
-                // 0 = peer closed, <0 = error or timeout. If we have
-                // partial data buffered there's no point trying to
-                // parse it as a valid HTTP request.
-                m_httpServer.closeClient(clientFd);
-        return false;
-            }
-            buffer[n] = '\0';
-            request.append(buffer, static_cast<size_t>(n));
-            // Headers fully arrived?
-            if (request.find("\r\n\r\n") != std::string::npos) break;
-        }
-        if (request.find("\r\n\r\n") == std::string::npos)
-        {
-            // Headers larger than 16 KB or stream never produced a
-            // terminator — either malformed or hostile. Drop.
-            m_httpServer.closeClient(clientFd);
-        return false;
-        }
-
-        // The SO_RCVTIMEO we set above is socket-wide and persists
-        // for the rest of this connection. That's fine for the read
-        // phase (and would auto-cap a stuck request) but BAD for the
-        // /stream monitoring loop later, where recv is intentionally
-        // a long-living 'detect disconnect' watch — there a 5 s
-        // EAGAIN would be mis-read as a peer-close and tear the
-        // stream down every 5 s. Reset the timeout to unlimited
-        // (tv = 0) before we leave this block.
-#ifdef _WIN32
-        DWORD tvOff = 0;
-        ::setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO,
-                     reinterpret_cast<const char *>(&tvOff), sizeof(tvOff));
-#else
-        timeval tvOff{};
-        tvOff.tv_sec  = 0;
-        tvOff.tv_usec = 0;
-        ::setsockopt(clientFd, SOL_SOCKET, SO_RCVTIMEO, &tvOff, sizeof(tvOff));
-#endif
-    }
-    return true;
-}
-
-
-void HTTPTSStreamer::serveRawClient(int clientFd, const std::string &request)
+void HTTPTSStreamer::serveRawClient(int clientFd, const std::string &request, const std::string &responseHeaders)
 {
     // #49 Phase 3 — password gate. When the user has configured a
     // stream password, /raw rejects unauthenticated connections
@@ -900,127 +835,71 @@ void HTTPTSStreamer::serveRawClient(int clientFd, const std::string &request)
         m_httpServer.closeClient(clientFd);
         return;
     }
+    // Hand the socket to the /raw reactor with the response headers and
+    // the cached format header queued first; the reactor sends both.
+    std::vector<uint8_t> preamble(responseHeaders.begin(), responseHeaders.end());
     {
         std::lock_guard<std::mutex> headerLock(m_rawHeaderMutex);
-        if (m_rawHeaderWritten && !m_rawFormatHeader.empty())
+        if (m_rawHeaderWritten)
         {
-            ssize_t headerSent = m_httpServer.sendData(clientFd, m_rawFormatHeader.data(), m_rawFormatHeader.size());
-            if (headerSent < 0)
-            {
-                LOG_ERROR("Failed to send raw format header to client");
-                m_httpServer.closeClient(clientFd);
-                return;
-            }
+            preamble.insert(preamble.end(), m_rawFormatHeader.begin(), m_rawFormatHeader.end());
         }
     }
 
     enableClientKeepalive(clientFd);
-    {
-        std::lock_guard<std::mutex> lock(m_rawOutputMutex);
-        m_rawClientSockets.push_back(clientFd);
-        m_rawClientCount = m_rawClientSockets.size();
-    }
-
-    while (!m_stopRequest && m_running)
-    {
-        char dummy;
-        ssize_t result = m_httpServer.receiveData(clientFd, &dummy, 1);
-        if (result <= 0) break;
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    }
-
-    // Atomically remove from the broadcast list AND close the fd,
-    // both under the list lock. Without this writeToRawClients
-    // (which also detects send failures and closes the fd) and the
-    // handler thread could double-close the same fd value — and
-    // because Linux reuses fd numbers immediately, the second close
-    // sometimes shut down a freshly-accepted unrelated connection,
-    // breaking every subsequent client until streaming was
-    // restarted. Whichever path finds the fd still in the list
-    // wins the close; the loser sees an empty find result and exits
-    // without touching the fd.
-    {
-        std::lock_guard<std::mutex> lock(m_rawOutputMutex);
-        auto it = std::find(m_rawClientSockets.begin(), m_rawClientSockets.end(), clientFd);
-        if (it != m_rawClientSockets.end())
-        {
-            m_rawClientSockets.erase(it);
-            m_rawClientPending.erase(clientFd);
-            m_rawClientCount = m_rawClientSockets.size();
-            m_httpServer.closeClient(clientFd);
-        }
-    }
-    return;
+    m_rawClients.addClient(clientFd, preamble.data(), preamble.size());
 }
 
 
-void HTTPTSStreamer::serveStreamClient(int clientFd)
+void HTTPTSStreamer::serveStreamClient(int clientFd, const std::string &responseHeaders)
 {
-    // /stream path — unchanged from before Phase 2.
-
-    // Enviar header do formato MPEG-TS se já foi capturado
+    // Headers HTTP e header do formato MPEG-TS (se já foi capturado) vão na
+    // frente da fila do cliente. From here on the /stream reactor owns the
+    // socket: it sends, watches for disconnect and closes it.
+    std::vector<uint8_t> preamble(responseHeaders.begin(), responseHeaders.end());
     {
         std::lock_guard<std::mutex> headerLock(m_headerMutex);
-        if (m_headerWritten && !m_formatHeader.empty())
-        {
-            ssize_t headerSent = m_httpServer.sendData(clientFd, m_formatHeader.data(), m_formatHeader.size());
-            if (headerSent < 0)
-            {
-                LOG_ERROR("Failed to send format header to client");
-                m_httpServer.closeClient(clientFd);
-                return;
-            }
-        }
-        else
+        if (m_headerWritten)
         {
+            preamble.insert(preamble.end(), m_formatHeader.begin(), m_formatHeader.end());
         }
     }
 
-    // Adicionar cliente à lista
     enableClientKeepalive(clientFd);
-    {
-        std::lock_guard<std::mutex> lock(m_outputMutex);
-        m_clientSockets.push_back(clientFd);
-        m_clientCount = m_clientSockets.size();
-    }
+    m_streamClients.addClient(clientFd, preamble.data(), preamble.size());
+}
 
-    // Manter conexão aberta - dados serão enviados via writeToClients
-    // Monitorar conexão para detectar desconexão
-    while (!m_stopRequest && m_running)
-    {
-        char dummy;
-        ssize_t result = m_httpServer.receiveData(clientFd, &dummy, 1);
-        if (result <= 0)
+
+void HTTPTSStreamer::dispatchRequest(int clientFd, std::string request)
+{
+    // Runs on the /stream reactor thread. Viewer requests are answered
+    // right here — everything they send goes through a reactor preamble —
+    // but the portal, API and HLS routes write whole bodies with blocking
+    // send loops, so they keep a short-lived thread of their own.
+    std::string path;
+    const size_t methodEnd = request.find(' ');
+    if (methodEnd != std::string::npos)
+    {
+        const size_t pathEnd = request.find_first_of(" ?", methodEnd + 1);
+        if (pathEnd != std::string::npos)
         {
-            break; // Cliente desconectou
+            path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(10)); // evitar busy-waiting
     }
-
-    // Atomically remove from the broadcast list AND close the fd, same
-    // pattern as the /raw branch above — avoids the double-close race
-    // with writeToClients on disconnect.
+    const bool viewer = path == "/stream" || path.rfind("/stream/", 0) == 0 || path == "/raw";
+    if (viewer && !m_apiController.isAPIRequest(request))
     {
-        std::lock_guard<std::mutex> lock(m_outputMutex);
-        auto it = std::find(m_clientSockets.begin(), m_clientSockets.end(), clientFd);
-        if (it != m_clientSockets.end())
-        {
-            m_clientSockets.erase(it);
-            m_clientPending.erase(clientFd);
-            m_clientCount = m_clientSockets.size();
-            m_httpServer.closeClient(clientFd);
-        }
+        handleClient(clientFd, request);
+        return;
     }
+
+    std::thread clientThread(&HTTPTSStreamer::handleClient, this, clientFd, std::move(request));
+    clientThread.detach(); // Detach para não precisar fazer join
 }
 
 
-void HTTPTSStreamer::handleClient(int clientFd)
+void HTTPTSStreamer::handleClient(int clientFd, const std::string &request)
 {
-    std::string request;
-    if (!readClientRequest(clientFd, request))
-        return;
-    ssize_t bytesRead = static_cast<ssize_t>(request.size());
-    (void)bytesRead;
 
     // Se HTTPS está habilitado E Web Portal está habilitado mas o cliente está usando HTTP, redirecionar para HTTPS
     // HTTPS só faz sentido se o Web Portal estiver ativo
@@ -1123,6 +1002,9 @@ void HTTPTSStreamer::handleClient(int clientFd)
     // execute them, and the page hung waiting for never-ending data.
     bool isStreamRequest = false;
     bool isRawRequest = false;
+    bool isHLSRequest = false;
+    std::string requestPath;
+    std::string requestQuery;
     {
         size_t methodEnd = request.find(' ');
         if (methodEnd != std::string::npos)
@@ -1132,13 +1014,26 @@ void HTTPTSStreamer::handleClient(int clientFd)
             {
                 std::string path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
                 size_t q = path.find('?');
-                if (q != std::string::npos) path = path.substr(0, q);
+                if (q != std::string::npos)
+                {
+                    requestQuery = path.substr(q + 1);
+                    path = path.substr(0, q);
+                }
                 isStreamRequest = (path == "/stream" || path.rfind("/stream/", 0) == 0);
                 isRawRequest    = (path == "/raw");
+                isHLSRequest    = (path.rfind("/hls/", 0) == 0);
+                requestPath = path;
             }
         }
     }
 
+    if (isHLSRequest)
+    {
+        serveHLSRequest(clientFd, requestPath, requestQuery);
+        m_httpServer.closeClient(clientFd);
+        return;
+    }
+
     // Verificar API REST primeiro (antes do Web Portal)
     if (m_apiController.isAPIRequest(request))
     {
@@ -1172,7 +1067,8 @@ void HTTPTSStreamer::handleClient(int clientFd)
         return;
     }
 
-    // Enviar headers HTTP para stream MPEG-TS
+    // Headers HTTP para stream MPEG-TS; the reactor sends them ahead of
+    // the format header once the socket is writable.
     std::ostringstream headers;
     headers << "HTTP/1.1 200 OK\r\n";
     headers << "Content-Type: video/mp2t\r\n";
@@ -1181,24 +1077,73 @@ void HTTPTSStreamer::handleClient(int clientFd)
     headers << "Pragma: no-cache\r\n";
     headers << "\r\n";
 
-    std::string headerStr = headers.str();
-    ssize_t sent = m_httpServer.sendData(clientFd, headerStr.c_str(), headerStr.length());
-    if (sent < 0)
+    // Phase 2 of #47: branch on /raw vs /stream — same protocol on the wire,
+    // different state mirrors (format header, client list, mutex).
+    if (isRawRequest)
     {
-        // Cliente desconectou ou erro
-        m_httpServer.closeClient(clientFd);
+        serveRawClient(clientFd, request, headers.str());
         return;
     }
 
-    // Phase 2 of #47: branch on /raw vs /stream — same protocol on the wire,
-    // different state mirrors (format header, client list, mutex).
-    if (isRawRequest)
+    serveStreamClient(clientFd, headers.str());
+}
+
+void HTTPTSStreamer::serveHLSRequest(int clientFd, const std::string &path, const std::string &query)
+{
+    // Bodies are whole parts/segments (tens to hundreds of KB), sent in
+    // one response with Content-Length; playlists must never be cached,
+    // media names are unique per session so they can be.
+    HLSSegmenter::Response response;
+    if (!m_hlsSegmenter.serve(path.substr(5), query, response)) // strip "/hls/"
     {
-        serveRawClient(clientFd, request);
+        send404(clientFd);
         return;
     }
 
-    serveStreamClient(clientFd);
+    std::ostringstream headers;
+    headers << "HTTP/1.1 200 OK\r\n";
+    headers << "Content-Type: " << response.contentType << "\r\n";
+    headers << "Content-Length: " << response.body.size() << "\r\n";
+    headers << (response.cacheable ? "Cache-Control: public, max-age=60\r\n"
+                                   : "Cache-Control: no-cache, no-store\r\n");
+    headers << "Access-Control-Allow-Origin: *\r\n";
+    headers << "Connection: close\r\n";
+    headers << "\r\n";
+
+    if (sendAll(clientFd, headers.str()))
+    {
+        sendAll(clientFd, response.body);
+    }
+}
+
+bool HTTPTSStreamer::sendAll(int clientFd, const std::string &data)
+{
+    // sendData() is non-blocking (0 = socket full); retry for up to ~5 s
+    // so a slow HLS client can't pin its request thread forever.
+    const char *p = data.data();
+    size_t remaining = data.size();
+    int eagainRetries = 0;
+    while (remaining > 0 && !m_stopRequest)
+    {
+        ssize_t n = m_httpServer.sendData(clientFd, p, remaining);
+        if (n < 0)
+        {
+            return false;
+        }
+        if (n == 0)
+        {
+            if (++eagainRetries > 500)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        eagainRetries = 0;
+        p += n;
+        remaining -= static_cast<size_t>(n);
+    }
+    return remaining == 0;
 }
 
 void HTTPTSStreamer::send404(int clientFd)
@@ -1229,122 +1174,17 @@ int HTTPTSStreamer::writeToClients(const uint8_t *buf, int buf_size)
         }
     }
 
-    // Broadcast to every connected client. EAGAIN / partial sends used
-    // to silently drop the unsent tail; that corrupts MPEG-TS framing
-    // and mpegts.js loses the SourceBuffer permanently. We now stash
-    // the leftover bytes in a per-client tail buffer and drain it on
-    // the next call so byte order is preserved across brief slow-downs.
-    {
-        std::lock_guard<std::mutex> lock(m_outputMutex);
-
-        if (m_stopRequest || m_clientSockets.empty())
-        {
-            return buf_size;
-        }
-
-        auto it = m_clientSockets.begin();
-        while (it != m_clientSockets.end())
-        {
-            const int clientFd = *it;
-            ClientPending &p = m_clientPending[clientFd]; // default-construct if missing
-            bool drop = false;
-
-            // 1. Try to drain any pending bytes from a previous call first.
-            //    Order matters: we cannot send 'buf' before the existing
-            //    tail or the receiver sees a discontinuity.
-            while (p.pending() > 0)
-            {
-                ssize_t sent = m_httpServer.sendData(
-                    clientFd,
-                    p.tail.data() + p.tailOffset,
-                    p.pending());
-                if (sent < 0) { drop = true; break; }
-                if (sent == 0) break; // EAGAIN — kernel buffer still full
-                p.tailOffset += static_cast<size_t>(sent);
-                if (p.tailOffset >= p.tail.size())
-                {
-                    p.tail.clear();
-                    p.tailOffset = 0;
-                }
-            }
-
-            // 2. If the tail is empty, try the new payload directly.
-            size_t newOffset = 0;
-            if (!drop && p.pending() == 0)
-            {
-                while (newOffset < static_cast<size_t>(buf_size))
-                {
-                    ssize_t sent = m_httpServer.sendData(
-                        clientFd,
-                        buf + newOffset,
-                        static_cast<size_t>(buf_size) - newOffset);
-                    if (sent < 0) { drop = true; break; }
-                    if (sent == 0) break; // EAGAIN
-                    newOffset += static_cast<size_t>(sent);
-                }
-            }
-
-            // 3. Stash anything we couldn't send so the next call resumes
-            //    from exactly where we left off.
-            if (!drop)
-            {
-                if (p.pending() > 0)
-                {
-                    // Couldn't drain the old tail — append the new payload
-                    // whole, otherwise the receiver would see buf before
-                    // the still-queued previous packet.
-                    p.tail.insert(p.tail.end(), buf, buf + buf_size);
-                }
-                else if (newOffset < static_cast<size_t>(buf_size))
-                {
-                    p.tail.assign(buf + newOffset, buf + buf_size);
-                    p.tailOffset = 0;
-                }
-
-                // Compact the partially-consumed prefix once it gets
-                // chunky so the tail doesn't grow unbounded just from
-                // offset accounting.
-                if (p.tailOffset > 64 * 1024)
-                {
-                    p.tail.erase(p.tail.begin(),
-                                 p.tail.begin() + static_cast<std::ptrdiff_t>(p.tailOffset));
-                    p.tailOffset = 0;
-                }
-
-                // Hopelessly slow client: backlog past the bound means
-                // the receiver has been falling behind for seconds. Cut
-                // them rather than burn memory forever.
-                if (p.pending() > kMaxClientBacklog)
-                {
-                    LOG_WARN("/stream client fd=" + std::to_string(clientFd) +
-                             " send backlog " + std::to_string(p.pending()) +
-                             " bytes exceeded cap (" + std::to_string(kMaxClientBacklog) +
-                             ") — closing");
-                    drop = true;
-                }
-            }
-
-            if (drop)
-            {
-                m_httpServer.closeClient(clientFd);
-                m_clientPending.erase(clientFd);
-                it = m_clientSockets.erase(it);
-                m_clientCount = m_clientSockets.size();
-            }
-            else
-            {
-                ++it;
-            }
-        }
-
-        return buf_size;
-    }
+    // Append to the client ring and return — the reactor thread does the
+    // sends, so a slow viewer can no longer stall the muxer (and with it
+    // the encoder thread). Each client resumes from its own cursor, so
+    // partial sends never break TS byte order.
+    m_streamClients.broadcast(buf, static_cast<size_t>(buf_size));
+    return buf_size;
 }
 
 int HTTPTSStreamer::writeToRawClients(const uint8_t *buf, int buf_size)
 {
-    // Mirror of writeToClients, operating on the /raw output state. Kept as
-    // a near-duplicate so the /stream path stays byte-for-byte unchanged.
+    // Mirror of writeToClients, operating on the /raw output state.
     if (!buf || buf_size <= 0 || m_stopRequest)
     {
         return buf_size;
@@ -1359,112 +1199,10 @@ int HTTPTSStreamer::writeToRawClients(const uint8_t *buf, int buf_size)
         }
     }
 
-    // Same tail-buffer logic as writeToClients — see the long comment
-    // there. /raw clients are FFmpeg-driven and rarely hit backpressure
-    // in practice (no Cloudflare hop), but the corruption mode is
-    // identical so we apply the same fix for symmetry.
-    {
-        std::lock_guard<std::mutex> lock(m_rawOutputMutex);
-        if (m_stopRequest || m_rawClientSockets.empty())
-        {
-            return buf_size;
-        }
-
-        auto it = m_rawClientSockets.begin();
-        while (it != m_rawClientSockets.end())
-        {
-            const int clientFd = *it;
-            ClientPending &p = m_rawClientPending[clientFd];
-            bool drop = false;
-
-            while (p.pending() > 0)
-            {
-                ssize_t sent = m_httpServer.sendData(
-                    clientFd,
-                    p.tail.data() + p.tailOffset,
-                    p.pending());
-                if (sent < 0) { drop = true; break; }
-                if (sent == 0) break;
-                p.tailOffset += static_cast<size_t>(sent);
-                if (p.tailOffset >= p.tail.size())
-                {
-                    p.tail.clear();
-                    p.tailOffset = 0;
-                }
-            }
-
-            size_t newOffset = 0;
-            if (!drop && p.pending() == 0)
-            {
-                while (newOffset < static_cast<size_t>(buf_size))
-                {
-                    ssize_t sent = m_httpServer.sendData(
-                        clientFd,
-                        buf + newOffset,
-                        static_cast<size_t>(buf_size) - newOffset);
-                    if (sent < 0) { drop = true; break; }
-                    if (sent == 0) break;
-                    newOffset += static_cast<size_t>(sent);
-                }
-            }
-
-            if (!drop)
-            {
-                if (p.pending() > 0)
-                {
-                    p.tail.insert(p.tail.end(), buf, buf + buf_size);
-                }
-                else if (newOffset < static_cast<size_t>(buf_size))
-                {
-                    p.tail.assign(buf + newOffset, buf + buf_size);
-                    p.tailOffset = 0;
-                }
-                if (p.tailOffset > 64 * 1024)
-                {
-                    p.tail.erase(p.tail.begin(),
-                                 p.tail.begin() + static_cast<std::ptrdiff_t>(p.tailOffset));
-                    p.tailOffset = 0;
-                }
-                // Slow /raw receiver (remote hop, congested link). Closing
-                // it here forced the client into a full messy reconnect —
-                // re-probe, deferred audio sink, multi-second A/V desync,
-                // audio dropout (#93). The /raw consumer is an FFmpeg
-                // demuxer that resyncs at the next in-band keyframe/PAT, so
-                // instead of tearing down we DROP the queued backlog and
-                // keep the connection. We clear the whole tail (rather than
-                // a partial trim) so what we resume sending stays 188-byte
-                // TS-packet aligned; the client sees a brief glitch, not a
-                // disconnect. /stream (browser mpegts.js) is left closing
-                // because it cannot tolerate a mid-stream byte drop.
-                if (p.pending() > kMaxClientBacklog)
-                {
-                    p.tail.clear();
-                    p.tailOffset = 0;
-                    uint64_t n = ++p.backlogDrops;
-                    if (n == 1 || (n % 30) == 0)
-                    {
-                        LOG_WARN("/raw client fd=" + std::to_string(clientFd) +
-                                 " send backlog exceeded cap — dropped backlog, keeping connection (total drops: " +
-                                 std::to_string(n) + ")");
-                    }
-                }
-            }
-
-            if (drop)
-            {
-                m_httpServer.closeClient(clientFd);
-                m_rawClientPending.erase(clientFd);
-                it = m_rawClientSockets.erase(it);
-                m_rawClientCount = m_rawClientSockets.size();
-            }
-            else
-            {
-                ++it;
-            }
-        }
-
-        return buf_size;
-    }
+    // A lagging /raw client skips to a keyframe instead of being closed
+    // (#93) — see the limits set in the constructor.
+    m_rawClients.broadcast(buf, static_cast<size_t>(buf_size));
+    return buf_size;
 }
 
 bool HTTPTSStreamer::initializeEncoding()
@@ -1532,6 +1270,15 @@ bool HTTPTSStreamer::initializeEncoding()
     }
 
     LOG_INFO("MediaMuxer inicializado com sucesso - encoding pronto para streaming");
+    m_streamPacketBus.attachSource(&m_mediaEncoder);
+
+    // LL-HLS re-mux of the same packets. Soft-fail like /raw: codecs HLS
+    // can't carry (VP8/VP9, MP3) just leave /hls/ returning 404.
+    m_hlsSegmenter.initialize(videoConfig, audioConfig,
+                              m_mediaEncoder.getVideoCodecContext(),
+                              m_mediaEncoder.getAudioCodecContext(),
+                              [this]()
+                              { m_mediaEncoder.requestKeyframe(); });
 
     // Phase 2 of #47: also bring up the /raw pipeline so RetroCapture remote
     // clients can consume the pre-shader feed. Soft-fail — if /raw can't
@@ -1641,6 +1388,10 @@ void HTTPTSStreamer::cleanupRawPipeline()
 
 void HTTPTSStreamer::cleanupEncoding()
 {
+    m_streamPacketBus.detachSource();
+    // Before the encoder goes: the segmenter's muxer holds its codec contexts.
+    m_hlsSegmenter.cleanup();
+
     // Flush encoder para processar frames pendentes
     if (m_mediaEncoder.isInitialized())
     {
@@ -1721,9 +1472,19 @@ void HTTPTSStreamer::serverThread()
             break; // Sair do loop se não estiver rodando ou se o servidor foi fechado
         }
 
-        // Processar cliente em thread separada
-        std::thread clientThread(&HTTPTSStreamer::handleClient, this, clientFd);
-        clientThread.detach(); // Detach para não precisar fazer join
+        // Configurar socket para baixa latência
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+        int flag = 1;
+        setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+#elif defined(_WIN32)
+        // Windows: usar int (BOOL é apenas um typedef para int)
+        int flag = 1;
+        setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, (const char *)&flag, sizeof(flag));
+#endif
+
+        // No thread per connection: the /stream reactor reads the request
+        // (16 KB / 5 s cap) and calls dispatchRequest() once it is in.
+        m_streamClients.addConnection(clientFd);
     }
 
     return;
@@ -1738,6 +1499,8 @@ void HTTPTSStreamer::encodingThread()
     int cleanupCounter = 0;
     const int CLEANUP_INTERVAL = 10;
 
+    auto statStart = std::chrono::steady_clock::now();
+
     while (m_running)
     {
         if (m_stopRequest)
@@ -1745,7 +1508,10 @@ void HTTPTSStreamer::encodingThread()
             break;
         }
 
-        bool processedAny = false;
+        // Snapshot before draining: anything pushed from here on bumps the
+        // sequence, so the wait at the bottom can't miss it.
+        const uint64_t seenSequence = m_streamSynchronizer.getDataSequence();
+        bool moreVideo = false;
 
         // Limpar dados antigos do MediaSynchronizer apenas ocasionalmente (não a cada iteração)
         // Isso evita remover dados muito agressivamente antes de serem processados
@@ -1777,7 +1543,8 @@ void HTTPTSStreamer::encodingThread()
                     {
                         m_mediaMuxer.muxPacket(p);
                     }
-                    processedAny = true;
+                    m_streamPacketBus.publish(aPackets);
+                    m_hlsSegmenter.push(aPackets);
                 }
                 m_streamSynchronizer.markAudioChunkProcessedByTimestamp(chunk.captureTimestampUs);
             }
@@ -1816,6 +1583,7 @@ void HTTPTSStreamer::encodingThread()
                 // Limitar número de frames processados por iteração
                 if (framesProcessed >= MAX_FRAMES_PER_ITERATION)
                 {
+                    moreVideo = true;
                     break;
                 }
 
@@ -1824,14 +1592,15 @@ void HTTPTSStreamer::encodingThread()
                     // Encodar frame usando MediaEncoder
                     std::vector<MediaEncoder::EncodedPacket> packets;
                     if (m_mediaEncoder.encodeVideo(frame.data->data(), frame.width, frame.height,
-                                                   frame.captureTimestampUs, packets))
+                                                   frame.captureTimestampUs, packets, frame.format))
                     {
                         // Muxar pacotes usando MediaMuxer
                         for (const auto &packet : packets)
                         {
                             m_mediaMuxer.muxPacket(packet);
                         }
-                        processedAny = true;
+                        m_streamPacketBus.publish(packets);
+                        m_hlsSegmenter.push(packets);
                         framesProcessed++;
                         // Mark this specific frame as processed by its
                         // capture timestamp — see the matching note in
@@ -1860,40 +1629,30 @@ void HTTPTSStreamer::encodingThread()
             }
         }
 
-        // Adicionar delay mínimo entre iterações para evitar aceleração
-        // Reduzir ou remover delay quando há backlog para processar mais rápido
-        if (processedAny)
+        auto nowTs = std::chrono::steady_clock::now();
+        if (std::chrono::duration_cast<std::chrono::seconds>(nowTs - statStart).count() >= 1)
         {
-            if (hasBacklog)
-            {
-                // Quando há backlog, delay mínimo para não consumir 100% CPU mas processar rápido
-                std::this_thread::sleep_for(std::chrono::microseconds(100)); // 100µs apenas
-            }
-            else
+            auto latency = m_streamSynchronizer.fetchVideoQueueLatency();
+            if (latency.frames > 0)
             {
-                // Sem backlog: delay baseado no FPS para manter taxa natural
-                // Para 60 FPS: ~16.67ms por frame, mas processamos 2 frames, então ~8ms
-                int64_t frameTimeUs = 1000000LL / static_cast<int64_t>(m_fps); // Tempo por frame em microssegundos
-                int64_t delayUs = frameTimeUs / 2;                             // Delay proporcional (já que processamos 2 frames)
-                std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+                char buf[128];
+                std::snprintf(buf, sizeof(buf), "/stream encoder: queue latency avg=%.2fms max=%.2fms (%llu frames)",
+                              (latency.totalUs / 1000.0) / latency.frames, latency.maxUs / 1000.0,
+                              static_cast<unsigned long long>(latency.frames));
+                LOG_DEBUG(buf);
             }
+            statStart = nowTs;
         }
-        else
-        {
-            // Se não processamos nada, verificar se há dados pendentes antes de dormir
-            bool hasPendingData = (videoBufferSize > 0 || audioBufferSize > 0);
 
-            if (!hasPendingData)
-            {
-                // Só dormir se realmente não há dados para processar
-                std::this_thread::sleep_for(std::chrono::milliseconds(1)); // 1ms quando não há dados
-            }
-            else
-            {
-                // Há dados mas não processamos (possivelmente aguardando sincronização)
-                // Delay mínimo para não consumir CPU mas continuar tentando
-                std::this_thread::sleep_for(std::chrono::microseconds(500)); // 500µs quando há dados mas não processou
-            }
+        // Frames left over from the per-iteration cap: go straight back.
+        // Otherwise block until the capture side pushes something — this
+        // replaced the 100 µs / frameTime/2 / 500 µs / 1 ms sleep ladder,
+        // which both burned CPU while idle and added up to half a frame of
+        // latency to every frame. The timeout only keeps cleanupOldData()
+        // ticking when capture stops.
+        if (!moreVideo)
+        {
+            m_streamSynchronizer.waitForData(seenSequence, ENCODER_IDLE_WAIT_US);
         }
     }
 
@@ -1926,7 +1685,8 @@ void HTTPTSStreamer::rawEncodingThread()
     {
         if (m_stopRequest) break;
 
-        bool processedAny = false;
+        const uint64_t seenSequence = m_rawStreamSynchronizer.getDataSequence();
+        bool moreVideo = false;
         ++statIterations;
 
         cleanupCounter++;
@@ -1952,7 +1712,6 @@ void HTTPTSStreamer::rawEncodingThread()
                     {
                         m_rawMediaMuxer.muxPacket(p);
                     }
-                    processedAny = true;
                     ++statAudioEncoded;
                 }
                 m_rawStreamSynchronizer.markAudioChunkProcessedByTimestamp(chunk.captureTimestampUs);
@@ -1981,18 +1740,21 @@ void HTTPTSStreamer::rawEncodingThread()
             for (const auto &frame : pendingVideo)
             {
                 if (m_stopRequest) break;
-                if (framesProcessed >= MAX_FRAMES_PER_ITERATION) break;
+                if (framesProcessed >= MAX_FRAMES_PER_ITERATION)
+                {
+                    moreVideo = true;
+                    break;
+                }
                 if (frame.processed || !frame.data || frame.width == 0 || frame.height == 0) continue;
 
                 std::vector<MediaEncoder::EncodedPacket> packets;
                 if (m_rawMediaEncoder.encodeVideo(frame.data->data(), frame.width, frame.height,
-                                                 frame.captureTimestampUs, packets))
+                                                 frame.captureTimestampUs, packets, frame.format))
                 {
                     for (const auto &packet : packets)
                     {
                         m_rawMediaMuxer.muxPacket(packet);
                     }
-                    processedAny = true;
                     framesProcessed++;
                     ++statVideoEncoded;
                 }
@@ -2017,10 +1779,20 @@ void HTTPTSStreamer::rawEncodingThread()
             // CPU swscale convert, the HW surface upload, or the codec is the
             // 60 fps bottleneck. avg = accumulated µs / frames encoded.
             auto st = m_rawMediaEncoder.fetchVideoStageTimings();
+            auto latency = m_rawStreamSynchronizer.fetchVideoQueueLatency();
             std::string line = "/raw encoder: video=" + std::to_string(statVideoEncoded) +
                                "/s audio=" + std::to_string(statAudioEncoded) +
                                "/s iters=" + std::to_string(statIterations) +
                                " maxVidQueue=" + std::to_string(statMaxQueueDepth);
+            if (latency.frames > 0)
+            {
+                // Push -> encoded+muxed, includes the time spent waiting
+                // for the encoder thread to wake up.
+                char buf[96];
+                std::snprintf(buf, sizeof(buf), " queueLatency(ms): avg=%.2f max=%.2f",
+                              (latency.totalUs / 1000.0) / latency.frames, latency.maxUs / 1000.0);
+                line += buf;
+            }
             if (st.frames > 0)
             {
                 double convMs = (st.convertUs / 1000.0) / st.frames;
@@ -2044,29 +1816,10 @@ void HTTPTSStreamer::rawEncodingThread()
             statStart = nowTs;
         }
 
-        if (processedAny)
-        {
-            if (hasBacklog)
-            {
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
-            }
-            else
-            {
-                int64_t frameTimeUs = 1000000LL / static_cast<int64_t>(m_fps);
-                std::this_thread::sleep_for(std::chrono::microseconds(frameTimeUs / 2));
-            }
-        }
-        else
+        // Same wake-up scheme as encodingThread.
+        if (!moreVideo)
         {
-            bool hasPendingData = (videoBufferSize > 0 || audioBufferSize > 0);
-            if (!hasPendingData)
-            {
-                std::this_thread::sleep_for(std::chrono::milliseconds(1));
-            }
-            else
-            {
-                std::this_thread::sleep_for(std::chrono::microseconds(500));
-            }
+            m_rawStreamSynchronizer.waitForData(seenSequence, ENCODER_IDLE_WAIT_US);
         }
     }
 }
@@ -3,10 +3,13 @@
 #include "IStreamer.h"
 #include "WebPortal.h"
 #include "HTTPServer.h"
+#include "StreamClientReactor.h"
 #include "APIController.h"
+#include "HLSSegmenter.h"
 #include "../encoding/MediaEncoder.h"
 #include "../encoding/MediaMuxer.h"
 #include "../encoding/MediaSynchronizer.h"
+#include "../encoding/EncodedPacketBus.h"
 #include <thread>
 #include <mutex>
 #include <atomic>
@@ -51,7 +54,8 @@ public:
     bool isActive() const override;
     bool canStart() const;                  // Verifica se pode iniciar (não está em cooldown)
     int64_t getCooldownRemainingMs() const; // Retorna tempo restante de cooldown em ms
-    bool pushFrame(const uint8_t *data, uint32_t width, uint32_t height) override;
+    bool pushFrame(const uint8_t *data, uint32_t width, uint32_t height,
+                   VideoFrameFormat format = VideoFrameFormat::RGB24) override;
     bool pushAudio(const int16_t *samples, size_t sampleCount) override;
     std::string getStreamUrl() const override;
     uint32_t getClientCount() const override;
@@ -61,9 +65,10 @@ public:
     // at /raw, fed with pre-shader frames. Same codec config as /stream; the
     // contract is that /raw is ALWAYS pre-shader regardless of any
     // per-pipeline shader-bypass toggle that may flip /stream's contents.
-    bool pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height);
-    uint32_t getRawClientCount() const { return m_rawClientCount.load(); }
-    bool hasRawClients() const { return m_rawClientCount.load() > 0; }
+    bool pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height,
+                      VideoFrameFormat format = VideoFrameFormat::RGB24);
+    uint32_t getRawClientCount() const { return m_rawClients.getClientCount(); }
+    bool hasRawClients() const { return m_rawClients.getClientCount() > 0; }
 
     // /stream-only subscriber count. getClientCount() above deliberately
     // combines /stream + /raw for the audience display (#68); this counts
@@ -73,8 +78,21 @@ public:
     // combined count let a /raw client defeat the #121 gate, so the host
     // ran two concurrent 720p60 encodes and the /stream synchronizer
     // overflowed continuously).
-    uint32_t getStreamClientCount() const { return m_clientCount.load(); }
-    bool hasStreamClients() const { return m_clientCount.load() > 0; }
+    uint32_t getStreamClientCount() const { return m_streamClients.getClientCount(); }
+    // HLS players poll instead of holding a socket open, so a recent
+    // /hls/ request counts as a /stream viewer too — they watch the same
+    // encode (see HLSSegmenter).
+    bool hasStreamClients() const
+    {
+        return m_streamClients.getClientCount() > 0 || m_hlsSegmenter.hasRecentRequests();
+    }
+
+    // Shared encode: the /stream encoder's packets are also published
+    // here so a recording with identical settings can mux them instead of
+    // running its own encoder. While anyone is subscribed the /stream
+    // encoder must keep being fed even with no /stream viewers.
+    EncodedPacketBus *getEncodedPacketBus() { return &m_streamPacketBus; }
+    bool hasEncodeSubscribers() const { return m_streamPacketBus.hasSubscribers(); }
 
     // Additional configuration methods
     void setVideoBitrate(uint32_t bitrate) { m_videoBitrate = bitrate; }
@@ -202,12 +220,15 @@ private:
     bool initializeRawPipeline(); // Phase 2 of #47 — sets up the raw encoder + muxer.
     void cleanupRawPipeline();    // Phase 2 of #47 — tears down the raw encoder + muxer.
     int  writeToRawClients(const uint8_t *buf, int buf_size); // Phase 2 of #47.
-    void handleClient(int clientFd);
-    // #156 — phases extracted from the monolithic handleClient (behavior-preserving):
-    // request read-with-timeout loop, and the /raw and /stream serving branches.
-    bool readClientRequest(int clientFd, std::string &request);
-    void serveRawClient(int clientFd, const std::string &request);
-    void serveStreamClient(int clientFd);
+    // Reactor thread: answer viewer requests inline, the rest on a worker.
+    void dispatchRequest(int clientFd, std::string request);
+    void handleClient(int clientFd, const std::string &request);
+    // #156 — the /raw and /stream serving branches of handleClient. Both
+    // queue responseHeaders ahead of the format header in the reactor.
+    void serveRawClient(int clientFd, const std::string &request, const std::string &responseHeaders);
+    void serveStreamClient(int clientFd, const std::string &responseHeaders);
+    void serveHLSRequest(int clientFd, const std::string &path, const std::string &query);
+    bool sendAll(int clientFd, const std::string &data);
     void send404(int clientFd);     // Enviar resposta 404
     void encodingThread();          // Thread para encoding com sincronização baseada em timestamps
     void cleanupOldData();          // Limpar dados antigos baseado em tempo
@@ -256,6 +277,8 @@ private:
     MediaEncoder m_mediaEncoder;
     MediaMuxer m_mediaMuxer;
     MediaSynchronizer m_streamSynchronizer;
+    EncodedPacketBus m_streamPacketBus; // fan-out of m_mediaEncoder's packets
+    HLSSegmenter m_hlsSegmenter;        // /hls/ — LL-HLS re-mux of the same packets
 
     std::atomic<bool> m_active{false};
     std::atomic<bool> m_running{false};
@@ -310,7 +333,6 @@ private:
 
     // Mutexes para sincronização
     std::mutex m_muxMutex;    // Proteger av_interleaved_write_frame (não é thread-safe)
-    std::mutex m_outputMutex; // Proteger lista de clientes e writeToClients
     std::mutex m_headerMutex; // Proteger m_formatHeader
 
     // Threads
@@ -326,42 +348,11 @@ private:
     std::string m_foundSSLCertPath; // Caminho real do certificado encontrado (após busca)
     std::string m_foundSSLKeyPath;  // Caminho real da chave encontrada (após busca)
 
-    std::atomic<uint32_t> m_clientCount{0};
-
-    // Output buffer for clients
-    std::vector<int> m_clientSockets;
-
-    /**
-     * Per-client outbound tail buffer.
-     *
-     * The encoder thread feeds writeToClients() with TS packets at the
-     * source FPS. When a client (typically the browser side of a
-     * Cloudflare/FRP tunnel) can't drain the kernel TCP send buffer
-     * fast enough, send() returns partial or EAGAIN. Silently dropping
-     * the unsent tail — which the original implementation did — breaks
-     * MPEG-TS continuity counters and mpegts.js loses the SourceBuffer
-     * forever (visible to the user as "playback freezes after a while
-     * and never recovers"). Stashing the unsent bytes here and
-     * draining them on the next call preserves byte order across
-     * brief network glitches.
-     *
-     * Bounded so a hopelessly slow client doesn't grow memory without
-     * limit; on overflow we close the fd, mirroring how the existing
-     * code reacts to send() returning -1.
-     */
-    struct ClientPending
-    {
-        std::vector<uint8_t> tail;
-        size_t tailOffset = 0;
-        // #93 — how many times this client's send backlog overflowed the
-        // cap. For /raw we drop the backlog and keep the connection (the
-        // FFmpeg demuxer resyncs at the next keyframe) instead of closing
-        // and forcing a messy reconnect; this just throttles the log.
-        uint64_t backlogDrops = 0;
-        size_t pending() const { return tail.size() - tailOffset; }
-    };
-    static constexpr size_t kMaxClientBacklog = 4 * 1024 * 1024; // 4 MB
-    std::unordered_map<int, ClientPending> m_clientPending;
+    // Long-lived /stream and /raw viewers: one epoll I/O thread each,
+    // fed by writeToClients / writeToRawClients. Declared after
+    // m_httpServer — their shutdown closes fds through it.
+    StreamClientReactor m_streamClients{"stream"};
+    StreamClientReactor m_rawClients{"raw"};
 
     // Header do formato MPEG-TS (enviado quando cliente se conecta)
     std::vector<uint8_t> m_formatHeader;
@@ -372,18 +363,13 @@ private:
     // Parallel mirror of the /stream pipeline above, fed with pre-shader
     // frames. Shares the codec config (bitrate / codec / preset) — Strategy B
     // of the design — but uses its own encoder, muxer, synchronizer, client
-    // list and format-header cache so the two outputs are fully independent.
+    // reactor and format-header cache so the two outputs are fully independent.
     MediaEncoder      m_rawMediaEncoder;
     MediaMuxer        m_rawMediaMuxer;
     MediaSynchronizer m_rawStreamSynchronizer;
 
-    std::mutex m_rawOutputMutex; // Proteger m_rawClientSockets e writeToRawClients
     std::mutex m_rawHeaderMutex; // Proteger m_rawFormatHeader
 
-    std::atomic<uint32_t> m_rawClientCount{0};
-    std::vector<int>      m_rawClientSockets;
-    std::unordered_map<int, ClientPending> m_rawClientPending; // same semantics as m_clientPending
-
     std::vector<uint8_t> m_rawFormatHeader;
     bool                 m_rawHeaderWritten = false;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../encoding/VideoFrameFormat.h"
 #include <cstdint>
 #include <string>
 
@@ -47,12 +48,14 @@ public:
 
     /**
      * Push a frame to be streamed
-     * @param data RGB frame data (width * height * 3 bytes)
+     * @param data Frame data (RGB24: width * height * 3 bytes; see VideoFrameFormat)
      * @param width Frame width
      * @param height Frame height
+     * @param format Pixel layout of data
      * @return true if frame was queued successfully
      */
-    virtual bool pushFrame(const uint8_t *data, uint32_t width, uint32_t height) = 0;
+    virtual bool pushFrame(const uint8_t *data, uint32_t width, uint32_t height,
+                           VideoFrameFormat format = VideoFrameFormat::RGB24) = 0;
 
     /**
      * Push audio samples to be streamed
@@ -0,0 +1,155 @@
+#include "StaticFileCache.h"
+#include "../utils/Logger.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+// Not all MinGW-w64 headers define the POSIX macro
+#ifndef S_ISREG
+#define S_ISREG(m) (((m) & S_IFMT) == S_IFREG)
+#endif
+
+#ifdef RETROCAPTURE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+    constexpr int64_t kRevalidateMs = 2000;
+    constexpr size_t kMinGzipSize = 1024; // below this the headers dominate
+
+    int64_t nowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    bool statFile(const std::string &path, int64_t &mtime, uint64_t &size)
+    {
+        struct stat st{};
+        if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            return false;
+        }
+        mtime = static_cast<int64_t>(st.st_mtime);
+        size = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    // FNV-1a 64 — only needs to change when the bytes do.
+    std::string makeETag(const std::string &content)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : content)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        char buf[40];
+        std::snprintf(buf, sizeof(buf), "\"%016llx-%llx\"", static_cast<unsigned long long>(hash),
+                      static_cast<unsigned long long>(content.size()));
+        return buf;
+    }
+
+#ifdef RETROCAPTURE_HAVE_ZLIB
+    std::string gzipCompress(const std::string &input)
+    {
+        z_stream zs{};
+        // windowBits 15 + 16 = gzip wrapper (what Content-Encoding: gzip expects).
+        if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        {
+            return "";
+        }
+        std::string output(deflateBound(&zs, static_cast<uLong>(input.size())), '\0');
+        zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+        zs.avail_in = static_cast<uInt>(input.size());
+        zs.next_out = reinterpret_cast<Bytef *>(&output[0]);
+        zs.avail_out = static_cast<uInt>(output.size());
+        const int ret = deflate(&zs, Z_FINISH);
+        output.resize(zs.total_out);
+        deflateEnd(&zs);
+        return ret == Z_STREAM_END ? output : std::string();
+    }
+#endif
+}
+
+std::shared_ptr<const StaticFileCache::Entry> StaticFileCache::get(const std::string &fullPath, bool compressible)
+{
+    const int64_t now = nowMs();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_slots.find(fullPath);
+        if (it != m_slots.end() && now - it->second.checkedMs < kRevalidateMs)
+        {
+            return it->second.entry;
+        }
+    }
+
+    int64_t mtime = 0;
+    uint64_t size = 0;
+    if (!statFile(fullPath, mtime, size))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots.erase(fullPath);
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_slots.find(fullPath);
+        if (it != m_slots.end() && it->second.entry->mtime == mtime && it->second.entry->size == size)
+        {
+            it->second.checkedMs = now;
+            return it->second.entry;
+        }
+    }
+
+    // Load (and compress) outside the lock; two racing loads of the same
+    // file just produce identical entries.
+    std::shared_ptr<const Entry> entry = load(fullPath, compressible, mtime, size);
+    if (!entry)
+    {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Slot &slot = m_slots[fullPath];
+    slot.entry = entry;
+    slot.checkedMs = now;
+    return entry;
+}
+
+std::shared_ptr<const StaticFileCache::Entry> StaticFileCache::load(const std::string &fullPath, bool compressible,
+                                                                    int64_t mtime, uint64_t size)
+{
+    std::ifstream file(fullPath, std::ios::binary);
+    if (!file.is_open())
+    {
+        LOG_ERROR("StaticFileCache: failed to open " + fullPath);
+        return nullptr;
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+
+    auto entry = std::make_shared<Entry>();
+    entry->content = content.str();
+    entry->etag = makeETag(entry->content);
+    entry->mtime = mtime;
+    entry->size = size;
+#ifdef RETROCAPTURE_HAVE_ZLIB
+    if (compressible && entry->content.size() >= kMinGzipSize)
+    {
+        std::string gz = gzipCompress(entry->content);
+        if (!gz.empty() && gz.size() < entry->content.size())
+        {
+            entry->gzip = std::move(gz);
+        }
+    }
+#else
+    (void)compressible;
+    (void)kMinGzipSize;
+#endif
+    return entry;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * StaticFileCache - in-memory copy of the portal's web assets
+ *
+ * The portal's CSS/JS/HTML are small and requested by every viewer, so
+ * they are read once and kept in memory together with a strong ETag and,
+ * for text types, a precomputed gzip variant (only when built with zlib
+ * and only if it actually saves bytes). Entries are revalidated against
+ * the file's mtime/size at most every couple of seconds, so editing a
+ * file under web/ still shows up without a restart.
+ *
+ * Thread-safe; entries are immutable and handed out as shared_ptr.
+ */
+class StaticFileCache
+{
+public:
+    struct Entry
+    {
+        std::string content;
+        std::string gzip; // empty = no gzip variant
+        std::string etag; // quoted, identity encoding; gzip uses etag + "-gz"
+        int64_t mtime = 0;
+        uint64_t size = 0;
+    };
+
+    // compressible: worth building a gzip variant (text-like types).
+    // nullptr when the file doesn't exist or can't be read.
+    std::shared_ptr<const Entry> get(const std::string &fullPath, bool compressible);
+
+private:
+    struct Slot
+    {
+        std::shared_ptr<const Entry> entry;
+        int64_t checkedMs = 0;
+    };
+
+    static std::shared_ptr<const Entry> load(const std::string &fullPath, bool compressible,
+                                             int64_t mtime, uint64_t size);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Slot> m_slots;
+};
@@ -0,0 +1,1038 @@
+#include "StreamClientReactor.h"
+#include "../utils/Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+
+#if defined(PLATFORM_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <winsock2.h>
+#endif
+
+namespace
+{
+    // epoll data id reserved for the wake-up eventfd; client ids start at 1.
+    constexpr uint64_t kWakeId = 0;
+    constexpr int kMaxEventsPerWait = 64;
+
+    constexpr size_t kTsPacketSize = 188;
+    constexpr uint8_t kTsSyncByte = 0x47;
+    constexpr uint16_t kTsPatPid = 0x0000;
+
+    // ISO/IEC 13818-1 stream_type values for video elementary streams.
+    bool isVideoStreamType(uint8_t type)
+    {
+        switch (type)
+        {
+        case 0x01: // MPEG-1 video
+        case 0x02: // MPEG-2 video
+        case 0x10: // MPEG-4 part 2
+        case 0x1B: // H.264
+        case 0x24: // H.265
+        case 0x33: // H.266
+        case 0xD1: // Dirac
+        case 0xEA: // VC-1
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool setNonBlocking(int fd, bool nonBlocking)
+    {
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0)
+        {
+            return false;
+        }
+        flags = nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+        return fcntl(fd, F_SETFL, flags) == 0;
+#elif defined(_WIN32)
+        u_long nonblock = nonBlocking ? 1 : 0;
+        return ioctlsocket(static_cast<SOCKET>(fd), FIONBIO, &nonblock) == 0;
+#else
+        (void)fd;
+        (void)nonBlocking;
+        return true;
+#endif
+    }
+}
+
+StreamClientReactor::StreamClientReactor(const std::string &name)
+    : m_name(name)
+{
+}
+
+StreamClientReactor::~StreamClientReactor()
+{
+    stop();
+}
+
+void StreamClientReactor::setTransport(SendFunction sendFn, CloseFunction closeFn, ReceiveFunction receiveFn)
+{
+    m_send = std::move(sendFn);
+    m_receive = std::move(receiveFn);
+    m_close = std::move(closeFn);
+}
+
+void StreamClientReactor::setRequestHandler(RequestHandler handler)
+{
+    m_onRequest = std::move(handler);
+}
+
+void StreamClientReactor::setLimits(const Limits &limits)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_limits = limits;
+}
+
+int64_t StreamClientReactor::nowUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool StreamClientReactor::start()
+{
+    if (m_running)
+    {
+        return true;
+    }
+    if (!m_send || !m_close)
+    {
+        LOG_ERROR("StreamClientReactor[" + m_name + "]: transport not set");
+        return false;
+    }
+
+#if defined(PLATFORM_LINUX)
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0)
+    {
+        LOG_ERROR("StreamClientReactor[" + m_name + "]: epoll_create1 failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0)
+    {
+        LOG_ERROR("StreamClientReactor[" + m_name + "]: eventfd failed: " + std::string(strerror(errno)));
+        close(m_epollFd);
+        m_epollFd = -1;
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.u64 = kWakeId;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev) != 0)
+    {
+        LOG_ERROR("StreamClientReactor[" + m_name + "]: epoll_ctl(wake) failed: " + std::string(strerror(errno)));
+        close(m_wakeFd);
+        close(m_epollFd);
+        m_wakeFd = -1;
+        m_epollFd = -1;
+        return false;
+    }
+#endif
+
+    m_wakePending = false;
+    m_running = true;
+    m_thread = std::thread(&StreamClientReactor::reactorThread, this);
+    return true;
+}
+
+void StreamClientReactor::stop()
+{
+    if (!m_running.exchange(false))
+    {
+        return;
+    }
+    wake();
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &entry : m_clients)
+        {
+            fds.push_back(entry.second.fd);
+        }
+        for (auto &entry : m_requests)
+        {
+            fds.push_back(entry.second.fd);
+        }
+        m_clients.clear();
+        m_requests.clear();
+        m_clientCount = 0;
+        m_ring.clear();
+        m_ringBytes = 0;
+        m_ringFirstSeq = m_nextSeq;
+        m_lastKeyframeSeq = UINT64_MAX;
+        m_tsSkip = 0;
+        m_pmtPid = -1;
+        m_videoPid = -1;
+    }
+    for (int fd : fds)
+    {
+        m_close(fd);
+    }
+
+#if defined(PLATFORM_LINUX)
+    if (m_wakeFd >= 0)
+    {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+    if (m_epollFd >= 0)
+    {
+        close(m_epollFd);
+        m_epollFd = -1;
+    }
+#endif
+}
+
+bool StreamClientReactor::addClient(int fd, const uint8_t *preamble, size_t preambleSize)
+{
+    if (!m_running || fd < 0)
+    {
+        if (fd >= 0 && m_close)
+        {
+            m_close(fd);
+        }
+        return false;
+    }
+
+    // Sends happen from the reactor only and must never block it; plain
+    // sockets already use MSG_DONTWAIT, TLS ones need the fd itself
+    // non-blocking so SSL_write reports WANT_WRITE instead of stalling.
+    if (!setNonBlocking(fd, true))
+    {
+        LOG_WARN("StreamClientReactor[" + m_name + "]: could not make fd " + std::to_string(fd) + " non-blocking");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint64_t id = m_nextId++;
+        Client &client = m_clients[id];
+        client.fd = fd;
+        client.cursorSeq = m_nextSeq; // join at the live edge
+        if (preamble && preambleSize > 0)
+        {
+            client.preamble = std::make_shared<const std::vector<uint8_t>>(preamble, preamble + preambleSize);
+        }
+        const bool havePreamble = client.preamble != nullptr;
+
+#if defined(PLATFORM_LINUX)
+        // No EPOLLIN: viewers don't talk after the request, and TLS
+        // records we never read would keep a level-triggered EPOLLIN hot.
+        // EPOLLRDHUP still reports the peer's FIN.
+        epoll_event ev{};
+        ev.events = EPOLLRDHUP | (havePreamble ? EPOLLOUT : 0u);
+        ev.data.u64 = id;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            LOG_ERROR("StreamClientReactor[" + m_name + "]: epoll_ctl(add) failed: " + std::string(strerror(errno)));
+            m_clients.erase(id);
+            m_close(fd);
+            return false;
+        }
+        client.writeArmed = havePreamble;
+#endif
+        m_clientCount = static_cast<uint32_t>(m_clients.size());
+    }
+    return true;
+}
+
+bool StreamClientReactor::addConnection(int fd)
+{
+    if (!m_running || fd < 0 || !m_receive || !m_onRequest)
+    {
+        if (fd >= 0 && m_close)
+        {
+            m_close(fd);
+        }
+        return false;
+    }
+
+    // Reads must not block the reactor either; for TLS this makes SSL_read
+    // report WANT_READ once the record layer has nothing buffered.
+    if (!setNonBlocking(fd, true))
+    {
+        LOG_WARN("StreamClientReactor[" + m_name + "]: could not make fd " + std::to_string(fd) + " non-blocking");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const uint64_t id = m_nextId++;
+        PendingRequest &request = m_requests[id];
+        request.fd = fd;
+        request.deadlineUs = nowUs() + kRequestTimeoutUs;
+
+#if defined(PLATFORM_LINUX)
+        // Level-triggered EPOLLIN: the request may already be waiting in the
+        // socket buffer, in which case the next epoll_wait reports it.
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = id;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            LOG_ERROR("StreamClientReactor[" + m_name + "]: epoll_ctl(add) failed: " + std::string(strerror(errno)));
+            m_requests.erase(id);
+            m_close(fd);
+            return false;
+        }
+#endif
+    }
+    return true;
+}
+
+void StreamClientReactor::broadcast(const uint8_t *data, size_t size)
+{
+    if (!data || size == 0 || !m_running)
+    {
+        return;
+    }
+    const int64_t now = nowUs();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // Always scanned, even with nobody connected, so the TS packet
+        // phase is right when the first viewer arrives.
+        m_keyframeScratch.clear();
+        findKeyframeStarts(data, size, m_keyframeScratch);
+
+        if (m_clients.empty())
+        {
+            return;
+        }
+
+        // One segment per keyframe boundary; the bytes are copied exactly
+        // once, whatever the number of viewers.
+        size_t begin = 0;
+        bool beginIsKeyframe = false;
+        for (size_t start : m_keyframeScratch)
+        {
+            if (start == 0)
+            {
+                beginIsKeyframe = true;
+                continue;
+            }
+            appendSegment(data + begin, start - begin, beginIsKeyframe, now);
+            begin = start;
+            beginIsKeyframe = true;
+        }
+        appendSegment(data + begin, size - begin, beginIsKeyframe, now);
+
+        evictSegments();
+        for (auto &entry : m_clients)
+        {
+            enforceLag(entry.second, now);
+        }
+    }
+    wake();
+}
+
+void StreamClientReactor::appendSegment(const uint8_t *data, size_t size, bool keyframe, int64_t now)
+{
+    if (m_ring.empty())
+    {
+        m_ringFirstSeq = m_nextSeq;
+    }
+    Segment segment;
+    segment.data = std::make_shared<const std::vector<uint8_t>>(data, data + size);
+    segment.streamPos = m_streamBytes;
+    segment.enqueuedUs = now;
+    segment.keyframe = keyframe;
+    if (keyframe)
+    {
+        m_lastKeyframeSeq = m_nextSeq;
+    }
+    m_ring.push_back(std::move(segment));
+    ++m_nextSeq;
+    m_streamBytes += size;
+    m_ringBytes += size;
+}
+
+void StreamClientReactor::evictSegments()
+{
+    // Everything before the slowest client's cursor is garbage, except
+    // that we hold on to the newest keyframe segment onward so a lagging
+    // client always has somewhere to skip to. Past the hard cap we evict
+    // regardless; enforceLag() deals with whoever that strands.
+    uint64_t keepFrom = m_nextSeq;
+    for (const auto &entry : m_clients)
+    {
+        const Client &client = entry.second;
+        if (client.doomed)
+        {
+            continue;
+        }
+        const uint64_t seq = client.head ? client.headSeq + 1 : client.cursorSeq;
+        keepFrom = std::min(keepFrom, seq);
+    }
+    if (m_lastKeyframeSeq != UINT64_MAX)
+    {
+        keepFrom = std::min(keepFrom, m_lastKeyframeSeq);
+    }
+
+    while (!m_ring.empty() &&
+           (m_ringFirstSeq < keepFrom || m_ringBytes > m_limits.ringBytes))
+    {
+        m_ringBytes -= m_ring.front().data->size();
+        m_ring.pop_front();
+        ++m_ringFirstSeq;
+    }
+}
+
+size_t StreamClientReactor::getRingBytes() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ringBytes;
+}
+
+bool StreamClientReactor::hasPending(const Client &client) const
+{
+    return (client.preamble && client.preambleOffset < client.preamble->size()) ||
+           client.head || client.cursorSeq < m_nextSeq;
+}
+
+void StreamClientReactor::enforceLag(Client &client, int64_t now)
+{
+    if (client.doomed)
+    {
+        return;
+    }
+
+    // Oldest byte this client still has to send.
+    const uint64_t seq = client.head ? client.headSeq : client.cursorSeq;
+    const size_t offset = client.head ? client.headOffset : 0;
+    if (seq >= m_nextSeq)
+    {
+        return;
+    }
+
+    bool over = seq < m_ringFirstSeq; // fell off the ring
+    size_t lagBytes = 0;
+    if (!over)
+    {
+        const Segment &segment = m_ring[static_cast<size_t>(seq - m_ringFirstSeq)];
+        lagBytes = static_cast<size_t>(m_streamBytes - (segment.streamPos + offset));
+        over = lagBytes > m_limits.maxLagBytes ||
+               (m_limits.maxLagUs > 0 && (now - segment.enqueuedUs) > m_limits.maxLagUs);
+    }
+    if (!over)
+    {
+        return;
+    }
+
+    if (m_limits.policy == OverflowPolicy::Disconnect)
+    {
+        client.doomed = true;
+        m_overflowDisconnects.fetch_add(1);
+        LOG_WARN("/" + m_name + " client fd=" + std::to_string(client.fd) + " fell " +
+                 std::to_string(lagBytes) + " bytes behind the live edge — closing");
+        return;
+    }
+
+    // Never abandon a segment half-sent: finish it, then skip.
+    if (client.head)
+    {
+        client.pendingSkip = true;
+        return;
+    }
+    skipToKeyframe(client, now);
+}
+
+void StreamClientReactor::skipToKeyframe(Client &client, int64_t now)
+{
+    client.pendingSkip = false;
+
+    // Prefer the newest keyframe already in the ring when it is
+    // comfortably inside the lag budget — the viewer gets a picture
+    // right away. Otherwise jump to the live edge and wait for the next
+    // one.
+    bool useRecent = false;
+    if (m_lastKeyframeSeq != UINT64_MAX && m_lastKeyframeSeq >= m_ringFirstSeq &&
+        m_lastKeyframeSeq < m_nextSeq && m_lastKeyframeSeq > client.cursorSeq)
+    {
+        const Segment &segment = m_ring[static_cast<size_t>(m_lastKeyframeSeq - m_ringFirstSeq)];
+        const uint64_t lagBytes = m_streamBytes - segment.streamPos;
+        useRecent = lagBytes <= m_limits.maxLagBytes / 2 &&
+                    (m_limits.maxLagUs <= 0 || (now - segment.enqueuedUs) <= m_limits.maxLagUs / 2);
+    }
+    if (useRecent)
+    {
+        client.cursorSeq = m_lastKeyframeSeq;
+        client.waitKeyframe = false;
+    }
+    else
+    {
+        client.cursorSeq = m_nextSeq;
+        client.waitKeyframe = true;
+    }
+
+    m_keyframeSkips.fetch_add(1);
+    const uint64_t n = ++client.skips;
+    if (n == 1 || (n % 30) == 0)
+    {
+        LOG_WARN("/" + m_name + " client fd=" + std::to_string(client.fd) +
+                 " fell behind — skipped to keyframe, keeping connection (total skips: " +
+                 std::to_string(n) + ")");
+    }
+}
+
+bool StreamClientReactor::selectNextSegment(Client &client, int64_t now)
+{
+    while (client.cursorSeq < m_nextSeq)
+    {
+        if (client.cursorSeq < m_ringFirstSeq)
+        {
+            // Evicted under us (hard ring cap).
+            if (m_limits.policy == OverflowPolicy::Disconnect)
+            {
+                client.doomed = true;
+                m_overflowDisconnects.fetch_add(1);
+                return false;
+            }
+            skipToKeyframe(client, now);
+            continue;
+        }
+        const Segment &segment = m_ring[static_cast<size_t>(client.cursorSeq - m_ringFirstSeq)];
+        if (client.waitKeyframe && !segment.keyframe)
+        {
+            ++client.cursorSeq;
+            continue;
+        }
+        client.waitKeyframe = false;
+        client.head = segment.data;
+        client.headSeq = client.cursorSeq;
+        client.headOffset = 0;
+        return true;
+    }
+    return false;
+}
+
+void StreamClientReactor::findKeyframeStarts(const uint8_t *data, size_t size, std::vector<size_t> &starts)
+{
+    if (m_tsSkip >= size)
+    {
+        m_tsSkip -= size; // whole buffer is the middle of one TS packet
+        return;
+    }
+
+    size_t pos = m_tsSkip;
+    if (data[pos] != kTsSyncByte)
+    {
+        // Lost the phase (new muxer session, odd flush): find two sync
+        // bytes one packet apart, or the last one in the buffer.
+        pos = size;
+        for (size_t i = 0; i < size; ++i)
+        {
+            if (data[i] == kTsSyncByte && (i + kTsPacketSize >= size || data[i + kTsPacketSize] == kTsSyncByte))
+            {
+                pos = i;
+                break;
+            }
+        }
+        if (pos == size)
+        {
+            m_tsSkip = 0;
+            return;
+        }
+    }
+
+    for (; pos < size; pos += kTsPacketSize)
+    {
+        if (data[pos] != kTsSyncByte)
+        {
+            m_tsSkip = 0; // resync on the next buffer
+            return;
+        }
+        // 4-byte header, then adaptation_field_length and its flags.
+        if (pos + 5 < size)
+        {
+            const uint16_t pid = static_cast<uint16_t>(((data[pos + 1] & 0x1F) << 8) | data[pos + 2]);
+            const bool payloadUnitStart = (data[pos + 1] & 0x40) != 0;
+            const bool hasAdaptation = (data[pos + 3] & 0x20) != 0;
+            const bool randomAccess = hasAdaptation && data[pos + 4] > 0 && (data[pos + 5] & 0x40) != 0;
+            if (payloadUnitStart && (pid == kTsPatPid || static_cast<int32_t>(pid) == m_pmtPid) &&
+                pos + kTsPacketSize <= size)
+            {
+                // PAT/PMT straddling a flush is simply caught on its next
+                // repetition (the muxer resends them every ~100 ms).
+                parseProgramTable(data + pos, pid);
+            }
+            if (payloadUnitStart && randomAccess && static_cast<int32_t>(pid) == m_videoPid)
+            {
+                starts.push_back(pos);
+            }
+        }
+    }
+    m_tsSkip = pos - size;
+}
+
+void StreamClientReactor::parseProgramTable(const uint8_t *packet, uint16_t pid)
+{
+    // Payload after the header and adaptation field, then pointer_field.
+    size_t offset = 4;
+    if (packet[3] & 0x20)
+    {
+        offset += 1 + packet[4];
+    }
+    if (!(packet[3] & 0x10) || offset >= kTsPacketSize)
+    {
+        return;
+    }
+    offset += 1 + packet[offset];
+    if (offset + 3 > kTsPacketSize)
+    {
+        return;
+    }
+    const uint8_t *section = packet + offset;
+    const size_t sectionLength = static_cast<size_t>(((section[1] & 0x0F) << 8) | section[2]);
+    // Sections longer than one packet never come from libavformat for a
+    // single program; ignore them rather than reassemble.
+    const size_t sectionEnd = 3 + sectionLength;
+    if (sectionLength < 9 || offset + sectionEnd > kTsPacketSize)
+    {
+        return;
+    }
+    const size_t entriesEnd = sectionEnd - 4; // CRC_32
+
+    if (pid == kTsPatPid)
+    {
+        if (section[0] != 0x00)
+        {
+            return;
+        }
+        for (size_t i = 8; i + 4 <= entriesEnd; i += 4)
+        {
+            const uint16_t programNumber = static_cast<uint16_t>((section[i] << 8) | section[i + 1]);
+            if (programNumber != 0) // 0 = network PID
+            {
+                m_pmtPid = ((section[i + 2] & 0x1F) << 8) | section[i + 3];
+                return;
+            }
+        }
+        return;
+    }
+
+    if (section[0] != 0x02)
+    {
+        return;
+    }
+    const size_t programInfoLength = static_cast<size_t>(((section[10] & 0x0F) << 8) | section[11]);
+    for (size_t i = 12 + programInfoLength; i + 5 <= entriesEnd;)
+    {
+        const uint8_t streamType = section[i];
+        const int32_t elementaryPid = ((section[i + 1] & 0x1F) << 8) | section[i + 2];
+        const size_t esInfoLength = static_cast<size_t>(((section[i + 3] & 0x0F) << 8) | section[i + 4]);
+        if (isVideoStreamType(streamType))
+        {
+            m_videoPid = elementaryPid;
+            return;
+        }
+        i += 5 + esInfoLength;
+    }
+}
+
+void StreamClientReactor::wake()
+{
+#if defined(PLATFORM_LINUX)
+    // Coalesce: one eventfd write per reactor pass is enough.
+    if (m_wakeFd >= 0 && !m_wakePending.exchange(true))
+    {
+        uint64_t one = 1;
+        ssize_t r = write(m_wakeFd, &one, sizeof(one));
+        (void)r;
+    }
+#endif
+}
+
+void StreamClientReactor::updateWriteInterest(uint64_t id, Client &client, bool wantWrite)
+{
+#if defined(PLATFORM_LINUX)
+    if (client.writeArmed == wantWrite)
+    {
+        return;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLRDHUP | (wantWrite ? EPOLLOUT : 0u);
+    ev.data.u64 = id;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, client.fd, &ev) == 0)
+    {
+        client.writeArmed = wantWrite;
+    }
+#else
+    (void)id;
+    client.writeArmed = wantWrite;
+#endif
+}
+
+bool StreamClientReactor::flushClient(uint64_t id)
+{
+    for (;;)
+    {
+        Bytes data;
+        size_t offset = 0;
+        int fd = -1;
+        bool isPreamble = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_clients.find(id);
+            if (it == m_clients.end() || it->second.doomed)
+            {
+                return true;
+            }
+            Client &client = it->second;
+            if (client.preamble && client.preambleOffset < client.preamble->size())
+            {
+                data = client.preamble;
+                offset = client.preambleOffset;
+                isPreamble = true;
+            }
+            else
+            {
+                client.preamble.reset();
+                if (!client.head && !selectNextSegment(client, nowUs()))
+                {
+                    updateWriteInterest(id, client, false);
+                    return true;
+                }
+                data = client.head;
+                offset = client.headOffset;
+            }
+            fd = client.fd;
+            client.sending = true;
+        }
+
+        const ssize_t sent = m_send(fd, data->data() + offset, data->size() - offset);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_clients.find(id);
+        if (it == m_clients.end())
+        {
+            return true;
+        }
+        Client &client = it->second;
+        client.sending = false;
+        if (sent < 0)
+        {
+            return false;
+        }
+        if (sent == 0)
+        {
+            // Kernel buffer full: let epoll tell us when it drains.
+            updateWriteInterest(id, client, true);
+            return true;
+        }
+        if (isPreamble)
+        {
+            client.preambleOffset += static_cast<size_t>(sent);
+            continue;
+        }
+        client.headOffset += static_cast<size_t>(sent);
+        if (client.headOffset >= data->size())
+        {
+            client.cursorSeq = client.headSeq + 1;
+            client.head.reset();
+            client.headOffset = 0;
+            if (client.pendingSkip)
+            {
+                skipToKeyframe(client, nowUs());
+            }
+        }
+    }
+}
+
+void StreamClientReactor::closeClient(uint64_t id)
+{
+    int fd = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_clients.find(id);
+        if (it == m_clients.end())
+        {
+            return;
+        }
+        fd = it->second.fd;
+#if defined(PLATFORM_LINUX)
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+        m_clients.erase(it);
+        m_clientCount = static_cast<uint32_t>(m_clients.size());
+        if (m_clients.empty())
+        {
+            // Nobody left to read the ring; broadcast() stops filling it.
+            m_ring.clear();
+            m_ringBytes = 0;
+            m_ringFirstSeq = m_nextSeq;
+            m_lastKeyframeSeq = UINT64_MAX;
+        }
+    }
+    // Closed only here, after removal, so a reused fd number can never be
+    // mistaken for this client.
+    m_close(fd);
+}
+
+void StreamClientReactor::closeDoomedClients()
+{
+    std::vector<uint64_t> doomed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &entry : m_clients)
+        {
+            if (entry.second.doomed)
+            {
+                doomed.push_back(entry.first);
+            }
+        }
+    }
+    for (uint64_t id : doomed)
+    {
+        closeClient(id);
+    }
+}
+
+bool StreamClientReactor::isPendingRequest(uint64_t id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_requests.count(id) != 0;
+}
+
+void StreamClientReactor::dropRequest(uint64_t id, int fd, bool closeFd)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_requests.erase(id);
+#if defined(PLATFORM_LINUX)
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+#endif
+    }
+    if (closeFd)
+    {
+        m_close(fd);
+    }
+}
+
+void StreamClientReactor::readRequest(uint64_t id, bool peerClosed)
+{
+    // Taken out of the map while reading so addConnection() can insert
+    // concurrently; put back if the header block is still incomplete.
+    PendingRequest request;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_requests.find(id);
+        if (it == m_requests.end())
+        {
+            return;
+        }
+        request = std::move(it->second);
+        m_requests.erase(it);
+    }
+
+    // TCP (and Cloudflare-style tunnels in particular) may split the
+    // request across segments; keep reading until the socket is drained,
+    // which for TLS also empties what SSL has already decrypted.
+    bool complete = false;
+    bool dead = false;
+    char buffer[4096];
+    while (request.data.size() < kMaxRequestBytes)
+    {
+        const ssize_t n = m_receive(request.fd, buffer, sizeof(buffer));
+        if (n == 0)
+        {
+            break;
+        }
+        if (n < 0)
+        {
+            dead = true;
+            break;
+        }
+        const size_t searchFrom = request.data.size() >= 3 ? request.data.size() - 3 : 0;
+        request.data.append(buffer, static_cast<size_t>(n));
+        if (request.data.find("\r\n\r\n", searchFrom) != std::string::npos)
+        {
+            complete = true;
+            break;
+        }
+    }
+
+    if (complete)
+    {
+        // The handler answers on its own terms (inline or on a worker that
+        // expects an ordinary blocking socket); addClient() flips it back.
+        dropRequest(id, request.fd, false);
+        setNonBlocking(request.fd, false);
+        m_onRequest(request.fd, std::move(request.data));
+        return;
+    }
+    if (dead || peerClosed || request.data.size() >= kMaxRequestBytes)
+    {
+        // Closed mid-request, or headers past 16 KB — malformed or hostile.
+        dropRequest(id, request.fd, true);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requests.emplace(id, std::move(request));
+}
+
+void StreamClientReactor::expireRequests()
+{
+    // A peer that connects and never finishes its request would otherwise
+    // hold an fd forever.
+    std::vector<std::pair<uint64_t, int>> expired;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int64_t now = nowUs();
+        for (const auto &entry : m_requests)
+        {
+            if (now >= entry.second.deadlineUs)
+            {
+                expired.emplace_back(entry.first, entry.second.fd);
+            }
+        }
+    }
+    for (const auto &request : expired)
+    {
+        dropRequest(request.first, request.second, true);
+    }
+}
+
+void StreamClientReactor::reactorThread()
+{
+#if defined(PLATFORM_LINUX)
+    epoll_event events[kMaxEventsPerWait];
+    while (m_running)
+    {
+        const int n = epoll_wait(m_epollFd, events, kMaxEventsPerWait, 100);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LOG_ERROR("StreamClientReactor[" + m_name + "]: epoll_wait failed: " + std::string(strerror(errno)));
+            break;
+        }
+
+        bool woken = false;
+        for (int i = 0; i < n; ++i)
+        {
+            const uint64_t id = events[i].data.u64;
+            const uint32_t ev = events[i].events;
+            if (id == kWakeId)
+            {
+                m_wakePending = false;
+                uint64_t value = 0;
+                ssize_t r = read(m_wakeFd, &value, sizeof(value));
+                (void)r;
+                woken = true;
+                continue;
+            }
+            if (isPendingRequest(id))
+            {
+                // Read before honouring RDHUP: a client may send its
+                // request and half-close right after.
+                readRequest(id, (ev & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) != 0);
+                continue;
+            }
+            if (ev & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))
+            {
+                closeClient(id);
+                continue;
+            }
+            if ((ev & EPOLLOUT) && !flushClient(id))
+            {
+                closeClient(id);
+            }
+        }
+
+        if (woken)
+        {
+            // New data: try every client that isn't already waiting on
+            // EPOLLOUT. Clients that are will get it when the socket drains.
+            std::vector<uint64_t> ready;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (auto &entry : m_clients)
+                {
+                    const Client &client = entry.second;
+                    if (!client.doomed && !client.writeArmed && hasPending(client))
+                    {
+                        ready.push_back(entry.first);
+                    }
+                }
+            }
+            for (uint64_t id : ready)
+            {
+                if (!flushClient(id))
+                {
+                    closeClient(id);
+                }
+            }
+        }
+
+        closeDoomedClients();
+        expireRequests();
+    }
+#else
+    // Portable fallback: same ring and lag limits, socket readiness
+    // discovered by trying. Peer close shows up as a send error or, on
+    // POSIX, as a zero-byte MSG_PEEK.
+    while (m_running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        std::vector<std::pair<uint64_t, int>> clients;
+        std::vector<uint64_t> requests;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto &entry : m_clients)
+            {
+                clients.emplace_back(entry.first, entry.second.fd);
+            }
+            for (auto &entry : m_requests)
+            {
+                requests.push_back(entry.first);
+            }
+        }
+        for (uint64_t id : requests)
+        {
+            readRequest(id, false);
+        }
+        for (const auto &c : clients)
+        {
+            bool alive = flushClient(c.first);
+#if defined(PLATFORM_MACOS)
+            if (alive)
+            {
+                char probe;
+                ssize_t r = recv(c.second, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+                alive = !(r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK));
+            }
+#endif
+            if (!alive)
+            {
+                closeClient(c.first);
+            }
+        }
+        closeDoomedClients();
+        expireRequests();
+    }
+#endif
+}
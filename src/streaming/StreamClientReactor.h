@@ -0,0 +1,237 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+#include <sys/types.h>
+#endif
+
+/**
+ * StreamClientReactor - one I/O thread for every long-lived MPEG-TS viewer.
+ *
+ * Before this, each /stream or /raw viewer kept a detached handler thread
+ * parked in a 1-byte recv() loop, and the muxer's AVIO callback walked every
+ * socket under the output mutex calling send(). One viewer behind a slow
+ * link meant the encoder thread spent its frame budget in that loop, and
+ * a few hundred LAN viewers meant a few hundred threads.
+ *
+ * Freshly accepted sockets come in through addConnection(): the reactor
+ * reads the HTTP request without blocking and passes it to the request
+ * handler, which answers viewers by handing the socket back with
+ * addClient() — the response headers ride in the preamble, so no thread
+ * per connection is needed even for the handshake. broadcast() — called from the muxer callback —
+ * appends the bytes to a single segment ring and wakes the reactor; it
+ * never touches a socket. The reactor thread owns all sends and all closes:
+ *  - Linux: epoll, EPOLLOUT armed only while a client has backlog,
+ *    EPOLLRDHUP/HUP/ERR for disconnects, eventfd for wake-ups.
+ *  - elsewhere: a 10 ms polling loop with the same ring/lag semantics.
+ *
+ * Segment ring: muxed bytes are stored once, as refcounted immutable
+ * segments, and every client just holds a cursor (segment seq + offset)
+ * into it — memory is O(ring), not O(clients x backlog). Incoming data is
+ * split at TS packets that carry the random-access indicator, so each
+ * video keyframe starts its own segment and a lagging client can be moved
+ * to one without ever cutting a TS packet. The segment a client is in the
+ * middle of sending is pinned (shared_ptr) so ring eviction can't pull it
+ * away mid-send — TLS retries always see the same buffer.
+ */
+class StreamClientReactor
+{
+public:
+    enum class OverflowPolicy
+    {
+        // Close the connection. For /stream: mpegts.js in the portal loses
+        // its SourceBuffer on a mid-stream gap, a clean reconnect is the
+        // only recovery.
+        Disconnect,
+        // Move the client forward to a keyframe and keep the connection.
+        // For /raw: the FFmpeg demuxer on the other end just resyncs (#93).
+        SkipToKeyframe,
+    };
+
+    struct Limits
+    {
+        // How far behind the live edge a client may fall — in bytes and in
+        // age of the oldest unsent segment — before the policy applies.
+        size_t maxLagBytes = 4 * 1024 * 1024; // 4 MB
+        int64_t maxLagUs = 10 * 1000000LL;    // 10 s
+        // Ring capacity. Kept above maxLagBytes so the lag check, not
+        // eviction, is what normally catches a slow client.
+        size_t ringBytes = 8 * 1024 * 1024; // 8 MB
+        OverflowPolicy policy = OverflowPolicy::Disconnect;
+    };
+
+    // Transport hooks so TLS clients go through HTTPServer like every other
+    // write. send/receive return bytes transferred, 0 for "would block", <0
+    // for a dead peer; close must release everything tied to the fd.
+    using SendFunction = std::function<ssize_t(int fd, const void *data, size_t size)>;
+    using ReceiveFunction = std::function<ssize_t(int fd, void *buffer, size_t size)>;
+    using CloseFunction = std::function<void(int fd)>;
+    // Called on the reactor thread with a complete request header block.
+    // The fd is out of the poll set and back in blocking mode; the handler
+    // owns it from here and must not block on the network.
+    using RequestHandler = std::function<void(int fd, std::string request)>;
+
+    explicit StreamClientReactor(const std::string &name);
+    ~StreamClientReactor();
+
+    StreamClientReactor(const StreamClientReactor &) = delete;
+    StreamClientReactor &operator=(const StreamClientReactor &) = delete;
+
+    void setTransport(SendFunction sendFn, CloseFunction closeFn, ReceiveFunction receiveFn = nullptr);
+    // Needed only by the reactor that accepts connections.
+    void setRequestHandler(RequestHandler handler);
+    void setLimits(const Limits &limits);
+
+    bool start();
+    // Joins the I/O thread, closes every client still connected and
+    // empties the ring.
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    /**
+     * Take ownership of an already-handshaken socket. `preamble` (the cached
+     * format header) is sent first, then the client joins the live edge of
+     * the ring. On failure the fd is closed through the transport and false
+     * is returned.
+     */
+    bool addClient(int fd, const uint8_t *preamble, size_t preambleSize);
+
+    /**
+     * Take a socket straight from accept(). Its HTTP request is read here,
+     * capped at kMaxRequestBytes and kRequestTimeoutUs; a peer that closes,
+     * overflows or times out first is closed through the transport.
+     */
+    bool addConnection(int fd);
+
+    // Append muxed TS bytes to the ring. Never blocks on the network.
+    void broadcast(const uint8_t *data, size_t size);
+
+    uint32_t getClientCount() const { return m_clientCount.load(); }
+
+    // Statistics
+    uint64_t getKeyframeSkipCount() const { return m_keyframeSkips.load(); }
+    uint64_t getOverflowDisconnectCount() const { return m_overflowDisconnects.load(); }
+    size_t getRingBytes() const;
+
+private:
+    using Bytes = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Segment
+    {
+        Bytes data;
+        uint64_t streamPos = 0; // offset of data[0] in the whole byte stream
+        int64_t enqueuedUs = 0;
+        bool keyframe = false; // starts with a video random-access TS packet
+    };
+
+    // Accepted socket whose request header block is still arriving.
+    struct PendingRequest
+    {
+        int fd = -1;
+        std::string data;
+        int64_t deadlineUs = 0;
+    };
+
+    static constexpr size_t kMaxRequestBytes = 16 * 1024;
+    static constexpr int64_t kRequestTimeoutUs = 5 * 1000000LL;
+
+    struct Client
+    {
+        int fd = -1;
+        Bytes preamble;
+        size_t preambleOffset = 0;
+        // Next segment to send. While `head` is set it is the segment being
+        // sent (seq headSeq); cursorSeq is re-derived once it completes.
+        uint64_t cursorSeq = 0;
+        Bytes head;
+        uint64_t headSeq = 0;
+        size_t headOffset = 0;
+        bool waitKeyframe = false; // skip segments until a keyframe one
+        bool pendingSkip = false;  // lag limit hit while head was pinned
+        bool writeArmed = false;   // EPOLLOUT currently requested
+        bool sending = false;      // reactor is inside send() on head/preamble
+        bool doomed = false;       // close on the next reactor pass
+        uint64_t skips = 0;
+    };
+
+    void reactorThread();
+    void wake();
+    // Send as much as the socket takes. Returns false when the peer is
+    // gone. Called on the reactor thread only.
+    bool flushClient(uint64_t id);
+    void closeClient(uint64_t id);
+    void closeDoomedClients();
+    // Read what the socket has; dispatch the request once complete, close
+    // it on EOF/error/overflow. Reactor thread only.
+    void readRequest(uint64_t id, bool peerClosed);
+    bool isPendingRequest(uint64_t id) const;
+    void expireRequests();
+    // Forget a pending request (poll set included); close it unless the
+    // request handler is taking it over.
+    void dropRequest(uint64_t id, int fd, bool closeFd);
+
+    // All of the below are called with m_mutex held.
+    void updateWriteInterest(uint64_t id, Client &client, bool wantWrite);
+    bool hasPending(const Client &client) const;
+    // Point client.head at the next segment it should send (honouring
+    // waitKeyframe and ring eviction). False when it is caught up.
+    bool selectNextSegment(Client &client, int64_t nowUs);
+    void enforceLag(Client &client, int64_t nowUs);
+    void skipToKeyframe(Client &client, int64_t nowUs);
+    void appendSegment(const uint8_t *data, size_t size, bool keyframe, int64_t nowUs);
+    void evictSegments();
+
+    // Offsets of TS packets in `data` that open a video keyframe (PUSI +
+    // random_access_indicator on the video PID — the mpegts muxer sets RAI
+    // on every audio PES too). Tracks TS packet phase across calls, since
+    // an AVIO flush can end mid-packet.
+    void findKeyframeStarts(const uint8_t *data, size_t size, std::vector<size_t> &starts);
+    // PAT -> PMT PID, PMT -> video PID. `packet` is a whole TS packet.
+    void parseProgramTable(const uint8_t *packet, uint16_t pid);
+
+    static int64_t nowUs();
+
+    std::string m_name;
+    SendFunction m_send;
+    ReceiveFunction m_receive;
+    CloseFunction m_close;
+    RequestHandler m_onRequest;
+    Limits m_limits;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<uint64_t, Client> m_clients; // keyed by id, not fd: fds get reused
+    std::unordered_map<uint64_t, PendingRequest> m_requests; // same id space as m_clients
+    uint64_t m_nextId = 1;
+    std::atomic<uint32_t> m_clientCount{0};
+
+    std::deque<Segment> m_ring;
+    uint64_t m_ringFirstSeq = 0; // seq of m_ring.front()
+    uint64_t m_nextSeq = 0;      // seq the next appended segment gets
+    uint64_t m_streamBytes = 0;  // total bytes ever appended
+    size_t m_ringBytes = 0;
+    uint64_t m_lastKeyframeSeq = UINT64_MAX;
+
+    size_t m_tsSkip = 0; // bytes at the start of the next buffer that finish a TS packet
+    int32_t m_pmtPid = -1;   // from the PAT; -1 until seen
+    int32_t m_videoPid = -1; // from the PMT; no keyframe starts until seen
+    std::vector<size_t> m_keyframeScratch;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_wakePending{false};
+    int m_epollFd = -1;
+    int m_wakeFd = -1;
+
+    std::atomic<uint64_t> m_keyframeSkips{0};
+    std::atomic<uint64_t> m_overflowDisconnects{0};
+};
@@ -99,7 +99,7 @@ bool StreamManager::isActive() const
     return m_active;
 }
 
-void StreamManager::pushFrame(const uint8_t *data, uint32_t width, uint32_t height)
+void StreamManager::pushFrame(const uint8_t *data, uint32_t width, uint32_t height, VideoFrameFormat format)
 {
     if (!m_active || !data)
     {
@@ -110,7 +110,7 @@ void StreamManager::pushFrame(const uint8_t *data, uint32_t width, uint32_t heig
     {
         if (streamer->isActive())
         {
-            streamer->pushFrame(data, width, height);
+            streamer->pushFrame(data, width, height, format);
         }
     }
 }
@@ -131,7 +131,7 @@ void StreamManager::pushAudio(const int16_t *samples, size_t sampleCount)
     }
 }
 
-void StreamManager::pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height)
+void StreamManager::pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height, VideoFrameFormat format)
 {
     if (!m_active || !data)
     {
@@ -147,7 +147,7 @@ void StreamManager::pushRawFrame(const uint8_t *data, uint32_t width, uint32_t h
         if (!streamer->isActive()) continue;
         if (auto *ts = dynamic_cast<HTTPTSStreamer *>(streamer.get()))
         {
-            ts->pushRawFrame(data, width, height);
+            ts->pushRawFrame(data, width, height, format);
         }
     }
 }
@@ -185,6 +185,32 @@ bool StreamManager::hasClients() const
     return false;
 }
 
+EncodedPacketBus *StreamManager::getEncodedPacketBus()
+{
+    for (auto &streamer : m_streamers)
+    {
+        if (!streamer->isActive()) continue;
+        if (auto *ts = dynamic_cast<HTTPTSStreamer *>(streamer.get()))
+        {
+            return ts->getEncodedPacketBus();
+        }
+    }
+    return nullptr;
+}
+
+bool StreamManager::hasEncodeSubscribers() const
+{
+    for (const auto &streamer : m_streamers)
+    {
+        if (!streamer->isActive()) continue;
+        if (auto *ts = dynamic_cast<const HTTPTSStreamer *>(streamer.get()))
+        {
+            if (ts->hasEncodeSubscribers()) return true;
+        }
+    }
+    return false;
+}
+
 std::vector<std::string> StreamManager::getStreamUrls() const
 {
     std::vector<std::string> urls;
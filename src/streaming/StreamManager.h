@@ -6,6 +6,8 @@
 #include <vector>
 #include <cstdint>
 
+class EncodedPacketBus;
+
 /**
  * Manages video streaming to remote clients.
  *
@@ -45,11 +47,13 @@ public:
 
     /**
      * Push a frame to all active streamers
-     * @param data RGB frame data (width * height * 3 bytes)
+     * @param data Frame data (RGB24: width * height * 3 bytes; see VideoFrameFormat)
      * @param width Frame width
      * @param height Frame height
+     * @param format Pixel layout of data
      */
-    void pushFrame(const uint8_t *data, uint32_t width, uint32_t height);
+    void pushFrame(const uint8_t *data, uint32_t width, uint32_t height,
+                   VideoFrameFormat format = VideoFrameFormat::RGB24);
     void pushAudio(const int16_t *samples, size_t sampleCount);
 
     /**
@@ -58,7 +62,8 @@ public:
      * shader-preserving distributed playback work (#47). Frames pushed here
      * MUST be pre-shader; /raw's contract is shader-free by definition.
      */
-    void pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height);
+    void pushRawFrame(const uint8_t *data, uint32_t width, uint32_t height,
+                      VideoFrameFormat format = VideoFrameFormat::RGB24);
 
     /**
      * True if at least one MPEG-TS streamer has a connected /raw client.
@@ -75,6 +80,21 @@ public:
      */
     bool hasClients() const;
 
+    /**
+     * Bus carrying the /stream encoder's packets (shared encode), or
+     * nullptr when no active streamer offers one. A recording whose
+     * settings match subscribes here instead of encoding again.
+     */
+    EncodedPacketBus *getEncodedPacketBus();
+
+    /**
+     * True while some sink (e.g. a recording) consumes the /stream encode
+     * through the bus. Application feeds /stream frames when this OR
+     * hasClients() is true — the shared encoder must run for the
+     * recording even if nobody is watching the stream.
+     */
+    bool hasEncodeSubscribers() const;
+
     /**
      * Get all stream URLs
      */
@@ -7,6 +7,7 @@
 #include <sys/socket.h>
 #include <unistd.h>
 #endif
+#include <cctype>
 #include <cstring>
 #include <cstdlib>
 #include <sstream>
@@ -14,6 +15,111 @@
 #include <chrono>
 #include <thread>
 
+namespace
+{
+    std::string toLower(std::string s)
+    {
+        for (char &c : s)
+        {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return s;
+    }
+
+    std::string trim(const std::string &s)
+    {
+        const size_t begin = s.find_first_not_of(" \t\r");
+        if (begin == std::string::npos)
+        {
+            return "";
+        }
+        const size_t end = s.find_last_not_of(" \t\r");
+        return s.substr(begin, end - begin + 1);
+    }
+
+    // Case-insensitive lookup of a request header, split into its
+    // comma-separated list elements (trimmed, empty ones skipped).
+    std::vector<std::string> headerTokens(const std::string &request, const std::string &name)
+    {
+        std::vector<std::string> tokens;
+        const std::string key = "\n" + toLower(name) + ":";
+        size_t pos = toLower(request).find(key);
+        if (pos == std::string::npos)
+        {
+            return tokens;
+        }
+        pos += key.size();
+        const size_t end = request.find('\n', pos);
+        const std::string value = request.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+
+        size_t start = 0;
+        while (start <= value.size())
+        {
+            size_t comma = value.find(',', start);
+            if (comma == std::string::npos)
+            {
+                comma = value.size();
+            }
+            std::string token = trim(value.substr(start, comma - start));
+            if (!token.empty())
+            {
+                tokens.push_back(std::move(token));
+            }
+            start = comma + 1;
+        }
+        return tokens;
+    }
+
+    // Accept-Encoding: the coding (or "*") must be listed without q=0.
+    // An explicit entry wins over "*", so "gzip;q=0, *" still refuses gzip.
+    bool acceptsEncoding(const std::string &request, const std::string &coding)
+    {
+        int wildcard = -1; // -1 absent, 0 refused, 1 accepted
+        for (const std::string &token : headerTokens(request, "Accept-Encoding"))
+        {
+            const size_t semi = token.find(';');
+            const std::string name = toLower(trim(token.substr(0, semi)));
+            bool acceptable = true;
+            if (semi != std::string::npos)
+            {
+                const std::string params = toLower(token.substr(semi + 1));
+                const size_t q = params.find("q=");
+                if (q != std::string::npos)
+                {
+                    acceptable = std::strtod(params.c_str() + q + 2, nullptr) > 0.0;
+                }
+            }
+            if (name == coding)
+            {
+                return acceptable;
+            }
+            if (name == "*")
+            {
+                wildcard = acceptable ? 1 : 0;
+            }
+        }
+        return wildcard == 1;
+    }
+
+    // If-None-Match uses the weak comparison: whole entity-tags, W/ ignored.
+    bool etagMatches(const std::string &request, const std::string &etag)
+    {
+        for (const std::string &token : headerTokens(request, "If-None-Match"))
+        {
+            if (token == "*")
+            {
+                return true;
+            }
+            const std::string tag = token.compare(0, 2, "W/") == 0 ? token.substr(2) : token;
+            if (tag == etag)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
 WebPortal::WebPortal()
 {
     // Verificar se o diretório web existe
@@ -352,28 +458,12 @@ bool WebPortal::handleRequest(int clientFd, const std::string &request) const
 
     // PRIMEIRO: Verificar se é arquivo estático (antes de verificar páginas HTML)
     // Isso é importante porque arquivos estáticos têm prioridade sobre páginas
-    LOG_INFO("WebPortal::handleRequest - Extracting file path from request");
     std::string filePath = extractFilePath(request);
-    LOG_INFO("WebPortal::handleRequest - Extracted file path: '" + filePath + "'");
     if (!filePath.empty())
     {
-        LOG_INFO("WebPortal::handleRequest - Serving static file: " + filePath + " (basePrefix: " + basePrefix + ")");
-        bool result = serveStaticFile(clientFd, filePath);
-        if (result)
-        {
-            LOG_INFO("WebPortal::handleRequest - Successfully served static file: " + filePath);
-            return true;
-        }
-        else
-        {
-            LOG_WARN("WebPortal::handleRequest - Failed to serve static file: " + filePath + " (404 already sent)");
-            // serveStaticFile já enviou 404, retornar true para indicar que a requisição foi processada
-            return true;
-        }
-    }
-    else
-    {
-        LOG_INFO("WebPortal::handleRequest - No file path extracted from request");
+        // serveStaticFile já enviou 404 se falhou; a requisição foi processada.
+        serveStaticFile(clientFd, filePath, request);
+        return true;
     }
 
     // Verificar se é página específica (recordings.html) - APENAS se não for arquivo estático
@@ -669,85 +759,66 @@ bool WebPortal::serveWebPage(int clientFd, const std::string &request,
     }
 }
 
-bool WebPortal::serveStaticFile(int clientFd, const std::string &filePath) const
+bool WebPortal::serveStaticFile(int clientFd, const std::string &filePath, const std::string &request) const
 {
-    LOG_INFO("WebPortal::serveStaticFile - Called with filePath: '" + filePath + "'");
-    std::string webDir = getWebDirectory();
-    LOG_INFO("WebPortal::serveStaticFile - Web directory: '" + webDir + "'");
-    std::string fullPath = webDir + "/" + filePath;
-    LOG_INFO("WebPortal::serveStaticFile - Full path: '" + fullPath + "'");
-
-    // Verificar se o arquivo existe
-    if (!fs::exists(fullPath))
-    {
-        LOG_ERROR("WebPortal::serveStaticFile - File does not exist: " + fullPath);
-        LOG_ERROR("WebPortal::serveStaticFile - Web directory exists: " + std::string(fs::exists(webDir) ? "yes" : "no"));
-        if (fs::exists(webDir))
-        {
-            LOG_INFO("WebPortal::serveStaticFile - Listing web directory contents:");
-            try
-            {
-                // Use manual loop for compatibility with custom filesystem implementation
-                fs::directory_iterator it(webDir);
-                fs::directory_iterator end;
-                for (; it != end; ++it)
-                {
-#if defined(_WIN32) && defined(__GNUC__) && __GNUC__ < 8
-                    // Custom implementation: path() is a method
-                    std::string filename = it.path().filename();
-#else
-                    // std::filesystem: need to dereference iterator
-                    std::string filename = it->path().filename().string();
-#endif
-                    LOG_INFO("WebPortal::serveStaticFile -   " + filename);
-                }
-            }
-            catch (const std::exception &e)
-            {
-                LOG_ERROR("WebPortal::serveStaticFile - Error listing directory: " + std::string(e.what()));
-            }
-        }
+    const std::string fullPath = getWebDirectory() + "/" + filePath;
+    const std::string contentType = getContentType(filePath);
+    const bool compressible = contentType.compare(0, 5, "text/") == 0 ||
+                              contentType == "application/javascript" ||
+                              contentType == "application/json" ||
+                              contentType == "image/svg+xml";
+
+    // Served from memory: the first request reads (and gzips) the file,
+    // later ones only revalidate its mtime every few seconds.
+    std::shared_ptr<const StaticFileCache::Entry> entry = m_staticCache.get(fullPath, compressible);
+    if (!entry)
+    {
+        LOG_WARN("WebPortal::serveStaticFile - Not found: " + fullPath);
         send404(clientFd);
         return false;
     }
 
-    LOG_INFO("WebPortal::serveStaticFile - File exists, reading content");
-    std::string content = readFileContent(fullPath);
-    if (content.empty())
+    const bool useGzip = !entry->gzip.empty() &&
+                         acceptsEncoding(request, "gzip");
+    const std::string etag = useGzip ? entry->etag.substr(0, entry->etag.size() - 1) + "-gz\"" : entry->etag;
+
+    std::ostringstream response;
+    if (etagMatches(request, etag))
     {
-        LOG_ERROR("WebPortal::serveStaticFile - Failed to read static file: " + fullPath);
-        LOG_ERROR("WebPortal::serveStaticFile - Web directory: " + webDir);
-        LOG_ERROR("WebPortal::serveStaticFile - Requested file path: " + filePath);
-        send404(clientFd);
-        return false;
+        response << "HTTP/1.1 304 Not Modified\r\n";
+        response << "ETag: " << etag << "\r\n";
+        response << "Cache-Control: public, max-age=3600\r\n";
+        response << "Vary: Accept-Encoding\r\n";
+        response << "Connection: close\r\n";
+        response << "\r\n";
+        std::string responseStr = response.str();
+        return sendAll(clientFd, responseStr.c_str(), responseStr.length()) >= 0;
     }
-    
-    LOG_INFO("WebPortal::serveStaticFile - Successfully read file, size: " + std::to_string(content.length()));
-
-    std::string contentType = getContentType(filePath);
-    LOG_INFO("WebPortal::serveStaticFile - Content-Type: " + contentType + " for file: " + filePath);
 
-    std::ostringstream response;
+    const std::string &body = useGzip ? entry->gzip : entry->content;
     response << "HTTP/1.1 200 OK\r\n";
     response << "Content-Type: " << contentType << "; charset=utf-8\r\n";
-    response << "Content-Length: " << content.length() << "\r\n";
+    response << "Content-Length: " << body.length() << "\r\n";
+    if (useGzip)
+    {
+        response << "Content-Encoding: gzip\r\n";
+    }
+    response << "ETag: " << etag << "\r\n";
+    response << "Vary: Accept-Encoding\r\n";
     response << "Connection: close\r\n";
     response << "Cache-Control: public, max-age=3600\r\n";
     response << "\r\n";
-    response << content;
 
-    std::string responseStr = response.str();
-    ssize_t sent = sendAll(clientFd, responseStr.c_str(), responseStr.length());
-    if (sent < 0)
+    // Header and body go out separately so the cached body is never
+    // copied into a per-request response string.
+    std::string headerStr = response.str();
+    if (sendAll(clientFd, headerStr.c_str(), headerStr.length()) < 0 ||
+        sendAll(clientFd, body.data(), body.length()) < 0)
     {
         LOG_ERROR("Failed to send static file to client: " + filePath);
         return false;
     }
-    else
-    {
-        LOG_INFO("Static file sent successfully (" + std::to_string(sent) + " bytes): " + filePath);
-        return true;
-    }
+    return true;
 }
 
 void WebPortal::send404(int clientFd) const
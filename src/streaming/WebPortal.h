@@ -5,6 +5,7 @@
 #include <sstream>
 #include <vector>
 #include "../utils/FilesystemCompat.h"
+#include "StaticFileCache.h"
 
 /**
  * WebPortal - Responsável por servir o portal web do RetroCapture
@@ -101,12 +102,15 @@ public:
                       const std::string &basePrefix = "") const;
 
     /**
-     * Serve um arquivo estático (CSS, JS, etc.)
+     * Serve um arquivo estático (CSS, JS, etc.) a partir do cache em
+     * memória (StaticFileCache): gzip quando o cliente aceita, ETag com
+     * 304 Not Modified para If-None-Match.
      * @param clientFd File descriptor do socket do cliente
      * @param filePath Caminho do arquivo relativo ao diretório web
+     * @param request Requisição HTTP (Accept-Encoding / If-None-Match)
      * @return true se servido com sucesso, false caso contrário
      */
-    bool serveStaticFile(int clientFd, const std::string &filePath) const;
+    bool serveStaticFile(int clientFd, const std::string &filePath, const std::string &request = "") const;
 
     /**
      * Envia resposta 404 Not Found
@@ -223,6 +227,7 @@ private:
     void stripConfigNavLink(std::string &html) const;
 
     HTTPServer *m_httpServer = nullptr;
+    mutable StaticFileCache m_staticCache; // web/ assets servidos sem ler o disco
     std::string m_title = "RetroCapture Stream";                 // Título da página web
     std::string m_subtitle = "Streaming de vídeo em tempo real"; // Subtítulo
     std::string m_imagePath = "logo.png";                        // Caminho da imagem para o título (padrão: logo.png)
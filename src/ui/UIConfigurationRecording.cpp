@@ -52,12 +52,27 @@ void UIConfigurationRecording::render()
                               "Useful to archive a clean master while keeping the CRT\n"
                               "look on screen / on stream.");
         }
+        bool share = m_uiManager->getRecordingShareStreamEncoder();
+        if (ImGui::Checkbox("Reuse stream encoder", &share))
+        {
+            m_uiManager->setRecordingShareStreamEncoder(share);
+            m_uiManager->saveConfig();
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("While streaming with the same codec, size, bitrate and\n"
+                              "preset, write the stream's encoded video to the file\n"
+                              "instead of encoding twice. Saves CPU/GPU, but the file\n"
+                              "gets the stream's low-latency rate control.\n"
+                              "Applies to the next recording.");
+        }
     }
     renderBasicSettings();
     renderCodecSettings();
     renderBitrateSettings();
     renderContainerSettings();
     renderOutputSettings();
+    renderReplayBuffer();
     ImGui::Spacing();
     ImGui::Separator();
     ImGui::Spacing();
@@ -730,6 +745,107 @@ void UIConfigurationRecording::renderOutputSettings()
                           "Example: recording_%%Y%%m%%d_%%H%%M%%S\n"
                           "Will generate: recording_20241215_143022");
     }
+
+    // Segmented recording: limits are per file, the cut waits for the
+    // next keyframe so each part starts cleanly.
+    bool segmentRecording = m_uiManager->getRecordingSegmentRecording();
+    int segmentMinutes = static_cast<int>(m_uiManager->getRecordingMaxDurationUs() / (60ULL * 1000000ULL));
+    int segmentMegabytes = static_cast<int>(m_uiManager->getRecordingMaxFileSize() / (1024ULL * 1024ULL));
+    bool segmentChanged = false;
+    if (ImGui::Checkbox("Split Into Segments", &segmentRecording))
+    {
+        segmentChanged = true;
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Start a new file (<name>_part001, _part002, ...)\n"
+                          "at the first keyframe after a limit is reached.\n"
+                          "No frames are lost at the cut. MP4 parts are\n"
+                          "written fragmented, so a crash only loses the\n"
+                          "last few seconds, not the whole file.");
+    }
+    if (segmentRecording)
+    {
+        if (ImGui::InputInt("Segment Length (min)", &segmentMinutes, 1, 10))
+        {
+            segmentMinutes = std::max(0, segmentMinutes);
+            segmentChanged = true;
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("0 = no time limit.");
+        }
+        if (ImGui::InputInt("Segment Size (MB)", &segmentMegabytes, 100, 1000))
+        {
+            segmentMegabytes = std::max(0, segmentMegabytes);
+            segmentChanged = true;
+        }
+        if (ImGui::IsItemHovered())
+        {
+            ImGui::SetTooltip("0 = no size limit. With both limits at 0\n"
+                              "the recording stays a single file.");
+        }
+    }
+    if (segmentChanged)
+    {
+        m_uiManager->triggerRecordingSegmentChange(segmentRecording,
+                                                   static_cast<uint64_t>(segmentMinutes) * 60ULL * 1000000ULL,
+                                                   static_cast<uint64_t>(segmentMegabytes) * 1024ULL * 1024ULL);
+    }
+}
+
+void UIConfigurationRecording::renderReplayBuffer()
+{
+    ui_section_header("Instant Replay",
+                      "Keep the last moments in memory and save them "
+                      "on demand (F9) — no need to record everything.");
+
+    // Window/cap apply the next time the buffer starts.
+    int seconds = static_cast<int>(m_uiManager->getRecordingReplayBufferSeconds());
+    int megabytes = static_cast<int>(m_uiManager->getRecordingReplayBufferMaxMB());
+    bool limitsChanged = false;
+    if (ImGui::InputInt("Replay Length (s)", &seconds, 5, 30))
+    {
+        seconds = std::max(5, std::min(seconds, 3600));
+        limitsChanged = true;
+    }
+    if (ImGui::InputInt("Replay Memory (MB)", &megabytes, 64, 256))
+    {
+        megabytes = std::max(16, std::min(megabytes, 8192));
+        limitsChanged = true;
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Upper bound on RAM held by the buffer. At high\n"
+                          "bitrates this, not the length, decides how far\n"
+                          "back a replay goes. Changes apply on next start.");
+    }
+    if (limitsChanged)
+    {
+        m_uiManager->triggerRecordingReplayLimitsChange(static_cast<uint32_t>(seconds),
+                                                        static_cast<uint32_t>(megabytes));
+    }
+
+    bool active = m_uiManager->getReplayBufferActive();
+    if (ImGui::Checkbox("Replay Buffer", &active))
+    {
+        m_uiManager->triggerReplayBufferStartStop(active);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("Runs the recording encoder in the background.\n"
+                          "Starting a recording meanwhile reuses it, so the\n"
+                          "recording uses the codec settings the buffer\n"
+                          "was started with.");
+    }
+    if (active)
+    {
+        ImGui::SameLine();
+        if (ImGui::Button("Save Replay (F9)"))
+        {
+            m_uiManager->triggerReplaySave(0);
+        }
+    }
 }
 
 void UIConfigurationRecording::renderStartStopButton()
@@ -31,6 +31,7 @@ private:
     void renderBitrateSettings();
     void renderContainerSettings();
     void renderOutputSettings();
+    void renderReplayBuffer();
     void renderStartStopButton();
 
     // Codec-specific settings
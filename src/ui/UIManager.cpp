@@ -2458,6 +2458,13 @@ void UIManager::triggerRemoteInterpolationChange(const std::string &v)
     saveConfig();
 }
 
+void UIManager::triggerRemoteHwDecodeChange(const std::string &v)
+{
+    m_remoteState.hwDecode = v;
+    if (m_onRemoteHwDecodeChanged) m_onRemoteHwDecodeChanged(v);
+    saveConfig();
+}
+
 void UIManager::triggerScreenRegionChange(uint32_t x, uint32_t y, uint32_t w, uint32_t h)
 {
     m_screenRegionX = x; m_screenRegionY = y; m_screenRegionW = w; m_screenRegionH = h;
@@ -2724,6 +2731,8 @@ void UIManager::loadConfig()
                 m_streamingConfig.amfQuality = streaming["amfQuality"].get<std::string>();
             if (streaming.contains("remoteInterpolation"))
                 m_remoteState.interpolation = streaming["remoteInterpolation"].get<std::string>();
+            if (streaming.contains("remoteHwDecode"))
+                m_remoteState.hwDecode = streaming["remoteHwDecode"].get<std::string>();
 
             // Carregar configurações de buffer
             if (streaming.contains("buffer"))
@@ -3200,6 +3209,18 @@ void UIManager::loadConfig()
                 m_recordingConfig.filenameTemplate = recording["filenameTemplate"].get<std::string>();
             if (recording.contains("includeAudio"))
                 m_recordingConfig.includeAudio = recording["includeAudio"];
+            if (recording.contains("segmentRecording"))
+                m_recordingConfig.segmentRecording = recording["segmentRecording"].get<bool>();
+            if (recording.contains("maxDurationUs"))
+                m_recordingConfig.maxDurationUs = recording["maxDurationUs"].get<uint64_t>();
+            if (recording.contains("maxFileSize"))
+                m_recordingConfig.maxFileSize = recording["maxFileSize"].get<uint64_t>();
+            if (recording.contains("replayBufferSeconds"))
+                m_recordingConfig.replayBufferSeconds = recording["replayBufferSeconds"].get<uint32_t>();
+            if (recording.contains("replayBufferMaxMB"))
+                m_recordingConfig.replayBufferMaxMB = recording["replayBufferMaxMB"].get<uint32_t>();
+            if (recording.contains("shareStreamEncoder"))
+                m_recordingConfig.shareStreamEncoder = recording["shareStreamEncoder"].get<bool>();
             if (recording.contains("applyShader"))
                 m_recordingApplyShader = recording["applyShader"].get<bool>();
             if (recording.contains("hardwareEncoder"))
@@ -3259,6 +3280,7 @@ void UIManager::saveConfig()
             {"qsvPreset",   m_streamingConfig.qsvPreset},
             {"amfQuality",  m_streamingConfig.amfQuality},
             {"remoteInterpolation", m_remoteState.interpolation},
+            {"remoteHwDecode", m_remoteState.hwDecode},
             {"applyShader", m_streamingApplyShader},
             {"buffer", {{"maxVideoBufferSize", m_streamingConfig.maxVideoBufferSize}, {"maxAudioBufferSize", m_streamingConfig.maxAudioBufferSize}, {"maxBufferTimeSeconds", m_streamingConfig.maxBufferTimeSeconds}, {"avioBufferSize", m_streamingConfig.avioBufferSize}}},
             // #49 Phase 2: public directory publish settings.
@@ -3406,6 +3428,12 @@ void UIManager::saveConfig()
             {"outputPath", m_recordingConfig.outputPath},
             {"filenameTemplate", m_recordingConfig.filenameTemplate},
             {"includeAudio", m_recordingConfig.includeAudio},
+            {"segmentRecording", m_recordingConfig.segmentRecording},
+            {"maxDurationUs", m_recordingConfig.maxDurationUs},
+            {"maxFileSize", m_recordingConfig.maxFileSize},
+            {"replayBufferSeconds", m_recordingConfig.replayBufferSeconds},
+            {"replayBufferMaxMB", m_recordingConfig.replayBufferMaxMB},
+            {"shareStreamEncoder", m_recordingConfig.shareStreamEncoder},
             {"applyShader", m_recordingApplyShader},
             {"hardwareEncoder", m_recordingConfig.hardwareEncoder},
             {"nvencPreset", m_recordingConfig.nvencPreset},
@@ -3977,6 +4005,18 @@ void UIManager::triggerRecordingIncludeAudioChange(bool include)
     saveConfig();
 }
 
+void UIManager::triggerRecordingSegmentChange(bool enabled, uint64_t maxDurationUs, uint64_t maxFileSize)
+{
+    m_recordingConfig.segmentRecording = enabled;
+    m_recordingConfig.maxDurationUs = maxDurationUs;
+    m_recordingConfig.maxFileSize = maxFileSize;
+    if (m_onRecordingSegmentChanged)
+    {
+        m_onRecordingSegmentChanged(enabled, maxDurationUs, maxFileSize);
+    }
+    saveConfig();
+}
+
 void UIManager::triggerRecordingHardwareEncoderChange(int v)
 {
     m_recordingConfig.hardwareEncoder = v;
@@ -4020,6 +4060,34 @@ void UIManager::triggerRecordingStartStop(bool start)
     }
 }
 
+void UIManager::triggerReplayBufferStartStop(bool start)
+{
+    if (m_onReplayBufferStartStop)
+    {
+        m_onReplayBufferStartStop(start);
+    }
+}
+
+bool UIManager::triggerReplaySave(uint32_t seconds, std::string *outputPath)
+{
+    if (m_onReplaySave)
+    {
+        return m_onReplaySave(seconds, outputPath);
+    }
+    return false;
+}
+
+void UIManager::triggerRecordingReplayLimitsChange(uint32_t seconds, uint32_t maxMB)
+{
+    m_recordingConfig.replayBufferSeconds = seconds;
+    m_recordingConfig.replayBufferMaxMB = maxMB;
+    if (m_onRecordingReplayLimitsChanged)
+    {
+        m_onRecordingReplayLimitsChanged(seconds, maxMB);
+    }
+    saveConfig();
+}
+
 // ----------------------------------------------------------------------
 // Recording profiles
 // ----------------------------------------------------------------------
@@ -4047,6 +4115,9 @@ RecordingSettings collectRecordingSettings(const UIManager &ui)
     s.outputPath = ui.getRecordingOutputPath();
     s.filenameTemplate = ui.getRecordingFilenameTemplate();
     s.includeAudio = ui.getRecordingIncludeAudio();
+    s.segmentRecording = ui.getRecordingSegmentRecording();
+    s.maxDurationUs = ui.getRecordingMaxDurationUs();
+    s.maxFileSize = ui.getRecordingMaxFileSize();
     s.hardwareEncoder = ui.getRecordingHardwareEncoder();
     switch (s.hardwareEncoder)
     {
@@ -4118,6 +4189,7 @@ bool UIManager::loadRecordingProfile(const std::string &name)
     triggerRecordingOutputPathChange(s.outputPath);
     triggerRecordingFilenameTemplateChange(s.filenameTemplate);
     triggerRecordingIncludeAudioChange(s.includeAudio);
+    triggerRecordingSegmentChange(s.segmentRecording, s.maxDurationUs, s.maxFileSize);
     triggerRecordingHardwareEncoderChange(s.hardwareEncoder);
     // Route the backend-specific preset string to the right per-backend
     // field — same dispatch as the streaming side does.
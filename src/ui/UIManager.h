@@ -8,6 +8,7 @@
 #include <memory>
 #include "../renderer/glad_loader.h"
 #include "../capture/IVideoCapture.h"
+#include "../capture/JitterBuffer.h"
 
 struct GLFWwindow;
 #ifdef USE_SDL2
@@ -88,6 +89,12 @@ struct RecordingConfig
     std::string outputPath       = "recordings/";
     std::string filenameTemplate = "recording_%Y%m%d_%H%M%S";
     bool        includeAudio     = true;
+    bool        segmentRecording = false;      // per-segment limits below
+    uint64_t    maxDurationUs    = 0;          // 0 = no limit
+    uint64_t    maxFileSize      = 0;          // bytes, 0 = no limit
+    uint32_t    replayBufferSeconds = 60;      // instant replay window
+    uint32_t    replayBufferMaxMB   = 512;     // instant replay memory cap
+    bool        shareStreamEncoder  = false;   // reuse /stream's encode (opt-in)
     int         hardwareEncoder  = 0;          // 0=Auto 1=SW 2=NVENC 3=VAAPI 4=QSV 5=AMF
     std::string nvencPreset      = "p4";
     std::string vaapiRcMode      = "VBR";
@@ -158,8 +165,10 @@ struct RemoteState
     bool        initialConnectFailing = false;
     uint32_t    upstreamClientCount   = 0;
     std::string interpolation         = "linear";
+    std::string hwDecode              = "auto"; // VideoCaptureRemote::hwDecodeModeFromString
     float       audioVolume           = 1.0f;
     bool        audioMuted            = false;
+    JitterBufferStats jitter;
 };
 
 // #160 — UIManager chat settings grouped (group 6/N, final grouping group).
@@ -655,6 +664,7 @@ public:
     void setStreamingConfig(const StreamingConfig &cfg) { m_streamingConfig = cfg; }
 
     std::string getRemoteInterpolation() const { return m_remoteState.interpolation; }
+    std::string getRemoteHwDecode() const { return m_remoteState.hwDecode; }
     // #160 — bulk access to the remote-source state group (per-field accessors
     // are thin wrappers over the same struct).
     const RemoteState &getRemoteState() const { return m_remoteState; }
@@ -711,6 +721,7 @@ public:
     void triggerStreamingQsvPresetChange(const std::string &v);
     void triggerStreamingAmfQualityChange(const std::string &v);
     void triggerRemoteInterpolationChange(const std::string &v);
+    void triggerRemoteHwDecodeChange(const std::string &v);
     // #77 — volume in [0,1]; mute is a separate latch that overrides
     // the slider value (so unmuting restores the last level). Both push
     // the effective gain (muted ? 0 : volume) through the callback.
@@ -781,6 +792,11 @@ public:
     // we're not a client or the host's /meta predates this field.
     uint32_t getRemoteUpstreamClientCount() const { return m_remoteState.upstreamClientCount; }
     void setRemoteUpstreamClientCount(uint32_t v) { m_remoteState.upstreamClientCount = v; }
+    // Playout-buffer metrics, mirrored from
+    // VideoCaptureRemote::getJitterStats() every frame; zeroed outside
+    // client mode. Served by GET /api/v1/source/jitter.
+    JitterBufferStats getRemoteJitterStats() const { return m_remoteState.jitter; }
+    void setRemoteJitterStats(const JitterBufferStats &v) { m_remoteState.jitter = v; }
     float getSourceOverscanPercentX() const { return m_sourceOverscanPercentX; }
     float getSourceOverscanPercentY() const { return m_sourceOverscanPercentY; }
     bool getSourceOverscanLocked() const { return m_sourceOverscanLocked; }
@@ -855,6 +871,7 @@ public:
     void setOnStreamingQsvPresetChanged  (std::function<void(const std::string &)> cb) { m_onStreamingQsvPresetChanged   = cb; }
     void setOnStreamingAmfQualityChanged (std::function<void(const std::string &)> cb) { m_onStreamingAmfQualityChanged  = cb; }
     void setOnRemoteInterpolationChanged (std::function<void(const std::string &)> cb) { m_onRemoteInterpolationChanged  = cb; }
+    void setOnRemoteHwDecodeChanged      (std::function<void(const std::string &)> cb) { m_onRemoteHwDecodeChanged       = cb; }
     // #77 — receives the effective linear gain (muted ? 0 : volume).
     void setOnRemoteAudioVolumeChanged   (std::function<void(float)> cb) { m_onRemoteAudioVolumeChanged = cb; }
 
@@ -878,6 +895,7 @@ public:
 
     // Recording info setters (public)
     void setRecordingActive(bool active) { m_recordingActive = active; }
+    void setReplayBufferActive(bool active) { m_replayBufferActive = active; }
     void setRecordingDurationUs(uint64_t durationUs) { m_recordingDurationUs = durationUs; }
     void setRecordingFileSize(uint64_t fileSize) { m_recordingFileSize = fileSize; }
     void setRecordingFilename(const std::string& filename) { m_recordingFilename = filename; }
@@ -898,6 +916,10 @@ public:
     void setRecordingOutputPath(const std::string& path) { m_recordingConfig.outputPath = path; }
     void setRecordingFilenameTemplate(const std::string& template_) { m_recordingConfig.filenameTemplate = template_; }
     void setRecordingIncludeAudio(bool include) { m_recordingConfig.includeAudio = include; }
+    void setRecordingSegmentRecording(bool enabled) { m_recordingConfig.segmentRecording = enabled; }
+    void setRecordingMaxDurationUs(uint64_t us) { m_recordingConfig.maxDurationUs = us; }
+    void setRecordingMaxFileSize(uint64_t bytes) { m_recordingConfig.maxFileSize = bytes; }
+    void setRecordingShareStreamEncoder(bool share) { m_recordingConfig.shareStreamEncoder = share; }
 
     // Hardware encoder selection for recording (#59). Same int-based
     // encoding as the streaming side so we don't have to pull
@@ -913,6 +935,7 @@ public:
 
     // Recording info getters (public)
     bool getRecordingActive() const { return m_recordingActive; }
+    bool getReplayBufferActive() const { return m_replayBufferActive; }
     uint64_t getRecordingDurationUs() const { return m_recordingDurationUs; }
     uint64_t getRecordingFileSize() const { return m_recordingFileSize; }
     std::string getRecordingFilename() const { return m_recordingFilename; }
@@ -933,6 +956,12 @@ public:
     std::string getRecordingOutputPath() const { return m_recordingConfig.outputPath; }
     std::string getRecordingFilenameTemplate() const { return m_recordingConfig.filenameTemplate; }
     bool getRecordingIncludeAudio() const { return m_recordingConfig.includeAudio; }
+    bool getRecordingSegmentRecording() const { return m_recordingConfig.segmentRecording; }
+    uint64_t getRecordingMaxDurationUs() const { return m_recordingConfig.maxDurationUs; }
+    uint64_t getRecordingMaxFileSize() const { return m_recordingConfig.maxFileSize; }
+    uint32_t getRecordingReplayBufferSeconds() const { return m_recordingConfig.replayBufferSeconds; }
+    uint32_t getRecordingReplayBufferMaxMB() const { return m_recordingConfig.replayBufferMaxMB; }
+    bool getRecordingShareStreamEncoder() const { return m_recordingConfig.shareStreamEncoder; }
     int  getRecordingHardwareEncoder() const         { return m_recordingConfig.hardwareEncoder; }
     std::string getRecordingNvencPreset() const      { return m_recordingConfig.nvencPreset; }
     std::string getRecordingVaapiRcMode() const      { return m_recordingConfig.vaapiRcMode; }
@@ -962,12 +991,21 @@ public:
     void triggerRecordingOutputPathChange(const std::string& path);
     void triggerRecordingFilenameTemplateChange(const std::string& template_);
     void triggerRecordingIncludeAudioChange(bool include);
+    // Segmented recording: toggle + per-segment limits travel together.
+    void triggerRecordingSegmentChange(bool enabled, uint64_t maxDurationUs, uint64_t maxFileSize);
     void triggerRecordingHardwareEncoderChange(int v);
     void triggerRecordingNvencPresetChange(const std::string &v);
     void triggerRecordingVaapiRcModeChange(const std::string &v);
     void triggerRecordingQsvPresetChange(const std::string &v);
     void triggerRecordingAmfQualityChange(const std::string &v);
     void triggerRecordingStartStop(bool start);
+    // Instant replay: buffer on/off, save (seconds = 0 → whole buffer),
+    // window/memory caps (applied the next time the buffer starts).
+    void triggerReplayBufferStartStop(bool start);
+    // false if nothing was started (buffer off or a save still running);
+    // outputPath (optional) receives the file being written.
+    bool triggerReplaySave(uint32_t seconds, std::string *outputPath = nullptr);
+    void triggerRecordingReplayLimitsChange(uint32_t seconds, uint32_t maxMB);
 
     // Recording profiles — save/load/list/delete the full recording
     // configuration (codec, preset, bitrate, container, audio, etc.)
@@ -1006,6 +1044,10 @@ public:
     void setOnRecordingOutputPathChanged(std::function<void(const std::string&)> callback) { m_onRecordingOutputPathChanged = callback; }
     void setOnRecordingFilenameTemplateChanged(std::function<void(const std::string&)> callback) { m_onRecordingFilenameTemplateChanged = callback; }
     void setOnRecordingIncludeAudioChanged(std::function<void(bool)> callback) { m_onRecordingIncludeAudioChanged = callback; }
+    void setOnRecordingSegmentChanged(std::function<void(bool, uint64_t, uint64_t)> callback) { m_onRecordingSegmentChanged = callback; }
+    void setOnReplayBufferStartStop(std::function<void(bool)> callback) { m_onReplayBufferStartStop = callback; }
+    void setOnReplaySave(std::function<bool(uint32_t, std::string *)> callback) { m_onReplaySave = callback; }
+    void setOnRecordingReplayLimitsChanged(std::function<void(uint32_t, uint32_t)> callback) { m_onRecordingReplayLimitsChanged = callback; }
     void setOnRecordingHardwareEncoderChanged(std::function<void(int)> cb)             { m_onRecordingHardwareEncoderChanged = cb; }
     void setOnRecordingNvencPresetChanged(std::function<void(const std::string &)> cb) { m_onRecordingNvencPresetChanged = cb; }
     void setOnRecordingVaapiRcModeChanged(std::function<void(const std::string &)> cb) { m_onRecordingVaapiRcModeChanged = cb; }
@@ -1480,6 +1522,7 @@ private:
     std::function<void(const std::string &)> m_onStreamingQsvPresetChanged;
     std::function<void(const std::string &)> m_onStreamingAmfQualityChanged;
     std::function<void(const std::string &)> m_onRemoteInterpolationChanged;
+    std::function<void(const std::string &)> m_onRemoteHwDecodeChanged;
     std::function<void(float)> m_onRemoteAudioVolumeChanged;
     std::function<void(uint32_t, uint32_t, uint32_t, uint32_t)> m_onScreenRegionChanged;
     std::function<void(size_t)> m_onStreamingMaxVideoBufferSizeChanged;
@@ -1489,6 +1532,7 @@ private:
 
     // Recording state
     bool m_recordingActive = false;
+    bool m_replayBufferActive = false;
     uint64_t m_recordingDurationUs = 0;
     uint64_t m_recordingFileSize = 0;
     std::string m_recordingFilename;
@@ -1517,6 +1561,10 @@ private:
     std::function<void(const std::string&)> m_onRecordingOutputPathChanged;
     std::function<void(const std::string&)> m_onRecordingFilenameTemplateChanged;
     std::function<void(bool)> m_onRecordingIncludeAudioChanged;
+    std::function<void(bool, uint64_t, uint64_t)> m_onRecordingSegmentChanged;
+    std::function<void(bool)> m_onReplayBufferStartStop;
+    std::function<bool(uint32_t, std::string *)> m_onReplaySave;
+    std::function<void(uint32_t, uint32_t)> m_onRecordingReplayLimitsChanged;
     std::function<void(int)> m_onRecordingHardwareEncoderChanged;
     std::function<void(const std::string &)> m_onRecordingNvencPresetChanged;
     std::function<void(const std::string &)> m_onRecordingVaapiRcModeChanged;
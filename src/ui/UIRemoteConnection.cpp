@@ -151,6 +151,32 @@ void UIRemoteConnection::renderManualTab(bool /*sourceIsRemote*/,
 
     ImGui::Spacing();
 
+    const char *decoders[]      = {"auto", "vaapi", "v4l2m2m", "off"};
+    const char *decoderLabels[] = {
+        "Auto",
+        "VAAPI",
+        "V4L2 M2M",
+        "Software"
+    };
+    std::string currentDecoder = m_uiManager->getRemoteHwDecode();
+    int currentDecoderIndex = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        if (currentDecoder == decoders[i]) { currentDecoderIndex = i; break; }
+    }
+    ui_section_header(T("remote.hw_decode").c_str());
+    ImGui::SetNextItemWidth(-1);
+    if (ImGui::Combo("##remoteHwDecode", &currentDecoderIndex, decoderLabels, 4))
+    {
+        m_uiManager->triggerRemoteHwDecodeChange(decoders[currentDecoderIndex]);
+    }
+    if (ImGui::IsItemHovered())
+    {
+        ImGui::SetTooltip("%s", T("remote.hw_decode.tip").c_str());
+    }
+
+    ImGui::Spacing();
+
     // #77 Client-side audio volume + mute. Only meaningful in Remote
     // source mode, which is exactly where this tab lives. The slider
     // shows 0–100%; mute is a separate latch so unmuting restores the
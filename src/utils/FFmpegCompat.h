@@ -66,6 +66,14 @@ extern "C"
 // Helper functions for channel layout setup
 namespace FFmpegCompat
 {
+    /**
+     * Bytes to allocate past the last row of a packed buffer handed to
+     * sws_scale as its source. libswscale's SIMD input paths (AVX2 on x86)
+     * read a couple of registers past the end of the image; 64 is FFmpeg's
+     * AV_INPUT_BUFFER_PADDING_SIZE and covers them.
+     */
+    constexpr size_t kSwsTailPad = 64;
+
     /**
      * Set channel layout for AVCodecContext
      * Compatible with FFmpeg 5.8 (58) through 6.2+ (62+)
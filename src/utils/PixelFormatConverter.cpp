@@ -1,80 +1,231 @@
 #include "PixelFormatConverter.h"
+#include "PixelFormatConverterSimd.h"
 
 #include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
 
 namespace rc
 {
 namespace pixfmt
 {
-void yuv601ToRgb(int y, int u, int v, uint8_t *out)
+namespace
 {
-    int C = y - 16, D = u - 128, E = v - 128;
-    int R = (298 * C + 409 * E + 128) >> 8;
-    int G = (298 * C - 100 * D - 208 * E + 128) >> 8;
-    int B = (298 * C + 516 * D + 128) >> 8;
-    out[0] = static_cast<uint8_t>(std::max(0, std::min(255, R)));
-    out[1] = static_cast<uint8_t>(std::max(0, std::min(255, G)));
-    out[2] = static_cast<uint8_t>(std::max(0, std::min(255, B)));
+// 8.8 fixed point. Limited range scales Y by 255/219 (298) and chroma by
+// 255/224; full range uses Y as-is (256) and the plain matrix.
+const YuvCoefficients kBt601Limited = {16, 298, 409, -100, -208, 516};
+const YuvCoefficients kBt709Limited = {16, 298, 459, -55, -136, 541};
+const YuvCoefficients kBt601Full = {0, 256, 359, -88, -183, 454};
+const YuvCoefficients kBt709Full = {0, 256, 403, -48, -120, 475};
+
+// Above 1080p a single core can't keep up with 4K60 even with SIMD; split
+// into row bands. Below it the thread start-up costs more than it saves.
+const size_t kParallelMinPixels = 1920u * 1088u;
+const uint32_t kMinRowsPerBand = 64;
+
+std::atomic<int> g_simdLevel(-1); // -1 = detectSimdLevel()
+std::atomic<unsigned int> g_maxThreads(4);
+
+bool isSupported(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return true;
+    case SimdLevel::Ssse3:
+        return detail::ssse3Kernels() != nullptr;
+    case SimdLevel::Avx2:
+        return detail::avx2Kernels() != nullptr;
+    case SimdLevel::Neon:
+        return detail::neonKernels() != nullptr;
+    }
+    return false;
 }
 
-void yuy2ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height)
+const detail::RowKernels *activeKernels()
 {
-    if (!src || !dst || width == 0 || height == 0)
+    switch (getSimdLevel())
+    {
+    case SimdLevel::Ssse3:
+        return detail::ssse3Kernels();
+    case SimdLevel::Avx2:
+        return detail::avx2Kernels();
+    case SimdLevel::Neon:
+        return detail::neonKernels();
+    case SimdLevel::Scalar:
+        break;
+    }
+    return nullptr;
+}
+
+// Run fn(rowBegin, rowEnd) over [0, rows), split across threads for large
+// frames. Bands are disjoint destination rows, so no synchronisation is
+// needed beyond the join.
+template <typename Fn>
+void forEachRowBand(uint32_t rows, uint32_t width, const Fn &fn)
+{
+    unsigned int threads = std::min(g_maxThreads.load(std::memory_order_relaxed),
+                                    std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, std::max(1u, rows / kMinRowsPerBand));
+    if (threads <= 1 || static_cast<size_t>(width) * rows < kParallelMinPixels)
+    {
+        fn(0u, rows);
         return;
-    // YUY2: Y0 U0 Y1 V0 ... (2 pixels per 4 bytes). Bounds-check per macro-pixel.
-    for (uint32_t y = 0; y < height; ++y)
+    }
+
+    const uint32_t band = (rows + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (uint32_t begin = band; begin < rows; begin += band)
     {
-        for (uint32_t x = 0; x < width; x += 2)
+        const uint32_t end = std::min(rows, begin + band);
+        try
         {
-            size_t i = (static_cast<size_t>(y) * width + x) * 2;
-            if (i + 3 >= srcSize)
-                break;
-            int Y0 = src[i], U = src[i + 1], Y1 = src[i + 2], V = src[i + 3];
-            yuv601ToRgb(Y0, U, V, dst + (static_cast<size_t>(y) * width + x) * 3);
-            if (x + 1 < width)
-                yuv601ToRgb(Y1, U, V, dst + (static_cast<size_t>(y) * width + x + 1) * 3);
+            workers.emplace_back([&fn, begin, end]() { fn(begin, end); });
         }
+        catch (const std::system_error &)
+        {
+            fn(begin, end); // no thread available — do the band inline
+        }
+    }
+    fn(0u, std::min(rows, band));
+    for (std::thread &worker : workers)
+    {
+        worker.join();
     }
 }
 
-void uyvyToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height)
+// One row of YUY2/UYVY starting at pixel x. `avail` is how many source
+// bytes exist from the start of this row; stops at the first macro-pixel
+// that would read past it (the frame-level bounds rule of #150).
+void packed422RowScalar(const uint8_t *src, size_t avail, uint8_t *dst, uint32_t x, uint32_t width, bool uyvy,
+                        const YuvCoefficients &k)
 {
-    if (!src || !dst || width == 0 || height == 0)
-        return;
-    if (static_cast<size_t>(width) * height * 2 > srcSize)
-        return; // not enough data — leave as-is
-    for (uint32_t y = 0; y < height; ++y)
+    for (; x < width; x += 2)
     {
-        for (uint32_t x = 0; x < width; x += 2)
+        const size_t i = static_cast<size_t>(x) * 2;
+        if (i + 3 >= avail)
+            break;
+        int Y0, U, Y1, V;
+        if (uyvy)
+        {
+            U = src[i];
+            Y0 = src[i + 1];
+            V = src[i + 2];
+            Y1 = src[i + 3];
+        }
+        else
         {
-            const uint8_t *p = src + (static_cast<size_t>(y) * width + x) * 2;
-            int U = p[0], Y0 = p[1], V = p[2], Y1 = p[3];
-            yuv601ToRgb(Y0, U, V, dst + (static_cast<size_t>(y) * width + x) * 3);
-            if (x + 1 < width)
-                yuv601ToRgb(Y1, U, V, dst + (static_cast<size_t>(y) * width + x + 1) * 3);
+            Y0 = src[i];
+            U = src[i + 1];
+            Y1 = src[i + 2];
+            V = src[i + 3];
         }
+        yuvToRgb(k, Y0, U, V, dst + static_cast<size_t>(x) * 3);
+        if (x + 1 < width)
+            yuvToRgb(k, Y1, U, V, dst + static_cast<size_t>(x + 1) * 3);
+    }
+}
+
+void convertPacked422(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height, bool uyvy,
+                      const YuvCoefficients &k)
+{
+    const size_t rowBytes = static_cast<size_t>(width) * 2;
+    const uint32_t fullRows = static_cast<uint32_t>(std::min<size_t>(height, srcSize / rowBytes));
+    // Odd widths put macro-pixels across row boundaries — scalar only.
+    const detail::RowKernels *kernels = (width & 1) ? nullptr : activeKernels();
+
+    forEachRowBand(fullRows, width, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; ++y)
+        {
+            const uint8_t *s = src + y * rowBytes;
+            uint8_t *d = dst + static_cast<size_t>(y) * width * 3;
+            const uint32_t done = kernels ? kernels->packed422(s, d, width, uyvy, k) : 0;
+            packed422RowScalar(s, srcSize - y * rowBytes, d, done, width, uyvy, k);
+        }
+    });
+
+    // A truncated buffer converts the partial row it ends in, as before.
+    if (fullRows < height && fullRows * rowBytes < srcSize)
+    {
+        packed422RowScalar(src + fullRows * rowBytes, srcSize - fullRows * rowBytes,
+                           dst + static_cast<size_t>(fullRows) * width * 3, 0, width, uyvy, k);
     }
 }
+} // namespace
 
-void nv12ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height)
+const YuvCoefficients &yuvCoefficients(YuvMatrix matrix, YuvRange range)
+{
+    if (matrix == YuvMatrix::Bt709)
+        return range == YuvRange::Full ? kBt709Full : kBt709Limited;
+    return range == YuvRange::Full ? kBt601Full : kBt601Limited;
+}
+
+void yuvToRgb(const YuvCoefficients &k, int y, int u, int v, uint8_t *out)
+{
+    int C = y - k.yOffset, D = u - 128, E = v - 128;
+    int R = (k.cy * C + k.rv * E + 128) >> 8;
+    int G = (k.cy * C + k.gu * D + k.gv * E + 128) >> 8;
+    int B = (k.cy * C + k.bu * D + 128) >> 8;
+    out[0] = static_cast<uint8_t>(std::max(0, std::min(255, R)));
+    out[1] = static_cast<uint8_t>(std::max(0, std::min(255, G)));
+    out[2] = static_cast<uint8_t>(std::max(0, std::min(255, B)));
+}
+
+void yuv601ToRgb(int y, int u, int v, uint8_t *out)
+{
+    yuvToRgb(kBt601Limited, y, u, v, out);
+}
+
+void yuy2ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height,
+                 YuvMatrix matrix, YuvRange range)
+{
+    if (!src || !dst || width == 0 || height == 0)
+        return;
+    // YUY2: Y0 U0 Y1 V0 ... (2 pixels per 4 bytes). Bounds-checked per
+    // macro-pixel: a short buffer converts as much as it holds.
+    convertPacked422(src, srcSize, dst, width, height, false, yuvCoefficients(matrix, range));
+}
+
+void uyvyToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height,
+                 YuvMatrix matrix, YuvRange range)
+{
+    if (!src || !dst || width == 0 || height == 0)
+        return;
+    if (static_cast<size_t>(width) * height * 2 > srcSize)
+        return; // not enough data — leave as-is
+    convertPacked422(src, srcSize, dst, width, height, true, yuvCoefficients(matrix, range));
+}
+
+void nv12ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height,
+                 YuvMatrix matrix, YuvRange range)
 {
     if (!src || !dst || width == 0 || height == 0)
         return;
     const size_t ySize = static_cast<size_t>(width) * height;
     if (ySize + ySize / 2 > srcSize)
         return; // not enough data — leave as-is
+    const YuvCoefficients &k = yuvCoefficients(matrix, range);
     const uint8_t *yPlane = src;
     const uint8_t *uvPlane = src + ySize;
-    for (uint32_t y = 0; y < height; ++y)
-    {
-        const size_t uvRow = static_cast<size_t>(y / 2) * width;
-        for (uint32_t x = 0; x < width; ++x)
+    const detail::RowKernels *kernels = (width & 1) ? nullptr : activeKernels();
+
+    forEachRowBand(height, width, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t y = begin; y < end; ++y)
         {
-            int Y = yPlane[static_cast<size_t>(y) * width + x];
-            const uint8_t *uv = uvPlane + uvRow + (x & ~1u);
-            yuv601ToRgb(Y, uv[0], uv[1], dst + (static_cast<size_t>(y) * width + x) * 3);
+            const uint8_t *yRow = yPlane + static_cast<size_t>(y) * width;
+            const uint8_t *uvRow = uvPlane + static_cast<size_t>(y / 2) * width;
+            uint8_t *d = dst + static_cast<size_t>(y) * width * 3;
+            uint32_t x = kernels ? kernels->nv12(yRow, uvRow, d, width, k) : 0;
+            for (; x < width; ++x)
+            {
+                const uint8_t *uv = uvRow + (x & ~1u);
+                yuvToRgb(k, yRow[x], uv[0], uv[1], d + static_cast<size_t>(x) * 3);
+            }
         }
-    }
+    });
 }
 
 void rgb32ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height)
@@ -84,12 +235,117 @@ void rgb32ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t wid
     const size_t px = static_cast<size_t>(width) * height;
     if (px * 4 > srcSize)
         return; // not enough data — leave as-is
-    for (size_t i = 0; i < px; ++i)
+    const detail::RowKernels *kernels = activeKernels();
+
+    forEachRowBand(height, width, [&](uint32_t begin, uint32_t end) {
+        const size_t first = static_cast<size_t>(begin) * width;
+        const size_t count = static_cast<size_t>(end - begin) * width;
+        const uint8_t *s = src + first * 4;
+        uint8_t *d = dst + first * 3;
+        for (size_t i = kernels ? kernels->rgb32(s, d, count) : 0; i < count; ++i)
+        {
+            d[i * 3 + 0] = s[i * 4 + 0];
+            d[i * 3 + 1] = s[i * 4 + 1];
+            d[i * 3 + 2] = s[i * 4 + 2];
+        }
+    });
+}
+
+void downscaleRgb24Area(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                        uint8_t *dst, uint32_t dstWidth, uint32_t dstHeight)
+{
+    if (!src || !dst || srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0)
+        return;
+    const size_t rowBytes = static_cast<size_t>(srcWidth) * 3;
+    if (srcStride < rowBytes)
+        return;
+    const detail::RowKernels *kernels = activeKernels();
+
+    // Column spans are the same for every output row.
+    std::vector<uint32_t> colBegin(dstWidth + 1);
+    for (uint32_t x = 0; x <= dstWidth; ++x)
+        colBegin[x] = static_cast<uint32_t>(static_cast<uint64_t>(x) * srcWidth / dstWidth);
+
+    // Per-byte column sums of the rows under one output row. u32 holds
+    // 16M rows of 255; the horizontal sums below go to 64 bits.
+    std::vector<uint32_t> acc(rowBytes);
+    for (uint32_t y = 0; y < dstHeight; ++y)
+    {
+        const uint32_t y0 = static_cast<uint32_t>(static_cast<uint64_t>(y) * srcHeight / dstHeight);
+        const uint32_t y1 = std::max(y0 + 1, static_cast<uint32_t>(static_cast<uint64_t>(y + 1) * srcHeight / dstHeight));
+
+        std::fill(acc.begin(), acc.end(), 0u);
+        for (uint32_t sy = y0; sy < y1; ++sy)
+        {
+            const uint8_t *s = src + static_cast<size_t>(sy) * srcStride;
+            for (size_t i = kernels ? kernels->accumulate(s, acc.data(), rowBytes) : 0; i < rowBytes; ++i)
+                acc[i] += s[i];
+        }
+
+        uint8_t *d = dst + static_cast<size_t>(y) * dstWidth * 3;
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            const uint32_t x0 = colBegin[x];
+            const uint32_t x1 = std::max(x0 + 1, colBegin[x + 1]);
+            const uint64_t area = static_cast<uint64_t>(x1 - x0) * (y1 - y0);
+            uint64_t r = 0, g = 0, b = 0;
+            for (uint32_t sx = x0; sx < x1; ++sx)
+            {
+                r += acc[sx * 3 + 0];
+                g += acc[sx * 3 + 1];
+                b += acc[sx * 3 + 2];
+            }
+            d[x * 3 + 0] = static_cast<uint8_t>((r + area / 2) / area);
+            d[x * 3 + 1] = static_cast<uint8_t>((g + area / 2) / area);
+            d[x * 3 + 2] = static_cast<uint8_t>((b + area / 2) / area);
+        }
+    }
+}
+
+SimdLevel detectSimdLevel()
+{
+    static const SimdLevel detected = []() {
+        if (detail::avx2Kernels())
+            return SimdLevel::Avx2;
+        if (detail::ssse3Kernels())
+            return SimdLevel::Ssse3;
+        if (detail::neonKernels())
+            return SimdLevel::Neon;
+        return SimdLevel::Scalar;
+    }();
+    return detected;
+}
+
+SimdLevel getSimdLevel()
+{
+    const int level = g_simdLevel.load(std::memory_order_relaxed);
+    return level < 0 ? detectSimdLevel() : static_cast<SimdLevel>(level);
+}
+
+void setSimdLevel(SimdLevel level)
+{
+    g_simdLevel.store(isSupported(level) ? static_cast<int>(level) : -1, std::memory_order_relaxed);
+}
+
+const char *simdLevelName(SimdLevel level)
+{
+    switch (level)
     {
-        dst[i * 3 + 0] = src[i * 4 + 0];
-        dst[i * 3 + 1] = src[i * 4 + 1];
-        dst[i * 3 + 2] = src[i * 4 + 2];
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Ssse3:
+        return "ssse3";
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Neon:
+        return "neon";
     }
+    return "unknown";
+}
+
+void setMaxThreads(unsigned int threads)
+{
+    g_maxThreads.store(std::max(1u, threads), std::memory_order_relaxed);
 }
 } // namespace pixfmt
 } // namespace rc
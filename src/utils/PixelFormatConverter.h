@@ -9,8 +9,13 @@
 // math lives in one testable place instead of inline in a capture backend.
 // These are dependency-free (no FFmpeg/GL) — usable anywhere a backend has a
 // raw buffer and no swscale handy (the custom DirectShow filter path). The
-// main app's hot paths (FrameProcessor, MediaEncoder) keep using libswscale,
-// which is SIMD-optimized; this is the fallback math, not a replacement.
+// main app's hot paths (FrameProcessor, MediaEncoder) keep using libswscale.
+//
+// The converters pick a SIMD kernel at runtime (SSSE3/AVX2 via CPUID on x86,
+// NEON on ARM) and split frames larger than 1080p into row bands across a
+// few threads. Every kernel is bit-exact with the scalar reference
+// (yuvToRgb) — same integer coefficients, same rounding and clamping — so
+// the dispatch level never changes the output, only the speed.
 //
 // All converters write tightly-packed RGB24 (3 bytes/pixel, top-to-bottom)
 // and bounds-check the source: if the input buffer is too small they leave
@@ -21,19 +26,85 @@ namespace rc
 {
 namespace pixfmt
 {
+enum class YuvMatrix
+{
+    Bt601,
+    Bt709
+};
+
+enum class YuvRange
+{
+    Limited, // Y 16..235, UV 16..240 (TV / studio swing)
+    Full     // 0..255 (JPEG / PC swing)
+};
+
+// 8.8 fixed-point YUV → RGB coefficients:
+//   R = (cy*(Y-yOffset) + rv*(V-128) + 128) >> 8, clamped to 0..255
+//   G = (cy*(Y-yOffset) + gu*(U-128) + gv*(V-128) + 128) >> 8
+//   B = (cy*(Y-yOffset) + bu*(U-128) + 128) >> 8
+struct YuvCoefficients
+{
+    int yOffset;
+    int cy;
+    int rv;
+    int gu;
+    int gv;
+    int bu;
+};
+
+const YuvCoefficients &yuvCoefficients(YuvMatrix matrix, YuvRange range);
+
+// Scalar reference for a single pixel; writes 3 bytes to `out`.
+void yuvToRgb(const YuvCoefficients &k, int y, int u, int v, uint8_t *out);
+
 // BT.601 limited-range YUV → RGB for a single pixel; writes 3 bytes to `out`.
 void yuv601ToRgb(int y, int u, int v, uint8_t *out);
 
 // YUY2 / YUYV: Y0 U0 Y1 V0 (2 pixels per 4 bytes).
-void yuy2ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height);
+void yuy2ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height,
+                 YuvMatrix matrix = YuvMatrix::Bt601, YuvRange range = YuvRange::Limited);
 
 // UYVY: U0 Y0 V0 Y1 (2 pixels per 4 bytes) — byte order swapped vs YUY2.
-void uyvyToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height);
+void uyvyToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height,
+                 YuvMatrix matrix = YuvMatrix::Bt601, YuvRange range = YuvRange::Limited);
 
 // NV12: full-res Y plane (W*H) then interleaved U/V plane (W*H/2), 2x2 subsampled.
-void nv12ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height);
+void nv12ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height,
+                 YuvMatrix matrix = YuvMatrix::Bt601, YuvRange range = YuvRange::Limited);
 
 // RGB32 (BGRX/BGRA, 4 bpp) → RGB24: drop the 4th byte, keep byte order.
 void rgb32ToRgb24(const uint8_t *src, size_t srcSize, uint8_t *dst, uint32_t width, uint32_t height);
+
+// Box (area-average) resize of packed RGB24, meant for thumbnails. Output
+// pixel (x, y) is the rounded mean of source columns [x*sw/dw, (x+1)*sw/dw)
+// and the matching rows, so every source pixel counts exactly once; an axis
+// that is enlarged degenerates to nearest-neighbour. srcStride is the byte
+// distance between source rows (>= srcWidth*3, e.g. an AVFrame linesize);
+// dst is tightly packed. The vertical pass — the part that reads every
+// source byte — goes through the SIMD kernels; single-threaded.
+void downscaleRgb24Area(const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, size_t srcStride,
+                        uint8_t *dst, uint32_t dstWidth, uint32_t dstHeight);
+
+// Kernel selection. detectSimdLevel() is the best level this CPU runs;
+// setSimdLevel() switches to any supported level (Scalar always is) — e.g.
+// to get the reference output for comparison (retrocapture-bench
+// --pixfmt). Unsupported levels reset to detectSimdLevel(). Not meant to be
+// flipped while conversions are running.
+enum class SimdLevel
+{
+    Scalar,
+    Ssse3,
+    Avx2,
+    Neon
+};
+
+SimdLevel detectSimdLevel();
+SimdLevel getSimdLevel();
+void setSimdLevel(SimdLevel level);
+const char *simdLevelName(SimdLevel level);
+
+// Row-band threading for large frames (default: up to 4 threads above
+// 1080p). 1 disables it.
+void setMaxThreads(unsigned int threads);
 } // namespace pixfmt
 } // namespace rc
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "PixelFormatConverter.h"
+
+// Internal to PixelFormatConverter*.cpp — the per-ISA row kernels behind
+// the rc::pixfmt dispatch.
+namespace rc
+{
+namespace pixfmt
+{
+namespace detail
+{
+// Each kernel converts the longest prefix of a row it can do in whole
+// vector blocks and returns how many pixels it wrote; the caller finishes
+// the tail with the scalar code. Kernels never read past the source bytes
+// of the pixels they convert. packed422/nv12 expect an even width.
+struct RowKernels
+{
+    uint32_t (*packed422)(const uint8_t *src, uint8_t *dst, uint32_t width, bool uyvy,
+                          const YuvCoefficients &k);
+    uint32_t (*nv12)(const uint8_t *yRow, const uint8_t *uvRow, uint8_t *dst, uint32_t width,
+                     const YuvCoefficients &k);
+    size_t (*rgb32)(const uint8_t *src, uint8_t *dst, size_t pixels);
+    // acc[i] += src[i] (area downscale's vertical pass); returns bytes done.
+    size_t (*accumulate)(const uint8_t *src, uint32_t *acc, size_t count);
+};
+
+// nullptr when the kernels weren't compiled for this target or the CPU
+// running us doesn't have the instructions.
+const RowKernels *ssse3Kernels();
+const RowKernels *avx2Kernels();
+const RowKernels *neonKernels();
+} // namespace detail
+} // namespace pixfmt
+} // namespace rc
@@ -0,0 +1,170 @@
+#include "PixelFormatConverterSimd.h"
+
+// NEON row kernels. NEON is mandatory on AArch64 (BUILD_COMPATIBLE_ARM64's
+// armv8-a baseline included); the 32-bit Pi build enables it with
+// -mfpu=neon-vfpv4, and on 32-bit Linux we still ask HWCAP before using it.
+//
+// vld4/vld2 split the packed/semi-planar input into even-Y, odd-Y, U and V
+// lanes, so chroma is computed once per pixel pair and vst3 does the RGB24
+// interleave. Widening multiplies keep the math in 32 bits and
+// vqmovn/vqmovun clamp exactly like the scalar reference.
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__) && defined(__linux__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+namespace rc
+{
+namespace pixfmt
+{
+namespace detail
+{
+namespace
+{
+inline uint8x8_t channel(int32x4_t yLo, int32x4_t yHi, int32x4_t cLo, int32x4_t cHi)
+{
+    const int16x4_t lo = vqmovn_s32(vshrq_n_s32(vaddq_s32(yLo, cLo), 8));
+    const int16x4_t hi = vqmovn_s32(vshrq_n_s32(vaddq_s32(yHi, cHi), 8));
+    return vqmovun_s16(vcombine_s16(lo, hi));
+}
+
+// 16 pixels: 8 even + 8 odd luma samples sharing 8 U/V pairs.
+inline uint8x16x3_t yuv16(uint8x8_t yEven, uint8x8_t yOdd, uint8x8_t u8, uint8x8_t v8, const YuvCoefficients &k)
+{
+    const int16x8_t yOffset = vdupq_n_s16(static_cast<int16_t>(k.yOffset));
+    const int16x8_t c128 = vdupq_n_s16(128);
+    const int32x4_t round = vdupq_n_s32(128);
+    const int16_t cy = static_cast<int16_t>(k.cy);
+
+    const int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), c128);
+    const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), c128);
+    const int16x8_t ye = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(yEven)), yOffset);
+    const int16x8_t yo = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(yOdd)), yOffset);
+
+    const int32x4_t rLo = vmull_n_s16(vget_low_s16(v), static_cast<int16_t>(k.rv));
+    const int32x4_t rHi = vmull_n_s16(vget_high_s16(v), static_cast<int16_t>(k.rv));
+    const int32x4_t gLo = vmlal_n_s16(vmull_n_s16(vget_low_s16(u), static_cast<int16_t>(k.gu)),
+                                      vget_low_s16(v), static_cast<int16_t>(k.gv));
+    const int32x4_t gHi = vmlal_n_s16(vmull_n_s16(vget_high_s16(u), static_cast<int16_t>(k.gu)),
+                                      vget_high_s16(v), static_cast<int16_t>(k.gv));
+    const int32x4_t bLo = vmull_n_s16(vget_low_s16(u), static_cast<int16_t>(k.bu));
+    const int32x4_t bHi = vmull_n_s16(vget_high_s16(u), static_cast<int16_t>(k.bu));
+
+    const int32x4_t yeLo = vmlal_n_s16(round, vget_low_s16(ye), cy);
+    const int32x4_t yeHi = vmlal_n_s16(round, vget_high_s16(ye), cy);
+    const int32x4_t yoLo = vmlal_n_s16(round, vget_low_s16(yo), cy);
+    const int32x4_t yoHi = vmlal_n_s16(round, vget_high_s16(yo), cy);
+
+    const uint8x8x2_t r = vzip_u8(channel(yeLo, yeHi, rLo, rHi), channel(yoLo, yoHi, rLo, rHi));
+    const uint8x8x2_t g = vzip_u8(channel(yeLo, yeHi, gLo, gHi), channel(yoLo, yoHi, gLo, gHi));
+    const uint8x8x2_t b = vzip_u8(channel(yeLo, yeHi, bLo, bHi), channel(yoLo, yoHi, bLo, bHi));
+
+    uint8x16x3_t rgb;
+    rgb.val[0] = vcombine_u8(r.val[0], r.val[1]);
+    rgb.val[1] = vcombine_u8(g.val[0], g.val[1]);
+    rgb.val[2] = vcombine_u8(b.val[0], b.val[1]);
+    return rgb;
+}
+
+uint32_t packed422Neon(const uint8_t *src, uint8_t *dst, uint32_t width, bool uyvy, const YuvCoefficients &k)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        // YUY2: Y0 U Y1 V, UYVY: U Y0 V Y1.
+        const uint8x8x4_t p = vld4_u8(src + x * 2);
+        const uint8x16x3_t rgb = uyvy ? yuv16(p.val[1], p.val[3], p.val[0], p.val[2], k)
+                                      : yuv16(p.val[0], p.val[2], p.val[1], p.val[3], k);
+        vst3q_u8(dst + x * 3, rgb);
+    }
+    return x;
+}
+
+uint32_t nv12Neon(const uint8_t *yRow, const uint8_t *uvRow, uint8_t *dst, uint32_t width, const YuvCoefficients &k)
+{
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const uint8x8x2_t y = vld2_u8(yRow + x);
+        const uint8x8x2_t uv = vld2_u8(uvRow + x);
+        vst3q_u8(dst + x * 3, yuv16(y.val[0], y.val[1], uv.val[0], uv.val[1], k));
+    }
+    return x;
+}
+
+size_t rgb32Neon(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        const uint8x16x4_t px = vld4q_u8(src + i * 4);
+        uint8x16x3_t rgb;
+        rgb.val[0] = px.val[0];
+        rgb.val[1] = px.val[1];
+        rgb.val[2] = px.val[2];
+        vst3q_u8(dst + i * 3, rgb);
+    }
+    return i;
+}
+
+// Area downscale column sums: widen 16 bytes to u16, then add-widen into
+// four u32 vectors.
+size_t accumulateNeon(const uint8_t *src, uint32_t *acc, size_t count)
+{
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16_t v = vld1q_u8(src + i);
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        uint32_t *a = acc + i;
+        vst1q_u32(a + 0, vaddw_u16(vld1q_u32(a + 0), vget_low_u16(lo)));
+        vst1q_u32(a + 4, vaddw_u16(vld1q_u32(a + 4), vget_high_u16(lo)));
+        vst1q_u32(a + 8, vaddw_u16(vld1q_u32(a + 8), vget_low_u16(hi)));
+        vst1q_u32(a + 12, vaddw_u16(vld1q_u32(a + 12), vget_high_u16(hi)));
+    }
+    return i;
+}
+
+bool cpuHasNeon()
+{
+#if !defined(__aarch64__) && defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+    return true;
+#endif
+}
+} // namespace
+
+const RowKernels *neonKernels()
+{
+    static const RowKernels kernels = {packed422Neon, nv12Neon, rgb32Neon, accumulateNeon};
+    static const bool supported = cpuHasNeon();
+    return supported ? &kernels : nullptr;
+}
+} // namespace detail
+} // namespace pixfmt
+} // namespace rc
+
+#else
+
+namespace rc
+{
+namespace pixfmt
+{
+namespace detail
+{
+const RowKernels *neonKernels()
+{
+    return nullptr;
+}
+} // namespace detail
+} // namespace pixfmt
+} // namespace rc
+
+#endif
@@ -0,0 +1,416 @@
+#include "PixelFormatConverterSimd.h"
+
+// SSSE3 / AVX2 row kernels. Compiled with per-function target attributes
+// (GCC/Clang) instead of global -mavx2, so BUILD_COMPATIBLE_X86_64 builds
+// stay runnable on pre-AVX2 CPUs and still pick AVX2 up at runtime.
+//
+// Math per pixel, in 32-bit lanes via pmaddwd so it matches the scalar
+// reference bit for bit: yTerm = cy*(Y-yOffset) + 128 comes from one madd
+// of (Y, 1) x (cy, 128); chroma from (U, V) x (0, rv) / (gu, gv) / (bu, 0).
+// >> 8 is an arithmetic shift, then packs/packus clamp to 0..255 exactly
+// like std::max(0, std::min(255, x)).
+//
+// SSE2 alone has no byte shuffle for the RGB24 interleave, so the 128-bit
+// tier needs SSSE3 (pshufb); CPUs without it use the scalar code.
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) && \
+    (defined(__GNUC__) || defined(_MSC_VER))
+
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RC_TARGET_SSSE3
+#define RC_TARGET_AVX2
+#else
+#define RC_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define RC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace rc
+{
+namespace pixfmt
+{
+namespace detail
+{
+namespace
+{
+// pshufb masks spreading 16 R, G and B bytes over 48 bytes of RGB24:
+// output byte i takes pixel i/3 from channel i%3, -128 zeroes it.
+struct InterleaveMasks
+{
+    alignas(16) int8_t m[3][3][16]; // [channel][output chunk][byte]
+
+    InterleaveMasks()
+    {
+        for (int ch = 0; ch < 3; ch++)
+            for (int chunk = 0; chunk < 3; chunk++)
+                for (int j = 0; j < 16; j++)
+                {
+                    const int i = chunk * 16 + j;
+                    m[ch][chunk][j] = (i % 3 == ch) ? static_cast<int8_t>(i / 3) : static_cast<int8_t>(-128);
+                }
+    }
+};
+
+const InterleaveMasks kInterleave;
+
+inline uint32_t pair16(int lo, int hi)
+{
+    return static_cast<uint32_t>(static_cast<uint16_t>(lo)) |
+           (static_cast<uint32_t>(static_cast<uint16_t>(hi)) << 16);
+}
+
+// ---- SSSE3 ---------------------------------------------------------------
+
+struct Coeffs128
+{
+    __m128i yOffset, c128, one, kY, kR, kG, kB;
+};
+
+RC_TARGET_SSSE3 inline Coeffs128 makeCoeffs128(const YuvCoefficients &k)
+{
+    Coeffs128 c;
+    c.yOffset = _mm_set1_epi16(static_cast<short>(k.yOffset));
+    c.c128 = _mm_set1_epi16(128);
+    c.one = _mm_set1_epi16(1);
+    c.kY = _mm_set1_epi32(static_cast<int>(pair16(k.cy, 128)));
+    c.kR = _mm_set1_epi32(static_cast<int>(pair16(0, k.rv)));
+    c.kG = _mm_set1_epi32(static_cast<int>(pair16(k.gu, k.gv)));
+    c.kB = _mm_set1_epi32(static_cast<int>(pair16(k.bu, 0)));
+    return c;
+}
+
+// 8 pixels: y16 = Y as int16, c16 = 4 (U, V) int16 pairs, one per pixel pair.
+// Out: R/G/B as int16 (already clamped to the int16 range).
+RC_TARGET_SSSE3 inline void yuv8(__m128i y16, __m128i c16, const Coeffs128 &c,
+                                 __m128i &r, __m128i &g, __m128i &b)
+{
+    y16 = _mm_sub_epi16(y16, c.yOffset);
+    c16 = _mm_sub_epi16(c16, c.c128);
+    const __m128i yLo = _mm_madd_epi16(_mm_unpacklo_epi16(y16, c.one), c.kY);
+    const __m128i yHi = _mm_madd_epi16(_mm_unpackhi_epi16(y16, c.one), c.kY);
+    const __m128i uvLo = _mm_unpacklo_epi32(c16, c16);
+    const __m128i uvHi = _mm_unpackhi_epi32(c16, c16);
+    r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(uvLo, c.kR)), 8),
+                        _mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(uvHi, c.kR)), 8));
+    g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(uvLo, c.kG)), 8),
+                        _mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(uvHi, c.kG)), 8));
+    b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(yLo, _mm_madd_epi16(uvLo, c.kB)), 8),
+                        _mm_srai_epi32(_mm_add_epi32(yHi, _mm_madd_epi16(uvHi, c.kB)), 8));
+}
+
+RC_TARGET_SSSE3 inline void storeRgb16(uint8_t *dst, __m128i r, __m128i g, __m128i b)
+{
+    for (int chunk = 0; chunk < 3; chunk++)
+    {
+        const __m128i mr = _mm_load_si128(reinterpret_cast<const __m128i *>(kInterleave.m[0][chunk]));
+        const __m128i mg = _mm_load_si128(reinterpret_cast<const __m128i *>(kInterleave.m[1][chunk]));
+        const __m128i mb = _mm_load_si128(reinterpret_cast<const __m128i *>(kInterleave.m[2][chunk]));
+        const __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, mr), _mm_shuffle_epi8(g, mg)),
+                                         _mm_shuffle_epi8(b, mb));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + chunk * 16), out);
+    }
+}
+
+RC_TARGET_SSSE3 uint32_t packed422Ssse3(const uint8_t *src, uint8_t *dst, uint32_t width, bool uyvy,
+                                        const YuvCoefficients &k)
+{
+    const Coeffs128 c = makeCoeffs128(k);
+    const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2));
+        const __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x * 2 + 16));
+        __m128i y0, y1, c0, c1;
+        if (uyvy)
+        {
+            y0 = _mm_srli_epi16(v0, 8);
+            y1 = _mm_srli_epi16(v1, 8);
+            c0 = _mm_and_si128(v0, lowBytes);
+            c1 = _mm_and_si128(v1, lowBytes);
+        }
+        else
+        {
+            y0 = _mm_and_si128(v0, lowBytes);
+            y1 = _mm_and_si128(v1, lowBytes);
+            c0 = _mm_srli_epi16(v0, 8);
+            c1 = _mm_srli_epi16(v1, 8);
+        }
+        __m128i r0, g0, b0, r1, g1, b1;
+        yuv8(y0, c0, c, r0, g0, b0);
+        yuv8(y1, c1, c, r1, g1, b1);
+        storeRgb16(dst + x * 3, _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1));
+    }
+    return x;
+}
+
+RC_TARGET_SSSE3 uint32_t nv12Ssse3(const uint8_t *yRow, const uint8_t *uvRow, uint8_t *dst, uint32_t width,
+                                   const YuvCoefficients &k)
+{
+    const Coeffs128 c = makeCoeffs128(k);
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i yv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(yRow + x));
+        const __m128i uv = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uvRow + x));
+        __m128i r0, g0, b0, r1, g1, b1;
+        yuv8(_mm_unpacklo_epi8(yv, zero), _mm_unpacklo_epi8(uv, zero), c, r0, g0, b0);
+        yuv8(_mm_unpackhi_epi8(yv, zero), _mm_unpackhi_epi8(uv, zero), c, r1, g1, b1);
+        storeRgb16(dst + x * 3, _mm_packus_epi16(r0, r1), _mm_packus_epi16(g0, g1), _mm_packus_epi16(b0, b1));
+    }
+    return x;
+}
+
+RC_TARGET_SSSE3 size_t rgb32Ssse3(const uint8_t *src, uint8_t *dst, size_t pixels)
+{
+    // 4 pixels -> 12 bytes packed at the bottom of each register, then
+    // shifted together into three 16-byte stores.
+    const __m128i drop = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -128, -128, -128, -128);
+    size_t i = 0;
+    for (; i + 16 <= pixels; i += 16)
+    {
+        const __m128i *s = reinterpret_cast<const __m128i *>(src + i * 4);
+        const __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128(s + 0), drop);
+        const __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128(s + 1), drop);
+        const __m128i s2 = _mm_shuffle_epi8(_mm_loadu_si128(s + 2), drop);
+        const __m128i s3 = _mm_shuffle_epi8(_mm_loadu_si128(s + 3), drop);
+        __m128i *d = reinterpret_cast<__m128i *>(dst + i * 3);
+        _mm_storeu_si128(d + 0, _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+        _mm_storeu_si128(d + 1, _mm_or_si128(_mm_srli_si128(s1, 4), _mm_slli_si128(s2, 8)));
+        _mm_storeu_si128(d + 2, _mm_or_si128(_mm_srli_si128(s2, 8), _mm_slli_si128(s3, 4)));
+    }
+    return i;
+}
+
+// ---- AVX2 ----------------------------------------------------------------
+// Same math on 16 pixels per register. All the unpack/pack steps work per
+// 128-bit lane, which keeps pixel order within a lane; the cross-lane fixup
+// is noted where it's needed.
+
+struct Coeffs256
+{
+    __m256i yOffset, c128, one, kY, kR, kG, kB;
+};
+
+RC_TARGET_AVX2 inline Coeffs256 makeCoeffs256(const YuvCoefficients &k)
+{
+    Coeffs256 c;
+    c.yOffset = _mm256_set1_epi16(static_cast<short>(k.yOffset));
+    c.c128 = _mm256_set1_epi16(128);
+    c.one = _mm256_set1_epi16(1);
+    c.kY = _mm256_set1_epi32(static_cast<int>(pair16(k.cy, 128)));
+    c.kR = _mm256_set1_epi32(static_cast<int>(pair16(0, k.rv)));
+    c.kG = _mm256_set1_epi32(static_cast<int>(pair16(k.gu, k.gv)));
+    c.kB = _mm256_set1_epi32(static_cast<int>(pair16(k.bu, 0)));
+    return c;
+}
+
+RC_TARGET_AVX2 inline void yuv16(__m256i y16, __m256i c16, const Coeffs256 &c,
+                                 __m256i &r, __m256i &g, __m256i &b)
+{
+    y16 = _mm256_sub_epi16(y16, c.yOffset);
+    c16 = _mm256_sub_epi16(c16, c.c128);
+    const __m256i yLo = _mm256_madd_epi16(_mm256_unpacklo_epi16(y16, c.one), c.kY);
+    const __m256i yHi = _mm256_madd_epi16(_mm256_unpackhi_epi16(y16, c.one), c.kY);
+    const __m256i uvLo = _mm256_unpacklo_epi32(c16, c16);
+    const __m256i uvHi = _mm256_unpackhi_epi32(c16, c16);
+    r = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(uvLo, c.kR)), 8),
+                           _mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(uvHi, c.kR)), 8));
+    g = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(uvLo, c.kG)), 8),
+                           _mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(uvHi, c.kG)), 8));
+    b = _mm256_packs_epi32(_mm256_srai_epi32(_mm256_add_epi32(yLo, _mm256_madd_epi16(uvLo, c.kB)), 8),
+                           _mm256_srai_epi32(_mm256_add_epi32(yHi, _mm256_madd_epi16(uvHi, c.kB)), 8));
+}
+
+// 32 pixels of R/G/B bytes (in order) -> 96 bytes of RGB24.
+RC_TARGET_AVX2 inline void storeRgb32px(uint8_t *dst, __m256i r, __m256i g, __m256i b)
+{
+    for (int half = 0; half < 2; half++)
+    {
+        const __m128i r8 = half ? _mm256_extracti128_si256(r, 1) : _mm256_castsi256_si128(r);
+        const __m128i g8 = half ? _mm256_extracti128_si256(g, 1) : _mm256_castsi256_si128(g);
+        const __m128i b8 = half ? _mm256_extracti128_si256(b, 1) : _mm256_castsi256_si128(b);
+        for (int chunk = 0; chunk < 3; chunk++)
+        {
+            const __m128i mr = _mm_load_si128(reinterpret_cast<const __m128i *>(kInterleave.m[0][chunk]));
+            const __m128i mg = _mm_load_si128(reinterpret_cast<const __m128i *>(kInterleave.m[1][chunk]));
+            const __m128i mb = _mm_load_si128(reinterpret_cast<const __m128i *>(kInterleave.m[2][chunk]));
+            const __m128i out = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r8, mr), _mm_shuffle_epi8(g8, mg)),
+                                             _mm_shuffle_epi8(b8, mb));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + half * 48 + chunk * 16), out);
+        }
+    }
+}
+
+RC_TARGET_AVX2 uint32_t packed422Avx2(const uint8_t *src, uint8_t *dst, uint32_t width, bool uyvy,
+                                      const YuvCoefficients &k)
+{
+    const Coeffs256 c = makeCoeffs256(k);
+    const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        const __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2));
+        const __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + x * 2 + 32));
+        __m256i y0, y1, c0, c1;
+        if (uyvy)
+        {
+            y0 = _mm256_srli_epi16(v0, 8);
+            y1 = _mm256_srli_epi16(v1, 8);
+            c0 = _mm256_and_si256(v0, lowBytes);
+            c1 = _mm256_and_si256(v1, lowBytes);
+        }
+        else
+        {
+            y0 = _mm256_and_si256(v0, lowBytes);
+            y1 = _mm256_and_si256(v1, lowBytes);
+            c0 = _mm256_srli_epi16(v0, 8);
+            c1 = _mm256_srli_epi16(v1, 8);
+        }
+        __m256i r0, g0, b0, r1, g1, b1;
+        yuv16(y0, c0, c, r0, g0, b0); // pixels 0-15
+        yuv16(y1, c1, c, r1, g1, b1); // pixels 16-31
+        // packus interleaves per lane (0-7, 16-23 | 8-15, 24-31); put the
+        // middle quadwords back in order.
+        storeRgb32px(dst + x * 3,
+                     _mm256_permute4x64_epi64(_mm256_packus_epi16(r0, r1), _MM_SHUFFLE(3, 1, 2, 0)),
+                     _mm256_permute4x64_epi64(_mm256_packus_epi16(g0, g1), _MM_SHUFFLE(3, 1, 2, 0)),
+                     _mm256_permute4x64_epi64(_mm256_packus_epi16(b0, b1), _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+    return x;
+}
+
+RC_TARGET_AVX2 uint32_t nv12Avx2(const uint8_t *yRow, const uint8_t *uvRow, uint8_t *dst, uint32_t width,
+                                 const YuvCoefficients &k)
+{
+    const Coeffs256 c = makeCoeffs256(k);
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        const __m256i yv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(yRow + x));
+        const __m256i uv = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(uvRow + x));
+        __m256i r0, g0, b0, r1, g1, b1;
+        // Per-lane unpack: lo = pixels 0-7 | 16-23, hi = 8-15 | 24-31, and
+        // the UV bytes split the same way — packus puts them back in order.
+        yuv16(_mm256_unpacklo_epi8(yv, zero), _mm256_unpacklo_epi8(uv, zero), c, r0, g0, b0);
+        yuv16(_mm256_unpackhi_epi8(yv, zero), _mm256_unpackhi_epi8(uv, zero), c, r1, g1, b1);
+        storeRgb32px(dst + x * 3, _mm256_packus_epi16(r0, r1), _mm256_packus_epi16(g0, g1),
+                     _mm256_packus_epi16(b0, b1));
+    }
+    return x;
+}
+
+// Area downscale column sums: 16 bytes widened to four u32 vectors. Only
+// SSE2 is used, but it lives in the SSSE3 table like the rest.
+RC_TARGET_SSSE3 size_t accumulateSsse3(const uint8_t *src, uint32_t *acc, size_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i lo = _mm_unpacklo_epi8(v, zero);
+        const __m128i hi = _mm_unpackhi_epi8(v, zero);
+        __m128i *a = reinterpret_cast<__m128i *>(acc + i);
+        _mm_storeu_si128(a + 0, _mm_add_epi32(_mm_loadu_si128(a + 0), _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1), _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(a + 2, _mm_add_epi32(_mm_loadu_si128(a + 2), _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(a + 3, _mm_add_epi32(_mm_loadu_si128(a + 3), _mm_unpackhi_epi16(hi, zero)));
+    }
+    return i;
+}
+
+RC_TARGET_AVX2 size_t accumulateAvx2(const uint8_t *src, uint32_t *acc, size_t count)
+{
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        for (int j = 0; j < 32; j += 8)
+        {
+            const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i + j)));
+            __m256i *a = reinterpret_cast<__m256i *>(acc + i + j);
+            _mm256_storeu_si256(a, _mm256_add_epi32(_mm256_loadu_si256(a), v));
+        }
+    }
+    return i;
+}
+
+bool cpuHasSsse3()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false; // OS doesn't save YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    // libgcc's cpuinfo already checks XGETBV for the OS-side YMM support.
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+} // namespace
+
+const RowKernels *ssse3Kernels()
+{
+    static const RowKernels kernels = {packed422Ssse3, nv12Ssse3, rgb32Ssse3, accumulateSsse3};
+    static const bool supported = cpuHasSsse3();
+    return supported ? &kernels : nullptr;
+}
+
+const RowKernels *avx2Kernels()
+{
+    // RGB32 is a pure shuffle; 16 pixels per iteration is already memory
+    // bound, so AVX2 reuses the SSSE3 one.
+    static const RowKernels kernels = {packed422Avx2, nv12Avx2, rgb32Ssse3, accumulateAvx2};
+    static const bool supported = cpuHasSsse3() && cpuHasAvx2();
+    return supported ? &kernels : nullptr;
+}
+} // namespace detail
+} // namespace pixfmt
+} // namespace rc
+
+#else
+
+namespace rc
+{
+namespace pixfmt
+{
+namespace detail
+{
+const RowKernels *ssse3Kernels()
+{
+    return nullptr;
+}
+
+const RowKernels *avx2Kernels()
+{
+    return nullptr;
+}
+} // namespace detail
+} // namespace pixfmt
+} // namespace rc
+
+#endif
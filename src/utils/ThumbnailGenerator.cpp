@@ -1,6 +1,7 @@
 #include "ThumbnailGenerator.h"
 #include "../utils/Logger.h"
 #include "../utils/FilesystemCompat.h"
+#include "../utils/PixelFormatConverter.h"
 #include "../renderer/glad_loader.h"
 #include <png.h>
 #include <cstdio>
@@ -183,28 +184,10 @@ void ThumbnailGenerator::resizeImage(
     uint32_t outputWidth,
     uint32_t outputHeight)
 {
-    // Simple nearest-neighbor scaling
-    for (uint32_t y = 0; y < outputHeight; y++)
-    {
-        for (uint32_t x = 0; x < outputWidth; x++)
-        {
-            // Calculate source coordinates
-            uint32_t srcX = (x * inputWidth) / outputWidth;
-            uint32_t srcY = (y * inputHeight) / outputHeight;
-
-            // Clamp to valid range
-            srcX = std::min(srcX, inputWidth - 1);
-            srcY = std::min(srcY, inputHeight - 1);
-
-            // Copy pixel (RGB = 3 bytes)
-            size_t srcIndex = (srcY * inputWidth + srcX) * 3;
-            size_t dstIndex = (y * outputWidth + x) * 3;
-
-            outputData[dstIndex + 0] = inputData[srcIndex + 0]; // R
-            outputData[dstIndex + 1] = inputData[srcIndex + 1]; // G
-            outputData[dstIndex + 2] = inputData[srcIndex + 2]; // B
-        }
-    }
+    // Area average instead of nearest-neighbor: a 1080p frame squeezed
+    // into a preset card otherwise aliases badly on scanlines/dithering.
+    rc::pixfmt::downscaleRgb24Area(inputData, inputWidth, inputHeight, static_cast<size_t>(inputWidth) * 3,
+                                   outputData, outputWidth, outputHeight);
 }
 
 bool ThumbnailGenerator::savePNG(
@@ -69,7 +69,7 @@ private:
     );
 
     /**
-     * @brief Resize RGB image data using simple nearest-neighbor scaling
+     * @brief Resize RGB image data (area average; see rc::pixfmt::downscaleRgb24Area)
      * @param inputData Source RGB data
      * @param inputWidth Source width
      * @param inputHeight Source height
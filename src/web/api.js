@@ -88,6 +88,10 @@ class RetroCaptureAPI {
         return await this.request('POST', '/source/overscan', { x, y, locked });
     }
 
+    async getSourceJitter() {
+        return await this.request('GET', '/source/jitter');
+    }
+
     async getImageSettings() {
         return await this.request('GET', '/image/settings');
     }
@@ -140,8 +144,17 @@ class RetroCaptureAPI {
         return await this.request('GET', '/recording/status');
     }
 
-    async getRecordings() {
-        return await this.request('GET', '/recordings');
+    // params: { offset, limit, order: 'asc'|'desc', from, to, shader, source, session, q }
+    // — empty/undefined ones are left out. No params = the whole list.
+    async getRecordings(params = {}) {
+        const query = new URLSearchParams();
+        for (const [key, value] of Object.entries(params)) {
+            if (value !== undefined && value !== null && value !== '') {
+                query.set(key, value);
+            }
+        }
+        const qs = query.toString();
+        return await this.request('GET', '/recordings' + (qs ? `?${qs}` : ''));
     }
 
     async getRecording(id) {
@@ -224,6 +237,11 @@ class RetroCaptureAPI {
         return await this.request('POST', '/recording/control', { action });
     }
 
+    async setReplayControl(action, seconds = 0) {
+        // action: 'start' | 'stop' | 'save' (seconds = 0 salva o buffer inteiro)
+        return await this.request('POST', '/recording/replay', { action, seconds });
+    }
+
     async deleteRecording(id) {
         return await this.request('DELETE', `/recordings/${encodeURIComponent(id)}`);
     }
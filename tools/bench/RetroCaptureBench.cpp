@@ -0,0 +1,910 @@
+// retrocapture-bench — headless capture → process → encode → mux benchmark.
+//
+// Drives the real pipeline classes with the synthetic test pattern (#149)
+// as the source so numbers are comparable between builds and machines:
+//
+//   VideoCaptureTestPattern → FrameProcessor → ShaderEngine → readback
+//       → MediaEncoder (video + silent audio) → MediaMuxer
+//
+// `--renderer null` skips the GL stages and feeds the pattern's RGB24
+// buffer straight to the encoder (no display / GL context needed).
+// `--renderer gpu` (default when a preset is given) runs them in a hidden
+// GLFW window; each GL stage ends with glFinish() so its time includes the
+// GPU work — the stages run serialized, so this measures per-stage cost,
+// not the pipelined throughput of the app's main loop. SDL2 builds
+// (BUILD_WITH_SDL2) have no GLFW: there only `null` and `--pixfmt` run.
+//
+// Reports p50/p99/max per stage, achieved fps, output bitrate and process
+// CPU (user+sys over wall, so >100% means multi-threaded encoders).
+//
+// `--pixfmt` runs the rc::pixfmt converters instead: every SIMD level the
+// CPU supports is checked byte-for-byte against the scalar reference
+// (exit 1 on any mismatch) and timed per frame.
+// Built only with -DBUILD_BENCH=ON.
+
+#include "capture/VideoCaptureTestPattern.h"
+#include "encoding/MediaEncoder.h"
+#include "encoding/MediaMuxer.h"
+#include "processing/FrameProcessor.h"
+#include "renderer/OpenGLRenderer.h"
+#include "renderer/RGBToYUVPass.h"
+#include "renderer/glad_loader.h"
+#include "shader/ShaderEngine.h"
+#include "utils/Logger.h"
+#include "utils/PixelFormatConverter.h"
+
+#ifndef USE_SDL2
+#include <GLFW/glfw3.h>
+#endif
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct Options
+{
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    uint32_t fps = 60;
+    uint32_t frames = 600;
+    uint32_t warmup = 30;
+    std::string codec = "h264";
+    std::string preset = "veryfast";
+    std::string hw = "software";
+    uint32_t bitrate = 8000000;
+    std::string renderer = ""; // "", "null", "gpu"
+    std::string shaderPreset;
+    std::string readback = "rgb"; // "rgb", "yuv"
+    std::string output;           // empty = discard
+    bool paced = false;
+    bool json = false;
+    bool pixfmt = false;
+};
+
+void printUsage(const char *programName)
+{
+    std::cout << "Usage: " << programName << " [options]\n";
+    std::cout << "  --width <value>        Capture width (default: 1280)\n";
+    std::cout << "  --height <value>       Capture height (default: 720)\n";
+    std::cout << "  --fps <value>          Target framerate (default: 60)\n";
+    std::cout << "  --frames <value>       Measured frames (default: 600)\n";
+    std::cout << "  --warmup <value>       Frames run before measuring (default: 30)\n";
+    std::cout << "  --codec <name>         h264, h265, vp8, vp9 (default: h264)\n";
+    std::cout << "  --preset <name>        Encoder preset (default: veryfast)\n";
+    std::cout << "  --hw <backend>         auto, software, nvenc, vaapi, qsv, amf (default: software)\n";
+    std::cout << "  --bitrate <bps>        Video bitrate (default: 8000000)\n";
+    std::cout << "  --renderer <mode>      null (CPU only) or gpu (default: null, gpu with --shader-preset)\n";
+    std::cout << "  --shader-preset <path> .glslp/.slangp applied in the gpu renderer\n";
+    std::cout << "  --readback <mode>      rgb or yuv (GPU RGB->YUV 4:2:0 pass) (default: rgb)\n";
+    std::cout << "  --output <path>        Write the muxed stream here (default: discard)\n";
+    std::cout << "  --paced                Sleep to the target fps instead of running flat out\n";
+    std::cout << "  --json                 Print the report as JSON\n";
+    std::cout << "  --pixfmt               Verify + time the rc::pixfmt converters (SIMD vs scalar) instead\n";
+}
+
+// std::stoul throws on garbage and accepts "-1" or "30fps"; report all of
+// those like the other option errors instead of aborting.
+bool parseUInt(const std::string &option, const std::string &value, uint32_t &out)
+{
+    try
+    {
+        size_t used = 0;
+        const unsigned long parsed = std::stoul(value, &used);
+        if (used != value.size() || value[0] == '-' || parsed > std::numeric_limits<uint32_t>::max())
+        {
+            throw std::out_of_range(option);
+        }
+        out = static_cast<uint32_t>(parsed);
+        return true;
+    }
+    catch (const std::invalid_argument &)
+    {
+        std::cerr << option << " needs a number, got '" << value << "'\n";
+    }
+    catch (const std::out_of_range &)
+    {
+        std::cerr << option << " out of range: '" << value << "'\n";
+    }
+    return false;
+}
+
+bool parseArgs(int argc, char *argv[], Options &opt)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if (arg == "--help" || arg == "-h")
+        {
+            printUsage(argv[0]);
+            std::exit(0);
+        }
+        else if (arg == "--paced")
+            opt.paced = true;
+        else if (arg == "--json")
+            opt.json = true;
+        else if (arg == "--pixfmt")
+            opt.pixfmt = true;
+        else if (!hasValue)
+        {
+            std::cerr << "Missing value for " << arg << "\n";
+            return false;
+        }
+        else if (arg == "--width")
+        {
+            if (!parseUInt(arg, argv[++i], opt.width))
+                return false;
+        }
+        else if (arg == "--height")
+        {
+            if (!parseUInt(arg, argv[++i], opt.height))
+                return false;
+        }
+        else if (arg == "--fps")
+        {
+            if (!parseUInt(arg, argv[++i], opt.fps))
+                return false;
+        }
+        else if (arg == "--frames")
+        {
+            if (!parseUInt(arg, argv[++i], opt.frames))
+                return false;
+        }
+        else if (arg == "--warmup")
+        {
+            if (!parseUInt(arg, argv[++i], opt.warmup))
+                return false;
+        }
+        else if (arg == "--codec")
+            opt.codec = argv[++i];
+        else if (arg == "--preset")
+            opt.preset = argv[++i];
+        else if (arg == "--hw")
+            opt.hw = argv[++i];
+        else if (arg == "--bitrate")
+        {
+            if (!parseUInt(arg, argv[++i], opt.bitrate))
+                return false;
+        }
+        else if (arg == "--renderer")
+            opt.renderer = argv[++i];
+        else if (arg == "--shader-preset")
+            opt.shaderPreset = argv[++i];
+        else if (arg == "--readback")
+            opt.readback = argv[++i];
+        else if (arg == "--output")
+            opt.output = argv[++i];
+        else
+        {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return false;
+        }
+    }
+
+    if (opt.renderer.empty())
+    {
+        opt.renderer = opt.shaderPreset.empty() && opt.readback == "rgb" ? "null" : "gpu";
+    }
+    if (opt.renderer != "null" && opt.renderer != "gpu")
+    {
+        std::cerr << "--renderer must be null or gpu\n";
+        return false;
+    }
+#ifdef USE_SDL2
+    if (opt.renderer == "gpu")
+    {
+        std::cerr << "--renderer gpu needs the GLFW build (hidden window for the GL context)\n";
+        return false;
+    }
+#endif
+    if (opt.readback != "rgb" && opt.readback != "yuv")
+    {
+        std::cerr << "--readback must be rgb or yuv\n";
+        return false;
+    }
+    if (opt.renderer == "null" && (!opt.shaderPreset.empty() || opt.readback == "yuv"))
+    {
+        std::cerr << "--shader-preset / --readback yuv need --renderer gpu\n";
+        return false;
+    }
+    if (opt.width == 0 || opt.height == 0 || opt.fps == 0 || opt.frames == 0)
+    {
+        std::cerr << "width, height, fps and frames must be > 0\n";
+        return false;
+    }
+    return true;
+}
+
+MediaEncoder::HardwareEncoder parseHardwareEncoder(const std::string &name)
+{
+    if (name == "auto") return MediaEncoder::HardwareEncoder::Auto;
+    if (name == "nvenc") return MediaEncoder::HardwareEncoder::NVENC;
+    if (name == "vaapi") return MediaEncoder::HardwareEncoder::VAAPI;
+    if (name == "qsv") return MediaEncoder::HardwareEncoder::QSV;
+    if (name == "amf") return MediaEncoder::HardwareEncoder::AMF;
+    return MediaEncoder::HardwareEncoder::Software;
+}
+
+double processCpuSeconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user))
+    {
+        return 0.0;
+    }
+    auto toSeconds = [](const FILETIME &ft)
+    {
+        ULARGE_INTEGER v;
+        v.LowPart = ft.dwLowDateTime;
+        v.HighPart = ft.dwHighDateTime;
+        return static_cast<double>(v.QuadPart) / 1e7; // 100 ns ticks
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0.0;
+    }
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#endif
+}
+
+double elapsedUs(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+struct Stage
+{
+    std::string name;
+    std::vector<double> samplesUs;
+
+    double percentile(double p) const
+    {
+        if (samplesUs.empty())
+        {
+            return 0.0;
+        }
+        std::vector<double> sorted = samplesUs;
+        std::sort(sorted.begin(), sorted.end());
+        const size_t index = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+};
+
+// Times pattern generation on its own even when FrameProcessor pulls the
+// frame internally (processFrame → captureLatestFrame → captureFrame).
+class TimedTestPattern : public VideoCaptureTestPattern
+{
+public:
+    bool captureFrame(Frame &frame) override
+    {
+        const auto t0 = Clock::now();
+        const bool ok = VideoCaptureTestPattern::captureFrame(frame);
+        m_lastUs = elapsedUs(t0, Clock::now());
+        return ok;
+    }
+    double lastCaptureUs() const { return m_lastUs; }
+
+private:
+    double m_lastUs = 0.0;
+};
+
+// Hidden-window GL context + the renderer-side objects of the pipeline.
+struct GpuStages
+{
+#ifndef USE_SDL2
+    GLFWwindow *window = nullptr;
+#endif
+    std::unique_ptr<OpenGLRenderer> renderer;
+    std::unique_ptr<FrameProcessor> frameProcessor;
+    std::unique_ptr<ShaderEngine> shaderEngine;
+    std::unique_ptr<RGBToYUVPass> yuvPass;
+    GLuint readFbo = 0;
+    std::vector<uint8_t> padded;
+
+    bool init(const Options &opt)
+    {
+#ifdef USE_SDL2
+        (void)opt;
+        LOG_ERROR("bench: the gpu renderer needs the GLFW build");
+        return false;
+#else
+        if (!glfwInit())
+        {
+            LOG_ERROR("bench: failed to initialize GLFW");
+            return false;
+        }
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(static_cast<int>(opt.width), static_cast<int>(opt.height),
+                                  "retrocapture-bench", nullptr, nullptr);
+        if (!window)
+        {
+            LOG_ERROR("bench: failed to create hidden GLFW window (no display?)");
+            return false;
+        }
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(0);
+#endif
+
+        renderer = std::make_unique<OpenGLRenderer>();
+        if (!renderer->init())
+        {
+            LOG_ERROR("bench: OpenGLRenderer init failed");
+            return false;
+        }
+        frameProcessor = std::make_unique<FrameProcessor>();
+        frameProcessor->init(renderer.get());
+
+        shaderEngine = std::make_unique<ShaderEngine>();
+        if (!shaderEngine->init())
+        {
+            LOG_ERROR("bench: ShaderEngine init failed");
+            return false;
+        }
+        if (!opt.shaderPreset.empty())
+        {
+            shaderEngine->setViewport(opt.width, opt.height);
+            if (!shaderEngine->loadPreset(opt.shaderPreset))
+            {
+                LOG_ERROR("bench: failed to load preset " + opt.shaderPreset);
+                return false;
+            }
+        }
+
+        if (opt.readback == "yuv")
+        {
+            yuvPass = std::make_unique<RGBToYUVPass>();
+            if (!yuvPass->init())
+            {
+                LOG_ERROR("bench: RGBToYUVPass unavailable on this context");
+                return false;
+            }
+        }
+        glGenFramebuffers(1, &readFbo);
+        return true;
+    }
+
+    // Synchronous glReadPixels (the app's sync fallback path) into a
+    // tightly packed buffer; rows come back with the default 4-byte
+    // GL_PACK_ALIGNMENT, so strip the padding like FrameCapturePipeline.
+    void readPixels(GLenum format, uint32_t bytesPerPixel, uint32_t width, uint32_t height,
+                    std::vector<uint8_t> &out)
+    {
+        const size_t row = static_cast<size_t>(width) * bytesPerPixel;
+        const size_t paddedRow = ((row + 3) / 4) * 4;
+        out.resize(row * height);
+        if (paddedRow == row)
+        {
+            glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+                         format, GL_UNSIGNED_BYTE, out.data());
+            return;
+        }
+        padded.resize(paddedRow * height);
+        glReadPixels(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height),
+                     format, GL_UNSIGNED_BYTE, padded.data());
+        for (uint32_t y = 0; y < height; y++)
+        {
+            std::memcpy(out.data() + y * row, padded.data() + y * paddedRow, row);
+        }
+    }
+
+    bool readTexture(GLuint texture, uint32_t width, uint32_t height, std::vector<uint8_t> &out)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, readFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            return false;
+        }
+        readPixels(GL_RGB, 3, width, height, out);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return true;
+    }
+
+    bool readYuv(GLuint texture, uint32_t width, uint32_t height, std::vector<uint8_t> &out)
+    {
+        if (!yuvPass->render(texture, width, height))
+        {
+            return false;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, yuvPass->getFramebuffer());
+        readPixels(GL_RED, 1, width, height + height / 2, out);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return true;
+    }
+
+    void shutdown()
+    {
+        if (readFbo)
+        {
+            glDeleteFramebuffers(1, &readFbo);
+            readFbo = 0;
+        }
+        if (yuvPass)
+        {
+            yuvPass->shutdown();
+            yuvPass.reset();
+        }
+        if (shaderEngine)
+        {
+            shaderEngine->shutdown();
+            shaderEngine.reset();
+        }
+        frameProcessor.reset();
+        if (renderer)
+        {
+            renderer->shutdown();
+            renderer.reset();
+        }
+#ifndef USE_SDL2
+        if (window)
+        {
+            glfwDestroyWindow(window);
+            window = nullptr;
+        }
+        glfwTerminate();
+#endif
+    }
+};
+
+// --pixfmt: each converter at every supported SIMD level, compared with
+// the scalar output of the same input and timed over opt.frames frames.
+int runPixfmtBench(const Options &opt)
+{
+    using namespace rc::pixfmt;
+
+    const uint32_t w = opt.width;
+    const uint32_t h = opt.height;
+    const size_t px = static_cast<size_t>(w) * h;
+    std::vector<uint8_t> src(px * 4);
+    std::mt19937 rng(149);
+    for (uint8_t &b : src)
+    {
+        b = static_cast<uint8_t>(rng());
+    }
+
+    struct Case
+    {
+        const char *name;
+        size_t srcSize;
+        YuvMatrix matrix;
+        YuvRange range;
+        void (*convertYuv)(const uint8_t *, size_t, uint8_t *, uint32_t, uint32_t, YuvMatrix, YuvRange);
+        void (*convertOther)(const uint8_t *, size_t, uint8_t *, uint32_t, uint32_t);
+    };
+    // Recording thumbnails: the source read as RGB24, area-downscaled to 320 wide.
+    auto area320 = [](const uint8_t *s, size_t, uint8_t *d, uint32_t sw, uint32_t sh)
+    { downscaleRgb24Area(s, sw, sh, static_cast<size_t>(sw) * 3, d, 320, std::max(1u, sh * 320 / sw)); };
+    const Case cases[] = {
+        {"yuy2", px * 2, YuvMatrix::Bt601, YuvRange::Limited, yuy2ToRgb24, nullptr},
+        {"uyvy", px * 2, YuvMatrix::Bt601, YuvRange::Limited, uyvyToRgb24, nullptr},
+        {"nv12", px + px / 2, YuvMatrix::Bt601, YuvRange::Limited, nv12ToRgb24, nullptr},
+        {"nv12-709-full", px + px / 2, YuvMatrix::Bt709, YuvRange::Full, nv12ToRgb24, nullptr},
+        {"rgb32", px * 4, YuvMatrix::Bt601, YuvRange::Limited, nullptr, rgb32ToRgb24},
+        {"area-320", px * 3, YuvMatrix::Bt601, YuvRange::Limited, nullptr, area320},
+    };
+
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    const SimdLevel detected = detectSimdLevel();
+    if (detected == SimdLevel::Avx2)
+    {
+        levels.push_back(SimdLevel::Ssse3);
+    }
+    if (detected != SimdLevel::Scalar)
+    {
+        levels.push_back(detected);
+    }
+
+    nlohmann::json report;
+    report["width"] = w;
+    report["height"] = h;
+    report["frames"] = opt.frames;
+    report["detected"] = simdLevelName(detected);
+    if (!opt.json)
+    {
+        std::printf("rc::pixfmt %ux%u, %u frames, detected %s\n", w, h, opt.frames, simdLevelName(detected));
+        std::printf("%-14s %-7s %10s %10s %10s %8s\n", "format", "level", "p50 (ms)", "p99 (ms)", "MPix/s", "exact");
+    }
+
+    std::vector<uint8_t> reference(px * 3);
+    std::vector<uint8_t> out(px * 3);
+    bool allExact = true;
+    for (const Case &c : cases)
+    {
+        auto convert = [&](uint8_t *dst)
+        {
+            if (c.convertYuv)
+                c.convertYuv(src.data(), c.srcSize, dst, w, h, c.matrix, c.range);
+            else
+                c.convertOther(src.data(), c.srcSize, dst, w, h);
+        };
+
+        for (SimdLevel level : levels)
+        {
+            setSimdLevel(level);
+            std::fill(out.begin(), out.end(), 0);
+            convert(out.data());
+            if (level == SimdLevel::Scalar)
+            {
+                reference = out;
+            }
+            const bool exact = (out == reference);
+            allExact = allExact && exact;
+
+            Stage timing;
+            for (uint32_t i = 0; i < opt.frames; i++)
+            {
+                const auto t0 = Clock::now();
+                convert(out.data());
+                timing.samplesUs.push_back(elapsedUs(t0, Clock::now()));
+            }
+            const double p50 = timing.percentile(0.50);
+            const double mpixPerSec = p50 > 0.0 ? static_cast<double>(px) / p50 : 0.0;
+
+            if (opt.json)
+            {
+                report["results"][c.name][simdLevelName(level)] = {
+                    {"p50_us", p50}, {"p99_us", timing.percentile(0.99)},
+                    {"mpix_per_s", mpixPerSec}, {"exact", exact}};
+            }
+            else
+            {
+                std::printf("%-14s %-7s %10.3f %10.3f %10.1f %8s\n", c.name, simdLevelName(level),
+                            p50 / 1000.0, timing.percentile(0.99) / 1000.0, mpixPerSec, exact ? "yes" : "NO");
+            }
+        }
+    }
+    setSimdLevel(detected);
+
+    if (opt.json)
+    {
+        report["exact"] = allExact;
+        std::cout << report.dump(2) << std::endl;
+    }
+    else if (!allExact)
+    {
+        std::printf("MISMATCH: a SIMD kernel differs from the scalar reference\n");
+    }
+    return allExact ? 0 : 1;
+}
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    // No Logger::init(): that would truncate the app's retrocapture.log.
+    // Console only; with --json keep stdout clean (errors go to stderr).
+    Logger::setLevel(opt.json ? Logger::Level::Error : Logger::Level::Warn);
+
+    if (opt.pixfmt)
+    {
+        return runPixfmtBench(opt);
+    }
+
+    const bool gpu = (opt.renderer == "gpu");
+    uint32_t encodeWidth = opt.width;
+    uint32_t encodeHeight = opt.height;
+    GpuStages gpuStages;
+    if (gpu && !gpuStages.init(opt))
+    {
+        gpuStages.shutdown();
+        return 1;
+    }
+
+    TimedTestPattern capture;
+    capture.setFormat(opt.width, opt.height, 0);
+    capture.setFramerate(opt.fps);
+    capture.startCapture();
+
+    MediaEncoder::VideoConfig videoConfig;
+    videoConfig.width = opt.width;
+    videoConfig.height = opt.height;
+    videoConfig.fps = opt.fps;
+    videoConfig.bitrate = opt.bitrate;
+    videoConfig.codec = opt.codec;
+    videoConfig.preset = opt.preset;
+    videoConfig.hardwareEncoder = parseHardwareEncoder(opt.hw);
+    MediaEncoder::AudioConfig audioConfig;
+    audioConfig.sampleRate = 48000;
+    audioConfig.channels = 2;
+
+    MediaEncoder encoder;
+    if (!encoder.initialize(videoConfig, audioConfig, opt.output.empty()))
+    {
+        std::cerr << "Failed to initialize MediaEncoder (codec=" << opt.codec << ", hw=" << opt.hw << ")\n";
+        gpuStages.shutdown();
+        return 1;
+    }
+
+    uint64_t outputBytes = 0;
+    MediaMuxer muxer;
+    MediaMuxer::WriteCallback discard = [&outputBytes](const uint8_t *, size_t size) -> int
+    {
+        outputBytes += size;
+        return static_cast<int>(size);
+    };
+    const bool muxerOk = opt.output.empty()
+                             ? muxer.initialize(videoConfig, audioConfig, encoder.getVideoCodecContext(),
+                                                encoder.getAudioCodecContext(), "", discard)
+                             : muxer.initialize(videoConfig, audioConfig, encoder.getVideoCodecContext(),
+                                                encoder.getAudioCodecContext(), opt.output);
+    if (!muxerOk)
+    {
+        std::cerr << "Failed to initialize MediaMuxer\n";
+        encoder.cleanup();
+        gpuStages.shutdown();
+        return 1;
+    }
+
+    std::vector<Stage> stages;
+    auto stageIndex = [&stages](const std::string &name)
+    {
+        for (size_t i = 0; i < stages.size(); i++)
+        {
+            if (stages[i].name == name) return i;
+        }
+        stages.push_back(Stage{name, {}});
+        return stages.size() - 1;
+    };
+    const size_t sCapture = stageIndex("capture");
+    const size_t sUpload = gpu ? stageIndex("upload") : 0;
+    const size_t sShader = gpu && !opt.shaderPreset.empty() ? stageIndex("shader") : 0;
+    const size_t sReadback = gpu ? stageIndex("readback") : 0;
+    const size_t sEncode = stageIndex("encode");
+    const size_t sAudio = stageIndex("audio");
+    const size_t sMux = stageIndex("mux");
+    const size_t sTotal = stageIndex("total");
+    for (Stage &stage : stages)
+    {
+        stage.samplesUs.reserve(opt.frames);
+    }
+
+    const size_t audioSamplesPerFrame = static_cast<size_t>(audioConfig.sampleRate / opt.fps) * audioConfig.channels;
+    std::vector<int16_t> silence(audioSamplesPerFrame, 0);
+    std::vector<uint8_t> readbackBuffer;
+    std::vector<MediaEncoder::EncodedPacket> packets;
+    const int64_t frameIntervalUs = 1000000LL / opt.fps;
+
+    uint64_t encodeFailures = 0;
+    uint64_t packetsOut = 0;
+    double cpuStart = 0.0;
+    Clock::time_point wallStart = Clock::now();
+    Clock::time_point nextDeadline = wallStart;
+    const uint32_t totalFrames = opt.warmup + opt.frames;
+
+    for (uint32_t i = 0; i < totalFrames; i++)
+    {
+        const bool measuring = (i >= opt.warmup);
+        if (i == opt.warmup)
+        {
+            // Stats only cover the measured window.
+            encoder.fetchVideoStageTimings();
+            outputBytes = 0;
+            cpuStart = processCpuSeconds();
+            wallStart = Clock::now();
+            nextDeadline = wallStart;
+        }
+        auto record = [&](size_t stage, double us)
+        {
+            if (measuring) stages[stage].samplesUs.push_back(us);
+        };
+
+        const auto frameStart = Clock::now();
+        const uint8_t *frameData = nullptr;
+        VideoFrameFormat frameFormat = VideoFrameFormat::RGB24;
+
+        if (gpu)
+        {
+            auto t0 = Clock::now();
+            if (!gpuStages.frameProcessor->processFrame(&capture))
+            {
+                std::cerr << "FrameProcessor::processFrame failed at frame " << i << "\n";
+                break;
+            }
+            glFinish();
+            const double processUs = elapsedUs(t0, Clock::now());
+            record(sCapture, capture.lastCaptureUs());
+            record(sUpload, processUs - capture.lastCaptureUs());
+
+            GLuint texture = gpuStages.frameProcessor->getTexture();
+            uint32_t texW = gpuStages.frameProcessor->getTextureWidth();
+            uint32_t texH = gpuStages.frameProcessor->getTextureHeight();
+            if (!opt.shaderPreset.empty())
+            {
+                t0 = Clock::now();
+                texture = gpuStages.shaderEngine->applyShader(texture, texW, texH);
+                glFinish();
+                record(sShader, elapsedUs(t0, Clock::now()));
+                if (gpuStages.shaderEngine->getOutputWidth() > 0)
+                {
+                    texW = gpuStages.shaderEngine->getOutputWidth();
+                    texH = gpuStages.shaderEngine->getOutputHeight();
+                }
+            }
+
+            t0 = Clock::now();
+            const bool readOk = (opt.readback == "yuv")
+                                    ? gpuStages.readYuv(texture, texW, texH, readbackBuffer)
+                                    : gpuStages.readTexture(texture, texW, texH, readbackBuffer);
+            record(sReadback, elapsedUs(t0, Clock::now()));
+            if (!readOk)
+            {
+                std::cerr << "Readback failed at frame " << i << "\n";
+                break;
+            }
+            frameData = readbackBuffer.data();
+            frameFormat = (opt.readback == "yuv") ? VideoFrameFormat::YUV420SideBySide : VideoFrameFormat::RGB24;
+            // A preset may change the output size; the encoder rescales to
+            // the configured size, as it does in the app.
+            encodeWidth = texW;
+            encodeHeight = texH;
+        }
+        else
+        {
+            Frame frame;
+            capture.captureFrame(frame);
+            record(sCapture, capture.lastCaptureUs());
+            frameData = frame.data;
+        }
+
+        // Synthetic capture clock: exactly one frame interval apart, so PTS
+        // and the encoder's rate control see a steady source.
+        const int64_t timestampUs = static_cast<int64_t>(i) * frameIntervalUs;
+
+        packets.clear();
+        auto t0 = Clock::now();
+        if (!encoder.encodeVideo(frameData, encodeWidth, encodeHeight, timestampUs, packets, frameFormat))
+        {
+            encodeFailures++;
+        }
+        record(sEncode, elapsedUs(t0, Clock::now()));
+
+        t0 = Clock::now();
+        encoder.encodeAudio(silence.data(), silence.size(), timestampUs, packets);
+        record(sAudio, elapsedUs(t0, Clock::now()));
+
+        t0 = Clock::now();
+        for (const auto &packet : packets)
+        {
+            muxer.muxPacket(packet);
+        }
+        record(sMux, elapsedUs(t0, Clock::now()));
+        if (measuring)
+        {
+            packetsOut += packets.size();
+        }
+
+        record(sTotal, elapsedUs(frameStart, Clock::now()));
+
+        if (opt.paced)
+        {
+            nextDeadline += std::chrono::microseconds(frameIntervalUs);
+            std::this_thread::sleep_until(nextDeadline);
+        }
+    }
+
+    const double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    const double cpuSeconds = processCpuSeconds() - cpuStart;
+    const MediaEncoder::VideoStageTimings encoderStages = encoder.fetchVideoStageTimings();
+
+    packets.clear();
+    encoder.flush(packets);
+    for (const auto &packet : packets)
+    {
+        muxer.muxPacket(packet);
+    }
+    muxer.finalize();
+    muxer.cleanup();
+    encoder.cleanup();
+    capture.stopCapture();
+    gpuStages.shutdown();
+
+    const size_t measured = stages[sTotal].samplesUs.size();
+    const double fps = wallSeconds > 0.0 ? static_cast<double>(measured) / wallSeconds : 0.0;
+    const double cpuPercent = wallSeconds > 0.0 ? 100.0 * cpuSeconds / wallSeconds : 0.0;
+    const double mediaSeconds = static_cast<double>(measured) / static_cast<double>(opt.fps);
+    const double kbps = mediaSeconds > 0.0 ? static_cast<double>(outputBytes) * 8.0 / mediaSeconds / 1000.0 : 0.0;
+    auto perFrameUs = [&encoderStages](uint64_t totalUs)
+    {
+        return encoderStages.frames ? static_cast<double>(totalUs) / static_cast<double>(encoderStages.frames) : 0.0;
+    };
+
+    if (opt.json)
+    {
+        nlohmann::json report;
+        report["width"] = opt.width;
+        report["height"] = opt.height;
+        report["fps_target"] = opt.fps;
+        report["codec"] = opt.codec;
+        report["preset"] = opt.preset;
+        report["hw"] = opt.hw;
+        report["renderer"] = opt.renderer;
+        report["readback"] = opt.readback;
+        report["shader_preset"] = opt.shaderPreset;
+        report["frames"] = measured;
+        report["fps"] = fps;
+        report["cpu_percent"] = cpuPercent;
+        report["encode_failures"] = encodeFailures;
+        report["packets"] = packetsOut;
+        if (opt.output.empty())
+        {
+            report["output_kbps"] = kbps;
+        }
+        for (const Stage &stage : stages)
+        {
+            report["stages_us"][stage.name] = {
+                {"p50", stage.percentile(0.50)},
+                {"p99", stage.percentile(0.99)},
+                {"max", stage.percentile(1.0)}};
+        }
+        report["encoder_us_per_frame"] = {
+            {"convert", perFrameUs(encoderStages.convertUs)},
+            {"upload", perFrameUs(encoderStages.uploadUs)},
+            {"encode", perFrameUs(encoderStages.encodeUs)}};
+        std::cout << report.dump(2) << std::endl;
+    }
+    else
+    {
+        std::printf("retrocapture-bench: %ux%u@%u %s/%s hw=%s renderer=%s readback=%s%s%s\n",
+                    opt.width, opt.height, opt.fps, opt.codec.c_str(), opt.preset.c_str(),
+                    opt.hw.c_str(), opt.renderer.c_str(), opt.readback.c_str(),
+                    opt.shaderPreset.empty() ? "" : " preset=", opt.shaderPreset.c_str());
+        std::printf("%-10s %10s %10s %10s\n", "stage", "p50 (ms)", "p99 (ms)", "max (ms)");
+        for (const Stage &stage : stages)
+        {
+            std::printf("%-10s %10.3f %10.3f %10.3f\n", stage.name.c_str(),
+                        stage.percentile(0.50) / 1000.0, stage.percentile(0.99) / 1000.0,
+                        stage.percentile(1.0) / 1000.0);
+        }
+        std::printf("encoder split per frame: convert %.3f ms, upload %.3f ms, encode %.3f ms\n",
+                    perFrameUs(encoderStages.convertUs) / 1000.0,
+                    perFrameUs(encoderStages.uploadUs) / 1000.0,
+                    perFrameUs(encoderStages.encodeUs) / 1000.0);
+        std::printf("frames %zu in %.2f s: %.1f fps, CPU %.0f%%, %llu packets, %llu encode failures",
+                    measured, wallSeconds, fps, cpuPercent,
+                    static_cast<unsigned long long>(packetsOut),
+                    static_cast<unsigned long long>(encodeFailures));
+        if (opt.output.empty())
+        {
+            std::printf(", %.0f kbps", kbps);
+        }
+        std::printf("\n");
+    }
+
+    return encodeFailures == 0 ? 0 : 1;
+}